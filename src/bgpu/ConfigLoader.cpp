@@ -557,9 +557,24 @@ bool ConfigLoader::parseSimSectionParameter(SimParameters *simP)
     if (!parseBooleanParameter("PerCycleStatistics", id, simP->perCycleStatistics))
         return FALSE;
 
+    if (!parseBooleanParameter("BinaryStatistics", id, simP->binaryStatistics))
+        return FALSE;
+
+    if (!parseBooleanParameter("CompressStatistics", id, simP->compressStatistics))
+        return FALSE;
+
     if (!parseBooleanParameter("DetectStalls", id, simP->detectStalls))
         return FALSE;
 
+    if (!parseBooleanParameter("ProfileBoxes", id, simP->profileBoxes))
+        return FALSE;
+
+    if (!parseBooleanParameter("FrameDumpPNG", id, simP->frameDumpPNG))
+        return FALSE;
+
+    if (!parseBooleanParameter("AsyncFrameDump", id, simP->asyncFrameDump))
+        return FALSE;
+
     if (!parseBooleanParameter("GenerateFragmentMap", id, simP->fragmentMap))
         return FALSE;
 
@@ -581,6 +596,18 @@ bool ConfigLoader::parseSimSectionParameter(SimParameters *simP)
     if (!parseBooleanParameter("EnableDriverShaderTranslation", id, simP->enableDriverShTrans))
         return FALSE;
 
+    if (!parseBooleanParameter("LazyTextureResidency", id, simP->lazyTextureResidency))
+        return FALSE;
+
+    if (!parseBooleanParameter("DriverWriteDedup", id, simP->driverWriteDedup))
+        return FALSE;
+
+    if (!parseBooleanParameter("ThreadedTraceDriver", id, simP->threadedTraceDriver))
+        return FALSE;
+
+    if (!parseDecimalParameter("TraceDriverQueueSize", id, simP->traceDriverQueueSize))
+        return FALSE;
+
     if (!parseDecimalParameter("ObjectSize0", id, simP->objectSize0))
         return FALSE;
 
@@ -707,6 +734,9 @@ bool ConfigLoader::parseComSectionParameter(ComParameters *comP)
     if (!parseBooleanParameter("DumpShaderPrograms", id, comP->dumpShaderPrograms))
         return FALSE;
 
+    if (!parseBooleanParameter("FilterRedundantRegisterWrites", id, comP->filterRegisterWrites))
+        return FALSE;
+
 
     if ( !paramsTracker.wasAnyParamSectionDefined() ) {
         stringstream ss;
@@ -1238,6 +1268,12 @@ bool ConfigLoader::parseClpSectionParameter(ClpParameters *clpP)
     if (!parseDecimalParameter("ClipBufferSize", id, clpP->clipBufferSize))
         return FALSE;
 
+    if (!parseBooleanParameter("FrustumClipping", id, clpP->frustumClipping))
+        return FALSE;
+
+    if (!parseFloatParameter("GuardBand", id, clpP->guardBand))
+        return FALSE;
+
     if ( !paramsTracker.wasAnyParamSectionDefined() ) {
         stringstream ss;
         ss << "Parameter '" << id << "' in section [CLIPPER] is not supported";
@@ -1354,6 +1390,9 @@ bool ConfigLoader::parseRasSectionParameter(RasParameters *rasP)
     if (!parseDecimalParameter("HZCacheLineSize", id, rasP->hzCacheLineSize))
         return FALSE;
 
+    if (!parseDecimalParameter("HZCacheWays", id, rasP->hzCacheWays))
+        return FALSE;
+
     if (!parseDecimalParameter("EarlyZQueueSize", id, rasP->earlyZQueueSz))
         return FALSE;
 
@@ -1408,6 +1447,9 @@ bool ConfigLoader::parseRasSectionParameter(RasParameters *rasP)
     if (!parseDecimalParameter("EmulatorStoredTriangles", id, rasP->emuStoredTriangles))
         return FALSE;
 
+    if (!parseBooleanParameter("SIMDStampKernel", id, rasP->simdStampKernel))
+        return FALSE;
+
     if (!parseBooleanParameter("UseMicroPolygonRasterizer", id, rasP->useMicroPolRast))
         return FALSE;
 
@@ -1598,6 +1640,9 @@ bool ConfigLoader::parseFShSectionParameter(FShParameters *fshP)
         
     if (!parseBooleanParameter("AnisoRatioMultOfTwo", id, fshP->anisoRatioMultOf2))
         return FALSE;
+
+    if (!parseBooleanParameter("SpecializedSamplerKernels", id, fshP->samplerKernels))
+        return FALSE;
         
     if (!parseDecimalParameter("TextureBlockDimension", id, fshP->textBlockDim))
         return FALSE;
@@ -116,6 +116,7 @@ struct ComParameters
 {
     bool pipelinedBatches;      /**<  Enable/disable pipelined batch rendering.  */
     bool dumpShaderPrograms;    /**<  Enable/disable dumping shader programs being loaded to files.  */
+    bool filterRegisterWrites;  /**<  Enable/disable filtering register writes that don't change the register value.  */
 };
 
 
@@ -330,6 +331,8 @@ struct ClpParameters
     u32bit startLatency;        /**<  Triangle clipping start latency.  */
     u32bit execLatency;         /**<  Triangle clipping execution latency.  */
     u32bit clipBufferSize;      /**<  Clipped triangle buffer size.  */
+    bool frustumClipping;       /**<  Clip the triangles against the near and far planes and the guard band (otherwise only trivial reject).  */
+    f32bit guardBand;           /**<  Guard band size relative to the viewport for x and y clipping.  */
 };
 
 /**
@@ -365,6 +368,7 @@ struct RasParameters
     u32bit hzBufferSize;            /**<  Size of the Hierarchical Z buffer in blocks.  */
     u32bit hzCacheLines;            /**<  Lines in the HZ cache.  */
     u32bit hzCacheLineSize;         /**<  Block per HZ cache line.  */
+    u32bit hzCacheWays;             /**<  Ways (lines per set) of the HZ cache.  */
     u32bit earlyZQueueSz;           /**<  Size of the Hierarchical/Early Z test queue.  */
     u32bit hzAccessLatency;         /**<  Access latency to the Hierarchical Z Buffer.  */
     u32bit hzUpdateLatency;         /**<  Latency of the update signal to the Hierarchical Z.  */
@@ -383,6 +387,7 @@ struct RasParameters
     u32bit intStampQSize;           /**<  Interpolated stamp queue size (Fragment FIFO).  */
     u32bit shadedStampQSize;        /**<  Shaded stamp queue size (Fragment FIFO) (per stamp unit).  */
     u32bit emuStoredTriangles;      /**<  Number of triangles that can be kept stored in the rasterizer emulator.  */
+    bool simdStampKernel;           /**<  Use the SIMD kernel in the rasterizer emulator to evaluate subtiles, stamps and MSAA samples.  */
 
     //   MicroPolygon Rasterizer parameters.
     bool useMicroPolRast;           /**<  Use the MicroPolygon Rasterizer.  */
@@ -453,6 +458,7 @@ struct FShParameters
     u32bit anisoRoundPrec;  /**<  Aniso round precision.  */
     u32bit anisoRoundThres; /**<  Aniso round threshold.  */
     bool anisoRatioMultOf2; /**<  Aniso ratio must be a multiple of two.  */
+    bool samplerKernels;    /**<  Use the texel conversions specialized for the texture format in the texture emulator.  */
     u32bit textBlockDim;    /**<  Texture block/line dimension in texels (2^n x 2^n).  */
     u32bit textSBlockDim;   /**<  Texture super block dimension in blocks (2^m x 2^m).  */
     u32bit textReqQSize;    /**<  Texture request queue size.  */
@@ -590,7 +596,12 @@ struct SimParameters
     bool perFrameStatistics;/**<  Enable/disable per frame statistics generation.  */
     bool perBatchStatistics;/**<  Enable/disable per batch statistics generation.  */
     bool perCycleStatistics;/**<  Enable/disable per cycle statistics generation.  */
+    bool binaryStatistics;  /**<  Statistics files are written in the binary statistics format instead of CSV.  */
+    bool compressStatistics;/**<  Enable/disable zlib compression of the statistics files.  */
     bool detectStalls;      /**<  Enable/disable stall detection.  */
+    bool profileBoxes;      /**<  Measure and report the host time spent simulating each box.  */
+    bool frameDumpPNG;      /**<  Color, depth and stencil dumps are written as PNG files instead of PPM files.  */
+    bool asyncFrameDump;    /**<  Color, depth and stencil dumps are converted and written by a background thread.  */
     bool fragmentMap;       /**<  Generate the fragment propierty map.  */
     u32bit fragmentMapMode; /**<  Fragment map mode: 0 => fragment latency from generation to color write/blend.  */
     bool doubleBuffer;      /**<  Enables double buffer (front/back) for the color frame buffer.  */
@@ -598,6 +609,11 @@ struct SimParameters
     u32bit msaaSamples;     /**<  Number of MSAA samples per pixel when multisampling is forced in the configuration file.  */
     bool forceFP16ColorBuffer;   /**<  Force float16 color buffer. */
     bool enableDriverShTrans;   /**<  Enables shader program translation in the driver.  */
+    bool lazyTextureResidency;  /**<  Texture mipmaps are written into GPU memory when first accessed.  The uploads are
+                                      preloads, no AGP write traffic is simulated for the textures.  */
+    bool driverWriteDedup;      /**<  The driver elides memory writes with the same content it last wrote.  */
+    bool threadedTraceDriver;   /**<  The trace reader and driver run in their own thread ahead of the simulator.  */
+    u32bit traceDriverQueueSize;    /**<  Number of AGP transactions queued between the trace driver thread and the simulator.  */
     u32bit objectSize0;     /**<  Size in bytes of the objects in the optimized dynamic memory bucket 0.  */
     u32bit objectSize1;     /**<  Size in bytes of the objects in the optimized dynamic memory bucket 1.  */
     u32bit objectSize2;     /**<  Size in bytes of the objects in the optimized dynamic memory bucket 2.  */
@@ -25,7 +25,7 @@
 
 #include "GPUEmulator.h"
 #include "GlobalProfiler.h"
-#include "ImageSaver.h"
+#include "FrameDumpWriter.h"
 #include "ClipperEmulator.h"
 #include <iostream>
 #include <cstring>
@@ -41,16 +41,19 @@ namespace gpu3d
 GPUEmulator::GPUEmulator(SimParameters simP, TraceDriverInterface *trDriver) :
 
     simP(simP), trDriver(trDriver), abortEmulation(false),
-    cacheDXT1RGB(*this, 1024, 64, 0x003C, DXT1_SPACE_SHIFT, TextureEmulator::decompressDXT1RGB),
-    cacheDXT1RGBA(*this, 1024, 64, 0x003C, DXT1_SPACE_SHIFT, TextureEmulator::decompressDXT1RGBA),
-    cacheDXT3RGBA(*this, 1024, 64, 0x003C, DXT3_DXT5_SPACE_SHIFT, TextureEmulator::decompressDXT3RGBA),
-    cacheDXT5RGBA(*this, 1024, 64, 0x003C, DXT3_DXT5_SPACE_SHIFT, TextureEmulator::decompressDXT5RGBA),
-    cacheLATC1(*this, 1024, 64, 0x003F, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC1),
-    cacheLATC1_SIGNED(*this, 1024, 64, 0x003F, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC1Signed),
-    cacheLATC2(*this, 1024, 64, 0x003E, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC2),
-    cacheLATC2_SIGNED(*this, 1024, 64, 0x003E, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC2Signed)
+    cacheDXT1RGB(*this, 1024, 8, 64, 0x003C, DXT1_SPACE_SHIFT, TextureEmulator::decompressDXT1RGB),
+    cacheDXT1RGBA(*this, 1024, 8, 64, 0x003C, DXT1_SPACE_SHIFT, TextureEmulator::decompressDXT1RGBA),
+    cacheDXT3RGBA(*this, 1024, 8, 64, 0x003C, DXT3_DXT5_SPACE_SHIFT, TextureEmulator::decompressDXT3RGBA),
+    cacheDXT5RGBA(*this, 1024, 8, 64, 0x003C, DXT3_DXT5_SPACE_SHIFT, TextureEmulator::decompressDXT5RGBA),
+    cacheLATC1(*this, 1024, 8, 64, 0x003F, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC1),
+    cacheLATC1_SIGNED(*this, 1024, 8, 64, 0x003F, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC1Signed),
+    cacheLATC2(*this, 1024, 8, 64, 0x003E, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC2),
+    cacheLATC2_SIGNED(*this, 1024, 8, 64, 0x003E, LATC1_LATC2_SPACE_SHIFT, TextureEmulator::decompressLATC2Signed)
     
 {
+    //  Configure the color, depth and stencil dumps.
+    FrameDumpWriter::getInstance().setOptions(simP.frameDumpPNG, simP.asyncFrameDump);
+
 printf("GPUEmulator => Creating rasterizer emulator.\n");
 
     //  Create and initialize a rasterizer emulator for Rasterizer.
@@ -64,7 +67,8 @@ printf("GPUEmulator => Creating rasterizer emulator.\n");
         simP.ras.genWidth,              /*  Generation tile width in fragments.  */
         simP.ras.genHeight,             /*  Generation tile width in fragments.  */
         simP.ras.useBBOptimization,     /*  Use the Bounding Box optimization pass (micropolygon rasterizer).  */
-        simP.ras.subPixelPrecision      /*  Precision bits for the decimal part of subpixel operations (micropolygon rasterizer).  */
+        simP.ras.subPixelPrecision,     /*  Precision bits for the decimal part of subpixel operations (micropolygon rasterizer).  */
+        simP.ras.simdStampKernel        /*  Use the SIMD kernel to evaluate subtiles, stamps and MSAA samples.  */
         );
 
     GPU_ASSERT(
@@ -72,6 +76,8 @@ printf("GPUEmulator => Creating rasterizer emulator.\n");
             panic("GPUEmulator", "GPUEmulator", "Error creating rasterizer emulator object.");
     )    
 
+    clipEmu = new ClipperEmulator(MAX_VERTEX_ATTRIBUTES, simP.clp.guardBand);
+
 printf("GPUEmulator => Creating texture emulator.\n");
 
     //  Create texture emulator.
@@ -92,7 +98,8 @@ printf("GPUEmulator => Creating texture emulator.\n");
         simP.ras.scanWidth,             /*  Scan tile width (pixels).  */
         simP.ras.scanHeight,            /*  Scan tile height (pixels).  */
         simP.ras.genWidth,              /*  Generation tile width (pixels).  */
-        simP.ras.genHeight              /*  Generation tile height (pixels).  */
+        simP.ras.genHeight,             /*  Generation tile height (pixels).  */
+        simP.fsh.samplerKernels         /*  Use the specialized texel conversions.  */
         );
 
     GPU_ASSERT(
@@ -158,6 +165,22 @@ printf("GPUEmulator => Allocating memory.\n");
     //  Reset the counter of draw calls processed.
     batchCounter = 0;
 
+    //  Reset the counter of shaded fragments.
+    fragmentCounter = 0;
+
+    //  The hierarchical Z is built on the first z stencil buffer clear.
+    hzValid = false;
+    hzTestedQuads = 0;
+    hzBlockCulledQuads = 0;
+    hzQuadCulledQuads = 0;
+
+    //  Reset the clipping statistics.
+    clippedTriangles = 0;
+    clipCulledTriangles = 0;
+    clipGeneratedTriangles = 0;
+    clipTilesBefore = 0;
+    clipTilesAfter = 0;
+
     //  Reset the validation mode flag.
     validationMode = false;
 
@@ -209,6 +232,18 @@ GPUEmulator::ShadedFragment::ShadedFragment(Fragment *fr, bool _culled)
     culled = _culled;
 }
 
+GPUEmulator::ShadedFragment::ShadedFragment()
+{
+    fragment = NULL;
+    culled = true;
+}
+
+void GPUEmulator::ShadedFragment::set(Fragment *fr, bool _culled)
+{
+    fragment = fr;
+    culled = _culled;
+}
+
 Fragment *GPUEmulator::ShadedFragment::getFragment()
 {
     return fragment;
@@ -235,7 +270,8 @@ void GPUEmulator::ShadedFragment::setAsCulled()
 //  Implementation of the CompressedTextureCache helper class.
 //
 
-GPUEmulator::CompressedTextureCache::CompressedTextureCache(GPUEmulator &emu, u32bit blocks, u32bit blockSize, u64bit blockMask, u32bit ratioShift,
+GPUEmulator::CompressedTextureCache::CompressedTextureCache(GPUEmulator &emu, u32bit blocks, u32bit ways, u32bit blockSize,
+                                                            u64bit blockMask, u32bit ratioShift,
                                                             void (*decompFunc) (u8bit *, u8bit *, u32bit)) :
     emu(emu)
 {
@@ -245,63 +281,87 @@ GPUEmulator::CompressedTextureCache::CompressedTextureCache(GPUEmulator &emu, u3
     decompressedBlockMask = blockMask;
     decompressionFunction = decompFunc;
 
-    //  Allocate space for the decompressed texture data.
+    numWays = ways;
+    numSets = blocks / ways;
+
+    if ((numSets == 0) || ((numSets & (numSets - 1)) != 0) || ((blockSize & (blockSize - 1)) != 0))
+        panic("GPUEmulator::CompressedTextureCache", "CompressedTextureCache", "Number of sets and block size must be a power of 2.");
+
+    for(blockSizeShift = 0; (1U << blockSizeShift) < blockSize; blockSizeShift++);
+
+    //  Allocate space for the decompressed texture data and the block tags.
     decompressedData = new u8bit[decompressedBlockSize * maxCachedBlocks];
+    blockTag = new u64bit[maxCachedBlocks];
+    blockValid = new bool[maxCachedBlocks];
+    blockLastUse = new u32bit[maxCachedBlocks];
 
     //  Clear compressed texture cache data.
-    cachedBlocks = 0;
-    blockCache.clear();
+    clear();
+}
+
+GPUEmulator::CompressedTextureCache::~CompressedTextureCache()
+{
+    delete[] decompressedData;
+    delete[] blockTag;
+    delete[] blockValid;
+    delete[] blockLastUse;
 }
 
 void GPUEmulator::CompressedTextureCache::readData(u64bit address, u8bit *data, u32bit size)
 {
-    //  Search block in the block cache.
+    //  Select the set for the block.
     u64bit blockAddress = address & ~(decompressedBlockMask);
-    map<u64bit, u8bit *>::iterator it;
-    it = blockCache.find(blockAddress);
+    u32bit set = u32bit(blockAddress >> blockSizeShift) & (numSets - 1);
+    u32bit first = set * numWays;
 
-    //  Check if decompressed block is in the cache.
-    if (it != blockCache.end())
-    {
-        //  Copy decompressed data.
-        for(u32bit b = 0; b < size; b++)
-            data[b] = (it->second)[(address & decompressedBlockMask) + b];
-    }
-    else
+    accessCounter++;
+
+    //  Search the block in the set.  Select the LRU block (invalid blocks first) for replacement.
+    u32bit victim = first;
+    for(u32bit w = first; w < (first + numWays); w++)
     {
-        //  Calculate address of the compressed data in memory.
-        u32bit comprAddress = u32bit((blockAddress >> compressionRatioShift) & 0xffffffff);
+        if (blockValid[w] && (blockTag[w] == blockAddress))
+        {
+            //  Copy decompressed data.
+            blockLastUse[w] = accessCounter;
+            memcpy(data, &decompressedData[(w << blockSizeShift) + (address & decompressedBlockMask)], size);
+            return;
+        }
 
-        //  Check if block cache is full.
-        if (cachedBlocks == maxCachedBlocks)
+        if (!blockValid[w])
         {
-            //  Clear the cache.
-            cachedBlocks = 0;
-            blockCache.clear();
+            if (blockValid[victim])
+                victim = w;
         }
+        else if (blockValid[victim] && ((accessCounter - blockLastUse[w]) > (accessCounter - blockLastUse[victim])))
+            victim = w;
+    }
 
-        u8bit *memory = emu.selectMemorySpace(comprAddress);
-        comprAddress = comprAddress & SPACE_ADDRESS_MASK;
-        
-        //  Decompress into the next free cached block.
-        decompressionFunction(&memory[comprAddress], &decompressedData[cachedBlocks * decompressedBlockSize],
-            decompressedBlockSize >> compressionRatioShift);
+    //  Calculate address of the compressed data in memory.
+    u32bit comprAddress = u32bit((blockAddress >> compressionRatioShift) & 0xffffffff);
 
-        //  Copy decompressed data.
-        for(u32bit b = 0; b < size; b++)
-            data[b] = decompressedData[cachedBlocks * decompressedBlockSize + (address & decompressedBlockMask) + b];
+    u8bit *memory = emu.selectMemorySpace(comprAddress);
+    comprAddress = comprAddress & SPACE_ADDRESS_MASK;
 
-        //  Add to the block cache.
-        blockCache.insert(make_pair(blockAddress, &decompressedData[cachedBlocks * decompressedBlockSize]));
-        cachedBlocks++;
-    }
+    //  Decompress into the replaced block.
+    decompressionFunction(&memory[comprAddress], &decompressedData[victim << blockSizeShift],
+        decompressedBlockSize >> compressionRatioShift);
+
+    blockTag[victim] = blockAddress;
+    blockValid[victim] = true;
+    blockLastUse[victim] = accessCounter;
+
+    //  Copy decompressed data.
+    memcpy(data, &decompressedData[(victim << blockSizeShift) + (address & decompressedBlockMask)], size);
 }
 
 void GPUEmulator::CompressedTextureCache::clear()
 {
     //  Clear the cache.
-    cachedBlocks = 0;
-    blockCache.clear();
+    for(u32bit b = 0; b < maxCachedBlocks; b++)
+        blockValid[b] = false;
+
+    accessCounter = 0;
 }
 
 //
@@ -328,6 +388,9 @@ void GPUEmulator::emulateCommandProcessor(AGPTransaction *currentTransaction)
                     printf("AGP_WRITE address %08x size %d\n", address, size);
                 )
 
+                //  The write may modify the z stencil buffer.
+                invalidateHZ(address, size);
+
                 //  Check memory space for the write.
                 if ((address & ADDRESS_SPACE_MASK) == GPU_ADDRESS_SPACE)
                 {
@@ -373,6 +436,9 @@ void GPUEmulator::emulateCommandProcessor(AGPTransaction *currentTransaction)
                     printf("AGP_PRELOAD address %08x size %d\n", address, size);
                 )
 
+                //  The write may modify the z stencil buffer.
+                invalidateHZ(address, size);
+
                 //  Check memory space for the write.
                 if ((address & ADDRESS_SPACE_MASK) == GPU_ADDRESS_SPACE)
                 {
@@ -526,6 +592,9 @@ void GPUEmulator::emulateCommandProcessor(AGPTransaction *currentTransaction)
 
                 case GPU_BLIT:
 
+                    //  The blit destination may be the z stencil buffer.
+                    hzValid = false;
+
                     emulateBlitter();
                     delete currentTransaction;
                     break;
@@ -883,6 +952,7 @@ void GPUEmulator::processRegisterWrite(GPURegister gpuReg, u32bit gpuSubReg, GPU
 
             //  Set GPU use d39 depth range in clip space register.
             state.d3d9DepthRange = gpuData.booleanVal;
+            clipEmu->setDepthRange(state.d3d9DepthRange);
 
             break;
 
@@ -1764,6 +1834,9 @@ void GPUEmulator::processRegisterWrite(GPURegister gpuReg, u32bit gpuSubReg, GPU
             state.userClip[gpuSubReg].setComponents(gpuData.qfVal[0],
                 gpuData.qfVal[1], gpuData.qfVal[2], gpuData.qfVal[3]);
 
+            if (state.userClipPlanes)
+                clipEmu->defineClipPlane(gpuSubReg, state.userClip[gpuSubReg]);
+
             break;
 
         case GPU_USER_CLIP_PLANE:
@@ -1775,6 +1848,14 @@ void GPUEmulator::processRegisterWrite(GPURegister gpuReg, u32bit gpuSubReg, GPU
             //  Set GPU user clip planes enable register.
             state.userClipPlanes = gpuData.booleanVal;
 
+            for(u32bit c = 0; c < MAX_USER_CLIP_PLANES; c++)
+            {
+                if (state.userClipPlanes)
+                    clipEmu->defineClipPlane(c, state.userClip[c]);
+                else
+                    clipEmu->undefineClipPlane(c);
+            }
+
             break;
 
         case GPU_FACEMODE:
@@ -4161,6 +4242,9 @@ void GPUEmulator::clearColorBuffer()
                                  simP.ras.overScanWidth, simP.ras.overScanHeight,
                                  samples, bytesPixel);
 
+        //  The render target may alias the z stencil buffer.
+        invalidateHZ(state.rtAddress[0], pixelMapper[0].computeFrameBufferSize());
+
         //u8bit *memory = selectMemorySpace(state.backBufferBaseAddr);
         u8bit *memory = selectMemorySpace(state.rtAddress[0]);
 
@@ -4264,17 +4348,8 @@ void GPUEmulator::clearColorBuffer()
 //  Converts color data from RGBA8 format to RGBA32F format.
 void GPUEmulator::colorRGBA8ToRGBA32F(u8bit *in, QuadFloat *out)
 {
-    u32bit i;
-
     //  Convert all pixels in the stamp.
-    for(i = 0; i < STAMP_FRAGMENTS; i++)
-    {
-        //  Convert 8 bit normalized color components to 32 bit float point color components.
-        out[i][0] = f32bit(in[i * 4]) * (1.0f / 255.0f);
-        out[i][1] = f32bit(in[i * 4 + 1]) * (1.0f / 255.0f);
-        out[i][2] = f32bit(in[i * 4 + 2]) * (1.0f / 255.0f);
-        out[i][3] = f32bit(in[i * 4 + 3]) * (1.0f / 255.0f);
-    }
+    FragmentOpEmulator::colorRGBA8ToRGBA32F(in, out, STAMP_FRAGMENTS);
 }
 
 //  Converts color data from RGBA16 format to RGBA32F format.
@@ -4296,17 +4371,8 @@ void GPUEmulator::colorRGBA16ToRGBA32F(u8bit *in, QuadFloat *out)
 //  Converts color data in RGB32F format to RGBA8 format.
 void GPUEmulator::colorRGBA32FToRGBA8(QuadFloat *in, u8bit *out)
 {
-    u32bit i;
-
     //  Convert all pixels in the stamp.
-    for(i = 0; i < STAMP_FRAGMENTS; i++)
-    {
-        //  Convert 32bit float point color components to 8 bit normalized color components.
-        out[i * 4] = u8bit(255.0f * GPU_CLAMP(in[i][0], 0.0f, 1.0f));
-        out[i * 4 + 1] = u8bit(255.0f * GPU_CLAMP(in[i][1], 0.0f, 1.0f));
-        out[i * 4 + 2] = u8bit(255.0f * GPU_CLAMP(in[i][2], 0.0f, 1.0f));
-        out[i * 4 + 3] = u8bit(255.0f * GPU_CLAMP(in[i][3], 0.0f, 1.0f));
-    }
+    FragmentOpEmulator::colorRGBA32FToRGBA8(in, out, STAMP_FRAGMENTS);
 }
 
 //  Converts color data in RGB32F format to RGBA16 format.
@@ -4448,59 +4514,9 @@ void GPUEmulator::colorSRGBToLinear(QuadFloat *in)
     }
 }
 
-//  Writes the current color buffer as a ppm file.
+//  Writes the current color buffer as a ppm or png file.
 void GPUEmulator::dumpFrame(char *filename, u32bit rt, bool dumpAlpha)
 {
-    u32bit address;
-    s32bit x,y;
-
-    static u8bit *data = 0;
-    static u32bit dataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (dataSize < (state.displayResX * state.displayResY * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (data != NULL)
-            delete[] data;
-            
-        //  Set the new buffer size.            
-        dataSize = state.displayResX * state.displayResY * 4;
-        
-        //  Create the new buffer.
-        data = new u8bit[dataSize];
-    }
-
-/*#else
-
-    FILE *fout;
-
-    //  Add file extension.
-    char filenameAux[256];
-    sprintf(filenameAux, "%s.ppm", filename);
-    
-    //  Open/Create the file for the current frame.
-    fout = fopen(filenameAux, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("GPUEmulator", "dumpFrame", "Error creating frame color output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.
-    fprintf(fout, "%d %d\n", state.displayResX, state.displayResY);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-
-#endif*/
-
     u32bit samples = state.multiSampling ? state.msaaSamples : 1;
     u32bit bytesPixel;
 
@@ -4523,836 +4539,177 @@ void GPUEmulator::dumpFrame(char *filename, u32bit rt, bool dumpAlpha)
                                 simP.ras.overScanWidth, simP.ras.overScanHeight,
                                 samples, bytesPixel);
 
-    u8bit red;
-    u8bit green;
-    u8bit blue;
-    u8bit alpha;
-
     u8bit *memory = selectMemorySpace(state.rtAddress[rt]);
 
-    //  Check if multisampling is enabled.
-    if (!state.multiSampling)
-    {
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
-
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (x = 0; x < s32bit(state.displayResX); x++)
-            {
-                //  Calculate address from pixel position.
-                address = pixelMapper[rt].computeAddress(x, y);
-                address += state.rtAddress[rt];
-
-                //  Get address inside the memory space.
-                address = address & SPACE_ADDRESS_MASK;
-
-                //  Convert data from the color color buffer to 8-bit PPM format.
-                switch(state.rtFormat[rt])
-                {
-                    case GPU_RGBA8888:
-                        red   = memory[address];
-                        green = memory[address + 1];
-                        blue  = memory[address + 2];
-                        alpha = memory[address + 3];
-                        break;
-
-                    case GPU_RG16F:
-                        red   = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0])), 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2])), 0.0f), 1.0f) * 255.0f);
-                        blue  = 0;
-                        alpha = 0;
-                        break;
-
-                    case GPU_R32F:
-                        red   = u8bit(GPU_MIN(GPU_MAX(*((f32bit *) &memory[address]), 0.0f), 1.0f) * 255.0f);
-                        green = 0;
-                        blue  = 0;
-                        alpha = 0;
-                        break;
-
-                    case GPU_RGBA16:
-                        red   = u8bit(GPU_MIN(GPU_MAX((f32bit(*((u16bit *) &memory[address + 0])) / 65535.0f), 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX((f32bit(*((u16bit *) &memory[address + 2])) / 65535.0f), 0.0f), 1.0f) * 255.0f);
-                        blue  = u8bit(GPU_MIN(GPU_MAX((f32bit(*((u16bit *) &memory[address + 4])) / 65535.0f), 0.0f), 1.0f) * 255.0f);
-                        alpha = u8bit(GPU_MIN(GPU_MAX((f32bit(*((u16bit *) &memory[address + 6])) / 65535.0f), 0.0f), 1.0f) * 255.0f);
-                        break;
+    FrameDumpSurface surface;
 
-                    case GPU_RGBA16F:
-                        red   = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0])), 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2])), 0.0f), 1.0f) * 255.0f);
-                        blue  = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 4])), 0.0f), 1.0f) * 255.0f);
-                        alpha = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 6])), 0.0f), 1.0f) * 255.0f);
-                        break;
-                }
+    surface.mode = dumpAlpha ? FrameDumpSurface::ALPHA : FrameDumpSurface::COLOR;
+    surface.format = state.rtFormat[rt];
+    surface.width = state.displayResX;
+    surface.height = state.displayResY;
+    surface.samples = samples;
+    surface.d3d9PixelCoordinates = state.d3d9PixelCoordinates;
+    surface.pixelMapper = pixelMapper[rt];
 
-                if (!dumpAlpha)
-                {
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    data[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    data[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    data[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    //data[(yImage * state.displayResX + x) * 4 + 3] = alpha;
-                    data[(yImage * state.displayResX + x) * 4 + 3] = 255;
-                }
-                else
-                {
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    data[(yImage * state.displayResX + x) * 4 + 0] = 
-                    data[(yImage * state.displayResX + x) * 4 + 1] = 
-                    data[(yImage * state.displayResX + x) * 4 + 2] = 
-                    data[(yImage * state.displayResX + x) * 4 + 3] = alpha;
-                }
-            }
-        }
-    }
-    else
-    {
-        QuadFloat sampleColors[MAX_MSAA_SAMPLES];
-        QuadFloat resolvedColor;
-        QuadFloat referenceColor;
-        QuadFloat currentColor;
+    //  Convert and write the render target (MSAA samples are resolved).
+    FrameDumpWriter::getInstance().dump(filename, surface, &memory[state.rtAddress[rt] & SPACE_ADDRESS_MASK],
+                                        pixelMapper[rt].computeFrameBufferSize());
+}
 
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
+//  Writes the current depth buffer as a ppm or png file.
+void GPUEmulator::dumpDepthBuffer(char *filename)
+{
+    //  Check if multisampling is enabled.
+    if (state.multiSampling)
+        panic("GPUEmulator", "dumpDepthBuffer", "MSAA not implemented.");
 
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for(x = 0; x < s32bit(state.displayResX); x++)
-            {
+    zPixelMapper.setupDisplay(state.displayResX, state.displayResY, STAMP_WIDTH, STAMP_WIDTH,
+                             simP.ras.genWidth / STAMP_WIDTH, simP.ras.genHeight / STAMP_HEIGHT,
+                             simP.ras.scanWidth / simP.ras.genWidth, simP.ras.scanHeight / simP.ras.genHeight,
+                             simP.ras.overScanWidth, simP.ras.overScanHeight,
+                             1, 4);
 
-                address = pixelMapper[rt].computeAddress(x, y);
+    u8bit *memory = selectMemorySpace(state.zStencilBufferBaseAddr);
 
-                //  Calculate address for the first sample in the pixel.
-                address += state.rtAddress[rt];
+    FrameDumpSurface surface;
 
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-                resolvedColor[3] = 0.0f;
+    surface.mode = FrameDumpSurface::DEPTH;
+    surface.format = state.colorBufferFormat;
+    surface.width = state.displayResX;
+    surface.height = state.displayResY;
+    surface.samples = 1;
+    surface.d3d9PixelCoordinates = state.d3d9PixelCoordinates;
+    surface.pixelMapper = zPixelMapper;
 
-                QuadFloat referenceColor;
+    FrameDumpWriter::getInstance().dump(filename, surface, &memory[state.zStencilBufferBaseAddr & SPACE_ADDRESS_MASK],
+                                        zPixelMapper.computeFrameBufferSize());
+}
 
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(state.rtFormat[rt])
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(memory[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(memory[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(memory[address + 2]) / 255.0f;
-                        referenceColor[3] = f32bit(memory[address + 3]) / 255.0f;
-                        break;
+//  Writes the current stencil buffer as a ppm or png file.
+void GPUEmulator::dumpStencilBuffer(char *filename)
+{
+    //  Check if multisampling is enabled.
+    if (state.multiSampling)
+        panic("GPUEmulator", "dumpStencilBuffer", "MSAA not implemented.");
 
-                    case GPU_RG16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2]));
-                        referenceColor[2] = 0.0f;
-                        referenceColor[3] = 0.0f;
-                        break;
+    zPixelMapper.setupDisplay(state.displayResX, state.displayResY, STAMP_WIDTH, STAMP_WIDTH,
+                             simP.ras.genWidth / STAMP_WIDTH, simP.ras.genHeight / STAMP_HEIGHT,
+                             simP.ras.scanWidth / simP.ras.genWidth, simP.ras.scanHeight / simP.ras.genHeight,
+                             simP.ras.overScanWidth, simP.ras.overScanHeight,
+                             1, 4);
 
-                    case GPU_R32F:
-                        referenceColor[0] = *((f32bit *) &memory[address]);
-                        referenceColor[1] = 0.0f;
-                        referenceColor[2] = 0.0f;
-                        referenceColor[3] = 0.0f;
-                        break;
+    u8bit *memory = selectMemorySpace(state.zStencilBufferBaseAddr);
 
-                    case GPU_RGBA16:
-                        referenceColor[0] = f32bit(*((u16bit *) &memory[address + 0])) / 65535.0f;
-                        referenceColor[1] = f32bit(*((u16bit *) &memory[address + 2])) / 65535.0f;
-                        referenceColor[2] = f32bit(*((u16bit *) &memory[address + 6])) / 65535.0f;
-                        referenceColor[3] = f32bit(*((u16bit *) &memory[address + 8])) / 65535.0f;
-                        break;
+    FrameDumpSurface surface;
 
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 4]));
-                        referenceColor[3] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 6]));
-                        break;
-                }
+    surface.mode = FrameDumpSurface::STENCIL;
+    surface.format = state.colorBufferFormat;
+    surface.width = state.displayResX;
+    surface.height = state.displayResY;
+    surface.samples = 1;
+    surface.d3d9PixelCoordinates = state.d3d9PixelCoordinates;
+    surface.pixelMapper = zPixelMapper;
 
-                bool fullCoverage = true;
+    FrameDumpWriter::getInstance().dump(filename, surface, &memory[state.zStencilBufferBaseAddr & SPACE_ADDRESS_MASK],
+                                        zPixelMapper.computeFrameBufferSize());
+}
 
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < state.msaaSamples; i++)
-                {
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(state.rtFormat[rt])
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(memory[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(memory[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(memory[address + i * 4 + 2]) / 255.0f;
-                            currentColor[3] = f32bit(memory[address + i * 4 + 3]) / 255.0f;
-                            break;
+//  Load the current vertex program in the shader emulator.
+void GPUEmulator::loadVertexProgram()
+{
+    u8bit *code;
 
-                        case GPU_RG16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 4 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 4 + 2]));
-                            currentColor[2] = 0.0f;
-                            currentColor[3] = 0.0f;
-                            break;
+    u8bit *memory = selectMemorySpace(state.vertexProgramAddr);
+    u32bit address = state.vertexProgramAddr & SPACE_ADDRESS_MASK;
 
-                        case GPU_R32F:
-                            currentColor[0] = *((f32bit *) &memory[address + i * 4]);
-                            currentColor[1] = 0.0f;
-                            currentColor[2] = 0.0f;
-                            currentColor[3] = 0.0f;
-                            break;
+    code = &memory[address];
 
-                        case GPU_RGBA16:
-                            currentColor[0] = f32bit(*((u16bit *) &memory[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = f32bit(*((u16bit *) &memory[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = f32bit(*((u16bit *) &memory[address + i * 8 + 4])) / 65535.0f;
-                            currentColor[3] = f32bit(*((u16bit *) &memory[address + i * 8 + 6])) / 65535.0f;
-                            break;
+    GPU_DEBUG(
+        printf("Loading vertex program from address %08x to PC %04x size %d\n", state.vertexProgramAddr,
+            state.vertexProgramStartPC, state.vertexProgramSize);
+        bool endProgram = false;
+        u32bit nopsAtTheEnd = 0;
+        for(u32bit i = 0; i < (state.vertexProgramSize / ShaderInstruction::SHINSTRSIZE); i++)
+        {
+            ShaderInstruction shInstr(&code[i * ShaderInstruction::SHINSTRSIZE]);
 
+            if (!endProgram)
+            {
+                char dis[1024];
+                shInstr.disassemble(dis);
+                printf(" %04x : ", state.vertexProgramStartPC + i);
+                for(u32bit b = 0; b < ShaderInstruction::SHINSTRSIZE; b++)
+                    printf("%02x ", code[i * ShaderInstruction::SHINSTRSIZE + b]);
+                printf(" : %s\n", dis);
+                fflush(stdout);
+                endProgram = shInstr.getEndFlag();
+            }
+            else
+            {
+                if (shInstr.getOpcode() != NOP)
+                    panic("GPUEmulator", "loadVertexProgram", "Unexpected instruction after end of program.");
 
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 4]));
-                            currentColor[3] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 6]));
-                            break;
-                    }
+                nopsAtTheEnd++;
+            }
+        }
+        printf("Trail NOPs = %d\n", nopsAtTheEnd);
+    )
 
-                    sampleColors[i][0] = currentColor[0];
-                    sampleColors[i][1] = currentColor[1];
-                    sampleColors[i][2] = currentColor[2];
-                    sampleColors[i][3] = currentColor[3];
+    shEmu->loadShaderProgram(code, state.vertexProgramStartPC, state.vertexProgramSize, VERTEX_PARTITION);
+}
 
-                    resolvedColor[0] += LINEAR(currentColor[0]);
-                    resolvedColor[1] += LINEAR(currentColor[1]);
-                    resolvedColor[2] += LINEAR(currentColor[2]);
-                    //resolvedColor[3] += LINEAR(currentColor[3]);
-                    resolvedColor[3] += currentColor[3];
+//  Load the current fragment program in the shader emulator.
+void GPUEmulator::loadFragmentProgram()
+{
+    u8bit *code;
 
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
+    u8bit *memory = selectMemorySpace(state.fragProgramAddr);
+    u32bit address = state.fragProgramAddr & SPACE_ADDRESS_MASK;
 
+    code = &memory[address];
 
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(referenceColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(referenceColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(referenceColor[2], 0.0f), 1.0f) * 255.0f);
-                    alpha = u8bit(GPU_MIN(GPU_MAX(referenceColor[3], 0.0f), 1.0f) * 255.0f);
+    GPU_DEBUG(
+        printf("Loading fragment program from address %08x to PC %04x size %d\n", state.fragProgramAddr,
+            state.fragProgramStartPC, state.fragProgramSize);
+        bool endProgram = false;
+        u32bit nopsAtTheEnd = 0;
+        for(u32bit i = 0; i < (state.fragProgramSize / ShaderInstruction::SHINSTRSIZE); i++)
+        {
+            ShaderInstruction shInstr(&code[i * ShaderInstruction::SHINSTRSIZE]);
 
-                }
-                else
-                {
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(state.msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(state.msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(state.msaaSamples));
-                    //resolvedColor[3] = GAMMA(resolvedColor[3] / f32bit(state.msaaSamples));
-                    resolvedColor[3] = resolvedColor[3] / f32bit(state.msaaSamples);
-
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(resolvedColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(resolvedColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(resolvedColor[2], 0.0f), 1.0f) * 255.0f);
-                    alpha = u8bit(GPU_MIN(GPU_MAX(resolvedColor[3], 0.0f), 1.0f) * 255.0f);
-                }
+            if (!endProgram)
+            {
+                char dis[1024];
+                shInstr.disassemble(dis);
+                printf(" %04x : ", state.fragProgramStartPC + i);
+                for(u32bit b = 0; b < ShaderInstruction::SHINSTRSIZE; b++)
+                    printf("%02x ", code[i * ShaderInstruction::SHINSTRSIZE + b]);
+                printf(" : %s\n", dis);
+                fflush(stdout);
+                endProgram = shInstr.getEndFlag();
+            }
+            else
+            {
+                if (shInstr.getOpcode() != NOP)
+                    panic("GPUEmulator", "loadShaderProgram", "Unexpected instruction after end of program.");
 
-                if (!dumpAlpha)
-                {
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    data[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    data[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    data[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    //data[(yImage * state.displayResX + x) * 4 + 3] = alpha;
-                    data[(yImage * state.displayResX + x) * 4 + 3] = 255;
-                }
-                else
-                {
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    data[(yImage * state.displayResX + x) * 4 + 0] = 
-                    data[(yImage * state.displayResX + x) * 4 + 1] = 
-                    data[(yImage * state.displayResX + x) * 4 + 2] = 
-                    data[(yImage * state.displayResX + x) * 4 + 3] = alpha;
-                }
+                nopsAtTheEnd++;
             }
         }
-    }
+        printf("Trail NOPs = %d\n", nopsAtTheEnd);
+    )
+
+    shEmu->loadShaderProgram(code, state.fragProgramStartPC, state.fragProgramSize, FRAGMENT_PARTITION);
 
-    ImageSaver::getInstance().savePNG(filename, state.displayResX, state.displayResY, data);
 }
 
-//  Writes the current depth buffer as a ppm file.
-void GPUEmulator::dumpDepthBuffer(char *filename)
+//  Load the shader program in the shader emulator.
+void GPUEmulator::loadShaderProgram()
 {
-    u32bit address;
-    s32bit x,y;
+    u8bit *code;
 
-    static u8bit *depthData = 0;
-    static u32bit depthDataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (depthDataSize < (state.displayResX * state.displayResY * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (depthData != NULL)
-            delete[] depthData;
-            
-        //  Set the new buffer size.            
-        depthDataSize = state.displayResX * state.displayResY * 4;
-        
-        //  Create the new buffer.
-        depthData = new u8bit[depthDataSize];
-    }
-
-/*#else
-
-    FILE *fout;
-    
-    //  Add file extension.
-    char filenameAux[256];
-    sprintf(filenameAux, "%s.ppm", filename);
-
-    //  Open/Create the file for the current frame.
-    fout = fopen(filename, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("GPUEmulator", "dumpDepthFrame", "Error creating frame color output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.
-    fprintf(fout, "%d %d\n", state.displayResX, state.displayResY);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-
-#endif*/
-
-    u32bit samples = state.multiSampling ? state.msaaSamples : 1;
-    u32bit bytesPixel;
-
-    bytesPixel = 4;
-
-    zPixelMapper.setupDisplay(state.displayResX, state.displayResY, STAMP_WIDTH, STAMP_WIDTH,
-                             simP.ras.genWidth / STAMP_WIDTH, simP.ras.genHeight / STAMP_HEIGHT,
-                             simP.ras.scanWidth / simP.ras.genWidth, simP.ras.scanHeight / simP.ras.genHeight,
-                             simP.ras.overScanWidth, simP.ras.overScanHeight,
-                             samples, bytesPixel);
-
-    u8bit red;
-    u8bit green;
-    u8bit blue;
-    //u8bit zval;
-
-    u8bit *memory = selectMemorySpace(state.zStencilBufferBaseAddr);
-
-    //  Check if multisampling is enabled.
-    if (!state.multiSampling)
-    {
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
-
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (x = 0; x < s32bit(state.displayResX); x++)
-            {
-                //  Calculate address from pixel position.
-                address = zPixelMapper.computeAddress(x, y);
-                address += state.zStencilBufferBaseAddr;
-
-                //  Get address inside the memory space.
-                address = address & SPACE_ADDRESS_MASK;
-
-                //red   = memory[address];
-                //green = memory[address + 1];
-                //blue  = memory[address + 2];
-
-                // Invert for better reading with irfan view.
-                red   = memory[address + 2];
-                green = memory[address + 1];
-                blue  = memory[address + 0];
-                //zval = u8bit(f32bit(*((u32bit *)&(memory[address + 0]))  & 0x00FFFFFF) / 16777215.0f * 255.f);  //f32bit(*((u32bit *) data) & 0x00FFFFFF) / 16777215.0f;
-
-                u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                depthData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                depthData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                depthData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                //depthData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                depthData[(yImage * state.displayResX + x) * 4 + 3] = 255;
-            }
-        }
-    }
-    else
-    {
-        panic("GPUEmulator", "dumpDepthBuffer", "MSAA not implemented.");
-
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
-
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for(x = 0; x < s32bit(state.displayResX); x++)
-            {
-                QuadFloat resolvedColor;
-
-                u32bit sampleX;
-                u32bit sampleY;
-
-                sampleX = x - GPU_MOD(x, STAMP_WIDTH);
-                sampleY = y - GPU_MOD(y, STAMP_HEIGHT);
-
-                address = pixelMapper[0].computeAddress(sampleX, sampleY);
-
-                //  Calculate address for the first sample in the pixel.
-                address = address + state.msaaSamples * (GPU_MOD(y, STAMP_HEIGHT) * STAMP_WIDTH + GPU_MOD(x, STAMP_WIDTH)) * bytesPixel;
-                address += state.backBufferBaseAddr;
-
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-
-                QuadFloat referenceColor;
-
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(state.colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(memory[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(memory[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(memory[address + 2]) / 255.0f;
-                        break;
-
-                    case GPU_RGBA16:
-                        referenceColor[0] = f32bit(*((u16bit *) &memory[address + 0])) / 65535.0f;
-                        referenceColor[1] = f32bit(*((u16bit *) &memory[address + 2])) / 65535.0f;
-                        referenceColor[2] = f32bit(*((u16bit *) &memory[address + 4])) / 65535.0f;
-                        referenceColor[3] = f32bit(*((u16bit *) &memory[address + 6])) / 65535.0f;
-                        break;
-
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 4]));
-                        break;
-                }
-
-                bool fullCoverage = true;
-
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < state.msaaSamples; i++)
-                {
-                    QuadFloat currentColor;
-
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(state.colorBufferFormat)
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(memory[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(memory[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(memory[address + i * 4 + 2]) / 255.0f;
-                            break;
-
-                        case GPU_RGBA16:
-                            currentColor[0] = f32bit(*((u16bit *) &memory[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = f32bit(*((u16bit *) &memory[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = f32bit(*((u16bit *) &memory[address + i * 8 + 4])) / 65535.0f;
-                            break;
-
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 4]));
-                            break;
-                    }
-
-                    resolvedColor[0] += currentColor[0];
-                    resolvedColor[1] += currentColor[1];
-                    resolvedColor[2] += currentColor[2];
-
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
-
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(referenceColor[0] * 255.0f);
-                    green = u8bit(referenceColor[1] * 255.0f);
-                    blue  = u8bit(referenceColor[2] * 255.0f);
-
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    depthData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    depthData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    depthData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    depthData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                }
-                else
-                {
-                    //  Resolve color as the average of all the sample colors.
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(state.msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(state.msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(state.msaaSamples));
-
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    depthData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    depthData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    depthData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    depthData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                }
-            }
-        }
-    }
-
-    ImageSaver::getInstance().savePNG(filename, state.displayResX, state.displayResY, depthData);
-}
-
-//  Writes the current depth buffer as a ppm file.
-void GPUEmulator::dumpStencilBuffer(char *filename)
-{
-    u32bit address;
-    s32bit x,y;
-
-    static u8bit *stencilData = 0;
-    static u32bit stencilDataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (stencilDataSize < (state.displayResX * state.displayResY * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (stencilData != NULL)
-            delete[] stencilData;
-            
-        //  Set the new buffer size.            
-        stencilDataSize = state.displayResX * state.displayResY * 4;
-        
-        //  Create the new buffer.
-        stencilData = new u8bit[stencilDataSize];
-    }
-
-/*#else
-
-    FILE *fout;
-    
-    //  Add file extension.
-    char filenameAux[256];
-    sprintf(filenameAux, "%s.ppm", filename);
-    //  Open/Create the file for the current frame.
-    fout = fopen(filename, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("GPUEmulator", "dumpStencilBuffer", "Error creating frame color output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.
-    fprintf(fout, "%d %d\n", state.displayResX, state.displayResY);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-
-#endif*/
-
-    u32bit samples = state.multiSampling ? state.msaaSamples : 1;
-    u32bit bytesPixel;
-
-    bytesPixel = 4;
-
-    zPixelMapper.setupDisplay(state.displayResX, state.displayResY, STAMP_WIDTH, STAMP_WIDTH,
-                             simP.ras.genWidth / STAMP_WIDTH, simP.ras.genHeight / STAMP_HEIGHT,
-                             simP.ras.scanWidth / simP.ras.genWidth, simP.ras.scanHeight / simP.ras.genHeight,
-                             simP.ras.overScanWidth, simP.ras.overScanHeight,
-                             samples, bytesPixel);
-
-    u8bit red;
-    u8bit green;
-    u8bit blue;
-
-    u8bit *memory = selectMemorySpace(state.zStencilBufferBaseAddr);
-
-    //  Check if multisampling is enabled.
-    if (!state.multiSampling)
-    {
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
-
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (x = 0; x < s32bit(state.displayResX); x++)
-            {
-                //  Calculate address from pixel position.
-                address = zPixelMapper.computeAddress(x, y);
-                address += state.zStencilBufferBaseAddr;
-
-                //  Get address inside the memory space.
-                address = address & SPACE_ADDRESS_MASK;
-
-                //  Put some color to make small differences more easy to discover.
-                red   = memory[address + 3];
-                green = red & 0xF0;
-                blue  = (red & 0x0F) << 4;
-
-                u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                stencilData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                stencilData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                stencilData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                //stencilData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                stencilData[(yImage * state.displayResX + x) * 4 + 3] = 255;
-            }
-        }
-    }
-    else
-    {
-        panic("GPUEmulator", "dumpStencilBuffer", "MSAA not implemented.");
-
-        s32bit top = state.d3d9PixelCoordinates ? 0 : (state.displayResY - 1);
-        s32bit bottom = state.d3d9PixelCoordinates ? (state.displayResY - 1) : 0;
-        s32bit nextLine = state.d3d9PixelCoordinates ? +1 : -1;
-
-        //  Do this for the whole picture now.
-        for (y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for(x = 0; x < s32bit(state.displayResX); x++)
-            {
-                QuadFloat resolvedColor;
-
-                u32bit sampleX;
-                u32bit sampleY;
-
-                sampleX = x - GPU_MOD(x, STAMP_WIDTH);
-                sampleY = y - GPU_MOD(y, STAMP_HEIGHT);
-
-                address = pixelMapper[0].computeAddress(sampleX, sampleY);
-
-                //  Calculate address for the first sample in the pixel.
-                address = address + state.msaaSamples * (GPU_MOD(y, STAMP_HEIGHT) * STAMP_WIDTH + GPU_MOD(x, STAMP_WIDTH)) * bytesPixel;
-                address += state.backBufferBaseAddr;
-
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-
-                QuadFloat referenceColor;
-
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(state.colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(memory[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(memory[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(memory[address + 2]) / 255.0f;
-                        break;
-
-                    case GPU_RGBA16:
-                        referenceColor[0] = f32bit(*((u16bit *) &memory[address + 0])) / 65535.0f;
-                        referenceColor[1] = f32bit(*((u16bit *) &memory[address + 2])) / 65535.0f;
-                        referenceColor[2] = f32bit(*((u16bit *) &memory[address + 4])) / 65535.0f;
-                        break;
-
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + 4]));
-                        break;
-                }
-
-                bool fullCoverage = true;
-
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < state.msaaSamples; i++)
-                {
-                    QuadFloat currentColor;
-
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(state.colorBufferFormat)
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(memory[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(memory[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(memory[address + i * 4 + 2]) / 255.0f;
-                            break;
-
-                        case GPU_RGBA16:
-                            currentColor[0] = f32bit(*((u16bit *) &memory[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = f32bit(*((u16bit *) &memory[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = f32bit(*((u16bit *) &memory[address + i * 8 + 4])) / 65535.0f;
-                            break;
-
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &memory[address + i * 8 + 4]));
-                            break;
-                    }
-
-                    resolvedColor[0] += currentColor[0];
-                    resolvedColor[1] += currentColor[1];
-                    resolvedColor[2] += currentColor[2];
-
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
-
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(referenceColor[0] * 255.0f);
-                    green = u8bit(referenceColor[1] * 255.0f);
-                    blue  = u8bit(referenceColor[2] * 255.0f);
-
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                }
-                else
-                {
-                    //  Resolve color as the average of all the sample colors.
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(state.msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(state.msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(state.msaaSamples));
-
-                    u32bit yImage = state.d3d9PixelCoordinates ? y : (state.displayResY - 1) - y;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 2] = red;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 1] = green;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 0] = blue;
-                    stencilData[(yImage * state.displayResX + x) * 4 + 3] = 0;
-                }
-            }
-        }
-    }
-
-    ImageSaver::getInstance().savePNG(filename, state.displayResX, state.displayResY, stencilData);
-}
-
-
-//  Load the current vertex program in the shader emulator.
-void GPUEmulator::loadVertexProgram()
-{
-    u8bit *code;
-
-    u8bit *memory = selectMemorySpace(state.vertexProgramAddr);
-    u32bit address = state.vertexProgramAddr & SPACE_ADDRESS_MASK;
-
-    code = &memory[address];
-
-    GPU_DEBUG(
-        printf("Loading vertex program from address %08x to PC %04x size %d\n", state.vertexProgramAddr,
-            state.vertexProgramStartPC, state.vertexProgramSize);
-        bool endProgram = false;
-        u32bit nopsAtTheEnd = 0;
-        for(u32bit i = 0; i < (state.vertexProgramSize / ShaderInstruction::SHINSTRSIZE); i++)
-        {
-            ShaderInstruction shInstr(&code[i * ShaderInstruction::SHINSTRSIZE]);
-
-            if (!endProgram)
-            {
-                char dis[1024];
-                shInstr.disassemble(dis);
-                printf(" %04x : ", state.vertexProgramStartPC + i);
-                for(u32bit b = 0; b < ShaderInstruction::SHINSTRSIZE; b++)
-                    printf("%02x ", code[i * ShaderInstruction::SHINSTRSIZE + b]);
-                printf(" : %s\n", dis);
-                fflush(stdout);
-                endProgram = shInstr.getEndFlag();
-            }
-            else
-            {
-                if (shInstr.getOpcode() != NOP)
-                    panic("GPUEmulator", "loadVertexProgram", "Unexpected instruction after end of program.");
-
-                nopsAtTheEnd++;
-            }
-        }
-        printf("Trail NOPs = %d\n", nopsAtTheEnd);
-    )
-
-    shEmu->loadShaderProgram(code, state.vertexProgramStartPC, state.vertexProgramSize, VERTEX_PARTITION);
-}
-
-//  Load the current fragment program in the shader emulator.
-void GPUEmulator::loadFragmentProgram()
-{
-    u8bit *code;
-
-    u8bit *memory = selectMemorySpace(state.fragProgramAddr);
-    u32bit address = state.fragProgramAddr & SPACE_ADDRESS_MASK;
-
-    code = &memory[address];
-
-    GPU_DEBUG(
-        printf("Loading fragment program from address %08x to PC %04x size %d\n", state.fragProgramAddr,
-            state.fragProgramStartPC, state.fragProgramSize);
-        bool endProgram = false;
-        u32bit nopsAtTheEnd = 0;
-        for(u32bit i = 0; i < (state.fragProgramSize / ShaderInstruction::SHINSTRSIZE); i++)
-        {
-            ShaderInstruction shInstr(&code[i * ShaderInstruction::SHINSTRSIZE]);
-
-            if (!endProgram)
-            {
-                char dis[1024];
-                shInstr.disassemble(dis);
-                printf(" %04x : ", state.fragProgramStartPC + i);
-                for(u32bit b = 0; b < ShaderInstruction::SHINSTRSIZE; b++)
-                    printf("%02x ", code[i * ShaderInstruction::SHINSTRSIZE + b]);
-                printf(" : %s\n", dis);
-                fflush(stdout);
-                endProgram = shInstr.getEndFlag();
-            }
-            else
-            {
-                if (shInstr.getOpcode() != NOP)
-                    panic("GPUEmulator", "loadShaderProgram", "Unexpected instruction after end of program.");
-
-                nopsAtTheEnd++;
-            }
-        }
-        printf("Trail NOPs = %d\n", nopsAtTheEnd);
-    )
-
-    shEmu->loadShaderProgram(code, state.fragProgramStartPC, state.fragProgramSize, FRAGMENT_PARTITION);
-
-}
-
-//  Load the shader program in the shader emulator.
-void GPUEmulator::loadShaderProgram()
-{
-    u8bit *code;
-
-    u8bit *memory = selectMemorySpace(state.programAddress);
-    u32bit address = state.programAddress & SPACE_ADDRESS_MASK;
+    u8bit *memory = selectMemorySpace(state.programAddress);
+    u32bit address = state.programAddress & SPACE_ADDRESS_MASK;
 
     code = &memory[address];
 
@@ -5442,7 +4799,14 @@ void GPUEmulator::clearZStencilBuffer()
                 }
             }
         }
-    
+
+        //  Build the hierarchical Z for the cleared z stencil buffer.
+        resetHZ(state.zBufferClear & 0x00FFFFFF);
+    }
+    else
+    {
+        //  The z stencil buffer was not cleared.
+        hzValid = false;
     }
     
     GLOBALPROFILER_EXITREGION()
@@ -5450,6 +4814,8 @@ void GPUEmulator::clearZStencilBuffer()
 
 void GPUEmulator::resetState()
 {
+    hzValid = false;
+
     state.statusRegister = GPU_ST_RESET;
     state.displayResX = 400;
     state.displayResY = 400;
@@ -5509,6 +4875,7 @@ void GPUEmulator::resetState()
         state.userClip[c][1] = 0.0f;
         state.userClip[c][2] = 0.0f;
         state.userClip[c][3] = 0.0f;
+        clipEmu->undefineClipPlane(c);
     }
 
     state.userClipPlanes = false;
@@ -6539,341 +5906,378 @@ void GPUEmulator::emulateRasterization(ShadedVertex *vertex1, ShadedVertex *vert
         )
 
     }
-    else
+    else if (((state.frustumClipping && simP.clp.frustumClipping) || state.userClipPlanes) &&
+             clipEmu->clip(attribV1, attribV2, attribV3, state.frustumClipping && simP.clp.frustumClipping, state.userClipPlanes))
     {
-        //  Rasterize the triangle.
+        //  The triangle crosses the near or far planes, the guard band or an user clip plane.
+        clippedTriangles++;
+
+        //  Triangle fan for the clipped polygon without the triangles outside the viewport.
+        QuadFloat *clipTriangle[MAX_CLIP_TRIANGLES][3];
+        u32bit numTriangles = clipEmu->getClipTriangles(clipTriangle);
 
         GPU_DEBUG(
-            printf("Rasterize triangle with positions :\n");
-            printf("    v1 = (%f, %f, %f, %f)\n", attribV1[0][0], attribV1[0][1], attribV1[0][2], attribV1[0][3]);
-            printf("    v2 = (%f, %f, %f, %f)\n", attribV2[0][0], attribV2[0][1], attribV2[0][2], attribV2[0][3]);
-            printf("    v3 = (%f, %f, %f, %f)\n", attribV3[0][0], attribV3[0][1], attribV3[0][2], attribV3[0][3]);
+            printf("Clipped triangle into %d triangles\n", numTriangles);
         )
 
-        QuadFloat *attributesVertex1 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
-        QuadFloat *attributesVertex2 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
-        QuadFloat *attributesVertex3 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
-
-        for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+        if (numTriangles == 0)
         {
-            attributesVertex1[a] = attribV1[a];
-            attributesVertex2[a] = attribV2[a];
-            attributesVertex3[a] = attribV3[a];
+            //  The triangle is completely outside the clip planes or the clipped polygon is outside the viewport.
+            clipCulledTriangles++;
         }
+        else
+        {
+            //  Bounding box tiles traversed for the original triangle.
+            clipTilesBefore += boundingBoxTiles(attribV1, attribV2, attribV3);
 
-        //  Setup the triangle.
-        u32bit triangleID = rastEmu->setup(attributesVertex1, attributesVertex2, attributesVertex3);
+            //  Rasterize the triangles for the clipped polygon.  The triangle counter is incremented
+            //  per source primitive, as the triangle identifier in the simulator, so the validation
+            //  logs of the triangles generated by clipping are keyed by the original triangle.
+            for(u32bit t = 0; t < numTriangles; t++)
+            {
+                clipTilesAfter += boundingBoxTiles(clipTriangle[t][0], clipTriangle[t][1], clipTriangle[t][2]);
+                clipGeneratedTriangles++;
 
-        GPU_DEBUG(
-            printf("Triangle setup ID %d\n", triangleID);
-        )
+                rasterizeTriangle(clipTriangle[t][0], clipTriangle[t][1], clipTriangle[t][2]);
+            }
+        }
+    }
+    else
+    {
+        rasterizeTriangle(attribV1, attribV2, attribV3);
+    }
 
-        //  Perform cull face test.
-        bool dropTriangle = cullTriangle(triangleID);
+    //char filename[1024];
+    //sprintf(filename, "frame%04d-batch%05d-triangle%09d", frameCounter, batchCounter, triangleCounter);
+    //dumpFrame(filename);
 
-        //  Check if the triangle must be culled.
-        if (!dropTriangle)
-        {
-            //  Generate fragments for the triangle.
+    triangleCounter++;
 
-            //  Initiate rasterization of the triangle.
-            u32bit batchID = rastEmu->startRecursiveMulti(&triangleID, 1, state.multiSampling);
+    GLOBALPROFILER_EXITREGION()
+}
 
-            GPU_DEBUG(
-                printf("Starting recursive algorithm\n");
-            )
+void GPUEmulator::rasterizeTriangle(QuadFloat *attribV1, QuadFloat *attribV2, QuadFloat *attribV3)
+{
+    //  Rasterize the triangle.
 
-            bool lastFragment = false;
+    GPU_DEBUG(
+        printf("Rasterize triangle with positions :\n");
+        printf("    v1 = (%f, %f, %f, %f)\n", attribV1[0][0], attribV1[0][1], attribV1[0][2], attribV1[0][3]);
+        printf("    v2 = (%f, %f, %f, %f)\n", attribV2[0][0], attribV2[0][1], attribV2[0][2], attribV2[0][3]);
+        printf("    v3 = (%f, %f, %f, %f)\n", attribV3[0][0], attribV3[0][1], attribV3[0][2], attribV3[0][3]);
+    )
 
-            GPU_DEBUG(
-                printf("Updating recursive algorithm\n");
-            )
+    QuadFloat *attributesVertex1 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+    QuadFloat *attributesVertex2 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+    QuadFloat *attributesVertex3 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
 
-            //  Update the triangle rasterization algorithm.
-            rastEmu->updateRecursiveMultiv2(batchID);
+    for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+    {
+        attributesVertex1[a] = attribV1[a];
+        attributesVertex2[a] = attribV2[a];
+        attributesVertex3[a] = attribV3[a];
+    }
 
-            //  Process all the triangle fragments.
-            while(!rastEmu->lastFragment(triangleID))
-            {
-                u32bit currentTriangleID;
+    //  Setup the triangle.
+    u32bit triangleID = rastEmu->setup(attributesVertex1, attributesVertex2, attributesVertex3);
 
-                //  Get the next fragment quad for the triangle.
-                Fragment **stamp = rastEmu->nextStampRecursiveMulti(batchID, currentTriangleID);
+    GPU_DEBUG(
+        printf("Triangle setup ID %d\n", triangleID);
+    )
 
-                GPU_DEBUG(
-                    printf("Requested next fragment quad. Empty = %s\n", (stamp == NULL) ? "T" : "F");
-                )
+    //  Perform cull face test.
+    bool dropTriangle = cullTriangle(triangleID);
 
-                //  Check if fragments were obtained.
-                if (stamp != NULL)
-                {
-                    // Remove fragments outside the viewport or scissor windows.
+    //  Check if the triangle must be culled.
+    if (!dropTriangle)
+    {
+        //  Generate fragments for the triangle.
 
-                    //  Check if multisampling is enabled.
-                    if (state.multiSampling)
-                    {
-                        //  Compute samples for all the fragments in the quad.
-                        for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
-                            rastEmu->computeMSAASamples(stamp[p], state.msaaSamples);
-                    }
+        //  Initiate rasterization of the triangle.
+        u32bit batchID = rastEmu->startRecursiveMulti(&triangleID, 1, state.multiSampling);
+
+        GPU_DEBUG(
+            printf("Starting recursive algorithm\n");
+        )
+
+        bool lastFragment = false;
+
+        GPU_DEBUG(
+            printf("Updating recursive algorithm\n");
+        )
+
+        //  Update the triangle rasterization algorithm.
+        rastEmu->updateRecursiveMultiv2(batchID);
+
+        //  Process all the triangle fragments.
+        while(!rastEmu->lastFragment(triangleID))
+        {
+            u32bit currentTriangleID;
 
-                    //  Create array of shaded fragments.
-                    ShadedFragment *quad[4];
+            //  Get the next fragment quad for the triangle.
+            Fragment **stamp = rastEmu->nextStampRecursiveMulti(batchID, currentTriangleID);
 
-                    bool notAllFragmentsCulled = false;
-                    bool culled[4];
+            GPU_DEBUG(
+                printf("Requested next fragment quad. Empty = %s\n", (stamp == NULL) ? "T" : "F");
+            )
+
+            //  Check if fragments were obtained.
+            if (stamp != NULL)
+            {
+                // Remove fragments outside the viewport or scissor windows.
 
-                    //  Cull fragments and compute fragments attributes for the quad.
+                //  Check if multisampling is enabled.
+                if (state.multiSampling)
+                {
+                    //  Compute samples for all the fragments in the quad.
                     for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
-                    {
-                        //  Check for the last triangle fragment.
-                        lastFragment = stamp[p]->isLastFragment();
+                        rastEmu->computeMSAASamples(stamp[p], state.msaaSamples);
+                }
 
-                        //  Cull fragments outside the triangle.
-                        culled[p] = !stamp[p]->isInsideTriangle();
+                //  Create array of shaded fragments.
+                ShadedFragment *quad[4];
 
-                        //  Cull fragments outside the screen, the viewport or the scissor rectangle.
-                        if (!culled[p])
-                            culled[p] = (stamp[p]->getX() < 0) ||
-                                     (stamp[p]->getX() >= s32bit(state.displayResX)) ||
+                bool notAllFragmentsCulled = false;
+                bool culled[4];
+
+                //  Cull fragments and compute fragments attributes for the quad.
+                for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
+                {
+                    //  Check for the last triangle fragment.
+                    lastFragment = stamp[p]->isLastFragment();
+
+                    //  Cull fragments outside the triangle.
+                    culled[p] = !stamp[p]->isInsideTriangle();
+
+                    //  Cull fragments outside the screen, the viewport or the scissor rectangle.
+                    if (!culled[p])
+                        culled[p] = (stamp[p]->getX() < 0) ||
+                                 (stamp[p]->getX() >= s32bit(state.displayResX)) ||
+                                 (stamp[p]->getY() < 0) ||
+                                 (stamp[p]->getY() >= s32bit(state.displayResY)) ||
+                                 (stamp[p]->getX() < state.viewportIniX) ||
+                                 (stamp[p]->getX() >= (state.viewportIniX + s32bit(state.viewportWidth))) ||
+                                 (stamp[p]->getY() < state.viewportIniY) ||
+                                 (stamp[p]->getY() >= (state.viewportIniY + s32bit(state.viewportHeight))) ||
+                                 (state.scissorTest &&
+                                  ((stamp[p]->getX() < state.scissorIniX) ||
+                                   (stamp[p]->getX() >= (state.scissorIniX + s32bit(state.scissorWidth))) ||
+                                   (stamp[p]->getY() < state.scissorIniY) ||
+                                   (stamp[p]->getY() >= (state.scissorIniY + s32bit(state.scissorHeight)))
+                                  )
+                                 );
+
+
+                    notAllFragmentsCulled = notAllFragmentsCulled || !culled[p];
+
+                    GPU_DEBUG(
+                        if (culled[p])
+                        {
+                            if (!stamp[p]->isInsideTriangle())
+                                printf("Fragment at (%d, %d) has been culled.  Outside triangle.\n", stamp[p]->getX(), stamp[p]->getY());
+                            else if ((stamp[p]->getX() < 0) ||
+                                     (stamp[p]->getX() >= state.displayResX) ||
                                      (stamp[p]->getY() < 0) ||
-                                     (stamp[p]->getY() >= s32bit(state.displayResY)) ||
-                                     (stamp[p]->getX() < state.viewportIniX) ||
-                                     (stamp[p]->getX() >= (state.viewportIniX + s32bit(state.viewportWidth))) ||
+                                     (stamp[p]->getY() >= state.displayResY))
+                                printf("Fragment at (%d, %d) has been culled.  Outside display.\n", stamp[p]->getX(), stamp[p]->getY());
+                            else if ((stamp[p]->getX() < state.viewportIniX) ||
+                                     (stamp[p]->getX() >= (state.viewportIniX + state.viewportWidth)) ||
                                      (stamp[p]->getY() < state.viewportIniY) ||
-                                     (stamp[p]->getY() >= (state.viewportIniY + s32bit(state.viewportHeight))) ||
-                                     (state.scissorTest &&
-                                      ((stamp[p]->getX() < state.scissorIniX) ||
-                                       (stamp[p]->getX() >= (state.scissorIniX + s32bit(state.scissorWidth))) ||
-                                       (stamp[p]->getY() < state.scissorIniY) ||
-                                       (stamp[p]->getY() >= (state.scissorIniY + s32bit(state.scissorHeight)))
-                                      )
-                                     );
+                                     (stamp[p]->getY() >= (state.viewportIniY + state.viewportHeight)))
+                                printf("Fragment at (%d, %d) has been culled.  Outside viewport.\n", stamp[p]->getX(), stamp[p]->getY());
+                            else if (state.scissorTest &&
+                                     ((stamp[p]->getX() < state.scissorIniX) ||
+                                      (stamp[p]->getX() >= (state.scissorIniX + state.scissorWidth)) ||
+                                      (stamp[p]->getY() < state.scissorIniY) ||
+                                      (stamp[p]->getY() >= (state.scissorIniY + state.scissorHeight))))
+                                printf("Fragment at (%d, %d) has been culled.  Outside scissor rectangle.\n", stamp[p]->getX(), stamp[p]->getY());
+                        }
+                        else
+                            printf("Fragment at (%d, %d) generated\n", stamp[p]->getX(), stamp[p]->getY());
+                    )
+                }
 
+                for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
+                {
+                    quad[p] = &shadedStamp[p];
+                    quad[p]->set(stamp[p], culled[p]);
+                }
 
-                        notAllFragmentsCulled = notAllFragmentsCulled || !culled[p];
+                //  Check if all the fragments in the quad are culled or fail the z test against the hierarchical Z.
+                if (notAllFragmentsCulled && !testHZ(quad))
+                {
+                    GLOBALPROFILER_ENTERREGION("emulateRasterization(attribute interpolation)", "", "emulateRasterization")
 
-                        GPU_DEBUG(
-                            if (culled[p])
-                            {
-                                if (!stamp[p]->isInsideTriangle())
-                                    printf("Fragment at (%d, %d) has been culled.  Outside triangle.\n", stamp[p]->getX(), stamp[p]->getY());
-                                else if ((stamp[p]->getX() < 0) ||
-                                         (stamp[p]->getX() >= state.displayResX) ||
-                                         (stamp[p]->getY() < 0) ||
-                                         (stamp[p]->getY() >= state.displayResY))
-                                    printf("Fragment at (%d, %d) has been culled.  Outside display.\n", stamp[p]->getX(), stamp[p]->getY());
-                                else if ((stamp[p]->getX() < state.viewportIniX) ||
-                                         (stamp[p]->getX() >= (state.viewportIniX + state.viewportWidth)) ||
-                                         (stamp[p]->getY() < state.viewportIniY) ||
-                                         (stamp[p]->getY() >= (state.viewportIniY + state.viewportHeight)))
-                                    printf("Fragment at (%d, %d) has been culled.  Outside viewport.\n", stamp[p]->getX(), stamp[p]->getY());
-                                else if (state.scissorTest &&
-                                         ((stamp[p]->getX() < state.scissorIniX) ||
-                                          (stamp[p]->getX() >= (state.scissorIniX + state.scissorWidth)) ||
-                                          (stamp[p]->getY() < state.scissorIniY) ||
-                                          (stamp[p]->getY() >= (state.scissorIniY + state.scissorHeight))))
-                                    printf("Fragment at (%d, %d) has been culled.  Outside scissor rectangle.\n", stamp[p]->getX(), stamp[p]->getY());
-                            }
-                            else
-                                printf("Fragment at (%d, %d) generated\n", stamp[p]->getX(), stamp[p]->getY());
-                        )
-                    }
+                    QuadFloat *stampAttributes[STAMP_FRAGMENTS];
 
-                    //  Check if all the fragments in the quad are culled.
-                    if (notAllFragmentsCulled)
-                    {
-                        GLOBALPROFILER_ENTERREGION("emulateRasterization(attribute interpolation)", "", "emulateRasterization")
+                    for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
+                        stampAttributes[p] = quad[p]->getAttributes();
 
-                        //  Interpolate attributes for all the fragments.
-                        for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
-                        {
-                            quad[p] = new ShadedFragment(stamp[p], culled[p]);
+                    //  Interpolate attributes for all the fragments.
+                    rastEmu->interpolateStamp(stamp, STAMP_FRAGMENTS, state.fragmentInputAttributes, state.interpolation,
+                        stampAttributes);
 
-                            QuadFloat *attributes = quad[p]->getAttributes();
+                    for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
+                    {
+                        QuadFloat *attributes = stampAttributes[p];
 
-                            //  Interpolate fragment attributes.
+                        GPU_DEBUG(
                             for(u32bit a = 0; a < MAX_FRAGMENT_ATTRIBUTES; a++)
                             {
-                                //  Check if the attribute is active.
                                 if (state.fragmentInputAttributes[a])
-                                {
-                                    //  Check if attribute interpolation is enabled.
-                                    if (state.interpolation[a])
-                                    {
-                                        //  Interpolate attribute;
-                                        attributes[a] = rastEmu->interpolate(stamp[p], a);
-
-                                        GPU_DEBUG(
-                                            printf("Interpolating attribute %d to fragment attribute : {%f, %f, %f, %f}\n",
-                                                a, attributes[a][0],  attributes[a][1],  attributes[a][2],  attributes[a][3]);
-                                        )
-                                    }
-                                    else
-                                    {
-                                        //  Copy attribute from the triangle last vertex attribute.
-                                        attributes[a] = rastEmu->copy(stamp[p], a, 2);
-
-                                        GPU_DEBUG(
-                                            printf("Copying attribute %d from vertex 2 to fragment attribute : {%f, %f, %f, %f}\n",
-                                                a, attributes[a][0],  attributes[a][1],  attributes[a][2],  attributes[a][3]);
-                                        )
-                                    }
-                                }
-                                else
-                                {
-                                    GPU_DEBUG(
-                                        printf("Setting default value to fragment attribute %d\n", a);
-                                    )
-
-                                    //  Set default attribute value.
-                                    attributes[a][0] = 0.0f;
-                                    attributes[a][1] = 0.0f;
-                                    attributes[a][2] = 0.0f;
-                                    attributes[a][3] = 0.0f;
-                                }
+                                    printf("%s attribute %d to fragment attribute : {%f, %f, %f, %f}\n",
+                                        state.interpolation[a] ? "Interpolating" : "Copying from vertex 2",
+                                        a, attributes[a][0],  attributes[a][1],  attributes[a][2],  attributes[a][3]);
                             }
+                        )
 
+                        //  Set position attribute (special case).
+                        attributes[POSITION_ATTRIBUTE][0] = f32bit(stamp[p]->getX());
+                        attributes[POSITION_ATTRIBUTE][1] = f32bit(stamp[p]->getY());
+                        attributes[POSITION_ATTRIBUTE][2] = ((f32bit) stamp[p]->getZ()) / ((f32bit) ((1 << state.zBufferBitPrecission) - 1));
+                        attributes[POSITION_ATTRIBUTE][3] = 0.0f;
+                    
+                        //  Set face (triangle area) attribute (special case)
+                        attributes[FACE_ATTRIBUTE][3] = f32bit(stamp[p]->getTriangle()->getArea());
+                    }
 
-                            //  Set position attribute (special case).
-                            attributes[POSITION_ATTRIBUTE][0] = f32bit(stamp[p]->getX());
-                            attributes[POSITION_ATTRIBUTE][1] = f32bit(stamp[p]->getY());
-                            attributes[POSITION_ATTRIBUTE][2] = ((f32bit) stamp[p]->getZ()) / ((f32bit) ((1 << state.zBufferBitPrecission) - 1));
-                            attributes[POSITION_ATTRIBUTE][3] = 0.0f;
-                        
-                            //  Set face (triangle area) attribute (special case)
-                            attributes[FACE_ATTRIBUTE][3] = f32bit(stamp[p]->getTriangle()->getArea());
-                        }
-
-                        GLOBALPROFILER_EXITREGION()
+                    GLOBALPROFILER_EXITREGION()
 
-                        bool watchPixelFound = false;
-                        u32bit watchPixelPosInQuad = 0;
-                        
-                        GPU_EMU_TRACE(
-                            if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                    bool watchPixelFound = false;
+                    u32bit watchPixelPosInQuad = 0;
+                    
+                    GPU_EMU_TRACE(
+                        if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                        {
+                            u32bit watchPixelPosInQuad = 0;
+                            while (!watchPixelFound && (watchPixelPosInQuad < STAMP_FRAGMENTS))
                             {
-                                u32bit watchPixelPosInQuad = 0;
-                                while (!watchPixelFound && (watchPixelPosInQuad < STAMP_FRAGMENTS))
-                                {
-                                    Fragment *fr = quad[watchPixelPosInQuad]->getFragment();
-                                    watchPixelFound = ((fr->getX() == watchPixelX) && (fr->getY() == watchPixelY));
-                                    if (!watchPixelFound)
-                                        watchPixelPosInQuad++;
-                                }
-                                if (watchPixelFound)
-                                {
-                                    printf("emuPrimAssembly => Cull flag for pixel (%d, %d) before zstencil is %s\n",
-                                        watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
-                                }
+                                Fragment *fr = quad[watchPixelPosInQuad]->getFragment();
+                                watchPixelFound = ((fr->getX() == watchPixelX) && (fr->getY() == watchPixelY));
+                                if (!watchPixelFound)
+                                    watchPixelPosInQuad++;
                             }
-                        )
-                        
-                        //  Perform early z.
-                        if (state.earlyZ && !state.modifyDepth)
-                        {
-                            emulateZStencilTest(quad);
-                        }
-
-                        GPU_EMU_TRACE(
-                            if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                            if (watchPixelFound)
                             {
-                                if (watchPixelFound)
-                                {
-                                    printf("emuPrimAssembly => Cull flag for pixel (%d, %d) after zstencil (earlyz) is %s\n",
-                                        watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
-
-                                    traceFShader = true;
-                                    traceTexture = true;
-                                }
+                                printf("emuPrimAssembly => Cull flag for pixel (%d, %d) before zstencil is %s\n",
+                                    watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
                             }
-                        )
-                        
-                        //  Shade the fragment quad.
-                        emulateFragmentShading(quad);
+                        }
+                    )
+                    
+                    //  Perform early z.
+                    if (state.earlyZ && !state.modifyDepth)
+                    {
+                        emulateZStencilTest(quad);
+                    }
 
-                        GPU_EMU_TRACE(
-                            if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                    GPU_EMU_TRACE(
+                        if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                        {
+                            if (watchPixelFound)
                             {
-                                if (watchPixelFound)
-                                {
-                                    QuadFloat *attributes = quad[watchPixelPosInQuad]->getAttributes();
-                                    printf("emuPrimAssembly => Output color for pixel (%d, %d) -> {%f, %f, %f, %f} [%02x, %02x, %02x, %02x]\n",
-                                        watchPixelX, watchPixelY,
-                                        attributes[COLOR_ATTRIBUTE][0], attributes[COLOR_ATTRIBUTE][1],
-                                        attributes[COLOR_ATTRIBUTE][2], attributes[COLOR_ATTRIBUTE][3],
-                                        u8bit(attributes[COLOR_ATTRIBUTE][0] * 255.0f), u8bit(attributes[COLOR_ATTRIBUTE][1] * 255.0f),
-                                        u8bit(attributes[COLOR_ATTRIBUTE][2] * 255.0f), u8bit(attributes[COLOR_ATTRIBUTE][3] * 255.0f));
-
-                                    traceFShader = false;
-                                    traceTexture = false;
-                                }
+                                printf("emuPrimAssembly => Cull flag for pixel (%d, %d) after zstencil (earlyz) is %s\n",
+                                    watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
+
+                                traceFShader = true;
+                                traceTexture = true;
                             }
-                        )
-                        
-                        //  Perform late z.
-                        if (!state.earlyZ || state.modifyDepth)
-                        {
-                            emulateZStencilTest(quad);
                         }
+                    )
+                    
+                    //  Shade the fragment quad.
+                    emulateFragmentShading(quad);
 
-                        GPU_EMU_TRACE(
-                            if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                    GPU_EMU_TRACE(
+                        if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
+                        {
+                            if (watchPixelFound)
                             {
-                                if (watchPixelFound)
-                                {
-                                    printf("emuPrimAssembly => Cull flag for pixel (%d, %d) after zstencil (late z) is %s\n",
-                                        watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
-                                }
+                                QuadFloat *attributes = quad[watchPixelPosInQuad]->getAttributes();
+                                printf("emuPrimAssembly => Output color for pixel (%d, %d) -> {%f, %f, %f, %f} [%02x, %02x, %02x, %02x]\n",
+                                    watchPixelX, watchPixelY,
+                                    attributes[COLOR_ATTRIBUTE][0], attributes[COLOR_ATTRIBUTE][1],
+                                    attributes[COLOR_ATTRIBUTE][2], attributes[COLOR_ATTRIBUTE][3],
+                                    u8bit(attributes[COLOR_ATTRIBUTE][0] * 255.0f), u8bit(attributes[COLOR_ATTRIBUTE][1] * 255.0f),
+                                    u8bit(attributes[COLOR_ATTRIBUTE][2] * 255.0f), u8bit(attributes[COLOR_ATTRIBUTE][3] * 255.0f));
+
+                                traceFShader = false;
+                                traceTexture = false;
                             }
-                        )
-
-                        //  Write/combine the shaded pixel color in/with the current color buffer.
-                        emulateColorWrite(quad);
+                        }
+                    )
+                    
+                    //  Perform late z.
+                    if (!state.earlyZ || state.modifyDepth)
+                    {
+                        emulateZStencilTest(quad);
+                    }
 
-                        //  Delete fragment quad.
-                        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                    GPU_EMU_TRACE(
+                        if (traceLog || (traceBatch && (batchCounter == watchBatch)) || tracePixel)
                         {
-                            delete quad[f]->getFragment();
-                            delete quad[f];
+                            if (watchPixelFound)
+                            {
+                                printf("emuPrimAssembly => Cull flag for pixel (%d, %d) after zstencil (late z) is %s\n",
+                                    watchPixelX, watchPixelY, quad[watchPixelPosInQuad]->isCulled() ? "True" : "False");
+                            }
                         }
-                    }
-                    else
-                    {
-                        GPU_DEBUG(
-                            printf("All fragments in the quad culled\n");
-                        )
+                    )
 
-                        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
-                            delete stamp[f];
-                    }
+                    //  Write/combine the shaded pixel color in/with the current color buffer.
+                    emulateColorWrite(quad);
 
-                    //  Delete the arrays of pointers to fragments for the current quad.
-                    delete[] stamp;
+                    //  Delete the fragments in the quad.  The shaded fragments are reused for the next quad.
+                    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                        delete quad[f]->getFragment();
                 }
                 else
                 {
                     GPU_DEBUG(
-                        printf("Updating recursive algorithm\n");
+                        if (notAllFragmentsCulled)
+                            printf("All fragments in the quad culled by the hierarchical Z\n");
+                        else
+                            printf("All fragments in the quad culled\n");
                     )
 
-                    //  Update the triangle rasterization algorithm.
-                    rastEmu->updateRecursiveMultiv2(batchID);
+                    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                        delete stamp[f];
                 }
+
             }
-        }
+            else
+            {
+                GPU_DEBUG(
+                    printf("Updating recursive algorithm\n");
+                )
 
-        //  Eliminate triangle.
-        rastEmu->destroyTriangle(triangleID);
+                //  Update the triangle rasterization algorithm.
+                rastEmu->updateRecursiveMultiv2(batchID);
+            }
+        }
     }
 
-    //char filename[1024];
-    //sprintf(filename, "frame%04d-batch%05d-triangle%09d", frameCounter, batchCounter, triangleCounter);
-    //dumpFrame(filename);
+    //  Eliminate triangle.
+    rastEmu->destroyTriangle(triangleID);
+}
 
-    triangleCounter++;
+u64bit GPUEmulator::boundingBoxTiles(QuadFloat *attribV1, QuadFloat *attribV2, QuadFloat *attribV3)
+{
+    s32bit xMin, xMax, yMin, yMax, zMin, zMax;
 
-    GLOBALPROFILER_EXITREGION()
+    //  Compute the triangle bounding box inside the viewport as done by triangle setup.
+    GPUMath::boundingBox(attribV1[POSITION_ATTRIBUTE], attribV2[POSITION_ATTRIBUTE], attribV3[POSITION_ATTRIBUTE],
+        state.viewportIniX, state.viewportIniY, state.viewportWidth, state.viewportHeight, xMin, xMax, yMin, yMax, zMin, zMax);
+
+    if ((xMax < xMin) || (yMax < yMin))
+        return 0;
+
+    //  Count the scan tiles covered by the bounding box.
+    s32bit tileWidth = s32bit(simP.ras.scanWidth);
+    s32bit tileHeight = s32bit(simP.ras.scanHeight);
+
+    return u64bit(GPU_FLOOR(f32bit(xMax) / f32bit(tileWidth)) - GPU_FLOOR(f32bit(xMin) / f32bit(tileWidth)) + 1) *
+           u64bit(GPU_FLOOR(f32bit(yMax) / f32bit(tileHeight)) - GPU_FLOOR(f32bit(yMin) / f32bit(tileHeight)) + 1);
 }
 
 
@@ -6938,6 +6342,18 @@ void GPUEmulator::setupDraw()
                              simP.ras.overScanWidth, simP.ras.overScanHeight,
                              samples, bytesPixel);
 
+    //  Check if the z stencil buffer covered by the hierarchical Z changed.
+    if (hzValid && ((hzBufferAddress != state.zStencilBufferBaseAddr) || (hzResX != state.displayResX) ||
+                    (hzResY != state.displayResY) || (hzSamples != samples)))
+        hzValid = false;
+
+    //  Check if an active render target aliases the z stencil buffer.
+    for(u32bit rt = 0; rt < MAX_RENDER_TARGETS; rt++)
+    {
+        if (state.rtEnable[rt])
+            invalidateHZ(state.rtAddress[rt], pixelMapper[rt].computeFrameBufferSize());
+    }
+
     //  Configure Z test emulation.
     fragEmu->configureZTest(state.depthFunction, state.depthMask);
     fragEmu->setZTest(state.depthTest);
@@ -7069,6 +6485,8 @@ void GPUEmulator::emulateFragmentShading(ShadedFragment **quad)
 
     GLOBALPROFILER_ENTERREGION("emulateFragmentShading (load attributes)", "", "emulateFragmentShading")
 
+    fragmentCounter += STAMP_FRAGMENTS;
+
     //  Initialize four threads for the fragment quad.
     for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
     {
@@ -8273,9 +7691,198 @@ void GPUEmulator::emulateZStencilTest(ShadedFragment **quad)
         printf("\n--------\n");
     )
 
+    //  Update the hierarchical Z if z writes are enabled.
+    if (hzValid && state.depthTest && state.depthMask)
+        updateHZ(quad[0]->getFragment()->getX(), quad[0]->getFragment()->getY(), zStencilData);
+
     GLOBALPROFILER_EXITREGION()
 }
 
+void GPUEmulator::resetHZ(u32bit z)
+{
+    hzBufferAddress = state.zStencilBufferBaseAddr;
+    hzBufferSize = zPixelMapper.computeFrameBufferSize();
+    hzResX = state.displayResX;
+    hzResY = state.displayResY;
+    hzSamples = state.multiSampling ? state.msaaSamples : 1;
+
+    hzQuadsX = (hzResX + 1) >> 1;
+    hzQuadsY = (hzResY + 1) >> 1;
+    hzBlocksX = (hzQuadsX + HZ_BLOCK_QUADS - 1) / HZ_BLOCK_QUADS;
+    u32bit hzBlocksY = (hzQuadsY + HZ_BLOCK_QUADS - 1) / HZ_BLOCK_QUADS;
+
+    hzQuadMin.assign(hzQuadsX * hzQuadsY, z);
+    hzQuadMax.assign(hzQuadsX * hzQuadsY, z);
+    hzBlockMin.assign(hzBlocksX * hzBlocksY, z);
+    hzBlockMax.assign(hzBlocksX * hzBlocksY, z);
+
+    hzValid = true;
+}
+
+void GPUEmulator::invalidateHZ(u32bit address, u32bit size)
+{
+    if (hzValid && (u64bit(address) < (u64bit(hzBufferAddress) + hzBufferSize)) &&
+        (u64bit(hzBufferAddress) < (u64bit(address) + size)))
+    {
+        GPU_DEBUG(
+            printf("Hierarchical Z invalidated by write to %08x size %d\n", address, size);
+        )
+
+        hzValid = false;
+    }
+}
+
+//  Checks if a z range fails the z test against all the z values in a [min, max] range.
+static bool hzRangeFails(CompareMode func, u32bit minZ, u32bit maxZ, u32bit hzMin, u32bit hzMax)
+{
+    switch(func)
+    {
+        case GPU_NEVER:
+            return true;
+        case GPU_LESS:
+            return (minZ >= hzMax);
+        case GPU_LEQUAL:
+            return (minZ > hzMax);
+        case GPU_EQUAL:
+            return (maxZ < hzMin) || (minZ > hzMax);
+        case GPU_GEQUAL:
+            return (maxZ < hzMin);
+        case GPU_GREATER:
+            return (maxZ <= hzMin);
+        default:
+            return false;
+    }
+}
+
+bool GPUEmulator::testHZ(ShadedFragment **quad)
+{
+    //  Culled fragments must not have other effects than failing the z test:  no stencil updates
+    //  and no depth computed by the shader.  Killed fragments are culled anyway.
+    //  In validation mode all the quads must reach the z stencil test so the z stencil update
+    //  log can be compared with the simulator log.
+    if (validationMode || !hzValid || !state.depthTest || state.stencilTest || state.modifyDepth)
+        return false;
+
+    s32bit x = quad[0]->getFragment()->getX();
+    s32bit y = quad[0]->getFragment()->getY();
+
+    if ((x < 0) || (y < 0))
+        return false;
+
+    u32bit qx = u32bit(x) >> 1;
+    u32bit qy = u32bit(y) >> 1;
+
+    if ((qx >= hzQuadsX) || (qy >= hzQuadsY))
+        return false;
+
+    //  Compute the z range of the fragments (samples) in the quad that reach the z test.
+    u32bit minZ = 0xffffffff;
+    u32bit maxZ = 0;
+    bool anyZ = false;
+
+    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+    {
+        Fragment *fr = quad[f]->getFragment();
+
+        if (!state.multiSampling)
+        {
+            if (!quad[f]->isCulled())
+            {
+                u32bit z = fr->getZ();
+                minZ = (z < minZ) ? z : minZ;
+                maxZ = (z > maxZ) ? z : maxZ;
+                anyZ = true;
+            }
+        }
+        else
+        {
+            //  The z test is performed on the covered samples.
+            u32bit *fragmentZSamples = fr->getMSAASamples();
+            bool *fragmentCoverage = fr->getMSAACoverage();
+
+            for(u32bit s = 0; s < state.msaaSamples; s++)
+            {
+                if (fragmentCoverage[s])
+                {
+                    minZ = (fragmentZSamples[s] < minZ) ? fragmentZSamples[s] : minZ;
+                    maxZ = (fragmentZSamples[s] > maxZ) ? fragmentZSamples[s] : maxZ;
+                    anyZ = true;
+                }
+            }
+        }
+    }
+
+    if (!anyZ)
+        return false;
+
+    hzTestedQuads++;
+
+    //  Test against the block (level 1).
+    u32bit block = (qy / HZ_BLOCK_QUADS) * hzBlocksX + (qx / HZ_BLOCK_QUADS);
+
+    if (hzRangeFails(state.depthFunction, minZ, maxZ, hzBlockMin[block], hzBlockMax[block]))
+    {
+        hzBlockCulledQuads++;
+        return true;
+    }
+
+    //  Test against the quad (level 0).
+    u32bit q = qy * hzQuadsX + qx;
+
+    if (hzRangeFails(state.depthFunction, minZ, maxZ, hzQuadMin[q], hzQuadMax[q]))
+    {
+        hzQuadCulledQuads++;
+        return true;
+    }
+
+    return false;
+}
+
+void GPUEmulator::updateHZ(s32bit x, s32bit y, u8bit *zStencilData)
+{
+    if ((x < 0) || (y < 0))
+        return;
+
+    u32bit qx = u32bit(x) >> 1;
+    u32bit qy = u32bit(y) >> 1;
+
+    if ((qx >= hzQuadsX) || (qy >= hzQuadsY))
+        return;
+
+    //  Compute the z range of all the samples in the quad.
+    u32bit minZ, maxZ, min, max;
+    FragmentOpEmulator::blockMinMaxZ((u32bit *) zStencilData, STAMP_FRAGMENTS * hzSamples, minZ, maxZ, min, max);
+
+    u32bit q = qy * hzQuadsX + qx;
+
+    if ((hzQuadMin[q] == minZ) && (hzQuadMax[q] == maxZ))
+        return;
+
+    hzQuadMin[q] = minZ;
+    hzQuadMax[q] = maxZ;
+
+    //  Recompute the z range of the block from the z range of its quads.
+    u32bit bx = qx / HZ_BLOCK_QUADS;
+    u32bit by = qy / HZ_BLOCK_QUADS;
+    u32bit endX = GPU_MIN((bx + 1) * HZ_BLOCK_QUADS, hzQuadsX);
+    u32bit endY = GPU_MIN((by + 1) * HZ_BLOCK_QUADS, hzQuadsY);
+
+    u32bit blockMin = 0x00ffffff;
+    u32bit blockMax = 0;
+
+    for(u32bit j = by * HZ_BLOCK_QUADS; j < endY; j++)
+    {
+        for(u32bit i = bx * HZ_BLOCK_QUADS; i < endX; i++)
+        {
+            blockMin = GPU_MIN(blockMin, hzQuadMin[j * hzQuadsX + i]);
+            blockMax = GPU_MAX(blockMax, hzQuadMax[j * hzQuadsX + i]);
+        }
+    }
+
+    hzBlockMin[by * hzBlocksX + bx] = blockMin;
+    hzBlockMax[by * hzBlocksX + bx] = blockMax;
+}
+
 void GPUEmulator::cleanup()
 {
     indexList.clear();
@@ -8814,6 +8421,27 @@ u32bit GPUEmulator::getTriangleCounter()
     return triangleCounter;
 }
 
+u64bit GPUEmulator::getFragmentCounter()
+{
+    return fragmentCounter;
+}
+
+void GPUEmulator::getHZStatistics(u64bit &tested, u64bit &blockCulled, u64bit &quadCulled)
+{
+    tested = hzTestedQuads;
+    blockCulled = hzBlockCulledQuads;
+    quadCulled = hzQuadCulledQuads;
+}
+
+void GPUEmulator::getClipStatistics(u64bit &clipped, u64bit &culled, u64bit &generated, u64bit &tilesBefore, u64bit &tilesAfter)
+{
+    clipped = clippedTriangles;
+    culled = clipCulledTriangles;
+    generated = clipGeneratedTriangles;
+    tilesBefore = clipTilesBefore;
+    tilesAfter = clipTilesAfter;
+}
+
 void GPUEmulator::setValidationMode(bool enable)
 {
     validationMode = enable;
@@ -8938,6 +8566,9 @@ void GPUEmulator::loadSnapshot()
     input.read((char *) sysMemory, simP.mem.mappedMemSize * 1024 * 1024);
     
     input.close();
+
+    //  The loaded z stencil buffer is unknown to the hierarchical Z.
+    hzValid = false;
 }
 
 //  Set skip draw call mode.
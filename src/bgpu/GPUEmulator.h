@@ -40,6 +40,7 @@
 //  Emulator classes.
 #include "ShaderEmulator.h"
 #include "RasterizerEmulator.h"
+#include "ClipperEmulator.h"
 #include "TextureEmulator.h"
 #include "FragmentOpEmulator.h"
 #include "PixelMapper.h"
@@ -137,6 +138,25 @@ private:
          */
          
         ShadedFragment(Fragment *fr, bool culled);
+
+        /**
+         *
+         *  Constructor.  Creates an empty shaded fragment to be reused with set().
+         *
+         */
+
+        ShadedFragment();
+
+        /**
+         *
+         *  Sets the fragment stored in the container.  The fragment attributes are not cleared.
+         *
+         *  @param fr Pointer to a Fragment object storing the fragment information.
+         *  @param culled A boolean storing if the fragment is culled.
+         *
+         */
+
+        void set(Fragment *fr, bool culled);
         
         /**
          *
@@ -180,8 +200,7 @@ private:
      *
      *  Implements a cache for compressed texture data.
      *
-     *  No replacement policy is implemented.  When the cache is full and a request to a new block
-     *  is issued the whole cache is flushed.
+     *  The cache stores decompressed blocks and is set associative with LRU replacement.
      *
      */
      
@@ -196,9 +215,15 @@ private:
         u32bit compressionRatioShift;       /**<  Defines the address shift due to the compression-decompression ratio.  */
         void (*decompressionFunction) (u8bit *, u8bit *, u32bit);   /**<  Pointer to the decompression function.  */
 
+        u32bit numWays;                     /**<  Number of ways (blocks per set) in the cache.  */
+        u32bit numSets;                     /**<  Number of sets in the cache.  */
+        u32bit blockSizeShift;              /**<  Log2 of the decompressed block size.  */
+
         u8bit *decompressedData;            /**<  Pointer to data array storing decompressed data.  */
-        map<u64bit, u8bit *> blockCache;    /**<  Maps addresses to data blocks in the decompressed data array.  */
-        u32bit cachedBlocks;                /**<  Stores the number of texture data blocks currently cached.  */
+        u64bit *blockTag;                   /**<  Address of the block stored in each cache block.  */
+        bool *blockValid;                   /**<  Stores if the cache block contains a valid block.  */
+        u32bit *blockLastUse;               /**<  Stores the last access (LRU) for each cache block.  */
+        u32bit accessCounter;               /**<  Counts the accesses to the cache, used to implement LRU.  */
 
     public:
 
@@ -207,6 +232,7 @@ private:
          *  Constructor.
          *
          *  @param blocks Defines the number of texture data blocks to keep in the cache.
+         *  @param ways Defines the number of ways (blocks per set) of the cache.
          *  @param blockSize Defines the size in bytes of a decompressed texture data block.
          *  @param blockMask Defines the address mask used to access data in decompressed texture data blocks.
          *  @param ratioShift Defines the address shift due to the compression-decompression ratio.
@@ -216,8 +242,16 @@ private:
          *
          */
          
-        CompressedTextureCache(GPUEmulator &emu, u32bit blocks, u32bit blockSize, u64bit blockMask, u32bit ratioShift,
+        CompressedTextureCache(GPUEmulator &emu, u32bit blocks, u32bit ways, u32bit blockSize, u64bit blockMask, u32bit ratioShift,
             void (*decompFunc) (u8bit *, u8bit *, u32bit));
+
+        /**
+         *
+         *  Destructor.
+         *
+         */
+
+        ~CompressedTextureCache();
          
         /**
          *
@@ -249,6 +283,7 @@ private:
     ShaderEmulator *shEmu;          /**<  Pointer to the shader emulator object.  */
     TextureEmulator *texEmu;        /**<  Pointer to the texture emulator object.  */
     RasterizerEmulator *rastEmu;    /**<  Pointer to the rasterization emulator object.  */
+    ClipperEmulator *clipEmu;       /**<  Pointer to the clipper emulator object.  */
     FragmentOpEmulator *fragEmu;    /**<  Pointer to the fragment operation (z, stencil, color, blend) emulator object.  */
 
     //  Memory arrays.
@@ -265,6 +300,40 @@ private:
 
     std::vector<u32bit> indexList;                  /**<  Stores the indices processed for the current draw call.  */
     std::map<u32bit, ShadedVertex*> vertexList;     /**<  Maps indices to vertices (and the associated attributes) for the current draw call.  */
+    ShadedFragment shadedStamp[STAMP_FRAGMENTS];    /**<  Shaded fragments for the quad being processed, reused for all the quads.  */
+
+    //  Hierarchical Z.
+    //
+    //  Two level min/max Z pyramid for the z stencil buffer.  Level 0 stores the minimum and maximum
+    //  z of each quad (all the samples of the 2x2 pixels) and level 1 the minimum and maximum z of each
+    //  block of HZ_BLOCK_QUADS x HZ_BLOCK_QUADS quads.  The pyramid is built on a z stencil buffer clear
+    //  and kept exact on z writes.  It is invalidated when the z stencil buffer may be modified
+    //  through other paths (memory writes, blits, aliased render targets) or its layout changes.
+    //
+    static const u32bit HZ_BLOCK_QUADS = 4;         /**<  Width and height in quads of a level 1 block.  */
+    bool hzValid;                                   /**<  Flag that stores if the hierarchical Z content matches the z stencil buffer.  */
+    u32bit hzBufferAddress;                         /**<  Address of the z stencil buffer covered by the hierarchical Z.  */
+    u32bit hzBufferSize;                            /**<  Size in bytes of the z stencil buffer covered by the hierarchical Z.  */
+    u32bit hzResX;                                  /**<  Horizontal resolution of the z stencil buffer covered by the hierarchical Z.  */
+    u32bit hzResY;                                  /**<  Vertical resolution of the z stencil buffer covered by the hierarchical Z.  */
+    u32bit hzSamples;                               /**<  Samples per pixel of the z stencil buffer covered by the hierarchical Z.  */
+    u32bit hzQuadsX;                                /**<  Width in quads of the level 0.  */
+    u32bit hzQuadsY;                                /**<  Height in quads of the level 0.  */
+    u32bit hzBlocksX;                               /**<  Width in blocks of the level 1.  */
+    std::vector<u32bit> hzQuadMin;                  /**<  Minimum z for each quad (level 0).  */
+    std::vector<u32bit> hzQuadMax;                  /**<  Maximum z for each quad (level 0).  */
+    std::vector<u32bit> hzBlockMin;                 /**<  Minimum z for each block of quads (level 1).  */
+    std::vector<u32bit> hzBlockMax;                 /**<  Maximum z for each block of quads (level 1).  */
+    u64bit hzTestedQuads;                           /**<  Number of quads tested against the hierarchical Z.  */
+    u64bit hzBlockCulledQuads;                      /**<  Number of quads culled by the hierarchical Z level 1 (block).  */
+    u64bit hzQuadCulledQuads;                       /**<  Number of quads culled by the hierarchical Z level 0 (quad).  */
+
+    //  Clipping statistics.
+    u64bit clippedTriangles;                        /**<  Number of triangles clipped against the clip planes.  */
+    u64bit clipCulledTriangles;                     /**<  Number of triangles removed by clipping against the clip planes.  */
+    u64bit clipGeneratedTriangles;                  /**<  Number of triangles generated by clipping.  */
+    u64bit clipTilesBefore;                         /**<  Bounding box scan tiles of the clipped triangles before clipping.  */
+    u64bit clipTilesAfter;                          /**<  Bounding box scan tiles of the triangles generated by clipping.  */
 
     //  Caches for compressed texture data.
     
@@ -294,6 +363,7 @@ private:
     u32bit frameCounter;        /**<  Stores the current frame number.  */
     u32bit batchCounter;        /**<  Stores the current draw call (batch) number.  */
     u32bit triangleCounter;     /**<  Stores the number of triangles processed in the current draw call.  */
+    u64bit fragmentCounter;     /**<  Stores the number of fragments shaded since the start of the emulation.  */
 
     bool abortEmulation;        /**<  Flag that stores if the emulation must be aborted due to an 'external' event.  */
     
@@ -437,6 +507,33 @@ public:
      *
      */
     void emulateRasterization(ShadedVertex *vertex1, ShadedVertex *vertex2, ShadedVertex *vertex3);
+
+    /**
+     *
+     *  Rasterizes a triangle.
+     *
+     *  Performs triangle setup and culling, generates fragments and processes them for a single
+     *  triangle that was not rejected or already clipped.
+     *
+     *  @param attribV1 Pointer to the attributes of the triangle first vertex.
+     *  @param attribV2 Pointer to the attributes of the triangle second vertex.
+     *  @param attribV3 Pointer to the attributes of the triangle third vertex.
+     *
+     */
+    void rasterizeTriangle(QuadFloat *attribV1, QuadFloat *attribV2, QuadFloat *attribV3);
+
+    /**
+     *
+     *  Computes the number of scan tiles covered by the bounding box of a triangle in the viewport.
+     *
+     *  @param attribV1 Pointer to the attributes of the triangle first vertex.
+     *  @param attribV2 Pointer to the attributes of the triangle second vertex.
+     *  @param attribV3 Pointer to the attributes of the triangle third vertex.
+     *
+     *  @return The number of scan tiles covered by the triangle bounding box.
+     *
+     */
+    u64bit boundingBoxTiles(QuadFloat *attribV1, QuadFloat *attribV2, QuadFloat *attribV3);
     
     /**
      *
@@ -489,6 +586,53 @@ public:
      */
 
     void emulateZStencilTest(ShadedFragment **quad);
+
+    /**
+     *
+     *  Builds the hierarchical Z for the current z stencil buffer setting all the levels to a z value.
+     *
+     *  @param z The z value stored in the whole z stencil buffer.
+     *
+     */
+
+    void resetHZ(u32bit z);
+
+    /**
+     *
+     *  Invalidates the hierarchical Z if a memory region overlaps the z stencil buffer covered by
+     *  the hierarchical Z.
+     *
+     *  @param address Start address of the memory region.
+     *  @param size Size in bytes of the memory region.
+     *
+     */
+
+    void invalidateHZ(u32bit address, u32bit size);
+
+    /**
+     *
+     *  Checks if all the fragments in a quad fail the z test against the hierarchical Z.
+     *
+     *  @param quad Pointer to an array of ShadedFragment containers storing the data associated with
+     *  the 2x2 fragment tile to test.
+     *
+     *  @return If the quad can be culled before fragment shading.
+     *
+     */
+
+    bool testHZ(ShadedFragment **quad);
+
+    /**
+     *
+     *  Updates the hierarchical Z with the z stencil buffer content of a quad after a z write.
+     *
+     *  @param x Horizontal coordinate of the top left fragment of the quad.
+     *  @param y Vertical coordinate of the top left fragment of the quad.
+     *  @param zStencilData Pointer to the z stencil buffer data for the quad.
+     *
+     */
+
+    void updateHZ(s32bit x, s32bit y, u8bit *zStencilData);
     
     /**
      *
@@ -895,6 +1039,42 @@ public:
      */
      
      u32bit getTriangleCounter();
+
+    /**
+     *
+     *  Get the number of fragments shaded since the start of the emulation.
+     *
+     *  @return The number of shaded fragments (including the fragments in partially covered quads).
+     *
+     */
+
+    u64bit getFragmentCounter();
+
+    /**
+     *
+     *  Get the hierarchical Z statistics since the start of the emulation.
+     *
+     *  @param tested Reference to a variable where to store the number of quads tested against the hierarchical Z.
+     *  @param blockCulled Reference to a variable where to store the number of quads culled by the level 1 (block).
+     *  @param quadCulled Reference to a variable where to store the number of quads culled by the level 0 (quad).
+     *
+     */
+
+    void getHZStatistics(u64bit &tested, u64bit &blockCulled, u64bit &quadCulled);
+
+    /**
+     *
+     *  Get the clipping statistics since the start of the emulation.
+     *
+     *  @param clipped Reference to a variable where to store the number of triangles clipped against the clip planes.
+     *  @param culled Reference to a variable where to store the number of triangles removed by clipping.
+     *  @param generated Reference to a variable where to store the number of triangles generated by clipping.
+     *  @param tilesBefore Reference to a variable where to store the bounding box scan tiles of the clipped triangles.
+     *  @param tilesAfter Reference to a variable where to store the bounding box scan tiles of the generated triangles.
+     *
+     */
+
+    void getClipStatistics(u64bit &clipped, u64bit &culled, u64bit &generated, u64bit &tilesBefore, u64bit &tilesAfter);
      
      /**
       *
@@ -28,6 +28,7 @@
 #include "AGPTraceDriver.h"
 #include "ColorCompressorEmulator.h"
 #include "DepthCompressorEmulator.h"
+#include "FrameDumpWriter.h"
 #include "StatisticsManager.h"
 #include "support.h"
 #include <ctime>
@@ -67,6 +68,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
     ColorCompressorEmulator::configureCompressor(simP.cwr.comprAlgo);
     DepthCompressorEmulator::configureCompressor(simP.zst.comprAlgo);
 
+    //  Configure the color, depth and stencil dumps.
+    FrameDumpWriter::getInstance().setOptions(simP.frameDumpPNG, simP.asyncFrameDump);
+
     // Notify boxes when the specific signal trace code is required.
     // Allows optimization in boxes with several inner signals only used to
     // show STV information
@@ -261,6 +265,7 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
         simP.mem.memSize,                               //  GPU Memory Size.
         simP.com.pipelinedBatches,                      //  Enable/disable pipelined batch rendering.
         simP.com.dumpShaderPrograms,                    //  Enable/disable dumping shader programs to files.
+        simP.com.filterRegisterWrites,                  //  Enable/disable filtering redundant register writes.
         "CommandProc", NULL);
 
     //  Add Command Processor box to the box array.
@@ -430,6 +435,8 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
         simP.clp.startLatency,      //  Start latency for triangle clipping.
         simP.clp.execLatency,       //  Triangle clipping latency.
         simP.clp.clipBufferSize,    //  Clipped triangle buffer size.
+        simP.clp.frustumClipping,   //  Clip the triangles against the near and far planes and the guard band.
+        simP.clp.guardBand,         //  Guard band size relative to the viewport.
         simP.ras.setupStartLat,     //  Start latency of the triangle setup units.
         simP.ras.trInputLat,        //  Latency of the triangle bus with Triangle Setup.
         "Clipper", NULL);
@@ -450,7 +457,8 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
         simP.ras.genWidth,              //  Generation tile width in fragments.
         simP.ras.genHeight,             //  Generation tile width in fragments.
         simP.ras.useBBOptimization,     //  Use the Bounding Box optimization pass (micropolygon rasterizer).
-        simP.ras.subPixelPrecision      //  Precision bits for the decimal part of subpixel operations (micropolygon rasterizer).
+        simP.ras.subPixelPrecision,     //  Precision bits for the decimal part of subpixel operations (micropolygon rasterizer).
+        simP.ras.simdStampKernel        //  Use the SIMD kernel to evaluate subtiles, stamps and MSAA samples.
         );
     
     u32bit threadGroup;  //  Set to the number of shader elements processed together and that must
@@ -503,6 +511,7 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             simP.ras.hzBufferSize,          //  Size of the HZ Buffer Level 0.
             simP.ras.hzCacheLines,          //  Lines in the HZ cache.
             simP.ras.hzCacheLineSize,       //  Blocks in a HZ cache line.
+            simP.ras.hzCacheWays,           //  Ways of the HZ cache.
             simP.ras.earlyZQueueSz,         //  Size of the early HZ test stamp queue.
             simP.ras.hzAccessLatency,       //  Access latency to the HZ Buffer Level 0.
             simP.ras.hzUpdateLatency,       //  Hierarchical Update signal latency.
@@ -592,7 +601,8 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             simP.ras.scanWidth,             //  Scan tile width (pixels).
             simP.ras.scanHeight,            //  Scan tile height (pixels).
             simP.ras.genWidth,              //  Generation tile width (pixels).
-            simP.ras.genHeight              //  Generation tile height (pixels).
+            simP.ras.genHeight,             //  Generation tile height (pixels).
+            simP.fsh.samplerKernels         //  Use the specialized texel conversions.
             );
 
         //  Creat Emulator name.
@@ -786,6 +796,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             boxArray.push_back(textUnit[i * simP.fsh.textureUnits + j]);
             if (multiClock)
                 gpuDomainBoxes.push_back(textUnit[i * simP.fsh.textureUnits + j]);
+
+            //  The register writes for the Texture Units are read from the Command Processor shared register file.
+            textUnit[i * simP.fsh.textureUnits + j]->setSharedRegisters(&commProc->getSharedRegisters());
         }
     }
 
@@ -908,6 +921,10 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
         boxArray.push_back(colorWriteV2[i]);
         if (multiClock)
             gpuDomainBoxes.push_back(colorWriteV2[i]);
+
+        //  The register writes for the stamp units are read from the Command Processor shared register file.
+        zStencilV2[i]->setSharedRegisters(&commProc->getSharedRegisters(), SharedRegisterFile::ZSTENCIL_UNITS);
+        colorWriteV2[i]->setSharedRegisters(&commProc->getSharedRegisters(), SharedRegisterFile::COLORWRITE_UNITS);
     }
 
     //  Create DAC box.
@@ -940,6 +957,38 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
     boxArray.push_back(dac);
     if (multiClock)
         gpuDomainBoxes.push_back(dac);
+
+    //  Define the box profiler entries in the same order the boxes are clocked.
+    if (!multiClock)
+    {
+        gpuDomainEntries = 0;
+        for(i = 0; i < boxArray.size(); i++)
+            boxProfiler.addEntry(boxArray[i]->getName(), GPU_CLOCK_DOMAIN);
+    }
+    else
+    {
+        gpuDomainEntries = 0;
+        for(i = 0; i < gpuDomainBoxes.size(); i++)
+            boxProfiler.addEntry(gpuDomainBoxes[i]->getName(), GPU_CLOCK_DOMAIN);
+
+        shaderGPUEntries = gpuDomainEntries + gpuDomainBoxes.size();
+        for(i = 0; i < shaderDomainBoxes.size(); i++)
+            boxProfiler.addEntry(shaderDomainBoxes[i]->getName(), GPU_CLOCK_DOMAIN);
+
+        memoryGPUEntries = shaderGPUEntries + shaderDomainBoxes.size();
+        for(i = 0; i < memoryDomainBoxes.size(); i++)
+            boxProfiler.addEntry(memoryDomainBoxes[i]->getName(), GPU_CLOCK_DOMAIN);
+
+        shaderDomainEntries = memoryGPUEntries + memoryDomainBoxes.size();
+        for(i = 0; i < shaderDomainBoxes.size(); i++)
+            boxProfiler.addEntry(shaderDomainBoxes[i]->getName(), SHADER_CLOCK_DOMAIN);
+
+        memoryDomainEntries = shaderDomainEntries + shaderDomainBoxes.size();
+        for(i = 0; i < memoryDomainBoxes.size(); i++)
+            boxProfiler.addEntry(memoryDomainBoxes[i]->getName(), MEMORY_CLOCK_DOMAIN);
+    }
+
+    boxProfiler.setEnabled(simP.profileBoxes);
         
     //  Check that all the signals are well defined.
     if (!sigBinder.checkSignalBindings())
@@ -977,6 +1026,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
         //  Set statistics rate 
         GPUStatistics::StatisticsManager::instance().setDumpScheduling(0, simP.statsRate);
 
+        //  Set the format of the statistics files.
+        GPUStatistics::StatisticsManager::instance().setBinaryOutput(simP.binaryStatistics);
+
         //  Check if per cycle statistics are enabled
         if (simP.perCycleStatistics)
         {
@@ -986,6 +1038,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             if (!out.is_open())
                 panic("GPUSimulator", "GPUSimulator", "Error opening per cycle statistics file");
 
+            if (!simP.compressStatistics)
+                out.setcompression(Z_NO_COMPRESSION, Z_DEFAULT_STRATEGY);
+
             GPUStatistics::StatisticsManager::instance().setOutputStream(out);
         }
 
@@ -997,6 +1052,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             if (!outFrame.is_open())
                 panic("GPUSimulator", "GPUSimulator", "Error opening per frame statistics file");
 
+            if (!simP.compressStatistics)
+                outFrame.setcompression(Z_NO_COMPRESSION, Z_DEFAULT_STRATEGY);
+
             GPUStatistics::StatisticsManager::instance().setPerFrameStream(outFrame);
         }
 
@@ -1008,6 +1066,9 @@ GPUSimulator::GPUSimulator(SimParameters simP, TraceDriverInterface *trDriver, b
             if (!outBatch.is_open())
                 panic("GPUSimulator", "GPUSimulator", "Error opening per batch statistics file");
 
+            if (!simP.compressStatistics)
+                outBatch.setcompression(Z_NO_COMPRESSION, Z_DEFAULT_STRATEGY);
+
             GPUStatistics::StatisticsManager::instance().setPerBatchStream(outBatch);
         }
     }
@@ -1340,6 +1401,8 @@ void GPUSimulator::debugLoop(bool validate)
             loadSnapshotCommand(lineStream);
         else if (!command.compare("autosnapshot"))
             autoSnapshotCommand(lineStream);
+        else if (!command.compare("profile"))
+            profileCommand(lineStream);
         else
             cout << "Unsupported command." << endl;
     }
@@ -1371,6 +1434,7 @@ void GPUSimulator::helpCommand(stringstream &comStream)
     cout << "savesnapshot  - Saves a snapshot of the GPU state to disk" << endl;
     cout << "loadsnapshot  - Loads a snapshot of the GPU state from disk" << endl;
     cout << "autosnapshot  - Sets automatic snapshot saves" << endl;
+    cout << "profile       - Enables/disables/resets/reports the host time spent simulating each box" << endl;
     cout << "memoryUsage   - Displays information about the memory used" << endl;
     cout << "listMDs       - Lists the memory descriptors in the GPU Driver" << endl;
     cout << "infoMD        - Displays the information about a memory descriptor" << endl;
@@ -2947,6 +3011,134 @@ void GPUSimulator::autoSnapshotCommand(stringstream &comStream)
     }
 }
 
+void GPUSimulator::profileCommand(stringstream &comStream)
+{
+    string paramStr;
+
+    // Skip white spaces.
+    comStream >> ws;
+
+    comStream >> paramStr;
+
+    comStream >> ws;
+
+    if (!comStream.eof())
+        paramStr.clear();
+
+    if (!paramStr.compare("on"))
+    {
+        cout << "Enabling box profiling." << endl;
+        boxProfiler.setEnabled(true);
+    }
+    else if (!paramStr.compare("off"))
+    {
+        cout << "Disabling box profiling." << endl;
+        boxProfiler.setEnabled(false);
+    }
+    else if (!paramStr.compare("reset"))
+        boxProfiler.reset();
+    else if (!paramStr.compare("report"))
+        boxProfiler.report(cout);
+    else
+        cout << "Usage: profile <on|off|reset|report>" << endl;
+}
+
+void GPUSimulator::clockBoxes(u64bit cycle)
+{
+    if (!boxProfiler.isEnabled())
+    {
+        for(u32bit box = 0; box < boxArray.size(); box++)
+            boxArray[box]->clock(cycle);
+    }
+    else
+    {
+        u64bit ticks = BoxProfiler::readTicks();
+
+        for(u32bit box = 0; box < boxArray.size(); box++)
+        {
+            boxArray[box]->clock(cycle);
+            ticks = boxProfiler.sample(gpuDomainEntries + box, ticks);
+        }
+    }
+}
+
+void GPUSimulator::clockGPUDomain(u64bit cycle)
+{
+    if (!boxProfiler.isEnabled())
+    {
+        // Clock all the boxes in the GPU Domain.
+        for(u32bit box = 0; box < gpuDomainBoxes.size(); box++)
+            gpuDomainBoxes[box]->clock(cycle);
+
+        //  Clock boxes with multiple domains.
+        for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
+            shaderDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, cycle);
+
+        for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
+            memoryDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, cycle);
+    }
+    else
+    {
+        u64bit ticks = BoxProfiler::readTicks();
+
+        for(u32bit box = 0; box < gpuDomainBoxes.size(); box++)
+        {
+            gpuDomainBoxes[box]->clock(cycle);
+            ticks = boxProfiler.sample(gpuDomainEntries + box, ticks);
+        }
+
+        for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
+        {
+            shaderDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, cycle);
+            ticks = boxProfiler.sample(shaderGPUEntries + box, ticks);
+        }
+
+        for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
+        {
+            memoryDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, cycle);
+            ticks = boxProfiler.sample(memoryGPUEntries + box, ticks);
+        }
+    }
+}
+
+void GPUSimulator::clockShaderDomain(u64bit cycle)
+{
+    if (!boxProfiler.isEnabled())
+    {
+        for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
+            shaderDomainBoxes[box]->clock(SHADER_CLOCK_DOMAIN, cycle);
+    }
+    else
+    {
+        u64bit ticks = BoxProfiler::readTicks();
+
+        for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
+        {
+            shaderDomainBoxes[box]->clock(SHADER_CLOCK_DOMAIN, cycle);
+            ticks = boxProfiler.sample(shaderDomainEntries + box, ticks);
+        }
+    }
+}
+
+void GPUSimulator::clockMemoryDomain(u64bit cycle)
+{
+    if (!boxProfiler.isEnabled())
+    {
+        for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
+            memoryDomainBoxes[box]->clock(MEMORY_CLOCK_DOMAIN, cycle);
+    }
+    else
+    {
+        u64bit ticks = BoxProfiler::readTicks();
+
+        for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
+        {
+            memoryDomainBoxes[box]->clock(MEMORY_CLOCK_DOMAIN, cycle);
+            ticks = boxProfiler.sample(memoryDomainEntries + box, ticks);
+        }
+    }
+}
+
 void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTrace, bool &gpuStalled, bool &validationError)
 {
     current = this;
@@ -2959,8 +3151,7 @@ void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTr
         cyclesCounter->inc();
         
         //  Issue a clock for all the simulation boxes.
-        for(u32bit box = 0; box < boxArray.size(); box++)
-            boxArray[box]->clock(cycle);
+        clockBoxes(cycle);
         
         //  Update the simulator cycle counter.
         cycle++;
@@ -2994,15 +3185,7 @@ void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTr
                 )
                 
                 // Clock all the boxes in the GPU Domain.
-                for(u32bit box = 0; box < gpuDomainBoxes.size(); box++)
-                    gpuDomainBoxes[box]->clock(gpuCycle);
-                    
-                //  Clock boxes with multiple domains.
-                for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
-                    shaderDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, gpuCycle);
-                    
-                for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
-                    memoryDomainBoxes[box]->clock(GPU_CLOCK_DOMAIN, gpuCycle);
+                clockGPUDomain(gpuCycle);
 
                 //  Update GPU domain clock state.
                 gpuCycle++;
@@ -3022,8 +3205,7 @@ void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTr
                     )
 
                     //  Clock boxes with multiple domains.
-                    for(u32bit box = 0; box < shaderDomainBoxes.size(); box++)
-                        shaderDomainBoxes[box]->clock(SHADER_CLOCK_DOMAIN, shaderCycle);
+                    clockShaderDomain(shaderCycle);
 
                     //  Update shader domain clock and step counter.
                     shaderCycle++;
@@ -3042,8 +3224,7 @@ void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTr
                     )
 
                     //  Clock boxes with multiple domains.
-                    for(u32bit box = 0; box < memoryDomainBoxes.size(); box++)
-                        memoryDomainBoxes[box]->clock(MEMORY_CLOCK_DOMAIN, memoryCycle);
+                    clockMemoryDomain(memoryCycle);
 
                     //  Update memory domain clock and step counter.
                     memoryCycle++;
@@ -3060,6 +3241,9 @@ void GPUSimulator::advanceTime(bool &endOfBatch, bool &endOfFrame, bool &endOfTr
     //  Check if the current batch has finished
     if (commProc->endOfBatch())
     {
+        //  Update the box profile for the batch.
+        boxProfiler.endBatch(batchCounter);
+
         //  Update rendered batches counter.
         batchCounter++;
         
@@ -3945,6 +4129,9 @@ itVertexInput->second.timesRead, itVertexInput->second.differencesBetweenReads ?
     //  Check if the current frame has finished.
     if (commProc->isSwap())
     {
+        //  Update the box profile for the frame.
+        boxProfiler.endFrame(frameCounter);
+
         //  Update rendered frames counter.
         frameCounter++;
 
@@ -4130,8 +4317,7 @@ void GPUSimulator::simulationLoop()
         cyclesCounter->inc();
         
         // Clock all the boxes.
-        for(i = 0; i < boxArray.size(); i++)
-            boxArray[i]->clock(cycle);
+        clockBoxes(cycle);
 
         //  Check if statistics generation is active.
         if (simP.statistics)
@@ -4157,6 +4343,9 @@ void GPUSimulator::simulationLoop()
         //  Check end of batch event.
         if (commProc->endOfBatch())
         {
+            //  Update the box profile for the batch.
+            boxProfiler.endBatch(batchCounter);
+
             //  Update rendered batches counter.
             batchCounter++;
             
@@ -4178,6 +4367,9 @@ void GPUSimulator::simulationLoop()
                 dumpLatencyMap(width, height);
             }
 
+            //  Update the box profile for the frame.
+            boxProfiler.endFrame(frameCounter);
+
             //  Update frame counter.
             frameCounter++;
 
@@ -4283,7 +4475,13 @@ void GPUSimulator::simulationLoop()
         sigBinder.endSignalTrace();
     }
 
+    //  Report the host time spent per box.
+    if (boxProfiler.isEnabled())
+        boxProfiler.report(cout);
+
     OptimizedDynamicMemory::usage();
+    printf("Dynamic object allocations = %lld (%.2f per cycle)\n", OptimizedDynamicMemory::getAllocations(),
+        (cycle == 0) ? 0.0 : f64bit(OptimizedDynamicMemory::getAllocations()) / f64bit(cycle));
     GPUStatistics::StatisticsManager::instance().finish();
 
     //OptimizedDynamicMemory::dumpDynamicMemoryState(FALSE, FALSE);
@@ -4336,15 +4534,7 @@ void GPUSimulator::multiClockSimLoop()
             )
 
             // Clock all the boxes in the GPU Domain.
-            for(i = 0; i < gpuDomainBoxes.size(); i++)
-                gpuDomainBoxes[i]->clock(gpuCycle);
-                
-            //  Clock boxes with multiple domains.
-            for(i = 0; i < shaderDomainBoxes.size(); i++)
-                shaderDomainBoxes[i]->clock(GPU_CLOCK_DOMAIN, gpuCycle);
-
-            for(i = 0; i < memoryDomainBoxes.size(); i++)
-                memoryDomainBoxes[i]->clock(GPU_CLOCK_DOMAIN, gpuCycle);
+            clockGPUDomain(gpuCycle);
 
             //  Update cycle counter statistic.
             cyclesCounter->inc();
@@ -4374,6 +4564,9 @@ void GPUSimulator::multiClockSimLoop()
             //  Check end of batch event.
             if (commProc->endOfBatch())
             {
+                //  Update the box profile for the batch.
+                boxProfiler.endBatch(batchCounter);
+
                 //  Update rendered batches counter.
                 batchCounter++;
                 
@@ -4395,6 +4588,9 @@ void GPUSimulator::multiClockSimLoop()
                     dumpLatencyMap(width, height);
                 }
 
+                //  Update the box profile for the frame.
+                boxProfiler.endFrame(frameCounter);
+
                 //  Update frame counter.
                 frameCounter++;
                 
@@ -4516,8 +4712,7 @@ void GPUSimulator::multiClockSimLoop()
                 )
 
                 //  Clock boxes with multiple domains.
-                for(i = 0; i < shaderDomainBoxes.size(); i++)
-                    shaderDomainBoxes[i]->clock(SHADER_CLOCK_DOMAIN, shaderCycle);
+                clockShaderDomain(shaderCycle);
 
                 //  Update shader domain clock and step counter.
                 shaderCycle++;
@@ -4536,8 +4731,7 @@ void GPUSimulator::multiClockSimLoop()
                 )
                 
                 //  Clock boxes with multiple domains.
-                for(i = 0; i < memoryDomainBoxes.size(); i++)
-                    memoryDomainBoxes[i]->clock(MEMORY_CLOCK_DOMAIN, memoryCycle);
+                clockMemoryDomain(memoryCycle);
 
                 //  Update memory domain clock and step counter.
                 memoryCycle++;
@@ -4568,7 +4762,13 @@ void GPUSimulator::multiClockSimLoop()
     //    sigBinder.endSignalTrace();
     //}
 
+    //  Report the host time spent per box.
+    if (boxProfiler.isEnabled())
+        boxProfiler.report(cout);
+
     OptimizedDynamicMemory::usage();
+    printf("Dynamic object allocations = %lld (%.2f per GPU cycle)\n", OptimizedDynamicMemory::getAllocations(),
+        (gpuCycle == 0) ? 0.0 : f64bit(OptimizedDynamicMemory::getAllocations()) / f64bit(gpuCycle));
     GPUStatistics::StatisticsManager::instance().finish();
 
     //OptimizedDynamicMemory::dumpDynamicMemoryState(FALSE, FALSE);
@@ -34,6 +34,7 @@
 #include "StatisticsManager.h"
 #include "SignalBinder.h"
 #include "OptimizedDynamicMemory.h"
+#include "BoxProfiler.h"
 
 //  Emulators.
 #include "ShaderEmulator.h"
@@ -146,6 +147,13 @@ private:
     std::vector<MultiClockBox*> shaderDomainBoxes;  /**<  Stores a pointer to all the boxes with GPU and shader clock domain (multiple domains).  */
     std::vector<MultiClockBox*> memoryDomainBoxes;  /**<  Stores a pointer to all the boxes with GPU and memory clock domain (multiple domains).  */
 
+    BoxProfiler boxProfiler;        /**<  Measures the host time spent simulating each box.  */
+    u32bit gpuDomainEntries;        /**<  First box profiler entry for the boxes in the GPU clock domain.  */
+    u32bit shaderGPUEntries;        /**<  First box profiler entry for the GPU clock domain of the boxes with a shader clock domain.  */
+    u32bit memoryGPUEntries;        /**<  First box profiler entry for the GPU clock domain of the boxes with a memory clock domain.  */
+    u32bit shaderDomainEntries;     /**<  First box profiler entry for the shader clock domain.  */
+    u32bit memoryDomainEntries;     /**<  First box profiler entry for the memory clock domain.  */
+
     GPUStatistics::Statistic *cyclesCounter;    /**<  Pointer to GPU statistic used to count the number of simulated cycles (main clock domain!).  */
 
     gzofstream out;             /**<  Compressed stream output file for statistics.  */
@@ -183,6 +191,47 @@ private:
      */
     
     void saveSimConfig();
+
+    /**
+     *
+     *  Clocks all the boxes of a single clock architecture.
+     *
+     *  @param cycle Current simulation cycle.
+     *
+     */
+
+    void clockBoxes(u64bit cycle);
+
+    /**
+     *
+     *  Clocks the boxes in the GPU clock domain of a multi-clock architecture, including the
+     *  GPU clock domain of the boxes with multiple clock domains.
+     *
+     *  @param cycle Current GPU domain cycle.
+     *
+     */
+
+    void clockGPUDomain(u64bit cycle);
+
+    /**
+     *
+     *  Clocks the boxes in the shader clock domain of a multi-clock architecture.
+     *
+     *  @param cycle Current shader domain cycle.
+     *
+     */
+
+    void clockShaderDomain(u64bit cycle);
+
+    /**
+     *
+     *  Clocks the boxes in the memory clock domain of a multi-clock architecture.
+     *
+     *  @param cycle Current memory domain cycle.
+     *
+     */
+
+    void clockMemoryDomain(u64bit cycle);
     
 public:
 
@@ -421,6 +470,19 @@ public:
 
     void autoSnapshotCommand(stringstream &streamCom);
 
+    /**
+     *
+     *  Implements the 'profile' command of the GPU simulator integrated debugger.
+     *
+     *  The 'profile' command enables, disables, resets or reports the host time spent simulating
+     *  each box.
+     *
+     *  @param streamCom A reference to a stringstream object storing the line with the debug command and parameters.
+     *
+     */
+
+    void profileCommand(stringstream &streamCom);
+
     //  Debug commands associated with the GPU Driver
 
     /**
@@ -34,10 +34,22 @@
 #include "AGPTraceDriver.h"
 #include "GLTraceDriver.h"
 #include "D3DTraceDriver.h"
+#include "ThreadedTraceDriver.h"
 
 #include <ctime>
 #include <new>
 #include <signal.h>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <cerrno>
+
+#ifndef WIN32
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+#endif
 
 using namespace std;
 using namespace gpu3d;
@@ -45,6 +57,7 @@ using namespace gpu3d;
 //  Trace reader+driver.
 TraceDriverInterface *trDriver;
 AGPTraceDriver *agpTraceDriver;
+ThreadedTraceDriver *threadedTrDriver = NULL;
 
 bool d3d9Trace = false;
 bool oglTrace = false;
@@ -61,6 +74,24 @@ u32bit memoryClockPeriod;   //  Period of the memory clock in picoseconds (ps):
 
 GPUSimulator *gpuSimulator;
 
+char *batchDecodeFile = NULL;   //  AGP transaction trace file to write when the process decodes the trace for a batch run.
+
+#ifndef WIN32
+vector<string> batchTraceFiles; //  AGP transaction trace files decoded for a batch run.
+pid_t batchProcess = 0;         //  Process running the batch, the one removing the decoded trace files.
+
+//  Removes the AGP transaction traces decoded for a batch run when the batch process exits.
+static void removeBatchTraceFiles()
+{
+    //  The trace decoding and simulation processes inherit the exit handler.
+    if (getpid() != batchProcess)
+        return;
+
+    for(u32bit f = 0; f < batchTraceFiles.size(); f++)
+        unlink(batchTraceFiles[f].c_str());
+}
+#endif
+
 //  Signal handler for abort signal in debug mode
 void gpu3d::abortSignalHandler(int s)
 {
@@ -155,30 +186,384 @@ bool gpu3d::has_extension(const string file_name, const string extension) {
     }
 }
 
-bool gpu3d::checkAGPTraceParameters(AGPTraceFileHeader *agpTraceHeader)
+//  Checks the parameters stored in an AGP transaction trace header against a simulator configuration.
+static bool matchAGPTraceParameters(const SimParameters &p, AGPTraceFileHeader *agpTraceHeader)
 {
-    bool allParamsOK = (simP.mem.memSize == agpTraceHeader->parameters.memSize) &&
-                       (simP.mem.mappedMemSize == agpTraceHeader->parameters.mappedMemSize) &&
-                       (simP.fsh.textBlockDim == agpTraceHeader->parameters.textBlockDim) &&
-                       (simP.fsh.textSBlockDim == agpTraceHeader->parameters.textSBlockDim) &&
-                       (simP.ras.scanWidth == agpTraceHeader->parameters.scanWidth) &&
-                       (simP.ras.scanHeight == agpTraceHeader->parameters.scanHeight) &&
-                       (simP.ras.overScanWidth == agpTraceHeader->parameters.overScanWidth) &&
-                       (simP.ras.overScanHeight == agpTraceHeader->parameters.overScanHeight) &&
-                       (simP.doubleBuffer == agpTraceHeader->parameters.doubleBuffer) &&
-                       (simP.fsh.fetchRate == agpTraceHeader->parameters.fetchRate) &&
-                       (simP.mem.memoryControllerV2 == agpTraceHeader->parameters.memoryControllerV2) &&
-                       (simP.mem.v2SecondInterleaving == agpTraceHeader->parameters.v2SecondInterleaving);
+    bool allParamsOK = (p.mem.memSize == agpTraceHeader->parameters.memSize) &&
+                       (p.mem.mappedMemSize == agpTraceHeader->parameters.mappedMemSize) &&
+                       (p.fsh.textBlockDim == agpTraceHeader->parameters.textBlockDim) &&
+                       (p.fsh.textSBlockDim == agpTraceHeader->parameters.textSBlockDim) &&
+                       (p.ras.scanWidth == agpTraceHeader->parameters.scanWidth) &&
+                       (p.ras.scanHeight == agpTraceHeader->parameters.scanHeight) &&
+                       (p.ras.overScanWidth == agpTraceHeader->parameters.overScanWidth) &&
+                       (p.ras.overScanHeight == agpTraceHeader->parameters.overScanHeight) &&
+                       (p.doubleBuffer == agpTraceHeader->parameters.doubleBuffer) &&
+                       (p.fsh.fetchRate == agpTraceHeader->parameters.fetchRate) &&
+                       (p.mem.memoryControllerV2 == agpTraceHeader->parameters.memoryControllerV2) &&
+                       (p.mem.v2SecondInterleaving == agpTraceHeader->parameters.v2SecondInterleaving);
 
     return allParamsOK;
 }
 
+bool gpu3d::checkAGPTraceParameters(AGPTraceFileHeader *agpTraceHeader)
+{
+    return matchAGPTraceParameters(simP, agpTraceHeader);
+}
+
+//  Checks if two simulator configurations generate the same AGP transactions from an API trace:  the
+//  trace library and GPU driver parameters are the same.
+static bool sameDriverParameters(const SimParameters &a, const SimParameters &b)
+{
+    return (a.mem.memSize == b.mem.memSize) &&
+           (a.mem.mappedMemSize == b.mem.mappedMemSize) &&
+           (a.fsh.textBlockDim == b.fsh.textBlockDim) &&
+           (a.fsh.textSBlockDim == b.fsh.textSBlockDim) &&
+           (a.ras.scanWidth == b.ras.scanWidth) &&
+           (a.ras.scanHeight == b.ras.scanHeight) &&
+           (a.ras.overScanWidth == b.ras.overScanWidth) &&
+           (a.ras.overScanHeight == b.ras.overScanHeight) &&
+           (a.doubleBuffer == b.doubleBuffer) &&
+           (a.forceMSAA == b.forceMSAA) &&
+           (a.msaaSamples == b.msaaSamples) &&
+           (a.forceFP16ColorBuffer == b.forceFP16ColorBuffer) &&
+           (a.fsh.useVectorShader == b.fsh.useVectorShader) &&
+           (strcmp(a.fsh.vectorALUConfig, b.fsh.vectorALUConfig) == 0) &&
+           (a.fsh.fetchRate == b.fsh.fetchRate) &&
+           (a.mem.memoryControllerV2 == b.mem.memoryControllerV2) &&
+           (a.mem.v2SecondInterleaving == b.mem.v2SecondInterleaving) &&
+           (a.fsh.vAttrLoadFromShader == b.fsh.vAttrLoadFromShader) &&
+           (a.enableDriverShTrans == b.enableDriverShTrans) &&
+           (a.ras.useMicroPolRast == b.ras.useMicroPolRast) &&
+           (a.ras.microTrisAsFragments == b.ras.microTrisAsFragments) &&
+           (a.ras.shadedSetup == b.ras.shadedSetup) &&
+           (a.useACD == b.useACD) &&
+           (a.lazyTextureResidency == b.lazyTextureResidency) &&
+           (a.driverWriteDedup == b.driverWriteDedup);
+}
+
 #ifdef WIN32
     #define parse_cycles(a) _atoi64(a)
 #else
     #define parse_cycles(a) atoll(a)
 #endif
 
+//  Writes the AGP transactions generated by the trace driver into an AGP transaction trace file.
+void gpu3d::decodeAGPTrace(const char *agpTraceName)
+{
+    gzofstream outFile;
+
+    //  Open output file
+    outFile.open(agpTraceName, ios::out | ios::binary);
+
+    //  Check if output file was correctly created.
+    if (!outFile.is_open())
+        panic("bGPU-Unified", "decodeAGPTrace", "Error opening output AGP transaction trace file.");
+
+    AGPTraceFileHeader agpTraceHeader;
+
+    //  Create header for the AGP Trace file.
+    for(u32bit i = 0; i < sizeof(AGPTRACEFILE_SIGNATURE); i++)
+        agpTraceHeader.signature[i] = AGPTRACEFILE_SIGNATURE[i];
+
+    agpTraceHeader.version = AGPTRACEFILE_CURRENT_VERSION;
+
+    agpTraceHeader.parameters.startFrame = simP.startFrame;
+    agpTraceHeader.parameters.traceFrames = simP.simFrames;
+    agpTraceHeader.parameters.memSize = simP.mem.memSize;
+    agpTraceHeader.parameters.mappedMemSize = simP.mem.mappedMemSize;
+    agpTraceHeader.parameters.textBlockDim = simP.fsh.textBlockDim;
+    agpTraceHeader.parameters.textSBlockDim = simP.fsh.textSBlockDim;
+    agpTraceHeader.parameters.scanWidth = simP.ras.scanWidth;
+    agpTraceHeader.parameters.scanHeight = simP.ras.scanHeight;
+    agpTraceHeader.parameters.overScanWidth = simP.ras.overScanWidth;
+    agpTraceHeader.parameters.overScanHeight = simP.ras.overScanHeight;
+    agpTraceHeader.parameters.doubleBuffer = simP.doubleBuffer;
+    agpTraceHeader.parameters.fetchRate = simP.fsh.fetchRate;
+    agpTraceHeader.parameters.memoryControllerV2 = simP.mem.memoryControllerV2;
+    agpTraceHeader.parameters.v2SecondInterleaving = simP.mem.v2SecondInterleaving;
+
+    //  Write header.
+    outFile.write((char *) &agpTraceHeader, sizeof(agpTraceHeader));
+
+    u32bit frameCounter = simP.startFrame;
+    bool end = false;
+
+    trDriver->startTrace();
+
+    while(!end)
+    {
+        AGPTransaction *nextAGPTransaction = trDriver->nextAGPTransaction();
+
+        //  Check if the end of the trace has been reached.
+        if (nextAGPTransaction != NULL)
+        {
+            if ((nextAGPTransaction->getAGPCommand() == AGP_COMMAND) &&
+                (nextAGPTransaction->getGPUCommand() == GPU_SWAPBUFFERS))
+                frameCounter++;
+
+            //  Save AGP Transaction in the output file.
+            nextAGPTransaction->save(&outFile);
+
+            delete nextAGPTransaction;
+        }
+        else
+        {
+            end = true;
+        }
+
+        //  End if the number of requested frames has been converted.  If the conversion didn't start
+        //  with the first frame the false frame (only swap command) must also be counted.
+        if (simP.simFrames != 0)
+            end = end || ((frameCounter - simP.startFrame) == (simP.simFrames + ((simP.startFrame == 0)?0:1)));
+    }
+
+    outFile.close();
+}
+
+//  Runs a batch of simulations, one per configuration file in the batch file.
+void gpu3d::runBatch(const char *batchFile, u32bit maxJobs)
+{
+#ifdef WIN32
+    panic("bGPU-Unified", "runBatch", "Batch mode not supported on this platform.");
+#else
+    vector<string> configs;
+
+    //  Read the configuration files.  Empty lines and lines starting with '#' are ignored.
+    ifstream batchIn(batchFile);
+
+    if (!batchIn.is_open())
+        panic("bGPU-Unified", "runBatch", "Error opening batch file.");
+
+    string line;
+    while (getline(batchIn, line))
+    {
+        string::size_type first = line.find_first_not_of(" \t\r");
+        if ((first == string::npos) || (line[first] == '#'))
+            continue;
+        string::size_type last = line.find_last_not_of(" \t\r");
+        configs.push_back(line.substr(first, last - first + 1));
+    }
+
+    batchIn.close();
+
+    if (configs.empty())
+        panic("bGPU-Unified", "runBatch", "No configuration files in the batch file.");
+
+    if (maxJobs == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        maxJobs = (cpus > 0) ? u32bit(cpus) : 1;
+    }
+
+    //  The simulation processes change to their own output directory so the input trace path must be absolute.
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+        panic("bGPU-Unified", "runBatch", "Error obtaining the current directory.");
+
+    string inputFile(simP.inputFile);
+    if (inputFile[0] != '/')
+        inputFile = string(cwd) + "/" + inputFile;
+
+    //  Load the configuration of each simulation.
+    vector<SimParameters> configParams(configs.size(), simP);
+
+    for(u32bit c = 0; c < configs.size(); c++)
+    {
+        ConfigLoader *cl = new ConfigLoader((char *) configs[c].c_str());
+        cl->getParameters(&configParams[c]);
+        delete cl;
+    }
+
+    //  Check if the input trace is already an AGP transaction trace.
+    bool inputAGPTrace = false;
+    vector<string> traceFiles(configs.size(), inputFile);
+
+    if (!has_extension(inputFile, "pixrun") && !has_extension(inputFile, "pixrunz"))
+    {
+        gzifstream agpTraceFile;
+        agpTraceFile.open(inputFile.c_str(), ios::in | ios::binary);
+
+        if (!agpTraceFile.is_open())
+            panic("bGPU-Unified", "runBatch", "Error opening input trace file.");
+
+        AGPTraceFileHeader agpTraceHeader;
+        agpTraceFile.read((char *) &agpTraceHeader, sizeof(agpTraceHeader));
+        inputAGPTrace = checkAGPTrace(&agpTraceHeader);
+        agpTraceFile.close();
+
+        //  An AGP transaction trace was generated for a single set of driver parameters.
+        if (inputAGPTrace)
+        {
+            for(u32bit c = 0; c < configs.size(); c++)
+            {
+                if (!matchAGPTraceParameters(configParams[c], &agpTraceHeader))
+                {
+                    cout << "Batch: " << configs[c] << " doesn't match the parameters of the AGP transaction trace." << endl;
+                    panic("bGPU-Unified", "runBatch", "Batch configurations must match the parameters used to generate the AGP transaction trace.");
+                }
+            }
+        }
+    }
+
+    u32bit startFrame = simP.startFrame;
+
+    //  Decode the API trace into an AGP transaction trace once per distinct set of driver parameters, shared
+    //  by all the simulations using that set.  The decoding runs in its own process to keep the driver and
+    //  library state out of the simulations.
+    if (!inputAGPTrace)
+    {
+        vector<u32bit> decodeConfigs;
+
+        //  The decoded traces are removed when the batch finishes, correctly or with an error.
+        batchProcess = getpid();
+        atexit(removeBatchTraceFiles);
+
+        for(u32bit c = 0; c < configs.size(); c++)
+        {
+            u32bit d = 0;
+            while ((d < decodeConfigs.size()) && !sameDriverParameters(configParams[decodeConfigs[d]], configParams[c]))
+                d++;
+
+            char traceName[64];
+            sprintf(traceName, "/bGPU.batch.%02d.tracefile.gz", d);
+            traceFiles[c] = string(cwd) + traceName;
+
+            if (d == decodeConfigs.size())
+            {
+                decodeConfigs.push_back(c);
+                batchTraceFiles.push_back(traceFiles[c]);
+            }
+        }
+
+        for(u32bit d = 0; d < decodeConfigs.size(); d++)
+        {
+            u32bit c = decodeConfigs[d];
+            string agpTraceName = traceFiles[c];
+
+            cout << "Batch: decoding " << inputFile << " into " << agpTraceName << " with the driver parameters of " << configs[c] << endl;
+
+            fflush(stdout);
+
+            pid_t pid = fork();
+
+            if (pid < 0)
+                panic("bGPU-Unified", "runBatch", "Error creating the trace decoding process.");
+
+            if (pid == 0)
+            {
+                SimParameters commandLineP = simP;
+                simP = configParams[c];
+                simP.inputFile = commandLineP.inputFile;
+                simP.simFrames = commandLineP.simFrames;
+                simP.simCycles = commandLineP.simCycles;
+                simP.startFrame = commandLineP.startFrame;
+
+                batchDecodeFile = new char[agpTraceName.length() + 1];
+                strcpy(batchDecodeFile, agpTraceName.c_str());
+                return;
+            }
+
+            int status;
+            waitpid(pid, &status, 0);
+
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+                panic("bGPU-Unified", "runBatch", "Error decoding the input trace.");
+        }
+
+        //  The decoded traces already start at the requested start frame.
+        startFrame = 0;
+    }
+
+    u32bit simFrames = simP.simFrames;
+    u64bit simCycles = simP.simCycles;
+
+    map<pid_t, u32bit> running;
+    vector<int> exitStatus(configs.size(), -1);
+
+    //  Launch one simulation process per configuration, at most maxJobs at the same time.
+    for(u32bit c = 0; c <= configs.size(); c++)
+    {
+        //  Wait for a simulation to finish if all the job slots are used or all the simulations were launched.
+        while ((running.size() == maxJobs) || ((c == configs.size()) && !running.empty()))
+        {
+            int status;
+            pid_t pid = wait(&status);
+
+            if (pid < 0)
+                panic("bGPU-Unified", "runBatch", "Error waiting for a simulation process.");
+
+            map<pid_t, u32bit>::iterator it = running.find(pid);
+            if (it == running.end())
+                continue;
+
+            exitStatus[it->second] = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            cout << "Batch: " << configs[it->second] << " finished with status " << exitStatus[it->second] << endl;
+            running.erase(it);
+        }
+
+        if (c == configs.size())
+            break;
+
+        //  Each simulation writes its statistics and output into its own directory.
+        string configName = configs[c];
+        string::size_type slash = configName.find_last_of('/');
+        if (slash != string::npos)
+            configName = configName.substr(slash + 1);
+        if (has_extension(configName, "ini"))
+            configName = configName.substr(0, configName.length() - 4);
+
+        char outDir[64];
+        sprintf(outDir, "batch_%02d_", c);
+        string outputDir = string(outDir) + configName;
+
+        if ((mkdir(outputDir.c_str(), 0755) != 0) && (errno != EEXIST))
+            panic("bGPU-Unified", "runBatch", "Error creating the simulation output directory.");
+
+        cout << "Batch: simulating " << configs[c] << " in " << outputDir << endl;
+
+        fflush(stdout);
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+            panic("bGPU-Unified", "runBatch", "Error creating a simulation process.");
+
+        if (pid == 0)
+        {
+            //  Use the configuration for this simulation and apply the command line overrides.
+            simP = configParams[c];
+
+            simP.inputFile = new char[traceFiles[c].length() + 1];
+            strcpy(simP.inputFile, traceFiles[c].c_str());
+            simP.simFrames = simFrames;
+            simP.simCycles = simCycles;
+            simP.startFrame = startFrame;
+
+            if (chdir(outputDir.c_str()) != 0)
+                panic("bGPU-Unified", "runBatch", "Error changing to the simulation output directory.");
+
+            if ((freopen("bGPU.out", "w", stdout) == NULL) || (freopen("bGPU.err", "w", stderr) == NULL))
+                panic("bGPU-Unified", "runBatch", "Error redirecting the simulation output.");
+
+            return;
+        }
+
+        running[pid] = c;
+    }
+
+    //  Report the batch results.
+    u32bit failed = 0;
+
+    for(u32bit c = 0; c < configs.size(); c++)
+        if (exitStatus[c] != 0)
+            failed++;
+
+    cout << "Batch: " << (configs.size() - failed) << " of " << configs.size() << " simulations finished correctly." << endl;
+
+    exit((failed == 0) ? 0 : -1);
+#endif
+}
+
 //  Main Function.
 int main(int argc, char *argv[])
 {
@@ -188,6 +573,8 @@ int main(int argc, char *argv[])
 
     // Arguments parsing and configuration loading.
     char *configFile = "bGPU.ini";
+    char *batchFile = NULL;
+    u32bit batchJobs = 0;
     bool debugMode = false;
     bool validationMode = false;
 
@@ -204,6 +591,7 @@ int main(int argc, char *argv[])
             if (++argIndex < argc) {
                 configFile = new char[strlen(argv[argIndex]) + 1];
                 strcpy(configFile, argv[argIndex]);
+                argIndex++;
             }
         }
         else
@@ -228,6 +616,8 @@ int main(int argc, char *argv[])
             debugMode = true;
         else if (strcmp(argList[argIndex], "--valid") == 0)
             validationMode = true;
+        else if (strcmp(argList[argIndex], "--profile") == 0)
+            simP.profileBoxes = true;
         else if (strcmp(argList[argIndex], "--start") == 0 && ++argIndex < argCount)
             simP.startFrame = atoi(argList[argIndex]);
         else if (strcmp(argList[argIndex], "--frames") == 0 && ++argIndex < argCount)
@@ -238,6 +628,10 @@ int main(int argc, char *argv[])
             simP.inputFile = new char[strlen(argList[argIndex]) + 1];
             strcpy(simP.inputFile, argList[argIndex]);
         }
+        else if (strcmp(argList[argIndex], "--batch") == 0 && ++argIndex < argCount)
+            batchFile = argList[argIndex];
+        else if (strcmp(argList[argIndex], "--jobs") == 0 && ++argIndex < argCount)
+            batchJobs = atoi(argList[argIndex]);
         else { // traditional arguments style
             switch (argPos) {
                 case 0: // trace file
@@ -267,6 +661,11 @@ int main(int argc, char *argv[])
         argIndex++;
     }
 
+    //  Batch mode:  simulate each configuration in the batch file in its own process.  Only returns
+    //  in the child processes, with the simulator parameters for the trace decoding or the simulation.
+    if (batchFile != NULL)
+        runBatch(batchFile, batchJobs);
+
     //  Check if the vector alu configuration is scalar (SOA).
     string aluConf(simP.fsh.vectorALUConfig);    
     bool vectorScalarALU = simP.fsh.useVectorShader && (aluConf.compare("scalar") == 0);
@@ -335,6 +734,13 @@ int main(int argc, char *argv[])
                                     simP.enableDriverShTrans,
                                     (simP.ras.useMicroPolRast && simP.ras.microTrisAsFragments)
                     );
+
+    GPUDriver::getGPUDriver()->setLazyTextureResidency(simP.lazyTextureResidency);
+    GPUDriver::getGPUDriver()->setWriteDedup(simP.driverWriteDedup);
+
+    //  Lazy texture uploads are preloads, they don't generate AGP write traffic.
+    if (simP.lazyTextureResidency)
+        cout << "Warning: LazyTextureResidency enabled, texture uploads are preloaded and the AGP write traffic for textures is not simulated." << endl;
     
     //  Set the shader architecture to use.
 #ifdef UNIFIEDSHADER
@@ -380,8 +786,17 @@ int main(int argc, char *argv[])
     printf("Statistics (Per Frame) Generation = %s\n", simP.perFrameStatistics?"enabled":"disabled");
     printf("Statistics (Per Batch) Generation = %s\n", simP.perBatchStatistics?"enabled":"disabled");
     printf("Statistics Rate = %d\n", simP.statsRate);
+    printf("BinaryStatistics = %s\n", simP.binaryStatistics ? "true" : "false");
+    printf("CompressStatistics = %s\n", simP.compressStatistics ? "true" : "false");
     printf("Dectect Stalls = %s\n", simP.detectStalls?"enabled":"disabled");
+    printf("ProfileBoxes = %s\n", simP.profileBoxes ? "true" : "false");
+    printf("FrameDumpPNG = %s\n", simP.frameDumpPNG ? "true" : "false");
+    printf("AsyncFrameDump = %s\n", simP.asyncFrameDump ? "true" : "false");
     printf("EnableDriverShaderTranslation = %s\n", simP.enableDriverShTrans ? "true" : "false");
+    printf("LazyTextureResidency = %s\n", simP.lazyTextureResidency ? "true" : "false");
+    printf("DriverWriteDedup = %s\n", simP.driverWriteDedup ? "true" : "false");
+    printf("ThreadedTraceDriver = %s\n", simP.threadedTraceDriver ? "true" : "false");
+    printf("TraceDriverQueueSize = %d\n", simP.traceDriverQueueSize);
     printf("VertexAttributeLoadFromShader = %s\n", simP.fsh.vAttrLoadFromShader ? "true" : "false");
     printf("VectorALUConfig = %s\n", simP.fsh.vectorALUConfig);
     if (multiClock)
@@ -469,7 +884,36 @@ int main(int argc, char *argv[])
             oglTrace = true;
         }
     }
-   
+
+    //  Run the API trace reader and the driver in their own thread.  Not used for AGP transaction
+    //  traces (cheap to read and required by the snapshot support) or in debug mode.
+    if (simP.threadedTraceDriver && !agpTrace && !debugMode && !validationMode)
+    {
+#ifdef ENABLE_GLOBAL_PROFILER
+        cout << "Warning: threaded trace driver not supported with the global profiler enabled." << endl;
+#else
+        //  AGP transactions are allocated in the trace driver thread and deleted in the simulator thread.
+        OptimizedDynamicMemory::setThreadSafe(true);
+
+        trDriver = threadedTrDriver = new ThreadedTraceDriver(trDriver, simP.traceDriverQueueSize);
+
+        cout << "Using threaded trace driver." << endl;
+#endif
+    }
+
+    //  Batch mode trace decoding process.
+    if (batchDecodeFile != NULL)
+    {
+        printf("Decoding trace into %s.\n\n", batchDecodeFile);
+
+        decodeAGPTrace(batchDecodeFile);
+
+        if (threadedTrDriver != NULL)
+            delete threadedTrDriver;
+
+        return 0;
+    }
+
 #ifdef UNIFIEDSHADER 
     gpuSimulator = new GPUSimulator(simP, trDriver, true, d3d9Trace, oglTrace, agpTrace);
 #else
@@ -505,6 +949,7 @@ int main(int argc, char *argv[])
             printf("Simulating %d frames (1 dot : 10K cycles).\n\n", simP.simFrames);
 
         time_t startTime = time(NULL);
+        f64bit startWallTime = getWallClockTime();
 
         //  Call the simulation main loop.
         if (!multiClock)
@@ -515,12 +960,26 @@ int main(int argc, char *argv[])
         f64bit elapsedTime = time(NULL) - startTime;
         cout << "\nSimulation clock time = " << elapsedTime << " seconds" << endl;
 
+        //  Print the simulation throughput (parsed by test/bench.pl).
+        f64bit wallTime = getWallClockTime() - startWallTime;
+        u64bit gpuCycles;
+        u64bit shaderCycles;
+        u64bit memCycles;
+        gpuSimulator->getCycles(gpuCycles, shaderCycles, memCycles);
+        printf("Benchmark => Wall time = %.3f s | GPU cycles = %lld | Cycles/s = %.1f | Peak RSS = %lld KB\n",
+            wallTime, gpuCycles, (wallTime > 0.0) ? f64bit(gpuCycles) / wallTime : 0.0, getPeakMemoryUsage());
+
         //  Close input file
         if (agpTraceFile.is_open())
             agpTraceFile.close();
 
         delete gpuSimulator;
-        
+
+        if (threadedTrDriver != NULL)
+        {
+            threadedTrDriver->dumpStatistics();
+            delete threadedTrDriver;
+        }
     }
 
     return 0;
@@ -46,6 +46,13 @@ void segFaultSignalHandler(int s);
 bool checkAGPTrace(AGPTraceFileHeader *agpTraceHeader);
 bool checkAGPTraceParameters(AGPTraceFileHeader *agpTraceHeader);
 
+//  Write the AGP transactions from the trace driver into an AGP transaction trace file.
+void decodeAGPTrace(const char *agpTraceName);
+
+//  Simulate each configuration in a batch file in its own process using a single decode of the trace.
+//  Only returns in the child processes.
+void runBatch(const char *batchFile, u32bit maxJobs);
+
 // case insensitive file extension test
 bool has_extension(const std::string file_name, const std::string extension);
 
@@ -31,6 +31,7 @@
 #include "AGPTraceDriver.h"
 #include "GLTraceDriver.h"
 #include "D3DTraceDriver.h"
+#include "ThreadedTraceDriver.h"
 
 #include "ShaderArchitectureParameters.h"
 
@@ -50,6 +51,7 @@ using namespace gpu3d;
 //  Trace reader+driver.
 TraceDriverInterface *trDriver;
 AGPTraceDriver *agpTraceDriver;
+ThreadedTraceDriver *threadedTrDriver = NULL;
 bool trDriverForACD;
 
  //  Simulator parameters.
@@ -291,6 +293,9 @@ int main(int argc, char *argv[])
                                     (simP.ras.useMicroPolRast && simP.ras.microTrisAsFragments)
                     );
 
+    GPUDriver::getGPUDriver()->setLazyTextureResidency(simP.lazyTextureResidency);
+    GPUDriver::getGPUDriver()->setWriteDedup(simP.driverWriteDedup);
+
     if (simP.fsh.fixedLatencyALU)
     {
         if (simP.fsh.useVectorShader && vectorScalarALU)
@@ -327,8 +332,17 @@ int main(int argc, char *argv[])
     printf("Statistics (Per Frame) Generation = %s\n", simP.perFrameStatistics?"enabled":"disabled");
     printf("Statistics (Per Batch) Generation = %s\n", simP.perBatchStatistics?"enabled":"disabled");
     printf("Statistics Rate = %d\n", simP.statsRate);
+    printf("BinaryStatistics = %s\n", simP.binaryStatistics ? "true" : "false");
+    printf("CompressStatistics = %s\n", simP.compressStatistics ? "true" : "false");
     printf("Dectect Stalls = %s\n", simP.detectStalls?"enabled":"disabled");
+    printf("ProfileBoxes = %s\n", simP.profileBoxes ? "true" : "false");
+    printf("FrameDumpPNG = %s\n", simP.frameDumpPNG ? "true" : "false");
+    printf("AsyncFrameDump = %s\n", simP.asyncFrameDump ? "true" : "false");
     printf("EnableDriverShaderTranslation = %s\n", simP.enableDriverShTrans ? "true" : "false");
+    printf("LazyTextureResidency = %s\n", simP.lazyTextureResidency ? "true" : "false");
+    printf("DriverWriteDedup = %s\n", simP.driverWriteDedup ? "true" : "false");
+    printf("ThreadedTraceDriver = %s\n", simP.threadedTraceDriver ? "true" : "false");
+    printf("TraceDriverQueueSize = %d\n", simP.traceDriverQueueSize);
     printf("VertexAttributeLoadFromShader = %s\n", simP.fsh.vAttrLoadFromShader ? "true" : "false");
     printf("VectorALUConfig = %s\n", simP.fsh.vectorALUConfig);
 
@@ -401,6 +415,22 @@ int main(int argc, char *argv[])
         }
     }
 
+    //  Run the API trace reader and the driver in their own thread.  Not used for AGP transaction
+    //  traces (cheap to read) or in debug mode.
+    if (simP.threadedTraceDriver && (agpTraceDriver == NULL) && !debugMode)
+    {
+#ifdef ENABLE_GLOBAL_PROFILER
+        cout << "Warning: threaded trace driver not supported with the global profiler enabled." << endl;
+#else
+        //  AGP transactions are allocated in the trace driver thread and deleted in the emulator thread.
+        OptimizedDynamicMemory::setThreadSafe(true);
+
+        trDriver = threadedTrDriver = new ThreadedTraceDriver(trDriver, simP.traceDriverQueueSize);
+
+        cout << "Using threaded trace driver." << endl;
+#endif
+    }
+
     //  Create GPU emulator.
     gpuEmu = new GPUEmulator(simP, trDriver);
 
@@ -429,6 +459,7 @@ int main(int argc, char *argv[])
         printf("Simulating %d frames (1 dot : 10K cycles).\n\n", simP.simFrames);
 
         time_t startTime = time(NULL);
+        f64bit startWallTime = getWallClockTime();
 
         //  Call the emulation main loop.
         gpuEmu->emulationLoop();
@@ -436,10 +467,34 @@ int main(int argc, char *argv[])
         f64bit elapsedTime = time(NULL) - startTime;
         cout << "\nSimulation clock time = " << elapsedTime << " seconds" << endl;
 
+        //  Print the emulation throughput (parsed by test/bench.pl).
+        f64bit wallTime = getWallClockTime() - startWallTime;
+        u64bit fragments = gpuEmu->getFragmentCounter();
+        printf("Benchmark => Wall time = %.3f s | Fragments = %lld | Fragments/s = %.1f | Peak RSS = %lld KB\n",
+            wallTime, fragments, (wallTime > 0.0) ? f64bit(fragments) / wallTime : 0.0, getPeakMemoryUsage());
+
+        //  Print the quads culled by the emulator hierarchical Z.
+        u64bit hzTested, hzBlockCulled, hzQuadCulled;
+        gpuEmu->getHZStatistics(hzTested, hzBlockCulled, hzQuadCulled);
+        printf("Hierarchical Z => Tested quads = %lld | Culled quads = %lld (block %lld, quad %lld)\n",
+            hzTested, hzBlockCulled + hzQuadCulled, hzBlockCulled, hzQuadCulled);
+
+        //  Print the triangles clipped by the emulator and the bounding box scan tiles before and after clipping.
+        u64bit clipped, clipCulled, clipGenerated, tilesBefore, tilesAfter;
+        gpuEmu->getClipStatistics(clipped, clipCulled, clipGenerated, tilesBefore, tilesAfter);
+        printf("Clipper => Clipped triangles = %lld | Culled = %lld | Generated triangles = %lld | Bounding box tiles = %lld -> %lld\n",
+            clipped, clipCulled, clipGenerated, tilesBefore, tilesAfter);
+
         //  Close input file
         if (agpTraceFile.is_open())
             agpTraceFile.close();
 
+        if (threadedTrDriver != NULL)
+        {
+            threadedTrDriver->dumpStatistics();
+            delete threadedTrDriver;
+        }
+
         //  Print end message.
         printf("\n\n");
         printf("End of simulation\n");
@@ -37,12 +37,26 @@
 using namespace gpu3d;
 
 /*  Clipper emulator constructor.  */
-ClipperEmulator::ClipperEmulator()
+ClipperEmulator::ClipperEmulator(u32bit attribs, f32bit guard) :
+
+    attributes(attribs), guardBand(guard)
 {
     u32bit i;
 
+    GPU_ASSERT(
+        if ((attributes == 0) || (attributes > MAX_VERTEX_ATTRIBUTES))
+            panic("ClipperEmulator", "ClipperEmulator", "Number of vertex attributes out of range.");
+        if (guardBand < 1.0f)
+            panic("ClipperEmulator", "ClipperEmulator", "The guard band must be at least the size of the viewport.");
+    )
+
     /*  Initialize number of clip vertices.  */
     numClipVertex = 0;
+    nextClipVertex = 0;
+    numGeneratedVertex = 0;
+
+    /*  OpenGL depth range by default.  */
+    d3d9DepthRange = false;
 
     /*  Initialize defined user clip planes table.  */
     for(i = 0; i < MAX_USER_CLIP_PLANES; i++)
@@ -53,6 +67,23 @@ ClipperEmulator::ClipperEmulator()
     /*  Set to null the generated clip vertex list.  */
     for(i = 0; i < MAX_CLIP_VERTICES; i++)
         clipVertex[i] = NULL;
+
+    /*  Allocate the storage for the generated vertices.  */
+    for(i = 0; i < MAX_GENERATED_VERTICES; i++)
+        generatedVertex[i] = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+}
+
+/*  Clipper emulator destructor.  */
+ClipperEmulator::~ClipperEmulator()
+{
+    for(u32bit i = 0; i < MAX_GENERATED_VERTICES; i++)
+        delete[] generatedVertex[i];
+}
+
+/*  Sets the clip space depth range.  */
+void ClipperEmulator::setDepthRange(bool d3d9Range)
+{
+    d3d9DepthRange = d3d9Range;
 }
 
 /*  Performs a trivial reject test against the frustum volume.  */
@@ -191,38 +222,234 @@ bool ClipperEmulator::trivialReject(QuadFloat v1, QuadFloat v2, QuadFloat v3, bo
 }
 
 
+/*  Clips the triangle against the frustum clip volume and/or the user clip planes.  */
+bool ClipperEmulator::clip(QuadFloat *v1, QuadFloat *v2, QuadFloat *v3, bool frustum, bool user)
+{
+    QuadFloat planes[MAX_CLIP_PLANES];
+    u32bit numPlanes;
+    u32bit outcode1, outcode2, outcode3;
+    u32bit crossed;
+    u32bit p;
+
+    /*  Reset the clip vertex list.  */
+    numClipVertex = 0;
+    nextClipVertex = 0;
+    numGeneratedVertex = 0;
+
+    /*  Build the list of clip planes.  */
+    numPlanes = 0;
+
+    if (frustum)
+    {
+        /*  Near plane:  z + w >= 0 (OpenGL) or z >= 0 (D3D9).  */
+        planes[numPlanes++] = QuadFloat(0.0f, 0.0f, 1.0f, d3d9DepthRange ? 0.0f : 1.0f);
+
+        /*  Far plane:  w - z >= 0.  */
+        planes[numPlanes++] = QuadFloat(0.0f, 0.0f, -1.0f, 1.0f);
+
+        /*  Guard band planes:  guardBand * w +/- x >= 0 and guardBand * w +/- y >= 0.  */
+        planes[numPlanes++] = QuadFloat( 1.0f,  0.0f, 0.0f, guardBand);
+        planes[numPlanes++] = QuadFloat(-1.0f,  0.0f, 0.0f, guardBand);
+        planes[numPlanes++] = QuadFloat( 0.0f,  1.0f, 0.0f, guardBand);
+        planes[numPlanes++] = QuadFloat( 0.0f, -1.0f, 0.0f, guardBand);
+    }
+
+    if (user)
+    {
+        for(p = 0; p < MAX_USER_CLIP_PLANES; p++)
+        {
+            if (userPlanes[p])
+                planes[numPlanes++] = userClipPlanes[p];
+        }
+    }
+
+    /*  Compute the outcodes of the three vertices, one bit per plane.  */
+    outcode1 = outcode2 = outcode3 = 0;
+
+#define PLANEDIST(pl, v) ((pl)[0] * (v)[0] + (pl)[1] * (v)[1] + (pl)[2] * (v)[2] + (pl)[3] * (v)[3])
+
+    for(p = 0; p < numPlanes; p++)
+    {
+        outcode1 |= (PLANEDIST(planes[p], v1[POSITION_ATTRIBUTE]) < 0.0f) ? (1 << p) : 0;
+        outcode2 |= (PLANEDIST(planes[p], v2[POSITION_ATTRIBUTE]) < 0.0f) ? (1 << p) : 0;
+        outcode3 |= (PLANEDIST(planes[p], v3[POSITION_ATTRIBUTE]) < 0.0f) ? (1 << p) : 0;
+    }
+
+#undef PLANEDIST
+
+    /*  The triangle is inside all the clip planes, keep the original triangle.  */
+    if ((outcode1 | outcode2 | outcode3) == 0)
+        return false;
+
+    /*  The triangle is outside a clip plane, no clip vertices.  */
+    if ((outcode1 & outcode2 & outcode3) != 0)
+        return true;
+
+    /*  Start with the triangle as clip polygon.  */
+    clipVertex[0] = v1;
+    clipVertex[1] = v2;
+    clipVertex[2] = v3;
+    numClipVertex = 3;
+
+    /*  Clip the polygon against the planes crossed by the triangle.  */
+    crossed = outcode1 | outcode2 | outcode3;
+
+    for(p = 0; (p < numPlanes) && (numClipVertex > 0); p++)
+    {
+        if ((crossed & (1 << p)) != 0)
+            clipPolygon(planes[p]);
+    }
+
+    /*  Discard degenerated polygons.  */
+    if (numClipVertex < 3)
+        numClipVertex = 0;
+
+    return true;
+}
+
+/*  Clips the current clip polygon against a plane.  */
+void ClipperEmulator::clipPolygon(QuadFloat plane)
+{
+    QuadFloat *output[MAX_CLIP_VERTICES];
+    f32bit distance[MAX_CLIP_VERTICES];
+    u32bit outputVertices;
+    u32bit crossings;
+    u32bit i;
+
+    /*  Compute the distance from the polygon vertices to the plane.  */
+    crossings = 0;
+    for(i = 0; i < numClipVertex; i++)
+    {
+        QuadFloat &position = clipVertex[i][POSITION_ATTRIBUTE];
+
+        distance[i] = plane[0] * position[0] + plane[1] * position[1] + plane[2] * position[2] + plane[3] * position[3];
+
+        if ((i > 0) && ((distance[i] < 0.0f) != (distance[i - 1] < 0.0f)))
+            crossings++;
+    }
+
+    if ((distance[0] < 0.0f) != (distance[numClipVertex - 1] < 0.0f))
+        crossings++;
+
+    /*  A convex polygon crosses the plane at most twice, more crossings are only possible
+        because of the precision with (almost) degenerated polygons that are discarded.  */
+    if (crossings > 2)
+    {
+        numClipVertex = 0;
+        return;
+    }
+
+    outputVertices = 0;
+
+    for(i = 0; i < numClipVertex; i++)
+    {
+        u32bit next = (i == (numClipVertex - 1)) ? 0 : (i + 1);
+        bool inside = (distance[i] >= 0.0f);
+
+        /*  Keep the vertices inside the plane.  */
+        if (inside)
+            output[outputVertices++] = clipVertex[i];
+
+        /*  Generate a new vertex where the edge crosses the plane.  */
+        if (inside != (distance[next] >= 0.0f))
+        {
+            /*  Always interpolate from the vertex inside to the vertex outside so the edges shared
+                by two triangles generate the same vertex.  */
+            u32bit in = inside ? i : next;
+            u32bit out = inside ? next : i;
+            f32bit t = distance[in] / (distance[in] - distance[out]);
+            QuadFloat *vertex = generatedVertex[numGeneratedVertex++];
+
+            for(u32bit a = 0; a < attributes; a++)
+            {
+                vertex[a][0] = clipVertex[in][a][0] + t * (clipVertex[out][a][0] - clipVertex[in][a][0]);
+                vertex[a][1] = clipVertex[in][a][1] + t * (clipVertex[out][a][1] - clipVertex[in][a][1]);
+                vertex[a][2] = clipVertex[in][a][2] + t * (clipVertex[out][a][2] - clipVertex[in][a][2]);
+                vertex[a][3] = clipVertex[in][a][3] + t * (clipVertex[out][a][3] - clipVertex[in][a][3]);
+            }
+
+            output[outputVertices++] = vertex;
+        }
+    }
+
+    /*  Store the clipped polygon.  */
+    for(i = 0; i < outputVertices; i++)
+        clipVertex[i] = output[i];
+
+    numClipVertex = outputVertices;
+}
+
 /*  Clips the triangle against the frustum clip volume.  */
 bool ClipperEmulator::frustumClip(QuadFloat *v1, QuadFloat *v2, QuadFloat *v3)
 {
-    panic("ClipperEmulator", "frustumClip", "Not implemented.");
-    return false;
+    return clip(v1, v2, v3, true, false);
 }
 
 /*  Clips the triangle against the defined user clip planes.  */
 bool ClipperEmulator::userClip(QuadFloat *v1, QuadFloat *v2, QuadFloat *v3)
 {
-    panic("ClipperEmulator", "userClip", "Not implemented.");
-    return false;
+    return clip(v1, v2, v3, false, true);
+}
+
+/*  Returns the number of clip vertices produced by the last clip operation.  */
+u32bit ClipperEmulator::getNumClipVertices()
+{
+    return numClipVertex;
 }
 
 /*  Gets the next clip vertex produced by the last clip operation.  */
 QuadFloat *ClipperEmulator::getNextClipVertex()
 {
-    panic("ClipperEmulator", "getNextClipVertex", "Not implemented.");
-    return 0;
+    if (nextClipVertex >= numClipVertex)
+        return NULL;
+
+    return clipVertex[nextClipVertex++];
+}
+
+/*  Gets the triangle fan for the clipped polygon produced by the last clip operation.  */
+u32bit ClipperEmulator::getClipTriangles(QuadFloat *triangles[MAX_CLIP_TRIANGLES][3])
+{
+    u32bit numTriangles;
+    u32bit i;
+
+    numTriangles = 0;
+
+    for(i = 2; i < numClipVertex; i++)
+    {
+        /*  Remove the triangles of the fan outside the viewport.  */
+        if (!trivialReject(clipVertex[0][POSITION_ATTRIBUTE], clipVertex[i - 1][POSITION_ATTRIBUTE],
+                           clipVertex[i][POSITION_ATTRIBUTE], d3d9DepthRange))
+        {
+            triangles[numTriangles][0] = clipVertex[0];
+            triangles[numTriangles][1] = clipVertex[i - 1];
+            triangles[numTriangles][2] = clipVertex[i];
+            numTriangles++;
+        }
+    }
+
+    return numTriangles;
 }
 
 
 /*  Defines a new user clip plane.  */
 void ClipperEmulator::defineClipPlane(u32bit id, QuadFloat plane)
 {
-    panic("ClipperEmulator", "defineClipPlane", "Not implemented.");
+    GPU_ASSERT(
+        if (id >= MAX_USER_CLIP_PLANES)
+            panic("ClipperEmulator", "defineClipPlane", "Out of range user clip plane identifier.");
+    )
+
+    userClipPlanes[id] = plane;
+    userPlanes[id] = TRUE;
 }
 
 /*  Undefines an user clip plane.  */
 void ClipperEmulator::undefineClipPlane(u32bit id)
 {
-    panic("ClipperEmulator", "undefineClipPlane", "Not implemented.");
-}
-
+    GPU_ASSERT(
+        if (id >= MAX_USER_CLIP_PLANES)
+            panic("ClipperEmulator", "undefineClipPlane", "Out of range user clip plane identifier.");
+    )
 
+    userPlanes[id] = FALSE;
+}
@@ -47,13 +47,30 @@ namespace gpu3d
  */
 //static const u32bit MAX_USER_CLIP_PLANES = 6;
 
+/**
+ *
+ *  Maximum number of clip planes: near, far, the four guard band
+ *  planes and the user clip planes.
+ *
+ */
+static const u32bit MAX_CLIP_PLANES = 6 + MAX_USER_CLIP_PLANES;
+
 /**
  * 
  *  Maximum number of clip vertices that can be stored in the
- *  clipper emulator.
+ *  clipper emulator.  Each clip plane adds at most one vertex
+ *  to the clipped polygon.
  *
  */
-static const u32bit MAX_CLIP_VERTICES = 12;
+static const u32bit MAX_CLIP_VERTICES = 3 + MAX_CLIP_PLANES;
+
+/**
+ *
+ *  Maximum number of triangles generated by a clip operation
+ *  (triangle fan of the clipped polygon).
+ *
+ */
+static const u32bit MAX_CLIP_TRIANGLES = MAX_CLIP_VERTICES - 2;
 
 
 /**
@@ -63,6 +80,15 @@ static const u32bit MAX_CLIP_VERTICES = 12;
  *  This class implements clipping functions for the clipper unit
  *  in the GPU simulator.
  *
+ *  Triangles are clipped in homogeneous clip space with the
+ *  Sutherland-Hodgman algorithm against the near and far planes,
+ *  the guard band planes for x and y (the rasterizer handles the
+ *  triangles that only cross the viewport edges) and the active
+ *  user clip planes.  A vertex is inside a plane when the dot
+ *  product of the plane and the vertex position is positive or zero.
+ *  The clipped polygon is returned as a list of vertices to be
+ *  assembled as a triangle fan.
+ *
  */
  
 class ClipperEmulator
@@ -70,11 +96,37 @@ class ClipperEmulator
 
 private:
 
+    /**
+     *
+     *  Maximum number of vertices generated by a clip operation, each clip
+     *  plane generates at most two new vertices.
+     *
+     */
+    static const u32bit MAX_GENERATED_VERTICES = 2 * MAX_CLIP_PLANES;
+
     QuadFloat userClipPlanes[MAX_USER_CLIP_PLANES]; /**<  User clip planes.  */
     bool userPlanes[MAX_USER_CLIP_PLANES];          /**<  Active user clip planes.  */
     QuadFloat *clipVertex[MAX_CLIP_VERTICES];       /**<  Table with the generated clip vertices.  */
     u32bit numClipVertex;                           /**<  Number of clip vertices produced by the last clip operation. */
-    
+    u32bit nextClipVertex;                          /**<  Next clip vertex returned by getNextClipVertex.  */
+
+    u32bit attributes;                              /**<  Number of vertex attributes interpolated for the new vertices.  */
+    f32bit guardBand;                               /**<  Guard band size relative to the viewport.  */
+    bool d3d9DepthRange;                            /**<  Clip space depth range, [0, 1] for D3D9 and [-1, 1] for OpenGL.  */
+
+    QuadFloat *generatedVertex[MAX_GENERATED_VERTICES]; /**<  Storage for the vertices generated by the clip operation.  */
+    u32bit numGeneratedVertex;                      /**<  Number of vertices generated by the last clip operation.  */
+
+    /**
+     *
+     *  Clips the current clip polygon against a plane.
+     *
+     *  @param plane The clip plane.
+     *
+     */
+
+    void clipPolygon(QuadFloat plane);
+
 public:
 
     /**
@@ -83,11 +135,36 @@ public:
      *
      *  Creates and initializes a new clipper emulator object.
      *
+     *  @param attributes Number of vertex attributes to interpolate for the
+     *  vertices generated by the clip operations.
+     *  @param guardBand Size of the guard band relative to the viewport (the
+     *  triangles are clipped against the x = +/- guardBand * w and
+     *  y = +/- guardBand * w planes).
+     *
      *  @return A new initializec clipper emulator object.
      *
      */
      
-    ClipperEmulator();
+    ClipperEmulator(u32bit attributes, f32bit guardBand);
+
+    /**
+     *
+     *  Clipper emulator destructor.
+     *
+     */
+
+    ~ClipperEmulator();
+
+    /**
+     *
+     *  Sets the clip space depth range used for the near plane.
+     *
+     *  @param d3d9DepthRange If TRUE the depth range is [0, 1] (D3D9), if
+     *  FALSE the depth range is [-1, 1] (OpenGL).
+     *
+     */
+
+    void setDepthRange(bool d3d9DepthRange);
 
     /**
      *
@@ -108,6 +185,30 @@ public:
      
     static bool trivialReject(QuadFloat v1, QuadFloat v2, QuadFloat v3, bool d3d9DepthRange);
     
+    /**
+     *
+     *  Clips a triangle against the frustum clip volume (near and far
+     *  planes and guard band) and/or the active user clip planes.
+     *
+     *  If the triangle is completely inside the clip planes no clip vertices
+     *  are produced and the original triangle must be used.  If the triangle
+     *  is completely outside a clip plane the clip operation produces no
+     *  vertices.  The clip vertices are stored in the clipper emulator until
+     *  the next clip operation.
+     *
+     *  @param v1 The triangle first vertex attributes.
+     *  @param v2 The triangle second vertex attributes.
+     *  @param v3 The triangle third vertex attributes.
+     *  @param frustum Clip against the frustum clip volume.
+     *  @param user Clip against the active user clip planes.
+     *
+     *  @return If the triangle was clipped (the triangle must be replaced by
+     *  the clip vertices produced).
+     *
+     */
+
+    bool clip(QuadFloat *v1, QuadFloat *v2, QuadFloat *v3, bool frustum, bool user);
+
     /**
      *
      *  Clips a triangle against the frustum clip volume.
@@ -136,17 +237,45 @@ public:
      
     bool userClip(QuadFloat *v1, QuadFloat *v2, QuadFloat *v3);
     
+    /**
+     *
+     *  Returns the number of clip vertices produced by the last clip operation.
+     *
+     *  @return The number of clip vertices (0 or at least 3).
+     *
+     */
+
+    u32bit getNumClipVertices();
+
     /**
      *
      *  Returns the next clipped vertex produced 
      *
      *  @return The next clip vertex and attributes produced by
-     *  the previous clip operation.
+     *  the previous clip operation or NULL if there are no more
+     *  clip vertices.
      *
      */
      
     QuadFloat *getNextClipVertex();
 
+    /**
+     *
+     *  Returns the triangles of the triangle fan for the clipped polygon produced
+     *  by the last clip operation.
+     *
+     *  The fan triangles that are completely outside the viewport (trivial reject
+     *  test) are removed, only the triangles crossing the guard band or the near
+     *  plane cross the viewport and the triangle setup can't process the others.
+     *
+     *  @param triangles Array where to store the three vertices of each triangle
+     *  generated.
+     *
+     *  @return The number of triangles stored in the array.
+     *
+     */
+    u32bit getClipTriangles(QuadFloat *triangles[MAX_CLIP_TRIANGLES][3]);
+
     /**
      *
      *  Defines a new user clip plane.
@@ -35,8 +35,372 @@
 #include "support.h"
 #include <cstdio>
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace gpu3d;
 
+/*  Computes the blend factor RGB components for a group of fragments.  */
+template<BlendFunction bf>
+static void factorRGB(const f32bit *constColor, const f32bit *source, const f32bit *destination,
+    f32bit *factor, u32bit fragments)
+{
+    for(u32bit i = 0; i < (fragments * 4); i += 4)
+    {
+        switch(bf)
+        {
+            case BLEND_ZERO:
+
+                /*  Set RGB components to 0.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = 0.0f;
+                break;
+
+            case BLEND_ONE:
+
+                /*  Set RGB components to 1.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = 1.0f;
+                break;
+
+            case BLEND_SRC_COLOR:
+
+                /*  Use source color.  */
+                factor[i + 0] = source[i + 0];
+                factor[i + 1] = source[i + 1];
+                factor[i + 2] = source[i + 2];
+                break;
+
+            case BLEND_ONE_MINUS_SRC_COLOR:
+
+                /*  Use 1 - source.  */
+                factor[i + 0] = 1.0f - source[i + 0];
+                factor[i + 1] = 1.0f - source[i + 1];
+                factor[i + 2] = 1.0f - source[i + 2];
+                break;
+
+            case BLEND_DST_COLOR:
+
+                /*  Use destination color.  */
+                factor[i + 0] = destination[i + 0];
+                factor[i + 1] = destination[i + 1];
+                factor[i + 2] = destination[i + 2];
+                break;
+
+            case BLEND_ONE_MINUS_DST_COLOR:
+
+                /*  Use 1 - destination.  */
+                factor[i + 0] = 1.0f - destination[i + 0];
+                factor[i + 1] = 1.0f - destination[i + 1];
+                factor[i + 2] = 1.0f - destination[i + 2];
+                break;
+
+            case BLEND_SRC_ALPHA:
+
+                /*  Use source alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = source[i + 3];
+                break;
+
+            case BLEND_ONE_MINUS_SRC_ALPHA:
+
+                /*  Use 1 - source alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = 1.0f - source[i + 3];
+                break;
+
+            case BLEND_DST_ALPHA:
+
+                /*  Use destination alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = destination[i + 3];
+                break;
+
+            case BLEND_ONE_MINUS_DST_ALPHA:
+
+                /*  Use 1 - destination alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = 1.0f - destination[i + 3];
+                break;
+
+            case BLEND_CONSTANT_COLOR:
+
+                /*  Use constant color RGB components.  */
+                factor[i + 0] = constColor[0];
+                factor[i + 1] = constColor[1];
+                factor[i + 2] = constColor[2];
+                break;
+
+            case BLEND_ONE_MINUS_CONSTANT_COLOR:
+
+                /*  Use 1 - constant color RGB components.  */
+                factor[i + 0] = 1.0f - constColor[0];
+                factor[i + 1] = 1.0f - constColor[1];
+                factor[i + 2] = 1.0f - constColor[2];
+                break;
+
+            case BLEND_CONSTANT_ALPHA:
+
+                /*  Use constant color alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = constColor[3];
+                break;
+
+            case BLEND_ONE_MINUS_CONSTANT_ALPHA:
+
+                /*  Use 1 - constant color alpha component.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = 1.0f - constColor[3];
+                break;
+
+            case BLEND_SRC_ALPHA_SATURATE:
+
+                /*  Use alpha saturate function.  */
+                factor[i + 0] = factor[i + 1] = factor[i + 2] = GPU_MIN(source[i + 3], 1.0f - destination[i + 3]);
+                break;
+        }
+    }
+}
+
+/*  Computes the blend factor alpha component for a group of fragments.  */
+template<BlendFunction bf>
+static void factorAlpha(const f32bit *constColor, const f32bit *source, const f32bit *destination,
+    f32bit *factor, u32bit fragments)
+{
+    for(u32bit i = 3; i < (fragments * 4); i += 4)
+    {
+        switch(bf)
+        {
+            case BLEND_ZERO:
+
+                /*  Set alpha component to 0.  */
+                factor[i] = 0.0f;
+                break;
+
+            case BLEND_ONE:
+            case BLEND_SRC_ALPHA_SATURATE:
+
+                /*  Set alpha component to 1.  */
+                factor[i] = 1.0f;
+                break;
+
+            case BLEND_SRC_COLOR:
+            case BLEND_SRC_ALPHA:
+
+                /*  Use source alpha component.  */
+                factor[i] = source[i];
+                break;
+
+            case BLEND_ONE_MINUS_SRC_COLOR:
+            case BLEND_ONE_MINUS_SRC_ALPHA:
+
+                /*  Use 1 - source alpha component.  */
+                factor[i] = 1.0f - source[i];
+                break;
+
+            case BLEND_DST_COLOR:
+            case BLEND_DST_ALPHA:
+
+                /*  Use destination alpha component.  */
+                factor[i] = destination[i];
+                break;
+
+            case BLEND_ONE_MINUS_DST_COLOR:
+            case BLEND_ONE_MINUS_DST_ALPHA:
+
+                /*  Use 1 - destination alpha.  */
+                factor[i] = 1.0f - destination[i];
+                break;
+
+            case BLEND_CONSTANT_COLOR:
+            case BLEND_CONSTANT_ALPHA:
+
+                /*  Use constant color alpha component.  */
+                factor[i] = constColor[3];
+                break;
+
+            case BLEND_ONE_MINUS_CONSTANT_COLOR:
+            case BLEND_ONE_MINUS_CONSTANT_ALPHA:
+
+                /*  Use 1 - constant color alpha component.  */
+                factor[i] = 1.0f - constColor[3];
+                break;
+        }
+    }
+}
+
+/*  Combines the source and destination colors of a group of fragments.  */
+template<BlendEquation eq>
+static void blendEquation(f32bit *color, const f32bit *source, const f32bit *sFactor,
+    const f32bit *destination, const f32bit *dFactor, u32bit fragments)
+{
+    for(u32bit i = 0; i < (fragments * 4); i += 4)
+    {
+#ifdef __SSE2__
+        /*  Blend the four components of the fragment at once.  */
+        __m128 s = _mm_loadu_ps(&source[i]);
+        __m128 d = _mm_loadu_ps(&destination[i]);
+        __m128 c;
+
+        switch(eq)
+        {
+            case BLEND_FUNC_ADD:
+                c = _mm_add_ps(_mm_mul_ps(s, _mm_loadu_ps(&sFactor[i])), _mm_mul_ps(d, _mm_loadu_ps(&dFactor[i])));
+                break;
+            case BLEND_FUNC_SUBTRACT:
+                c = _mm_sub_ps(_mm_mul_ps(s, _mm_loadu_ps(&sFactor[i])), _mm_mul_ps(d, _mm_loadu_ps(&dFactor[i])));
+                break;
+            case BLEND_FUNC_REVERSE_SUBTRACT:
+                c = _mm_sub_ps(_mm_mul_ps(d, _mm_loadu_ps(&dFactor[i])), _mm_mul_ps(s, _mm_loadu_ps(&sFactor[i])));
+                break;
+            case BLEND_MIN:
+                c = _mm_min_ps(s, d);
+                break;
+            case BLEND_MAX:
+                c = _mm_max_ps(s, d);
+                break;
+            default:
+                c = s;
+                break;
+        }
+
+        _mm_storeu_ps(&color[i], c);
+#else
+        for(u32bit j = i; j < (i + 4); j++)
+        {
+            switch(eq)
+            {
+                case BLEND_FUNC_ADD:
+                    color[j] = source[j] * sFactor[j] + destination[j] * dFactor[j];
+                    break;
+                case BLEND_FUNC_SUBTRACT:
+                    color[j] = source[j] * sFactor[j] - destination[j] * dFactor[j];
+                    break;
+                case BLEND_FUNC_REVERSE_SUBTRACT:
+                    color[j] = -source[j] * sFactor[j] + destination[j] * dFactor[j];
+                    break;
+                case BLEND_MIN:
+                    color[j] = GPU_MIN(source[j], destination[j]);
+                    break;
+                case BLEND_MAX:
+                    color[j] = GPU_MAX(source[j], destination[j]);
+                    break;
+            }
+        }
+#endif
+    }
+}
+
+/*  Selects the blend factor function for the RGB components.  */
+static FragmentOpEmulator::BlendFactorFunction selectFactorRGB(BlendFunction bf)
+{
+    switch(bf)
+    {
+        case BLEND_ZERO:                        return &factorRGB<BLEND_ZERO>;
+        case BLEND_ONE:                         return &factorRGB<BLEND_ONE>;
+        case BLEND_SRC_COLOR:                   return &factorRGB<BLEND_SRC_COLOR>;
+        case BLEND_ONE_MINUS_SRC_COLOR:         return &factorRGB<BLEND_ONE_MINUS_SRC_COLOR>;
+        case BLEND_DST_COLOR:                   return &factorRGB<BLEND_DST_COLOR>;
+        case BLEND_ONE_MINUS_DST_COLOR:         return &factorRGB<BLEND_ONE_MINUS_DST_COLOR>;
+        case BLEND_SRC_ALPHA:                   return &factorRGB<BLEND_SRC_ALPHA>;
+        case BLEND_ONE_MINUS_SRC_ALPHA:         return &factorRGB<BLEND_ONE_MINUS_SRC_ALPHA>;
+        case BLEND_DST_ALPHA:                   return &factorRGB<BLEND_DST_ALPHA>;
+        case BLEND_ONE_MINUS_DST_ALPHA:         return &factorRGB<BLEND_ONE_MINUS_DST_ALPHA>;
+        case BLEND_CONSTANT_COLOR:              return &factorRGB<BLEND_CONSTANT_COLOR>;
+        case BLEND_ONE_MINUS_CONSTANT_COLOR:    return &factorRGB<BLEND_ONE_MINUS_CONSTANT_COLOR>;
+        case BLEND_CONSTANT_ALPHA:              return &factorRGB<BLEND_CONSTANT_ALPHA>;
+        case BLEND_ONE_MINUS_CONSTANT_ALPHA:    return &factorRGB<BLEND_ONE_MINUS_CONSTANT_ALPHA>;
+        case BLEND_SRC_ALPHA_SATURATE:          return &factorRGB<BLEND_SRC_ALPHA_SATURATE>;
+        default:                                return NULL;
+    }
+}
+
+/*  Selects the blend factor function for the alpha component.  */
+static FragmentOpEmulator::BlendFactorFunction selectFactorAlpha(BlendFunction bf)
+{
+    switch(bf)
+    {
+        case BLEND_ZERO:                        return &factorAlpha<BLEND_ZERO>;
+        case BLEND_ONE:                         return &factorAlpha<BLEND_ONE>;
+        case BLEND_SRC_ALPHA_SATURATE:          return &factorAlpha<BLEND_SRC_ALPHA_SATURATE>;
+        case BLEND_SRC_COLOR:                   return &factorAlpha<BLEND_SRC_COLOR>;
+        case BLEND_SRC_ALPHA:                   return &factorAlpha<BLEND_SRC_ALPHA>;
+        case BLEND_ONE_MINUS_SRC_COLOR:         return &factorAlpha<BLEND_ONE_MINUS_SRC_COLOR>;
+        case BLEND_ONE_MINUS_SRC_ALPHA:         return &factorAlpha<BLEND_ONE_MINUS_SRC_ALPHA>;
+        case BLEND_DST_COLOR:                   return &factorAlpha<BLEND_DST_COLOR>;
+        case BLEND_DST_ALPHA:                   return &factorAlpha<BLEND_DST_ALPHA>;
+        case BLEND_ONE_MINUS_DST_COLOR:         return &factorAlpha<BLEND_ONE_MINUS_DST_COLOR>;
+        case BLEND_ONE_MINUS_DST_ALPHA:         return &factorAlpha<BLEND_ONE_MINUS_DST_ALPHA>;
+        case BLEND_CONSTANT_COLOR:              return &factorAlpha<BLEND_CONSTANT_COLOR>;
+        case BLEND_CONSTANT_ALPHA:              return &factorAlpha<BLEND_CONSTANT_ALPHA>;
+        case BLEND_ONE_MINUS_CONSTANT_COLOR:    return &factorAlpha<BLEND_ONE_MINUS_CONSTANT_COLOR>;
+        case BLEND_ONE_MINUS_CONSTANT_ALPHA:    return &factorAlpha<BLEND_ONE_MINUS_CONSTANT_ALPHA>;
+        default:                                return NULL;
+    }
+}
+
+/*  Selects the blend equation function.  */
+static FragmentOpEmulator::BlendEquationFunction selectEquation(BlendEquation eq)
+{
+    switch(eq)
+    {
+        case BLEND_FUNC_ADD:                return &blendEquation<BLEND_FUNC_ADD>;
+        case BLEND_FUNC_SUBTRACT:           return &blendEquation<BLEND_FUNC_SUBTRACT>;
+        case BLEND_FUNC_REVERSE_SUBTRACT:   return &blendEquation<BLEND_FUNC_REVERSE_SUBTRACT>;
+        case BLEND_MIN:                     return &blendEquation<BLEND_MIN>;
+        case BLEND_MAX:                     return &blendEquation<BLEND_MAX>;
+        default:                            return NULL;
+    }
+}
+
+#ifdef __SSE2__
+
+/*  Computes the logical operation for 16 bytes.  */
+static inline __m128i logicOpSIMD(LogicOpMode mode, __m128i s, __m128i d)
+{
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    switch(mode)
+    {
+        case LOGICOP_CLEAR:         return _mm_setzero_si128();
+        case LOGICOP_AND:           return _mm_and_si128(s, d);
+        case LOGICOP_AND_REVERSE:   return _mm_andnot_si128(d, s);
+        case LOGICOP_COPY:          return s;
+        case LOGICOP_AND_INVERTED:  return _mm_andnot_si128(s, d);
+        case LOGICOP_NOOP:          return d;
+        case LOGICOP_XOR:           return _mm_xor_si128(s, d);
+        case LOGICOP_OR:            return _mm_or_si128(s, d);
+        case LOGICOP_NOR:           return _mm_xor_si128(_mm_or_si128(s, d), ones);
+        case LOGICOP_EQUIV:         return _mm_xor_si128(_mm_xor_si128(s, d), ones);
+        case LOGICOP_INVERT:        return _mm_xor_si128(d, ones);
+        case LOGICOP_OR_REVERSE:    return _mm_or_si128(s, _mm_xor_si128(d, ones));
+        case LOGICOP_COPY_INVERTED: return _mm_xor_si128(s, ones);
+        case LOGICOP_OR_INVERTED:   return _mm_or_si128(_mm_xor_si128(s, ones), d);
+        case LOGICOP_NAND:          return _mm_xor_si128(_mm_and_si128(s, d), ones);
+        case LOGICOP_SET:           return ones;
+        default:                    return d;
+    }
+}
+
+/*  Compares four unsigned 32 bit values with four references.  Returns the result as a 4 bit mask.  */
+static inline u32bit compareSIMD(CompareMode func, __m128i value, __m128i ref)
+{
+    /*  Unsigned values are compared as signed values after flipping the sign bit.  */
+    const __m128i bias = _mm_set1_epi32(0x80000000);
+    __m128i v = _mm_xor_si128(value, bias);
+    __m128i r = _mm_xor_si128(ref, bias);
+
+    switch(func)
+    {
+        case GPU_NEVER:     return 0x0;
+        case GPU_ALWAYS:    return 0xf;
+        case GPU_LESS:      return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(r, v)));
+        case GPU_LEQUAL:    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, r))) ^ 0xf;
+        case GPU_EQUAL:     return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, r)));
+        case GPU_GEQUAL:    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(r, v))) ^ 0xf;
+        case GPU_GREATER:   return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, r)));
+        case GPU_NOTEQUAL:  return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, r))) ^ 0xf;
+        default:
+            panic("FragmentOpEmulator", "compare", "Undefined compare mode.");
+            return 0;
+    }
+}
+
+#endif  // __SSE2__
+
 /*  Fragment Operation Emulator constructor.  */
 FragmentOpEmulator::FragmentOpEmulator(u32bit stampFrags)
 {
@@ -108,6 +472,10 @@ FragmentOpEmulator::FragmentOpEmulator(u32bit stampFrags)
     depthPass = STENCIL_KEEP;
     depthFunction = GPU_LESS;
     depthMask =  TRUE;
+
+    /*  Set initial blend state.  */
+    for(u32bit rt = 0; rt < MAX_RENDER_TARGETS; rt++)
+        setBlending(rt, BLEND_FUNC_ADD, BLEND_ONE, BLEND_ONE, BLEND_ZERO, BLEND_ZERO, QuadFloat(0.0f, 0.0f, 0.0f, 0.0f));
 }
 
 /*  Enables or disables stencil test.  */
@@ -158,6 +526,13 @@ void FragmentOpEmulator::setBlending(u32bit rt, BlendEquation eq, BlendFunction
     dstRGB[rt] = dRGB;
     dstAlpha[rt] = dA;
     constantColor[rt] = color;
+
+    /*  Select the blend functions for the new parameters.  */
+    equationFunction[rt] = selectEquation(eq);
+    srcRGBFunction[rt] = selectFactorRGB(sRGB);
+    srcAlphaFunction[rt] = selectFactorAlpha(sA);
+    dstRGBFunction[rt] = selectFactorRGB(dRGB);
+    dstAlphaFunction[rt] = selectFactorAlpha(dA);
 }
 
 /*  Set logical operation mode.  */
@@ -265,107 +640,113 @@ void FragmentOpEmulator::stencilZTest(u32bit *stampZ, u32bit *bufferZ,
 }
 
 
-/*  Blends two stamps using the current blend mode.  */
-void FragmentOpEmulator::blend(u32bit rt, QuadFloat *color, QuadFloat *source,
-    QuadFloat *destination)
+/*  Converts color data from RGBA8 format to RGBA32F format.  */
+void FragmentOpEmulator::colorRGBA8ToRGBA32F(u8bit *in, QuadFloat *out, u32bit fragments)
 {
-    u32bit i;
-
-    /*  Calculate source factor RGB components.  */
-    factorRGB(srcRGB[rt], constantColor[rt], source, destination, sFactor);
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128i zero = _mm_setzero_si128();
+#endif
 
-    /*  Calculate source factor alpha component.  */
-    factorAlpha(srcAlpha[rt], constantColor[rt], source, destination, sFactor);
-
-    /*  Calculate destination factor RGB components.  */
-    factorRGB(dstRGB[rt], constantColor[rt], source, destination, dFactor);
-
-    /*  Calculate destination factor alpha component.  */
-    factorAlpha(dstAlpha[rt], constantColor[rt], source, destination, dFactor);
-
-    /*  Blend source and destination.  */
-    switch(equation[rt])
+    /*  Convert all the colors.  */
+    for(u32bit i = 0; i < fragments; i++)
     {
-        case BLEND_FUNC_ADD:
-
-            /*  Add source and destination colors.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                color[i][0] = source[i][0] * sFactor[i][0] + destination[i][0] * dFactor[i][0];
-                color[i][1] = source[i][1] * sFactor[i][1] + destination[i][1] * dFactor[i][1];
-                color[i][2] = source[i][2] * sFactor[i][2] + destination[i][2] * dFactor[i][2];
-                color[i][3] = source[i][3] * sFactor[i][3] + destination[i][3] * dFactor[i][3];
-            }
-
-            break;
-
-        case BLEND_FUNC_SUBTRACT:
-
-            /*  Subtract source and destination colors.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                color[i][0] = source[i][0] * sFactor[i][0] - destination[i][0] * dFactor[i][0];
-                color[i][1] = source[i][1] * sFactor[i][1] - destination[i][1] * dFactor[i][1];
-                color[i][2] = source[i][2] * sFactor[i][2] - destination[i][2] * dFactor[i][2];
-                color[i][3] = source[i][3] * sFactor[i][3] - destination[i][3] * dFactor[i][3];
-            }
-
-            break;
-
-        case BLEND_FUNC_REVERSE_SUBTRACT:
-
-            /*  Subtract destination and source colors.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                color[i][0] = -source[i][0] * sFactor[i][0] + destination[i][0] * dFactor[i][0];
-                color[i][1] = -source[i][1] * sFactor[i][1] + destination[i][1] * dFactor[i][1];
-                color[i][2] = -source[i][2] * sFactor[i][2] + destination[i][2] * dFactor[i][2];
-                color[i][3] = -source[i][3] * sFactor[i][3] + destination[i][3] * dFactor[i][3];
-            }
-
-            break;
-
-        case BLEND_MIN:
-
-            /*  Minimum.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                color[i][0] = GPU_MIN(source[i][0], destination[i][0]);
-                color[i][1] = GPU_MIN(source[i][1], destination[i][1]);
-                color[i][2] = GPU_MIN(source[i][2], destination[i][2]);
-                color[i][3] = GPU_MIN(source[i][3], destination[i][3]);
-            }
-
-            break;
+#ifdef __SSE2__
+        /*  Expand the four 8 bit components to 32 bit integers and convert them to float point.  */
+        __m128i c = _mm_cvtsi32_si128(*((s32bit *) &in[i * 4]));
+        c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(c, zero), zero);
+        _mm_storeu_ps(&out[i][0], _mm_mul_ps(_mm_cvtepi32_ps(c), scale));
+#else
+        /*  Convert 8 bit normalized color components to 32 bit float point color components.  */
+        out[i][0] = f32bit(in[i * 4]) * (1.0f / 255.0f);
+        out[i][1] = f32bit(in[i * 4 + 1]) * (1.0f / 255.0f);
+        out[i][2] = f32bit(in[i * 4 + 2]) * (1.0f / 255.0f);
+        out[i][3] = f32bit(in[i * 4 + 3]) * (1.0f / 255.0f);
+#endif
+    }
+}
 
-        case BLEND_MAX:
+/*  Converts color data from RGBA32F format to RGBA8 format.  */
+void FragmentOpEmulator::colorRGBA32FToRGBA8(QuadFloat *in, u8bit *out, u32bit fragments)
+{
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+#endif
+
+    /*  Convert all the colors.  */
+    for(u32bit i = 0; i < fragments; i++)
+    {
+#ifdef __SSE2__
+        /*  Clamp to [0, 1] (NaN is clamped to 1), scale and truncate the four components.  */
+        __m128 f = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(&in[i][0]), one), zero);
+        __m128i c = _mm_cvttps_epi32(_mm_mul_ps(f, scale));
+        c = _mm_packus_epi16(_mm_packs_epi32(c, c), c);
+        *((s32bit *) &out[i * 4]) = _mm_cvtsi128_si32(c);
+#else
+        /*  Convert 32bit float point color components to 8 bit normalized color components.  */
+        out[i * 4 + 0] = u8bit(255.0f * GPU_CLAMP(in[i][0], 0.0f, 1.0f));
+        out[i * 4 + 1] = u8bit(255.0f * GPU_CLAMP(in[i][1], 0.0f, 1.0f));
+        out[i * 4 + 2] = u8bit(255.0f * GPU_CLAMP(in[i][2], 0.0f, 1.0f));
+        out[i * 4 + 3] = u8bit(255.0f * GPU_CLAMP(in[i][3], 0.0f, 1.0f));
+#endif
+    }
+}
 
-            /*  Maximum.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                color[i][0] = GPU_MAX(source[i][0], destination[i][0]);
-                color[i][1] = GPU_MAX(source[i][1], destination[i][1]);
-                color[i][2] = GPU_MAX(source[i][2], destination[i][2]);
-                color[i][3] = GPU_MAX(source[i][3], destination[i][3]);
-            }
+/*  Blends two stamps using the current blend mode.  */
+void FragmentOpEmulator::blend(u32bit rt, QuadFloat *color, QuadFloat *source,
+    QuadFloat *destination)
+{
+    /*  The stamp colors are accessed as arrays of float point components.  */
+    const f32bit *src = &source[0][0];
+    const f32bit *dst = &destination[0][0];
+    const f32bit *constColor = &constantColor[rt][0];
+    f32bit *sF = &sFactor[0][0];
+    f32bit *dF = &dFactor[0][0];
+
+    if (equationFunction[rt] == NULL)
+        panic("FragmentOpEmulator", "blend", "Unsupported blend equation mode.");
+
+    /*  The minimum and maximum equations don't use the blend factors.  */
+    if ((equation[rt] != BLEND_MIN) && (equation[rt] != BLEND_MAX))
+    {
+        if ((srcRGBFunction[rt] == NULL) || (srcAlphaFunction[rt] == NULL) ||
+            (dstRGBFunction[rt] == NULL) || (dstAlphaFunction[rt] == NULL))
+            panic("FragmentOpEmulator", "blend", "Unsupported blend factor function.");
 
-            break;
+        /*  Calculate source factor RGB and alpha components.  */
+        srcRGBFunction[rt](constColor, src, dst, sF, stampFragments);
+        srcAlphaFunction[rt](constColor, src, dst, sF, stampFragments);
 
-        default:
-            panic("FragmentOpEmulator", "blend", "Unsupported blend equation mode.");
-            break;
+        /*  Calculate destination factor RGB and alpha components.  */
+        dstRGBFunction[rt](constColor, src, dst, dF, stampFragments);
+        dstAlphaFunction[rt](constColor, src, dst, dF, stampFragments);
     }
+
+    /*  Blend source and destination.  */
+    equationFunction[rt](&color[0][0], src, sF, dst, dF, stampFragments);
 }
 
 /*  Performs a logical operation between the incoming stamp and the color buffer.  */
 void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination)
 {
-    u32bit i;
+    u32bit i = 0;
 
     //
     //  Note: only 32-bit color format supported (RGBA8).
     //
-    
+
+#ifdef __SSE2__
+    /*  Process the stamp 16 bytes at a time.  The remaining bytes are processed below.  */
+    for(; (i + 16) <= (stampFragments * 4); i += 16)
+    {
+        __m128i s = _mm_loadu_si128((__m128i *) &source[i]);
+        __m128i d = _mm_loadu_si128((__m128i *) &destination[i]);
+        _mm_storeu_si128((__m128i *) &color[i], logicOpSIMD(logicOpMode, s, d));
+    }
+#endif
+
     /*  Which logical operation mode to use?  */
     switch(logicOpMode)
     {
@@ -373,7 +754,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_CLEAR:
 
             /*  Clear color.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Clear byte.  */
                 color[i] = 0;
@@ -384,7 +765,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_AND:
 
             /*  And source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical and.  */
                 color[i] = source[i] & destination[i];
@@ -395,7 +776,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_AND_REVERSE:
 
             /*  And reverse source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical and reverse.  */
                 color[i] = source[i] & ~destination[i];
@@ -406,7 +787,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_COPY:
 
             /*  Copy source color.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Just copy.  */
                 color[i] = source[i];
@@ -417,7 +798,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_AND_INVERTED:
 
             /*  And inverted source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical and inverted .  */
                 color[i] = ~source[i] & destination[i];
@@ -428,7 +809,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_NOOP:
 
             /*  Do not change destination color.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Mantein destination color.  */
                 color[i] = destination[i];
@@ -439,7 +820,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_XOR:
 
             /*  Xor source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical xor.  */
                 color[i] = source[i] ^ destination[i];
@@ -450,7 +831,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_OR:
 
             /*  Or source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical or.  */
                 color[i] = source[i] | destination[i];
@@ -461,7 +842,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_NOR:
 
             /*  Nor source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical nor.  */
                 color[i] = ~(source[i] | destination[i]);
@@ -472,7 +853,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_EQUIV:
 
             /*  Equiv (?) source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical equiv (?).  */
                 color[i] = ~(source[i] ^ destination[i]);
@@ -483,7 +864,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_INVERT:
 
             /*  Invert destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Invert destination.  */
                 color[i] = ~destination[i];
@@ -494,7 +875,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_OR_REVERSE:
 
             /*  Or reverse source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical or reverse.  */
                 color[i] = source[i] | ~destination[i];
@@ -505,7 +886,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_COPY_INVERTED:
 
             /*  Copy inverted source.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Invert source.  */
                 color[i] = ~source[i];
@@ -516,7 +897,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_OR_INVERTED:
 
             /*  Or inverted source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical or inverted.  */
                 color[i] = ~source[i] | destination[i];
@@ -527,7 +908,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_NAND:
 
             /*  Not and source and destination colors.  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Logical not and.  */
                 color[i] = ~(source[i] & destination[i]);
@@ -538,7 +919,7 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
         case LOGICOP_SET:
 
             /*  Set color (to all 1s).  */
-            for(i = 0; i < (stampFragments * 4); i++)
+            for(; i < (stampFragments * 4); i++)
             {
                 /*  Set byte to all 1s.  */
                 color[i] = 0xff;
@@ -553,306 +934,6 @@ void FragmentOpEmulator::logicOp(u8bit *color, u8bit *source, u8bit *destination
 }
 
 
-/*  Sets blending factor RGB components.  */
-void FragmentOpEmulator::factorRGB(BlendFunction bf, QuadFloat constColor, QuadFloat *source,
-    QuadFloat *destination, QuadFloat *factor)
-{
-    u32bit i;
-
-    switch(bf)
-    {
-        case BLEND_ZERO:
-
-            /*  Set RGB components to 0.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Clear RGB components.  */
-                factor[i][0] = 0.0;
-                factor[i][1] = 0.0;
-                factor[i][2] = 0.0;
-            }
-            break;
-
-        case BLEND_ONE:
-
-            /*  Set RGB components to 1.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0;
-                factor[i][1] = 1.0;
-                factor[i][2] = 1.0;
-            }
-
-            break;
-
-        case BLEND_SRC_COLOR:
-
-            /*  Use source color.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Copy source RGB components.  */
-                factor[i][0] = source[i][0];
-                factor[i][1] = source[i][1];
-                factor[i][2] = source[i][2];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_SRC_COLOR:
-
-            /*  Use 1 - source.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - source[i][0];
-                factor[i][1] = 1.0f - source[i][1];
-                factor[i][2] = 1.0f - source[i][2];
-            }
-
-            break;
-
-        case BLEND_DST_COLOR:
-
-            /*  Use destination color.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Copy destination color RGB components.  */
-                factor[i][0] = destination[i][0];
-                factor[i][1] = destination[i][1];
-                factor[i][2] = destination[i][2];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_DST_COLOR:
-
-            /*  Use 1 - destination.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - destination[i][0];
-                factor[i][1] = 1.0f - destination[i][1];
-                factor[i][2] = 1.0f - destination[i][2];
-            }
-
-            break;
-
-        case BLEND_SRC_ALPHA:
-
-            /*  Use source alpha component.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = source[i][3];
-                factor[i][1] = source[i][3];
-                factor[i][2] = source[i][3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_SRC_ALPHA:
-
-            /*  Use 1 - source alpha component.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - source[i][3];
-                factor[i][1] = 1.0f - source[i][3];
-                factor[i][2] = 1.0f - source[i][3];
-            }
-
-            break;
-
-        case BLEND_DST_ALPHA:
-
-            /*  Use destination alpha component.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = destination[i][3];
-                factor[i][1] = destination[i][3];
-                factor[i][2] = destination[i][3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_DST_ALPHA:
-
-            /*  Use 1 - source alpha component.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - destination[i][3];
-                factor[i][1] = 1.0f - destination[i][3];
-                factor[i][2] = 1.0f - destination[i][3];
-            }
-
-            break;
-
-        case BLEND_CONSTANT_COLOR:
-
-            /*  Use constant color RGB components.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = constColor[0];
-                factor[i][1] = constColor[1];
-                factor[i][2] = constColor[2];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_CONSTANT_COLOR:
-
-            /*  Use 1 - constant color RGB components.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - constColor[0];
-                factor[i][1] = 1.0f - constColor[1];
-                factor[i][2] = 1.0f - constColor[2];
-            }
-
-            break;
-
-        case BLEND_CONSTANT_ALPHA:
-
-            /*  Use constant color alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = constColor[3];
-                factor[i][1] = constColor[3];
-                factor[i][2] = constColor[3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_CONSTANT_ALPHA:
-
-            /*  Use 1 - constant color alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = 1.0f - constColor[3];
-                factor[i][1] = 1.0f - constColor[3];
-                factor[i][2] = 1.0f - constColor[3];
-            }
-
-            break;
-
-        case BLEND_SRC_ALPHA_SATURATE:
-
-            /*  Use alpha saturate function.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][0] = GPU_MIN(source[i][3], 1.0f - destination[i][3]);
-                factor[i][1] = factor[i][0];
-                factor[i][2] = factor[i][0];
-            }
-
-            break;
-
-        default:
-            panic("FragmentOpEmulator", "factorRGB", "Unsupported blend factor function.");
-            break;
-    }
-
-}
-
-/*  Sets blending factor alpha component.  */
-void FragmentOpEmulator::factorAlpha(BlendFunction bf, QuadFloat constColor, QuadFloat *source,
-    QuadFloat *destination, QuadFloat *factor)
-{
-    u32bit i;
-    switch(bf)
-    {
-        case BLEND_ZERO:
-
-            /*  Set alpha components to 0.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Clear alpha component.  */
-                factor[i][3] = 0.0;
-            }
-            break;
-
-        case BLEND_ONE:
-        case BLEND_SRC_ALPHA_SATURATE:
-
-            /*  Set alpha components to 1.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][3] = 1.0;
-            }
-
-            break;
-
-        case BLEND_SRC_COLOR:
-        case BLEND_SRC_ALPHA:
-
-            /*  Use source alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Copy source alpha component.  */
-                factor[i][3] = source[i][3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_SRC_COLOR:
-        case BLEND_ONE_MINUS_SRC_ALPHA:
-
-            /*  Use 1 - source alpha component.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][3] = 1.0f - source[i][3];
-            }
-
-            break;
-
-        case BLEND_DST_COLOR:
-        case BLEND_DST_ALPHA:
-
-            /*  Use destination alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                /*  Copy destination alpha component.  */
-                factor[i][3] = destination[i][3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_DST_COLOR:
-        case BLEND_ONE_MINUS_DST_ALPHA:
-
-            /*  Use 1 - destination alpha.  */
-            for (i = 0; i < stampFragments; i++)
-            {
-                factor[i][3] = 1.0f - destination[i][3];
-            }
-
-            break;
-
-        case BLEND_CONSTANT_COLOR:
-        case BLEND_CONSTANT_ALPHA:
-
-            /*  Use constant color alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][3] = constColor[3];
-            }
-
-            break;
-
-        case BLEND_ONE_MINUS_CONSTANT_COLOR:
-        case BLEND_ONE_MINUS_CONSTANT_ALPHA:
-
-            /*  Use 1 - constant color alpha component.  */
-            for(i = 0; i < stampFragments; i++)
-            {
-                factor[i][3] = 1.0f - constColor[3];
-            }
-
-            break;
-
-        default:
-            panic("FragmentOpEmulator", "factorA", "Unsupported blend factor function.");
-            break;
-    }
-
-}
-
 /*  Updates the stencil value for a fragment.  */
 void FragmentOpEmulator::updateStencil(StencilUpdateFunction func,
     u8bit stencilVal, u32bit &bufferVal)
@@ -941,11 +1022,56 @@ void FragmentOpEmulator::compare(CompareMode func, u8bit *value,
 //printf("FragmentOpEmulator::compare -> func %d value %p ref %x result %p stencilTest %s\n", func, value, ref, result,
 //    stencilTest?"T":"F");
 
+    /*  All the fragments pass if the stencil test is disabled.  */
+    if (!stencilTest)
+    {
+        for(i = 0; i < stampFragments; i++)
+            result[i] = TRUE;
+
+        return;
+    }
+
+    /*  The masked reference is the same for all the fragments.  */
+    u8bit maskedRef = ref & stencilTestMask;
+
     /*  Test each fragment stencil against the reference value.  */
-    for(i = 0; i < stampFragments; i++)
+    switch(func)
     {
-        /*  Compare reference and input value.  */
-        result[i] = compare(func, value[i], ref) || !stencilTest;
+        case GPU_NEVER:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = FALSE;
+            break;
+        case GPU_ALWAYS:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = TRUE;
+            break;
+        case GPU_LESS:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef < (value[i] & stencilTestMask));
+            break;
+        case GPU_LEQUAL:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef <= (value[i] & stencilTestMask));
+            break;
+        case GPU_EQUAL:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef == (value[i] & stencilTestMask));
+            break;
+        case GPU_GEQUAL:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef >= (value[i] & stencilTestMask));
+            break;
+        case GPU_GREATER:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef > (value[i] & stencilTestMask));
+            break;
+        case GPU_NOTEQUAL:
+            for(i = 0; i < stampFragments; i++)
+                result[i] = (maskedRef != (value[i] & stencilTestMask));
+            break;
+        default:
+            panic("FragmentOpEmulator", "compare", "Undefined compare mode.");
+            break;
     }
 }
 
@@ -953,13 +1079,35 @@ void FragmentOpEmulator::compare(CompareMode func, u8bit *value,
 void FragmentOpEmulator::compare(CompareMode func, u32bit *value,
     u32bit *ref, bool *result)
 {
-    u32bit i;
+    u32bit i = 0;
 
-    /*  Test each fragment z with stored z.  */
-    for(i = 0; i < stampFragments; i++)
+    /*  All the fragments pass if the z test is disabled.  */
+    if (!depthTest)
+    {
+        for(i = 0; i < stampFragments; i++)
+            result[i] = TRUE;
+
+        return;
+    }
+
+#ifdef __SSE2__
+    /*  Test four fragments at a time.  */
+    for(; (i + 4) <= stampFragments; i += 4)
+    {
+        u32bit mask = compareSIMD(func, _mm_loadu_si128((__m128i *) &value[i]), _mm_loadu_si128((__m128i *) &ref[i]));
+
+        result[i + 0] = (mask & 0x1) != 0;
+        result[i + 1] = (mask & 0x2) != 0;
+        result[i + 2] = (mask & 0x4) != 0;
+        result[i + 3] = (mask & 0x8) != 0;
+    }
+#endif
+
+    /*  Test each remaining fragment z with stored z.  */
+    for(; i < stampFragments; i++)
     {
         /*  Compare value with reference.  */
-        result[i] = compare(func, value[i], ref[i]) || !depthTest;
+        result[i] = compare(func, value[i], ref[i]);
     }
 }
 
@@ -1107,14 +1255,84 @@ bool FragmentOpEmulator::compare(CompareMode func, u32bit value, u32bit ref)
     return false;
 }
 
+#ifdef __SSE2__
+
+//  Selects the signed 32-bit minimum/maximum per lane.
+static inline __m128i minS32(__m128i a, __m128i b)
+{
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+static inline __m128i maxS32(__m128i a, __m128i b)
+{
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+//  Reduces the four lanes to the signed 32-bit minimum/maximum.
+static inline s32bit reduceMinS32(__m128i v)
+{
+    v = minS32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = minS32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+static inline s32bit reduceMaxS32(__m128i v)
+{
+    v = maxS32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = maxS32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+//  Unsigned 32-bit values are compared as signed values after flipping the sign bit.
+static const u32bit SIGN_BIAS = 0x80000000;
+
+//  Selects the HILO reference value for four values.  The reference high bits and identifiers
+//  are ordered by priority.  Sets the lanes of compressable for the values matching a reference.
+static inline __m128i hiloReference(__m128i high, const __m128i *refHigh, const __m128i *refId,
+    __m128i &compressable)
+{
+    __m128i flag = _mm_setzero_si128();
+
+    compressable = _mm_setzero_si128();
+
+    for(s32bit r = 3; r >= 0; r--)
+    {
+        __m128i eq = _mm_cmpeq_epi32(high, refHigh[r]);
+        flag = _mm_or_si128(_mm_and_si128(eq, refId[r]), _mm_andnot_si128(eq, flag));
+        compressable = _mm_or_si128(compressable, eq);
+    }
+
+    return flag;
+}
+
+#endif  // __SSE2__
+
 /*  Calculates the z and z-stencil maximum value.  */
 void FragmentOpEmulator::blockMaxZ(u32bit *input, u32bit size, u32bit &maxZ)
 {
+    u32bit i = 0;
+
     /*  Initial Z maximum is the minimum 24 bit value.  */
     maxZ = 0x00000000L;
 
+#ifdef __SSE2__
+    /*  Search four values at a time.  The 24 bit Z values are positive as signed 32 bit values.  */
+    if (size >= 4)
+    {
+        const __m128i zMask = _mm_set1_epi32(0x00ffffff);
+        __m128i maxV = _mm_setzero_si128();
+
+        for(; (i + 4) <= size; i += 4)
+            maxV = maxS32(maxV, _mm_and_si128(_mm_loadu_si128((__m128i *) &input[i]), zMask));
+
+        maxZ = u32bit(reduceMaxS32(maxV));
+    }
+#endif
+
     /*  Search for the min and max z/stencil values.  */
-    for(u32bit i = 0; i < size; i++)
+    for(; i < size; i++)
     {
         /*  Get the maximum Z value.  */
         u32bit d = input[i] & 0x00ffffff;
@@ -1126,7 +1344,7 @@ void FragmentOpEmulator::blockMaxZ(u32bit *input, u32bit size, u32bit &maxZ)
 void FragmentOpEmulator::blockMinMaxZ(u32bit *input, u32bit size,
     u32bit &minZ, u32bit &maxZ, u32bit &min, u32bit &max)
 {
-    u32bit i;
+    u32bit i = 0;
 
     /*  Initial minimum is the maximum 32 bit value.  */
     min = 0xffffffffL;
@@ -1140,8 +1358,38 @@ void FragmentOpEmulator::blockMinMaxZ(u32bit *input, u32bit size,
     /*  Initial Z maximum is the minimum 24 bit value.  */
     maxZ = 0x00000000L;
 
+#ifdef __SSE2__
+    /*  Search four values at a time.  */
+    if (size >= 4)
+    {
+        const __m128i zMask = _mm_set1_epi32(0x00ffffff);
+        const __m128i bias = _mm_set1_epi32(SIGN_BIAS);
+        __m128i minV = _mm_set1_epi32(0x7fffffff);
+        __m128i maxV = _mm_set1_epi32(SIGN_BIAS);
+        __m128i minZV = zMask;
+        __m128i maxZV = _mm_setzero_si128();
+
+        for(; (i + 4) <= size; i += 4)
+        {
+            __m128i d = _mm_loadu_si128((__m128i *) &input[i]);
+            __m128i biased = _mm_xor_si128(d, bias);
+            __m128i z = _mm_and_si128(d, zMask);
+
+            minV = minS32(minV, biased);
+            maxV = maxS32(maxV, biased);
+            minZV = minS32(minZV, z);
+            maxZV = maxS32(maxZV, z);
+        }
+
+        min = u32bit(reduceMinS32(minV)) ^ SIGN_BIAS;
+        max = u32bit(reduceMaxS32(maxV)) ^ SIGN_BIAS;
+        minZ = u32bit(reduceMinS32(minZV));
+        maxZ = u32bit(reduceMaxS32(maxZV));
+    }
+#endif
+
     /*  Search for the min and max z/stencil values.  */
-    for(i = 0; i < size; i++)
+    for(; i < size; i++)
     {
         /*  Get the minimun value.  */
         min = (input[i] < min)?input[i]:min;
@@ -1161,7 +1409,7 @@ void FragmentOpEmulator::blockMinMaxZ(u32bit *input, u32bit size,
 void FragmentOpEmulator::blockMinMax(u32bit *input, u32bit size,
     u32bit &min, u32bit &max)
 {
-    u32bit i;
+    u32bit i = 0;
 
     /*  Initial minimum is the maximum 32 bit value.  */
     min = 0xffffffffL;
@@ -1169,8 +1417,29 @@ void FragmentOpEmulator::blockMinMax(u32bit *input, u32bit size,
     /*  Initial maximum is the minimum 32 bit value.  */
     max = 0x00000000L;
 
+#ifdef __SSE2__
+    /*  Search four values at a time.  */
+    if (size >= 4)
+    {
+        const __m128i bias = _mm_set1_epi32(SIGN_BIAS);
+        __m128i minV = _mm_set1_epi32(0x7fffffff);
+        __m128i maxV = _mm_set1_epi32(SIGN_BIAS);
+
+        for(; (i + 4) <= size; i += 4)
+        {
+            __m128i biased = _mm_xor_si128(_mm_loadu_si128((__m128i *) &input[i]), bias);
+
+            minV = minS32(minV, biased);
+            maxV = maxS32(maxV, biased);
+        }
+
+        min = u32bit(reduceMinS32(minV)) ^ SIGN_BIAS;
+        max = u32bit(reduceMaxS32(maxV)) ^ SIGN_BIAS;
+    }
+#endif
+
     /*  Search for the min and max values.  */
-    for(i = 0; i < size; i++)
+    for(; i < size; i++)
     {
         /*  Get the minimun value.  */
         min = (input[i] < min)?input[i]:min;
@@ -1193,8 +1462,8 @@ FragmentOpEmulator::CompressionMode FragmentOpEmulator::hiloCompress(
     ReferenceValue flagL1;
     u32bit byteOff;
     u32bit bitOff;
-    u16bit loBitsL0[MAX_COMPR_FRAGMENTS];
-    u8bit loBitsL1[MAX_COMPR_FRAGMENTS];
+    u32bit loBitsL0[MAX_COMPR_FRAGMENTS];
+    u32bit loBitsL1[MAX_COMPR_FRAGMENTS];
     bool level0;
     bool level1;
     u32bit aux;
@@ -1232,8 +1501,50 @@ FragmentOpEmulator::CompressionMode FragmentOpEmulator::hiloCompress(
     //printf("hiloCompress => hiMaskL0 = %08x | loShiftL0 = %d | loMaskL0 = %08x | hiMaskL1 = %08x | loSfhitL1 = %d | loMaskL1 = %08x\n",
     //    hiMaskL0, loMaskL0, hiMaskL1, loShiftL1, loMaskL1);
                 
+    i = 0;
+
+#ifdef __SSE2__
+    /*  Reference values high bits and identifiers, ordered by priority.  */
+    const __m128i refId[4] = {_mm_set1_epi32(REF_A), _mm_set1_epi32(REF_B), _mm_set1_epi32(REF_MIN), _mm_set1_epi32(REF_MAX)};
+    const __m128i refHighL0[4] = {_mm_set1_epi32(aL0 & hiMaskL0), _mm_set1_epi32(bL0 & hiMaskL0),
+                                  _mm_set1_epi32(min & hiMaskL0), _mm_set1_epi32(max & hiMaskL0)};
+    const __m128i refHighL1[4] = {_mm_set1_epi32(aL1 & hiMaskL1), _mm_set1_epi32(bL1 & hiMaskL1),
+                                  _mm_set1_epi32(min & hiMaskL1), _mm_set1_epi32(max & hiMaskL1)};
+    const __m128i hiMaskL0V = _mm_set1_epi32(hiMaskL0);
+    const __m128i hiMaskL1V = _mm_set1_epi32(hiMaskL1);
+    const __m128i loMaskL0V = _mm_set1_epi32(loMaskL0);
+    const __m128i loMaskL1V = _mm_set1_epi32(loMaskL1);
+    const __m128i loShiftL0V = _mm_cvtsi32_si128(loShiftL0);
+    const __m128i loShiftL1V = _mm_cvtsi32_si128(loShiftL1);
+    const __m128i alignL0V = _mm_cvtsi32_si128(16 - 2 - loShiftL0);
+    const __m128i alignL1V = _mm_cvtsi32_si128(8 - 2 - loShiftL1);
+
+    /*  Create the low bits for four values at a time while any compression level is possible.  */
+    for(; ((i + 4) <= size) && (level0 || level1); i += 4)
+    {
+        __m128i value = _mm_loadu_si128((__m128i *) &input[i]);
+        __m128i comprL0;
+        __m128i comprL1;
+
+        /*  Get the reference value flags.  */
+        __m128i flagL0V = hiloReference(_mm_and_si128(value, hiMaskL0V), refHighL0, refId, comprL0);
+        __m128i flagL1V = hiloReference(_mm_and_si128(value, hiMaskL1V), refHighL1, refId, comprL1);
+
+        /*  Get the values low bits and reference flags.  */
+        __m128i loL0 = _mm_sll_epi32(_mm_or_si128(_mm_sll_epi32(flagL0V, loShiftL0V), _mm_and_si128(value, loMaskL0V)), alignL0V);
+        __m128i loL1 = _mm_sll_epi32(_mm_or_si128(_mm_sll_epi32(flagL1V, loShiftL1V), _mm_and_si128(value, loMaskL1V)), alignL1V);
+
+        _mm_storeu_si128((__m128i *) &loBitsL0[i], _mm_and_si128(loL0, _mm_set1_epi32(0xffff)));
+        _mm_storeu_si128((__m128i *) &loBitsL1[i], _mm_and_si128(loL1, _mm_set1_epi32(0xff)));
+
+        /*  Check if the four values are compressable.  */
+        level0 = level0 && (_mm_movemask_ps(_mm_castsi128_ps(comprL0)) == 0xf);
+        level1 = level1 && (_mm_movemask_ps(_mm_castsi128_ps(comprL1)) == 0xf);
+    }
+#endif
+
     /*  Create the vectors of low bits from the reference values.  */
-    for(i = 0; (i < size) && (level0 || level1); i++)
+    for(; (i < size) && (level0 || level1); i++)
     {
     
         /*  Check level 0 compression level.  */
@@ -1254,14 +1565,14 @@ FragmentOpEmulator::CompressionMode FragmentOpEmulator::hiloCompress(
         if (level0)
         {
             /*  Get value low bits for level 0.  */
-            loBitsL0[i] = ((flagL0 << loShiftL0) | (input[i] & loMaskL0)) << (16 - 2 - loShiftL0);
+            loBitsL0[i] = (((flagL0 << loShiftL0) | (input[i] & loMaskL0)) << (16 - 2 - loShiftL0)) & 0xffff;
         }
 
         /*  Check if level 1 compression is enabled.  */
         if (level1)
         {
             /*  Get value low bits for level 1.  */
-            loBitsL1[i] = ((flagL1 << loShiftL1) | (input[i] & loMaskL1)) << (8 - 2 - loShiftL1);
+            loBitsL1[i] = (((flagL1 << loShiftL1) | (input[i] & loMaskL1)) << (8 - 2 - loShiftL1)) & 0xff;
         }
         //printf(" <<< input = %08x | level0 = %s | level1 = %s | flagL0 = %02x | flagL1 = %02x\n", input[i],
         //    level0 ? "T" : "F", level1 ? "T" : "F", flagL0, flagL1);
@@ -1614,8 +1925,26 @@ void FragmentOpEmulator::compressionSwizzle(u32bit *input, u32bit *output, u32bi
     u32bit regionData;
     u32bit inData;
     u32bit swizzledData;
-    
-    for(u32bit i = 0; i < size; i++)
+    u32bit i = 0;
+
+#ifdef __SSE2__
+    //  Swizzle four words at a time.
+    for(; (i + 4) <= size; i += 4)
+    {
+        __m128i inData4 = _mm_loadu_si128((__m128i *) &input[i]);
+        __m128i swizzledData4 = _mm_setzero_si128();
+
+        for(u32bit r = 0; r < regions; r++)
+        {
+            __m128i regionData4 = _mm_and_si128(_mm_srl_epi32(inData4, _mm_cvtsi32_si128(inShift[r])), _mm_set1_epi32(inMask[r]));
+            swizzledData4 = _mm_or_si128(swizzledData4, _mm_sll_epi32(regionData4, _mm_cvtsi32_si128(outShift[r])));
+        }
+
+        _mm_storeu_si128((__m128i *) &output[i], swizzledData4);
+    }
+#endif
+
+    for(; i < size; i++)
     {
         //  Read input data.
         inData = input[i];
@@ -54,6 +54,26 @@ static const u32bit MAX_COMPR_FRAGMENTS = 128;
 class FragmentOpEmulator
 {
 
+public:
+
+    /**
+     *
+     *  Computes the RGB or alpha components of a blend factor for a group of fragments.
+     *  The fragment colors are stored as arrays of four float point components.
+     *
+     */
+    typedef void (*BlendFactorFunction)(const f32bit *constantColor, const f32bit *source,
+        const f32bit *destination, f32bit *factor, u32bit fragments);
+
+    /**
+     *
+     *  Combines the source and destination colors of a group of fragments using the
+     *  source and destination blend factors.
+     *
+     */
+    typedef void (*BlendEquationFunction)(f32bit *color, const f32bit *source, const f32bit *sFactor,
+        const f32bit *destination, const f32bit *dFactor, u32bit fragments);
+
 private:
 
     /**
@@ -107,37 +127,14 @@ private:
     QuadFloat *dFactor;         /**<  Pointer to the array for the destination blend factor.  */
 
 
-    /*  Private functions.  */
-
-    /**
-     *
-     *  Creates the blend factor for RGB components.
-     *
-     *  @param function The blend factor function.
-     *  @param constantColor The constant blend color.
-     *  @param source Pointer to the source color array.
-     *  @param destination Pointer to the destination color array.
-     *  @param factor Pointer to the factor array.
-     *
-     */
-
-    void factorRGB(BlendFunction function, QuadFloat constantColor, QuadFloat *source, QuadFloat *destination, QuadFloat *factor);
-
-    /**
-     *
-     *  Creates the blend factor for alpha component.
-     *
-     *  @param function The blend factor function.
-     *  @param constantColor The constant blend color.
-     *  @param source Pointer to the source color array.
-     *  @param destination Pointer to the destination color array.
-     *  @param factor Pointer to the factor array.
-     *
-     */
-
-    void factorAlpha(BlendFunction function, QuadFloat constantColor, QuadFloat *source,
-        QuadFloat *destination, QuadFloat *factor);
+    /*  Blend functions selected when the blend parameters are set.  */
+    BlendEquationFunction equationFunction[MAX_RENDER_TARGETS];  /**<  Blend equation function for each render target.  */
+    BlendFactorFunction srcRGBFunction[MAX_RENDER_TARGETS];      /**<  Source RGB factor function for each render target.  */
+    BlendFactorFunction srcAlphaFunction[MAX_RENDER_TARGETS];    /**<  Source alpha factor function for each render target.  */
+    BlendFactorFunction dstRGBFunction[MAX_RENDER_TARGETS];      /**<  Destination RGB factor function for each render target.  */
+    BlendFactorFunction dstAlphaFunction[MAX_RENDER_TARGETS];    /**<  Destination alpha factor function for each render target.  */
 
+    /*  Private functions.  */
 
     /**
      *
@@ -401,6 +398,31 @@ public:
 
     void stencilZTest(u32bit *stampZ, u32bit *bufferZ, bool *stampCull);
 
+    /**
+     *
+     *  Converts color data from RGBA8 format to RGBA32F format.
+     *
+     *  @param in Pointer to the RGBA8 color data.
+     *  @param out Pointer to the array where to store the RGBA32F colors.
+     *  @param fragments Number of colors to convert.
+     *
+     */
+
+    static void colorRGBA8ToRGBA32F(u8bit *in, QuadFloat *out, u32bit fragments);
+
+    /**
+     *
+     *  Converts color data from RGBA32F format to RGBA8 format.  The color components
+     *  are clamped to the [0, 1] range.
+     *
+     *  @param in Pointer to the RGBA32F colors.
+     *  @param out Pointer to the buffer where to store the RGBA8 color data.
+     *  @param fragments Number of colors to convert.
+     *
+     */
+
+    static void colorRGBA32FToRGBA8(QuadFloat *in, u8bit *out, u32bit fragments);
+
     /**
      *
      *  Swizzles the bits of the 32-bit words in the input block of data based on a list
@@ -0,0 +1,687 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Frame Dump Writer implementation file.
+ *
+ */
+
+/**
+ *
+ * @file FrameDumpWriter.cpp
+ *
+ * Implements the Frame Dump Writer class.
+ *
+ */
+
+#include "FrameDumpWriter.h"
+#include "GPUMath.h"
+#include "ImageSaver.h"
+#include "support.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace gpu3d
+{
+
+//  Same conversions used by the color buffer MSAA resolve.
+#define GAMMA(x) f32bit(GPU_POWER(f64bit(x), f64bit(1.0f / 2.2f)))
+#define LINEAR(x) f32bit(GPU_POWER(f64bit(x), f64bit(2.2f)))
+
+//  Converts a float32 value to clamped 8-bit normalized.
+static inline u8bit clampToU8(f32bit v)
+{
+    return u8bit(GPU_MIN(GPU_MAX(v, 0.0f), 1.0f) * 255.0f);
+}
+
+#ifdef __SSE2__
+
+//  Converts four float16 values (zero extended to 32-bit lanes) to float32.  Same result than
+//  GPUMath::convertFP16ToFP32:  scaling the shifted exponent and mantissa by 2^112 is exact for
+//  normalized and denormalized values, infinites and NaNs get the float32 maximum exponent.
+static inline __m128 convertFP16SIMD(__m128i half)
+{
+    const __m128i absMask = _mm_set1_epi32(0x7FFF);
+    const __m128i expMask = _mm_set1_epi32(0x7C00);
+    const __m128i infNaNExp = _mm_set1_epi32(0x7F800000);
+    const __m128 scale = _mm_castsi128_ps(_mm_set1_epi32(0x77800000));
+
+    __m128i absValue = _mm_and_si128(half, absMask);
+    __m128 value = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(absValue, 13)), scale);
+    __m128i infNaN = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(half, expMask), expMask), infNaNExp);
+    __m128i sign = _mm_slli_epi32(_mm_xor_si128(half, absValue), 16);
+
+    return _mm_castsi128_ps(_mm_or_si128(_mm_or_si128(_mm_castps_si128(value), infNaN), sign));
+}
+
+//  Converts four float32 values to clamped 8-bit normalized, same operations than clampToU8.
+//  MAXPS and MINPS return the second operand for NaNs, as GPU_MAX and GPU_MIN.
+static inline __m128i clampToU8SIMD(__m128 v)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(255.0f)));
+}
+
+//  Packs the 8-bit RGBA channels of four pixels (one 32-bit lane per channel) into RGBA8 pixels.
+static inline __m128i packRGBA8SIMD(__m128i p0, __m128i p1, __m128i p2, __m128i p3)
+{
+    return _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+}
+
+//  Swizzles four RGBA8 pixels to BGRA8 with the alpha set to 255, or to the alpha replicated in
+//  all the channels.
+static inline __m128i finishBGRA8SIMD(__m128i rgba, bool alphaMode)
+{
+    if (alphaMode)
+    {
+        __m128i a = _mm_srli_epi32(rgba, 24);
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+        return _mm_or_si128(a, _mm_slli_epi32(a, 16));
+    }
+
+    __m128i rb = _mm_and_si128(rgba, _mm_set1_epi32(0x00FF00FF));
+    __m128i g = _mm_and_si128(rgba, _mm_set1_epi32(0x0000FF00));
+    __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+
+    return _mm_or_si128(_mm_or_si128(br, g), _mm_set1_epi32(0xFF000000));
+}
+
+//  Reads the RGBA color of a 16-bit per channel pixel (float16 or normalized) as float32.
+static inline __m128 readColor16SIMD(const u8bit *data, bool fp16)
+{
+    __m128i channels = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *) data), _mm_setzero_si128());
+
+    if (fp16)
+        return convertFP16SIMD(channels);
+    else
+        return _mm_div_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(65535.0f));
+}
+
+//  Reads the RGBA color of a RGBA8 pixel as float32.
+static inline __m128 readColor8SIMD(const u8bit *data)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i channels = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(*((const s32bit *) data)), zero), zero);
+
+    return _mm_div_ps(_mm_cvtepi32_ps(channels), _mm_set1_ps(255.0f));
+}
+
+#endif  // __SSE2__
+
+FrameDumpWriter::FrameDumpWriter() :
+
+    pngOutput(false), asyncOutput(false), image(NULL), imageSize(0), busy(false), threadStarted(false)
+
+{
+    for(u32bit i = 0; i < 65536; i++)
+    {
+        fp16ToF32[i] = GPUMath::convertFP16ToFP32(f16bit(i));
+        fp16ToU8[i] = clampToU8(fp16ToF32[i]);
+        linearFP16[i] = LINEAR(fp16ToF32[i]);
+
+        unorm16ToU8[i] = clampToU8(f32bit(i) / 65535.0f);
+        linearUnorm16[i] = LINEAR(f32bit(i) / 65535.0f);
+    }
+
+    for(u32bit i = 0; i < 256; i++)
+        linearUnorm8[i] = LINEAR(f32bit(i) / 255.0f);
+
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&jobQueued, NULL);
+    pthread_cond_init(&jobDone, NULL);
+
+    //  Create the image saver before the background thread may use it.
+    ImageSaver::getInstance();
+}
+
+FrameDumpWriter &FrameDumpWriter::getInstance()
+{
+    static FrameDumpWriter *frameDumpWriter = NULL;
+
+    if (frameDumpWriter == NULL)
+        frameDumpWriter = new FrameDumpWriter;
+
+    return *frameDumpWriter;
+}
+
+void FrameDumpWriter::setOptions(bool png, bool async)
+{
+    //  Dumps already queued are written with the previous options.
+    flush();
+
+    pngOutput = png;
+    asyncOutput = async;
+}
+
+void FrameDumpWriter::dump(const char *filename, const FrameDumpSurface &surface, const u8bit *buffer, u32bit size)
+{
+    if ((surface.samples > 1) && ((surface.mode == FrameDumpSurface::DEPTH) || (surface.mode == FrameDumpSurface::STENCIL)))
+        panic("FrameDumpWriter", "dump", "Multisampling not supported for depth and stencil dumps.");
+
+    if (!asyncOutput)
+    {
+        //  Check if the image buffer is large enough.
+        if (imageSize < (surface.width * surface.height * 4))
+        {
+            delete[] image;
+            imageSize = surface.width * surface.height * 4;
+            image = new u8bit[imageSize];
+        }
+
+        FrameDumpSurface current = surface;
+        writeImage(filename, current, buffer, image);
+
+        return;
+    }
+
+    if (!threadStarted)
+    {
+        if (pthread_create(&writerThread, NULL, &FrameDumpWriter::writerMain, this) != 0)
+            panic("FrameDumpWriter", "dump", "Error creating the frame dump thread.");
+
+        threadStarted = true;
+
+        atexit(&FrameDumpWriter::flushAtExit);
+    }
+
+    //  The simulator may update the buffer before the dump is written.
+    Job job;
+    job.filename = filename;
+    job.surface = surface;
+    job.buffer = new u8bit[size];
+    memcpy(job.buffer, buffer, size);
+
+    pthread_mutex_lock(&lock);
+
+    while (jobs.size() >= MAX_PENDING_DUMPS)
+        pthread_cond_wait(&jobDone, &lock);
+
+    jobs.push_back(job);
+
+    pthread_cond_signal(&jobQueued);
+    pthread_mutex_unlock(&lock);
+}
+
+void FrameDumpWriter::flush()
+{
+    if (!threadStarted)
+        return;
+
+    pthread_mutex_lock(&lock);
+
+    while (!jobs.empty() || busy)
+        pthread_cond_wait(&jobDone, &lock);
+
+    pthread_mutex_unlock(&lock);
+}
+
+void FrameDumpWriter::flushAtExit()
+{
+    FrameDumpWriter &writer = getInstance();
+
+    //  A panic in the background thread also runs the exit handlers.
+    if (!pthread_equal(pthread_self(), writer.writerThread))
+        writer.flush();
+}
+
+void *FrameDumpWriter::writerMain(void *arg)
+{
+    static_cast<FrameDumpWriter *>(arg)->writeJobs();
+
+    return NULL;
+}
+
+void FrameDumpWriter::writeJobs()
+{
+    vector<u8bit> jobImage;
+
+    while (true)
+    {
+        pthread_mutex_lock(&lock);
+
+        while (jobs.empty())
+            pthread_cond_wait(&jobQueued, &lock);
+
+        Job job = jobs.front();
+        jobs.pop_front();
+        busy = true;
+
+        pthread_mutex_unlock(&lock);
+
+        jobImage.resize(job.surface.width * job.surface.height * 4);
+        writeImage(job.filename.c_str(), job.surface, job.buffer, &jobImage[0]);
+        delete[] job.buffer;
+
+        pthread_mutex_lock(&lock);
+
+        busy = false;
+
+        pthread_cond_broadcast(&jobDone);
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+void FrameDumpWriter::writeImage(const char *filename, FrameDumpSurface &surface, const u8bit *buffer, u8bit *image)
+{
+    convert(surface, buffer, image);
+
+    char name[256];
+    strncpy(name, filename, sizeof(name) - 1);
+    name[sizeof(name) - 1] = 0;
+
+    if (pngOutput)
+        ImageSaver::getInstance().savePNG(name, surface.width, surface.height, image);
+    else
+        ImageSaver::getInstance().savePPM(name, surface.width, surface.height, image);
+}
+
+void FrameDumpWriter::convert(FrameDumpSurface &surface, const u8bit *buffer, u8bit *image)
+{
+    vector<u32bit> address(surface.width);
+
+    for(u32bit row = 0; row < surface.height; row++)
+    {
+        //  The first row of the image is the top of the surface.
+        u32bit y = surface.d3d9PixelCoordinates ? row : (surface.height - 1) - row;
+
+        for(u32bit x = 0; x < surface.width; x++)
+            address[x] = surface.pixelMapper.computeAddress(x, y);
+
+        u8bit *data = &image[row * surface.width * 4];
+
+        switch(surface.mode)
+        {
+            case FrameDumpSurface::COLOR:
+            case FrameDumpSurface::ALPHA:
+
+                if (surface.samples > 1)
+                    resolveColorRow(surface, buffer, &address[0], data);
+                else
+                    convertColorRow(surface, buffer, &address[0], data);
+
+                break;
+
+            case FrameDumpSurface::DEPTH:
+
+                //  Invert for better reading with irfan view.
+                for(u32bit x = 0; x < surface.width; x++)
+                {
+                    const u8bit *pixel = &buffer[address[x]];
+                    data[x * 4 + 0] = pixel[0];
+                    data[x * 4 + 1] = pixel[1];
+                    data[x * 4 + 2] = pixel[2];
+                    data[x * 4 + 3] = 255;
+                }
+
+                break;
+
+            case FrameDumpSurface::STENCIL:
+
+                //  Put some color to make small differences more easy to discover.
+                for(u32bit x = 0; x < surface.width; x++)
+                {
+                    u8bit stencil = buffer[address[x] + 3];
+                    data[x * 4 + 0] = (stencil & 0x0F) << 4;
+                    data[x * 4 + 1] = stencil & 0xF0;
+                    data[x * 4 + 2] = stencil;
+                    data[x * 4 + 3] = 255;
+                }
+
+                break;
+        }
+    }
+}
+
+void FrameDumpWriter::convertColorRow(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row)
+{
+    u32bit width = surface.width;
+
+#ifdef __SSE2__
+    //  Convert four pixels at a time, the remaining pixels are converted below.
+    u32bit first = convertColorRowSIMD(surface, buffer, address, row);
+#else
+    u32bit first = 0;
+#endif
+
+    //  Convert the row to BGRA.
+    switch(surface.format)
+    {
+        case GPU_RGBA8888:
+
+            for(u32bit x = first; x < width; x++)
+            {
+                const u8bit *pixel = &buffer[address[x]];
+                row[x * 4 + 0] = pixel[2];
+                row[x * 4 + 1] = pixel[1];
+                row[x * 4 + 2] = pixel[0];
+                row[x * 4 + 3] = pixel[3];
+            }
+
+            break;
+
+        case GPU_RG16F:
+
+            for(u32bit x = first; x < width; x++)
+            {
+                const u16bit *pixel = (const u16bit *) &buffer[address[x]];
+                row[x * 4 + 0] = 0;
+                row[x * 4 + 1] = fp16ToU8[pixel[1]];
+                row[x * 4 + 2] = fp16ToU8[pixel[0]];
+                row[x * 4 + 3] = 0;
+            }
+
+            break;
+
+        case GPU_R32F:
+
+            for(u32bit x = first; x < width; x++)
+            {
+                row[x * 4 + 0] = 0;
+                row[x * 4 + 1] = 0;
+                row[x * 4 + 2] = clampToU8(*((const f32bit *) &buffer[address[x]]));
+                row[x * 4 + 3] = 0;
+            }
+
+            break;
+
+        case GPU_RGBA16:
+
+            for(u32bit x = first; x < width; x++)
+            {
+                const u16bit *pixel = (const u16bit *) &buffer[address[x]];
+                row[x * 4 + 0] = unorm16ToU8[pixel[2]];
+                row[x * 4 + 1] = unorm16ToU8[pixel[1]];
+                row[x * 4 + 2] = unorm16ToU8[pixel[0]];
+                row[x * 4 + 3] = unorm16ToU8[pixel[3]];
+            }
+
+            break;
+
+        case GPU_RGBA16F:
+
+            for(u32bit x = first; x < width; x++)
+            {
+                const u16bit *pixel = (const u16bit *) &buffer[address[x]];
+                row[x * 4 + 0] = fp16ToU8[pixel[2]];
+                row[x * 4 + 1] = fp16ToU8[pixel[1]];
+                row[x * 4 + 2] = fp16ToU8[pixel[0]];
+                row[x * 4 + 3] = fp16ToU8[pixel[3]];
+            }
+
+            break;
+
+        default:
+
+            //  Formats not supported by the color buffer are dumped as white.
+            memset(&row[first * 4], 255, (width - first) * 4);
+            break;
+    }
+
+    if (surface.mode == FrameDumpSurface::ALPHA)
+    {
+        for(u32bit x = first; x < width; x++)
+            row[x * 4 + 0] = row[x * 4 + 1] = row[x * 4 + 2] = row[x * 4 + 3];
+    }
+    else
+    {
+        for(u32bit x = first; x < width; x++)
+            row[x * 4 + 3] = 255;
+    }
+}
+
+#ifdef __SSE2__
+
+u32bit FrameDumpWriter::convertColorRowSIMD(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row)
+{
+    u32bit width = surface.width & ~3;
+    bool alphaMode = (surface.mode == FrameDumpSurface::ALPHA);
+    __m128i pixels;
+
+    switch(surface.format)
+    {
+        case GPU_RGBA8888:
+
+            for(u32bit x = 0; x < width; x += 4)
+            {
+                pixels = _mm_set_epi32(*((const s32bit *) &buffer[address[x + 3]]), *((const s32bit *) &buffer[address[x + 2]]),
+                                       *((const s32bit *) &buffer[address[x + 1]]), *((const s32bit *) &buffer[address[x]]));
+                _mm_storeu_si128((__m128i *) &row[x * 4], finishBGRA8SIMD(pixels, alphaMode));
+            }
+
+            return width;
+
+        case GPU_RGBA16:
+        case GPU_RGBA16F:
+
+            {
+                bool fp16 = (surface.format == GPU_RGBA16F);
+
+                for(u32bit x = 0; x < width; x += 4)
+                {
+                    pixels = packRGBA8SIMD(clampToU8SIMD(readColor16SIMD(&buffer[address[x]], fp16)),
+                                           clampToU8SIMD(readColor16SIMD(&buffer[address[x + 1]], fp16)),
+                                           clampToU8SIMD(readColor16SIMD(&buffer[address[x + 2]], fp16)),
+                                           clampToU8SIMD(readColor16SIMD(&buffer[address[x + 3]], fp16)));
+                    _mm_storeu_si128((__m128i *) &row[x * 4], finishBGRA8SIMD(pixels, alphaMode));
+                }
+            }
+
+            return width;
+
+        default:
+
+            //  Two channel and single channel formats use the scalar conversion.
+            return 0;
+    }
+}
+
+#endif  // __SSE2__
+
+void FrameDumpWriter::readSample(TextureFormat format, const u8bit *data, f32bit *color, f32bit *linear)
+{
+    const u16bit *data16 = (const u16bit *) data;
+
+    switch(format)
+    {
+        case GPU_RGBA8888:
+
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = f32bit(data[c]) / 255.0f;
+            for(u32bit c = 0; c < 3; c++)
+                linear[c] = linearUnorm8[data[c]];
+
+            break;
+
+        case GPU_RG16F:
+
+            color[0] = fp16ToF32[data16[0]];
+            color[1] = fp16ToF32[data16[1]];
+            color[2] = color[3] = 0.0f;
+            linear[0] = linearFP16[data16[0]];
+            linear[1] = linearFP16[data16[1]];
+            linear[2] = 0.0f;
+
+            break;
+
+        case GPU_R32F:
+
+            color[0] = *((const f32bit *) data);
+            color[1] = color[2] = color[3] = 0.0f;
+            linear[0] = LINEAR(color[0]);
+            linear[1] = linear[2] = 0.0f;
+
+            break;
+
+        case GPU_RGBA16:
+
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = f32bit(data16[c]) / 65535.0f;
+            for(u32bit c = 0; c < 3; c++)
+                linear[c] = linearUnorm16[data16[c]];
+
+            break;
+
+        case GPU_RGBA16F:
+
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = fp16ToF32[data16[c]];
+            for(u32bit c = 0; c < 3; c++)
+                linear[c] = linearFP16[data16[c]];
+
+            break;
+
+        default:
+
+            color[0] = color[1] = color[2] = color[3] = 0.0f;
+            linear[0] = linear[1] = linear[2] = 0.0f;
+            break;
+    }
+}
+
+void FrameDumpWriter::resolveColorRow(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row)
+{
+#ifdef __SSE2__
+    //  The four channel formats are resolved with a vector per sample.
+    if (resolveColorRowSIMD(surface, buffer, address, row))
+        return;
+#endif
+
+    u32bit samples = surface.samples;
+    u32bit bytesSample = ((surface.format == GPU_RGBA16) || (surface.format == GPU_RGBA16F)) ? 8 : 4;
+
+    for(u32bit x = 0; x < surface.width; x++)
+    {
+        f32bit referenceColor[4];
+        f32bit currentColor[4];
+        f32bit linearColor[3];
+        f32bit resolvedColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        bool fullCoverage = true;
+
+        readSample(surface.format, &buffer[address[x]], referenceColor, linearColor);
+
+        //  Accumulate the color for all the samples in the pixel.
+        for(u32bit i = 0; i < samples; i++)
+        {
+            readSample(surface.format, &buffer[address[x] + i * bytesSample], currentColor, linearColor);
+
+            resolvedColor[0] += linearColor[0];
+            resolvedColor[1] += linearColor[1];
+            resolvedColor[2] += linearColor[2];
+            resolvedColor[3] += currentColor[3];
+
+            fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
+                                        && (referenceColor[1] == currentColor[1])
+                                        && (referenceColor[2] == currentColor[2]);
+        }
+
+        u8bit *pixel = &row[x * 4];
+
+        //  Check if there is a single color for the pixel.
+        if (fullCoverage)
+        {
+            pixel[0] = clampToU8(referenceColor[2]);
+            pixel[1] = clampToU8(referenceColor[1]);
+            pixel[2] = clampToU8(referenceColor[0]);
+            pixel[3] = clampToU8(referenceColor[3]);
+        }
+        else
+        {
+            //  Resolve color as the average of all the sample colors.
+            pixel[0] = clampToU8(GAMMA(resolvedColor[2] / f32bit(samples)));
+            pixel[1] = clampToU8(GAMMA(resolvedColor[1] / f32bit(samples)));
+            pixel[2] = clampToU8(GAMMA(resolvedColor[0] / f32bit(samples)));
+            pixel[3] = clampToU8(resolvedColor[3] / f32bit(samples));
+        }
+
+        if (surface.mode == FrameDumpSurface::ALPHA)
+            pixel[0] = pixel[1] = pixel[2] = pixel[3];
+        else
+            pixel[3] = 255;
+    }
+}
+
+#ifdef __SSE2__
+
+bool FrameDumpWriter::resolveColorRowSIMD(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row)
+{
+    TextureFormat format = surface.format;
+
+    if ((format != GPU_RGBA8888) && (format != GPU_RGBA16) && (format != GPU_RGBA16F))
+        return false;
+
+    bool rgba8 = (format == GPU_RGBA8888);
+    bool fp16 = (format == GPU_RGBA16F);
+    bool alphaMode = (surface.mode == FrameDumpSurface::ALPHA);
+    u32bit samples = surface.samples;
+    u32bit bytesSample = rgba8 ? 4 : 8;
+    const f32bit *linearTable = rgba8 ? linearUnorm8 : (fp16 ? linearFP16 : linearUnorm16);
+    const __m128 alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+    const __m128 samplesDivisor = _mm_set1_ps(f32bit(samples));
+
+    for(u32bit x = 0; x < surface.width; x++)
+    {
+        const u8bit *pixel = &buffer[address[x]];
+        __m128 referenceColor = rgba8 ? readColor8SIMD(pixel) : readColor16SIMD(pixel, fp16);
+        __m128 resolvedColor = _mm_setzero_ps();
+        s32bit equalChannels = 0x0F;
+
+        //  Accumulate the linear RGB and the alpha of all the samples in the pixel.
+        for(u32bit i = 0; i < samples; i++)
+        {
+            const u8bit *sample = &pixel[i * bytesSample];
+            __m128 currentColor = rgba8 ? readColor8SIMD(sample) : readColor16SIMD(sample, fp16);
+            __m128 linearColor;
+
+            if (rgba8)
+                linearColor = _mm_set_ps(0.0f, linearTable[sample[2]], linearTable[sample[1]], linearTable[sample[0]]);
+            else
+            {
+                const u16bit *sample16 = (const u16bit *) sample;
+                linearColor = _mm_set_ps(0.0f, linearTable[sample16[2]], linearTable[sample16[1]], linearTable[sample16[0]]);
+            }
+
+            resolvedColor = _mm_add_ps(resolvedColor, _mm_or_ps(linearColor, _mm_and_ps(currentColor, alphaMask)));
+            equalChannels &= _mm_movemask_ps(_mm_cmpeq_ps(referenceColor, currentColor));
+        }
+
+        __m128i color;
+
+        //  Check if there is a single color for the pixel.
+        if ((equalChannels & 0x07) == 0x07)
+            color = clampToU8SIMD(referenceColor);
+        else
+        {
+            //  Resolve color as the average of all the sample colors.
+            f32bit average[4];
+            _mm_storeu_ps(average, _mm_div_ps(resolvedColor, samplesDivisor));
+
+            for(u32bit c = 0; c < 3; c++)
+                average[c] = GAMMA(average[c]);
+
+            color = clampToU8SIMD(_mm_loadu_ps(average));
+        }
+
+        __m128i rgba = _mm_packus_epi16(_mm_packs_epi32(color, color), color);
+        *((s32bit *) &row[x * 4]) = _mm_cvtsi128_si32(finishBGRA8SIMD(rgba, alphaMode));
+    }
+
+    return true;
+}
+
+#endif  // __SSE2__
+
+} // namespace gpu3d
@@ -0,0 +1,240 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Frame Dump Writer definition file.
+ *
+ */
+
+/**
+ *
+ * @file FrameDumpWriter.h
+ *
+ * Defines a class that converts color, depth and stencil buffers to images and
+ * writes them into PPM or PNG files, optionally from a background thread.
+ *
+ */
+
+#ifndef _FRAMEDUMPWRITER_
+    #define _FRAMEDUMPWRITER_
+
+#include "GPUTypes.h"
+#include "GPU.h"
+#include "PixelMapper.h"
+#include <pthread.h>
+#include <string>
+#include <deque>
+
+namespace gpu3d
+{
+
+/**
+ *
+ *  Describes a surface to dump.
+ *
+ */
+struct FrameDumpSurface
+{
+    /**
+     *  Defines how the surface is converted to an image.
+     */
+    enum Mode
+    {
+        COLOR,      /**<  RGB from the color buffer.  */
+        ALPHA,      /**<  Alpha from the color buffer written in all the channels.  */
+        DEPTH,      /**<  24-bit depth from the z stencil buffer written as RGB.  */
+        STENCIL     /**<  Stencil from the z stencil buffer.  */
+    };
+
+    Mode mode;                  /**<  Conversion mode.  */
+    TextureFormat format;       /**<  Format of the color buffer.  */
+    u32bit width;               /**<  Horizontal resolution.  */
+    u32bit height;              /**<  Vertical resolution.  */
+    u32bit samples;             /**<  MSAA samples per pixel, 1 if multisampling is disabled.  */
+    bool d3d9PixelCoordinates;  /**<  Row 0 is the top of the image.  */
+    PixelMapper pixelMapper;    /**<  Maps pixels to addresses inside the buffer.  */
+};
+
+/**
+ *
+ *  Frame Dump Writer class.
+ *
+ *  Converts color, depth and stencil buffers in the GPU tiled layout to BGRA8 images and
+ *  writes them into PPM or PNG files.  The conversion is done a row at a time: the
+ *  addresses of the row are computed first and then a loop specialized for the buffer format
+ *  converts the pixels.  Float16 and 16-bit normalized channels are converted to 8-bit with
+ *  precomputed tables and the sRGB linearization used by the MSAA resolve is also tabulated
+ *  for all the formats except float32.  With SSE2 the four channel formats are converted
+ *  four pixels at a time and resolved with a vector per sample.  The result is the same than
+ *  converting the pixels one by one.
+ *
+ *  When asynchronous dumps are enabled the buffer is copied and the conversion and the
+ *  file write are done by a background thread.  The number of queued dumps is bounded, the
+ *  simulator waits when the queue is full.  Pending dumps are written before the program
+ *  exits.
+ *
+ */
+class FrameDumpWriter
+{
+private:
+
+    /**
+     *  A dump pending to be written.
+     */
+    struct Job
+    {
+        std::string filename;       /**<  Name of the file without extension.  */
+        FrameDumpSurface surface;   /**<  Description of the surface.  */
+        u8bit *buffer;              /**<  Copy of the surface data.  */
+    };
+
+    static const u32bit MAX_PENDING_DUMPS = 4;  /**<  Maximum number of dumps queued for the background thread.  */
+
+    bool pngOutput;             /**<  Write PNG files instead of PPM files.  */
+    bool asyncOutput;           /**<  Dumps are written by the background thread.  */
+
+    //  Conversion tables.
+    u8bit fp16ToU8[65536];      /**<  Float16 to clamped 8-bit normalized.  */
+    u8bit unorm16ToU8[65536];   /**<  16-bit normalized to 8-bit normalized.  */
+    f32bit fp16ToF32[65536];    /**<  Float16 to float32.  */
+    f32bit linearFP16[65536];   /**<  sRGB to linear for float16 values.  */
+    f32bit linearUnorm16[65536];/**<  sRGB to linear for 16-bit normalized values.  */
+    f32bit linearUnorm8[256];   /**<  sRGB to linear for 8-bit normalized values.  */
+
+    u8bit *image;               /**<  Image buffer used by synchronous dumps.  */
+    u32bit imageSize;           /**<  Size of the synchronous image buffer.  */
+
+    //  Background thread state.
+    std::deque<Job> jobs;       /**<  Dumps waiting for the background thread.  */
+    bool busy;                  /**<  The background thread is writing a dump.  */
+    bool threadStarted;         /**<  The background thread was created.  */
+    pthread_t writerThread;     /**<  Background thread.  */
+    pthread_mutex_t lock;       /**<  Protects the job queue.  */
+    pthread_cond_t jobQueued;   /**<  Signaled when a job is queued.  */
+    pthread_cond_t jobDone;     /**<  Signaled when a job is finished.  */
+
+    /**
+     *
+     *  Constructor.
+     *
+     */
+    FrameDumpWriter();
+
+    /**
+     *  Background thread entry point.
+     */
+    static void *writerMain(void *arg);
+
+    /**
+     *  Background thread loop.
+     */
+    void writeJobs();
+
+    /**
+     *  Writes the pending dumps at program exit.
+     */
+    static void flushAtExit();
+
+    /**
+     *
+     *  Converts a surface and writes the image file.
+     *
+     *  @param filename Name of the file without extension.
+     *  @param surface Description of the surface.
+     *  @param buffer Surface data.
+     *  @param image Buffer for the BGRA8 image (width x height x 4 bytes).
+     *
+     */
+    void writeImage(const char *filename, FrameDumpSurface &surface, const u8bit *buffer, u8bit *image);
+
+    /**
+     *  Converts a row of color pixels without multisampling.
+     */
+    void convertColorRow(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row);
+
+    /**
+     *  Converts a row of color pixels resolving the samples of the pixels.
+     */
+    void resolveColorRow(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row);
+
+    /**
+     *  Reads the RGBA color of a sample as float32 and the linear space RGB color.
+     */
+    void readSample(TextureFormat format, const u8bit *data, f32bit *color, f32bit *linear);
+
+#ifdef __SSE2__
+    /**
+     *  Converts the four channel formats four pixels at a time with SSE2.  Returns the number
+     *  of pixels converted, the remaining pixels are converted by convertColorRow.
+     */
+    u32bit convertColorRowSIMD(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row);
+
+    /**
+     *  Resolves a row of a four channel format with an SSE2 vector per sample.  Returns false
+     *  for the other formats.
+     */
+    bool resolveColorRowSIMD(const FrameDumpSurface &surface, const u8bit *buffer, const u32bit *address, u8bit *row);
+#endif
+
+public:
+
+    /**
+     *
+     *  Get the single instance of the Frame Dump Writer.
+     *
+     *  @return Reference to the single instance of the Frame Dump Writer.
+     *
+     */
+    static FrameDumpWriter &getInstance();
+
+    /**
+     *
+     *  Sets the output options.
+     *
+     *  @param png Write PNG files instead of PPM files.
+     *  @param async Convert and write the dumps in a background thread.
+     *
+     */
+    void setOptions(bool png, bool async);
+
+    /**
+     *
+     *  Dumps a surface into an image file.  The file extension is added to the filename.
+     *
+     *  @param filename Name of the file without extension.
+     *  @param surface Description of the surface.
+     *  @param buffer Pointer to the surface data.
+     *  @param size Bytes of surface data.
+     *
+     */
+    void dump(const char *filename, const FrameDumpSurface &surface, const u8bit *buffer, u32bit size);
+
+    /**
+     *
+     *  Waits until all the pending dumps are written.
+     *
+     */
+    void flush();
+
+    /**
+     *
+     *  Converts a surface into a BGRA8 image with the first row at the top of the image.
+     *
+     *  @param surface Description of the surface.
+     *  @param buffer Surface data.
+     *  @param image Buffer for the image (width x height x 4 bytes).
+     *
+     */
+    void convert(FrameDumpSurface &surface, const u8bit *buffer, u8bit *image);
+};
+
+} // namespace gpu3d
+
+#endif  // _FRAMEDUMPWRITER_
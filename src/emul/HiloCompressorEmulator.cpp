@@ -15,9 +15,57 @@
 #include "BitStreamWriter.h"
 #include "BitStreamReader.h"
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 namespace gpu3d
 {
 
+#ifdef __SSE2__
+
+// Shifts the selected bits of four values.
+static inline __m128i maskShiftLeft(__m128i data, u32bit mask, int shift)
+{
+    return _mm_sll_epi32(_mm_and_si128(data, _mm_set1_epi32(mask)), _mm_cvtsi32_si128(shift));
+}
+
+static inline __m128i maskShiftRight(__m128i data, u32bit mask, int shift)
+{
+    return _mm_srl_epi32(_mm_and_si128(data, _mm_set1_epi32(mask)), _mm_cvtsi32_si128(shift));
+}
+
+// Reorders the bits of four values (see HiloCompressorEmulator::reorder).
+static inline __m128i reorder4(__m128i data, const HiloLevelConfig& config)
+{
+    __m128i r = _mm_and_si128(data, _mm_set1_epi32(config.reHighMask1));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.reHighMask2, config.reHighShift2));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.reHighMask3, config.reHighShift3));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.reHighMask4, config.reHighShift4));
+    r = _mm_or_si128(r, maskShiftRight(data, config.reLowMask1, config.reLowShift1));
+    r = _mm_or_si128(r, maskShiftRight(data, config.reLowMask2, config.reLowShift2));
+    r = _mm_or_si128(r, maskShiftRight(data, config.reLowMask3, config.reLowShift3));
+    return _mm_or_si128(r, _mm_and_si128(data, _mm_set1_epi32(config.reLowMask4)));
+}
+
+// Restores the bit order of four values (see HiloCompressorEmulator::unreorder).
+static inline __m128i unreorder4(__m128i data, const HiloLevelConfig& config)
+{
+    __m128i r = _mm_and_si128(data, _mm_set1_epi32(config.reHighMask1));
+    r = _mm_or_si128(r, maskShiftRight(data, config.unreHighMask2, config.reHighShift2));
+    r = _mm_or_si128(r, maskShiftRight(data, config.unreHighMask3, config.reHighShift3));
+    r = _mm_or_si128(r, maskShiftRight(data, config.unreHighMask4, config.reHighShift4));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.unreLowMask1, config.reLowShift1));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.unreLowMask2, config.reLowShift2));
+    r = _mm_or_si128(r, maskShiftLeft(data, config.unreLowMask3, config.reLowShift3));
+    return _mm_or_si128(r, _mm_and_si128(data, _mm_set1_epi32(config.reLowMask4)));
+}
+
+// Unsigned 32-bit values are compared as signed values after flipping the sign bit.
+static const u32bit SIGN_BIAS = 0x80000000;
+
+#endif  // __SSE2__
+
 HiloCompressorEmulator::HiloCompressorEmulator(int numLevels, u32bit dataMask, bool reorderData)
     : numLevels(numLevels), dataMask(dataMask), reorderData(reorderData)
 {
@@ -72,8 +120,39 @@ MinMaxInfo HiloCompressorEmulator::findMinMax(
 {
     u32bit min = 0xffffffff;
     u32bit max = 0x00000000;
-    
-    for (int i = 0; i < size; i++) {
+    int i = 0;
+
+#ifdef __SSE2__
+    // Search four values at a time.
+    if (size >= 4) {
+        const __m128i bias = _mm_set1_epi32(SIGN_BIAS);
+        const __m128i mask = _mm_set1_epi32(dataMask);
+        __m128i minV = _mm_set1_epi32(0x7fffffff);
+        __m128i maxV = _mm_set1_epi32(SIGN_BIAS);
+
+        for (; (i + 4) <= size; i += 4) {
+            __m128i d = _mm_and_si128(_mm_loadu_si128((__m128i *) &data[i]), mask);
+            d = _mm_xor_si128(reorderData ? reorder4(d, config) : d, bias);
+
+            __m128i lt = _mm_cmplt_epi32(d, minV);
+            __m128i gt = _mm_cmpgt_epi32(d, maxV);
+            minV = _mm_or_si128(_mm_and_si128(lt, d), _mm_andnot_si128(lt, minV));
+            maxV = _mm_or_si128(_mm_and_si128(gt, d), _mm_andnot_si128(gt, maxV));
+        }
+
+        u32bit minLanes[4];
+        u32bit maxLanes[4];
+        _mm_storeu_si128((__m128i *) minLanes, _mm_xor_si128(minV, bias));
+        _mm_storeu_si128((__m128i *) maxLanes, _mm_xor_si128(maxV, bias));
+
+        for (int l = 0; l < 4; l++) {
+            min = minLanes[l] < min ? minLanes[l] : min;
+            max = maxLanes[l] > max ? maxLanes[l] : max;
+        }
+    }
+#endif
+
+    for (; i < size; i++) {
         u32bit d = reorder(data[i] & dataMask, config);
         min = d < min ? d : min;
         max = d > max ? d : max;
@@ -82,6 +161,47 @@ MinMaxInfo HiloCompressorEmulator::findMinMax(
     return MinMaxInfo(min, max);
 }
 
+int HiloCompressorEmulator::findUncompressable(
+        const u32bit *data, int size, const HiloLevelConfig& config, HiloLevelRefs& refs)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    // Test four values at a time.
+    const __m128i mask = _mm_set1_epi32(dataMask);
+    const __m128i highMask = _mm_set1_epi32(config.highMask);
+    const __m128i refMin = _mm_set1_epi32(refs.min);
+    const __m128i refMax = _mm_set1_epi32(refs.max);
+    const __m128i refA = _mm_set1_epi32(refs.a);
+    const __m128i refB = _mm_set1_epi32(refs.b);
+
+    for (; (i + 4) <= size; i += 4) {
+        __m128i d = _mm_and_si128(_mm_loadu_si128((__m128i *) &data[i]), mask);
+        d = _mm_and_si128(reorderData ? reorder4(d, config) : d, highMask);
+
+        __m128i ok = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(d, refMin), _mm_cmpeq_epi32(d, refMax)),
+                                  _mm_or_si128(_mm_cmpeq_epi32(d, refA), _mm_cmpeq_epi32(d, refB)));
+        int okMask = _mm_movemask_ps(_mm_castsi128_ps(ok));
+
+        if (okMask != 0xf) {
+            while ((okMask & 1) != 0) {
+                okMask >>= 1;
+                i++;
+            }
+            return i;
+        }
+    }
+#endif
+
+    for (; i < size; i++) {
+        u32bit d = reorder(data[i] & dataMask, config);
+        if (!refs.test(d & config.highMask))
+            return i;
+    }
+
+    return size;
+}
+
 int HiloCompressorEmulator::findCompressionLevel(
         const u32bit *data, int size, MinMaxInfo& mmi, HiloLevelRefs& refs)
 {
@@ -91,20 +211,25 @@ int HiloCompressorEmulator::findCompressionLevel(
     mmi = findMinMax(data, size, *config);
     refs = HiloLevelRefs(mmi, *config);
     
-    int i = 0;
-    while (i < size && level < numLevels) {
+    int i = findUncompressable(data, size, *config, refs);
+    while (i < size) {
+        // The value that can't be encoded (bits ordered for the failing level) is
+        // tested with the next levels before searching the whole block again.
         u32bit d = reorder(data[i] & dataMask, *config);
         
-        while (level < numLevels && !refs.test(d & config->highMask)) {
+        do {
             level++;
             if (level < numLevels) {
                 config = &configs[level];
                 mmi = findMinMax(data, size, *config);
                 refs = HiloLevelRefs(mmi, *config);
-                i = -1;
             }
-        }
-        i++;
+        } while (level < numLevels && !refs.test(d & config->highMask));
+
+        if (level >= numLevels)
+            break;
+
+        i = findUncompressable(data, size, *config, refs);
     }
     
     return level;
@@ -134,8 +259,8 @@ CompressorInfo HiloCompressorEmulator::compress(
         for (int i = 0; i < size; i++) {
             u32bit d = reorder(datain[i] & dataMask, config);
             u32bit index = refs.getIndexOfRef(d & config.highMask);
-            bs.write(index, 2);
-            bs.write(d, config.lowBits);
+            // Reference index (2 bits) followed by the low bits.
+            bs.write(index | (d << 2), config.lowBits + 2);
         }
         
         //volatile int wb = (bs.getWrittenBits() + 7) / 8;
@@ -166,11 +291,38 @@ CompressorInfo HiloCompressorEmulator::uncompress(
     
     HiloLevelRefs refs(mmi, config);
     
-    for (int i = 0; i < size; i++) {
-        u32bit index = bs.read(2);
-        u32bit lowPart = bs.read(config.lowBits);
-        u32bit highPart = refs.getRefByIndex(index);
-        dataout[i] = unreorder(highPart | lowPart, config);
+    // Read the reference index (2 bits) and low bits of all the values.
+    for (int i = 0; i < size; i++)
+        dataout[i] = bs.read(config.lowBits + 2);
+
+    int i = 0;
+
+#ifdef __SSE2__
+    // Rebuild four values at a time.
+    const __m128i indexMask = _mm_set1_epi32(0x03);
+    const __m128i refMin = _mm_set1_epi32(refs.min);
+    const __m128i refMax = _mm_set1_epi32(refs.max);
+    const __m128i refA = _mm_set1_epi32(refs.a);
+    const __m128i refB = _mm_set1_epi32(refs.b);
+
+    for (; (i + 4) <= size; i += 4) {
+        __m128i code = _mm_loadu_si128((__m128i *) &dataout[i]);
+        __m128i index = _mm_and_si128(code, indexMask);
+
+        __m128i highPart = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(0)), refMin),
+                         _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(1)), refMax)),
+            _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(2)), refA),
+                         _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(3)), refB)));
+
+        __m128i d = _mm_or_si128(highPart, _mm_srli_epi32(code, 2));
+        _mm_storeu_si128((__m128i *) &dataout[i], reorderData ? unreorder4(d, config) : d);
+    }
+#endif
+
+    for (; i < size; i++) {
+        u32bit highPart = refs.getRefByIndex(dataout[i] & 0x03);
+        dataout[i] = unreorder(highPart | (dataout[i] >> 2), config);
     }
     
     return CompressorInfo(true, level, size * sizeof(u32bit));
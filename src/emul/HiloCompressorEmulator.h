@@ -176,6 +176,9 @@ private:
     
     MinMaxInfo findMinMax(const u32bit *data, int size, const HiloLevelConfig& config);
     
+    // Returns the index of the first value that can't be encoded with the references (size if none).
+    int findUncompressable(const u32bit *data, int size, const HiloLevelConfig& config, HiloLevelRefs& refs);
+    
     int findCompressionLevel(const u32bit *data, int size, MinMaxInfo& mmi, HiloLevelRefs& refs);
 
 private:
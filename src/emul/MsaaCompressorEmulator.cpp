@@ -15,6 +15,10 @@
 #include "BitStreamWriter.h"
 #include "BitStreamReader.h"
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 namespace gpu3d
 {
 
@@ -38,33 +42,60 @@ MsaaCompressorEmulator::~MsaaCompressorEmulator()
 bool MsaaCompressorEmulator::checkSubblock(
         const u32bit *data, int start, const MsaaLevelConfig* conf, MsaaRefs* refs) 
 {
-    //printf("refs = 0x%0p\n", refs);
-    
-    bool *bdiff = new bool[blockSize];
-
     int end = start + conf->samples;
     
-    for (int i = start; i < end; i++)
-        bdiff[i] = true;
-    
-    int diff = 0;
-
-    refs->ref1 = data[start];
-    refs->ref2 = refs->ref1;
-    refs->mask = 0;
-
-    for (int i = start; (i < end) && (diff <= conf->numRefs); i++) {
-        if (bdiff[i]) {
-            diff += 1;
-            refs->ref2 = (data[i] == refs->ref1) ? refs->ref2 : data[i];
-            for (int j = i + 1; j < end; j++)
-                bdiff[j] = bdiff[j] && (data[i] != data[j]);
+    // The first sample is the first reference and the first sample with a different
+    // value the second reference.  Count the distinct values (up to three).
+    u32bit ref1 = data[start];
+    u32bit ref2 = ref1;
+    u32bit mask = 0;
+    int diff = 1;
+    int i = start;
+
+#ifdef __SSE2__
+    // Compare four samples at a time.
+    const __m128i ref1V = _mm_set1_epi32(ref1);
+    __m128i ref2V = ref1V;
+
+    for (; (i + 4) <= end; i += 4) {
+        __m128i d = _mm_loadu_si128((__m128i *) &data[i]);
+        int notRef1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, ref1V))) ^ 0xf;
+
+        if ((notRef1 != 0) && (diff == 1)) {
+            // Get the second reference from the first sample that isn't the first reference.
+            int first = 0;
+            while (((notRef1 >> first) & 1) == 0)
+                first++;
+            ref2 = data[i + first];
+            ref2V = _mm_set1_epi32(ref2);
+            diff = 2;
+        }
+
+        int other = notRef1 & (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(d, ref2V))) ^ 0xf);
+        if (other != 0)
+            diff = 3;
+
+        // The mask stores the first sample in the most significant bit.
+        for (int j = 0; j < 4; j++)
+            mask = (mask << 1) | ((notRef1 >> j) & 1);
+    }
+#endif
+
+    for (; i < end; i++) {
+        if (data[i] != ref1) {
+            if (diff == 1) {
+                ref2 = data[i];
+                diff = 2;
+            }
+            else if (data[i] != ref2)
+                diff = 3;
         }
-        int index = (data[i] == refs->ref1) ? 0 : 1;
-        refs->mask = (refs->mask << 1) | index;
+        mask = (mask << 1) | ((data[i] == ref1) ? 0 : 1);
     }
     
-    delete[] bdiff;
+    refs->ref1 = ref1;
+    refs->ref2 = ref2;
+    refs->mask = mask;
     
     return diff <= conf->numRefs;
 }
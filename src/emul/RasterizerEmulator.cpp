@@ -37,9 +37,59 @@
 #include <iostream>
 #include "FixedPoint.h"
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace gpu3d;
 using namespace std;
 
+#ifdef __SSE2__
+
+//  Computes for two edge equation values if they are inside the edge equation.  Implements
+//  the same rules than INSIDE_EQUATION (see testInsideTriangle) for the two lanes, a and b
+//  are the edge equation first and second coefficients.  Returns the mask of lanes inside.
+static inline int insideEdgesSIMD(__m128d e, __m128d a, __m128d b)
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d bias = _mm_set1_pd(MIN_BIAS);
+    const __m128d negBias = _mm_set1_pd(-MIN_BIAS);
+
+    __m128d positive = _mm_cmpgt_pd(e, negBias);
+    __m128d zeroRegion = _mm_and_pd(_mm_cmplt_pd(e, bias), positive);
+    __m128d tie = _mm_or_pd(_mm_cmpgt_pd(a, zero), _mm_and_pd(_mm_cmpeq_pd(a, zero), _mm_cmpge_pd(b, zero)));
+
+    return _mm_movemask_pd(_mm_or_pd(_mm_andnot_pd(zeroRegion, positive), _mm_and_pd(zeroRegion, tie)));
+}
+
+//  Test if the sample is inside of the triangle and the clip space (near/far).  The sample
+//  is stored as the pairs (edge1, edge2) and (edge3, z), the coefficient vectors store the
+//  edge equation coefficients with the same layout.
+static inline bool insideTriangleSIMD(__m128d s01, __m128d s23, __m128d a01, __m128d b01, __m128d a23, __m128d b23,
+    bool d3d9DepthRange)
+{
+    f64bit z;
+
+    if ((insideEdgesSIMD(s01, a01, b01) != 0x03) || ((insideEdgesSIMD(s23, a23, b23) & 0x01) == 0))
+        return false;
+
+    z = _mm_cvtsd_f64(_mm_unpackhi_pd(s23, s23));
+
+    return d3d9DepthRange ? (GPU_IS_POSITIVE(z) && GPU_IS_LESS_EQUAL(z, f64bit(1))) :
+                            GPU_IS_LESS_EQUAL(GPU_ABS(z), f64bit(1));
+}
+
+//  Computes the outcode of a sample point (see GPUMath::evaluateSample).
+static inline u32bit evaluateSampleSIMD(f64bit *s)
+{
+    const __m128d zero = _mm_setzero_pd();
+
+    return u32bit(_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(s), zero))) |
+           (u32bit(_mm_movemask_pd(_mm_cmplt_pd(_mm_load_sd(&s[2]), zero)) & 0x01) << 2);
+}
+
+#endif  // __SSE2__
+
 RasterizerEmulator::MSAAOffset RasterizerEmulator::MSAAPatternTable2[4] =
 {
     {  8.0, 120.0},
@@ -97,16 +147,21 @@ RasterizerEmulator::MSAAOffset RasterizerEmulator::MSAAPatternTable8[10] =
 /*  Rasterizer Emulator constructor.  */
 RasterizerEmulator::RasterizerEmulator(u32bit numActiveTriangles,
     u32bit attrPerFragment, u32bit scanW, u32bit scanH, u32bit overW,
-    u32bit overH, u32bit genW, u32bit genH, bool useBBOpt, u32bit subPxBits) :
+    u32bit overH, u32bit genW, u32bit genH, bool useBBOpt, u32bit subPxBits, bool simdKernel) :
 
     scanTileWidth(scanW), scanTileHeight(scanH),
     scanOverTileWidth(overW), scanOverTileHeight(overH),
     genTileWidth(genW), genTileHeight(genH),
     genTileFragments(genW * genH), useBBOptimization(useBBOpt),
-    subPixelPrecision(subPxBits)
+    subPixelPrecision(subPxBits), simdStampKernel(simdKernel)
 {
     u32bit i;
 
+#ifndef __SSE2__
+    /*  The SIMD kernel requires SSE2, use the scalar path.  */
+    simdStampKernel = false;
+#endif
+
     /*  Set the maximum number of active triangles in the
         rasterizer. */
     activeTriangles = numActiveTriangles;
@@ -2815,20 +2870,9 @@ Fragment **RasterizerEmulator::nextScanlineStampTiled(u32bit triangleID)
     /*  Check if there are stamps stored.  */
     if (trStoredFragments[triangleID] > 0)
     {
-        /*  Allocate the stamp.  */
-        stamp = new Fragment*[4];
-
-        /*  Check allocation.  */
-        GPU_ASSERT(
-            if (stamp == NULL)
-                panic("RasterizerEmulator", "nextScanlineStampTiled", "Error allocating stamp.");
-        )
-
-        /*  Get next stored stamp.  */
-        stamp[0] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID]];
-        stamp[1] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 1];
-        stamp[2] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 2];
-        stamp[3] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 3];
+        /*  Get next stored stamp.  The stamp fragments are stored contiguously in the
+            generation tile fragment buffer, return the stamp in place.  */
+        stamp = &trFragments[triangleID][genTileFragments - trStoredFragments[triangleID]];
 
         /*  Update number of stored fragments.  */
         trStoredFragments[triangleID] -= 4;
@@ -3466,20 +3510,9 @@ Fragment **RasterizerEmulator::nextStampRecursiveMulti(u32bit batchID, u32bit &g
     /*  Check if there are stamps stored.  */
     if (trStoredFragments[triangleID] > 0)
     {
-        /*  Allocate the stamp.  */
-        stamp = new Fragment*[STAMP_FRAGMENTS];
-
-        /*  Check allocation.  */
-        GPU_ASSERT(
-            if (stamp == NULL)
-                panic("RasterizerEmulator", "nextScanlineStampTiled", "Error allocating stamp.");
-        )
-
-        /*  Get next stored stamp.  */
-        stamp[0] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID]];
-        stamp[1] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 1];
-        stamp[2] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 2];
-        stamp[3] = trFragments[triangleID][genTileFragments - trStoredFragments[triangleID] + 3];
+        /*  Get next stored stamp.  The stamp fragments are stored contiguously in the
+            generation tile fragment buffer, return the stamp in place.  */
+        stamp = &trFragments[triangleID][genTileFragments - trStoredFragments[triangleID]];
 
         /*  Get identifier of the triangle that generated the stamp (should be same for all the stamp).  */
         genTriangle = frTriangleID[triangleID][genTileFragments - trStoredFragments[triangleID]];
@@ -3910,6 +3943,95 @@ void RasterizerEmulator::interpolate(Fragment *fr, QuadFloat *attribute)
 }
 
 
+/*  Interpolates the attributes for all the fragments in a stamp.  */
+void RasterizerEmulator::interpolateStamp(Fragment **stamp, u32bit fragments, bool *active, bool *interpolation,
+    QuadFloat **attributes)
+{
+    SetupTriangle *triangle;
+    QuadFloat *vAttr[3];
+    f64bit r;
+    f64bit f[3];
+    f64bit *coordinates;
+    u32bit i;
+    u32bit j;
+
+    /*  Fragment attributes are interpolated as in interpolate(Fragment *, u32bit).  */
+
+    triangle = NULL;
+    vAttr[0] = vAttr[1] = vAttr[2] = NULL;
+
+    for(j = 0; j < fragments; j++)
+    {
+        /*  Skip empty fragments.  */
+        if (stamp[j] == NULL)
+            continue;
+
+        /*  Get the three vertex attributes only when the triangle changes.  */
+        if (stamp[j]->getTriangle() != triangle)
+        {
+            triangle = stamp[j]->getTriangle();
+            triangle->getVertexAttributes(vAttr[0], vAttr[1], vAttr[2]);
+        }
+
+        /*  Get the fragment edge/barycentric coordinates.  */
+        coordinates = stamp[j]->getCoordinates();
+
+        /*  Calculate reciproque of the edge/barycentric coordinates sum.  */
+        r = 1.0 / (coordinates[0] + coordinates[1] + coordinates[2]);
+
+        /*  Calculate fragment coordinate factors for interpolation.  */
+        f[0] = r * coordinates[0];
+        f[1] = r * coordinates[1];
+        f[2] = r * coordinates[2];
+
+#ifdef __SSE2__
+        __m128d f0 = _mm_set1_pd(f[0]);
+        __m128d f1 = _mm_set1_pd(f[1]);
+        __m128d f2 = _mm_set1_pd(f[2]);
+#endif
+
+        for(i = 0; i < fragmentAttributes; i++)
+        {
+            QuadFloat &attrib = attributes[j][i];
+
+            if (!active[i])
+            {
+                /*  Set default attribute value.  */
+                attrib.setComponents(0.0f, 0.0f, 0.0f, 0.0f);
+            }
+            else if (!interpolation[i])
+            {
+                /*  Copy attribute from the triangle last vertex attribute.  */
+                attrib = vAttr[2][i];
+            }
+            else
+            {
+#ifdef __SSE2__
+                /*  Interpolate the four components as two pairs using 64-bit fp.  The operations
+                    are the same than in the scalar path.  */
+                __m128 p0 = _mm_loadu_ps(&vAttr[0][i][0]);
+                __m128 p1 = _mm_loadu_ps(&vAttr[1][i][0]);
+                __m128 p2 = _mm_loadu_ps(&vAttr[2][i][0]);
+
+                __m128d xy = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(p0), f0), _mm_mul_pd(_mm_cvtps_pd(p1), f1)),
+                                        _mm_mul_pd(_mm_cvtps_pd(p2), f2));
+                __m128d zw = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(p0, p0)), f0),
+                                                   _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(p1, p1)), f1)),
+                                        _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(p2, p2)), f2));
+
+                _mm_storeu_ps(&attrib[0], _mm_movelh_ps(_mm_cvtpd_ps(xy), _mm_cvtpd_ps(zw)));
+#else
+                attrib[0] = f32bit(vAttr[0][i][0] * f[0] + vAttr[1][i][0] * f[1] + vAttr[2][i][0] * f[2]);
+                attrib[1] = f32bit(vAttr[0][i][1] * f[0] + vAttr[1][i][1] * f[1] + vAttr[2][i][1] * f[2]);
+                attrib[2] = f32bit(vAttr[0][i][2] * f[0] + vAttr[1][i][2] * f[1] + vAttr[2][i][2] * f[2]);
+                attrib[3] = f32bit(vAttr[0][i][3] * f[0] + vAttr[1][i][3] * f[1] + vAttr[2][i][3] * f[2]);
+#endif
+            }
+        }
+    }
+}
+
+
 /*  Return an aproximation of the triangle signed area.  */
 f64bit RasterizerEmulator::triangleArea(u32bit triangle)
 {
@@ -4784,17 +4906,25 @@ u32bit RasterizerEmulator::evaluateTile(Tile *tile, Tile **outputTiles)
 
              */
 
-            /*  Evaluate first subtile.  */
-            insideTile[i][0] = GPUMath::evaluateTile(s0[i], s1[i], s4[i], s3[i]);
+            if (simdStampKernel)
+            {
+                /*  Evaluate the four subtiles.  */
+                evaluateSubTilesSIMD(s0[i], s1[i], s2, s3[i], s4[i], s5, s6, s7, s8, insideTile[i]);
+            }
+            else
+            {
+                /*  Evaluate first subtile.  */
+                insideTile[i][0] = GPUMath::evaluateTile(s0[i], s1[i], s4[i], s3[i]);
 
-            /*  Evaluate second subtile.  */
-            insideTile[i][1] = GPUMath::evaluateTile(s1[i], s2, s5, s4[i]);
+                /*  Evaluate second subtile.  */
+                insideTile[i][1] = GPUMath::evaluateTile(s1[i], s2, s5, s4[i]);
 
-            /*  Evaluate third subtile.  */
-            insideTile[i][2] = GPUMath::evaluateTile(s3[i], s4[i], s7, s6);
+                /*  Evaluate third subtile.  */
+                insideTile[i][2] = GPUMath::evaluateTile(s3[i], s4[i], s7, s6);
 
-            /*  Evaluate fourth subtile.  */
-            insideTile[i][3] = GPUMath::evaluateTile(s4[i], s5, s8, s7);
+                /*  Evaluate fourth subtile.  */
+                insideTile[i][3] = GPUMath::evaluateTile(s4[i], s5, s8, s7);
+            }
 
             /*  Update global evaluation results.  */
             evTile[0] = evTile[0] || insideTile[i][0];
@@ -4907,6 +5037,34 @@ u32bit RasterizerEmulator::evaluateTile(Tile *tile, Tile **outputTiles)
     return generatedTiles;
 }
 
+/*  Evaluates the four subtiles defined by the nine subtile sample points using the SIMD kernel.  */
+void RasterizerEmulator::evaluateSubTilesSIMD(f64bit *s0, f64bit *s1, f64bit *s2, f64bit *s3, f64bit *s4,
+    f64bit *s5, f64bit *s6, f64bit *s7, f64bit *s8, bool *insideTile)
+{
+#ifdef __SSE2__
+    u32bit outcode[9];
+
+    /*  Evaluate the nine sample points once, they are shared by the subtiles.  */
+    outcode[0] = evaluateSampleSIMD(s0);
+    outcode[1] = evaluateSampleSIMD(s1);
+    outcode[2] = evaluateSampleSIMD(s2);
+    outcode[3] = evaluateSampleSIMD(s3);
+    outcode[4] = evaluateSampleSIMD(s4);
+    outcode[5] = evaluateSampleSIMD(s5);
+    outcode[6] = evaluateSampleSIMD(s6);
+    outcode[7] = evaluateSampleSIMD(s7);
+    outcode[8] = evaluateSampleSIMD(s8);
+
+    /*  Evaluate the subtiles (see GPUMath::evaluateTile).  */
+    insideTile[0] = ((outcode[0] & outcode[1] & outcode[4] & outcode[3]) == 0);
+    insideTile[1] = ((outcode[1] & outcode[2] & outcode[5] & outcode[4]) == 0);
+    insideTile[2] = ((outcode[3] & outcode[4] & outcode[7] & outcode[6]) == 0);
+    insideTile[3] = ((outcode[4] & outcode[5] & outcode[8] & outcode[7]) == 0);
+#else
+    panic("RasterizerEmulator", "evaluateSubTilesSIMD", "SIMD stamp kernel not supported.");
+#endif
+}
+
 /*  Generates four subtiles from the input tile.  */
 void RasterizerEmulator::generateTiles(Tile *tile, Tile **outputTiles)
 {
@@ -5149,41 +5307,49 @@ bool RasterizerEmulator::generateStampMulti(Tile *tile, Fragment **fragments, u3
     /*  Get tile setup triangle.  */
     triangle = tile->getTriangle(nextTriangle);
 
-    /*  Get triangle edge equations.  */
-    triangle->getEdgeEquations(e1, e2, e3);
+    if (simdStampKernel)
+    {
+        /*  Generate stamp fragments.  */
+        generateStampSIMD(triangle, x, y, s0, fragments);
+    }
+    else
+    {
+        /*  Get triangle edge equations.  */
+        triangle->getEdgeEquations(e1, e2, e3);
 
-    /*  Get triangle Z equation.  */
-    triangle->getZEquation(zeq);
+        /*  Get triangle Z equation.  */
+        triangle->getZEquation(zeq);
 
-    /*  Current implementation generates just a 2x2 fragment stamp:
+        /*  Current implementation generates just a 2x2 fragment stamp:
 
-        s3 s4
-        s0 s1
+            s3 s4
+            s0 s1
 
-     */
+         */
 
-    /*  Create horizontal coefficient vector.  */
-    a[0] = e1[0];
-    a[1] = e2[0];
-    a[2] = e3[0];
-    a[3] = zeq[0];
+        /*  Create horizontal coefficient vector.  */
+        a[0] = e1[0];
+        a[1] = e2[0];
+        a[2] = e3[0];
+        a[3] = zeq[0];
 
-    /*  Create vertical coefficient vector.  */
-    b[0] = e1[1];
-    b[1] = e2[1];
-    b[2] = e3[1];
-    b[3] = zeq[1];
+        /*  Create vertical coefficient vector.  */
+        b[0] = e1[1];
+        b[1] = e2[1];
+        b[2] = e3[1];
+        b[3] = zeq[1];
 
-    /*  Calculate stamp fragment samples.  */
-    GPUMath::ADD64(s1, s0, a);
-    GPUMath::ADD64(s2, s0, b);
-    GPUMath::ADD64(s3, s1, b);
+        /*  Calculate stamp fragment samples.  */
+        GPUMath::ADD64(s1, s0, a);
+        GPUMath::ADD64(s2, s0, b);
+        GPUMath::ADD64(s3, s1, b);
 
-    /*  Generate stamp fragments.  */
-    fragments[0] = new Fragment(triangle, x, y, convertZ(s0[3]), s0, testInsideTriangle(triangle, s0));
-    fragments[1] = new Fragment(triangle, x + 1, y, convertZ(s1[3]), s1, testInsideTriangle(triangle, s1));
-    fragments[2] = new Fragment(triangle, x, y + 1, convertZ(s2[3]), s2, testInsideTriangle(triangle, s2));
-    fragments[3] = new Fragment(triangle, x + 1, y + 1, convertZ(s3[3]), s3, testInsideTriangle(triangle, s3));
+        /*  Generate stamp fragments.  */
+        fragments[0] = new Fragment(triangle, x, y, convertZ(s0[3]), s0, testInsideTriangle(triangle, s0));
+        fragments[1] = new Fragment(triangle, x + 1, y, convertZ(s1[3]), s1, testInsideTriangle(triangle, s1));
+        fragments[2] = new Fragment(triangle, x, y + 1, convertZ(s2[3]), s2, testInsideTriangle(triangle, s2));
+        fragments[3] = new Fragment(triangle, x + 1, y + 1, convertZ(s3[3]), s3, testInsideTriangle(triangle, s3));
+    }
 
     /*  Search for the next triangle with fragments in the tile.  */
     for(i = nextTriangle + 1; (i < numTriangles) && (!inside[i]); i++);
@@ -5202,6 +5368,59 @@ bool RasterizerEmulator::generateStampMulti(Tile *tile, Fragment **fragments, u3
     return (i < numTriangles);
 }
 
+/*  Generates the fragments of a 2x2 stamp using the SIMD kernel.  */
+void RasterizerEmulator::generateStampSIMD(SetupTriangle *triangle, s32bit x, s32bit y, f64bit *s0, Fragment **fragments)
+{
+#ifdef __SSE2__
+    f64bit s1[4], s2[4], s3[4];
+    f64bit e1[3], e2[3], e3[3], zeq[3];
+
+    /*  Get triangle edge and Z equations.  */
+    triangle->getEdgeEquations(e1, e2, e3);
+    triangle->getZEquation(zeq);
+
+    /*  Create horizontal and vertical coefficient vectors as (edge1, edge2) and (edge3, z) pairs.  */
+    __m128d a01 = _mm_set_pd(e2[0], e1[0]);
+    __m128d a23 = _mm_set_pd(zeq[0], e3[0]);
+    __m128d b01 = _mm_set_pd(e2[1], e1[1]);
+    __m128d b23 = _mm_set_pd(zeq[1], e3[1]);
+
+    /*  Calculate stamp fragment samples:
+
+        s2 s3
+        s0 s1
+
+     */
+    __m128d s0_01 = _mm_loadu_pd(&s0[0]);
+    __m128d s0_23 = _mm_loadu_pd(&s0[2]);
+    __m128d s1_01 = _mm_add_pd(s0_01, a01);
+    __m128d s1_23 = _mm_add_pd(s0_23, a23);
+    __m128d s2_01 = _mm_add_pd(s0_01, b01);
+    __m128d s2_23 = _mm_add_pd(s0_23, b23);
+    __m128d s3_01 = _mm_add_pd(s1_01, b01);
+    __m128d s3_23 = _mm_add_pd(s1_23, b23);
+
+    _mm_storeu_pd(&s1[0], s1_01);
+    _mm_storeu_pd(&s1[2], s1_23);
+    _mm_storeu_pd(&s2[0], s2_01);
+    _mm_storeu_pd(&s2[2], s2_23);
+    _mm_storeu_pd(&s3[0], s3_01);
+    _mm_storeu_pd(&s3[2], s3_23);
+
+    /*  Generate stamp fragments.  */
+    fragments[0] = new Fragment(triangle, x, y, convertZ(s0[3]), s0,
+        insideTriangleSIMD(s0_01, s0_23, a01, b01, a23, b23, d3d9DepthRange));
+    fragments[1] = new Fragment(triangle, x + 1, y, convertZ(s1[3]), s1,
+        insideTriangleSIMD(s1_01, s1_23, a01, b01, a23, b23, d3d9DepthRange));
+    fragments[2] = new Fragment(triangle, x, y + 1, convertZ(s2[3]), s2,
+        insideTriangleSIMD(s2_01, s2_23, a01, b01, a23, b23, d3d9DepthRange));
+    fragments[3] = new Fragment(triangle, x + 1, y + 1, convertZ(s3[3]), s3,
+        insideTriangleSIMD(s3_01, s3_23, a01, b01, a23, b23, d3d9DepthRange));
+#else
+    panic("RasterizerEmulator", "generateStampSIMD", "SIMD stamp kernel not supported.");
+#endif
+}
+
 
 /*  Generates the fragments of a stamp level tile.  */
 Fragment **RasterizerEmulator::generateStamp(Tile *tile)
@@ -6488,6 +6707,12 @@ void RasterizerEmulator::computeMSAASamples(Fragment *fr, u32bit samples)
     bool anySampleInsideTriangle = false;
     f32bit centroidSamples;
 
+    if (simdStampKernel)
+    {
+        computeMSAASamplesSIMD(fr, samples);
+        return;
+    }
+
     //  Get the triangle associated with the fragment.
     triangle = fr->getTriangle();
 
@@ -6708,6 +6933,107 @@ printf("current = %f %f %f %f\n", fragCoord[0], fragCoord[1], fragCoord[2], zw);
     fr->setMSAASamples(samples, z, coverage, centroid, anySampleInsideTriangle);
 }
 
+//  Function that computes the fragment Z samples for MSAA using the SIMD kernel.
+void RasterizerEmulator::computeMSAASamplesSIMD(Fragment *fr, u32bit samples)
+{
+#ifdef __SSE2__
+    f64bit edge1[3];
+    f64bit edge2[3];
+    f64bit edge3[3];
+    f64bit zeq[3];
+    f64bit sample[4];
+    f64bit centroid[4];
+    f64bit *fragCoord;
+    MSAAOffset *pattern = NULL;
+    SetupTriangle *triangle;
+    bool coverage[MAX_MSAA_SAMPLES];
+    u32bit z[MAX_MSAA_SAMPLES];
+    bool anySampleInsideTriangle = false;
+    f32bit centroidSamples;
+
+    //  Select the sample pattern.
+    switch(samples)
+    {
+        case 2: pattern = MSAAPatternTable2; break;
+        case 4: pattern = MSAAPatternTable4; break;
+        case 6: pattern = MSAAPatternTable6; break;
+        case 8: pattern = MSAAPatternTable8; break;
+        default:
+            panic("RasterizerEmulator", "computeMSAASamplesSIMD", "Unsupported MSAA mode.");
+            break;
+    }
+
+    //  Get the triangle associated with the fragment.
+    triangle = fr->getTriangle();
+
+    //  Get triangle current edge equations and z interpolation equation.
+    triangle->getEdgeEquations(edge1, edge2, edge3);
+    triangle->getZEquation(zeq);
+
+    //  Get fragment values for the edge equations and the z/w interpolation equation.
+    fragCoord = fr->getCoordinates();
+
+    //  Create the fragment values and coefficient vectors as (edge1, edge2) and (edge3, z) pairs.
+    __m128d base01 = _mm_set_pd(fragCoord[1], fragCoord[0]);
+    __m128d base23 = _mm_set_pd(fr->getZW(), fragCoord[2]);
+    __m128d a01 = _mm_set_pd(edge2[0], edge1[0]);
+    __m128d a23 = _mm_set_pd(zeq[0], edge3[0]);
+    __m128d b01 = _mm_set_pd(edge2[1], edge1[1]);
+    __m128d b23 = _mm_set_pd(zeq[1], edge3[1]);
+
+    //  Initilize centroid sampling computation.
+    __m128d centroid01 = _mm_setzero_pd();
+    __m128d centroid23 = _mm_setzero_pd();
+    centroidSamples = 0.0f;
+
+    for(u32bit i = 0; i < samples; i++)
+    {
+        __m128d xOff = _mm_set1_pd(pattern[i].xOff / MSAA_SUBPIXEL_PRECISSION);
+        __m128d yOff = _mm_set1_pd(pattern[i].yOff / MSAA_SUBPIXEL_PRECISSION);
+
+        //  Compute the edge and z equations for the current fragment sample.
+        __m128d sample01 = _mm_add_pd(_mm_add_pd(base01, _mm_mul_pd(a01, xOff)), _mm_mul_pd(b01, yOff));
+        __m128d sample23 = _mm_add_pd(_mm_add_pd(base23, _mm_mul_pd(a23, xOff)), _mm_mul_pd(b23, yOff));
+
+        _mm_storeu_pd(&sample[0], sample01);
+        _mm_storeu_pd(&sample[2], sample23);
+
+        //  Convert the computed z for the sample from 64-bit fp to 24 bit integer.
+        z[i] = convertZ(sample[3]);
+
+        //  Determine if the sample is inside the triangle.
+        coverage[i] = insideTriangleSIMD(sample01, sample23, a01, b01, a23, b23, d3d9DepthRange);
+
+        //  Update centroid sample computation.
+        if (coverage[i])
+        {
+            centroid01 = _mm_add_pd(centroid01, sample01);
+            centroid23 = _mm_add_pd(centroid23, sample23);
+            centroidSamples++;
+        }
+
+        //  Compute if any of the fragment samples is inside the triangle.
+        anySampleInsideTriangle = anySampleInsideTriangle || coverage[i];
+    }
+
+    //  Finish centroid sampling computation.
+    if (anySampleInsideTriangle)
+    {
+        __m128d divisor = _mm_set1_pd(centroidSamples);
+        centroid01 = _mm_div_pd(centroid01, divisor);
+        centroid23 = _mm_div_pd(centroid23, divisor);
+    }
+
+    _mm_storeu_pd(&centroid[0], centroid01);
+    _mm_storeu_pd(&centroid[2], centroid23);
+
+    //  Set fragment MSAA data.
+    fr->setMSAASamples(samples, z, coverage, centroid, anySampleInsideTriangle);
+#else
+    panic("RasterizerEmulator", "computeMSAASamplesSIMD", "SIMD stamp kernel not supported.");
+#endif
+}
+
 
 /*************************************************************************
  *
@@ -99,6 +99,7 @@ private:
     u32bit genTileHeight;           /**<  Generation tile height.  */
     bool   useBBOptimization;       /**<  Use the Bounding Box optimization pass.  */
     u32bit subPixelPrecision;       /**<  Number of bits for the subpixel decimal representation in fixed-point.  */ 
+    bool   simdStampKernel;         /**<  Use the SIMD kernel to evaluate subtiles, stamps and MSAA samples.  */
 
     /*  Triangle Storage.  */
     SetupTriangle **setupTriangles; /**<  Stores the triangles in setup process or already stored.  */
@@ -769,6 +770,57 @@ private:
 
     void generateSubTileSamples(Tile *tile, u32bit triId, f64bit *s0, f64bit *s1, f64bit *s2, f64bit *s3);
 
+    /**
+     *
+     *  Evaluates the four subtiles defined by the nine subtile sample points (see
+     *  generateSubTileSamples) using the SIMD kernel.  Each sample point is evaluated
+     *  only once.
+     *
+     *  @param s0 Pointer to the first sample point.
+     *  @param s1 Pointer to the second sample point.
+     *  @param s2 Pointer to the third sample point.
+     *  @param s3 Pointer to the fourth sample point.
+     *  @param s4 Pointer to the fifth sample point.
+     *  @param s5 Pointer to the sixth sample point.
+     *  @param s6 Pointer to the seventh sample point.
+     *  @param s7 Pointer to the eight sample point.
+     *  @param s8 Pointer to the nineth samplepoint.
+     *  @param insideTile Pointer to an array where to store if there may be triangle fragments inside
+     *  each of the four subtiles.
+     *
+     */
+
+    void evaluateSubTilesSIMD(f64bit *s0, f64bit *s1, f64bit *s2, f64bit *s3, f64bit *s4, f64bit *s5,
+        f64bit *s6, f64bit *s7, f64bit *s8, bool *insideTile);
+
+    /**
+     *
+     *  Generates the fragments of a 2x2 stamp using the SIMD kernel.  The edge and z equations
+     *  are evaluated and tested for the four fragments using the same operations than the
+     *  scalar path so the coverage is the same.
+     *
+     *  @param triangle Setup triangle that generates the stamp.
+     *  @param x Horizontal position of the stamp.
+     *  @param y Vertical position of the stamp.
+     *  @param s0 Pointer to the edge and z equation values at the stamp start point.
+     *  @param fragments Pointer to an array where to store the four generated fragments.
+     *
+     */
+
+    void generateStampSIMD(SetupTriangle *triangle, s32bit x, s32bit y, f64bit *s0, Fragment **fragments);
+
+    /**
+     *
+     *  Computes the Z samples and coverage for MultiSampling AntiAliasing for the input
+     *  fragment using the SIMD kernel.
+     *
+     *  @param fr Pointer to the fragment for which to compute the MSAA Z samples.
+     *  @param samples Number of Z samples to compute.
+     *
+     */
+
+    void computeMSAASamplesSIMD(Fragment *fr, u32bit samples);
+
     /**
      *
      *  Generates four subtiles from the input tile.
@@ -955,6 +1007,7 @@ public:
      *  @param genTileH Generation tile height (fragments).
      *  @param useBBOpt Use the Bounding Box optimization pass.
      *  @param subPxBBbit Number of precision bits for the subpixel operations.
+     *  @param simdKernel Use the SIMD kernel to evaluate subtiles, stamps and MSAA samples.
      *
      *  @return A new initialized Rasterizer Emulator.
      *
@@ -962,7 +1015,7 @@ public:
 
     RasterizerEmulator(u32bit activeTriangles, u32bit fragmentAttributes,
         u32bit scanTileW, u32bit scanTileH, u32bit overTileW, u32bit overTileH, u32bit genTileW, u32bit genTileH,
-        bool useBBOpt, u32bit subPxBBbit);
+        bool useBBOpt, u32bit subPxBBbit, bool simdKernel);
 
     /**
      *
@@ -1344,7 +1397,9 @@ public:
      *  @param triangle The triangle identifier for the triangle
      *  from which to generate the next fragment.
      *
-     *  @return A pointer to an array of fragments (stamp).
+     *  @return A pointer to an array of fragments (stamp).  The array is owned by the
+     *  rasterizer emulator and is only valid until the next stamp is requested for the
+     *  triangle, the fragments are owned by the caller.
      *
      */
 
@@ -1374,6 +1429,8 @@ public:
      *
      *  @return A stamp of fragments generated by the recursive rasterization of the
      *  batch of triangles.  It returns NULL if no stamp/fragments could be generated.
+     *  The array is owned by the rasterizer emulator and is only valid until the next
+     *  stamp is requested for the batch, the fragments are owned by the caller.
      *
      */
 
@@ -1421,6 +1478,26 @@ public:
 
     void interpolate(Fragment *f, QuadFloat *attribute);
 
+    /**
+     *
+     *  Interpolates the attributes for all the fragments in a stamp.  The barycentric
+     *  coordinates are computed once per fragment and the vertex attributes are obtained
+     *  once per triangle.  Active attributes are interpolated (or copied from the triangle
+     *  third vertex if interpolation is disabled), inactive attributes are set to zero.
+     *  The results are the same than the ones computed by interpolate and copy.
+     *
+     *  @param stamp Pointer to the array of fragments in the stamp.  NULL fragments are ignored.
+     *  @param fragments Number of fragments in the stamp.
+     *  @param active Pointer to an array of flags storing if a fragment attribute is active.
+     *  @param interpolation Pointer to an array of flags storing if a fragment attribute is
+     *  interpolated or copied from the triangle third vertex.
+     *  @param attributes Pointer to an array of pointers to the QuadFloat arrays where to
+     *  store the attributes of each fragment.
+     *
+     */
+
+    void interpolateStamp(Fragment **stamp, u32bit fragments, bool *active, bool *interpolation, QuadFloat **attributes);
+
     /**
      *
      *  Copies the fragment attribute from one of the setup
@@ -33,6 +33,11 @@
 #include "TextureEmulator.h"
 #include "GPUMath.h"
 #include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
 #
 using namespace gpu3d;
 
@@ -41,7 +46,7 @@ TextureEmulator::TextureEmulator(u32bit stampFrags, u32bit blockDim, u32bit supe
                     bool forceAniso, u32bit maxAniso, u32bit triPrecision, u32bit briThreshold,
                     u32bit anisoRoundPrec, u32bit _anisoRoundThreshold, bool _anisoRatioMultOfTwo,
                     u32bit overScanWidth, u32bit overScanHeight, u32bit scanWidth, u32bit scanHeight,
-                    u32bit genWidth, u32bit genHeight)
+                    u32bit genWidth, u32bit genHeight, bool samplerKernels)
 {
     //  Set number of fragments per stamp.
     stampFragments = stampFrags;
@@ -84,6 +89,9 @@ TextureEmulator::TextureEmulator(u32bit stampFrags, u32bit blockDim, u32bit supe
     anisoRoundThreshold = _anisoRoundThreshold;
     anisoRatioMultOfTwo = _anisoRatioMultOfTwo;    
 
+    //  Set the sampler kernels.
+    specializedKernels = samplerKernels;
+
     GPU_ASSERT(
         if ((anisoRoundPrecision == 0) || (anisoRoundPrecision > 32))
             panic("TextureEmulator", "TextureEmulator", "Aniso round precision valid range is [1, 32]");
@@ -450,6 +458,8 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
     u32bit anisoSamples;
     f32bit dsOffset;
     f32bit dtOffset;
+    f32bit sOffset;
+    f32bit tOffset;
     f32bit fractionalLOD;
     bool twoMipsSampled;
     bool sampleFirstMip;
@@ -476,6 +486,11 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
     //  Allocate the trilinear object the first time it will be used
     textAccess->trilinear[trilinearAccess] = new TextureAccess::Trilinear;
 
+    //  Calculate the texture coordinate offsets of the current anisotropic sample.  They are
+    //  the same for all the fragments in the quad.
+    sOffset = dsOffset * (currentAnisoSample - 0.5f * f32bit(anisoSamples + 1));
+    tOffset = dtOffset * (currentAnisoSample - 0.5f * f32bit(anisoSamples + 1));
+
     /*  Calculate the texel coordinates and addresses for all whole texture access.  */
     for(frag = 0; frag < STAMP_FRAGMENTS; frag++)
     {
@@ -516,7 +531,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
 
 
                         /*  Get sample texel coordinate.  */
-                        texelCoord(textUnit, d1, GPU_NEAREST, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                        texelCoord(textUnit, d1, GPU_NEAREST, sOffset, tOffset,
                                    stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > N/N_M_N > d1 %d i %d j %d k %d\n", d1, i, j, k);
@@ -551,7 +566,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
 
 
                         /*  Get coordinates of first sample texel.  */
-                        texelCoord(textUnit, d1, GPU_LINEAR, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                        texelCoord(textUnit, d1, GPU_LINEAR, sOffset, tOffset,
                                    stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > L/L_M_N > d1 %d i %d j %d k %d\n", d1, i, j, k);
@@ -586,7 +601,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
                         if (sampleFirstMip)
                         {
                             /*  Get sample texel coordinate at first mipmap.  */
-                            texelCoord(textUnit, d1, GPU_NEAREST, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                            texelCoord(textUnit, d1, GPU_NEAREST, sOffset, tOffset,
                                        stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > N_M_L > d1 %d i %d j %d k %d\n", d1, i, j, k);
@@ -618,7 +633,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
                         if (sampleSecondMip)
                         {
                             /*  Get sample texel coordinate at first mipmap.  */
-                            texelCoord(textUnit, d2, GPU_NEAREST, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                            texelCoord(textUnit, d2, GPU_NEAREST, sOffset, tOffset,
                                        stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > N_M_L > d2 %d i %d j %d k %d\n", d2, i, j, k);
@@ -683,7 +698,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
                         if (sampleFirstMip)
                         {
                             /*  Get coordinates of first sample texel at first mipmap level.  */
-                            texelCoord(textUnit, d1, GPU_LINEAR, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                            texelCoord(textUnit, d1, GPU_LINEAR, sOffset, tOffset,
                                 stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > L_M_L > d1 %d i %d j %d k %d\n", d1, i, j, k);
@@ -703,7 +718,7 @@ void TextureEmulator::calculateAddress(TextureAccess *textAccess)
                         if (sampleSecondMip)
                         {
                             /*  Get coordinates of first sample texel at second mipmap level.  */
-                            texelCoord(textUnit, d2, GPU_LINEAR, currentAnisoSample, anisoSamples, dsOffset, dtOffset,
+                            texelCoord(textUnit, d2, GPU_LINEAR, sOffset, tOffset,
                                 stampCoord[frag][0], stampCoord[frag][1], stampCoord[frag][2], i, j, k, a, b, c);
 
 //printf("TU > L_M_L > d2 %d i %d j %d k %d\n", d2, i, j, k);
@@ -1171,6 +1186,31 @@ f32bit TextureEmulator::calculateScale1D(f32bit dudx, f32bit dudy)
     return scale;
 }
 
+/*
+ *  Computes the square root of four values.  The result is the same than converting
+ *  the result of GPU_SQRT to single precision.
+ */
+static void sqrtSIMD(f32bit *v)
+{
+#ifdef __SSE2__
+    _mm_storeu_ps(v, _mm_sqrt_ps(_mm_loadu_ps(v)));
+#else
+    for(u32bit i = 0; i < 4; i++)
+        v[i] = (f32bit) GPU_SQRT(v[i]);
+#endif
+}
+
+/*  Divides four values by four divisors.  */
+static void divideSIMD(f32bit *v, const f32bit *d)
+{
+#ifdef __SSE2__
+    _mm_storeu_ps(v, _mm_div_ps(_mm_loadu_ps(v), _mm_loadu_ps(d)));
+#else
+    for(u32bit i = 0; i < 4; i++)
+        v[i] = v[i] / d[i];
+#endif
+}
+
 /*  Calculates level of detail for GPU_TEXTURE2D textures.  */
 f32bit TextureEmulator::calculateScale2D(u32bit textUnit, f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy, u32bit maxAniso,
     u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
@@ -1193,6 +1233,23 @@ f32bit TextureEmulator::calculateScale2D(u32bit textUnit, f32bit dudx, f32bit du
     }
     else if (maxAniso > 1)
     {
+        AnisoFootprint &footprint = anisoFootprint[textUnit];
+        f32bit derivatives[4] = {dudx, dudy, dvdx, dvdy};
+
+        //  Reuse the footprint of the previous quad if the derivatives and the texture parameters
+        //  used to compute it are the same (for example quads from a primitive with an affine
+        //  texture mapping).
+        if (footprint.valid && (memcmp(footprint.derivatives, derivatives, sizeof(derivatives)) == 0) &&
+            (footprint.maxAniso == maxAniso) && (footprint.width == textureWidth[textUnit]) &&
+            (footprint.height == textureHeight[textUnit]))
+        {
+            samples = footprint.samples;
+            dsOffset = footprint.dsOffset;
+            dtOffset = footprint.dtOffset;
+
+            return footprint.scale;
+        }
+
         //  Call the selected anisotropy algorithm
         switch(anisoAlgorithm)
         {
@@ -1228,6 +1285,17 @@ f32bit TextureEmulator::calculateScale2D(u32bit textUnit, f32bit dudx, f32bit du
         dtOffset = dtOffset / f32bit(textureHeight[textUnit]);
 
 //printf("Scale2D >> scale %f samples %d dsOffset %f dtOffset %f\n", scale, samples, dsOffset, dtOffset);
+
+        //  Store the footprint for the next quad.
+        memcpy(footprint.derivatives, derivatives, sizeof(derivatives));
+        footprint.maxAniso = maxAniso;
+        footprint.width = textureWidth[textUnit];
+        footprint.height = textureHeight[textUnit];
+        footprint.scale = scale;
+        footprint.samples = samples;
+        footprint.dsOffset = dsOffset;
+        footprint.dtOffset = dtOffset;
+        footprint.valid = true;
     }
     else
     {
@@ -1287,8 +1355,10 @@ f32bit TextureEmulator::anisoTwoAxis(f32bit dudx, f32bit dudy, f32bit dvdx, f32b
         and offsets.  */
 
     /*  Calculate texture scale in the horizontal and vertical screen axis.  */
-    px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
-    py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+    f32bit lengths[4] = {dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy, 0.0f, 0.0f};
+    sqrtSIMD(lengths);
+    px = lengths[0];
+    py = lengths[1];
 
     /*  Calculate the minimum and maximum for both axis.  */
     pMin = GPU_MIN(px, py);
@@ -1348,8 +1418,10 @@ f32bit TextureEmulator::anisoFourAxis(f32bit dudx, f32bit dudy, f32bit dvdx, f32
         and offsets.  */
 
     /*  Calculate texture scale in the horizontal and vertical screen axis.  */
-    px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
-    py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+    f32bit lengths[4] = {dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy, 0.0f, 0.0f};
+    sqrtSIMD(lengths);
+    px = lengths[0];
+    py = lengths[1];
 
     /*  Calculate texture scale on the XY/YX axis (axis rotated 45 degrees).  */
     pxy = (f32bit) GPU_SQRT((dudx + dudy) * (dudx + dudy) * 0.5 + (dvdx + dvdy) * (dvdx + dvdy) * 0.5);
@@ -1468,19 +1540,25 @@ f32bit TextureEmulator::anisoRectangle(f32bit dudx, f32bit dudy, f32bit dvdx, f3
     f32bit lB;
     f32bit N;
 
-    //  Calculate lenghts of the x and y vectors in texture space
-    l1A = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
-    l2A = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
-
     //  Calculate diagonals of the x and y vectors in texture space (45 degree rotation)
-    diag1[0] = (dudx + dudy) / (f32bit) GPU_SQRT(2);
-    diag1[1] = (dvdx + dvdy) / (f32bit) GPU_SQRT(2);
-    diag2[0] = (dudx - dudy) / (f32bit) GPU_SQRT(2);
-    diag2[1] = (dvdx - dvdy) / (f32bit) GPU_SQRT(2);
-
-    //  Calculate lengths of the 45 degree rotated x and y vectors in texture space (diagonals)
-    l1B = (f32bit) GPU_SQRT(diag1[0] * diag1[0] + diag1[1] * diag1[1]);
-    l2B = (f32bit) GPU_SQRT(diag2[0] * diag2[0] + diag2[1] * diag2[1]);
+    f32bit sqrt2 = (f32bit) GPU_SQRT(2);
+    f32bit diagonals[4] = {dudx + dudy, dvdx + dvdy, dudx - dudy, dvdx - dvdy};
+    f32bit divisors[4] = {sqrt2, sqrt2, sqrt2, sqrt2};
+    divideSIMD(diagonals, divisors);
+    diag1[0] = diagonals[0];
+    diag1[1] = diagonals[1];
+    diag2[0] = diagonals[2];
+    diag2[1] = diagonals[3];
+
+    //  Calculate lenghts of the x and y vectors and of the 45 degree rotated x and y vectors
+    //  (diagonals) in texture space.
+    f32bit lengths[4] = {dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy,
+                         diag1[0] * diag1[0] + diag1[1] * diag1[1], diag2[0] * diag2[0] + diag2[1] * diag2[1]};
+    sqrtSIMD(lengths);
+    l1A = lengths[0];
+    l2A = lengths[1];
+    l1B = lengths[2];
+    l2B = lengths[3];
 
     /*  Select largest vector as major anisotropy axis.  */
     if (l1A >= l2A)
@@ -1658,9 +1736,12 @@ f32bit TextureEmulator::anisoEWA(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit d
     F = (dudx * dvdy - dudy * dvdx) * (dudx * dvdy - dudy * dvdx);
 
     //  What is the purpose of this?
-    A = A/F;
-    B = B/F;
-    C = C/F;
+    f32bit coefficients[4] = {A, B, C, 0.0f};
+    f32bit divisors[4] = {F, F, F, F};
+    divideSIMD(coefficients, divisors);
+    A = coefficients[0];
+    B = coefficients[1];
+    C = coefficients[2];
 //printf("EWA>> A %f B %f C %f F %f\n", A, B, C, F);
 /*
     f32bit cA;
@@ -1708,11 +1789,16 @@ printf("EWA >> major %f minor %f\n", major, minor);
     else
     {
         //  Calculate the major and minor axis of the ellipse
-        axis1[0] = (f32bit) GPU_SQRT((t + p) / (t * (q + t)));
-        axis1[1] = GPU_SIGN(B * p) * (f32bit) GPU_SQRT((t - p) / (t * (q + t)));
+        f32bit axes[4] = {t + p, t - p, t - p, t + p};
+        f32bit denominators[4] = {t * (q + t), t * (q + t), t * (q - t), t * (q - t)};
+        divideSIMD(axes, denominators);
+        sqrtSIMD(axes);
+
+        axis1[0] = axes[0];
+        axis1[1] = GPU_SIGN(B * p) * axes[1];
 
-        axis2[0] = -1.0f * GPU_SIGN(B * p) * (f32bit) GPU_SQRT((t - p) / (t * (q - t)));
-        axis2[1] = (f32bit) GPU_SQRT((t + p) / (t * (q - t)));
+        axis2[0] = -1.0f * GPU_SIGN(B * p) * axes[2];
+        axis2[1] = axes[3];
     }
 
     /*GPU_ASSERT(
@@ -1751,8 +1837,10 @@ printf("EWA >> major %f minor %f\n", major, minor);
     )*/
 
     //  Compute the lenght of both vectors
-    l1 = (f32bit) GPU_SQRT(axis1[0] * axis1[0] + axis1[1] * axis1[1]);
-    l2 = (f32bit) GPU_SQRT(axis2[0] * axis2[0] + axis2[1] * axis2[1]);
+    f32bit lengths[4] = {axis1[0] * axis1[0] + axis1[1] * axis1[1], axis2[0] * axis2[0] + axis2[1] * axis2[1], 0.0f, 0.0f};
+    sqrtSIMD(lengths);
+    l1 = lengths[0];
+    l2 = lengths[1];
 
 //printf("EWA => l1 %f l2 %f\n", l1, l2);
 
@@ -1850,8 +1938,10 @@ f32bit TextureEmulator::anisoExperimentalAngle(f32bit dudx, f32bit dudy, f32bit
     //  and offsets.
 
     //  Calculate texture scale in the horizontal and vertical screen axis.
-    px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
-    py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+    f32bit lengths[4] = {dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy, 0.0f, 0.0f};
+    sqrtSIMD(lengths);
+    px = lengths[0];
+    py = lengths[1];
 
     //  Calculate texture scale on the XY/YX axis (axis rotated 45 degrees).
     pxy = (f32bit) GPU_SQRT((dudx + dudy) * (dudx + dudy) * 0.5 + (dvdx + dvdy) * (dvdx + dvdy) * 0.5);
@@ -2030,8 +2120,8 @@ f32bit TextureEmulator::calculateLOD(u32bit textUnit, f32bit fragmentBias, f32bi
 }
 
 /*  Calculates texel coordinates and weight factors.  */
-void TextureEmulator::texelCoord(u32bit textUnit, u32bit l, FilterMode filter, u32bit currentSample,
-    u32bit numSamples, f32bit dsOffset, f32bit dtOffset, f32bit s, f32bit t, f32bit r,
+void TextureEmulator::texelCoord(u32bit textUnit, u32bit l, FilterMode filter, f32bit sOffset,
+    f32bit tOffset, f32bit s, f32bit t, f32bit r,
     u32bit &i, u32bit &j, u32bit &k, f32bit &a, f32bit &b, f32bit &c)
 {
     switch(textureMode[textUnit])
@@ -2042,7 +2132,7 @@ void TextureEmulator::texelCoord(u32bit textUnit, u32bit l, FilterMode filter, u
 
         case GPU_TEXTURE2D:
         case GPU_TEXTURECUBEMAP:
-            texelCoord2D(textUnit, l, filter, currentSample, numSamples, dsOffset, dtOffset, s, t, i, j, a, b);
+            texelCoord2D(textUnit, l, filter, sOffset, tOffset, s, t, i, j, a, b);
             break;
 
         case GPU_TEXTURE3D:
@@ -2105,7 +2195,7 @@ void TextureEmulator::texelCoord1D(u32bit textUnit, u32bit level, FilterMode fil
 
 //  Calculates texel cooordinates for a mipmap level of a GPU_TEXTURE2D texture.
 void TextureEmulator::texelCoord2D(u32bit textUnit, u32bit level, FilterMode filter,
-    u32bit currentSample, u32bit numSamples, f32bit dsOffset, f32bit dtOffset, f32bit s, f32bit t,
+    f32bit sOffset, f32bit tOffset, f32bit s, f32bit t,
     u32bit &i, u32bit &j, f32bit &a, f32bit &b)
 {
     f32bit u;
@@ -2128,8 +2218,8 @@ void TextureEmulator::texelCoord2D(u32bit textUnit, u32bit level, FilterMode fil
         )
         
         //  Apply anisotropic sample offset.
-        s = s + dsOffset * (currentSample - 0.5f * f32bit(numSamples + 1));
-        t = t + dtOffset * (currentSample - 0.5f * f32bit(numSamples + 1));
+        s = s + sOffset;
+        t = t + tOffset;
     }
 
     //  Check if the texture coordinates are normalized.
@@ -2365,6 +2455,260 @@ u32bit TextureEmulator::applyWrap(ClampMode wrapMode, u32bit i, u32bit size)
     return w;
 }
 
+/*  Decodes the components of a texel in a texture format.  */
+template<TextureFormat format>
+static void decodeTexel(const u8bit *data, u64bit address, f32bit *texel)
+{
+    switch(format)
+    {
+        case GPU_ALPHA8:
+            texel[0] = 0.0f;
+            texel[1] = 0.0f;
+            texel[2] = 0.0f;
+            texel[3] = f32bit(data[address & 0x03]) / 255.0f;
+            break;
+
+        case GPU_LUMINANCE8:
+            texel[0] = texel[1] = texel[2] = f32bit(data[address & 0x03]) / 255.0f;
+            texel[3] = 1.0f;
+            break;
+
+        case GPU_INTENSITY8:
+            texel[0] = texel[1] = texel[2] = texel[3] = f32bit(data[address & 0x03]) / 255.0f;
+            break;
+
+        case GPU_LUMINANCE8_ALPHA8:
+            texel[0] = texel[1] = texel[2] = f32bit(data[address & 0x02]) / 255.0f;
+            texel[3] = f32bit(data[(address & 0x02) + 1]) / 255.0f;
+            break;
+
+        case GPU_RGB565:
+            {
+                u16bit rgb = *((u16bit *) &data[address & 0x02]);
+                texel[0] = f32bit(rgb >> 11) / 31.0f;
+                texel[1] = f32bit((rgb >> 5) & 0x3f) / 31.0f;
+                texel[2] = f32bit(rgb & 0x1f) / 31.0f;
+                texel[3] = 1.0f;
+            }
+            break;
+
+        case GPU_RGB888:
+            texel[0] = f32bit(data[0]) / 255.0f;
+            texel[1] = f32bit(data[1]) / 255.0f;
+            texel[2] = f32bit(data[2]) / 255.0f;
+            texel[3] = 1.0f;
+            break;
+
+        case GPU_RGBA8888:
+#ifdef __SSE2__
+            {
+                //  Convert the four components at once.
+                __m128i rgba = _mm_cvtsi32_si128(*((s32bit *) data));
+                rgba = _mm_unpacklo_epi16(_mm_unpacklo_epi8(rgba, _mm_setzero_si128()), _mm_setzero_si128());
+                _mm_storeu_ps(texel, _mm_div_ps(_mm_cvtepi32_ps(rgba), _mm_set1_ps(255.0f)));
+            }
+#else
+            texel[0] = f32bit(data[0]) / 255.0f;
+            texel[1] = f32bit(data[1]) / 255.0f;
+            texel[2] = f32bit(data[2]) / 255.0f;
+            texel[3] = f32bit(data[3]) / 255.0f;
+#endif
+            break;
+
+        case GPU_R32F:
+            texel[0] = *((f32bit *) data);
+            texel[1] = 0.0f;
+            texel[2] = 0.0f;
+            texel[3] = 1.0f;
+            break;
+
+        case GPU_RG32F:
+            texel[0] = ((f32bit *) data)[0];
+            texel[1] = ((f32bit *) data)[1];
+            texel[2] = 0.0f;
+            texel[3] = 1.0f;
+            break;
+
+        case GPU_RGBA32F:
+            texel[0] = ((f32bit *) data)[0];
+            texel[1] = ((f32bit *) data)[1];
+            texel[2] = ((f32bit *) data)[2];
+            texel[3] = ((f32bit *) data)[3];
+            break;
+
+        case GPU_DEPTH_COMPONENT24:
+            texel[0] = texel[1] = texel[2] = f32bit(*((u32bit *) data) & 0x00FFFFFF) / 16777215.0f;
+            texel[3] = 1.0f;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*  Texel component orders applied after decoding the texel (see convertFormat).  */
+static const u32bit TEXEL_ORDER_D3D9 = 0x01;        /**<  D3D9 color component order (red and blue swapped).  */
+static const u32bit TEXEL_ORDER_REVERSE = 0x02;     /**<  Reversed component order.  */
+
+/*  Converts a texel in a texture format and component order to four float point components.  */
+template<TextureFormat format, u32bit order>
+static void convertTexel(const u8bit *data, u64bit address, f32bit *texel)
+{
+    f32bit aux;
+
+    decodeTexel<format>(data, address, texel);
+
+    if ((order & TEXEL_ORDER_D3D9) != 0)
+    {
+        aux = texel[0];
+        texel[0] = texel[2];
+        texel[2] = aux;
+    }
+
+    if ((order & TEXEL_ORDER_REVERSE) != 0)
+    {
+        aux = texel[0];
+        texel[0] = texel[3];
+        texel[3] = aux;
+        aux = texel[1];
+        texel[1] = texel[2];
+        texel[2] = aux;
+    }
+}
+
+/*  Selects the texel conversion function for a texture format and component order.  */
+template<u32bit order>
+static TextureEmulator::TexelConversionFunction selectTexelConversion(TextureFormat format)
+{
+    switch(format)
+    {
+        case GPU_ALPHA8:            return &convertTexel<GPU_ALPHA8, order>;
+        case GPU_LUMINANCE8:        return &convertTexel<GPU_LUMINANCE8, order>;
+        case GPU_INTENSITY8:        return &convertTexel<GPU_INTENSITY8, order>;
+        case GPU_LUMINANCE8_ALPHA8: return &convertTexel<GPU_LUMINANCE8_ALPHA8, order>;
+        case GPU_RGB565:            return &convertTexel<GPU_RGB565, order>;
+        case GPU_RGB888:            return &convertTexel<GPU_RGB888, order>;
+        case GPU_RGBA8888:          return &convertTexel<GPU_RGBA8888, order>;
+        case GPU_R32F:              return &convertTexel<GPU_R32F, order>;
+        case GPU_RG32F:             return &convertTexel<GPU_RG32F, order>;
+        case GPU_RGBA32F:           return &convertTexel<GPU_RGBA32F, order>;
+        case GPU_DEPTH_COMPONENT24: return &convertTexel<GPU_DEPTH_COMPONENT24, order>;
+
+        //  The other formats use the generic conversion.
+        default:                    return NULL;
+    }
+}
+
+/*
+ *  Filters the 2, 4 or 8 texels read from a mipmap level for a 1D, 2D or 3D texture.
+ *  The weight of each texel is the product of the weights for each dimension.  The
+ *  weighted texels are added in the same order than in the scalar filter expressions
+ *  (texel order for 2D and 3D, second texel first for 1D).
+ */
+template<u32bit dimensions>
+static void bilinearKernel(const f32bit *texels, u32bit level, f32bit a, f32bit b, f32bit c, f32bit *sample)
+{
+    const u32bit numTexels = 1 << dimensions;
+    const f32bit *texel = &texels[level * numTexels * 4];
+    f32bit wa[2] = {1.0f - a, a};
+    f32bit wb[2] = {1.0f - b, b};
+    f32bit wc[2] = {1.0f - c, c};
+
+#ifdef __SSE2__
+    __m128 result = _mm_setzero_ps();
+
+    for(u32bit n = 0; n < numTexels; n++)
+    {
+        u32bit t = (dimensions == 1) ? (numTexels - 1 - n) : n;
+
+        //  Weight the four components of the texel at once.
+        __m128 w = _mm_mul_ps(_mm_loadu_ps(&texel[t * 4]), _mm_set1_ps(wa[t & 0x01]));
+        if (dimensions > 1)
+            w = _mm_mul_ps(w, _mm_set1_ps(wb[(t >> 1) & 0x01]));
+        if (dimensions > 2)
+            w = _mm_mul_ps(w, _mm_set1_ps(wc[(t >> 2) & 0x01]));
+
+        result = (n == 0) ? w : _mm_add_ps(result, w);
+    }
+
+    _mm_storeu_ps(sample, result);
+#else
+    for(u32bit i = 0; i < 4; i++)
+    {
+        f32bit result = 0.0f;
+
+        for(u32bit n = 0; n < numTexels; n++)
+        {
+            u32bit t = (dimensions == 1) ? (numTexels - 1 - n) : n;
+            f32bit w = texel[t * 4 + i] * wa[t & 0x01];
+            if (dimensions > 1)
+                w = w * wb[(t >> 1) & 0x01];
+            if (dimensions > 2)
+                w = w * wc[(t >> 2) & 0x01];
+
+            result = (n == 0) ? w : (result + w);
+        }
+
+        sample[i] = result;
+    }
+#endif
+}
+
+/*  Interpolates between the samples from two mipmaps.  */
+static void interpolateMipmaps(f32bit *t1, f32bit *t2, f32bit w, f32bit *sample)
+{
+#ifdef __SSE2__
+    _mm_storeu_ps(sample, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(t1), _mm_set1_ps(1.0f - w)),
+                                     _mm_mul_ps(_mm_loadu_ps(t2), _mm_set1_ps(w))));
+#else
+    for(u32bit i = 0; i < 4; i++)
+        sample[i] = t1[i] * (1.0f - w) + t2[i] * w;
+#endif
+}
+
+//  Selects the sampler kernels for the current state of a texture unit.
+void TextureEmulator::selectSamplerKernels(u32bit textUnit)
+{
+    //  The comparison filter (PCF) and the sRGB conversion use the generic texel conversion.
+    if (!specializedKernels || textureEnableComparison[textUnit] || textureSRGB[textUnit])
+        texelConversion[textUnit] = NULL;
+    else
+    {
+        switch((textD3D9ColorConv[textUnit] ? TEXEL_ORDER_D3D9 : 0) | (textureReverse[textUnit] ? TEXEL_ORDER_REVERSE : 0))
+        {
+            case 0:
+                texelConversion[textUnit] = selectTexelConversion<0>(textureFormat[textUnit]);
+                break;
+            case TEXEL_ORDER_D3D9:
+                texelConversion[textUnit] = selectTexelConversion<TEXEL_ORDER_D3D9>(textureFormat[textUnit]);
+                break;
+            case TEXEL_ORDER_REVERSE:
+                texelConversion[textUnit] = selectTexelConversion<TEXEL_ORDER_REVERSE>(textureFormat[textUnit]);
+                break;
+            default:
+                texelConversion[textUnit] = selectTexelConversion<TEXEL_ORDER_D3D9 | TEXEL_ORDER_REVERSE>(textureFormat[textUnit]);
+                break;
+        }
+    }
+
+    switch(textureMode[textUnit])
+    {
+        case GPU_TEXTURE1D:
+            bilinearFunction[textUnit] = &bilinearKernel<1>;
+            break;
+        case GPU_TEXTURE2D:
+        case GPU_TEXTURECUBEMAP:
+            bilinearFunction[textUnit] = &bilinearKernel<2>;
+            break;
+        case GPU_TEXTURE3D:
+            bilinearFunction[textUnit] = &bilinearKernel<3>;
+            break;
+        default:
+            bilinearFunction[textUnit] = NULL;
+            break;
+    }
+}
+
 /*  Filters the texels read for a stamp texture access and generates the final sample value.  */
 void TextureEmulator::filter(TextureAccess &textAccess, u32bit nextTrilinearFilter)
 {
@@ -2408,20 +2752,32 @@ void TextureEmulator::filter(TextureAccess &textAccess, u32bit nextTrilinearFilt
         //  Filter each fragment.
         for(u32bit frag = 0; frag < stampFragments; frag++)
         {
+            f32bit *sample = textAccess.sample[frag].getVector();
+
+#ifdef __SSE2__
+            //  Add all the trilinear samples for the texture access.
+            __m128 sum = _mm_loadu_ps(sample);
+            for(u32bit subSample = 0; subSample < textAccess.anisoSamples; subSample++)
+                sum = _mm_add_ps(sum, _mm_loadu_ps(textAccess.trilinear[subSample]->sample[frag].getVector()));
+
+            //  Apply weight.
+            _mm_storeu_ps(sample, _mm_div_ps(sum, _mm_set1_ps(f32bit(textAccess.anisoSamples))));
+#else
             //  Add all the trilinear samples for the texture access.
             for(u32bit subSample = 0; subSample < textAccess.anisoSamples; subSample++)
             {
-                textAccess.sample[frag][0] += textAccess.trilinear[subSample]->sample[frag][0];
-                textAccess.sample[frag][1] += textAccess.trilinear[subSample]->sample[frag][1];
-                textAccess.sample[frag][2] += textAccess.trilinear[subSample]->sample[frag][2];
-                textAccess.sample[frag][3] += textAccess.trilinear[subSample]->sample[frag][3];
+                sample[0] += textAccess.trilinear[subSample]->sample[frag][0];
+                sample[1] += textAccess.trilinear[subSample]->sample[frag][1];
+                sample[2] += textAccess.trilinear[subSample]->sample[frag][2];
+                sample[3] += textAccess.trilinear[subSample]->sample[frag][3];
             }
 
             //  Apply weight.
-            textAccess.sample[frag][0] = textAccess.sample[frag][0] / f32bit(textAccess.anisoSamples);
-            textAccess.sample[frag][1] = textAccess.sample[frag][1] / f32bit(textAccess.anisoSamples);
-            textAccess.sample[frag][2] = textAccess.sample[frag][2] / f32bit(textAccess.anisoSamples);
-            textAccess.sample[frag][3] = textAccess.sample[frag][3] / f32bit(textAccess.anisoSamples);
+            sample[0] = sample[0] / f32bit(textAccess.anisoSamples);
+            sample[1] = sample[1] / f32bit(textAccess.anisoSamples);
+            sample[2] = sample[2] / f32bit(textAccess.anisoSamples);
+            sample[3] = sample[3] / f32bit(textAccess.anisoSamples);
+#endif
         }
 
 /*if (textAccess.accessID == 488)
@@ -2448,7 +2804,6 @@ textAccess.sample[f][2], textAccess.sample[f][3]);
 void TextureEmulator::filterTrilinear(TextureAccess &textAccess, u32bit trilinearAccess)
 {
     u32bit i;
-    QuadFloat t1, t2;
     f32bit w;
 
     GPU_ASSERT(
@@ -2456,12 +2811,21 @@ void TextureEmulator::filterTrilinear(TextureAccess &textAccess, u32bit trilinea
             panic("TextureEmulator", "filterTrilinear", "Requesting to filter more trilinear samples than those required.");
     )
 
+    if (bilinearFunction[textAccess.textUnit] == NULL)
+        panic("TextureEmulator", "filterTrilinear", "Unsupported texture mode.");
+
     /*  Update number of trilinear samples to filter for the current texture access.  */
     textAccess.trilinearToFilter--;
 
+    TextureAccess::Trilinear *trilinear = textAccess.trilinear[trilinearAccess];
+    BilinearFunction bilinear = bilinearFunction[textAccess.textUnit];
+
     /*  Filter each fragment.  */
     for(i = 0; i < stampFragments; i++)
     {
+        f32bit *texels = trilinear->texel[i][0].getVector();
+        f32bit *sample = trilinear->sample[i].getVector();
+
         /*  Select filter mode.  */
         switch(textAccess.filter[i])
         {
@@ -2469,10 +2833,7 @@ void TextureEmulator::filterTrilinear(TextureAccess &textAccess, u32bit trilinea
             case GPU_NEAREST_MIPMAP_NEAREST:
 
                 //  Point sampling.  Just copy the read texel.
-                textAccess.trilinear[trilinearAccess]->sample[i][0] = textAccess.trilinear[trilinearAccess]->texel[i][0][0];
-                textAccess.trilinear[trilinearAccess]->sample[i][1] = textAccess.trilinear[trilinearAccess]->texel[i][0][1];
-                textAccess.trilinear[trilinearAccess]->sample[i][2] = textAccess.trilinear[trilinearAccess]->texel[i][0][2];
-                textAccess.trilinear[trilinearAccess]->sample[i][3] = textAccess.trilinear[trilinearAccess]->texel[i][0][3];
+                trilinear->sample[i] = trilinear->texel[i][0];
 
                 break;
 
@@ -2480,39 +2841,25 @@ void TextureEmulator::filterTrilinear(TextureAccess &textAccess, u32bit trilinea
             case GPU_LINEAR_MIPMAP_NEAREST:
 
                 //  Bilinear filtering.
-                t1 = bilinearFilter(textAccess, trilinearAccess, 0, i);
-                textAccess.trilinear[trilinearAccess]->sample[i][0] = t1[0];
-                textAccess.trilinear[trilinearAccess]->sample[i][1] = t1[1];
-                textAccess.trilinear[trilinearAccess]->sample[i][2] = t1[2];
-                textAccess.trilinear[trilinearAccess]->sample[i][3] = t1[3];
+                bilinear(texels, 0, trilinear->a[i][0], trilinear->b[i][0], trilinear->c[i][0], sample);
 
                 break;
 
             case GPU_NEAREST_MIPMAP_LINEAR:
 
                 //  Check if two mipmaps were sampled.
-                if (textAccess.trilinear[trilinearAccess]->sampleFromTwoMips[i])
+                if (trilinear->sampleFromTwoMips[i])
                 {
                     //  Calculate weight between mipmaps as fractional part of the lod.
                     w = textAccess.lod[i] - static_cast<f32bit>(GPU_FLOOR(textAccess.lod[i]));
-                    
-                    //  Point samplig from two mip maps.  Just copy the two read texels.
-                    t1 = textAccess.trilinear[trilinearAccess]->texel[i][0];
-                    t2 = textAccess.trilinear[trilinearAccess]->texel[i][1];
-
-                    //  Interpolate between two mipmaps.
-                    textAccess.trilinear[trilinearAccess]->sample[i][0] = (t1[0] * (1.0f - w) + t2[0] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][1] = (t1[1] * (1.0f - w) + t2[1] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][2] = (t1[2] * (1.0f - w) + t2[2] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][3] = (t1[3] * (1.0f - w) + t2[3] * w);
+
+                    //  Point samplig from two mip maps.  Interpolate between the two read texels.
+                    interpolateMipmaps(&texels[0], &texels[4], w, sample);
                 }
                 else
                 {
                     //  Point sampling from single mip map.  Just copy the read texels.
-                    textAccess.trilinear[trilinearAccess]->sample[i][0] = textAccess.trilinear[trilinearAccess]->texel[i][0][0];
-                    textAccess.trilinear[trilinearAccess]->sample[i][1] = textAccess.trilinear[trilinearAccess]->texel[i][0][1];
-                    textAccess.trilinear[trilinearAccess]->sample[i][2] = textAccess.trilinear[trilinearAccess]->texel[i][0][2];
-                    textAccess.trilinear[trilinearAccess]->sample[i][3] = textAccess.trilinear[trilinearAccess]->texel[i][0][3];
+                    trilinear->sample[i] = trilinear->texel[i][0];
                 }
                 
                 break;
@@ -2520,40 +2867,26 @@ void TextureEmulator::filterTrilinear(TextureAccess &textAccess, u32bit trilinea
             case GPU_LINEAR_MIPMAP_LINEAR:
                
                 //  Check if two mipmaps were sampled.
-                if (textAccess.trilinear[trilinearAccess]->sampleFromTwoMips[i])
+                if (trilinear->sampleFromTwoMips[i])
                 {
                     //  Trilinear filter.
+                    f32bit t1[4];
+                    f32bit t2[4];
 
                     //  Calculate weight between mipmaps as fractional part of the lod.
                     w = textAccess.lod[i] - static_cast<f32bit>(GPU_FLOOR(textAccess.lod[i]));
 
                     //  Compute bilinear samples for two mipmaps.
-                    t1 = bilinearFilter(textAccess, trilinearAccess, 0, i);
-                    t2 = bilinearFilter(textAccess, trilinearAccess, 1, i);
+                    bilinear(texels, 0, trilinear->a[i][0], trilinear->b[i][0], trilinear->c[i][0], t1);
+                    bilinear(texels, 1, trilinear->a[i][1], trilinear->b[i][1], trilinear->c[i][1], t2);
 
                     /// Interpolate between two mipmaps.
-                    textAccess.trilinear[trilinearAccess]->sample[i][0] = (t1[0] * (1.0f - w) + t2[0] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][1] = (t1[1] * (1.0f - w) + t2[1] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][2] = (t1[2] * (1.0f - w) + t2[2] * w);
-                    textAccess.trilinear[trilinearAccess]->sample[i][3] = (t1[3] * (1.0f - w) + t2[3] * w);
-
-/*if (textAccess.accessID == 488)
-{
-printf("TexEmu::filterTrilinear => Pixel %02d -> sample LOD0 = {%f, %f, %f, %f}\n", i, t1[0], t1[1], t1[2], t1[3]);
-printf("TexEmu::filterTrilinear => Pixel %02d -> sample LOD1 = {%f, %f, %f, %f}\n", i, t2[0], t2[1], t2[2], t2[3]);
-printf("TexEmu::filterTrilinear => Pixel %02d -> w = %f  result = {%f, %f, %f, %f}\n", i, w, 
-textAccess.trilinear[trilinearAccess]->sample[i][0], textAccess.trilinear[trilinearAccess]->sample[i][1],
-textAccess.trilinear[trilinearAccess]->sample[i][2], textAccess.trilinear[trilinearAccess]->sample[i][3]);
-}*/
+                    interpolateMipmaps(t1, t2, w, sample);
                 }
                 else
                 {
                     //  Compute bilinear sample for a single mipmap.
-                    t1 = bilinearFilter(textAccess, trilinearAccess, 0, i);
-                    textAccess.trilinear[trilinearAccess]->sample[i][0] = t1[0];
-                    textAccess.trilinear[trilinearAccess]->sample[i][1] = t1[1];
-                    textAccess.trilinear[trilinearAccess]->sample[i][2] = t1[2];
-                    textAccess.trilinear[trilinearAccess]->sample[i][3] = t1[3];
+                    bilinear(texels, 0, trilinear->a[i][0], trilinear->b[i][0], trilinear->c[i][0], sample);
                 }
                 
                 break;
@@ -2565,126 +2898,6 @@ textAccess.trilinear[trilinearAccess]->sample[i][2], textAccess.trilinear[trilin
     }
 }
 
-/*  Performs a bilinear filtering at a mipmap level for a fragment in a stamp texture access. */
-QuadFloat TextureEmulator::bilinearFilter(TextureAccess &textAccess, u32bit trilinearAccess, u32bit level, u32bit frag)
-{
-    QuadFloat sample;
-    f32bit a, b, c;
-
-    /*  Select texture mode.  */
-    switch(textureMode[textAccess.textUnit])
-    {
-        case GPU_TEXTURE1D:
-
-            a = textAccess.trilinear[trilinearAccess]->a[frag][level];
-
-            /*  Linear filtering between two points.  */
-            sample[0] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 1][0] * a
-                + textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 0][0] * (1.0f - a);
-            sample[1] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 1][1] * a
-                + textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 0][1] * (1.0f - a);
-            sample[2] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 1][2] * a
-                + textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 0][2] * (1.0f - a);
-            sample[3] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 1][3] * a
-                + textAccess.trilinear[trilinearAccess]->texel[frag][level * 2 + 0][3] * (1.0f - a);
-
-            break;
-
-        case GPU_TEXTURE2D:
-        case GPU_TEXTURECUBEMAP:
-
-            /*  Get filter weights.  */
-            a = textAccess.trilinear[trilinearAccess]->a[frag][level];
-            b = textAccess.trilinear[trilinearAccess]->b[frag][level];
-
-            /*  Bilinear filtering between four points.  */
-            sample[0] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 0][0] * (1.0f - a) * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 1][0] * a * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 2][0] * (1.0f - a) * b +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 3][0] * a * b;
-
-            sample[1] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 0][1] * (1.0f - a) * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 1][1] * a * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 2][1] * (1.0f - a) * b +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 3][1] * a * b;
-
-            sample[2] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 0][2] * (1.0f - a) * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 1][2] * a * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 2][2] * (1.0f - a) * b +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 3][2] * a * b;
-
-            sample[3] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 0][3] * (1.0f - a) * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 1][3] * a * (1.0f - b) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 2][3] * (1.0f - a) * b +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + 3][3] * a * b;
-
-/*if (textAccess.accessID == 488)
-{
-printf("TexEmu::bilinearFilter => Pixel %02d -> a = %f b = %f level = %d\n", frag, a, b, level);
-for(u32bit t = 0; t < 4; t++)
-printf("   Texel %02d -> {%f, %f, %f, %f}\n", t,
-textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + t][0],
-textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + t][1],
-textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + t][2],
-textAccess.trilinear[trilinearAccess]->texel[frag][level * 4 + t][3]);
-printf("   Result -> {%f, %f, %f, %f}\n", sample[0], sample[1], sample[2], sample[3]);
-}*/
-//printf("Filter => %f %f %f %f\n", sample[0],  sample[1],  sample[2],  sample[3]);
-            break;
-
-        case GPU_TEXTURE3D:
-
-            /*  Get filter weights.  */
-            a = textAccess.trilinear[trilinearAccess]->a[frag][level];
-            b = textAccess.trilinear[trilinearAccess]->b[frag][level];
-            c = textAccess.trilinear[trilinearAccess]->c[frag][level];
-
-            /*  Bilinear filtering for 8 samples.  */
-            sample[0] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 0][0] * (1.0f - a) * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 1][0] * a * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 2][0] * (1.0f - a) * b * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 3][0] * a * b * (1.0f - c)+
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 4][0] * (1.0f - a) * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 5][0] * a * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 6][0] * (1.0f - a) * b * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 7][0] * a * b * c;
-
-            sample[1] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 0][1] * (1.0f - a) * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 1][1] * a * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 2][1] * (1.0f - a) * b * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 3][1] * a * b * (1.0f - c)+
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 4][1] * (1.0f - a) * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 5][1] * a * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 6][1] * (1.0f - a) * b * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 7][1] * a * b * c;
-
-            sample[2] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 0][2] * (1.0f - a) * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 1][2] * a * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 2][2] * (1.0f - a) * b * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 3][2] * a * b * (1.0f - c)+
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 4][2] * (1.0f - a) * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 5][2] * a * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 6][2] * (1.0f - a) * b * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 7][2] * a * b * c;
-
-            sample[3] = textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 0][3] * (1.0f - a) * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 1][3] * a * (1.0f - b) * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 2][3] * (1.0f - a) * b * (1.0f - c) +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 3][3] * a * b * (1.0f - c)+
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 4][3] * (1.0f - a) * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 5][3] * a * (1.0f - b) * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 6][3] * (1.0f - a) * b * c +
-                textAccess.trilinear[trilinearAccess]->texel[frag][level * 8 + 7][3] * a * b * c;
-
-            break;
-
-        default:
-            panic("TextureEmulator", "bilinearFilter", "Unsupported texture mode.");
-    }
-
-    return sample;
-}
-
 /*
     Textures are stored in memory in the following manner:
 
@@ -2827,7 +3040,7 @@ u64bit TextureEmulator::texel2address(u32bit textUnit, u32bit level, u32bit cube
             blockAddr = GPUMath::morton(textCacheSBlockDim, i >> textCacheBlockDim, j >> textCacheBlockDim);
         
             //  Calculate the 2's logarithm of the mipmap width.
-            mipmapWidthLog2 = u32bit(GPU_CEIL(GPU_LOG2(GPU_MAX(textureWidth[textUnit] >> level, u32bit(1)))));
+            mipmapWidthLog2 = textureMipWidthLog2[textUnit][level];
             
             //  Calculate the number of 
             sBlocksPerLine = GPU_MAX(s32bit(mipmapWidthLog2) - s32bit((textCacheSBlockDim + textCacheBlockDim)), s32bit(0));
@@ -3021,7 +3234,7 @@ u64bit TextureEmulator::texel2address(u32bit textUnit, u32bit level, u32bit cube
             //    (i >> (textCacheSBlockDim + textCacheBlockDim));
             
             //  Calculate the 2's logarithm of the mipmap width.
-            mipmapWidthLog2 = u32bit(GPU_CEIL(GPU_LOG2(GPU_MAX(textureWidth[textUnit] >> level, u32bit(1)))));
+            mipmapWidthLog2 = textureMipWidthLog2[textUnit][level];
             
             //  Calculate the number of 
             sBlocksPerLine = GPU_MAX(s32bit(mipmapWidthLog2) - s32bit((textCacheSBlockDim + textCacheBlockDim)), s32bit(0));
@@ -3182,6 +3395,13 @@ void TextureEmulator::convertFormat(TextureAccess &textAccess, u32bit trilinearA
     /*  Get texel address.  */
     address = textAccess.trilinear[trilinearAccess]->address[frag][tex];
 
+    //  Use the texel conversion specialized for the texture unit state if available.
+    if (texelConversion[textAccess.textUnit] != NULL)
+    {
+        texelConversion[textAccess.textUnit](data, address, textAccess.trilinear[trilinearAccess]->texel[frag][tex].getVector());
+        return;
+    }
+
     switch(textureFormat[textAccess.textUnit])
     {
         case GPU_ALPHA8:
@@ -3769,154 +3989,328 @@ u32bit TextureEmulator::format(TextureFormat format, QuadFloat color)
     return output;
 }
 
-/*  Decode a S3TC compressed texture using DXT1 encoding for RGB format.  */
-void TextureEmulator::decodeBlockDXT1RGB(u8bit *inBuffer, u8bit *outBuffer)
+//  Position in Morton order of the texels of a 4x4 block in row order (GPUMath::morton(2, i, j)).
+static const u32bit blockTexelOrder[16] = {0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15};
+
+//  Converted RGBA8888 alpha for each 4-bit DXT3 explicit alpha value (format(GPU_RGBA8888, {0, 0, 0, code / 15})).
+static const u32bit explicitAlphaPalette[16] =
 {
-    u32bit color0, color1;
-    QuadFloat RGBA0, RGBA1;
-    QuadFloat decodedColor;
-    u32bit code;
-    u32bit colorbits;
-    u32bit i, j;
+    0x00000000, 0x11000000, 0x22000000, 0x33000000, 0x44000000, 0x55000000, 0x66000000, 0x77000000,
+    0x88000000, 0x99000000, 0xaa000000, 0xbb000000, 0xcc000000, 0xdd000000, 0xee000000, 0xff000000
+};
+
+//
+//  The block decoders compute the palette of the block (the format converted value for each code) once
+//  and then store the palette entry selected by each texel code.  The palette entries are computed
+//  using the same decode and format functions than the per texel conversion so the result is bit exact.
+//  Color and alpha (or luminance and alpha) are converted separately as each component of the converted
+//  value only depends on its own input component.
+//
+//  The SSE2 versions compute the palette entries with the same single precision operations, in the same
+//  order, than decodeS3TCAlpha, nonTransparentS3TCRGB, transparentS3TCRGB and format, and select the
+//  palette entries for a row of four texels with compares against the codes in each lane.
+//
+
+#ifdef __SSE2__
+
+/*  Converts the four palette entries of a S3TC color block ({R, G, B, A} per entry) to RGBA8888.  */
+static inline void formatPaletteSIMD(__m128 p0, __m128 p1, __m128 p2, __m128 p3, u32bit *palette)
+{
+    const __m128 scale = _mm_set1_ps(255.0f);
 
-    /*  Patch to detect use of non initialized memory.  */
-    if (*((u32bit *) inBuffer) == 0xDEADCAFE)
+    __m128i c0 = _mm_cvttps_epi32(_mm_mul_ps(p0, scale));
+    __m128i c1 = _mm_cvttps_epi32(_mm_mul_ps(p1, scale));
+    __m128i c2 = _mm_cvttps_epi32(_mm_mul_ps(p2, scale));
+    __m128i c3 = _mm_cvttps_epi32(_mm_mul_ps(p3, scale));
+
+    //  Components are in the [0, 255] range so saturating packs keep the bytes.
+    _mm_storeu_si128((__m128i *) palette, _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3)));
+}
+
+/*  Computes the RGBA8888 palette for a S3TC color block.  All the entries use the same alpha.  */
+static inline void paletteS3TCRGBSIMD(QuadFloat &RGBA0, QuadFloat &RGBA1, bool transparent, f32bit alpha,
+    u32bit *palette)
+{
+    __m128 c0 = _mm_set_ps(alpha, RGBA0[2], RGBA0[1], RGBA0[0]);
+    __m128 c1 = _mm_set_ps(alpha, RGBA1[2], RGBA1[1], RGBA1[0]);
+
+    if (!transparent)
     {
-        for(i = 0; i < 16; i++)
+        //  (2 * RGB0 + RGB1) / 3 and (RGB0 + 2 * RGB1) / 3.
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 three = _mm_set1_ps(3.0f);
+
+        formatPaletteSIMD(c0, c1, _mm_div_ps(_mm_add_ps(_mm_mul_ps(two, c0), c1), three),
+            _mm_div_ps(_mm_add_ps(c0, _mm_mul_ps(two, c1)), three), palette);
+    }
+    else
+    {
+        //  (RGB0 + RGB1) / 2 and BLACK.
+        formatPaletteSIMD(c0, c1, _mm_mul_ps(_mm_add_ps(c0, c1), _mm_set1_ps(0.5f)), _mm_set_ps(alpha, 0.0f, 0.0f, 0.0f),
+            palette);
+    }
+}
+
+/*  Decodes the eight S3TC alpha codes, scales them and converts them to integer (truncating as format does).  */
+static inline void paletteS3TCAlphaSIMD(f32bit alpha0, f32bit alpha1, f32bit scale, s32bit *palette)
+{
+    __m128 a0 = _mm_set1_ps(alpha0);
+    __m128 a1 = _mm_set1_ps(alpha1);
+    __m128 lo;
+    __m128 hi;
+
+    //  Codes 0 and 1 use weights {1, 0} and {0, 1} and no division so the reference value is kept.
+    if (alpha0 > alpha1)
+    {
+        lo = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps(5.0f, 6.0f, 0.0f, 1.0f), a0), _mm_mul_ps(_mm_set_ps(2.0f, 1.0f, 1.0f, 0.0f), a1)),
+            _mm_set_ps(7.0f, 7.0f, 1.0f, 1.0f));
+        hi = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps(1.0f, 2.0f, 3.0f, 4.0f), a0), _mm_mul_ps(_mm_set_ps(6.0f, 5.0f, 4.0f, 3.0f), a1)),
+            _mm_set1_ps(7.0f));
+    }
+    else
+    {
+        lo = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps(3.0f, 4.0f, 0.0f, 1.0f), a0), _mm_mul_ps(_mm_set_ps(2.0f, 1.0f, 1.0f, 0.0f), a1)),
+            _mm_set_ps(5.0f, 5.0f, 1.0f, 1.0f));
+
+        //  Codes 6 and 7 are 0 and 1.
+        __m128 interpolated = _mm_div_ps(_mm_add_ps(_mm_mul_ps(_mm_set_ps(0.0f, 0.0f, 1.0f, 2.0f), a0),
+            _mm_mul_ps(_mm_set_ps(0.0f, 0.0f, 4.0f, 3.0f), a1)), _mm_set1_ps(5.0f));
+        hi = _mm_or_ps(_mm_and_ps(interpolated, _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1))), _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f));
+    }
+
+    __m128 s = _mm_set1_ps(scale);
+    _mm_storeu_si128((__m128i *) &palette[0], _mm_cvttps_epi32(_mm_mul_ps(lo, s)));
+    _mm_storeu_si128((__m128i *) &palette[4], _mm_cvttps_epi32(_mm_mul_ps(hi, s)));
+}
+
+/*  Selects the palette entry for each texel code of a 4x4 block and ORs the selected 32-bit values into the
+    four vectors of the block (one per 2x2 quad, Morton order).  */
+static inline void selectBlockSIMD(const u32bit *palette, u32bit entries, u64bit codes, u32bit bits, __m128i *block)
+{
+    u32bit mask = (1 << bits) - 1;
+    __m128i laneMask = _mm_set_epi32(mask << (3 * bits), mask << (2 * bits), mask << bits, mask);
+    __m128i codeStep = _mm_set_epi32(1 << (3 * bits), 1 << (2 * bits), 1 << bits, 1);
+    __m128i entry[16];
+    __m128i row[4];
+
+    for(u32bit c = 0; c < entries; c++)
+        entry[c] = _mm_set1_epi32(palette[c]);
+
+    for(u32bit j = 0; j < 4; j++)
+    {
+        //  Each lane keeps the code of its texel at the texel bit position.
+        __m128i rowCodes = _mm_and_si128(_mm_set1_epi32(s32bit(codes >> (4 * bits * j))), laneMask);
+        __m128i code = _mm_setzero_si128();
+
+        row[j] = _mm_setzero_si128();
+
+        for(u32bit c = 0; c < entries; c++)
         {
-            ((u32bit *) outBuffer)[i] = 0xFFFFFFFF;
+            row[j] = _mm_or_si128(row[j], _mm_and_si128(_mm_cmpeq_epi32(rowCodes, code), entry[c]));
+            code = _mm_add_epi32(code, codeStep);
         }
+    }
 
-        return;
+    //  Rows {0, 1} and {2, 3} form the 2x2 quads.
+    block[0] = _mm_or_si128(block[0], _mm_unpacklo_epi64(row[0], row[1]));
+    block[1] = _mm_or_si128(block[1], _mm_unpackhi_epi64(row[0], row[1]));
+    block[2] = _mm_or_si128(block[2], _mm_unpacklo_epi64(row[2], row[3]));
+    block[3] = _mm_or_si128(block[3], _mm_unpackhi_epi64(row[2], row[3]));
+}
+
+/*  Stores a block of 32-bit texels.  */
+static inline void storeBlockSIMD32(const __m128i *block, u8bit *outBuffer)
+{
+    for(u32bit q = 0; q < 4; q++)
+        _mm_storeu_si128(((__m128i *) outBuffer) + q, block[q]);
+}
+
+/*  Stores a block of 8-bit texels (the 32-bit values are in the [0, 255] range).  */
+static inline void storeBlockSIMD8(const __m128i *block, u8bit *outBuffer)
+{
+    _mm_storeu_si128((__m128i *) outBuffer, _mm_packus_epi16(_mm_packs_epi32(block[0], block[1]),
+        _mm_packs_epi32(block[2], block[3])));
+}
+
+/*  Stores a block of 16-bit texels (the 32-bit values are in the [0, 65535] range).  */
+static inline void storeBlockSIMD16(const __m128i *block, u8bit *outBuffer)
+{
+    //  SSE2 has no unsigned 32 to 16 bit pack, bias the values to the signed range.
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(s16bit(0x8000));
+
+    for(u32bit h = 0; h < 2; h++)
+    {
+        __m128i packed = _mm_packs_epi32(_mm_sub_epi32(block[2 * h], bias32), _mm_sub_epi32(block[2 * h + 1], bias32));
+        _mm_storeu_si128(((__m128i *) outBuffer) + h, _mm_xor_si128(packed, bias16));
     }
+}
+
+#endif
+
+/*  Fills a decompressed 4x4 block of 32 bit texels from the palette and the 2-bit codes of the texels.  */
+static inline void storeBlock32(const u32bit *palette, u32bit codes, u8bit *outBuffer)
+{
+#ifdef __SSE2__
+    __m128i block[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+
+    selectBlockSIMD(palette, 4, codes, 2, block);
+    storeBlockSIMD32(block, outBuffer);
+#else
+    for(u32bit t = 0; t < 16; t++)
+    {
+        ((u32bit *) outBuffer)[blockTexelOrder[t]] = palette[codes & 0x03];
+        codes = codes >> 2;
+    }
+#endif
+}
 
+/*  Fills a decompressed 4x4 block of 32 bit texels from the color and alpha palettes and the texel codes.  */
+static inline void storeBlock32(const u32bit *colorPalette, u32bit colorCodes, const u32bit *alphaPalette,
+    u32bit alphaEntries, u64bit alphaCodes, u32bit alphaBits, u8bit *outBuffer)
+{
+#ifdef __SSE2__
+    __m128i block[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+
+    selectBlockSIMD(colorPalette, 4, colorCodes, 2, block);
+    selectBlockSIMD(alphaPalette, alphaEntries, alphaCodes, alphaBits, block);
+    storeBlockSIMD32(block, outBuffer);
+#else
+    u32bit alphaMask = alphaEntries - 1;
+
+    for(u32bit t = 0; t < 16; t++)
+    {
+        ((u32bit *) outBuffer)[blockTexelOrder[t]] = colorPalette[colorCodes & 0x03] | alphaPalette[alphaCodes & alphaMask];
+        colorCodes = colorCodes >> 2;
+        alphaCodes = alphaCodes >> alphaBits;
+    }
+#endif
+}
+
+/*  Computes the color palette for a S3TC color block.  */
+static inline void paletteS3TCRGB(u8bit *colorData, QuadFloat &RGBA0, QuadFloat &RGBA1, u32bit &color0, u32bit &color1)
+{
     /*  Convert first reference color of the compressed block to RGBA.  */
-    color0 = (inBuffer[1] << 8) + inBuffer[0];
+    color0 = (colorData[1] << 8) + colorData[0];
     RGBA0[0] = f32bit(color0 >> 11) * (1.0f / 31.0f);
     RGBA0[1] = f32bit((color0 >> 5) & 0x3f) * (1.0f / 63.0f);
     RGBA0[2] = f32bit(color0 & 0x1f) * (1.0f / 31.0f);
-    //RGBA0[3] = 1.0f;
 
     /*  Convert second reference color of the compressed block to RGBA.  */
-    color1 = (inBuffer[3] << 8) + inBuffer[2];
+    color1 = (colorData[3] << 8) + colorData[2];
     RGBA1[0] = f32bit(color1 >> 11) * (1.0f / 31.0f);
     RGBA1[1] = f32bit((color1 >> 5) & 0x3f) * (1.0f / 63.0f);
     RGBA1[2] = f32bit(color1 & 0x1f) * (1.0f / 31.0f);
-    //RGBA1[3] = 1.0f;
-
-    /*  Get the code bits for the color components in the block.  */
-    colorbits = inBuffer[4] + u32bit(inBuffer[5] << 8) + u32bit(inBuffer[6] << 16) + u32bit(inBuffer[7] << 24);
+}
 
-    /*  Generate the decoded colors for all the texels in the block.  */
-    for(j = 0; j < 4; j++)
+/*  Fills the block with the pattern used for non initialized memory.  Returns if the pattern was detected.  */
+static inline bool uninitializedBlock(u8bit *inBuffer, u8bit *outBuffer)
+{
+    /*  Patch to detect use of non initialized memory.  */
+    if (*((u32bit *) inBuffer) == 0xDEADCAFE)
     {
-        for(i = 0; i < 4; i++)
-        {
-            /*  Get code for the texel.  */
-            //code = (inBuffer[4 + j] >> (i * 2)) & 0x03;
-            code = colorbits & 0x03;
-            colorbits = colorbits >> 2;
+        for(u32bit i = 0; i < 16; i++)
+            ((u32bit *) outBuffer)[i] = 0xFFFFFFFF;
 
-            /*  Determine if transparent or non-transparent encoding must be used.  */
-            if (color0 > color1)
-            {
-                /*  Use non transparent encoding.  */
-                nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
-            }
-            else
-            {
-                /*  Use transparent encoding.  */
-                transparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
-            }
+        return true;
+    }
 
-            /*  Alpha is always non transparent for RGB format.  */
-            decodedColor[3] = 1.0f;
+    return false;
+}
 
-            /*  Store block color in Morton order and 32 bit RGBA format.  */
-            ((u32bit *) outBuffer)[GPUMath::morton(2, i, j)] = format(GPU_RGBA8888, decodedColor);
-        }
-    }
+/*  Reads the 48 bits with the 3-bit codes of a S3TC alpha or LATC block.  */
+static inline u64bit codesS3TCAlpha(const u8bit *codes)
+{
+    return ((u64bit) codes[0]) + (((u64bit) codes[1]) << 8) + (((u64bit) codes[2]) << 16) +
+        (((u64bit) codes[3]) << 24) + (((u64bit) codes[4]) << 32) + (((u64bit) codes[5]) << 40);
 }
 
-/*  Decode a S3TC compressed texture using DXT1 encoding for RGBA format.  */
-void TextureEmulator::decodeBlockDXT1RGBA(u8bit *inBuffer, u8bit *outBuffer)
+/*  Decode a S3TC compressed texture using DXT1 encoding for RGB format.  */
+void TextureEmulator::decodeBlockDXT1RGB(u8bit *inBuffer, u8bit *outBuffer)
 {
     u32bit color0, color1;
     QuadFloat RGBA0, RGBA1;
+    u32bit palette[4];
+
+    if (uninitializedBlock(inBuffer, outBuffer))
+        return;
+
+    paletteS3TCRGB(inBuffer, RGBA0, RGBA1, color0, color1);
+
+    /*  Compute the decoded color for each code.  Alpha is always non transparent for RGB format.  */
+#ifdef __SSE2__
+    paletteS3TCRGBSIMD(RGBA0, RGBA1, color0 <= color1, 1.0f, palette);
+#else
     QuadFloat decodedColor;
-    u32bit code;
-    u32bit colorbits;
-    u32bit i, j;
 
-    /*  Patch to detect use of non initialized memory.  */
-    if (*((u32bit *) inBuffer) == 0xDEADCAFE)
+    for(u32bit code = 0; code < 4; code++)
     {
-        for(i = 0; i < 16; i++)
-        {
-            ((u32bit *) outBuffer)[i] = 0xFFFFFFFF;
-        }
+        /*  Determine if transparent or non-transparent encoding must be used.  */
+        if (color0 > color1)
+            nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+        else
+            transparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
 
-        return;
+        decodedColor[3] = 1.0f;
+
+        palette[code] = format(GPU_RGBA8888, decodedColor);
     }
+#endif
 
-    /*  Convert first reference color of the compressed block to RGBA.  */
-    color0 = (inBuffer[1] << 8) + inBuffer[0];
-    RGBA0[0] = ((f32bit) (color0 >> 11)) * (1.0f / 31.0f);
-    RGBA0[1] = ((f32bit) ((color0 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA0[2] = ((f32bit) (color0 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA0[3] = 1.0f;
+    /*  Store block colors in Morton order and 32 bit RGBA format.  */
+    storeBlock32(palette, inBuffer[4] + u32bit(inBuffer[5] << 8) + u32bit(inBuffer[6] << 16) + u32bit(inBuffer[7] << 24),
+        outBuffer);
+}
 
-    /*  Convert second reference color of the compressed block to RGBA.  */
-    color1 = (inBuffer[3] << 8) + inBuffer[2];
-    RGBA1[0] = ((f32bit) (color1 >> 11)) * (1.0f / 31.0f);
-    RGBA1[1] = ((f32bit) ((color1 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA1[2] = ((f32bit) (color1 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA1[3] = 1.0f;
+/*  Decode a S3TC compressed texture using DXT1 encoding for RGBA format.  */
+void TextureEmulator::decodeBlockDXT1RGBA(u8bit *inBuffer, u8bit *outBuffer)
+{
+    u32bit color0, color1;
+    QuadFloat RGBA0, RGBA1;
+    u32bit palette[4];
 
-//printf("RGBA0 = {%f, %f, %f, %f}\n", RGBA0[0], RGBA0[1], RGBA0[2], RGBA0[3]);
-//printf("RGBA1 = {%f, %f, %f, %f}\n", RGBA1[0], RGBA1[1], RGBA1[2], RGBA1[3]);
+    if (uninitializedBlock(inBuffer, outBuffer))
+        return;
 
-    /*  Get the code bits for the color components in the block.  */
-    colorbits = inBuffer[4] + u32bit(inBuffer[5] << 8) + u32bit(inBuffer[6] << 16) + u32bit(inBuffer[7] << 24);
+    paletteS3TCRGB(inBuffer, RGBA0, RGBA1, color0, color1);
 
-    /*  Generate the decoded colors for all the texels in the block.  */
-    for(j = 0; j < 4; j++)
-    {
-        for(i = 0; i < 4; i++)
-        {
-            /*  Get code for the texel.  */
-            //code = (inBuffer[4 + j] >> (i * 2)) & 0x03;
-            code = colorbits & 0x03;
-            colorbits = colorbits >> 2;
+    /*  Compute the decoded color for each code.  */
+#ifdef __SSE2__
+    paletteS3TCRGBSIMD(RGBA0, RGBA1, color0 <= color1, 1.0f, palette);
 
-            /*  Determine if transparent or non-transparent encoding must be used.  */
-            if (color0 > color1)
-            {
-                /*  Use non transparent encoding.  */
-                nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+    /*  Patch special transparent case (black with alpha 0).  */
+    if (color0 <= color1)
+        palette[3] = 0;
+#else
+    QuadFloat decodedColor;
 
-                /*  Non transparent alpha.  */
-                decodedColor[3] = 1.0f;
-            }
-            else
-            {
-                /*  Use transparent encoding.  */
-                transparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+    for(u32bit code = 0; code < 4; code++)
+    {
+        /*  Determine if transparent or non-transparent encoding must be used.  */
+        if (color0 > color1)
+        {
+            /*  Use non transparent encoding.  */
+            nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
 
-                /*  Patch special non transparent case.  */
-                if (code != 0x03)
-                    decodedColor[3] = 1.0f;
-                else
-                    decodedColor[3] = 0.0f;
-            }
+            /*  Non transparent alpha.  */
+            decodedColor[3] = 1.0f;
+        }
+        else
+        {
+            /*  Use transparent encoding.  */
+            transparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
 
-//printf("Decoded texel (%d, %d) stored as %d\n", i, j, GPUMath::morton(2, i, j));
-//printf("Decoded color {%f, %f, %f, %f} -> %x\n", decodedColor[0],
-//decodedColor[1], decodedColor[2], decodedColor[3], format(GPU_RGBA8888, decodedColor));
-            /*  Store block color in Morton order and 32 bit RGBA format.  */
-            ((u32bit *) outBuffer)[GPUMath::morton(2, i, j)] = format(GPU_RGBA8888, decodedColor);
+            /*  Patch special non transparent case.  */
+            decodedColor[3] = (code != 0x03) ? 1.0f : 0.0f;
         }
+
+        palette[code] = format(GPU_RGBA8888, decodedColor);
     }
+#endif
+
+    /*  Store block colors in Morton order and 32 bit RGBA format.  */
+    storeBlock32(palette, inBuffer[4] + u32bit(inBuffer[5] << 8) + u32bit(inBuffer[6] << 16) + u32bit(inBuffer[7] << 24),
+        outBuffer);
 }
 
 /*  Decode a S3TC compressed texture using DXT3 encoding for RGBA format.  */
@@ -3924,40 +4318,28 @@ void TextureEmulator::decodeBlockDXT3RGBA(u8bit *inBuffer, u8bit *outBuffer)
 {
     u32bit color0, color1;
     QuadFloat RGBA0, RGBA1;
-    QuadFloat decodedColor;
-    u32bit code;
+    u32bit colorPalette[4];
     u32bit colorbits;
     u64bit alphabits;
-    u32bit i, j;
-
-    /*  Patch to detect use of non initialized memory.  */
-    if (((u32bit *) inBuffer)[0] == 0xDEADCAFE)
-    {
-        for(i = 0; i < 16; i++)
-        {
-            ((u32bit *) outBuffer)[i] = 0xFFFFFFFF;
-        }
 
+    if (uninitializedBlock(inBuffer, outBuffer))
         return;
-    }
 
-//printf("DXT3C Block: ");
-//for(i = 0; i < 16; i++) printf("%02x ", inBuffer[i]);
-//printf("\n");
+    paletteS3TCRGB(&inBuffer[8], RGBA0, RGBA1, color0, color1);
 
-    /*  Convert first reference color of the compressed block to RGBA.  */
-    color0 = (inBuffer[9] << 8) + inBuffer[8];
-    RGBA0[0] = ((f32bit) (color0 >> 11)) * (1.0f / 31.0f);
-    RGBA0[1] = ((f32bit) ((color0 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA0[2] = ((f32bit) (color0 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA0[3] = 1.0f;
+    /*  Compute the decoded color (alpha converted as 0) for each code.  */
+#ifdef __SSE2__
+    paletteS3TCRGBSIMD(RGBA0, RGBA1, false, 0.0f, colorPalette);
+#else
+    QuadFloat decodedColor;
 
-    /*  Convert second reference color of the compressed block to RGBA.  */
-    color1 = (inBuffer[11] << 8) + inBuffer[10];
-    RGBA1[0] = ((f32bit) (color1 >> 11)) * (1.0f / 31.0f);
-    RGBA1[1] = ((f32bit) ((color1 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA1[2] = ((f32bit) (color1 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA1[3] = 1.0f;
+    for(u32bit code = 0; code < 4; code++)
+    {
+        nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+        decodedColor[3] = 0.0f;
+        colorPalette[code] = format(GPU_RGBA8888, decodedColor);
+    }
+#endif
 
     /*  Get the code bits for the color components in the block.  */
     colorbits = inBuffer[12] + (inBuffer[13] << 8) + (inBuffer[14] << 16) + (inBuffer[15] << 24);
@@ -3967,31 +4349,8 @@ void TextureEmulator::decodeBlockDXT3RGBA(u8bit *inBuffer, u8bit *outBuffer)
         (((u64bit) inBuffer[3]) << 24) + (((u64bit) inBuffer[4]) << 32) + (((u64bit) inBuffer[5]) << 40) +
         (((u64bit) inBuffer[6]) << 48) + (((u64bit) inBuffer[7]) << 56);
 
-    /*  Generate the decoded colors for all the texels in the block.  */
-    for(j = 0; j < 4; j++)
-    {
-        for(i = 0; i < 4; i++)
-        {
-            /*  Get code for the texel.  */
-            //code = (inBuffer[12 + j] >> (i * 2)) & 0x03;
-            code = colorbits & 0x03;
-            colorbits = colorbits >> 2;
-
-            /*  Decode color using non-transparent encoding.  */
-            nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
-
-            /*  Decode alpha.  */
-            decodedColor[3] = f32bit(alphabits & 0x0f) * (1.0f / 15.0f);
-            alphabits = alphabits >> 4;
-
-//printf("-> alphabits %llx\n", alphabits);
-//printf("DXT3 => {%d, %d}, decoded color { %f, %f, %f, %f } => %x\n", i, j,
-//    decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3], format(GPU_RGBA8888, decodedColor));
-
-            /*  Store block color in Morton order and 32 bit RGBA format.  */
-            ((u32bit *) outBuffer)[GPUMath::morton(2, i, j)] = format(GPU_RGBA8888, decodedColor);
-        }
-    }
+    /*  Store block colors in Morton order and 32 bit RGBA format.  */
+    storeBlock32(colorPalette, colorbits, explicitAlphaPalette, 16, alphabits, 4, outBuffer);
 }
 
 /*  Decode a S3TC compressed texture using DXT5 encoding for RGBA format.  */
@@ -3999,271 +4358,225 @@ void TextureEmulator::decodeBlockDXT5RGBA(u8bit *inBuffer, u8bit *outBuffer)
 {
     u32bit color0, color1;
     QuadFloat RGBA0, RGBA1;
-    float alpha0, alpha1;
-    QuadFloat decodedColor;
-    u32bit code;
-    u32bit alphacode;
-    u64bit alphabits;
+    f32bit alpha0, alpha1;
+    u32bit colorPalette[4];
+    u32bit alphaPalette[8];
     u32bit colorbits;
-    u32bit i, j;
-
-    /*  Patch to detect use of non initialized memory.  */
-    if (((u32bit *) inBuffer)[0] == 0xDEADCAFE)
-    {
-        for(i = 0; i < 16; i++)
-        {
-            ((u32bit *) outBuffer)[i] = 0xFFFFFFFF;
-        }
 
+    if (uninitializedBlock(inBuffer, outBuffer))
         return;
-    }
 
-    /*  Convert first reference color of the compressed block to RGBA.  */
-    color0 = (inBuffer[9] << 8) + inBuffer[8];
-    RGBA0[0] = ((f32bit) (color0 >> 11)) * (1.0f / 31.0f);
-    RGBA0[1] = ((f32bit) ((color0 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA0[2] = ((f32bit) (color0 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA0[3] = 1.0f;
+    paletteS3TCRGB(&inBuffer[8], RGBA0, RGBA1, color0, color1);
 
-    /*  Convert second reference color of the compressed block to RGBA.  */
-    color1 = (inBuffer[11] << 8) + inBuffer[10];
-    RGBA1[0] = ((f32bit) (color1 >> 11)) * (1.0f / 31.0f);
-    RGBA1[1] = ((f32bit) ((color1 >> 5) & 0x3f)) * (1.0f / 63.0f);
-    RGBA1[2] = ((f32bit) (color1 & 0x1f)) * (1.0f / 31.0f);
-    //RGBA1[3] = 1.0f;
-
-    /*  Get the code bits for the color components in the block.  */
-    colorbits = inBuffer[12] + (inBuffer[13] << 8) + (inBuffer[14] << 16) + (inBuffer[15] << 24);
-
-    /*  Convert first reference alpha from the compressed block.  */
+    /*  Convert the reference alphas from the compressed block.  */
     alpha0 = f32bit(inBuffer[0]) * (1.0f / 255.0f);
-
-    /*  Convert second reference alpha from the compressed block.  */
     alpha1 = f32bit(inBuffer[1]) * (1.0f / 255.0f);
 
-    /*  Get the code bits for the alpha components in the block.  */
-    alphabits = ((u64bit) inBuffer[2]) + (((u64bit) inBuffer[3]) << 8) + (((u64bit) inBuffer[4]) << 16) +
-        (((u64bit) inBuffer[5]) << 24) + (((u64bit) inBuffer[6]) << 32) + (((u64bit) inBuffer[7]) << 40);
+    /*  Compute the decoded color (alpha converted as 0) and the converted alpha for each code.  */
+#ifdef __SSE2__
+    s32bit alphas[8];
+
+    paletteS3TCRGBSIMD(RGBA0, RGBA1, false, 0.0f, colorPalette);
+    paletteS3TCAlphaSIMD(alpha0, alpha1, 255.0f, alphas);
 
-    /*  Generate the decoded colors for all the texels in the block.  */
-    for(j = 0; j < 4; j++)
+    for(u32bit code = 0; code < 8; code++)
+        alphaPalette[code] = u32bit(alphas[code] & 0xFF) << 24;
+#else
+    QuadFloat decodedColor;
+
+    for(u32bit code = 0; code < 4; code++)
     {
-        for(i = 0; i < 4; i++)
-        {
-            /*  Get code for the texel.  */
-            //code = (inBuffer[12 + j] >> (i * 2)) & 0x03;
-            code = colorbits & 0x03;
-            colorbits = colorbits >> 2;
+        nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+        decodedColor[3] = 0.0f;
+        colorPalette[code] = format(GPU_RGBA8888, decodedColor);
+    }
 
-            /*  Decode color using non-transparent encoding.  */
-            nonTransparentS3TCRGB(code, RGBA0, RGBA1, decodedColor);
+    for(u32bit code = 0; code < 8; code++)
+        alphaPalette[code] = format(GPU_RGBA8888, QuadFloat(0.0f, 0.0f, 0.0f, decodeS3TCAlpha(code, alpha0, alpha1)));
+#endif
+
+    /*  Get the code bits for the color components in the block.  */
+    colorbits = inBuffer[12] + (inBuffer[13] << 8) + (inBuffer[14] << 16) + (inBuffer[15] << 24);
+
+    /*  Store block colors in Morton order and 32 bit RGBA format.  */
+    storeBlock32(colorPalette, colorbits, alphaPalette, 8, codesS3TCAlpha(&inBuffer[2]), 3, outBuffer);
+}
 
-            /*  Get the three bit alpha code for the texel in the 4x4 block.  */
-            //alphacode = (alphaBits >> (3 * (4 * j + i))) & 0x07;
-            alphacode = u32bit(alphabits & 0x07);
-            alphabits = alphabits >> 3;
+//  Decodes a LATC1 or LATC1_SIGNED compressed block using the palette for the block.
+static inline void storeBlockLATC1(const u32bit *palette, u8bit *inBuffer, u8bit *outBuffer)
+{
+    //  Get the code bits for the luminance elements in the block.
+    u64bit luminanceCodes = codesS3TCAlpha(&inBuffer[2]);
 
-            /*  Decode alpha.  */
-            decodedColor[3] = decodeS3TCAlpha(alphacode, alpha0, alpha1);
+#ifdef __SSE2__
+    __m128i block[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
 
-//printf("DXT5 => {%d, %d} decoded color { %f, %f, %f, %f }\n", i, j, decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3]);
+    selectBlockSIMD(palette, 8, luminanceCodes, 3, block);
+    storeBlockSIMD8(block, outBuffer);
+#else
+    //  Store block luminance in Morton order.
+    for(u32bit t = 0; t < 16; t++)
+    {
+        outBuffer[blockTexelOrder[t]] = u8bit(palette[luminanceCodes & 0x07]);
+        luminanceCodes = luminanceCodes >> 3;
+    }
+#endif
+}
 
-            /*  Store block color in Morton order and 32 bit RGBA format.  */
-            ((u32bit *) outBuffer)[GPUMath::morton(2, i, j)] = format(GPU_RGBA8888, decodedColor);
-        }
+//  Decodes a LATC2 or LATC2_SIGNED compressed block using the palettes for the block.
+static inline void storeBlockLATC2(const u32bit *luminancePalette, const u32bit *alphaPalette, u8bit *inBuffer, u8bit *outBuffer)
+{
+    //  Get the code bits for the luminance and alpha elements in the block.
+    u64bit luminanceCodes = codesS3TCAlpha(&inBuffer[2]);
+    u64bit alphaCodes = codesS3TCAlpha(&inBuffer[10]);
+
+#ifdef __SSE2__
+    __m128i block[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+
+    selectBlockSIMD(luminancePalette, 8, luminanceCodes, 3, block);
+    selectBlockSIMD(alphaPalette, 8, alphaCodes, 3, block);
+    storeBlockSIMD16(block, outBuffer);
+#else
+    //  Store block luminance and alpha in Morton order.
+    for(u32bit t = 0; t < 16; t++)
+    {
+        ((u16bit *) outBuffer)[blockTexelOrder[t]] = u16bit(luminancePalette[luminanceCodes & 0x07] | alphaPalette[alphaCodes & 0x07]);
+        luminanceCodes = luminanceCodes >> 3;
+        alphaCodes = alphaCodes >> 3;
     }
+#endif
 }
 
 //  Decode a LATC1 compressed texture.
 void TextureEmulator::decodeBlockLATC1(u8bit *inBuffer, u8bit *outBuffer)
 {
-    f32bit luminance0, luminance1;
-    QuadFloat decodedColor;
-    u64bit luminanceCodes;
+    u32bit palette[8];
 
-    //  Convert first reference luminance from the compressed block.
-    luminance0 = f32bit(inBuffer[0]) * (1.0f / 255.0f);
+    //  Convert the reference luminances from the compressed block.
+    f32bit luminance0 = f32bit(inBuffer[0]) * (1.0f / 255.0f);
+    f32bit luminance1 = f32bit(inBuffer[1]) * (1.0f / 255.0f);
 
-    //  Convert second reference luminance from the compressed block.
-    luminance1 = f32bit(inBuffer[1]) * (1.0f / 255.0f);
+    //  Compute the converted 8-bit LUMINANCE value for each code.
+#ifdef __SSE2__
+    s32bit luminances[8];
 
-    //  Get the code bits for the luminance elements in the block.
-    luminanceCodes = ((u64bit) inBuffer[2]) + (((u64bit) inBuffer[3]) << 8) + (((u64bit) inBuffer[4]) << 16) +
-        (((u64bit) inBuffer[5]) << 24) + (((u64bit) inBuffer[6]) << 32) + (((u64bit) inBuffer[7]) << 40);
+    paletteS3TCAlphaSIMD(luminance0, luminance1, 255.0f, luminances);
 
-    //  Generate the decoded values for all the texels in the block.
-    for(u32bit j = 0; j < 4; j++)
+    for(u32bit code = 0; code < 8; code++)
+        palette[code] = u32bit(luminances[code] & 0xFF);
+#else
+    for(u32bit code = 0; code < 8; code++)
     {
-        for(u32bit i = 0; i < 4; i++)
-        {
-            //  Get the three bit luminance code for the texels in the 4x4 block.
-            u32bit luminanceCode = u32bit(luminanceCodes & 0x07);
-            luminanceCodes = luminanceCodes >> 3;
-
-            //  Decode luminance.
-            decodedColor[0] =
-            decodedColor[1] =
-            decodedColor[2] = decodeS3TCAlpha(luminanceCode, luminance0, luminance1);
-            decodedColor[3] = 1.0f;
-
-//printf("LATC1 => {%d, %d} decoded color { %f, %f, %f, %f }\n", i, j, decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3]);
-
-            //  Store block color in Morton order and 8-bit LUMINANCE format.
-            outBuffer[GPUMath::morton(2, i, j)] = u8bit(format(GPU_LUMINANCE8, decodedColor) & 0x00FF);
-        }
+        f32bit l = decodeS3TCAlpha(code, luminance0, luminance1);
+        palette[code] = format(GPU_LUMINANCE8, QuadFloat(l, l, l, 1.0f)) & 0x00FF;
     }
+#endif
+
+    storeBlockLATC1(palette, inBuffer, outBuffer);
 }
 
 //  Decode a LATC1_SIGNED compressed texture.
 void TextureEmulator::decodeBlockLATC1Signed(u8bit *inBuffer, u8bit *outBuffer)
 {
-    f32bit luminance0, luminance1;
-    QuadFloat decodedColor;
-    u64bit luminanceCodes;
+    u32bit palette[8];
 
-    //  Convert first reference luminance from the compressed block.
-    luminance0 = f32bit(s8bit(inBuffer[0])) * (1.0f / 127.0f);
+    //  Convert the reference luminances from the compressed block.
+    f32bit luminance0 = f32bit(s8bit(inBuffer[0])) * (1.0f / 127.0f);
+    f32bit luminance1 = f32bit(s8bit(inBuffer[1])) * (1.0f / 127.0f);
 
-    //  Convert second reference luminance from the compressed block.
-    luminance1 = f32bit(s8bit(inBuffer[1])) * (1.0f / 127.0f);
+    //  Compute the converted 8-bit LUMINANCE SIGNED value for each code.
+#ifdef __SSE2__
+    s32bit luminances[8];
 
-    //  Get the code bits for the luminance elements in the block.
-    luminanceCodes = ((u64bit) inBuffer[2]) + (((u64bit) inBuffer[3]) << 8) + (((u64bit) inBuffer[4]) << 16) +
-        (((u64bit) inBuffer[5]) << 24) + (((u64bit) inBuffer[6]) << 32) + (((u64bit) inBuffer[7]) << 40);
+    paletteS3TCAlphaSIMD(luminance0, luminance1, 127.0f, luminances);
 
-    //  Generate the decoded values for all the texels in the block.
-    for(u32bit j = 0; j < 4; j++)
+    for(u32bit code = 0; code < 8; code++)
+        palette[code] = u32bit(luminances[code] & 0xFF);
+#else
+    for(u32bit code = 0; code < 8; code++)
     {
-        for(u32bit i = 0; i < 4; i++)
-        {
-            //  Get the three bit luminance code for the texels in the 4x4 block.
-            u32bit luminanceCode = u32bit(luminanceCodes & 0x07);
-            luminanceCodes = luminanceCodes >> 3;
-
-            //  Decode luminance.
-            decodedColor[0] =
-            decodedColor[1] =
-            decodedColor[2] = decodeS3TCAlpha(luminanceCode, luminance0, luminance1);
-            decodedColor[3] = 1.0f;
-
-//printf("LATC1_SIGNED => {%d, %d} decoded color { %f, %f, %f, %f }\n", i, j, decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3]);
-
-            //  Store block color in Morton order and 8-bit LUMINANCE SIGNED format.
-            outBuffer[GPUMath::morton(2, i, j)] = u8bit(format(GPU_LUMINANCE8_SIGNED, decodedColor) & 0x00FF);
-        }
+        f32bit l = decodeS3TCAlpha(code, luminance0, luminance1);
+        palette[code] = format(GPU_LUMINANCE8_SIGNED, QuadFloat(l, l, l, 1.0f)) & 0x00FF;
     }
+#endif
+
+    storeBlockLATC1(palette, inBuffer, outBuffer);
 }
 
 //  Decode a LATC2 compressed texture.
 void TextureEmulator::decodeBlockLATC2(u8bit *inBuffer, u8bit *outBuffer)
 {
-    f32bit luminance0, luminance1;
-    f32bit alpha0, alpha1;
-    QuadFloat decodedColor;
-    u64bit luminanceCodes;
-    u64bit alphaCodes;
-
-    //  Convert first reference luminance from the compressed block.
-    luminance0 = f32bit(inBuffer[0]) * (1.0f / 255.0f);
-
-    //  Convert second reference luminance from the compressed block.
-    luminance1 = f32bit(inBuffer[1]) * (1.0f / 255.0f);
+    u32bit luminancePalette[8];
+    u32bit alphaPalette[8];
 
-    //  Get the code bits for the luminance elements in the block.
-    luminanceCodes = ((u64bit) inBuffer[2]) + (((u64bit) inBuffer[3]) << 8) + (((u64bit) inBuffer[4]) << 16) +
-        (((u64bit) inBuffer[5]) << 24) + (((u64bit) inBuffer[6]) << 32) + (((u64bit) inBuffer[7]) << 40);
-
-    //  Convert first reference alpha from the compressed block.
-    alpha0 = f32bit(inBuffer[8]) * (1.0f / 255.0f);
+    //  Convert the reference luminances and alphas from the compressed block.
+    f32bit luminance0 = f32bit(inBuffer[0]) * (1.0f / 255.0f);
+    f32bit luminance1 = f32bit(inBuffer[1]) * (1.0f / 255.0f);
+    f32bit alpha0 = f32bit(inBuffer[8]) * (1.0f / 255.0f);
+    f32bit alpha1 = f32bit(inBuffer[9]) * (1.0f / 255.0f);
 
-    //  Convert second reference alpha from the compressed block.
-    alpha1 = f32bit(inBuffer[9]) * (1.0f / 255.0f);
+    //  Compute the converted 16-bit LUMINANCE_ALPHA luminance and alpha for each code.
+#ifdef __SSE2__
+    s32bit luminances[8];
+    s32bit alphas[8];
 
-    //  Get the code bits for the luminance elements in the block.
-    alphaCodes = ((u64bit) inBuffer[10]) + (((u64bit) inBuffer[11]) << 8) + (((u64bit) inBuffer[12]) << 16) +
-        (((u64bit) inBuffer[13]) << 24) + (((u64bit) inBuffer[14]) << 32) + (((u64bit) inBuffer[15]) << 40);
+    paletteS3TCAlphaSIMD(luminance0, luminance1, 255.0f, luminances);
+    paletteS3TCAlphaSIMD(alpha0, alpha1, 255.0f, alphas);
 
-    //  Generate the decoded values for all the texels in the block.
-    for(u32bit j = 0; j < 4; j++)
+    for(u32bit code = 0; code < 8; code++)
     {
-        for(u32bit i = 0; i < 4; i++)
-        {
-            //  Get the three bit luminance code for the texels in the 4x4 block.
-            u32bit luminanceCode = u32bit(luminanceCodes & 0x07);
-            luminanceCodes = luminanceCodes >> 3;
-
-            // Get the three bit alpha code for the texels in the 4x4 block.
-            u32bit alphaCode = u32bit(alphaCodes & 0x07);
-            alphaCodes = alphaCodes >> 3;
-            
-            //  Decode luminance and alpha.
-            decodedColor[0] =
-            decodedColor[1] =
-            decodedColor[2] = decodeS3TCAlpha(luminanceCode, luminance0, luminance1);
-            decodedColor[3] = decodeS3TCAlpha(alphaCode, alpha0, alpha1);;
-
-//printf("LATC2 => {%d, %d} decoded color { %f, %f, %f, %f }\n", i, j, decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3]);
-
-            //  Store block color in Morton order and 16-bit LUMINANCE_ALPHA format.
-            ((u16bit *) outBuffer)[GPUMath::morton(2, i, j)] = u16bit(format(GPU_LUMINANCE8_ALPHA8, decodedColor) & 0x0000FFFF);
-        }
+        luminancePalette[code] = u32bit(luminances[code] & 0xFF);
+        alphaPalette[code] = u32bit(alphas[code] & 0xFF) << 8;
     }
+#else
+    for(u32bit code = 0; code < 8; code++)
+    {
+        f32bit l = decodeS3TCAlpha(code, luminance0, luminance1);
+        f32bit a = decodeS3TCAlpha(code, alpha0, alpha1);
+        luminancePalette[code] = format(GPU_LUMINANCE8_ALPHA8, QuadFloat(l, l, l, 0.0f)) & 0x00FF;
+        alphaPalette[code] = format(GPU_LUMINANCE8_ALPHA8, QuadFloat(0.0f, 0.0f, 0.0f, a)) & 0xFF00;
+    }
+#endif
+
+    storeBlockLATC2(luminancePalette, alphaPalette, inBuffer, outBuffer);
 }
 
 //  Decode a LATC2_SIGNED compressed texture.
 void TextureEmulator::decodeBlockLATC2Signed(u8bit *inBuffer, u8bit *outBuffer)
 {
-    f32bit luminance0, luminance1;
-    f32bit alpha0, alpha1;
-    QuadFloat decodedColor;
-    u64bit luminanceCodes;
-    u64bit alphaCodes;
+    u32bit luminancePalette[8];
+    u32bit alphaPalette[8];
 
-    //  Convert first reference luminance from the compressed block.
-    luminance0 = f32bit(s32bit(inBuffer[0])) * (1.0f / 127.0f);
+    //  Convert the reference luminances and alphas from the compressed block.
+    f32bit luminance0 = f32bit(s32bit(inBuffer[0])) * (1.0f / 127.0f);
+    f32bit luminance1 = f32bit(s32bit(inBuffer[1])) * (1.0f / 127.0f);
+    f32bit alpha0 = f32bit(s32bit(inBuffer[8])) * (1.0f / 127.0f);
+    f32bit alpha1 = f32bit(s32bit(inBuffer[9])) * (1.0f / 127.0f);
 
-    //  Convert second reference luminance from the compressed block.
-    luminance1 = f32bit(s32bit(inBuffer[1])) * (1.0f / 127.0f);
-
-    //  Get the code bits for the luminance elements in the block.
-    luminanceCodes = ((u64bit) inBuffer[2]) + (((u64bit) inBuffer[3]) << 8) + (((u64bit) inBuffer[4]) << 16) +
-        (((u64bit) inBuffer[5]) << 24) + (((u64bit) inBuffer[6]) << 32) + (((u64bit) inBuffer[7]) << 40);
+    //  Compute the converted 16-bit LUMINANCE_ALPHA_SIGNED luminance and alpha for each code.
+#ifdef __SSE2__
+    s32bit luminances[8];
+    s32bit alphas[8];
 
-    //  Convert first reference alpha from the compressed block.
-    alpha0 = f32bit(s32bit(inBuffer[8])) * (1.0f / 127.0f);
-
-    //  Convert second reference alpha from the compressed block.
-    alpha1 = f32bit(s32bit(inBuffer[9])) * (1.0f / 127.0f);
-
-    //  Get the code bits for the luminance elements in the block.
-    alphaCodes = ((u64bit) inBuffer[10]) + (((u64bit) inBuffer[11]) << 8) + (((u64bit) inBuffer[12]) << 16) +
-        (((u64bit) inBuffer[13]) << 24) + (((u64bit) inBuffer[14]) << 32) + (((u64bit) inBuffer[15]) << 40);
+    paletteS3TCAlphaSIMD(luminance0, luminance1, 255.0f, luminances);
+    paletteS3TCAlphaSIMD(alpha0, alpha1, 255.0f, alphas);
 
-    //  Generate the decoded values for all the texels in the block.
-    for(u32bit j = 0; j < 4; j++)
+    for(u32bit code = 0; code < 8; code++)
     {
-        for(u32bit i = 0; i < 4; i++)
-        {
-            //  Get the three bit luminance code for the texels in the 4x4 block.
-            u32bit luminanceCode = u32bit(luminanceCodes & 0x07);
-            luminanceCodes = luminanceCodes >> 3;
-
-            // Get the three bit alpha code for the texels in the 4x4 block.
-            u32bit alphaCode = u32bit(alphaCodes & 0x07);
-            alphaCodes = alphaCodes >> 3;
-            
-            //  Decode luminance and alpha.
-            decodedColor[0] =
-            decodedColor[1] =
-            decodedColor[2] = decodeS3TCAlpha(luminanceCode, luminance0, luminance1);
-            decodedColor[3] = decodeS3TCAlpha(alphaCode, alpha0, alpha1);;
-
-//printf("LATC2_SIGNED => {%d, %d} decoded color { %f, %f, %f, %f }\n", i, j, decodedColor[0], decodedColor[1], decodedColor[2], decodedColor[3]);
-
-            //  Store block color in Morton order and 16-bit LUMINANCE_ALPHA_SIGNED format.
-            ((u16bit *) outBuffer)[GPUMath::morton(2, i, j)] = u16bit(format(GPU_LUMINANCE8_ALPHA8_SIGNED, decodedColor) & 0x0000FFFF);
-        }
+        luminancePalette[code] = u32bit(luminances[code] & 0xFF);
+        alphaPalette[code] = u32bit(alphas[code] & 0xFF) << 8;
     }
+#else
+    for(u32bit code = 0; code < 8; code++)
+    {
+        f32bit l = decodeS3TCAlpha(code, luminance0, luminance1);
+        f32bit a = decodeS3TCAlpha(code, alpha0, alpha1);
+        luminancePalette[code] = format(GPU_LUMINANCE8_ALPHA8_SIGNED, QuadFloat(l, l, l, 0.0f)) & 0x00FF;
+        alphaPalette[code] = format(GPU_LUMINANCE8_ALPHA8_SIGNED, QuadFloat(0.0f, 0.0f, 0.0f, a)) & 0xFF00;
+    }
+#endif
+
+    storeBlockLATC2(luminancePalette, alphaPalette, inBuffer, outBuffer);
 }
 
 /*  Decodes and selects the proper alpha value for S3TC alpha encoding.  */
@@ -4658,6 +4971,8 @@ void TextureEmulator::reset()
         textureEnabled[i] = FALSE;
         textureMode[i] = GPU_TEXTURE2D;
         textureWidth[i] = 0;
+        for(u32bit l = 0; l < MAX_TEXTURE_SIZE; l++)
+            textureMipWidthLog2[i][l] = 0;
         textureHeight[i] = 0;
         textureDepth[i] = 0;
         textureWidth2[i] = 0;
@@ -4695,6 +5010,10 @@ void TextureEmulator::reset()
             maxAnisotropy[i] = GPU_MIN(u32bit(1), confMaxAniso);
     
         pixelMapperConfigured[i] = false;
+
+        selectSamplerKernels(i);
+
+        anisoFootprint[i].valid = false;
     }
 
     //  Set default values to vertex attribute and stream registers.
@@ -4736,6 +5055,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
         case GPU_TEXTURE_MODE:
             /*  Write texture mode register.  */
             textureMode[subReg] = data.txMode;
+            selectSamplerKernels(subReg);
 
             break;
 
@@ -4762,6 +5082,10 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
             /*  Write texture width (first mipmap).  */
             textureWidth[subReg] = data.uintVal;
 
+            //  Precompute the log2 of the width of the mipmaps used to compute the texel addresses.
+            for(mipmap = 0; mipmap < MAX_TEXTURE_SIZE; mipmap++)
+                textureMipWidthLog2[subReg][mipmap] = u32bit(GPU_CEIL(GPU_LOG2(GPU_MAX(textureWidth[subReg] >> mipmap, u32bit(1)))));
+
             break;
 
         case GPU_TEXTURE_HEIGHT:
@@ -4811,6 +5135,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
 
             /*  Write texture format register.  */
             textureFormat[subReg] = data.txFormat;
+            selectSamplerKernels(subReg);
 
             //  The pixel mapper requires to be configured in the next access.
             if (textureBlocking[subReg] == GPU_TXBLOCK_FRAMEBUFFER)
@@ -4822,6 +5147,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
 
             /*  Write texture reverse register.  */
             textureReverse[subReg] = data.booleanVal;
+            selectSamplerKernels(subReg);
 
             break;
 
@@ -4829,6 +5155,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
 
             /*  Write texture D3D9 color component read order register.  */
             textD3D9ColorConv[subReg] = data.booleanVal;
+            selectSamplerKernels(subReg);
 
             break;
 
@@ -4913,6 +5240,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
             
             //  Write texture enable comparison register.
             textureEnableComparison[subReg] = data.booleanVal;
+            selectSamplerKernels(subReg);
             
             break;
             
@@ -4927,6 +5255,7 @@ void TextureEmulator::writeRegister(GPURegister reg, u32bit subReg, GPURegData d
         
             //  Write texture sRGB space to linear space conversion.
             textureSRGB[subReg] = data.booleanVal;
+            selectSamplerKernels(subReg);
             
             break;
 
@@ -359,6 +359,23 @@ enum AnisotropyAlgorithm
 class TextureEmulator
 {
 
+public:
+
+    /**
+     *
+     *  Converts the data of a texel in a texture format to four float point components.
+     *
+     */
+    typedef void (*TexelConversionFunction)(const u8bit *data, u64bit address, f32bit *texel);
+
+    /**
+     *
+     *  Filters the texels read from a mipmap level for a fragment.  The texels of the
+     *  fragment are stored as arrays of four float point components.
+     *
+     */
+    typedef void (*BilinearFunction)(const f32bit *texels, u32bit level, f32bit a, f32bit b, f32bit c, f32bit *sample);
+
 private:
 
     //  Parameters.
@@ -422,6 +439,34 @@ private:
     f32bit textureUnitLODBias[MAX_TEXTURES];    /**<  Texture unit lod bias (not texture lod!!).  */
     u32bit maxAnisotropy[MAX_TEXTURES];         /**<  Maximum anisotropy for the texture.  */
 
+    //  Derived from the texture registers.
+    u32bit textureMipWidthLog2[MAX_TEXTURES][MAX_TEXTURE_SIZE]; /**<  Log2 (rounded up) of the width of each mipmap of the texture.  */
+
+    /**
+     *
+     *  Anisotropic footprint computed for a quad.
+     *
+     */
+    struct AnisoFootprint
+    {
+        bool valid;             /**<  The footprint has been computed.  */
+        f32bit derivatives[4];  /**<  Texture coordinate derivatives (dudx, dudy, dvdx, dvdy) of the quad.  */
+        u32bit maxAniso;        /**<  Maximum anisotropy used to compute the footprint.  */
+        u32bit width;           /**<  Texture width used to compute the footprint.  */
+        u32bit height;          /**<  Texture height used to compute the footprint.  */
+        f32bit scale;           /**<  Texture scale for each anisotropic sample.  */
+        u32bit samples;         /**<  Number of anisotropic samples.  */
+        f32bit dsOffset;        /**<  Per anisotropic sample offset for the s coordinate.  */
+        f32bit dtOffset;        /**<  Per anisotropic sample offset for the t coordinate.  */
+    };
+
+    AnisoFootprint anisoFootprint[MAX_TEXTURES];    /**<  Footprint of the last quad with anisotropic filtering for each texture unit.  */
+
+    //  Sampler kernels selected for the current texture unit state.
+    bool specializedKernels;                                /**<  Use the texel conversions specialized for the texture format.  */
+    TexelConversionFunction texelConversion[MAX_TEXTURES];  /**<  Texel conversion specialized for the texture format (NULL if the generic conversion must be used).  */
+    BilinearFunction bilinearFunction[MAX_TEXTURES];        /**<  Bilinear filter for the texture mode.  */
+
     //  Pixel mapper (for framebuffer textures).
     PixelMapper texPixelMapper[MAX_TEXTURES];   /**<  Maps texels/pixels to addresses.  */
     bool pixelMapperConfigured[MAX_TEXTURES];   /**<  Stores if the corresponding pixel mapper has been properly configured.  */
@@ -699,10 +744,8 @@ private:
      *  @param l The mipmap level where the access is performed.
      *  @param filter The filter that is going to be used at the mipmap level
      *  (either GPU_LINEAR or GPU_NEAREST).
-     *  @param currentSample Current anisotropic sample for which to calculate the texture coordinates.
-     *  @param samples Number of total anisotropic samples to take for the texture access.
-     *  @param dsOffset Texture coordinate component s offset in the anisotropy axis direction per anisotropic sample.
-     *  @param dtOffset Texture coordinate component t offset in the anisotropy axis direction per anisotropic sample.
+     *  @param sOffset Texture coordinate component s offset of the current anisotropic sample.
+     *  @param tOffset Texture coordinate component t offset of the current anisotropic sample.
      *  @param s Fragment s texture coordinate for the access.
      *  @param t Fragment t texture coordinate for the access.
      *  @param r Fragment r texture coordinate for the access.
@@ -715,8 +758,8 @@ private:
      *
      */
 
-    void texelCoord(u32bit textUnit, u32bit l, FilterMode filter, u32bit currentSample, u32bit samples,
-        f32bit dsOffset, f32bit dtOffset, f32bit s, f32bit t, f32bit r,
+    void texelCoord(u32bit textUnit, u32bit l, FilterMode filter, f32bit sOffset, f32bit tOffset,
+        f32bit s, f32bit t, f32bit r,
         u32bit &i, u32bit &j, u32bit &k, f32bit &a, f32bit &b, f32bit &c);
 
     /**
@@ -743,10 +786,8 @@ private:
      *  @param textUnit The texture unit being accssed.
      *  @param l The mipmap level being accessed.
      *  @param filter The filter being used at the mipmap level (GPU_LINEAR or GPU_NEAREST).
-     *  @param currentSample Current anisotropic sample for which to calculate the texture coordinates.
-     *  @param samples Number of total anisotropic samples to take for the texture access.
-     *  @param dsOffset Texture coordinate component s offset in the anisotropy axis direction per anisotropic sample.
-     *  @param dtOffset Texture coordinate component t offset in the anisotropy axis direction per anisotropic sample.
+     *  @param sOffset Texture coordinate component s offset of the current anisotropic sample.
+     *  @param tOffset Texture coordinate component t offset of the current anisotropic sample.
      *  @param s Fragment s texture coordinate for the access.
      *  @param t Fragment t texture coordinate for the access.
      *  @param i Reference an integer variable where to store the texel horizontal coordinate.
@@ -756,8 +797,8 @@ private:
      *
      */
 
-    void texelCoord2D(u32bit textUnit, u32bit l, FilterMode filter, u32bit currentSample, u32bit samples,
-        f32bit dsOffset, f32bit dtOffset, f32bit s, f32bit t, u32bit &i, u32bit &j, f32bit &a, f32bit &b);
+    void texelCoord2D(u32bit textUnit, u32bit l, FilterMode filter, f32bit sOffset, f32bit tOffset,
+        f32bit s, f32bit t, u32bit &i, u32bit &j, f32bit &a, f32bit &b);
 
     /**
      *
@@ -812,18 +853,14 @@ private:
 
     /**
      *
-     *  Performs a bilinear filtering at a mipmap level for a fragment in a stamp texture access.
-     *
-     *  @param textAccess The stamp texture access for which a bilinear sample must be calculated.
-     *  @param trilinearAccess The trilinear access for which a bilinear sample must be calculated.
-     *  @param level Which mipmap level (for trilinear) is being sampled.
-     *  @param frag The fragment inside the stamp for which the bilinear sample must be calculated.
+     *  Selects the texel conversion and bilinear filter kernels for the current
+     *  state of a texture unit.
      *
-     *  @return The filtered value.
+     *  @param textUnit The texture unit.
      *
      */
 
-    QuadFloat bilinearFilter(TextureAccess &textAccess, u32bit trilinearAccess, u32bit level, u32bit frag);
+    void selectSamplerKernels(u32bit textUnit);
 
     /**
      *
@@ -1042,6 +1079,8 @@ public:
      *  @param scanHeight Height of a frame buffer scan tile (in pixels).
      *  @param genWidth Width of a frame buffer generation tile (in pixels).
      *  @param genHeight Height of a frame buffer generation tile (in pixels).     
+     *  @param samplerKernels Use the texel conversions specialized for the texture format
+     *  and component order (the generic conversion is always used if disabled).
      *
      *  @return A new texture emulator object.
      *
@@ -1051,7 +1090,7 @@ public:
                     bool forceAniso, u32bit maxAniso, u32bit triPrecision, u32bit brilinearThreshold,
                     u32bit anisoRoundPrecision, u32bit anisoRoundThreshold, bool anisoRatioMultOfTwo,
                     u32bit overScanWidth, u32bit overScanHeight, u32bit scanWidth, u32bit scanHeight,
-                    u32bit genWidth, u32bit genHeight);
+                    u32bit genWidth, u32bit genHeight, bool samplerKernels);
 
     /**
      *
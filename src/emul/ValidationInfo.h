@@ -87,6 +87,10 @@ typedef std::map<VertexID, ShadedVertexInfo> ShadedVertexMap;
  *  Defines a fragment identifier and the operations required to
  *  use the class as a map key.
  *
+ *  The triangle identifier is the source primitive, the triangles
+ *  generated by clipping a triangle share its identifier.  A quad
+ *  covered by two of those triangles keeps only the first update.
+ *
  */
  
 struct FragmentID
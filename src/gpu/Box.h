@@ -87,6 +87,21 @@ private:
     static u64bit startCycle;
     static u64bit dumpCycles;
 
+    /// Registers a typed signal in the binder with the full name prefix::name
+    template <class T>
+    TypedSignal<T>* newTypedSignal( const char* name, u32bit bw, u32bit latency, const char* prefix, flag type )
+    {
+        char fullName[255];
+
+        if (prefix == NULL)
+            sprintf(fullName, "%s", name);
+        else
+            sprintf(fullName, "%s::%s", prefix, name);
+
+        return static_cast<TypedSignal<T>*>( binder.registerTypedSignal( fullName, type, bw, latency,
+            TypedSignal<T>::typeName(), &TypedSignal<T>::newSignal ) );
+    }
+
 protected:
 
     bool debugMode;     /**<  Flag used to enable or disable debug messages.  */
@@ -164,6 +179,42 @@ protected:
      */
     Signal* newOutputSignal( const char* name, u32bit bw, const char* prefix = 0);
 
+    /**
+     * Registers a new input TypedSignal
+     *
+     * @param name signal's name ( if no prefix is especified )
+     * @param bw bandwidth for this signal
+     * @param latency latency for this signal
+     * @param prefix if specified the the signal's name is prefix/name
+     *
+     * - Same rules than newInputSignal.  The output binding must use the same type T.
+     *
+     * @return a pointer to the typed signal
+     */
+    template <class T>
+    TypedSignal<T>* newInputTypedSignal( const char* name, u32bit bw, u32bit latency = 0, const char* prefix = 0 )
+    {
+        return newTypedSignal<T>( name, bw, latency, prefix, SignalBinder::BIND_MODE_READ );
+    }
+
+    /**
+     * Registers a new output TypedSignal
+     *
+     * @param name signal's name ( if no prefix is especified )
+     * @param bw bandwidth for this signal
+     * @param latency latency for this signal
+     * @param prefix if specified the the signal's name is prefix/name
+     *
+     * - Same rules than newOutputSignal.  The input binding must use the same type T.
+     *
+     * @return a pointer to the typed signal
+     */
+    template <class T>
+    TypedSignal<T>* newOutputTypedSignal( const char* name, u32bit bw, u32bit latency, const char* prefix = 0 )
+    {
+        return newTypedSignal<T>( name, bw, latency, prefix, SignalBinder::BIND_MODE_WRITE );
+    }
+
     /**
      * Gets a reference to StatisticsManager
      */
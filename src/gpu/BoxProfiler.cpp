@@ -0,0 +1,263 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Box Profiler implementation file.
+ *
+ */
+
+/**
+ *
+ *  @file BoxProfiler.cpp
+ *
+ *  Implements the BoxProfiler class.
+ *
+ */
+
+#include "BoxProfiler.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+
+namespace gpu3d
+{
+
+//  Orders the entries by accumulated time.
+struct CompareEntryTicks
+{
+    const vector<u64bit> &ticks;
+
+    CompareEntryTicks(const vector<u64bit> &t) : ticks(t) {}
+
+    bool operator()(u32bit a, u32bit b) const
+    {
+        return ticks[a] > ticks[b];
+    }
+};
+
+BoxProfiler::BoxProfiler() :
+
+    enabled(false), ticksPerSecond(0.0), enableTicks(0), profiledTicks(0), frameStartTicks(0), batchStartTicks(0)
+{
+}
+
+BoxProfiler::~BoxProfiler()
+{
+    if (frameFile.is_open())
+        frameFile.close();
+    if (batchFile.is_open())
+        batchFile.close();
+}
+
+void BoxProfiler::calibrate()
+{
+    //  Count the ticks elapsed during 20 ms of wall clock time.
+    f64bit startTime = getWallClockTime();
+    u64bit startTicks = readTicks();
+    f64bit time;
+
+    do
+    {
+        time = getWallClockTime();
+    }
+    while ((time - startTime) < 0.02);
+
+    ticksPerSecond = f64bit(readTicks() - startTicks) / (time - startTime);
+}
+
+const char *BoxProfiler::getDomainName(u32bit domain)
+{
+    static const char *names[MAX_DOMAINS] = {"GPU", "Shader", "Memory"};
+
+    return (domain < MAX_DOMAINS) ? names[domain] : "Unknown";
+}
+
+u32bit BoxProfiler::addEntry(const char *name, u32bit domain)
+{
+    GPU_ASSERT(
+        if (domain >= MAX_DOMAINS)
+            panic("BoxProfiler", "addEntry", "Undefined clock domain.");
+    )
+
+    Entry entry;
+
+    entry.name = name;
+    entry.domain = domain;
+    entry.ticks = 0;
+    entry.calls = 0;
+    entry.frameTicks = 0;
+    entry.batchTicks = 0;
+
+    entries.push_back(entry);
+
+    return u32bit(entries.size() - 1);
+}
+
+void BoxProfiler::setEnabled(bool enable)
+{
+    if (enable == enabled)
+        return;
+
+    if (enable)
+    {
+        if (ticksPerSecond == 0.0)
+            calibrate();
+
+        enableTicks = readTicks();
+        frameStartTicks = enableTicks;
+        batchStartTicks = enableTicks;
+    }
+    else
+        profiledTicks += readTicks() - enableTicks;
+
+    enabled = enable;
+}
+
+u64bit BoxProfiler::getProfiledTicks() const
+{
+    return profiledTicks + (enabled ? (readTicks() - enableTicks) : 0);
+}
+
+void BoxProfiler::writeRow(ofstream &file, const char *filename, const char *key, u32bit number, bool frameRow, u64bit elapsed)
+{
+    char buffer[64];
+
+    //  Create the file and write the column names with the first row.
+    if (!file.is_open())
+    {
+        file.open(filename, ios::out);
+
+        if (!file.is_open())
+            panic("BoxProfiler", "writeRow", "Error opening box profile file.");
+
+        file << key;
+        for(u32bit e = 0; e < entries.size(); e++)
+        {
+            file << ';' << entries[e].name;
+            if (entries[e].domain != 0)
+                file << '(' << getDomainName(entries[e].domain) << ')';
+        }
+        file << ";Other;Total" << endl;
+    }
+
+    //  Write the time in milliseconds.
+    f64bit msPerTick = 1000.0 / ticksPerSecond;
+    u64bit boxTicks = 0;
+
+    file << number;
+    for(u32bit e = 0; e < entries.size(); e++)
+    {
+        u64bit &ticks = frameRow ? entries[e].frameTicks : entries[e].batchTicks;
+
+        sprintf(buffer, ";%.3f", f64bit(ticks) * msPerTick);
+        file << buffer;
+
+        boxTicks += ticks;
+        ticks = 0;
+    }
+
+    sprintf(buffer, ";%.3f;%.3f", f64bit((elapsed > boxTicks) ? (elapsed - boxTicks) : 0) * msPerTick, f64bit(elapsed) * msPerTick);
+    file << buffer << endl;
+}
+
+void BoxProfiler::endBatch(u32bit batch)
+{
+    if (!enabled)
+        return;
+
+    u64bit ticks = readTicks();
+    writeRow(batchFile, "BoxProfile.batch.csv", "Batch", batch, false, ticks - batchStartTicks);
+    batchStartTicks = ticks;
+}
+
+void BoxProfiler::endFrame(u32bit frame)
+{
+    if (!enabled)
+        return;
+
+    u64bit ticks = readTicks();
+    writeRow(frameFile, "BoxProfile.frame.csv", "Frame", frame, true, ticks - frameStartTicks);
+    frameStartTicks = ticks;
+}
+
+void BoxProfiler::reset()
+{
+    for(u32bit e = 0; e < entries.size(); e++)
+    {
+        entries[e].ticks = 0;
+        entries[e].calls = 0;
+        entries[e].frameTicks = 0;
+        entries[e].batchTicks = 0;
+    }
+
+    profiledTicks = 0;
+    enableTicks = readTicks();
+    frameStartTicks = enableTicks;
+    batchStartTicks = enableTicks;
+}
+
+void BoxProfiler::report(ostream &os)
+{
+    char buffer[256];
+
+    if (ticksPerSecond == 0.0)
+    {
+        os << "Box profile => No profile data." << endl;
+        return;
+    }
+
+    u64bit totalTicks = getProfiledTicks();
+    u64bit boxTicks = 0;
+    u64bit domainTicks[MAX_DOMAINS] = {0, 0, 0};
+    vector<u64bit> ticks(entries.size());
+    vector<u32bit> order(entries.size());
+
+    for(u32bit e = 0; e < entries.size(); e++)
+    {
+        ticks[e] = entries[e].ticks;
+        order[e] = e;
+        boxTicks += ticks[e];
+        domainTicks[entries[e].domain] += ticks[e];
+    }
+
+    //  Report the boxes that took more time first.
+    stable_sort(order.begin(), order.end(), CompareEntryTicks(ticks));
+
+    f64bit percent = (totalTicks == 0) ? 0.0 : 100.0 / f64bit(totalTicks);
+    u64bit otherTicks = (totalTicks > boxTicks) ? (totalTicks - boxTicks) : 0;
+
+    sprintf(buffer, "Box profile => Profiled = %.3f s | Boxes = %.3f s | Other = %.3f s (%.2f %%)",
+        f64bit(totalTicks) / ticksPerSecond, f64bit(boxTicks) / ticksPerSecond, f64bit(otherTicks) / ticksPerSecond,
+        f64bit(otherTicks) * percent);
+    os << buffer << endl;
+
+    for(u32bit d = 0; d < MAX_DOMAINS; d++)
+    {
+        if (domainTicks[d] == 0)
+            continue;
+
+        sprintf(buffer, "Box profile => Domain %-6s %10.3f s %6.2f %%", getDomainName(d),
+            f64bit(domainTicks[d]) / ticksPerSecond, f64bit(domainTicks[d]) * percent);
+        os << buffer << endl;
+    }
+
+    for(u32bit i = 0; i < order.size(); i++)
+    {
+        const Entry &entry = entries[order[i]];
+
+        sprintf(buffer, "Box profile => Box %-24s %-6s %10.3f s %6.2f %% %10.1f ns/clock", entry.name.c_str(),
+            getDomainName(entry.domain), f64bit(entry.ticks) / ticksPerSecond, f64bit(entry.ticks) * percent,
+            (entry.calls == 0) ? 0.0 : 1E9 * f64bit(entry.ticks) / (ticksPerSecond * f64bit(entry.calls)));
+        os << buffer << endl;
+    }
+}
+
+} // namespace gpu3d
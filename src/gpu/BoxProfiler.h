@@ -0,0 +1,249 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Box Profiler definition file.
+ *
+ */
+
+/**
+ *
+ *  @file BoxProfiler.h
+ *
+ *  Defines the BoxProfiler class that measures the host time spent simulating
+ *  each box of the simulated GPU.
+ *
+ */
+
+#ifndef _BOXPROFILER_
+    #define _BOXPROFILER_
+
+#include "GPUTypes.h"
+#include "support.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <ostream>
+
+#ifdef WIN32
+    #include <intrin.h>
+#endif
+
+namespace gpu3d
+{
+
+/**
+ *
+ *  Box Profiler class.
+ *
+ *  Accumulates the host time spent in the clock function of each box.  An entry is
+ *  defined for each box and clock domain in which the box is clocked.  The simulation
+ *  loop reads the host cycle counter before and after clocking each box and adds the
+ *  difference to the entry of the box.
+ *
+ *  The accumulated time is reported per box, per clock domain and as the time spent
+ *  outside the boxes (statistics, end of batch and frame processing, etc).  When enabled
+ *  the time spent by each box in each frame and batch is written into the
+ *  BoxProfile.frame.csv and BoxProfile.batch.csv files.
+ *
+ *  The profiler can be enabled and disabled at any time.  When disabled the simulation
+ *  loop doesn't read the cycle counter.
+ *
+ */
+class BoxProfiler
+{
+private:
+
+    static const u32bit MAX_DOMAINS = 3;    /**<  Number of clock domains (see GPUClockDomain).  */
+
+    /**
+     *  Profiled box and clock domain.
+     */
+    struct Entry
+    {
+        std::string name;   /**<  Name of the box.  */
+        u32bit domain;      /**<  Clock domain.  */
+        u64bit ticks;       /**<  Accumulated ticks.  */
+        u64bit calls;       /**<  Number of calls to the box clock function.  */
+        u64bit frameTicks;  /**<  Ticks accumulated in the current frame.  */
+        u64bit batchTicks;  /**<  Ticks accumulated in the current batch.  */
+    };
+
+    std::vector<Entry> entries;     /**<  Profiled boxes.  */
+
+    bool enabled;                   /**<  Profiling is enabled.  */
+    f64bit ticksPerSecond;          /**<  Frequency of the tick counter.  */
+    u64bit enableTicks;             /**<  Tick counter when the profiler was enabled.  */
+    u64bit profiledTicks;           /**<  Ticks elapsed while enabled before the last enable.  */
+    u64bit frameStartTicks;         /**<  Tick counter at the start of the current frame.  */
+    u64bit batchStartTicks;         /**<  Tick counter at the start of the current batch.  */
+
+    std::ofstream frameFile;        /**<  Per frame profile file.  */
+    std::ofstream batchFile;        /**<  Per batch profile file.  */
+
+    /**
+     *  Measures the frequency of the tick counter.
+     */
+    void calibrate();
+
+    /**
+     *  Returns the ticks elapsed while the profiler was enabled.
+     */
+    u64bit getProfiledTicks() const;
+
+    /**
+     *  Writes a per frame or batch row and resets the per frame or batch ticks.
+     */
+    void writeRow(std::ofstream &file, const char *filename, const char *key, u32bit number, bool frameRow, u64bit elapsed);
+
+    /**
+     *  Returns the name of a clock domain.
+     */
+    static const char *getDomainName(u32bit domain);
+
+public:
+
+    /**
+     *
+     *  Box Profiler constructor.
+     *
+     */
+    BoxProfiler();
+
+    /**
+     *
+     *  Box Profiler destructor.
+     *
+     */
+    ~BoxProfiler();
+
+    /**
+     *
+     *  Reads the host tick counter.
+     *
+     *  @return The current value of the host tick counter.
+     *
+     */
+    static inline u64bit readTicks()
+    {
+#if defined(WIN32)
+        return __rdtsc();
+#elif defined(__i386__) || defined(__x86_64__)
+        u32bit lo, hi;
+        __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+        return (u64bit(hi) << 32) | u64bit(lo);
+#else
+        return u64bit(getWallClockTime() * 1E6);
+#endif
+    }
+
+    /**
+     *
+     *  Adds an entry for a box and clock domain.
+     *
+     *  @param name Name of the box.
+     *  @param domain Clock domain in which the box is clocked.
+     *
+     *  @return The identifier of the entry.
+     *
+     */
+    u32bit addEntry(const char *name, u32bit domain);
+
+    /**
+     *
+     *  Enables or disables profiling.
+     *
+     *  @param enable Enable profiling.
+     *
+     */
+    void setEnabled(bool enable);
+
+    /**
+     *
+     *  Returns if profiling is enabled.
+     *
+     */
+    inline bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    /**
+     *
+     *  Adds ticks to an entry.
+     *
+     *  @param entry Identifier of the entry.
+     *  @param ticks Ticks spent in the clock function of the box.
+     *
+     */
+    inline void add(u32bit entry, u64bit ticks)
+    {
+        Entry &e = entries[entry];
+        e.ticks += ticks;
+        e.frameTicks += ticks;
+        e.batchTicks += ticks;
+        e.calls++;
+    }
+
+    /**
+     *
+     *  Adds the ticks elapsed since a tick counter sample to an entry.
+     *
+     *  @param entry Identifier of the entry.
+     *  @param startTicks Tick counter sampled before calling the clock function of the box.
+     *
+     *  @return The current value of the tick counter, used as start for the next box.
+     *
+     */
+    inline u64bit sample(u32bit entry, u64bit startTicks)
+    {
+        u64bit ticks = readTicks();
+        add(entry, ticks - startTicks);
+        return ticks;
+    }
+
+    /**
+     *
+     *  Signals the end of a batch.
+     *
+     *  @param batch Number of the batch.
+     *
+     */
+    void endBatch(u32bit batch);
+
+    /**
+     *
+     *  Signals the end of a frame.
+     *
+     *  @param frame Number of the frame.
+     *
+     */
+    void endFrame(u32bit frame);
+
+    /**
+     *
+     *  Clears the accumulated times.
+     *
+     */
+    void reset();
+
+    /**
+     *
+     *  Prints the accumulated time per box, per clock domain and outside the boxes.
+     *
+     *  @param os Output stream.
+     *
+     */
+    void report(std::ostream &os);
+};
+
+} // namespace gpu3d
+
+#endif  // _BOXPROFILER_
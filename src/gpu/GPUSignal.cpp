@@ -703,8 +703,6 @@ void Signal::destroy()
 {
     u32bit i;
 
-    delete[] name;
-
     /*for ( i = 0; i < maxLatency; i++ )
         delete[] data[i];
 
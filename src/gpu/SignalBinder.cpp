@@ -190,12 +190,77 @@ Signal* SignalBinder::getSignal( const char* name ) const
     return ( pos < 0 ? 0 : signals[pos] );
 }
 
+TypedSignalBase* SignalBinder::registerTypedSignal( const char* name, flag type, u32bit bw, u32bit latency,
+    const char* typeName, TypedSignalBase* (*newSignal)( const char*, u32bit, u32bit ) )
+{
+    char buff[256];
+    u32bit pos;
+
+    GPU_DEBUG(
+        printf("SignalBinder => Registering typed signal %s Bw %d Lat %d as %s\n",
+            name, bw, latency, (type == BIND_MODE_READ)?"input":"output");
+    )
+
+    /*  Search the signal in the register.  */
+    for ( pos = 0; pos < typedSignals.size(); pos++ )
+        if ( strcmp( name, typedSignals[pos]->getName() ) == 0 )
+            break;
+
+    /*  Check if it is a new signal.  */
+    if ( pos == typedSignals.size() )
+    {
+        typedSignals.push_back( newSignal( name, bw, latency ) );
+        typedBindingState.push_back( ( type == BIND_MODE_READ ) ? BIND_MODE_READ : BIND_MODE_WRITE );
+
+        return typedSignals[pos];
+    }
+
+    TypedSignalBase* signal = typedSignals[pos];
+
+    if ( typedBindingState[pos] == BIND_MODE_RW || type == typedBindingState[pos] )
+    {
+        sprintf(buff, "Not allowed another registration for typed signal: %s", name);
+        panic("SignalBinder", "registerTypedSignal", buff);
+    }
+
+    if ( strcmp( typeName, signal->getTypeName() ) != 0 )
+    {
+        sprintf(buff, "No matching between the types of the typed signal bindings.  Signal: %s", name);
+        panic("SignalBinder", "registerTypedSignal", buff);
+    }
+
+    // Bandwidth and latency are defined by the first binding that specifies them, later definitions must be equal.
+    if ( ( signal->isBandwidthDefined() && bw != 0 && signal->getBandwidth() != bw ) ||
+         ( signal->isLatencyDefined() && latency != 0 && signal->getLatency() != latency ) )
+    {
+        sprintf(buff, "No matching between actual and previous bandwidth or latency.  Signal: %s", name);
+        panic("SignalBinder", "registerTypedSignal", buff);
+    }
+
+    u32bit newBw = signal->isBandwidthDefined() ? signal->getBandwidth() : bw;
+    u32bit newLatency = signal->isLatencyDefined() ? signal->getLatency() : latency;
+
+    if ( newBw == 0 || newLatency == 0 )
+        panic("SignalBinder", "registerTypedSignal", "Bandwidth and latency must be defined.");
+
+    if ( newBw != signal->getBandwidth() || newLatency != signal->getLatency() )
+        signal->setParameters( newBw, newLatency );
+
+    typedBindingState[pos] = BIND_MODE_RW;
+
+    return signal;
+}
+
 bool SignalBinder::checkSignalBindings() const
 {
     for ( u32bit i = 0; i < elements; i++ ) {
         if ( bindingState[i] != BIND_MODE_RW )
             return false;
     }
+    for ( u32bit i = 0; i < typedBindingState.size(); i++ ) {
+        if ( typedBindingState[i] != BIND_MODE_RW )
+            return false;
+    }
     return true;
 }
 
@@ -228,6 +293,13 @@ void SignalBinder::dump(bool showOnlyNotBoundSignals) const
             cout << "   LAT: " << signals[i]->getLatency() << endl;
         }
     }
+    for ( u32bit i = 0; i < typedSignals.size(); i++ ) {
+        if ( typedBindingState[i] != BIND_MODE_RW || !showOnlyNotBoundSignals )
+            cout << typedSignals[i]->getName() << "   Type: " << typedSignals[i]->getTypeName()
+                 << "   State: " << ( typedBindingState[i] == BIND_MODE_RW ? "RW" : ( typedBindingState[i] == BIND_MODE_READ ? "R" : "W" ) )
+                 << " binding   BW: " << typedSignals[i]->getBandwidth()
+                 << "   LAT: " << typedSignals[i]->getLatency() << endl;
+    }
     cout << "-------------------" << endl;
 }
 
@@ -262,6 +334,14 @@ void SignalBinder::initSignalTrace(ostream *trFile)
         (*traceFile) << lineBuffer;
     }
 
+    /*  Typed signals use the identifiers after the signals.  */
+    for(i = 0; i < typedSignals.size(); i++)
+    {
+        sprintf(lineBuffer,"%s\t\t\t%d\t\t%d\t\t%d\n", typedSignals[i]->getName(), elements + i,
+            typedSignals[i]->getBandwidth(), typedSignals[i]->getLatency());
+        (*traceFile) << lineBuffer;
+    }
+
     (*traceFile) << endl << endl;
     
 //    printf("\n\n");
@@ -307,4 +387,14 @@ void SignalBinder::dumpSignalTrace(u64bit cycle)
         /*  Dump the objects in the signal for that cycle.  */
         signals[i]->traceSignal(traceFile, cycle);
     }
+
+    /*  Typed signals carry no dynamic objects, only dump an empty object per value.  */
+    for (i = 0; i < typedSignals.size(); i++)
+    {
+        sprintf(bufferLine, "S %d:\n", elements + i);
+        (*traceFile) << bufferLine;
+
+        for (u32bit v = typedSignals[i]->getValues(cycle); v > 0; v--)
+            (*traceFile) << "\t0;0" << endl;
+    }
 }
@@ -23,8 +23,10 @@
 
 #include "GPUTypes.h"
 #include "GPUSignal.h"
+#include "TypedSignal.h"
 #include <cstdio>
 #include <ostream>
+#include <vector>
 
 namespace gpu3d
 {
@@ -57,6 +59,9 @@ private:
 
     std::ostream *traceFile;    ///< Trace file handle.
 
+    std::vector<TypedSignalBase*> typedSignals;   ///< Typed signals registered
+    std::vector<flag> typedBindingState;          ///< Binding control for the typed signals
+
     /// Aux method for finding positions in the binder
     s32bit find( const char* name ) const;
 
@@ -109,6 +114,21 @@ public:
      */
     Signal* getSignal( const char* name ) const;
 
+    /**
+     * Registers a name for a TypedSignal ( same rules than registerSignal )
+     *
+     * @param name Signal's name ( must be unique )
+     * @param type kind of binding, possible values are { BIND_MODE_READ, BIND_MODE_WRITE )
+     * @param bw bandwidth for this signal ( it can be left unspecified )
+     * @param latency latency for this signal ( it can be left unspecified )
+     * @param typeName Name of the type of the values carried by the signal ( both bindings must match )
+     * @param newSignal Function used to create the typed signal if it did not exist
+     *
+     * @return A pointer to the typed signal with name 'name'
+     */
+    TypedSignalBase* registerTypedSignal( const char* name, flag type, u32bit bw, u32bit latency,
+        const char* typeName, TypedSignalBase* (*newSignal)( const char*, u32bit, u32bit ) );
+
     /**
      * Obtains maximum capacity allowed within binder without 'growing'
      *
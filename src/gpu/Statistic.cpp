@@ -13,6 +13,7 @@
 
 #include "Statistic.h"
 #include <iostream>
+#include <cmath>
 
 using namespace std;
 using namespace gpu3d;
@@ -20,6 +21,41 @@ using namespace gpu3d::GPUStatistics;
 
 bool Statistic::disabled = false;
 
+CounterRegistry Statistic::counters;
+
+CounterRegistry::CounterRegistry()
+{
+    for(int f = 0; f < MAX_FREQS; f++)
+        resets[f] = 0;
+}
+
+u32bit CounterRegistry::add()
+{
+    u32bit handle = u32bit(total.size());
+
+    total.push_back(0);
+    count.push_back(0);
+
+    for(int f = 0; f < MAX_FREQS; f++)
+    {
+        totalSnapshot[f].push_back(0);
+        countSnapshot[f].push_back(0);
+    }
+
+    return handle;
+}
+
+void CounterRegistry::reset(int f)
+{
+    //  Array copies, the snapshot vectors keep their storage.
+    totalSnapshot[f] = total;
+    countSnapshot[f] = count;
+    resets[f]++;
+
+    for(u32bit i = 0; i < gauges.size(); i++)
+        gauges[i]->clearGauge(f);
+}
+
 void Statistic::enable()
 {
     disabled = false;
@@ -36,7 +72,24 @@ bool Statistic::isEnabled()
 }
 
 
+void Statistic::reset(int f)
+{
+    counters.reset(f);
+}
+
 Statistic::Statistic(string name) : name(name), owner(string("")), freq(0)
+{
+    handle = counters.add();
+}
+
+Statistic& Statistic::clear(int f)
+{
+    counters.totalSnapshot[f][handle] = counters.total[handle];
+    counters.countSnapshot[f][handle] = counters.count[handle];
+    return *this;
+}
+
+void Statistic::clearGauge(int f)
 {
 }
 
@@ -46,66 +99,154 @@ Statistic::~Statistic()
 
 
 
-Statistic& Statistic::operator++()
+string Statistic::getName() const
 {
-    if ( disabled )
-        return *this;
+    return name;
+}
 
-    inc(1);
-    return *this;
+void Statistic::setName(string name)
+{
+    this->name = name;
 }
 
-Statistic& Statistic::operator++(int)
+string Statistic::getOwner() const
 {
-    if ( disabled )
-        return *this;
+    return owner;
+}
 
-    inc(1);
-    return *this;
+
+void Statistic::setOwner(string owner)
+{
+    this->owner = owner;
+}
+
+void Statistic::setCurrentFreq(int f)
+{
+    freq = f;
 }
 
+HistogramStatistic::HistogramStatistic(string name) : Statistic(name), counts(BUCKETS, 0)
+{
+    for(int f = 0; f < MAX_FREQS; f++)
+    {
+        snapshot[f].assign(BUCKETS, 0);
+        maxValue[f] = 0;
+        seenReset[f] = counters.resets[f];
+    }
+}
 
-Statistic& Statistic::operator--()
+u32bit HistogramStatistic::bucketMax(u32bit b)
 {
-    if ( disabled )
-        return *this;
+    if ( b < 2 * SUB_BUCKETS )
+        return b;
 
-    inc(-1);
-    return *this;
+    u32bit shift = (b / SUB_BUCKETS) - 1;
+    u32bit m = b - shift * SUB_BUCKETS;
+
+    return u32bit(((u64bit(m) + 1) << shift) - 1);
 }
 
-Statistic& Statistic::operator--(int)
+u64bit HistogramStatistic::samples(int f) const
 {
-    if ( disabled )
-        return *this;
+    if ( seenReset[f] != counters.resets[f] )
+        return 0;
+
+    return counterCount(f);
+}
+
+u32bit HistogramStatistic::percentile(int f, f64bit p) const
+{
+    u64bit n = samples(f);
+
+    if ( n == 0 )
+        return 0;
+
+    //  Rank of the value in the frequency, at least the first value.
+    u64bit rank = u64bit(ceil(f64bit(n) * p / 100.0));
+    if ( rank == 0 )
+        rank = 1;
 
-    inc(-1);
+    if ( rank >= n )
+        return maxValue[f];
+
+    u64bit accum = 0;
+    for ( u32bit b = 0; b < BUCKETS; b++ )
+    {
+        accum += counts[b] - snapshot[f][b];
+        if ( accum >= rank )
+            return (bucketMax(b) < maxValue[f]) ? bucketMax(b) : maxValue[f];
+    }
+
+    return maxValue[f];
+}
+
+Statistic& HistogramStatistic::clear(int f)
+{
+    Statistic::clear(f);
+    snapshot[f] = counts;
+    maxValue[f] = 0;
+    seenReset[f] = counters.resets[f];
     return *this;
 }
 
+string HistogramStatistic::getString() const
+{
+    return string("HISTOGRAM_STATISTIC");
+}
 
-string Statistic::getName() const
+bool HistogramStatistic::isZero(int f) const
 {
-    return name;
+    return (samples(f) == 0);
 }
 
-void Statistic::setName(string name)
+void HistogramStatistic::print(ostream& os) const
 {
-    this->name = name;
+    u64bit n = samples(freq);
+
+    if (n == 0)
+        os << 0;
+    else
+        os << ((f32bit) counterValue(freq))/((f32bit) n);
 }
 
-string Statistic::getOwner() const
+Statistic::ValueType HistogramStatistic::getValueType() const
 {
-    return owner;
+    return UNSIGNED_VALUE;
 }
 
+u64bit HistogramStatistic::getRawValue(int f, u64bit& samples) const
+{
+    samples = this->samples(f);
+    return (samples == 0) ? 0 : u64bit(counterValue(f));
+}
 
-void Statistic::setOwner(string owner)
+HistogramPercentile::HistogramPercentile(string name, const HistogramStatistic* histogram, f64bit p) :
+Statistic(name), histogram(histogram), p(p)
 {
-    this->owner = owner;
 }
 
-void Statistic::setCurrentFreq(int f)
+string HistogramPercentile::getString() const
 {
-    freq = f;
+    return string("HISTOGRAM_PERCENTILE");
+}
+
+bool HistogramPercentile::isZero(int f) const
+{
+    return (histogram->percentile(f, p) == 0);
+}
+
+void HistogramPercentile::print(ostream& os) const
+{
+    os << histogram->percentile(freq, p);
+}
+
+Statistic::ValueType HistogramPercentile::getValueType() const
+{
+    return UNSIGNED_VALUE;
+}
+
+u64bit HistogramPercentile::getRawValue(int f, u64bit& samples) const
+{
+    samples = 0;
+    return histogram->percentile(f, p);
 }
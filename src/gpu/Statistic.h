@@ -16,6 +16,9 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+#include <limits>
+#include <cstring>
 #include "GPUTypes.h"
 
 namespace gpu3d
@@ -26,6 +29,34 @@ namespace GPUStatistics
 
 static const int MAX_FREQS = 3;
 
+class Statistic;
+
+/*
+ * Flat storage for the counters of all the statistics.  Counters are stored in contiguous
+ * arrays indexed by the statistic handle.  The value of a counter for a frequency (cycles,
+ * frame, batch) is the difference between the counter and the snapshot of the counters
+ * taken when the frequency was last reset.
+ */
+class CounterRegistry
+{
+public:
+
+    std::vector<s64bit> total;                  /* accumulated value */
+    std::vector<u64bit> count;                  /* accumulated samples (incavg) */
+    std::vector<s64bit> totalSnapshot[MAX_FREQS];
+    std::vector<u64bit> countSnapshot[MAX_FREQS];
+    u32bit resets[MAX_FREQS];                   /* number of resets of each frequency */
+    std::vector<Statistic*> gauges;             /* statistics updated with max/min */
+
+    CounterRegistry();
+
+    /* adds a new counter and returns its handle */
+    u32bit add();
+
+    /* takes the snapshot of all the counters for a frequency */
+    void reset(int f);
+};
+
 class Statistic
 {
 private:
@@ -37,6 +68,19 @@ protected:
 
     static bool disabled;
     int freq;
+    u32bit handle;                  /* index of the statistic counter in the registry */
+
+    static CounterRegistry counters;
+
+    s64bit counterValue(int f) const
+    {
+        return counters.total[handle] - counters.totalSnapshot[f][handle];
+    }
+
+    u64bit counterCount(int f) const
+    {
+        return counters.count[handle] - counters.countSnapshot[f][handle];
+    }
 
 public:
 
@@ -44,14 +88,34 @@ public:
     static void disable();
     static bool isEnabled();
 
+    /*
+     * Resets the counters of all the statistics for a frequency.  Every statistic is created
+     * and owned by the StatisticsManager singleton, so this is the same set of statistics the
+     * manager cleared one by one.  Use clear to reset a single statistic.
+     */
+    static void reset(int f);
+
     /* must be called in subclass constructor */
     Statistic(std::string name);
 
-    /* must be implemented in subclass */
-    virtual Statistic& inc(int times=1)=0;
+    Statistic& inc(int times=1)
+    {
+        if ( !disabled )
+            counters.total[handle] += times;
+        return *this;
+    }
 
-    /* must be implemented in subclass */
-    virtual Statistic& clear(int f=0)=0;
+    Statistic& incavg(int times=1)
+    {
+        if ( !disabled )
+        {
+            counters.total[handle] += times;
+            counters.count[handle]++;
+        }
+        return *this;
+    }
+
+    virtual Statistic& clear(int f=0);
 
     /*
      * Must be implemented in subclass, it should return a string
@@ -61,19 +125,15 @@ public:
 
     virtual bool isZero(int f=0) const=0;
 
-    Statistic& operator++();
-    Statistic& operator++(int);
-    Statistic& operator--();
-    Statistic& operator--(int);
-
-    virtual Statistic& incavg(int times=1)=0;
+    Statistic& operator++() { return inc(1); }
+    Statistic& operator++(int) { return inc(1); }
+    Statistic& operator--() { return inc(-1); }
+    Statistic& operator--(int) { return inc(-1); }
 
     std::string getName() const;
-
     void setName(std::string str);
 
     std::string getOwner() const;
-
     void setOwner(std::string owner);
 
     void setCurrentFreq(int i);
@@ -87,119 +147,269 @@ public:
         return os;
     }
 
-    virtual ~Statistic() = 0;
-
+    /* clears the max/min value for a frequency, only called for the registered gauges */
+    virtual void clearGauge(int f);
 
-};
+    /* type of the statistic value, stored in the binary statistics files */
+    enum ValueType
+    {
+        UNSIGNED_VALUE = 0,
+        SIGNED_VALUE = 1,
+        FLOAT_VALUE = 2
+    };
 
+    virtual ValueType getValueType() const=0;
 
+    /*
+     * Returns the value for a frequency as 64 raw bits (integers extended to 64 bits,
+     * floating point values as the bits of a f64bit) and the number of samples (incavg)
+     */
+    virtual u64bit getRawValue(int f, u64bit& samples) const=0;
 
+    virtual ~Statistic() = 0;
+};
 
 template<class T>
 class NumericStatistic : public Statistic
 {
 protected:
 
-    T value[MAX_FREQS];
-    u64bit count[MAX_FREQS];
-    bool firstValue[MAX_FREQS];
+    T initialValue;
+    u32bit initialReset[MAX_FREQS];     /* the initial value is used until the frequency is reset */
+    T gauge[MAX_FREQS];                 /* adjustment of the value set by max/min */
+    bool isGauge;
+
+    NumericStatistic& updateGauge(T val, bool isMax)
+    {
+        if ( !isGauge )
+        {
+            isGauge = true;
+            counters.gauges.push_back(this);
+        }
+
+        for(int i = 0; i < MAX_FREQS; i++)
+        {
+            T current = value(i);
+            if ((isMax && (val > current)) || (!isMax && (val < current)))
+                gauge[i] += val - current;
+        }
+
+        return *this;
+    }
+
+    T value(int f) const
+    {
+        T v = (initialReset[f] == counters.resets[f]) ? initialValue : (T)0;
+        return v + (T) counterValue(f) + gauge[f];
+    }
 
 public:
 
-    NumericStatistic(std::string name) : Statistic(name)
+    NumericStatistic(std::string name) : Statistic(name), initialValue((T)0), isGauge(false)
     {
         for(int i = 0; i < MAX_FREQS; i++)
         {
-            value[i] = (T)0;
-            count[i] = 0;
-            firstValue[i] = false;
+            initialReset[i] = counters.resets[i];
+            gauge[i] = (T)0;
         }
     }
 
-    NumericStatistic(std::string name, T initialValue) : Statistic(name)
+    NumericStatistic(std::string name, T initialValue) : Statistic(name), initialValue(initialValue), isGauge(false)
     {
         for(int i = 0; i < MAX_FREQS; i++)
         {
-            value[i] = initialValue;
-            count[i] = 0;
-            firstValue[i] = false;
+            initialReset[i] = counters.resets[i];
+            gauge[i] = (T)0;
         }
     }
 
-
     std::string getString() const
     {
         return std::string("NUMERIC_STATISTIC");
     }
 
-
     NumericStatistic& max(T val)
     {
-        for(int i = 0; i < MAX_FREQS; i++)
-        {
-            value[i] = (!firstValue || (val > value[i]))?val:value[i];
-            firstValue[i] = true;
-        }
+        return updateGauge(val, true);
+    }
 
+    NumericStatistic& min(T val)
+    {
+        return updateGauge(val, false);
+    }
+
+    virtual Statistic& clear(int f)
+    {
+        Statistic::clear(f);
+        initialReset[f] = u32bit(-1);
+        clearGauge(f);
         return *this;
     }
 
-    NumericStatistic& min(T val)
+    virtual void clearGauge(int f)
     {
-        for(int i = 0; i < MAX_FREQS; i++)
+        gauge[f] = (T)0;
+    }
+
+    virtual void print(std::ostream& os) const
+    {
+        u64bit samples = counterCount(freq);
+
+        if (samples == 0)
+            os << value(freq);
+        else
+            os << ((f32bit) value(freq))/((f32bit) samples);
+    }
+
+    virtual bool isZero(int f) const { return (value(f) == (T)0); }
+
+    virtual ValueType getValueType() const
+    {
+        if ( !std::numeric_limits<T>::is_integer )
+            return FLOAT_VALUE;
+        return std::numeric_limits<T>::is_signed ? SIGNED_VALUE : UNSIGNED_VALUE;
+    }
+
+    virtual u64bit getRawValue(int f, u64bit& samples) const
+    {
+        samples = counterCount(f);
+
+        T v = value(f);
+
+        if ( !std::numeric_limits<T>::is_integer )
         {
-            value[i] = (!firstValue || (val < value[i]))?val:value[i];
-            firstValue[i] = true;
+            f64bit d = (f64bit) v;
+            u64bit bits;
+            memcpy(&bits, &d, sizeof(bits));
+            return bits;
         }
 
-        return *this;
+        if ( std::numeric_limits<T>::is_signed )
+            return (u64bit) (s64bit) v;
+
+        return (u64bit) v;
     }
 
-    virtual Statistic& clear(int f)
+
+};
+
+/*
+ * Log-bucketed histogram of values (latencies in cycles) for each frequency.
+ *
+ * Values below 64 have their own bucket, larger values are stored in buckets with
+ * a width of 1/32 of the power of two range that contains the value (less than 3.2%
+ * error in the percentiles).  Values above 2^32 - 1 are stored in the last bucket.
+ *
+ * The histogram column shows the mean of the values recorded in the frequency, the
+ * percentiles are shown in the columns added by the StatisticsManager (see
+ * HistogramPercentile).
+ */
+class HistogramStatistic : public Statistic
+{
+public:
+
+    static const u32bit SUB_BUCKET_BITS = 5;
+    static const u32bit SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const u32bit BUCKETS = (32 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+private:
+
+    std::vector<u32bit> counts;                 /* values recorded in each bucket */
+    std::vector<u32bit> snapshot[MAX_FREQS];    /* counts when the frequency was last reset */
+    u32bit maxValue[MAX_FREQS];
+    u32bit seenReset[MAX_FREQS];                /* resets of the frequency when the snapshot was taken */
+
+    static u32bit bucket(u32bit value)
     {
-        value[f] = (T)0;
-        count[f] = 0;
-        firstValue[f] = false;
+        if ( value < 2 * SUB_BUCKETS )
+            return value;
 
-        return *this;
+        u32bit shift = 0;
+        for ( u32bit v = value >> (SUB_BUCKET_BITS + 1); v != 0; v >>= 1 )
+            shift++;
+
+        return (shift * SUB_BUCKETS) + (value >> shift);
     }
 
-    virtual Statistic& inc(int times = 1)
+    /* takes the snapshot for the frequencies reset since the last record */
+    void update(int f)
     {
-        if ( disabled )
-            return *this;
+        if ( seenReset[f] != counters.resets[f] )
+        {
+            snapshot[f] = counts;
+            maxValue[f] = 0;
+            seenReset[f] = counters.resets[f];
+        }
+    }
 
-        for(int i = 0; i < MAX_FREQS; i++)
-            value[i] += times;
+public:
 
-        return *this;
-    }
+    HistogramStatistic(std::string name);
 
-    virtual Statistic& incavg(int times = 1)
+    /* highest value stored in a bucket */
+    static u32bit bucketMax(u32bit b);
+
+    void record(u32bit value)
     {
         if ( disabled )
-            return *this;
+            return;
 
-        for(int i = 0; i < MAX_FREQS; i++)
+        for ( int f = 0; f < MAX_FREQS; f++ )
         {
-            value[i] += times;
-            count[i]++;
+            update(f);
+            if ( value > maxValue[f] )
+                maxValue[f] = value;
         }
 
-        return *this;
-    }
+        counts[bucket(value)]++;
 
-    virtual void print(std::ostream& os) const
-    {
-        if (count[freq] == 0)
-            os << value[freq];
-        else
-            os << ((f32bit) value[freq])/((f32bit) count[freq]);
+        counters.total[handle] += value;
+        counters.count[handle]++;
     }
 
-    virtual bool isZero(int f) const { return (value[f] == (T)0); }
+    /* number of values recorded in the frequency */
+    u64bit samples(int f) const;
+
+    /* percentile (0 to 100) of the values recorded in the frequency, 0 if there are no values */
+    u32bit percentile(int f, f64bit p) const;
+
+    virtual Statistic& clear(int f);
+
+    std::string getString() const;
+
+    virtual bool isZero(int f) const;
+
+    virtual void print(std::ostream& os) const;
+
+    virtual ValueType getValueType() const;
+
+    virtual u64bit getRawValue(int f, u64bit& samples) const;
+};
+
+/*
+ * Column showing a percentile of a HistogramStatistic.  A percentile of 100 shows the
+ * maximum value.
+ */
+class HistogramPercentile : public Statistic
+{
+private:
+
+    const HistogramStatistic* histogram;
+    f64bit p;
+
+public:
+
+    HistogramPercentile(std::string name, const HistogramStatistic* histogram, f64bit p);
+
+    std::string getString() const;
+
+    virtual bool isZero(int f) const;
+
+    virtual void print(std::ostream& os) const;
 
+    virtual ValueType getValueType() const;
 
+    virtual u64bit getRawValue(int f, u64bit& samples) const;
 };
 
 } // namespace GPUStatistics
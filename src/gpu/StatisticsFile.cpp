@@ -0,0 +1,434 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Binary statistics file implementation file.
+ *
+ */
+
+#include "StatisticsFile.h"
+#include "support.h"
+#include <cstring>
+#include <cstdio>
+
+using namespace std;
+using namespace gpu3d;
+using namespace gpu3d::GPUStatistics;
+
+StatisticsFileWriter::StatisticsFileWriter(ostream& os, bool rangeKey) :
+os(&os), rangeKey(rangeKey), headerWritten(false), columnsVersion(0), prevKey(0)
+{
+}
+
+ostream* StatisticsFileWriter::getStream() const
+{
+    return os;
+}
+
+void StatisticsFileWriter::putVarint(u64bit v)
+{
+    while ( v >= 0x80 )
+    {
+        buffer.push_back(u8bit(v | 0x80));
+        v >>= 7;
+    }
+    buffer.push_back(u8bit(v));
+}
+
+void StatisticsFileWriter::putSigned(s64bit v)
+{
+    //  Zigzag encoding, small negative values also use few bytes.
+    putVarint((u64bit(v) << 1) ^ u64bit(v >> 63));
+}
+
+void StatisticsFileWriter::putString(const string& str)
+{
+    putVarint(str.size());
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+void StatisticsFileWriter::putChanges(const vector<pair<u32bit, s64bit> >& changes)
+{
+    putVarint(changes.size());
+
+    u32bit prevColumn = 0;
+    for ( u32bit i = 0; i < changes.size(); i++ )
+    {
+        putVarint(changes[i].first - prevColumn);
+        putSigned(changes[i].second);
+        prevColumn = changes[i].first;
+    }
+}
+
+void StatisticsFileWriter::flushRecord()
+{
+    os->write((const char *) &buffer[0], buffer.size());
+    buffer.clear();
+}
+
+void StatisticsFileWriter::writeHeader(const char* keyName)
+{
+    if ( headerWritten )
+        return;
+
+    buffer.insert(buffer.end(), STATISTICS_FILE_MAGIC, STATISTICS_FILE_MAGIC + sizeof(STATISTICS_FILE_MAGIC));
+    buffer.push_back(rangeKey ? STATISTICS_KEY_RANGE : STATISTICS_KEY_NUMBER);
+    putString(keyName);
+    flushRecord();
+
+    headerWritten = true;
+}
+
+void StatisticsFileWriter::writeColumns(const vector<Statistic*>& stats, u32bit version)
+{
+    if ( !headerWritten )
+        panic("StatisticsFileWriter", "writeColumns", "Statistics file header not written.");
+
+    buffer.push_back(STATISTICS_RECORD_COLUMNS);
+    putVarint(stats.size());
+
+    for ( u32bit i = 0; i < stats.size(); i++ )
+    {
+        buffer.push_back(u8bit(stats[i]->getValueType()));
+        putString(stats[i]->getName());
+    }
+
+    flushRecord();
+
+    //  Statistics may be inserted in any position of the list, restart the deltas.
+    prevValue.assign(stats.size(), 0);
+    prevSamples.assign(stats.size(), 0);
+    columnsVersion = version;
+}
+
+void StatisticsFileWriter::writeRow(u64bit keyFirst, u64bit keyLast, const vector<Statistic*>& stats, u32bit version, int freq)
+{
+    if ( (version != columnsVersion) || (prevValue.size() != stats.size()) )
+        writeColumns(stats, version);
+
+    buffer.push_back(STATISTICS_RECORD_ROW);
+    putSigned(s64bit(keyFirst - prevKey));
+    if ( rangeKey )
+        putSigned(s64bit(keyLast - keyFirst));
+    prevKey = keyFirst;
+
+    changedValues.clear();
+    changedSamples.clear();
+
+    for ( u32bit i = 0; i < stats.size(); i++ )
+    {
+        u64bit samples;
+        u64bit value = stats[i]->getRawValue(freq, samples);
+
+        if ( value != prevValue[i] )
+            changedValues.push_back(make_pair(i, s64bit(value - prevValue[i])));
+
+        if ( samples != prevSamples[i] )
+            changedSamples.push_back(make_pair(i, s64bit(samples - prevSamples[i])));
+
+        prevValue[i] = value;
+        prevSamples[i] = samples;
+    }
+
+    putChanges(changedValues);
+    putChanges(changedSamples);
+
+    flushRecord();
+}
+
+StatisticsFileReader::StatisticsFileReader(istream& is) :
+is(&is), rangeKey(false), keyFirst(0), keyLast(0), newColumns(false), columnRecords(0)
+{
+}
+
+bool StatisticsFileReader::getVarint(u64bit& v)
+{
+    v = 0;
+
+    for ( u32bit shift = 0; shift < 64; shift += 7 )
+    {
+        int c = is->get();
+        if ( c == EOF )
+            return false;
+
+        v |= u64bit(c & 0x7f) << shift;
+
+        if ( (c & 0x80) == 0 )
+            return true;
+    }
+
+    return false;
+}
+
+bool StatisticsFileReader::getSigned(s64bit& v)
+{
+    u64bit u;
+
+    if ( !getVarint(u) )
+        return false;
+
+    v = s64bit(u >> 1) ^ -s64bit(u & 1);
+    return true;
+}
+
+bool StatisticsFileReader::getString(string& str)
+{
+    u64bit length;
+
+    if ( !getVarint(length) )
+        return false;
+
+    str.resize(length);
+    if ( length > 0 )
+        is->read(&str[0], length);
+
+    return !is->fail();
+}
+
+bool StatisticsFileReader::getChanges(vector<u64bit>& values)
+{
+    u64bit changes;
+
+    if ( !getVarint(changes) )
+        return false;
+
+    u64bit column = 0;
+    for ( u64bit i = 0; i < changes; i++ )
+    {
+        u64bit step;
+        s64bit delta;
+
+        if ( !getVarint(step) || !getSigned(delta) )
+            return false;
+
+        column += step;
+        if ( column >= values.size() )
+            return false;
+
+        values[column] += delta;
+    }
+
+    return true;
+}
+
+bool StatisticsFileReader::readHeader()
+{
+    char magic[sizeof(STATISTICS_FILE_MAGIC)];
+
+    is->read(magic, sizeof(magic));
+    if ( is->fail() || (memcmp(magic, STATISTICS_FILE_MAGIC, sizeof(magic)) != 0) )
+        return false;
+
+    int keyType = is->get();
+    if ( (keyType != STATISTICS_KEY_RANGE) && (keyType != STATISTICS_KEY_NUMBER) )
+        return false;
+
+    rangeKey = (keyType == STATISTICS_KEY_RANGE);
+
+    return getString(keyName);
+}
+
+bool StatisticsFileReader::readColumns()
+{
+    u64bit n;
+
+    if ( !getVarint(n) )
+        return false;
+
+    columns.resize(n);
+
+    for ( u32bit i = 0; i < n; i++ )
+    {
+        int type = is->get();
+        if ( type == EOF )
+            return false;
+
+        columns[i].type = Statistic::ValueType(type);
+
+        if ( !getString(columns[i].name) )
+            return false;
+    }
+
+    value.assign(n, 0);
+    samples.assign(n, 0);
+    columnRecords++;
+
+    return true;
+}
+
+bool StatisticsFileReader::nextRow()
+{
+    newColumns = false;
+
+    while ( true )
+    {
+        int tag = is->get();
+
+        if ( tag == EOF )
+            return false;
+
+        if ( tag == STATISTICS_RECORD_COLUMNS )
+        {
+            if ( !readColumns() )
+                panic("StatisticsFileReader", "nextRow", "Truncated columns record.");
+
+            newColumns = true;
+        }
+        else if ( tag == STATISTICS_RECORD_ROW )
+            break;
+        else
+            panic("StatisticsFileReader", "nextRow", "Unknown record in statistics file.");
+    }
+
+    s64bit delta;
+    bool ok = getSigned(delta);
+    keyFirst += delta;
+
+    if ( rangeKey )
+    {
+        ok = ok && getSigned(delta);
+        keyLast = keyFirst + delta;
+    }
+    else
+        keyLast = keyFirst;
+
+    ok = ok && getChanges(value) && getChanges(samples);
+
+    if ( !ok )
+        panic("StatisticsFileReader", "nextRow", "Truncated row record.");
+
+    return true;
+}
+
+bool StatisticsFileReader::isRangeKey() const
+{
+    return rangeKey;
+}
+
+const string& StatisticsFileReader::getKeyName() const
+{
+    return keyName;
+}
+
+u64bit StatisticsFileReader::getKeyFirst() const
+{
+    return keyFirst;
+}
+
+u64bit StatisticsFileReader::getKeyLast() const
+{
+    return keyLast;
+}
+
+bool StatisticsFileReader::columnsChanged() const
+{
+    return newColumns;
+}
+
+u32bit StatisticsFileReader::getColumnRecords() const
+{
+    return columnRecords;
+}
+
+u32bit StatisticsFileReader::getColumns() const
+{
+    return columns.size();
+}
+
+const string& StatisticsFileReader::getColumnName(u32bit col) const
+{
+    return columns[col].name;
+}
+
+Statistic::ValueType StatisticsFileReader::getColumnType(u32bit col) const
+{
+    return columns[col].type;
+}
+
+u64bit StatisticsFileReader::getValue(u32bit col) const
+{
+    return value[col];
+}
+
+u64bit StatisticsFileReader::getSamples(u32bit col) const
+{
+    return samples[col];
+}
+
+void StatisticsFileReader::printValue(u32bit col, ostream& os) const
+{
+    //  Same format than NumericStatistic::print.
+    u64bit v = value[col];
+    f32bit fv;
+
+    switch ( columns[col].type )
+    {
+        case Statistic::SIGNED_VALUE:
+            if ( samples[col] == 0 )
+            {
+                os << s64bit(v);
+                return;
+            }
+            fv = (f32bit) s64bit(v);
+            break;
+
+        case Statistic::FLOAT_VALUE:
+            {
+                f64bit d;
+                memcpy(&d, &v, sizeof(d));
+                if ( samples[col] == 0 )
+                {
+                    os << d;
+                    return;
+                }
+                fv = (f32bit) d;
+            }
+            break;
+
+        default:
+            if ( samples[col] == 0 )
+            {
+                os << v;
+                return;
+            }
+            fv = (f32bit) v;
+            break;
+    }
+
+    os << fv / ((f32bit) samples[col]);
+}
+
+void StatisticsFileReader::writeCSV(ostream& os)
+{
+    while ( nextRow() )
+    {
+        //  The simulator writes the names only once, with the columns of the first row.
+        if ( newColumns && (columnRecords == 1) )
+        {
+            os << keyName;
+            for ( u32bit i = 0; i < columns.size(); i++ )
+                os << ';' << columns[i].name;
+            os << '\n';
+        }
+
+        if ( rangeKey )
+            os << keyFirst << ".." << keyLast;
+        else
+            os << keyFirst;
+
+        for ( u32bit i = 0; i < columns.size(); i++ )
+        {
+            os << ';';
+            printValue(i, os);
+        }
+
+        os << '\n';
+    }
+}
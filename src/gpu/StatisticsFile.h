@@ -0,0 +1,188 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Binary statistics file definition file.
+ *
+ */
+
+#ifndef STATISTICSFILE_H
+    #define STATISTICSFILE_H
+
+#include "Statistic.h"
+#include <vector>
+#include <string>
+#include <iostream>
+#include <utility>
+
+namespace gpu3d
+{
+
+namespace GPUStatistics
+{
+
+/*
+ * Binary statistics file format.
+ *
+ * Header:
+ *
+ *   magic           8 bytes "ATTSTAT1"
+ *   key type        1 byte, 0 : cycle range (first..last), 1 : frame or batch number
+ *   key name        varint length + characters
+ *
+ * Followed by records starting with a tag byte:
+ *
+ *   'C' columns     varint number of columns, per column the value type byte
+ *                   (Statistic::ValueType) and the name (varint length + characters).
+ *                   Written before the first row and every time new statistics are
+ *                   created.  The previous row values are reset to 0.
+ *   'R' row         key (zigzag varint delta with the first value of the previous key,
+ *                   for cycle ranges also zigzag varint last - first), the values and
+ *                   the samples that changed since the previous row.  Each list is stored
+ *                   as the varint number of changes followed by the column (varint delta
+ *                   with the previous column in the list) and the zigzag varint delta
+ *                   with the previous value.
+ *
+ * Most counters keep the same value between consecutive rows so a row only stores
+ * a small fraction of the columns.  The file is usually written through a gzip stream.
+ */
+
+static const char STATISTICS_FILE_MAGIC[8] = {'A', 'T', 'T', 'S', 'T', 'A', 'T', '1'};
+
+static const u8bit STATISTICS_KEY_RANGE = 0;
+static const u8bit STATISTICS_KEY_NUMBER = 1;
+
+static const u8bit STATISTICS_RECORD_COLUMNS = 'C';
+static const u8bit STATISTICS_RECORD_ROW = 'R';
+
+/*
+ * Writes the values of the statistics in the binary statistics file format.
+ */
+class StatisticsFileWriter
+{
+private:
+
+    std::ostream* os;
+    bool rangeKey;
+    bool headerWritten;
+    u32bit columnsVersion;          /* version of the statistic list used for the last columns record */
+    u64bit prevKey;
+    std::vector<u64bit> prevValue;
+    std::vector<u64bit> prevSamples;
+    std::vector<std::pair<u32bit, s64bit> > changedValues;   /* columns with a new value in the current row */
+    std::vector<std::pair<u32bit, s64bit> > changedSamples;  /* columns with new samples in the current row */
+    std::vector<u8bit> buffer;      /* current record */
+
+    void putVarint(u64bit v);
+    void putSigned(s64bit v);
+    void putString(const std::string& str);
+    void putChanges(const std::vector<std::pair<u32bit, s64bit> >& changes);
+    void flushRecord();
+
+public:
+
+    /*
+     * Creates a writer.  rangeKey is true for per cycle statistics (rows identified by
+     * the first and last cycle) and false for per frame and per batch statistics.
+     */
+    StatisticsFileWriter(std::ostream& os, bool rangeKey);
+
+    std::ostream* getStream() const;
+
+    /* writes the file header, the names are written with the first row */
+    void writeHeader(const char* keyName);
+
+    /* writes the names and types of the statistics */
+    void writeColumns(const std::vector<Statistic*>& stats, u32bit version);
+
+    /* writes the values of the statistics for a frequency */
+    void writeRow(u64bit keyFirst, u64bit keyLast, const std::vector<Statistic*>& stats, u32bit version, int freq);
+};
+
+/*
+ * Reads binary statistics files.
+ *
+ * Usage:
+ *
+ *   StatisticsFileReader reader(is);
+ *   if ( reader.readHeader() )
+ *       while ( reader.nextRow() )
+ *           for ( u32bit i = 0; i < reader.getColumns(); i++ )
+ *               ... reader.getColumnName(i), reader.getValue(i), reader.getSamples(i) ...
+ */
+class StatisticsFileReader
+{
+private:
+
+    struct Column
+    {
+        std::string name;
+        Statistic::ValueType type;
+    };
+
+    std::istream* is;
+    bool rangeKey;
+    std::string keyName;
+    std::vector<Column> columns;
+    std::vector<u64bit> value;
+    std::vector<u64bit> samples;
+    u64bit keyFirst;
+    u64bit keyLast;
+    bool newColumns;
+    u32bit columnRecords;
+
+    bool getVarint(u64bit& v);
+    bool getSigned(s64bit& v);
+    bool getString(std::string& str);
+    bool getChanges(std::vector<u64bit>& values);
+    bool readColumns();
+
+public:
+
+    StatisticsFileReader(std::istream& is);
+
+    /* reads and checks the file header, returns false if the file is not a statistics file */
+    bool readHeader();
+
+    /* reads the next row, returns false at the end of the file */
+    bool nextRow();
+
+    bool isRangeKey() const;
+    const std::string& getKeyName() const;
+
+    u64bit getKeyFirst() const;
+    u64bit getKeyLast() const;
+
+    /* true if the columns changed with the current row */
+    bool columnsChanged() const;
+
+    /* number of column records read until the current row */
+    u32bit getColumnRecords() const;
+
+    u32bit getColumns() const;
+    const std::string& getColumnName(u32bit col) const;
+    Statistic::ValueType getColumnType(u32bit col) const;
+
+    /* raw value (see Statistic::getRawValue) and samples of a column in the current row */
+    u64bit getValue(u32bit col) const;
+    u64bit getSamples(u32bit col) const;
+
+    /* prints the value of a column in the current row as printed in the text statistics */
+    void printValue(u32bit col, std::ostream& os) const;
+
+    /* converts the remaining rows to the text (CSV) statistics written by the simulator */
+    void writeCSV(std::ostream& os);
+};
+
+} // namespace GPUStatistics
+
+} // namespace gpu3d
+
+#endif // STATISTICSFILE_H
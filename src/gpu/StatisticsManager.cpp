@@ -23,8 +23,11 @@ using namespace std;
 
 StatisticsManager::StatisticsManager():
 startCycle(0), nCycles(1000), nextDump(999), lastCycle(-1), autoReset(true),
-osCycle(NULL), osFrame(NULL), osBatch(NULL), cyclesFlagNamesDumped(false)
+osCycle(NULL), osFrame(NULL), osBatch(NULL), cyclesFlagNamesDumped(false), statListVersion(0),
+binaryOutput(false)
 {
+    for ( u32bit f = 0; f < MAX_FREQS; f++ )
+        binWriter[f] = NULL;
 }
 
 StatisticsManager& StatisticsManager::instance()
@@ -33,6 +36,24 @@ StatisticsManager& StatisticsManager::instance()
     return *sm;
 }
 
+void StatisticsManager::updateStatList()
+{
+    if ( statList.size() == stats.size() )
+        return;
+
+    statList.clear();
+    statNames.clear();
+    statListVersion++;
+
+    map<string,Statistic*>::iterator it = stats.begin();
+    for ( ; it != stats.end(); it++ )
+    {
+        statList.push_back(it->second);
+        statNames += ";";
+        statNames += it->first;
+    }
+}
+
 Statistic* StatisticsManager::find(std::string name)
 {
     map<string,Statistic*>::iterator it = stats.find(name);
@@ -114,6 +135,56 @@ void StatisticsManager::batch()
     }
 }
 
+HistogramStatistic& StatisticsManager::getHistogramStatistic(const char* name, const char* owner, const char* postfix)
+{
+    static const char* columnNames[] = {"P50", "P90", "P99", "P999", "Max"};
+    static const f64bit columnPercentiles[] = {50.0, 90.0, 99.0, 99.9, 100.0};
+
+    string histName = name;
+    if ( postfix != 0 )
+        histName = histName + "_" + postfix;
+
+    Statistic* st = find(histName);
+    if ( st )
+    {
+        HistogramStatistic* hst = dynamic_cast<HistogramStatistic*>(st);
+
+        if ( hst == 0 )
+        {
+            char temp[256];
+            sprintf(temp, "Another Statistic exists with name '%s' but has different type", histName.c_str());
+            panic("StatisticsManager","getHistogramStatistic()", temp);
+        }
+        return *hst;
+    }
+
+    HistogramStatistic* hst = new HistogramStatistic(histName);
+    stats.insert(make_pair(histName, hst));
+
+    if ( owner != 0 )
+        hst->setOwner(owner);
+
+    for ( u32bit i = 0; i < sizeof(columnNames) / sizeof(columnNames[0]); i++ )
+    {
+        string columnName = histName + "_" + columnNames[i];
+
+        if ( find(columnName) )
+        {
+            char temp[256];
+            sprintf(temp, "Another Statistic exists with name '%s'", columnName.c_str());
+            panic("StatisticsManager","getHistogramStatistic()", temp);
+        }
+
+        HistogramPercentile* column = new HistogramPercentile(columnName, hst, columnPercentiles[i]);
+        stats.insert(make_pair(columnName, column));
+
+        if ( owner != 0 )
+            column->setOwner(owner);
+    }
+
+    return *hst;
+}
+
 Statistic* StatisticsManager::operator[](std::string statName)
 {
     return find(statName);
@@ -131,47 +202,75 @@ void StatisticsManager::setDumpScheduling(u64bit startCycle, u64bit nCycles, boo
 void StatisticsManager::setOutputStream(ostream& os)
 {
     osCycle = &os;
+    delete binWriter[FREQ_CYCLES];
+    binWriter[FREQ_CYCLES] = binaryOutput ? new StatisticsFileWriter(os, true) : NULL;
 }
 
 void StatisticsManager::setPerFrameStream(ostream& os)
 {
     osFrame = &os;
+    delete binWriter[FREQ_FRAME];
+    binWriter[FREQ_FRAME] = binaryOutput ? new StatisticsFileWriter(os, false) : NULL;
 }
 
 void StatisticsManager::setPerBatchStream(ostream& os)
 {
     osBatch = &os;
+    delete binWriter[FREQ_BATCH];
+    binWriter[FREQ_BATCH] = binaryOutput ? new StatisticsFileWriter(os, false) : NULL;
 }
 
-void StatisticsManager::reset(u32bit freq)
+void StatisticsManager::setBinaryOutput(bool enable)
 {
-    map<string,Statistic*>::iterator it = stats.begin();
-    for ( ; it != stats.end(); it++ )
-        (it->second)->clear(freq);
+    binaryOutput = enable;
 }
 
-void StatisticsManager::dumpValues(ostream& os)
+StatisticsFileWriter* StatisticsManager::findWriter(ostream& os)
 {
-    map<string,Statistic*>::iterator it = stats.begin();
-
-    os << startCycle << ".." << lastCycle;
-    for ( ; it != stats.end(); it++ )
+    for ( u32bit f = 0; f < MAX_FREQS; f++ )
     {
-        (*(it->second)).setCurrentFreq(FREQ_CYCLES);
-        os << ";" << *(it->second);
+        if ( (binWriter[f] != NULL) && (binWriter[f]->getStream() == &os) )
+            return binWriter[f];
     }
-    os << endl;
+
+    return NULL;
+}
+
+void StatisticsManager::reset(u32bit freq)
+{
+    Statistic::reset(freq);
+}
+
+void StatisticsManager::dumpValues(ostream& os)
+{
+    dumpValues(0, FREQ_CYCLES, os);
 }
 
 void StatisticsManager::dumpValues(u32bit n, u32bit freq, ostream& os)
 {
-    map<string,Statistic*>::iterator it = stats.begin();
+    updateStatList();
 
-    os << n;
-    for ( ; it != stats.end(); it++ )
+    StatisticsFileWriter* writer = findWriter(os);
+
+    if ( writer != NULL )
     {
-        (*(it->second)).setCurrentFreq(freq);
-        os << ";" << *(it->second);
+        if ( freq == FREQ_CYCLES )
+            writer->writeRow(startCycle, lastCycle, statList, statListVersion, freq);
+        else
+            writer->writeRow(n, n, statList, statListVersion, freq);
+        return;
+    }
+
+    if ( freq == FREQ_CYCLES )
+        os << startCycle << ".." << lastCycle;
+    else
+        os << n;
+
+    for ( u32bit i = 0; i < statList.size(); i++ )
+    {
+        statList[i]->setCurrentFreq(freq);
+        os << ';';
+        statList[i]->print(os);
     }
 
     os << endl;
@@ -180,22 +279,23 @@ void StatisticsManager::dumpValues(u32bit n, u32bit freq, ostream& os)
 
 void StatisticsManager::dumpNames(ostream& os)
 {
-    map<string,Statistic*>::iterator it = stats.begin();
-
-    os << "Cycles";
-    for ( ; it != stats.end(); it++ )
-        os << ";" << it->first;
-    os << endl;
+    dumpNames("Cycles", os);
 }
 
 void StatisticsManager::dumpNames(char *str, ostream& os)
 {
-    map<string,Statistic*>::iterator it = stats.begin();
+    updateStatList();
 
-    os << str;
-    for ( ; it != stats.end(); it++ )
-        os << ";" << it->first;
-    os << endl;
+    StatisticsFileWriter* writer = findWriter(os);
+
+    if ( writer != NULL )
+    {
+        writer->writeHeader(str);
+        writer->writeColumns(statList, statListVersion);
+        return;
+    }
+
+    os << str << statNames << endl;
 }
 
 void StatisticsManager::dump(ostream& os)
@@ -15,6 +15,7 @@
     #define STATISTICSMANAGER_H
 
 #include "Statistic.h"
+#include "StatisticsFile.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -42,6 +43,14 @@ private:
     /* list of current stats */
     std::map<std::string,GPUStatistics::Statistic*> stats;
 
+    /* statistics and names ordered by name, used for the dumps */
+    std::vector<GPUStatistics::Statistic*> statList;
+    std::string statNames;
+    u32bit statListVersion;     /* incremented every time the dump list is rebuilt */
+
+    /* Helper method to rebuild the dump list after new statistics are created */
+    void updateStatList();
+
     /* Helper method to find a Statistic with name 'name' */
     Statistic* find(std::string name);
 
@@ -59,6 +68,13 @@ private:
     std::ostream* osFrame;
     std::ostream* osBatch;
 
+    /* binary output for the cycle, frame and batch streams */
+    bool binaryOutput;
+    StatisticsFileWriter* binWriter[MAX_FREQS];
+
+    /* Helper method to find the binary writer for an output stream */
+    StatisticsFileWriter* findWriter(std::ostream& os);
+
     /* singleton instance */
     // static StatisticsManager* sm;
 
@@ -112,6 +128,13 @@ public:
         return *nst;
     }
 
+    /*
+     * Returns the histogram statistic with name 'name', creates the histogram and the
+     * percentile columns (name_P50, name_P90, name_P99, name_P999 and name_Max) if it
+     * doesn't exist.
+     */
+    GPUStatistics::HistogramStatistic& getHistogramStatistic(const char* name, const char* owner = 0, const char* postfix = 0);
+
     Statistic* operator[](std::string statName);
 
     virtual void clock(u64bit cycle);
@@ -128,6 +151,13 @@ public:
 
     void setPerBatchStream(std::ostream& os);
 
+    /*
+     * Selects the binary statistics file format (see StatisticsFile.h) instead of the
+     * text (CSV) format for the output streams set after the call.
+     */
+    void setBinaryOutput(bool enable);
+
+    /* resets all the statistics for a frequency (see Statistic::reset) */
     void reset(u32bit freq);
 
     void dumpNames(std::ostream& os = std::cout);
@@ -0,0 +1,61 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Typed Signal class implementation file.
+ *
+ */
+
+#include "TypedSignal.h"
+#include <cstring>
+
+using namespace gpu3d;
+
+TypedSignalBase::TypedSignalBase( const char* signalName, u32bit bw, u32bit latency ) :
+bandwidth(bw), maxLatency(latency)
+{
+    name = new char[strlen(signalName)+1];
+    strcpy( name, signalName );
+}
+
+TypedSignalBase::~TypedSignalBase()
+{
+    delete[] name;
+}
+
+const char* TypedSignalBase::getName() const
+{
+    return name;
+}
+
+u32bit TypedSignalBase::getBandwidth() const
+{
+    return bandwidth;
+}
+
+u32bit TypedSignalBase::getLatency() const
+{
+    return maxLatency;
+}
+
+bool TypedSignalBase::isSignalDefined() const
+{
+    return ( bandwidth != 0 && maxLatency != 0 );
+}
+
+bool TypedSignalBase::isBandwidthDefined() const
+{
+    return ( bandwidth != 0 );
+}
+
+bool TypedSignalBase::isLatencyDefined() const
+{
+    return ( maxLatency != 0 );
+}
@@ -0,0 +1,378 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Typed Signal class definition file.
+ *
+ */
+
+#ifndef __TYPED_SIGNAL__
+    #define __TYPED_SIGNAL__
+
+#include "GPUTypes.h"
+#include "support.h"
+#include <cmath>
+#include <cstdio>
+#include <typeinfo>
+
+namespace gpu3d
+{
+
+/**
+ * @b TypedSignalBase class implements the type independent part of a TypedSignal.
+ *
+ * @b Files:  TypedSignal.h, TypedSignal.cpp
+ *
+ * - Used by the SignalBinder to register typed signals and to check their bindings.
+ *
+ */
+class TypedSignalBase {
+
+protected:
+
+    char* name;         ///< Name identifier for the signal
+    u32bit bandwidth;   ///< Bandwidth allowed ( writes per cycle ), 0 implies undefined
+    u32bit maxLatency;  ///< Signal's latency ( 0 implies undefined )
+
+public:
+
+    /**
+     * Creates the type independent part of a typed signal
+     *
+     * @param name signal's name
+     * @param bandwidth maximum signal's bandwidth supported
+     * @param maxLatency maximum signal's latency
+     */
+    TypedSignalBase( const char* name, u32bit bandwidth, u32bit maxLatency );
+
+    /// Destructor
+    virtual ~TypedSignalBase();
+
+    /// Obtains signal's name identifier
+    const char* getName() const;
+
+    /// Obtains max signal's bandwidth ( 0 if not yet defined )
+    u32bit getBandwidth() const;
+
+    /// Obtains max signal's latency ( 0 if not yet defined )
+    u32bit getLatency() const;
+
+    /// Test if signal has bandwidth and latency defined
+    bool isSignalDefined() const;
+
+    /// Test if bandwidth is defined
+    bool isBandwidthDefined() const;
+
+    /// Test if latency is defined
+    bool isLatencyDefined() const;
+
+    /**
+     * Sets new bandwidth and latency ( hard reset )
+     *
+     * @return true if SIGNAL is WELL-DEFINED, false ( 0 ) otherwise
+     */
+    virtual bool setParameters( u32bit newBandwidth, u32bit newLatency ) = 0;
+
+    /**
+     * Obtains the name of the type of the values carried by the signal
+     *
+     * @return the type name returned by typeid
+     */
+    virtual const char* getTypeName() const = 0;
+
+    /**
+     * Obtains the number of values stored in the signal to be read in a cycle ( signal trace )
+     *
+     * @param cycle the simulation cycle
+     *
+     * @return number of values pending to be read in the cycle
+     */
+    virtual u32bit getValues( u64bit cycle ) const = 0;
+};
+
+/**
+ * @b TypedSignal class implements the Signal concept for values of a fixed type.
+ *
+ * @b Files:  TypedSignal.h, TypedSignal.cpp
+ *
+ * - Same timing behaviour than Signal ( bandwidth, variable latency up to maxLatency,
+ *   pre-initialization with setData ) but the values are copied into a ring buffer
+ *   allocated when the signal is defined.  Writes and reads don't allocate memory, the
+ *   producer and consumer don't need to create and delete a DynamicObject per message.
+ * - Intended for small and frequent messages ( states, flags ) so T should be a small
+ *   copyable type.
+ * - Typed signals are registered in the SignalBinder with Box::newInputTypedSignal and
+ *   Box::newOutputTypedSignal.  Both sides of the signal must use the same type.
+ * - The signal trace only dumps the number of values in the signal.
+ *
+ */
+template <class T>
+class TypedSignal : public TypedSignalBase {
+
+private:
+
+    T* data;                ///< Values in the signal ( capacity x bandwidth )
+    u32bit* nReads;         ///< Values pending to be read in every position
+    u32bit capacity;        ///< Precalculated: 2^(ceil(log2(maxLatency + 1)))
+    u32bit capacityMask;    ///< Bitmask used for the capacity module.
+    u32bit readsDone;       ///< Reads in actual cycle
+    u64bit lastCycle;       ///< Last cycle with a read or write operation
+    u32bit nextRead;
+    u32bit nextWrite;
+    u32bit pendentReads;
+
+    /// Creates the value ring ( bandwidth and latency must be defined )
+    void create()
+    {
+        capacity = 1 << u32bit(ceil(log(f64bit(maxLatency + 1))/log(2.0)));
+        capacityMask = capacity - 1;
+
+        data = new T[capacity * bandwidth];
+        nReads = new u32bit[capacity];
+
+        for ( u32bit i = 0; i < capacity; i++ )
+            nReads[i] = 0;
+
+        readsDone = 0;
+        lastCycle = 0;
+        nextRead = 0;
+        nextWrite = maxLatency;
+        pendentReads = 0;
+    }
+
+    /// Deletes the value ring
+    void destroy()
+    {
+        delete[] data;
+        delete[] nReads;
+    }
+
+    /// Updates the signal clock
+    void clock( u64bit cycle )
+    {
+        u32bit passedCycles = u32bit(cycle - lastCycle);
+
+        if (pendentReads != 0)
+        {
+            //  Check that no value was left unread in the passed cycles.
+            if (passedCycles > maxLatency)
+                lostData(cycle);
+
+            u32bit missedReads = 0;
+
+            for(u32bit i = 0; i < passedCycles; i++)
+                missedReads += nReads[(nextRead + i) & capacityMask];
+
+            if (missedReads > 0)
+                lostData(cycle);
+        }
+
+        nextRead = (nextRead + passedCycles) & capacityMask;
+        nextWrite = (nextWrite + passedCycles) & capacityMask;
+        lastCycle = cycle;
+        readsDone = 0;
+    }
+
+    void lostData( u64bit cycle ) const
+    {
+        char buffer[1024];
+        sprintf(buffer, "Lost data in signal \"%s\" cycle %lld.", name, cycle);
+        panic("TypedSignal", "clock", buffer);
+    }
+
+    /// Stores a value at a position of the ring
+    bool insert( u64bit cycle, u32bit position, const T& value )
+    {
+        if (nReads[position] == bandwidth)
+        {
+            char buffer[1024];
+            sprintf(buffer, "Error.  Max. BW exceeded (read conflict).  Signal \"%s\" cycle %lld.", name, cycle);
+            panic("TypedSignal", "write", buffer);
+        }
+
+        data[position * bandwidth + nReads[position]] = value;
+        nReads[position]++;
+        pendentReads++;
+
+        return true;
+    }
+
+    /// Typed signals can't be copied
+    TypedSignal( const TypedSignal& );
+    TypedSignal& operator=( const TypedSignal& );
+
+public:
+
+    /**
+     * Creates a new TypedSignal
+     *
+     * @param name signal's name
+     * @param bandwidth maximum signal's bandwidth supported
+     * @param maxLatency maximum signal's latency
+     */
+    TypedSignal( const char* name, u32bit bandwidth = 0, u32bit maxLatency = 0 ) :
+        TypedSignalBase(name, bandwidth, maxLatency), data(0), nReads(0)
+    {
+        if ( isSignalDefined() )
+            create();
+    }
+
+    /// Destructor
+    ~TypedSignal()
+    {
+        if ( data != 0 )
+            destroy();
+    }
+
+    /// Creates a new typed signal for the SignalBinder
+    static TypedSignalBase* newSignal( const char* name, u32bit bandwidth, u32bit maxLatency )
+    {
+        return new TypedSignal<T>(name, bandwidth, maxLatency);
+    }
+
+    /// Obtains the name of the type T
+    static const char* typeName()
+    {
+        return typeid(T).name();
+    }
+
+    const char* getTypeName() const
+    {
+        return typeName();
+    }
+
+    bool setParameters( u32bit newBandwidth, u32bit newLatency )
+    {
+        if ( data != 0 )
+        {
+            destroy();
+            data = 0;
+        }
+
+        bandwidth = newBandwidth;
+        maxLatency = newLatency;
+
+        if ( !isSignalDefined() )
+            return false;
+
+        create();
+
+        return true;
+    }
+
+    /**
+     * Sets a default contents ( see Signal::setData )
+     *
+     * @param initialData array of maxLatency x bandwidth values used to fill the signal
+     * @param firstCycleForReadOrWrite first cycle with data available ( defaults to 0 )
+     */
+    bool setData( const T initialData[], u64bit firstCycleForReadOrWrite = 0 )
+    {
+        if ( !isSignalDefined() )
+            panic("TypedSignal", "setData", "Error. Signal is not well defined yet. It Cannot be initializated");
+
+        u32bit in = static_cast<u32bit>(GPU_MOD( firstCycleForReadOrWrite, capacity ));
+        for ( u32bit i = 0; i < maxLatency; i++ ) {
+            for ( nReads[in] = 0; nReads[in] < bandwidth; nReads[in]++ ) {
+                data[in * bandwidth + nReads[in]] = initialData[i * bandwidth + nReads[in]];
+                pendentReads++;
+            }
+            in = GPU_MOD( in + 1, capacity );
+        }
+        readsDone = 0;
+        lastCycle = firstCycleForReadOrWrite;
+
+        return true;
+    }
+
+    /**
+     * Writes a value using the maximum latency
+     *
+     * @param cycle cycle in which write is performed
+     * @param value value copied into the signal
+     *
+     * @return returns true if the write was successfully done
+     */
+    bool write( u64bit cycle, const T& value )
+    {
+        if (cycle > lastCycle)
+            clock(cycle);
+
+        return insert(cycle, nextWrite, value);
+    }
+
+    /**
+     * Writes a value
+     *
+     * @param cycle cycle in which write is performed
+     * @param value value copied into the signal
+     * @param latency latency for the value to be written
+     *
+     * @return returns true if the write was successfully done
+     */
+    bool write( u64bit cycle, const T& value, u32bit latency )
+    {
+        if (cycle > lastCycle)
+            clock(cycle);
+
+        if (latency > maxLatency)
+        {
+            char buffer[256];
+            sprintf(buffer, "Error.  Inconsistent latency value. Signal %s, latency %d.", name, latency);
+            panic("TypedSignal", "write", buffer);
+        }
+
+        nextWrite = (nextRead + latency) & capacityMask;
+
+        return insert(cycle, nextWrite, value);
+    }
+
+    /**
+     * Reads a value
+     *
+     * @param cycle cycle in which read is performed
+     * @param value reference to the variable where the value is copied
+     *
+     * @return returns true if a value was read, false otherwise
+     */
+    bool read( u64bit cycle, T& value )
+    {
+        bool cycleChanged = (cycle > lastCycle);
+
+        if ((pendentReads == 0) || (!cycleChanged && (nReads[nextRead] == 0)))
+            return false;
+
+        if (cycleChanged)
+            clock(cycle);
+
+        if (nReads[nextRead] == 0)
+            return false;
+
+        value = data[nextRead * bandwidth + readsDone];
+        readsDone++;
+        nReads[nextRead]--;
+        pendentReads--;
+
+        return true;
+    }
+
+    u32bit getValues( u64bit cycle ) const
+    {
+        if ( data == 0 )
+            return 0;
+
+        //  Position of the cycle relative to the current read position.
+        return nReads[(nextRead + u32bit(cycle - lastCycle)) & capacityMask];
+    }
+};
+
+} // namespace gpu3d
+
+#endif
@@ -88,6 +88,7 @@ TextureCacheL2::TextureCacheL2(u32bit waysL0, u32bit linesL0, u32bit bytesLineL0
     readBankConflicts = &GPUStatistics::StatisticsManager::instance().getNumericStatistic("ReadBankConflicts", u32bit(0), "TextureCache", postfix);
     memRequests = &GPUStatistics::StatisticsManager::instance().getNumericStatistic("MemoryRequests", u32bit(0), "TextureCache", postfix);
     memReqLatency = &GPUStatistics::StatisticsManager::instance().getNumericStatistic("MemoryRequestLatency", u32bit(0), "TextureCache", postfix);
+    memReqLatencyHist = &GPUStatistics::StatisticsManager::instance().getHistogramStatistic("MemoryRequestLatencyHist", "TextureCache", postfix);
     pendingRequests = &GPUStatistics::StatisticsManager::instance().getNumericStatistic("PendingMemoryRequests", u32bit(0), "TextureCache", postfix);
     pendingRequestsAvg = &GPUStatistics::StatisticsManager::instance().getNumericStatistic("PendingMemoryRequestsAvg", u32bit(0), "TextureCache", postfix);
 
@@ -768,6 +769,7 @@ void TextureCacheL2::clock(u64bit cycle)
             /*  Update statistics.  */
             memRequests->inc();
             memReqLatency->inc(cycle - memRStartCycle[readTicket]);
+            memReqLatencyHist->record(u32bit(cycle - memRStartCycle[readTicket]));
         }
     }
 
@@ -170,6 +170,7 @@ private:
     GPUStatistics::Statistic *readBankConflicts;    /**<  Counts bank conflicts when reading.  */
     GPUStatistics::Statistic *memRequests;          /**<  Memory requests served by the Memory Controller.  */
     GPUStatistics::Statistic *memReqLatency;        /**<  Latency of the memory requests served by the Memory Controller.  */
+    GPUStatistics::HistogramStatistic *memReqLatencyHist;   /**<  Distribution of the latency of the memory requests for L2 misses.  */
     GPUStatistics::Statistic *pendingRequests;      /**<  Number of memory requests issued to the Memory Controller and not served.  */
     GPUStatistics::Statistic *pendingRequestsAvg;   /**<  Average number of memory requests issued to the Memory Controller and not served.  */
 
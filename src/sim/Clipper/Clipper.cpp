@@ -38,16 +38,18 @@
 #include "TriangleSetup.h"
 
 #include <sstream>
+#include <cstring>
 
 using namespace gpu3d;
 
 /*  Clipper constructor.  */
 Clipper::Clipper(u32bit trCycle, u32bit clipUnits, u32bit startLat, u32bit execLat, u32bit bufferSize,
-    u32bit rastLat, u32bit outputLat, char *name, Box* parent) :
+    bool clipping, f32bit guardBand, u32bit rastLat, u32bit outputLat, char *name, Box* parent) :
 
     trianglesCycle(trCycle), clipperUnits(clipUnits),
     startLatency(startLat), execLatency(execLat), clipBufferSize(bufferSize),
-    rasterizerStartLat(rastLat), rasterizerOutputLat(outputLat), Box(name, parent)
+    rasterizerStartLat(rastLat), rasterizerOutputLat(outputLat), frustumClipping(clipping),
+    clipEmulator(MAX_VERTEX_ATTRIBUTES, guardBand), Box(name, parent)
 {
     DynamicObject *defaultState[1];
 
@@ -107,6 +109,9 @@ Clipper::Clipper(u32bit trCycle, u32bit clipUnits, u32bit startLat, u32bit execL
     inputs = &getSM().getNumericStatistic("InputTriangles", u32bit(0), "Clipper", "CLP");
     outputs = &getSM().getNumericStatistic("OutputTriangles", u32bit(0), "Clipper", "CLP");
     clipped = &getSM().getNumericStatistic("ClippedTriangles", u32bit(0), "Clipper", "CLP");
+    planeClipped = &getSM().getNumericStatistic("PlaneClippedTriangles", u32bit(0), "Clipper", "CLP");
+    planeCulled = &getSM().getNumericStatistic("PlaneCulledTriangles", u32bit(0), "Clipper", "CLP");
+    generated = &getSM().getNumericStatistic("GeneratedTriangles", u32bit(0), "Clipper", "CLP");
 
     /*  Initialize last triangle wait cycles.  */
     lastTriangleCycles = 0;
@@ -170,6 +175,15 @@ void Clipper::clock(u64bit cycle)
             
             //  Reset D3D9 depth range mode register.
             d3d9DepthRange = false;
+            clipEmulator.setDepthRange(false);
+
+            /*  Reset user clip planes.  */
+            userClipPlanes = FALSE;
+            for(i = 0; i < MAX_USER_CLIP_PLANES; i++)
+            {
+                userClip[i] = QuadFloat(0.0, 0.0, 0.0, 0.0);
+                clipEmulator.undefineClipPlane(i);
+            }
 
             /*  Reset last triangle wait cycles counter.  */
             lastTriangleCycles = 0;
@@ -202,10 +216,10 @@ void Clipper::clock(u64bit cycle)
             )
 
             /*  Check if there are available entries in the clip buffer.  */
-            if ((reservedEntries + clippedTriangles) < clipBufferSize)
+            if ((reservedEntries + clippedTriangles + clipQueue.size()) < clipBufferSize)
             {
                 /*  Calculate number of triangles to request.  */
-                triRequest = GPU_MIN(clipBufferSize - reservedEntries - clippedTriangles, trianglesCycle);
+                triRequest = GPU_MIN(clipBufferSize - reservedEntries - clippedTriangles - u32bit(clipQueue.size()), trianglesCycle);
 
                 /*  Request triangles to primitive assembly.  */
                 clipperRequest->write(cycle, new PrimitiveAssemblyRequest(triRequest));
@@ -272,17 +286,14 @@ void Clipper::clock(u64bit cycle)
                         panic("Clipper", "clock", "Clipped triangle buffer is full.");
                 )
 
+                /*  Release the entry reserved for the triangle.  */
+                reservedEntries--;
+
                 /*  Check if it is the last triangle.  **/
                 if (tsInput->isLast())
                 {
                     /*  Store the triangle in the clipped triangle buffer.  */
-                    clipBuffer[nextFreeEntry] = tsInput;
-
-                    /*  Update clipped triangle counter.  */
-                    clippedTriangles++;
-
-                    /*  Update pointer to the next free entry in the clip  buffer.  */
-                    nextFreeEntry = GPU_MOD(nextFreeEntry + 1, clipBufferSize);
+                    storeTriangle(tsInput);
                 }
                 else
                 {
@@ -310,22 +321,21 @@ void Clipper::clock(u64bit cycle)
                         /*  Drop clipped triangles.  */
                         delete tsInput;
                     }
-                    else
+                    else if (!clipTriangle(tsInput))
                     {
                         /*  Store the triangle in the clipped triangle buffer.  */
-                        clipBuffer[nextFreeEntry] = tsInput;
-
-                        /*  Update clipped triangle counter.  */
-                        clippedTriangles++;
-
-                        /*  Update pointer to the next free entry in the clip
-                            buffer.  */
-                        nextFreeEntry = GPU_MOD(nextFreeEntry + 1, clipBufferSize);
+                        storeTriangle(tsInput);
                     }
                 }
+            }
 
-                /*  Update reserved entries counter.  */
-                reservedEntries--;
+            /*  Move the triangles waiting in the clip queue to the clip buffer.  */
+            while (!clipQueue.empty() && ((clippedTriangles + reservedEntries) < clipBufferSize))
+            {
+                clipBuffer[nextFreeEntry] = clipQueue.front();
+                clipQueue.pop_front();
+                clippedTriangles++;
+                nextFreeEntry = GPU_MOD(nextFreeEntry + 1, clipBufferSize);
             }
 
             /*  Update rasterizer cycles counter.  */
@@ -555,7 +565,22 @@ void Clipper::processRegisterWrite(GPURegister reg, u32bit subReg,
 
             /*  User clip register.  */
 
-            panic("Clipper", "processRegisterWrite", "GPU_USER_CLIP not supported yet.");
+            /*  Check user clip plane identifier range.  */
+            GPU_ASSERT(
+                if (subReg >= MAX_USER_CLIP_PLANES)
+                    panic("Clipper", "processRegisterWrite", "Out of range user clip plane identifier.");
+            )
+
+            userClip[subReg] = QuadFloat(data.qfVal[0], data.qfVal[1], data.qfVal[2], data.qfVal[3]);
+
+            /*  Update the plane in the clipper emulator if the user clip planes are enabled.  */
+            if (userClipPlanes)
+                clipEmulator.defineClipPlane(subReg, userClip[subReg]);
+
+            GPU_DEBUG_BOX(
+                printf("Clipper => Write GPU_USER_CLIP(%d) = (%f, %f, %f, %f).\n", subReg,
+                    data.qfVal[0], data.qfVal[1], data.qfVal[2], data.qfVal[3]);
+            )
 
             break;
 
@@ -563,7 +588,20 @@ void Clipper::processRegisterWrite(GPURegister reg, u32bit subReg,
 
             /*  User clip plane register.  */
 
-            panic("Clipper", "processRegiterWrite", "GPU_USER_CLIP_PLANE not supported yet.");
+            userClipPlanes = data.booleanVal;
+
+            /*  Define or undefine the user clip planes in the clipper emulator.  */
+            for(u32bit i = 0; i < MAX_USER_CLIP_PLANES; i++)
+            {
+                if (userClipPlanes)
+                    clipEmulator.defineClipPlane(i, userClip[i]);
+                else
+                    clipEmulator.undefineClipPlane(i);
+            }
+
+            GPU_DEBUG_BOX(
+                printf("Clipper => Write GPU_USER_CLIP_PLANE = %s.\n", userClipPlanes ? "ENABLED" : "DISABLED");
+            )
 
             break;
 
@@ -572,6 +610,7 @@ void Clipper::processRegisterWrite(GPURegister reg, u32bit subReg,
             //  Set D3D9 depth range in clip space register.
             
             d3d9DepthRange = data.booleanVal;
+            clipEmulator.setDepthRange(d3d9DepthRange);
             
             GPU_DEBUG_BOX(
                 printf("Clipper => Write GPU_D3D9_DEPTH_RANGE = %s\n", d3d9DepthRange ? "T" : "F");
@@ -585,6 +624,101 @@ void Clipper::processRegisterWrite(GPURegister reg, u32bit subReg,
     }
 }
 
+/*  Stores a triangle in the clip buffer or in the clip queue.  */
+void Clipper::storeTriangle(TriangleSetupInput *tsInput)
+{
+    /*  Keep the triangle order, the triangle waits in the clip queue if the clip buffer is full
+        (more triangles than reserved entries generated by clipping) or other triangles are waiting.  */
+    if (clipQueue.empty() && ((clippedTriangles + reservedEntries) < clipBufferSize))
+    {
+        /*  Store the triangle in the clipped triangle buffer.  */
+        clipBuffer[nextFreeEntry] = tsInput;
+
+        /*  Update clipped triangle counter.  */
+        clippedTriangles++;
+
+        /*  Update pointer to the next free entry in the clip buffer.  */
+        nextFreeEntry = GPU_MOD(nextFreeEntry + 1, clipBufferSize);
+    }
+    else
+        clipQueue.push_back(tsInput);
+}
+
+/*  Clips a triangle against the clip planes.  */
+bool Clipper::clipTriangle(TriangleSetupInput *tsInput)
+{
+    QuadFloat *v1, *v2, *v3;
+    QuadFloat *triangle[MAX_CLIP_TRIANGLES][3];
+    u32bit numTriangles;
+    u32bit i;
+
+    /*  Get triangle vertex attributes.  */
+    v1 = tsInput->getVertexAttributes(0);
+    v2 = tsInput->getVertexAttributes(1);
+    v3 = tsInput->getVertexAttributes(2);
+
+    /*  Clip the triangle.  */
+    if (!clipEmulator.clip(v1, v2, v3, frustumClip && frustumClipping, userClipPlanes))
+        return false;
+
+    /*  Update statistics.  */
+    planeClipped->inc();
+
+    /*  Get the triangle fan for the clipped polygon without the triangles outside the viewport.  */
+    numTriangles = clipEmulator.getClipTriangles(triangle);
+
+    if (numTriangles == 0)
+    {
+        GPU_DEBUG_BOX(
+            printf("Clipper => Triangle (ID %d) removed by clipping.\n", tsInput->getTriangleID());
+        )
+
+        /*  Update statistics.  */
+        planeCulled->inc();
+    }
+    else
+    {
+        GPU_DEBUG_BOX(
+            printf("Clipper => Triangle (ID %d) clipped into %d triangles.\n", tsInput->getTriangleID(), numTriangles);
+        )
+
+        /*  Generate the triangles for the clipped polygon.  The new triangles keep the identifier
+            of the original triangle:  the fragments, shader inputs, validation logs and per
+            triangle statistics are keyed per source primitive.  */
+        for(i = 0; i < numTriangles; i++)
+        {
+            QuadFloat *attrib1 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+            QuadFloat *attrib2 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+            QuadFloat *attrib3 = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+
+            memcpy(attrib1, triangle[i][0], sizeof(QuadFloat) * MAX_VERTEX_ATTRIBUTES);
+            memcpy(attrib2, triangle[i][1], sizeof(QuadFloat) * MAX_VERTEX_ATTRIBUTES);
+            memcpy(attrib3, triangle[i][2], sizeof(QuadFloat) * MAX_VERTEX_ATTRIBUTES);
+
+            TriangleSetupInput *clipInput = new TriangleSetupInput(tsInput->getTriangleID(), attrib1, attrib2, attrib3, FALSE);
+
+            /*  Copy cookies from the original triangle.  */
+            clipInput->copyParentCookies(*tsInput);
+
+            /*  Store the triangle in the clipped triangle buffer.  */
+            storeTriangle(clipInput);
+
+            /*  Update statistics.  */
+            generated->inc();
+        }
+
+        /*  The clipper test units are busy generating the additional triangles.  */
+        clipCycles += (numTriangles - 1) * startLatency;
+    }
+
+    /*  Delete the original triangle.  */
+    delete[] v1;
+    delete[] v2;
+    delete[] v3;
+    delete tsInput;
+
+    return true;
+}
 
 void Clipper::getState(string &stateString)
 {
@@ -615,6 +749,7 @@ void Clipper::getState(string &stateString)
 
     stateStream << " | Clipped Triangles = " << clippedTriangles;
     stateStream << " | Requested Triangles = " << requestedTriangles;
+    stateStream << " | Clip Queue = " << clipQueue.size();
     stateStream << " | Triangle Count = " << triangleCount;
 
     stateString.assign(stateStream.str());
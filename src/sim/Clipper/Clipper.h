@@ -38,6 +38,8 @@
 #include "GPU.h"
 #include "TriangleSetupInput.h"
 #include "ClipperCommand.h"
+#include "ClipperEmulator.h"
+#include <deque>
 
 
 namespace gpu3d
@@ -80,9 +82,12 @@ enum ClipperStatus
  *  and/or the user clip planes.  The Clipper unit can generate
  *  new vertices and triangles.
  *
- *  The current version of the clipper only performs trivial
- *  triangle reject if the triangle is outside the frustum clip
- *  volume.
+ *  The triangles outside the frustum clip volume are trivially
+ *  rejected.  The other triangles are clipped against the near
+ *  and far planes, the guard band planes and the user clip planes
+ *  and replaced by the triangle fan of the clipped polygon.  The
+ *  triangles generated by clipping that don't fit in the clip
+ *  buffer wait in a queue until entries are released.
  *
  *  The Clipper class inherits from the Box class that provides
  *  basic simulation support.
@@ -112,10 +117,16 @@ private:
     u32bit clipBufferSize;       /**<  Size of the buffer for clipped triangles.  */
     u32bit rasterizerStartLat;   /**<  Start latency for rasterizer unit.  */
     u32bit rasterizerOutputLat;  /**<  Latency of the triangle bus to Rasterizer.  */
+    bool frustumClipping;        /**<  Clip the triangles against the near and far planes and the guard band.  */
 
     /*  Clipper registers.  */
     bool frustumClip;           /**<  Frustum clipping enable flag.  */
     bool d3d9DepthRange;        /**<  Defines the range for depth dimension in clip space, [0, 1] for D3D9, [-1, 1] for OpenGL.  */
+    QuadFloat userClip[MAX_USER_CLIP_PLANES];   /**<  User clip planes.  */
+    bool userClipPlanes;        /**<  User clip planes enabled or disabled.  */
+
+    /*  Clipper emulator.  */
+    ClipperEmulator clipEmulator;   /**<  Clipper emulator that performs the clip operations.  */
 
     /*  Clipper state.  */
     ClipperState state;                 /**<  The current clipper state.  */
@@ -132,11 +143,15 @@ private:
     u32bit nextFreeEntry;               /**<  Next free entry in the buffer.  */
     u32bit clippedTriangles;            /**<  Number of clipped triangles in the buffer.  */
     u32bit reservedEntries;             /**<  Number of reserved (triangles in the clipper pipeline) clip buffer entries.  */
+    std::deque<TriangleSetupInput *> clipQueue; /**<  Triangles waiting for a free clip buffer entry.  */
 
     /*  Statistics.  */
     GPUStatistics::Statistic *inputs;   /**<  Number of input triangles.  */
     GPUStatistics::Statistic *outputs;  /**<  Number of output triangles.  */
-    GPUStatistics::Statistic *clipped;  /**<  Number of clipped triangles.  */
+    GPUStatistics::Statistic *clipped;  /**<  Number of clipped (trivially rejected) triangles.  */
+    GPUStatistics::Statistic *planeClipped;     /**<  Number of triangles clipped against the clip planes.  */
+    GPUStatistics::Statistic *planeCulled;      /**<  Number of triangles removed by clipping against the clip planes.  */
+    GPUStatistics::Statistic *generated;        /**<  Number of triangles generated by clipping against the clip planes.  */
 
     /*  Private functions.  */
 
@@ -162,6 +177,31 @@ private:
 
     void processRegisterWrite(GPURegister reg, u32bit subReg, GPURegData data);
 
+    /**
+     *
+     *  Stores a triangle in the clip buffer or in the clip queue if the clip
+     *  buffer is full or there are triangles already waiting in the queue.
+     *
+     *  @param tsInput The triangle to store.
+     *
+     */
+
+    void storeTriangle(TriangleSetupInput *tsInput);
+
+    /**
+     *
+     *  Clips a triangle against the clip planes and stores the triangles
+     *  generated.
+     *
+     *  @param tsInput The triangle to clip.
+     *
+     *  @return If the triangle was clipped (the triangle and its vertex
+     *  attributes have been deleted).
+     *
+     */
+
+    bool clipTriangle(TriangleSetupInput *tsInput);
+
 
 
 public:
@@ -177,6 +217,8 @@ public:
      *  @param startLatency Start Clipper latency for input triangles.
      *  @param exeLatency Execution latency for frustum clip reject test.
      *  @param bufferSize Size of the buffer for the clipped triangles.
+     *  @param frustumClipping Clip the triangles against the near and far planes and the guard band.
+     *  @param guardBand Size of the guard band relative to the viewport.
      *  @param rasterizerStartLat Start latency of the rasterizer unit.
      *  @param rasterizerOutputLat Latency of the triangle bus to Rasterizer.
      *  @param parent The Clipper parent box.
@@ -187,7 +229,8 @@ public:
      */
 
     Clipper(u32bit trianglesCycle, u32bit clipperUnits, u32bit startLatency, u32bit execLatency,
-        u32bit bufferSize, u32bit rasterizerStartLat, u32bit rasterizerOutputLat, char *name, Box *parent);
+        u32bit bufferSize, bool frustumClipping, f32bit guardBand, u32bit rasterizerStartLat, u32bit rasterizerOutputLat,
+        char *name, Box *parent);
 
     /**
      *
@@ -36,7 +36,7 @@ using namespace gpu3d;
 AGPTransaction::AGPTransaction(u32bit addr, u32bit dataSize, u8bit *dataBuffer, u32bit _md, bool isWrite, bool isLocked):
 
 /*  Set object attributes.  */
-address(addr), size(dataSize), data(dataBuffer), md(_md), locked(isLocked)
+address(addr), size(dataSize), data(dataBuffer), md(_md), locked(isLocked), lazy(false)
 
 {
     if ( dataSize == 0 )
@@ -69,7 +69,7 @@ address(addr), size(dataSize), data(dataBuffer), md(_md), locked(isLocked)
 AGPTransaction::AGPTransaction(u32bit addr, u32bit dataSize, u8bit *dataBuffer, u32bit _md):
 
 /*  Set object attributes.  */
-address(addr), size(dataSize), data(dataBuffer), md(_md), locked(true)
+address(addr), size(dataSize), data(dataBuffer), md(_md), locked(true), lazy(false)
 
 {
     if ( dataSize == 0 )
@@ -169,6 +169,7 @@ AGPTransaction::AGPTransaction(AGPTransaction *sourceAGPTrans)
             address = sourceAGPTrans->address;
             md = sourceAGPTrans->md;
             locked = sourceAGPTrans->locked;
+            lazy = sourceAGPTrans->lazy;
             size = sourceAGPTrans->size;
             
             //  Allocate space for the transaction data
@@ -250,6 +251,7 @@ AGPTransaction::AGPTransaction(gzifstream *traceFile)
             traceFile->read((char *) &md, sizeof(md));
             traceFile->read((char *) &locked, sizeof(locked));
             traceFile->read((char *) &size, sizeof(size));
+            lazy = false;
             
             if (traceFile->eof())
                 return;
@@ -429,6 +431,22 @@ void AGPTransaction::forcePreload()
     }
 }
 
+//  Marks an AGP_PRELOAD transaction as lazy.
+void AGPTransaction::setLazy(bool isLazy)
+{
+    //  Only preloads can be deferred by the Memory Controller.
+    if (isLazy && (agpTrans != AGP_PRELOAD))
+        panic("AGPTransaction", "setLazy", "Only AGP_PRELOAD transactions can be lazy.");
+
+    lazy = isLazy;
+}
+
+//  Returns if the AGP transaction is a lazy preload.
+bool AGPTransaction::isLazy()
+{
+    return lazy;
+}
+
 //  Save AGP transaction into a file.
 void AGPTransaction::save(gzofstream *outFile)
 {
@@ -82,6 +82,7 @@ private:
     u32bit numPackets;      /**<  Number of AGP packets for this transaction.  */
     bool locked;            /**<  Flag marking the transaction must wait until the next batch has finished.  */
     u32bit md;              /**<  Memory descriptor associated with the register write (Used to help parsing AGP Transaction traces).  */
+    bool lazy;              /**<  Flag marking that the preloaded data can be written into memory when first accessed.  */
 
     GPUEvent gpuEvent;      /**<  GPU event.  */
     std::string eventMsg;   /**<  Event message.  */
@@ -387,6 +388,27 @@ public:
      */    
      
     void forcePreload();
+
+    /**
+     *
+     *  Marks an AGP_PRELOAD transaction as lazy.  The Memory Controller defers writing the
+     *  data of a lazy preload into memory until a memory transaction touches the region.
+     *
+     *  @param isLazy TRUE if the preload can be deferred.
+     *
+     */
+
+    void setLazy(bool isLazy);
+
+    /**
+     *
+     *  Returns if the AGP transaction is a lazy preload.
+     *
+     *  @return TRUE if the AGP transaction is a lazy preload.
+     *
+     */
+
+    bool isLazy();
      
     /**
      * Dumps AGPTransaction info
@@ -55,9 +55,10 @@ using namespace gpu3d;
 /*  Command Processor constructor.  */
 CommandProcessor::CommandProcessor(TraceDriverInterface *tDriver, u32bit nVShaders, char **vshPrefixArray,
     u32bit nFShaders, char **fshPrefixArray, u32bit nTUs, char **tuPrefixArray, u32bit nStampUnits, char **suPrefixes,
-    u32bit memSize, bool pipeBatches, bool dumpShaders, char *name, Box *parent):
+    u32bit memSize, bool pipeBatches, bool dumpShaders, bool filterWrites, char *name, Box *parent):
 
 regWrites(getSM().getNumericStatistic("RegisterWrites", u32bit(0), "CommandProcessor", "CP")),
+regWritesFiltered(getSM().getNumericStatistic("RegisterWritesFiltered", u32bit(0), "CommandProcessor", "CP")),
 bytesWritten(getSM().getNumericStatistic("BytesWritten", u32bit(0), "CommandProcessor", "CP")),
 bytesRead(getSM().getNumericStatistic("BytesRead", u32bit(0), "CommandProcessor", "CP")),
 writeTrans(getSM().getNumericStatistic("WriteTransactions", u32bit(0), "CommandProcessor", "CP")),
@@ -79,6 +80,7 @@ bitBlitCycles(getSM().getNumericStatistic("bitBlitCycles", u32bit(0), "CommandPr
 
 Box(name, parent), numVShaders(nVShaders), numFShaders(nFShaders), numTextureUnits(nTUs),
 numStampUnits(nStampUnits), memorySize(memSize), pipelinedBatches(pipeBatches), dumpShaderPrograms(dumpShaders),
+filterRegWrites(filterWrites),
 skipDraw(false), skipFrames(false), forceTransaction(false), forcedCommand(false)
 
 {
@@ -855,7 +857,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to all the Z Stencil Test.  */
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 /*  Send END command to all the Color Write units.  */
@@ -869,7 +871,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to the Color Write unit.  */
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to END_FRAGMENT state\n", cycle);
@@ -966,7 +968,7 @@ void CommandProcessor::clock(u64bit cycle)
                             rastComm->addCookie();
 
                             /*  Send the reset signal to the Z Stencil Test unit.  */
-                            zStencilCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                         }
 
                         /*  Send draw command to all the Color Write units.  */
@@ -980,7 +982,7 @@ void CommandProcessor::clock(u64bit cycle)
                             rastComm->addCookie();
 
                             /*  Send the reset signal to the Color Write unit.  */
-                            colorWriteCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                         }
 
 //printf("CP %lld => Change to DRAWING state.  Start pipelined batch rendering fragment phase.\n", cycle);
@@ -1460,7 +1462,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to the Color Write unit.  */
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
                 /*  Send SWAP command to the DAC unit.  */
@@ -1538,7 +1540,7 @@ void CommandProcessor::clock(u64bit cycle)
                             rastComm->addCookie();
 
                             //  Send the command to the Z Stencil Test unit.
-                            zStencilCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                         }
 
                         //  Send DUMP_BUFFER command to the DAC unit.
@@ -1573,7 +1575,7 @@ void CommandProcessor::clock(u64bit cycle)
                             rastComm->addCookie();
 
                             //  Send the command to the Color Write unit.
-                            colorWriteCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                         }
 
                         //  Send SWAP command to the DAC unit.
@@ -1638,7 +1640,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to the Color Write unit.  */
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
                 /*  Send BLIT command to the DAC unit.  */
@@ -1700,7 +1702,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to the Color Write unit.  */
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to READY state.\n", cycle);
@@ -1736,7 +1738,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     /*  Send the command to the Z Stencil Test unit.  */
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 /*  Create END command to the Rasterizert.  */
@@ -1782,7 +1784,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Color Write unit.
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to READY state.\n", cycle);
@@ -1818,7 +1820,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Z Stencil Test unit.
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 //  Start wait for HZ updates to finish.
@@ -1867,7 +1869,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Color Write unit.
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to READY state.\n", cycle);
@@ -1902,7 +1904,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Color Write unit.
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to READY state.\n", cycle);
@@ -1937,7 +1939,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Z Stencil Test unit.
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
 //printf("CP %lld => Change to READY state.\n", cycle);
@@ -1972,7 +1974,7 @@ void CommandProcessor::clock(u64bit cycle)
                     rastComm->addCookie();
 
                     //  Send the command to the Z Stencil Test unit.
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 //  Set end of command flag.
@@ -2172,6 +2174,9 @@ void CommandProcessor::processNewAGPTransaction(u64bit cycle)
                     COMMANDPROCESSOR,
                     currentTicket++);
 
+                /*  Lazy preloads are written into memory by the Memory Controller when first accessed.  */
+                memTrans->setLazy(lastAGPTrans->isLazy());
+
                 /*  Copy original AGP transaction cookie and add new cookie.  */
                 memTrans->copyParentCookies(*lastAGPTrans);
                 memTrans->addCookie();
@@ -2211,6 +2216,24 @@ void CommandProcessor::processNewAGPTransaction(u64bit cycle)
 
         case AGP_REG_WRITE:
 
+            /*  Filter register writes that don't change the register value.  */
+            if (filterRegWrites && regWriteFilter.isRedundant(lastAGPTrans->getGPURegister(),
+                lastAGPTrans->getGPUSubRegister(), lastAGPTrans->getGPURegData()))
+            {
+                GPU_DEBUG_BOX(
+                    printf("CommandProcessor => Filtering redundant AGP_REG_WRITE.\n");
+                )
+
+                /*  Allow processing the next transaction as current has finished.  */
+                processNewTransaction = TRUE;
+
+                /*  Update statistics.  */
+                regWrites++;
+                regWritesFiltered++;
+
+                break;
+            }
+
             /*  Determine register type.  */
             //regGroup = (lastAGPTrans->getGPURegister() < GPU_LAST_GEOMETRY_REGISTER)?GEOM_REG:FRAG_REG;
             if (lastAGPTrans->getGPURegister() < GPU_LAST_GEOMETRY_REGISTER)
@@ -2419,35 +2442,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2494,35 +2495,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2604,35 +2583,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2676,35 +2633,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2749,35 +2684,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2822,35 +2735,13 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -2936,19 +2827,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -3219,19 +3099,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -3276,19 +3145,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -3315,19 +3173,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -3359,19 +3206,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -3402,19 +3238,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send state to DAC.  */
 
@@ -3447,19 +3272,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             //  Send state to DAC.
@@ -3490,19 +3304,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3521,19 +3324,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3791,19 +3583,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3835,19 +3616,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3876,19 +3646,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3917,19 +3676,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3958,19 +3706,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -3999,19 +3736,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -4214,19 +3940,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to the streamer unit.  */
             streamCtrlSignal->write(cycle, streamComm);
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -4733,33 +4448,11 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to rasterizer.  */
             rastCommSignal->write(cycle, rastCom);
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
-
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send register write to all fragment shader units.  */
             for (i = 0; i < numFShaders; i++)
@@ -4808,33 +4501,11 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to rasterizer.  */
             rastCommSignal->write(cycle, rastCom);
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
-
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             /*  Send register write to all fragment shader units.  */
             for (i = 0; i < numFShaders; i++)
@@ -5063,19 +4734,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Send state change to Hierarchical Z.  */
             rastCommSignal->write(cycle, rastCom);
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5272,19 +4932,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture enable register.  */
             state.textureEnabled[gpuSubReg] = gpuData.booleanVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5297,19 +4946,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture mode register.  */
             state.textureMode[gpuSubReg] = gpuData.txMode;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5333,19 +4971,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture address register (per cubemap image, mipmap and texture unit).  */
             state.textureAddress[textUnit][mipmap][cubemap] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5358,19 +4985,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture width (first mipmap).  */
             state.textureWidth[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5383,19 +4999,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture height (first mipmap).  */
             state.textureHeight[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5408,19 +5013,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture width (first mipmap).  */
             state.textureDepth[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5433,19 +5027,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture width (log of 2 of the first mipmap).  */
             state.textureWidth2[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5458,19 +5041,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture height (log 2 of the first mipmap).  */
             state.textureHeight2[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5483,19 +5055,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture depth (log of 2 of the first mipmap).  */
             state.textureDepth2[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5508,19 +5069,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture border register.  */
             state.textureBorder[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5534,19 +5084,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture format register.  */
             state.textureFormat[gpuSubReg] = gpuData.txFormat;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5559,19 +5098,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture reverse register.  */
             state.textureReverse[gpuSubReg] = gpuData.booleanVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5584,19 +5112,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture D3D9 color order conversion register.  */
             state.textD3D9ColorConv[gpuSubReg] = gpuData.booleanVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5609,19 +5126,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture D3D9 v coordinate inversion register.  */
             state.textD3D9VInvert[gpuSubReg] = gpuData.booleanVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5634,19 +5140,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture compression register.  */
             state.textureCompr[gpuSubReg] = gpuData.txCompression;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5659,19 +5154,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             //  Write texture blocking mode register.
             state.textureBlocking[gpuSubReg] = gpuData.txBlocking;
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5687,19 +5171,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             state.textBorderColor[gpuSubReg][2] = gpuData.qfVal[2];
             state.textBorderColor[gpuSubReg][3] = gpuData.qfVal[3];
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5712,19 +5185,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture wrap in s dimension register.  */
             state.textureWrapS[gpuSubReg] = gpuData.txClamp;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5737,19 +5199,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture wrap in t dimension register.  */
             state.textureWrapT[gpuSubReg] = gpuData.txClamp;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5762,19 +5213,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture wrap in r dimension register.  */
             state.textureWrapR[gpuSubReg] = gpuData.txClamp;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5787,19 +5227,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             //  Write texture non-normalized coordinates register.
             state.textureNonNormalized[gpuSubReg] = gpuData.booleanVal;
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5813,19 +5242,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture minification filter register.  */
             state.textureMinFilter[gpuSubReg] = gpuData.txFilter;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5838,19 +5256,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture magnification filter register.  */
             state.textureMagFilter[gpuSubReg] = gpuData.txFilter;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5863,19 +5270,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             //  Write texture enable comparison (PCF) register.
             state.textureEnableComparison[gpuSubReg] = gpuData.booleanVal;
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5925,19 +5321,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             //  Write texture comparison function (PCF) register.
             state.textureComparisonFunction[gpuSubReg] = gpuData.compare;
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5950,19 +5335,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             //  Write texture SRGB space to linear space conversion register.
             state.textureSRGB[gpuSubReg] = gpuData.booleanVal;
 
-            //  Send register write to all Texture Units.
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                //  Create shader command to write a register.
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                //  Send the shader command to a texture unit.
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            //  Store register write in the shared register file for all the Texture Units.
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -5976,19 +5350,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture minimum lod register.  */
             state.textureMinLOD[gpuSubReg] = gpuData.f32Val;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6001,19 +5364,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture maximum lod register.  */
             state.textureMaxLOD[gpuSubReg] = gpuData.f32Val;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6026,19 +5378,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture lod bias register.  */
             state.textureLODBias[gpuSubReg] = gpuData.f32Val;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6051,19 +5392,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture minimum mipmap level register.  */
             state.textureMinLevel[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6076,19 +5406,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture maximum mipmap level register.  */
             state.textureMaxLevel[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6102,19 +5421,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture unit lod bias register.  */
             state.textureUnitLODBias[gpuSubReg] = gpuData.f32Val;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6127,19 +5435,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
             /*  Write texture unit max anisotropy register.  */
             state.maxAnisotropy[gpuSubReg] = gpuData.uintVal;
 
-            /*  Send register write to all Texture Units.  */
-            for(i = 0; i < numTextureUnits; i++)
-            {
-                /*  Create shader command to write a register.  */
-                shComm = new ShaderCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                shComm->copyParentCookies(*lastAGPTrans);
-                shComm->addCookie();
-
-                /*  Send the shader command to a texture unit.  */
-                tuCommandSignal[i]->write(cycle, shComm, 1);
-            }
+            /*  Store register write in the shared register file for all the Texture Units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::TEXTURE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6168,19 +5465,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             break;
@@ -6196,19 +5482,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6223,19 +5498,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             break;
@@ -6251,19 +5515,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             break;
@@ -6279,19 +5532,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6306,19 +5548,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6333,19 +5564,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6360,19 +5580,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6401,19 +5610,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             break;
@@ -6442,19 +5640,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6469,19 +5656,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Z Stencil Test.  */
 
-            /*  Send register write to all the Z Stencil units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Z Stencil Test.  */
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Z Stencil units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6496,19 +5672,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Z Stencil Test.
 
-            //  Send register write to all the Z Stencil units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Z Stencil Test.
-                zStencilCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Z Stencil units.
+            unitRegisters.write(cycle, SharedRegisterFile::ZSTENCIL_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC/Blitter.
 
@@ -6537,19 +5702,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC/Blitter.
 
@@ -6576,19 +5730,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC/Blitter.
 
@@ -6615,19 +5758,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
             
@@ -6670,19 +5802,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -6709,19 +5830,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -6751,19 +5861,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             //  Send state to Color Write.
 
-            //  Send register write to all the Color Write units.
-            for(i = 0; i < numStampUnits; i++)
-            {
-                //  Create rasterizer command.
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                //  Copy cookies from original AGP transaction and a new cookie.
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                //  Send state change to Color Write.
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            //  Store register write in the shared register file for all the Color Write units.
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             //  Send state to DAC.
 
@@ -6792,19 +5891,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6820,19 +5908,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6849,19 +5926,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
 
             break;
@@ -6878,19 +5944,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6906,19 +5961,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6934,19 +5978,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -6965,19 +5998,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7005,19 +6027,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7046,19 +6057,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7086,19 +6086,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7127,19 +6116,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7156,19 +6134,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
 
@@ -7184,19 +6151,8 @@ void CommandProcessor::processGPURegisterWrite(u64bit cycle, GPURegister gpuReg,
 
             /*  Send state to Color Write.  */
 
-            /*  Send register write to all the Color Write units.  */
-            for(i = 0; i < numStampUnits; i++)
-            {
-                /*  Create rasterizer command.  */
-                rastCom = new RasterizerCommand(gpuReg, gpuSubReg, gpuData);
-
-                /*  Copy cookies from original AGP transaction and a new cookie.  */
-                rastCom->copyParentCookies(*lastAGPTrans);
-                rastCom->addCookie();
-
-                /*  Send state change to Color Write.  */
-                colorWriteCommSignal[i]->write(cycle, rastCom);
-            }
+            /*  Store register write in the shared register file for all the Color Write units.  */
+            unitRegisters.write(cycle, SharedRegisterFile::COLORWRITE_UNITS, gpuReg, gpuSubReg, gpuData);
 
             break;
         case GPU_MCV2_2ND_INTERLEAVING_START_ADDR:
@@ -7357,7 +6313,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                 rastComm->addCookie();
 
                 /*  Send the reset signal to the Z Stencil Test unit.  */
-                zStencilCommSignal[i]->write(cycle, rastComm);
+                writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
             }
 
             /*  Send reset command to all the Color Write units.  */
@@ -7371,7 +6327,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                 rastComm->addCookie();
 
                 /*  Send the reset signal to the Color Write unit.  */
-                colorWriteCommSignal[i]->write(cycle, rastComm);
+                writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
             }
 
             /*  Send reset signal to the fragment shaders.  */
@@ -7498,7 +6454,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                             rastComm->addCookie();
 
                             /*  Send the reset signal to the Z Stencil Test unit.  */
-                            zStencilCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                         }
 
                         /*  Send draw command to all the Color Write units.  */
@@ -7512,7 +6468,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                             rastComm->addCookie();
 
                             /*  Send the reset signal to the Color Write unit.  */
-                            colorWriteCommSignal[i]->write(cycle, rastComm);
+                            writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                         }
 
 //printf("CP %lld => Change to DRAWING state.\n", cycle);
@@ -7590,7 +6546,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         /*  Send the command to the Color Write.  */
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     /*  Update statistics.  */
@@ -7665,7 +6621,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                     rastComm->addCookie();
 
                     //  Send the command to the Color Write unit.
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
                 //  Reset END command processed by Color Write units flag.
@@ -7712,7 +6668,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                     rastComm->addCookie();
 
                     //  Send the command to the Z Stencil Test unit.
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 //  Reset END command processed by Z Stencil Test units flag.
@@ -7759,7 +6715,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                     rastComm->addCookie();
 
                     //  Send the command to the Z Stencil Test unit.
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 //  Reset END command processed by Z Stencil Test units flag.
@@ -7811,7 +6767,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         /*  Send the command to the Color Write.  */
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     /*  Update statistics.  */
@@ -7906,7 +6862,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                     rastComm->addCookie();
 
                     /*  Send the command to the Z Stencil Test unit.  */
-                    zStencilCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                 }
 
                 /*  AGP transaction finished, process a new one.  */
@@ -7946,7 +6902,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                     rastComm->addCookie();
 
                     /*  Send the command to the Color Write unit.  */
-                    colorWriteCommSignal[i]->write(cycle, rastComm);
+                    writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                 }
 
                 /*  AGP transaction finished, process a new one.  */
@@ -7990,7 +6946,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Z Stencil Test unit.
-                        zStencilCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8041,7 +6997,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Color Write unit.
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8407,7 +7363,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Color Write unit.
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8457,7 +7413,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Color Write unit.
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8507,7 +7463,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Z Stencil Test unit.
-                        zStencilCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8557,7 +7513,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Z Stencil Test unit.
-                        zStencilCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8618,7 +7574,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         ///  Send the command to the Z Stencil Test unit.
-                        zStencilCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, zStencilCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8666,7 +7622,7 @@ void CommandProcessor::processGPUCommand(u64bit cycle, GPUCommand gpuComm)
                         rastComm->addCookie();
 
                         //  Send the command to the Color Write unit.
-                        colorWriteCommSignal[i]->write(cycle, rastComm);
+                        writeStampUnitCommand(cycle, colorWriteCommSignal[i], rastComm);
                     }
 
                     //  AGP transaction finished, process a new one.
@@ -8843,6 +7799,9 @@ void CommandProcessor::reset()
     regUpdates[FRAG_REG] = nextFreeUpdate[FRAG_REG] = nextUpdate[FRAG_REG] = 0;
     regUpdates[GEOM_REG] = nextFreeUpdate[GEOM_REG] = nextUpdate[GEOM_REG] = 0;
 
+    //  The GPU units reset their registers, forget the values last written.
+    regWriteFilter.invalidate();
+
     //  Reset process transaction flag.
     processNewTransaction = true;
 
@@ -9276,4 +8235,18 @@ void CommandProcessor::setValidationMode(bool enable)
     enableValidation = enable;
 }
 
+void CommandProcessor::writeStampUnitCommand(u64bit cycle, Signal *signal, RasterizerCommand *command)
+{
+    //  The stamp unit must process the register writes stored up to now before the command.
+    command->setStateVersion(unitRegisters.getVersion());
+
+    signal->write(cycle, command);
+}
+
+SharedRegisterFile &CommandProcessor::getSharedRegisters()
+{
+    return unitRegisters;
+}
+
+
 
@@ -43,6 +43,9 @@
 #include "Streamer.h"
 #include "TraceDriverInterface.h"
 #include "RasterizerStateInfo.h"
+#include "RasterizerCommand.h"
+#include "SharedRegisterFile.h"
+#include "RegisterWriteFilter.h"
 
 namespace gpu3d
 {
@@ -88,6 +91,7 @@ private:
     u32bit memorySize;          /**<  Size of the GPU memory in bytes.  */
     bool pipelinedBatches;      /**<  Enables/disables pipelined rendering of batches.  */
     bool dumpShaderPrograms;    /**<  Dumps shaders loaded to a file.  */
+    bool filterRegWrites;       /**<  Enables/disables filtering register writes that don't change the register value.  */
 
     /*  Command Processor signals.  */
     Signal **vshFCommSignal;    /**<  Array of the Shader Command signals to the Vertex Shader (Fetch) Units.  */
@@ -102,7 +106,7 @@ private:
     Signal *rastStateSignal;    /**<  Rasterizer state signal to the Command Processor.  */
     Signal **fshFCommandSignal; /**<  Array of command signals to the Fragment Shader Units (Fetch).  */
     Signal **fshDCommandSignal; /**<  Array of command signals to the Fragment Shader Units (Decode).  */
-    Signal **tuCommandSignal;   /**<  Array of command signals to the Texture Units.  */
+    Signal **tuCommandSignal;   /**<  Array of command signals to the Texture Units (register writes are stored in the shared register file).  */
     Signal **zStencilCommSignal;    /**<  Array of command signals to the Z Stencil Test unit.  */
     Signal **zStencilStateSignal;   /**<  Array of state signals from the Color Write unit.  */
     Signal **colorWriteCommSignal;  /**<  Array of command signals to the Color Write unit.  */
@@ -156,6 +160,10 @@ private:
     u32bit nextUpdate[2];       /**<  Pointer to the next register update in the update buffer.  */
     u32bit nextFreeUpdate[2];   /**<  Pointer to the next free entry in the register update buffer.  */
 
+    RegisterWriteFilter regWriteFilter; /**<  Last value written into each GPU register, filters the redundant register writes.  */
+
+    SharedRegisterFile unitRegisters;   /**<  Register writes for the stamp units (Z Stencil Test + Color Write) and the Texture Units.  */
+
     /*  Memory access state.  */
     MemState memoryState;       /**<  Stores current memory state.  */
     u32bit transCycles;         /**<  Stores the remaining cycles for the end of the current AGP Transaction.  */
@@ -168,6 +176,7 @@ private:
 
     /*  Command processor statistics.  */
     GPUStatistics::Statistic &regWrites;    /**<  Number of register writes.  */
+    GPUStatistics::Statistic &regWritesFiltered;    /**<  Number of redundant register writes filtered.  */
     GPUStatistics::Statistic &bytesWritten; /**<  Bytes written to memory.  */
     GPUStatistics::Statistic &bytesRead;    /**<  Bytes read from memory.  */
     GPUStatistics::Statistic &writeTrans;   /**<  Write transactions.  */
@@ -228,6 +237,19 @@ private:
 
     void processGPURegisterWrite(u64bit cycle, GPURegister gpuReg, u32bit gpuSubReg, GPURegData gpuData);
 
+    /**
+     *
+     *  Sends a command to a stamp unit (Z Stencil Test or Color Write).  The command carries
+     *  the current version of the stamp unit shared register file.
+     *
+     *  @param cycle Current simulation cycle.
+     *  @param signal Command signal to the stamp unit.
+     *  @param command The command to send.
+     *
+     */
+
+    void writeStampUnitCommand(u64bit cycle, Signal *signal, RasterizerCommand *command);
+
     /**
      *
      *  Processes an AGP_REG_READ transaction.
@@ -298,6 +320,7 @@ public:
      *  @param memorySize Size of the GPU memory in bytes.
      *  @param pipelinedBatches Enables/Disables pipelined rendering of batches.
      *  @param dumpShaders Enables/Disables the dumping of the shader programs being loaded to files.
+     *  @param filterWrites Enables/Disables filtering register writes that don't change the register value.
      *  @param name Name of the Command Processor Box.
      *  @param parent Pointer to a parent box.
      *  @return An initialized Command Processor.
@@ -307,7 +330,7 @@ public:
     CommandProcessor(TraceDriverInterface *driver, u32bit numVShaders, char **vshPrefixArray,
         u32bit numFShader, char **fshPrefixArray, u32bit numTextureUnits, char **tuPrefixArray,
         u32bit nStampUnits, char **suPrefixes,
-        u32bit memorySize, bool pipelinedBatches, bool dumpShaders, char *name, Box *parent = 0);
+        u32bit memorySize, bool pipelinedBatches, bool dumpShaders, bool filterWrites, char *name, Box *parent = 0);
 
 
     /**
@@ -477,6 +500,17 @@ public:
      */
      
     void setValidationMode(bool enable);
+
+    /**
+     *
+     *  Returns the shared register file that stores the register writes for the stamp units
+     *  (Z Stencil Test + Color Write) and the Texture Units.
+     *
+     *  @return A reference to the shared register file.
+     *
+     */
+
+    SharedRegisterFile &getSharedRegisters();
         
 };
 
@@ -0,0 +1,95 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Register Write Filter implementation file.
+ *
+ */
+
+/**
+ *
+ *  @file RegisterWriteFilter.cpp
+ *
+ *  Implements the RegisterWriteFilter class.
+ *
+ */
+
+#include "RegisterWriteFilter.h"
+#include <cstring>
+
+using namespace std;
+
+namespace gpu3d
+{
+
+RegisterWriteFilter::RegisterWriteFilter()
+{
+}
+
+bool RegisterWriteFilter::isRedundant(GPURegister gpuReg, u32bit gpuSubReg, const GPURegData &gpuData)
+{
+    //  The render target 0 address is also written through the front and back buffer address
+    //  registers and the Color Write and DAC units swap the buffers at the end of the frame.
+    if ((gpuReg == GPU_FRONTBUFFER_ADDR) || (gpuReg == GPU_BACKBUFFER_ADDR) || (gpuReg == GPU_RENDER_TARGET_ADDRESS))
+        return false;
+
+    GPU_ASSERT(
+        if (gpuReg >= GPU_LAST_REGISTER)
+            panic("RegisterWriteFilter", "isRedundant", "Undefined GPU register identifier.");
+    )
+
+    vector<RegisterShadow> &regShadow = shadow[gpuReg];
+
+    if (gpuSubReg >= regShadow.size())
+    {
+        RegisterShadow empty;
+        empty.valid = false;
+        regShadow.resize(gpuSubReg + 1, empty);
+    }
+
+    RegisterShadow &entry = regShadow[gpuSubReg];
+
+    //  Compare the raw register data, comparing the float values would not filter writes
+    //  of NaN and would filter writes changing the sign of zero.
+    if (entry.valid && (memcmp(&entry.data, &gpuData, sizeof(GPURegData)) == 0))
+        return true;
+
+    entry.valid = true;
+    entry.data = gpuData;
+
+    //  The color buffer format is aliased with the render target 0 format and the units
+    //  convert the clear color to the color buffer format when the clear color is written.
+    if (gpuReg == GPU_COLOR_BUFFER_FORMAT)
+    {
+        invalidate(GPU_RENDER_TARGET_FORMAT, 0);
+        invalidate(GPU_COLOR_BUFFER_CLEAR, 0);
+    }
+    else if ((gpuReg == GPU_RENDER_TARGET_FORMAT) && (gpuSubReg == 0))
+    {
+        invalidate(GPU_COLOR_BUFFER_FORMAT, 0);
+        invalidate(GPU_COLOR_BUFFER_CLEAR, 0);
+    }
+
+    return false;
+}
+
+void RegisterWriteFilter::invalidate(GPURegister gpuReg, u32bit gpuSubReg)
+{
+    if (gpuSubReg < shadow[gpuReg].size())
+        shadow[gpuReg][gpuSubReg].valid = false;
+}
+
+void RegisterWriteFilter::invalidate()
+{
+    for(u32bit r = 0; r < GPU_LAST_REGISTER; r++)
+        shadow[r].clear();
+}
+
+} // namespace gpu3d
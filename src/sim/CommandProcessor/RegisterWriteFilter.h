@@ -0,0 +1,114 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Register Write Filter definition file.
+ *
+ */
+
+/**
+ *
+ *  @file RegisterWriteFilter.h
+ *
+ *  Defines the RegisterWriteFilter class used by the Command Processor to
+ *  filter register writes that don't change the GPU state.
+ *
+ */
+
+#ifndef _REGISTERWRITEFILTER_
+    #define _REGISTERWRITEFILTER_
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPU.h"
+#include <vector>
+
+namespace gpu3d
+{
+
+/**
+ *
+ *  Register Write Filter class.
+ *
+ *  Stores a shadow copy of the last value written into each GPU register and subregister.
+ *  A register write is redundant when it writes the value stored in the shadow.
+ *
+ *  Some registers write the same GPU unit state than other registers (aliases) or the
+ *  units derive state from them using the value of other registers:
+ *
+ *    - The front and back buffer address registers and the render target 0 address are
+ *      aliased and the Color Write and DAC units swap the buffers at the end of the frame.
+ *      The writes to these registers are never filtered.
+ *    - The color buffer format and the render target 0 format are aliased.  A write to
+ *      one of the two registers invalidates the shadow of the other.
+ *    - The color buffer clear value is converted to the color buffer format when it is
+ *      written.  A write to the color buffer format or the render target 0 format
+ *      invalidates the shadow of the clear color.
+ *
+ */
+class RegisterWriteFilter
+{
+private:
+
+    /**
+     *  Last value written into a GPU register.
+     */
+    struct RegisterShadow
+    {
+        bool valid;         /**<  The shadow stores the last value written into the register.  */
+        GPURegData data;    /**<  Last value written into the register.  */
+    };
+
+    std::vector<RegisterShadow> shadow[GPU_LAST_REGISTER];  /**<  Last value written into each GPU register and subregister.  */
+
+    /**
+     *
+     *  Invalidates the last value written into a GPU register.
+     *
+     *  @param gpuReg GPU register.
+     *  @param gpuSubReg GPU subregister.
+     *
+     */
+    void invalidate(GPURegister gpuReg, u32bit gpuSubReg);
+
+public:
+
+    /**
+     *
+     *  Register Write Filter constructor.
+     *
+     */
+    RegisterWriteFilter();
+
+    /**
+     *
+     *  Checks if a register write is redundant (writes the value already stored in the
+     *  register) and updates the register shadow.
+     *
+     *  @param gpuReg GPU register to write.
+     *  @param gpuSubReg GPU subregister to write.
+     *  @param gpuData Data to write to the GPU register.
+     *
+     *  @return If the register write can be filtered.
+     *
+     */
+    bool isRedundant(GPURegister gpuReg, u32bit gpuSubReg, const GPURegData &gpuData);
+
+    /**
+     *
+     *  Invalidates the last values written into all the GPU registers.
+     *
+     */
+    void invalidate();
+};
+
+} // namespace gpu3d
+
+#endif
@@ -0,0 +1,120 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Shared Register File implementation file.
+ *
+ */
+
+/**
+ *
+ *  @file SharedRegisterFile.cpp
+ *
+ *  Implements the SharedRegisterFile class.
+ *
+ */
+
+#include "SharedRegisterFile.h"
+
+using namespace std;
+
+namespace gpu3d
+{
+
+SharedRegisterFile::SharedRegisterFile() : firstVersion(0)
+{
+}
+
+u32bit SharedRegisterFile::addReader(u32bit units)
+{
+    //  The new reader only reads the register writes stored from now on.
+    readerVersion.push_back(getVersion());
+    readerUnits.push_back(units);
+
+    return u32bit(readerVersion.size() - 1);
+}
+
+void SharedRegisterFile::write(u64bit cycle, u32bit units, GPURegister reg, u32bit subReg, const GPURegData &data)
+{
+    RegisterWrite regWrite;
+
+    regWrite.reg = reg;
+    regWrite.subReg = subReg;
+    regWrite.data = data;
+    regWrite.units = units;
+    regWrite.cycle = cycle;
+
+    writes.push_back(regWrite);
+
+    if (writes.size() >= TRIM_THRESHOLD)
+        trim();
+}
+
+void SharedRegisterFile::trim()
+{
+    u64bit minVersion = getVersion();
+
+    for(u32bit r = 0; r < readerVersion.size(); r++)
+        if (readerVersion[r] < minVersion)
+            minVersion = readerVersion[r];
+
+    while (firstVersion < minVersion)
+    {
+        writes.pop_front();
+        firstVersion++;
+    }
+}
+
+bool SharedRegisterFile::read(u32bit reader, u64bit version, GPURegister &reg, u32bit &subReg, GPURegData &data)
+{
+    GPU_ASSERT(
+        if (reader >= readerVersion.size())
+            panic("SharedRegisterFile", "read", "Undefined reader.");
+        if (version > getVersion())
+            panic("SharedRegisterFile", "read", "Version not yet stored in the register file.");
+    )
+
+    u64bit &next = readerVersion[reader];
+
+    //  Skip the register writes for other unit types.
+    while ((next < version) && ((writes[next - firstVersion].units & readerUnits[reader]) == 0))
+        next++;
+
+    if (next >= version)
+        return false;
+
+    const RegisterWrite &regWrite = writes[next - firstVersion];
+
+    reg = regWrite.reg;
+    subReg = regWrite.subReg;
+    data = regWrite.data;
+
+    next++;
+
+    return true;
+}
+
+bool SharedRegisterFile::readIssued(u32bit reader, u64bit cycle, GPURegister &reg, u32bit &subReg, GPURegData &data)
+{
+    GPU_ASSERT(
+        if (reader >= readerVersion.size())
+            panic("SharedRegisterFile", "readIssued", "Undefined reader.");
+    )
+
+    //  The register writes are stored in issue order.
+    u64bit version = readerVersion[reader];
+
+    while ((version < getVersion()) && (writes[version - firstVersion].cycle < cycle))
+        version++;
+
+    return read(reader, version, reg, subReg, data);
+}
+
+} // namespace gpu3d
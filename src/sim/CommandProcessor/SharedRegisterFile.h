@@ -0,0 +1,173 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Shared Register File definition file.
+ *
+ */
+
+/**
+ *
+ *  @file SharedRegisterFile.h
+ *
+ *  Defines the SharedRegisterFile class that stores the GPU register writes
+ *  issued by the Command Processor to the replicated units.
+ *
+ */
+
+#ifndef _SHAREDREGISTERFILE_
+    #define _SHAREDREGISTERFILE_
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPU.h"
+#include <deque>
+#include <vector>
+
+namespace gpu3d
+{
+
+/**
+ *
+ *  Shared Register File class.
+ *
+ *  Instead of creating and sending a register write command to each of the replicated
+ *  units (stamp pipes and texture units) the Command Processor stores the register write
+ *  once in the shared register file.  The version of the register file is the number of
+ *  register writes stored since the creation of the register file.
+ *
+ *  The commands sent to the stamp units carry the version of the register file when the
+ *  command was issued.  Before processing a command the unit reads and processes the
+ *  register writes up to that version, so the order between register writes and commands
+ *  is the same than when the register writes were sent through the command signal.
+ *
+ *  The texture units only receive register writes from the Command Processor.  They read
+ *  every cycle the register writes issued in previous cycles, the same latency than the
+ *  command signal they replace.
+ *
+ *  The shader units keep receiving commands:  the Command Processor translates the register
+ *  writes to the shaders into shader commands (program loads, constants, attributes, ...).
+ *
+ *  Each register write is tagged with the unit types that must process it.  The
+ *  register writes already read by all the units are removed from the register file.
+ *
+ */
+class SharedRegisterFile
+{
+public:
+
+    static const u32bit ZSTENCIL_UNITS = 0x01;      /**<  Register write for the Z Stencil Test units.  */
+    static const u32bit COLORWRITE_UNITS = 0x02;    /**<  Register write for the Color Write units.  */
+    static const u32bit TEXTURE_UNITS = 0x04;       /**<  Register write for the Texture Units.  */
+
+private:
+
+    static const u32bit TRIM_THRESHOLD = 1024;  /**<  Stored register writes that trigger removing the writes already read.  */
+
+    /**
+     *  Register write stored in the register file.
+     */
+    struct RegisterWrite
+    {
+        GPURegister reg;    /**<  GPU register written.  */
+        u32bit subReg;      /**<  GPU register subregister written.  */
+        GPURegData data;    /**<  Data written.  */
+        u32bit units;       /**<  Unit types that must process the register write.  */
+        u64bit cycle;       /**<  Cycle in which the register write was issued.  */
+    };
+
+    std::deque<RegisterWrite> writes;   /**<  Register writes not yet read by all the readers.  */
+    u64bit firstVersion;                /**<  Version of the first register write stored.  */
+
+    std::vector<u64bit> readerVersion;  /**<  Version up to which each reader has read the register writes.  */
+    std::vector<u32bit> readerUnits;    /**<  Unit type of each reader.  */
+
+    /**
+     *  Removes the register writes already read by all the readers.
+     */
+    void trim();
+
+public:
+
+    /**
+     *
+     *  Shared Register File constructor.
+     *
+     */
+    SharedRegisterFile();
+
+    /**
+     *
+     *  Adds a reader of the register file.
+     *
+     *  @param units Unit type of the reader.
+     *
+     *  @return The identifier of the reader.
+     *
+     */
+    u32bit addReader(u32bit units);
+
+    /**
+     *
+     *  Stores a register write.
+     *
+     *  @param cycle Cycle in which the register write is issued.
+     *  @param units Unit types that must process the register write.
+     *  @param reg GPU register written.
+     *  @param subReg GPU register subregister written.
+     *  @param data Data written.
+     *
+     */
+    void write(u64bit cycle, u32bit units, GPURegister reg, u32bit subReg, const GPURegData &data);
+
+    /**
+     *
+     *  Returns the current version of the register file.
+     *
+     */
+    inline u64bit getVersion() const
+    {
+        return firstVersion + writes.size();
+    }
+
+    /**
+     *
+     *  Reads the next register write for a reader up to a version of the register file.
+     *
+     *  @param reader Identifier of the reader.
+     *  @param version Version of the register file up to which register writes are read.
+     *  @param reg Reference to a variable where to store the GPU register written.
+     *  @param subReg Reference to a variable where to store the GPU register subregister written.
+     *  @param data Reference to a variable where to store the data written.
+     *
+     *  @return If there was a register write pending for the reader.
+     *
+     */
+    bool read(u32bit reader, u64bit version, GPURegister &reg, u32bit &subReg, GPURegData &data);
+
+    /**
+     *
+     *  Reads the next register write for a reader issued before a cycle.
+     *
+     *  @param reader Identifier of the reader.
+     *  @param cycle Current simulation cycle.  The register writes issued before this cycle are read.
+     *  @param reg Reference to a variable where to store the GPU register written.
+     *  @param subReg Reference to a variable where to store the GPU register subregister written.
+     *  @param data Reference to a variable where to store the data written.
+     *
+     *  @return If there was a register write pending for the reader.
+     *
+     */
+    bool readIssued(u32bit reader, u64bit cycle, GPURegister &reg, u32bit &subReg, GPURegData &data);
+};
+
+} // namespace gpu3d
+
+#endif  // _SHAREDREGISTERFILE_
@@ -39,7 +39,7 @@
 #include "FragmentOpEmulator.h"
 #include "DepthCompressorEmulator.h"
 #include "ColorCompressorEmulator.h"
-#include "ImageSaver.h"
+#include "FrameDumpWriter.h"
 
 using namespace gpu3d;
 
@@ -1990,36 +1990,11 @@ void DAC::startRefresh()
     state = RAST_SWAP;
 }
 
-#define GAMMA(x) f32bit(GPU_POWER(f64bit(x), f64bit(1.0f / 2.2f)))
-#define LINEAR(x) f32bit(GPU_POWER(f64bit(x), f64bit(2.2f)))
-//#define GAMMA(x) (x)
-
-//#define SAVE_AS_PNG
-
-/*  Writes the current color buffer as a ppm file.  */
+/*  Writes the current color buffer as a ppm or png file.  */
 void DAC::writeColorBuffer()
 {
     char filename[256];
 
-#ifdef SAVE_AS_PNG
-    static u8bit *data = 0;
-    static u32bit dataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (dataSize < (hRes * vRes * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (data != NULL)
-            delete[] data;
-            
-        //  Set the new buffer size.            
-        dataSize = hRes * vRes * 4;
-        
-        //  Create the new buffer.
-        data = new u8bit[dataSize];
-    }
-#endif
-
     if (lastRSCommand->getCommand() == RSCOM_DUMP_COLOR)
     {
         //  Create current frame filename.
@@ -2031,260 +2006,18 @@ void DAC::writeColorBuffer()
         sprintf(filename, "frame%04d.sim", frameCounter);
     }
 
-    
-#ifndef SAVE_AS_PNG
-    FILE *fout;
-
-    char filenamePPM[128];
-    
-    sprintf(filenamePPM, "%s.ppm", filename);
-    
-    //  Open/Create the file for the current frame.
-    fout = fopen(filenamePPM, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("DAC", "writeColorBuffer", "Error creating frame color output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.
-    fprintf(fout, "%d %d\n", hRes, vRes);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-#endif    
-
-
-    u8bit red = 255;
-    u8bit green = 255;
-    u8bit blue = 255;
-
-    //  Check if multisampling is enabled.
-    if (!multisampling)
-    {    
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes -1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        s32bit nextLine = d3d9PixelCoordinates ? +1 : -1;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (s32bit x = 0; x < s32bit(hRes); x++)
-            {
-                /**  NOTE THERE SURE ARE FASTER WAYS TO DO THIS ...  **/
-                
-                u32bit address = colorPixelMapper.computeAddress(x, y);
-                
-                //  Convert data from the color color buffer to 8-bit PPM format.
-                switch(colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        red   = colorBuffer[address];
-                        green = colorBuffer[address + 1];
-                        blue  = colorBuffer[address + 2];
-                        break;
-                        
-                    case GPU_RG16F:
-                        red   = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0])), 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2])), 0.0f), 1.0f) * 255.0f);
-                        blue  = 0;
-                        break;
-                        
-                    case GPU_R32F:
-                    
-                        red   = u8bit(GPU_MIN(GPU_MAX(*((f32bit *) &colorBuffer[address]), 0.0f), 1.0f) * 255.0f);
-                        green = 0;
-                        blue  = 0;
-                        break;
-
-                    case GPU_RGBA16:
-                        red   = u8bit(GPU_MIN(GPU_MAX((*((u16bit *) &colorBuffer[address + 0])) / 65535.0f, 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX((*((u16bit *) &colorBuffer[address + 2])) / 65535.0f, 0.0f), 1.0f) * 255.0f);
-                        blue  = u8bit(GPU_MIN(GPU_MAX((*((u16bit *) &colorBuffer[address + 4])) / 65535.0f, 0.0f), 1.0f) * 255.0f);
-                        break;
-                        
-                    case GPU_RGBA16F:
-                        red   = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0])), 0.0f), 1.0f) * 255.0f);
-                        green = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2])), 0.0f), 1.0f) * 255.0f);
-                        blue  = u8bit(GPU_MIN(GPU_MAX(GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 4])), 0.0f), 1.0f) * 255.0f);
-                        break;
-                }
-                
-                //  Write color to the file.
-#ifndef SAVE_AS_PNG                
-                fputc((char) red, fout);
-                fputc((char) green, fout);
-                fputc((char) blue, fout);
-#else                
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif                
-            }
-        }
-    }
-    else
-    {
-        QuadFloat sampleColors[MAX_MSAA_SAMPLES];
-        QuadFloat resolvedColor;
-        QuadFloat referenceColor;
-        QuadFloat currentColor;
-        
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes - 1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y >= bottom; y--)
-        {
-            for(s32bit x = 0; x < s32bit(hRes); x++)
-            {               
-                u32bit address = colorPixelMapper.computeAddress(x, y);
-
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-                
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(colorBuffer[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(colorBuffer[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(colorBuffer[address + 2]) / 255.0f;
-                        break;
-                
-                    case GPU_RG16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = 0.0f;
-                        break;
-                        
-                    case GPU_R32F:
-                        referenceColor[0] = *((f32bit *) &colorBuffer[address]);
-                        referenceColor[1] = 0.0f;
-                        referenceColor[2] = 0.0f;
-                        break;                        
-                                
-                    case GPU_RGBA16:
-                        referenceColor[0] = (*((u16bit *) &colorBuffer[address + 0])) / 65535.0f;
-                        referenceColor[1] = (*((u16bit *) &colorBuffer[address + 2])) / 65535.0f;
-                        referenceColor[2] = (*((u16bit *) &colorBuffer[address + 4])) / 65535.0f;
-                        break;
-
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 4]));
-                        break;
-                }
-                
-                bool fullCoverage = true;
+    FrameDumpSurface surface;
 
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < msaaSamples; i++)
-                {
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(colorBufferFormat)
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(colorBuffer[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(colorBuffer[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(colorBuffer[address + i * 4 + 2]) / 255.0f;
-                            break;
-                            
-                        case GPU_RG16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 2]));
-                            currentColor[2] = 0.0f;
-                            break;
-                            
-                        case GPU_R32F:
-                            currentColor[0] = *((f32bit *) &colorBuffer[address + i * 4]);
-                            currentColor[1] = 0.0f;
-                            currentColor[2] = 0.0f;
-                            break;                        
-
-                        case GPU_RGBA16:
-                            currentColor[0] = (*((u16bit *) &colorBuffer[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = (*((u16bit *) &colorBuffer[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = (*((u16bit *) &colorBuffer[address + i * 8 + 4])) / 65535.0f;
-                            break;
-                                    
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 4]));
-                            break;
-                    }
+    surface.mode = FrameDumpSurface::COLOR;
+    surface.format = colorBufferFormat;
+    surface.width = hRes;
+    surface.height = vRes;
+    surface.samples = multisampling ? msaaSamples : 1;
+    surface.d3d9PixelCoordinates = d3d9PixelCoordinates;
+    surface.pixelMapper = colorPixelMapper;
 
-                    sampleColors[i][0] = currentColor[0];
-                    sampleColors[i][1] = currentColor[1];
-                    sampleColors[i][2] = currentColor[2];
-                    
-                    resolvedColor[0] += LINEAR(currentColor[0]);
-                    resolvedColor[1] += LINEAR(currentColor[1]);
-                    resolvedColor[2] += LINEAR(currentColor[2]);
-                    
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
-                
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(referenceColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(referenceColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(referenceColor[2], 0.0f), 1.0f) * 255.0f);
-                    
-                }
-                else
-                {
-                    //  Resolve color as the average of all the sample colors.
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(msaaSamples));
-
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(resolvedColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(resolvedColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(resolvedColor[2], 0.0f), 1.0f) * 255.0f);
-                }
-
-#ifndef SAVE_AS_PNG
-                //  Write pixel color into the output file.
-                fputc(char(red)  , fout);
-                fputc(char(green), fout);
-                fputc(char(blue) , fout);
-#else   //  SAVE_AS_PNG
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif  //  SAVE_AS_PNG                    
-
-            }                    
-        }                
-    }
-    
-#ifndef SAVE_AS_PNG    
-    fclose(fout);
-#else    
-    ImageSaver::getInstance().savePNG(filename, hRes, vRes, data);
-#endif    
+    //  Convert and write the color buffer (MSAA samples are resolved).
+    FrameDumpWriter::getInstance().dump(filename, surface, colorBuffer, colorBufferSize);
 }
 
 
@@ -2293,26 +2026,6 @@ void DAC::writeDepthBuffer()
 {
     char filename[128];
 
-#ifdef SAVE_AS_PNG
-    static u8bit *data = 0;
-    static u32bit dataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (dataSize < (hRes * vRes * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (data != NULL)
-            delete[] data;
-            
-        //  Set the new buffer size.            
-        dataSize = hRes * vRes * 4;
-        
-        //  Create the new buffer.
-        data = new u8bit[dataSize];
-    }
-
-#endif
-
     if (lastRSCommand->getCommand() == RSCOM_DUMP_DEPTH)
     {
         //  Create current frame filename.
@@ -2323,256 +2036,28 @@ void DAC::writeDepthBuffer()
         //  Create current frame filename.
         sprintf(filename, "depth%04d.sim", frameCounter);
     }
-    
-#ifndef SAVE_AS_PNG
-    
-    char filenamePPM[128];
-
-    //  Add file extension.
-    sprintf(filenamePPM, "%s.ppm", filename);
-    
-    FILE *fout;
-
-    //  Open/Create the file for the current frame.
-    fout = fopen(filenamePPM, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("DAC", "writeDepthBuffer", "Error creating depth output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.  */
-    fprintf(fout, "%d %d\n", hRes, vRes);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-#endif
-
-    u8bit red = 255;
-    u8bit green = 255;
-    u8bit blue = 255;
 
     //  Check if multisampling is enabled.
-    if (!multisampling)
-    {    
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes -1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        s32bit nextLine = d3d9PixelCoordinates ? +1 : -1;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (s32bit x = 0; x < s32bit(hRes); x++)
-            {
-                //  Compute address of the pixel.
-                u32bit address = zstPixelMapper.computeAddress(x, y);
-                
-                // Invert for better reading with irfan view.
-                red   = zstBuffer[address + 2];
-                green = zstBuffer[address + 1];
-                blue  = zstBuffer[address + 0];                      
-                
-                //  Write color to the file.
-#ifndef SAVE_AS_PNG                
-                fputc((char) red, fout);
-                fputc((char) green, fout);
-                fputc((char) blue, fout);
-#else                
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif                
-            }
-        }
-    }
-    else
-    {
-    
+    if (multisampling)
         panic("DAC", "writeDepthBuffer", "Multisampling not supported.");
-        
-        QuadFloat sampleColors[MAX_MSAA_SAMPLES];
-        QuadFloat resolvedColor;
-        QuadFloat referenceColor;
-        QuadFloat currentColor;
-        
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes - 1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y >= bottom; y--)
-        {
-            for(s32bit x = 0; x < s32bit(hRes); x++)
-            {               
-                u32bit address = zstPixelMapper.computeAddress(x, y);
-
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-                
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(colorBuffer[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(colorBuffer[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(colorBuffer[address + 2]) / 255.0f;
-                        break;
-                
-                    case GPU_RG16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = 0.0f;
-                        break;
-                        
-                    case GPU_R32F:
-                        referenceColor[0] = *((f32bit *) &colorBuffer[address]);
-                        referenceColor[1] = 0.0f;
-                        referenceColor[2] = 0.0f;
-                        break;                        
-                                
-                    case GPU_RGBA16:
-                        referenceColor[0] = (*((u16bit *) &colorBuffer[address + 0])) / 65535.0f;
-                        referenceColor[1] = (*((u16bit *) &colorBuffer[address + 2])) / 65535.0f;
-                        referenceColor[2] = (*((u16bit *) &colorBuffer[address + 4])) / 65535.0f;
-                        break;
 
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 4]));
-                        break;
-                }
-                
-                bool fullCoverage = true;
+    FrameDumpSurface surface;
 
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < msaaSamples; i++)
-                {
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(colorBufferFormat)
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(colorBuffer[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(colorBuffer[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(colorBuffer[address + i * 4 + 2]) / 255.0f;
-                            break;
-                            
-                        case GPU_RG16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 2]));
-                            currentColor[2] = 0.0f;
-                            break;
-                            
-                        case GPU_R32F:
-                            currentColor[0] = *((f32bit *) &colorBuffer[address + i * 4]);
-                            currentColor[1] = 0.0f;
-                            currentColor[2] = 0.0f;
-                            break;                        
-                                    
-                        case GPU_RGBA16:
-                            currentColor[0] = (*((u16bit *) &colorBuffer[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = (*((u16bit *) &colorBuffer[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = (*((u16bit *) &colorBuffer[address + i * 8 + 4])) / 65535.0f;
-                            break;
-
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 4]));
-                            break;
-                    }
-
-                    sampleColors[i][0] = currentColor[0];
-                    sampleColors[i][1] = currentColor[1];
-                    sampleColors[i][2] = currentColor[2];
-                    
-                    resolvedColor[0] += LINEAR(currentColor[0]);
-                    resolvedColor[1] += LINEAR(currentColor[1]);
-                    resolvedColor[2] += LINEAR(currentColor[2]);
-                    
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
-                
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(referenceColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(referenceColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(referenceColor[2], 0.0f), 1.0f) * 255.0f);
-                }
-                else
-                {
-                    //  Resolve color as the average of all the sample colors.
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(msaaSamples));
-
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(resolvedColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(resolvedColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(resolvedColor[2], 0.0f), 1.0f) * 255.0f);
-                }
+    surface.mode = FrameDumpSurface::DEPTH;
+    surface.format = colorBufferFormat;
+    surface.width = hRes;
+    surface.height = vRes;
+    surface.samples = 1;
+    surface.d3d9PixelCoordinates = d3d9PixelCoordinates;
+    surface.pixelMapper = zstPixelMapper;
 
-#ifndef SAVE_AS_PNG
-                //  Write pixel color into the output file.
-                fputc(char(red)  , fout);
-                fputc(char(green), fout);
-                fputc(char(blue) , fout);
-#else   //  SAVE_AS_PNG
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif  //  SAVE_AS_PNG                    
-            }                    
-        }                
-    }
-    
-#ifndef SAVE_AS_PNG    
-    fclose(fout);
-#else    
-    ImageSaver::getInstance().savePNG(filename, hRes, vRes, data);
-#endif    
+    FrameDumpWriter::getInstance().dump(filename, surface, zstBuffer, zStencilBufferSize);
 }
 
 void DAC::writeStencilBuffer()
 {
     char filename[128];
 
-#ifdef SAVE_AS_PNG
-    static u8bit *data = 0;
-    static u32bit dataSize = 0;
-    
-    //  Check if the buffer is large enough.
-    if (dataSize < (hRes * vRes * 4))
-    {
-        //  Check if the old buffer must be deleted.
-        if (data != NULL)
-            delete[] data;
-            
-        //  Set the new buffer size.            
-        dataSize = hRes * vRes * 4;
-        
-        //  Create the new buffer.
-        data = new u8bit[dataSize];
-    }
-#endif
-
     if (lastRSCommand->getCommand() == RSCOM_DUMP_STENCIL)
     {
         //  Create current frame filename.
@@ -2583,231 +2068,22 @@ void DAC::writeStencilBuffer()
         //  Create current frame filename.
         sprintf(filename, "stencil%04d.sim", frameCounter);
     }
-    
-#ifndef SAVE_AS_PNG
-
-    FILE *fout;
-
-    char filenamePPM[128];
-
-    //  Add extension.
-    sprintf(filenamePPM, "%s.ppm", filename);
-        
-    //  Open/Create the file for the current frame.
-    fout = fopen(filenamePPM, "wb");
-
-    //  Check if the file was correctly created.
-    GPU_ASSERT(
-        if (fout == NULL)
-            panic("DAC", "writeStencilBuffer", "Error creating stencil output file.");
-    )
-
-    //  Write file header.
-
-    //  Write magic number.
-    fprintf(fout, "P6\n");
-
-    //  Write frame size.  */
-    fprintf(fout, "%d %d\n", hRes, vRes);
-
-    //  Write color component maximum value.
-    fprintf(fout, "255\n");
-
-#endif
-
-    u8bit red = 255;
-    u8bit green = 255;
-    u8bit blue = 255;
 
     //  Check if multisampling is enabled.
-    if (!multisampling)
-    {    
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes -1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        s32bit nextLine = d3d9PixelCoordinates ? +1 : -1;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y != (bottom + nextLine); y = y + nextLine)
-        {
-            for (s32bit x = 0; x < s32bit(hRes); x++)
-            {
-                //  Compute address of the pixel.
-                u32bit address = zstPixelMapper.computeAddress(x, y);
-                
-                //  Put some color to make small differences more easy to discover.
-                red   = zstBuffer[address + 3];
-                green = red & 0xF0;
-                blue  = (red & 0x0F) << 4;
-                
-#ifndef SAVE_AS_PNG                
-                fputc((char) red, fout);
-                fputc((char) green, fout);
-                fputc((char) blue, fout);
-#else                
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif                
-            }
-        }
-    }
-    else
-    {
-    
+    if (multisampling)
         panic("DAC", "writeStencilBuffer", "Multisampling not supported.");
-        
-        QuadFloat sampleColors[MAX_MSAA_SAMPLES];
-        QuadFloat resolvedColor;
-        QuadFloat referenceColor;
-        QuadFloat currentColor;
-        
-        s32bit top = d3d9PixelCoordinates ? 0 : (vRes - 1);
-        s32bit bottom = d3d9PixelCoordinates ? (vRes - 1) : 0;
-        
-        //  Do this for the whole picture now.
-        for (s32bit y = top; y >= bottom; y--)
-        {
-            for(s32bit x = 0; x < s32bit(hRes); x++)
-            {               
-                u32bit address = zstPixelMapper.computeAddress(x, y);
-
-                //  Zero resolved color.
-                resolvedColor[0] = 0.0f;
-                resolvedColor[1] = 0.0f;
-                resolvedColor[2] = 0.0f;
-                
-                //  Convert data from the color color buffer 32 bit fp internal format.
-                switch(colorBufferFormat)
-                {
-                    case GPU_RGBA8888:
-                        referenceColor[0] = f32bit(colorBuffer[address + 0]) / 255.0f;
-                        referenceColor[1] = f32bit(colorBuffer[address + 1]) / 255.0f;
-                        referenceColor[2] = f32bit(colorBuffer[address + 2]) / 255.0f;
-                        break;
-                
-                    case GPU_RG16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = 0.0f;
-                        break;
-                        
-                    case GPU_R32F:
-                        referenceColor[0] = *((f32bit *) &colorBuffer[address]);
-                        referenceColor[1] = 0.0f;
-                        referenceColor[2] = 0.0f;
-                        break;                        
-                                
-                    case GPU_RGBA16:
-                        referenceColor[0] = (*((u16bit *) &colorBuffer[address + 0])) / 65535.0f;
-                        referenceColor[1] = (*((u16bit *) &colorBuffer[address + 2])) / 65535.0f;
-                        referenceColor[2] = (*((u16bit *) &colorBuffer[address + 4])) / 65535.0f;
-                        break;
 
-                    case GPU_RGBA16F:
-                        referenceColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 0]));
-                        referenceColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 2]));
-                        referenceColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + 4]));
-                        break;
-                }
-                
-                bool fullCoverage = true;
+    FrameDumpSurface surface;
 
-                //  Accumulate the color for all the samples in the pixel
-                for(u32bit i = 0; i < msaaSamples; i++)
-                {
-                    //  Convert data from the color color buffer 32 bit fp internal format.
-                    switch(colorBufferFormat)
-                    {
-                        case GPU_RGBA8888:
-                            currentColor[0] = f32bit(colorBuffer[address + i * 4 + 0]) / 255.0f;
-                            currentColor[1] = f32bit(colorBuffer[address + i * 4 + 1]) / 255.0f;
-                            currentColor[2] = f32bit(colorBuffer[address + i * 4 + 2]) / 255.0f;
-                            break;
-                            
-                        case GPU_RG16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 4 + 2]));
-                            currentColor[2] = 0.0f;
-                            break;
-                            
-                        case GPU_R32F:
-                            currentColor[0] = *((f32bit *) &colorBuffer[address + i * 4]);
-                            currentColor[1] = 0.0f;
-                            currentColor[2] = 0.0f;
-                            break;                        
-                                    
-                        case GPU_RGBA16:
-                            currentColor[0] = (*((u16bit *) &colorBuffer[address + i * 8 + 0])) / 65535.0f;
-                            currentColor[1] = (*((u16bit *) &colorBuffer[address + i * 8 + 2])) / 65535.0f;
-                            currentColor[2] = (*((u16bit *) &colorBuffer[address + i * 8 + 4])) / 65535.0f;
-                            break;
-
-                        case GPU_RGBA16F:
-                            currentColor[0] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 0]));
-                            currentColor[1] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 2]));
-                            currentColor[2] = GPUMath::convertFP16ToFP32(*((u16bit *) &colorBuffer[address + i * 8 + 4]));
-                            break;
-                    }
+    surface.mode = FrameDumpSurface::STENCIL;
+    surface.format = colorBufferFormat;
+    surface.width = hRes;
+    surface.height = vRes;
+    surface.samples = 1;
+    surface.d3d9PixelCoordinates = d3d9PixelCoordinates;
+    surface.pixelMapper = zstPixelMapper;
 
-                    sampleColors[i][0] = currentColor[0];
-                    sampleColors[i][1] = currentColor[1];
-                    sampleColors[i][2] = currentColor[2];
-                    
-                    resolvedColor[0] += LINEAR(currentColor[0]);
-                    resolvedColor[1] += LINEAR(currentColor[1]);
-                    resolvedColor[2] += LINEAR(currentColor[2]);
-                    
-                    fullCoverage = fullCoverage && (referenceColor[0] == currentColor[0])
-                                                && (referenceColor[1] == currentColor[1])
-                                                && (referenceColor[2] == currentColor[2]);
-                }
-                
-                //  Check if there is a single sample for the pixel
-                if (fullCoverage)
-                {
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(referenceColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(referenceColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(referenceColor[2], 0.0f), 1.0f) * 255.0f);
-                }
-                else
-                {
-                    //  Resolve color as the average of all the sample colors.
-                    resolvedColor[0] = GAMMA(resolvedColor[0] / f32bit(msaaSamples));
-                    resolvedColor[1] = GAMMA(resolvedColor[1] / f32bit(msaaSamples));
-                    resolvedColor[2] = GAMMA(resolvedColor[2] / f32bit(msaaSamples));
-
-                    //  Convert from RGBA32F (internal format) to RGBA8 (PPM format)
-                    red   = u8bit(GPU_MIN(GPU_MAX(resolvedColor[0], 0.0f), 1.0f) * 255.0f);
-                    green = u8bit(GPU_MIN(GPU_MAX(resolvedColor[1], 0.0f), 1.0f) * 255.0f);
-                    blue  = u8bit(GPU_MIN(GPU_MAX(resolvedColor[2], 0.0f), 1.0f) * 255.0f);
-                }
-
-#ifndef SAVE_AS_PNG
-                //  Write pixel color into the output file.
-                fputc(char(red)  , fout);
-                fputc(char(green), fout);
-                fputc(char(blue) , fout);
-#else   //  SAVE_AS_PNG
-                u32bit yImage = d3d9PixelCoordinates ? y : (vRes - 1) - y;
-                data[(yImage * hRes + x) * 4 + 2] = red;
-                data[(yImage * hRes + x) * 4 + 1] = green;
-                data[(yImage * hRes + x) * 4 + 0] = blue;
-                //data[(yImage * hRes + x) * 4 + 3] = alpha;
-                data[(yImage * hRes + x) * 4 + 3] = 255;
-#endif  //  SAVE_AS_PNG                    
-            }                    
-        }                
-    }
-    
-#ifndef SAVE_AS_PNG    
-    fclose(fout);
-#else    
-    ImageSaver::getInstance().savePNG(filename, hRes, vRes, data);
-#endif    
+    FrameDumpWriter::getInstance().dump(filename, surface, zstBuffer, zStencilBufferSize);
 }
 
 /*  Translates an address to the start of a block into a block number.  */
@@ -231,7 +231,7 @@ private:
 
     /**
      *
-     *  Outputs the current color buffer as a PPM file.
+     *  Outputs the current color buffer as a PPM or PNG file.
      *
      */
 
@@ -239,7 +239,7 @@ private:
 
     /**
      *
-     *  Outputs the current depth buffer as a PPM file.
+     *  Outputs the current depth buffer as a PPM or PNG file.
      *
      */
 
@@ -247,7 +247,7 @@ private:
 
     /**
      *
-     *  Outputs the current stencil buffer as a PPM file.
+     *  Outputs the current stencil buffer as a PPM or PNG file.
      *
      */
 
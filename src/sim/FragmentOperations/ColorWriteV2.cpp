@@ -2783,34 +2783,15 @@ void ColorWriteV2::processRegisterWrite(GPURegister reg, u32bit subreg,
 //  Converts color data from RGBA8 format to RGBA32F format.
 void ColorWriteV2::colorRGBA8ToRGBA32F(u8bit *in, QuadFloat *out)
 {
-    u32bit i;
-
     //  Convert all pixels in the stamp.
-    for(i = 0; i < STAMP_FRAGMENTS; i++)
-    {
-        //  Convert 8 bit normalized color components to 32 bit float point color components.
-        out[i][0] = f32bit(in[i * 4]) * (1.0f / 255.0f);
-        out[i][1] = f32bit(in[i * 4 + 1]) * (1.0f / 255.0f);
-        out[i][2] = f32bit(in[i * 4 + 2]) * (1.0f / 255.0f);
-        out[i][3] = f32bit(in[i * 4 + 3]) * (1.0f / 255.0f);
-    }
-
+    FragmentOpEmulator::colorRGBA8ToRGBA32F(in, out, STAMP_FRAGMENTS);
 }
 
 //  Converts color data in RGB32F format to RGBA8 format.
 void ColorWriteV2::colorRGBA32FToRGBA8(QuadFloat *in, u8bit *out)
 {
-    u32bit i;
-
     //  Convert all pixels in the stamp.
-    for(i = 0; i < STAMP_FRAGMENTS; i++)
-    {
-        //  Convert 32bit float point color components to 8 bit normalized color components.
-        out[i * 4 + 0] = u32bit(255.0f * GPU_CLAMP(in[i][0], 0.0f, 1.0f));
-        out[i * 4 + 1] = u32bit(255.0f * GPU_CLAMP(in[i][1], 0.0f, 1.0f));
-        out[i * 4 + 2] = u32bit(255.0f * GPU_CLAMP(in[i][2], 0.0f, 1.0f));
-        out[i * 4 + 3] = u32bit(255.0f * GPU_CLAMP(in[i][3], 0.0f, 1.0f));
-    }
+    FragmentOpEmulator::colorRGBA32FToRGBA8(in, out, STAMP_FRAGMENTS);
 }
 
 //  Converts color data from RGBA16F format to RGBA32F format.
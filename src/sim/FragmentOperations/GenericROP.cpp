@@ -118,6 +118,10 @@ GenericROP::GenericROP(
             panic(ropName, ropName, "ROP operation latency must be 1 or greater.");
     )
 
+    /*  Register writes are received as commands until a shared register file is set.  */
+    sharedRegisters = NULL;
+    sharedRegistersReader = 0;
+
     /*  Create the full name and postfix for the statistics.  */
     sprintf(fullName, "%s::%s", prefix, name);
     sprintf(postfix, "%s-%s", ropShortName, prefix);
@@ -358,6 +362,9 @@ void GenericROP::clock(u64bit cycle)
             //  Receive and process a rasterizer command.
             if(rastCommand->read(cycle, (DynamicObject *&) rastComm))
             {
+                //  Process the register writes issued before the command.
+                processSharedRegisterWrites(rastComm);
+
                 //  Call the specific process command function
                 processCommand(rastComm, cycle);
             }
@@ -419,7 +426,10 @@ void GenericROP::clock(u64bit cycle)
 
             /*  Wait for end command.  */
             if (rastCommand->read(cycle, (DynamicObject *&) rastComm))
+            {
+                processSharedRegisterWrites(rastComm);
                 processCommand(rastComm, cycle);
+            }
 
             break;
 
@@ -1541,6 +1551,27 @@ void GenericROP::terminateStamp(u64bit cycle)
     }
 }
 
+//  Processes the register writes stored in the shared register file before the command.
+void GenericROP::processSharedRegisterWrites(RasterizerCommand *command)
+{
+    GPURegister reg;
+    u32bit subReg;
+    GPURegData data;
+
+    if (sharedRegisters == NULL)
+        return;
+
+    while (sharedRegisters->read(sharedRegistersReader, command->getStateVersion(), reg, subReg, data))
+        processRegisterWrite(reg, subReg, data);
+}
+
+//  Sets the shared register file.
+void GenericROP::setSharedRegisters(SharedRegisterFile *regFile, u32bit units)
+{
+    sharedRegisters = regFile;
+    sharedRegistersReader = regFile->addReader(units);
+}
+
 //  Processes a memory transaction.
 void GenericROP::processMemoryTransaction(u64bit cycle,
     MemoryTransaction *memTrans)
@@ -41,6 +41,7 @@
 #include "GPU.h"
 #include "RasterizerState.h"
 #include "RasterizerCommand.h"
+#include "SharedRegisterFile.h"
 #include "MemoryControllerDefs.h"
 #include "FragmentInput.h"
 #include "FragmentOpEmulator.h"
@@ -127,6 +128,8 @@ private:
 
     /*  Generic ROP state.  */
     MemState memoryState;       /**<  Current memory controller state.  */
+    SharedRegisterFile *sharedRegisters;    /**<  Register writes stored by the Command Processor (NULL if register writes are received as commands).  */
+    u32bit sharedRegistersReader;           /**<  Reader identifier in the shared register file.  */
     bool receivedFragment;      /**<  If a fragment has been received in the current cycle.  */
 
     /*  Generic ROP counters.  */
@@ -193,6 +196,17 @@ private:
 
     void processMemoryTransaction(u64bit cycle, MemoryTransaction *memTrans);
 
+    /**
+     *
+     *  Processes the register writes stored in the shared register file before a rasterizer command
+     *  was issued.
+     *
+     *  @param command The rasterizer command that is going to be processed.
+     *
+     */
+
+    void processSharedRegisterWrites(RasterizerCommand *command);
+
 
     /**
      *
@@ -574,6 +588,18 @@ public:
      
     void stallReport(u64bit cycle, string &stallReport);
 
+    /**
+     *
+     *  Sets the shared register file from which the register writes issued by the Command
+     *  Processor are read.
+     *
+     *  @param regFile Pointer to the shared register file.
+     *  @param units Unit type of the Generic ROP in the shared register file.
+     *
+     */
+
+    void setSharedRegisters(SharedRegisterFile *regFile, u32bit units);
+
 };
 
 } // namespace gpu3d
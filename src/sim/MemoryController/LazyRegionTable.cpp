@@ -0,0 +1,117 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ */
+
+#include "LazyRegionTable.h"
+#include "support.h"
+#include <cstring>
+
+using namespace gpu3d;
+
+LazyRegionTable::LazyRegionTable() : pending(0)
+{
+}
+
+LazyRegionTable::~LazyRegionTable()
+{
+    for (RegionMap::iterator it = regions.begin(); it != regions.end(); it++)
+        delete[] it->second.data;
+}
+
+LazyRegionTable::RegionMap::iterator LazyRegionTable::firstCandidate(u32bit address)
+{
+    //  The previous region may still extend over the start of the range.
+    RegionMap::iterator it = regions.upper_bound(address);
+    if (it != regions.begin())
+    {
+        RegionMap::iterator prev = it;
+        prev--;
+        if ((prev->first + prev->second.size) > address)
+            return prev;
+    }
+    return it;
+}
+
+void LazyRegionTable::defer(u32bit address, u32bit size, const u8bit *data)
+{
+    GPU_ASSERT(
+        if (size == 0)
+            panic("LazyRegionTable", "defer", "Region with size 0 not allowed.");
+        if (overlaps(address, size))
+            panic("LazyRegionTable", "defer", "New region overlaps with a deferred region.");
+    )
+
+    Region region;
+    region.size = size;
+    region.data = new u8bit[size];
+    memcpy(region.data, data, size);
+
+    regions.insert(std::make_pair(address, region));
+    pending += size;
+}
+
+bool LazyRegionTable::overlaps(u32bit address, u32bit size) const
+{
+    if (regions.empty())
+        return false;
+
+    RegionMap::const_iterator it = regions.upper_bound(address);
+    if (it != regions.begin())
+    {
+        RegionMap::const_iterator prev = it;
+        prev--;
+        if ((prev->first + prev->second.size) > address)
+            return true;
+    }
+    return (it != regions.end()) && (it->first < (address + size));
+}
+
+bool LazyRegionTable::extract(u32bit address, u32bit size, u32bit &regAddress, u32bit &regSize, u8bit *&regData)
+{
+    if (regions.empty())
+        return false;
+
+    RegionMap::iterator it = firstCandidate(address);
+
+    if ((it == regions.end()) || (it->first >= (address + size)))
+        return false;
+
+    regAddress = it->first;
+    regSize = it->second.size;
+    regData = it->second.data;
+
+    pending -= regSize;
+    regions.erase(it);
+
+    return true;
+}
+
+u32bit LazyRegionTable::discard(u32bit address, u32bit size)
+{
+    u32bit discarded = 0;
+
+    if (regions.empty())
+        return 0;
+
+    RegionMap::iterator it = regions.lower_bound(address);
+
+    while ((it != regions.end()) && ((it->first + it->second.size) <= (address + size)))
+    {
+        discarded += it->second.size;
+        delete[] it->second.data;
+        regions.erase(it++);
+    }
+
+    pending -= discarded;
+
+    return discarded;
+}
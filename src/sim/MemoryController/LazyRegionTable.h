@@ -0,0 +1,128 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ */
+
+#ifndef LAZYREGIONTABLE_H
+    #define LAZYREGIONTABLE_H
+
+#include "GPUTypes.h"
+#include <map>
+
+namespace gpu3d
+{
+
+/**
+ *  Table of memory regions whose contents have been received by the Memory Controller
+ *  (lazy MT_PRELOAD_DATA transactions) but that have not yet been written into memory.
+ *
+ *  The Memory Controller keeps a copy of the data for each deferred region and writes
+ *  it into memory only when a memory transaction first touches an address inside the
+ *  region (fault).  Regions completely overwritten before being touched are discarded
+ *  and their contents never reach memory.
+ *
+ *  Regions are stored ordered by start address and never overlap.
+ *
+ */
+class LazyRegionTable
+{
+public:
+
+    /**
+     *  Creates an empty lazy region table.
+     */
+    LazyRegionTable();
+
+    /**
+     *  Destroys the table and the data buffers of all the pending regions.
+     */
+    ~LazyRegionTable();
+
+    /**
+     *  Returns if there are no regions pending to be written into memory.
+     */
+    bool empty() const { return regions.empty(); }
+
+    /**
+     *  Returns the number of bytes pending to be written into memory.
+     */
+    u32bit pendingBytes() const { return pending; }
+
+    /**
+     *  Adds a new deferred region.  The data is copied into a buffer owned by the table.
+     *
+     *  @param address Start address of the region.
+     *  @param size Size in bytes of the region.
+     *  @param data Pointer to the region contents.
+     *
+     *  @note The caller must have removed (extract or discard) any region overlapping
+     *  with the new region before calling this method.
+     */
+    void defer(u32bit address, u32bit size, const u8bit *data);
+
+    /**
+     *  Returns if any deferred region overlaps with the address range.
+     *
+     *  @param address Start address of the range.
+     *  @param size Size in bytes of the range.
+     */
+    bool overlaps(u32bit address, u32bit size) const;
+
+    /**
+     *  Removes from the table the first deferred region overlapping with the address range
+     *  and returns its contents.  The caller takes ownership of the returned data buffer
+     *  (allocated with new[]).
+     *
+     *  @param address Start address of the range.
+     *  @param size Size in bytes of the range.
+     *  @param regAddress Reference to a variable where to store the start address of the region.
+     *  @param regSize Reference to a variable where to store the size of the region.
+     *  @param regData Reference to a variable where to store the pointer to the region data.
+     *
+     *  @return If a region overlapping with the range was found.
+     */
+    bool extract(u32bit address, u32bit size, u32bit &regAddress, u32bit &regSize, u8bit *&regData);
+
+    /**
+     *  Removes and deletes all the deferred regions completely covered by the address range.
+     *
+     *  @param address Start address of the range.
+     *  @param size Size in bytes of the range.
+     *
+     *  @return The number of bytes discarded.
+     */
+    u32bit discard(u32bit address, u32bit size);
+
+private:
+
+    /**
+     *  Deferred region information.
+     */
+    struct Region
+    {
+        u32bit size;    /**<  Size in bytes of the region.  */
+        u8bit *data;    /**<  Copy of the region contents.  */
+    };
+
+    typedef std::map<u32bit, Region> RegionMap;
+
+    RegionMap regions;  /**<  Deferred regions indexed by start address.  */
+    u32bit pending;     /**<  Bytes pending to be written into memory.  */
+
+    /**
+     *  Returns an iterator to the first region that could overlap with a range starting at the address.
+     */
+    RegionMap::iterator firstCandidate(u32bit address);
+};
+
+} // namespace gpu3d
+
+#endif // LAZYREGIONTABLE_H
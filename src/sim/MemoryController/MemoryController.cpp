@@ -740,6 +740,9 @@ MemoryController::MemoryController(u32bit memSize, u32bit clockMult, u32bit memF
     }
 
     preloadTrans = &getSM().getNumericStatistic("PreloadTransactions", u32bit(0), "MemoryController", "MC");
+    lazyDeferredBytes = &getSM().getNumericStatistic("LazyPreloadDeferredBytes", u32bit(0), "MemoryController", "MC");
+    lazyFaultBytes = &getSM().getNumericStatistic("LazyPreloadFaultBytes", u32bit(0), "MemoryController", "MC");
+    lazyDiscardedBytes = &getSM().getNumericStatistic("LazyPreloadDiscardedBytes", u32bit(0), "MemoryController", "MC");
     unusedCycles = &getSM().getNumericStatistic("UnusedCycles", u32bit(0), "MemoryController", "MC");
 
     dataCycles = new GPUStatistics::Statistic*[gpuMemoryBuses];
@@ -1282,6 +1285,10 @@ void MemoryController::receiveTransaction(MemoryTransaction *memTrans)
                             memTrans->getUnitID());
                     )
 
+                    /*  Write any lazy preload region that is going to be read.  */
+                    if (!lazyRegions.empty())
+                        faultLazyRegions(address, memTrans->getSize());
+
                     /*  Add to the request queue.  */
                     addRequest(memTrans);
 
@@ -1354,6 +1361,10 @@ void MemoryController::receiveTransaction(MemoryTransaction *memTrans)
                             memTrans->getUnitID());
                     )
 
+                    /*  Write any lazy preload region partially overwritten by the transaction.  */
+                    if (!lazyRegions.empty())
+                        faultLazyRegions(address, memTrans->getSize());
+
                     /*  Add to the request queue.  */
                     req = addRequest(memTrans);
 
@@ -1440,8 +1451,25 @@ void MemoryController::receiveTransaction(MemoryTransaction *memTrans)
                             panic("MemoryController", "receiveTransaction", "GPU memory operation out of range.");
                     )
 
-                    /*  Copy data to GPU memory.  */
-                    memcpy(&gpuMemory[address & SPACE_ADDRESS_MASK], data, size);
+                    /*  Lazy preload regions completely overwritten are never written into memory.  */
+                    if (!lazyRegions.empty())
+                    {
+                        lazyDiscardedBytes->inc(lazyRegions.discard(address, size));
+                        faultLazyRegions(address, size);
+                    }
+
+                    /*  Check if the data can be written into GPU memory when first accessed.  */
+                    if (memTrans->isLazy())
+                    {
+                        /*  Store the data until the region is accessed.  */
+                        lazyRegions.defer(address, size, data);
+                        lazyDeferredBytes->inc(size);
+                    }
+                    else
+                    {
+                        /*  Copy data to GPU memory.  */
+                        memcpy(&gpuMemory[address & SPACE_ADDRESS_MASK], data, size);
+                    }
                     break;
 
 
@@ -1491,6 +1519,29 @@ void MemoryController::receiveTransaction(MemoryTransaction *memTrans)
 }
 
 
+/*  Writes into GPU memory the lazy preload regions overlapping with an address range.  */
+void MemoryController::faultLazyRegions(u32bit address, u32bit size)
+{
+    u32bit regAddress;
+    u32bit regSize;
+    u8bit *regData;
+
+    while (lazyRegions.extract(address, size, regAddress, regSize, regData))
+    {
+        GPU_DEBUG_BOX(
+            printf("MemoryController => Writing lazy preload region (%x, %d).\n", regAddress, regSize);
+        )
+
+        /*  Copy the deferred data to GPU memory.  */
+        memcpy(&gpuMemory[regAddress & SPACE_ADDRESS_MASK], regData, regSize);
+
+        delete[] regData;
+
+        /*  Update statistics.  */
+        lazyFaultBytes->inc(regSize);
+    }
+}
+
 /*  Adds a new request to the request queue.  */
 u32bit MemoryController::addRequest(MemoryTransaction *memTrans)
 {
@@ -3134,6 +3185,10 @@ void MemoryController::saveMemory()
 {
     ofstream out;
 
+    //  Write all the pending lazy preload regions before dumping the GPU memory.
+    if (!lazyRegions.empty())
+        faultLazyRegions(0, gpuMemorySize);
+
     //  Open/create snapshot file for the gpu memory.
     out.open("gpumem.snapshot", ios::binary);
     
@@ -3171,6 +3226,9 @@ void MemoryController::loadMemory()
 {
     ifstream in;
 
+    //  The snapshot replaces the pending lazy preload regions.
+    lazyRegions.discard(0, gpuMemorySize);
+
     //  Open snapshot file for the gpu memory.
     in.open("gpumem.snapshot", ios::binary);
     
@@ -36,6 +36,7 @@
 #include "Box.h"
 #include "MemorySpace.h"
 #include "MemoryControllerDefs.h"
+#include "LazyRegionTable.h"
 
 namespace gpu3d
 {
@@ -168,6 +169,7 @@ private:
     /*  Memory buffers.  */
     u8bit *gpuMemory;       /**<  Pointer to the buffer where the GPU local memory is stored.  */
     u8bit *mappedMemory;    /**<  Pointer to the buffer where the mapped system memory is stored.  */
+    LazyRegionTable lazyRegions;    /**<  GPU memory regions preloaded lazily and not yet written into GPU memory.  */
 
     /**
      * Command signal from the Command Processor.
@@ -271,6 +273,9 @@ private:
     /*  Memory controller statistics.  */
     GPUStatistics::Statistic *unusedCycles;             /**<  Cycles in which the memory module is unused.  */
     GPUStatistics::Statistic *preloadTrans;             /**<  Preload transactions received.  */
+    GPUStatistics::Statistic *lazyDeferredBytes;        /**<  Bytes received with lazy preloads and not written into GPU memory.  */
+    GPUStatistics::Statistic *lazyFaultBytes;           /**<  Lazy preload bytes written into GPU memory when first accessed.  */
+    GPUStatistics::Statistic *lazyDiscardedBytes;       /**<  Lazy preload bytes overwritten before being accessed.  */
 
     /*  GPU memory statistics.  */
     GPUStatistics::Statistic **gpuBusReadBytes;         /**<  Bytes read from a GPU memory bus.  */
@@ -409,6 +414,18 @@ private:
 
     void receiveTransaction(MemoryTransaction *memTrans);
 
+    /**
+     *
+     *  Writes into GPU memory all the lazy preload regions that overlap with an
+     *  address range.  Called before a transaction accesses the range.
+     *
+     *  @param address Start address of the range.
+     *  @param size Size in bytes of the range.
+     *
+     */
+
+    void faultLazyRegions(u32bit address, u32bit size);
+
     /**
      *
      *  Tries to issue a memory transaction to a memory module.
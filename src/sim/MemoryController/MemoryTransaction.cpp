@@ -95,7 +95,7 @@ void MemoryTransaction::setBusWidth(GPUUnit unit, u32bit newBW)
 MemoryTransaction::MemoryTransaction(MemTransCom com, u32bit addr,
     u32bit sz, u8bit *dataBuffer, GPUUnit source, u32bit id) :
     command(com), address(addr), size(sz), sourceUnit(source), unitID(0), ID(id),
-    state(MS_BOTH)
+    state(MS_BOTH), lazy(false)
 {
     ++instances;
 
@@ -186,7 +186,7 @@ MemoryTransaction::MemoryTransaction(MemTransCom com, u32bit addr,
 //  Memory transaction operation for MASKED MT_WRITE_DATA
 MemoryTransaction::MemoryTransaction(u32bit addr, u32bit sz, u8bit *dataBuffer,
     u32bit *writeMask, GPUUnit source, u32bit id) :
-    address(addr), size(sz), sourceUnit(source), unitID(0), ID(id), state(MS_BOTH)
+    address(addr), size(sz), sourceUnit(source), unitID(0), ID(id), state(MS_BOTH), lazy(false)
 {
     ++instances;
 
@@ -224,7 +224,7 @@ MemoryTransaction::MemoryTransaction(u32bit addr, u32bit sz, u8bit *dataBuffer,
 MemoryTransaction::MemoryTransaction(MemTransCom com, u32bit addr,
     u32bit sz, u8bit *dataBuffer, GPUUnit source, u32bit sourceID, u32bit id) :
     unitID(sourceID), command(com), address(addr), size(sz), sourceUnit(source), ID(id),
-    state(MS_BOTH)
+    state(MS_BOTH), lazy(false)
 {
     ++instances;
 
@@ -287,7 +287,7 @@ MemoryTransaction::MemoryTransaction(MemTransCom com, u32bit addr,
 MemoryTransaction::MemoryTransaction(u32bit addr, u32bit sz, u8bit *dataBuffer,
     u32bit *writeMask, GPUUnit source, u32bit sourceID, u32bit id) :
     unitID(sourceID),
-    address(addr), size(sz), sourceUnit(source), ID(id), state(MS_BOTH)
+    address(addr), size(sz), sourceUnit(source), ID(id), state(MS_BOTH), lazy(false)
 {
     ++instances;
 
@@ -325,7 +325,7 @@ MemoryTransaction::MemoryTransaction(u32bit addr, u32bit sz, u8bit *dataBuffer,
 }
 
 // Constructor for MT_READ_DATA
-MemoryTransaction::MemoryTransaction(MemoryTransaction *request)
+MemoryTransaction::MemoryTransaction(MemoryTransaction *request) : lazy(false)
 {
     ++instances;
 
@@ -359,7 +359,7 @@ MemoryTransaction::MemoryTransaction(MemoryTransaction *request)
     setTag("memTr");
 }
 
-MemoryTransaction::MemoryTransaction(MemState memState) : state(memState)
+MemoryTransaction::MemoryTransaction(MemState memState) : state(memState), lazy(false)
 {
     ++instances;
 
@@ -465,6 +465,21 @@ u32bit MemoryTransaction::getRequestID() const
     return requestID;
 }
 
+void MemoryTransaction::setLazy(bool isLazy)
+{
+    GPU_ASSERT(
+        if (isLazy && (command != MT_PRELOAD_DATA))
+            panic("MemoryTransaction", "setLazy", "Only MT_PRELOAD_DATA transactions can be lazy.");
+    )
+
+    lazy = isLazy;
+}
+
+bool MemoryTransaction::isLazy() const
+{
+    return lazy;
+}
+
 string MemoryTransaction::toString(bool compact) const
 {
     std::stringstream ss;
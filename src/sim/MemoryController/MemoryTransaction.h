@@ -153,6 +153,13 @@ public:
     u32bit getRequestID() const;
     void setRequestID(u32bit id);
 
+    /**
+     * Marks a MT_PRELOAD_DATA transaction as lazy.  The Memory Controller defers writing
+     * the data of a lazy preload into memory until the region is first accessed.
+     */
+    void setLazy(bool isLazy);
+    bool isLazy() const;
+
     std::string getRequestSourceStr(bool compactName = false) const;
 
     bool isToSystemMemory() const;
@@ -200,6 +207,7 @@ private:
     u32bit unitID; ///< Identifies between units of the same type
     u32bit ID; ///< Transaction identifier
     u32bit requestID; ///< Request pointer/identifier for the memory transaction
+    bool lazy; ///< Preload data can be deferred until first accessed (only MT_PRELOAD_DATA)
 
 };
 
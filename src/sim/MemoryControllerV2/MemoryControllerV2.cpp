@@ -568,6 +568,11 @@ void MemoryController::createStatistics()
     // create preload transaction counter
     preloadStat = &getSM().getNumericStatistic("PreloadTransactions", u32bit(0), "MemoryController", "MC");
 
+    // create lazy preload statistics
+    lazyDeferredBytesStat = &getSM().getNumericStatistic("LazyPreloadDeferredBytes", u32bit(0), "MemoryController", "MC");
+    lazyFaultBytesStat = &getSM().getNumericStatistic("LazyPreloadFaultBytes", u32bit(0), "MemoryController", "MC");
+    lazyDiscardedBytesStat = &getSM().getNumericStatistic("LazyPreloadDiscardedBytes", u32bit(0), "MemoryController", "MC");
+
     // Create system memory statistics
     sysBusReadBytesStat = &getSM().getNumericStatistic("ReadBytesSystemBus", u32bit(0),
                                                        "MemoryController", "MC");
@@ -604,6 +609,7 @@ void MemoryController::UnitStatsGroup::initUnitStatGroup( const std::string& pre
     readServiceAccumTime = &getSM().getNumericStatistic((prefix + "serviceAccumTime").c_str(), u32bit(0), "MemoryController", "MC");
     completedReadTrans = &getSM().getNumericStatistic((prefix + "completedReadTrans").c_str(), u32bit(0), "MemoryController", "MC");
     readServiceTimeAvg = &getSM().getNumericStatistic((prefix + "serviceTimeAvg").c_str(), u32bit(0), "MemoryController", "MC");
+    readServiceTimeHist = &getSM().getHistogramStatistic((prefix + "serviceTimeHist").c_str(), "MemoryController", "MC");
 }
 
 void MemoryController::UnitChannelStatsGroup::initUnitChannelStatsGroup( const string& prefix, const string& postfix )
@@ -825,6 +831,30 @@ void MemoryController::preloadGPUMemory(MemoryTransaction* mt)
     }
 }
 
+void MemoryController::faultLazyRegions(u32bit address, u32bit size)
+{
+    u32bit regAddress;
+    u32bit regSize;
+    u8bit* regData;
+
+    while ( lazyRegions.extract(address, size, regAddress, regSize, regData) )
+    {
+        GPU_DEBUG
+        (
+            cout << "MC => Writing lazy preload region (" << hex << regAddress
+                 << "," << dec << regSize << ")" << endl;
+        )
+
+        // Write the deferred data into the DDR modules
+        MemoryTransaction mt(MT_PRELOAD_DATA, regAddress, regSize, regData, COMMANDPROCESSOR, 0);
+        preloadGPUMemory(&mt);
+
+        delete[] regData;
+
+        lazyFaultBytesStat->inc(regSize);
+    }
+}
+
 void MemoryController::updateCompletedReadStats(MemoryRequest& mr, u64bit cycle)
 {
 
@@ -842,6 +872,7 @@ void MemoryController::updateCompletedReadStats(MemoryRequest& mr, u64bit cycle)
     usg.readServiceAccumTime->inc(cycle - mr.getArrivalTime());
     usg.completedReadTrans->inc();
     usg.readServiceTimeAvg->incavg(cycle - mr.getArrivalTime());
+    usg.readServiceTimeHist->record(u32bit(cycle - mr.getArrivalTime()));
 
     // update globals per unit type if the unit is a replicated unit (ex: color write)
     if ( unitStats[unit].size() > 1 )
@@ -850,6 +881,7 @@ void MemoryController::updateCompletedReadStats(MemoryRequest& mr, u64bit cycle)
         usgGlobal.readServiceAccumTime->inc(cycle - mr.getArrivalTime());
         usgGlobal.completedReadTrans->inc();
         usgGlobal.readServiceTimeAvg->incavg(cycle - mr.getArrivalTime());
+        usgGlobal.readServiceTimeHist->record(u32bit(cycle - mr.getArrivalTime()));
     }
 
 }
@@ -924,8 +956,24 @@ void MemoryController::processMemoryTransaction(u64bit cycle, MemoryTransaction*
                         (((address & SPACE_ADDRESS_MASK) + size) > gpuMemorySize))
                         panic("MemoryController", "processMemoryTransaction", "GPU memory operation out of range.");
                 )
-                // preload DDR modules
-                preloadGPUMemory(memTrans);
+                // lazy regions completely overwritten are never written into the DDR modules
+                if ( !lazyRegions.empty() )
+                {
+                    lazyDiscardedBytesStat->inc(lazyRegions.discard(address, size));
+                    faultLazyRegions(address, size);
+                }
+
+                if ( memTrans->isLazy() )
+                {
+                    // keep the data until the region is accessed
+                    lazyRegions.defer(address, size, data);
+                    lazyDeferredBytesStat->inc(size);
+                }
+                else
+                {
+                    // preload DDR modules
+                    preloadGPUMemory(memTrans);
+                }
             }
 
             delete memTrans; // The transaction is not any more needed
@@ -968,6 +1016,10 @@ void MemoryController::processMemoryTransaction(u64bit cycle, MemoryTransaction*
 
     u32bit requestID;
 
+    // Write any lazy preload region accessed by the request
+    if ( !isSystemMemory && !lazyRegions.empty() )
+        faultLazyRegions(address, size);
+
     // Add request to the corresponding address space
     if ( isSystemMemory )
         requestID = addSystemMemoryRequest(memTrans, cycle);
@@ -2181,10 +2233,14 @@ void MemoryController::updateMemoryDomain(u64bit cycle)
 }
 
 
-void MemoryController::saveMemory() const
+void MemoryController::saveMemory()
 {
     ofstream out;
 
+    //  Write all the pending lazy preload regions before dumping the GPU memory.
+    if ( !lazyRegions.empty() )
+        faultLazyRegions(0, gpuMemorySize);
+
     //  Create snapshot file for the gpu memory.
     out.open("mcv2.gpumem.snapshot", ios::binary);
 
@@ -2222,6 +2278,9 @@ void MemoryController::loadMemory()
 {
     ifstream in;
 
+    //  The snapshot replaces the pending lazy preload regions.
+    lazyRegions.discard(0, gpuMemorySize);
+
     //  Open snapshot file for the gpu memory.
     in.open("mcv2.gpumem.snapshot", ios::binary);
 
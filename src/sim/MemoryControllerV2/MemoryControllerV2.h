@@ -20,6 +20,7 @@
 #include "ChannelScheduler.h"
 #include "DDRModule.h"
 #include "MemoryRequest.h"
+#include "LazyRegionTable.h"
 
 //  std includes
 #include <string>
@@ -197,6 +198,7 @@ private:
         GPUStatistics::Statistic* readServiceAccumTime;
         GPUStatistics::Statistic* completedReadTrans; // different from readTrans -> readTrans is computed when a request arrive to the MC
         GPUStatistics::Statistic* readServiceTimeAvg; // equivalent to readServiceAccumTime/completedReadTrans 
+        GPUStatistics::HistogramStatistic* readServiceTimeHist; // distribution of the read service time
 
         void initUnitStatGroup(const std::string& prefix);
     };
@@ -224,6 +226,11 @@ private:
     // preload transaction counter
     GPUStatistics::Statistic* preloadStat;
 
+    // lazy preload statistics (bytes deferred, written when first accessed and overwritten before any access)
+    GPUStatistics::Statistic* lazyDeferredBytesStat;
+    GPUStatistics::Statistic* lazyFaultBytesStat;
+    GPUStatistics::Statistic* lazyDiscardedBytesStat;
+
     // System memory statistics
     GPUStatistics::Statistic* sysBusReadBytesStat;
     GPUStatistics::Statistic* sysBusWriteBytesStat;
@@ -365,6 +372,8 @@ private:
     tools::Queue<MemoryRequest> serviceQueue; ///< Stores the memory read requests to be served to the GPU units
 
     u8bit* systemMemory; ///< Pointer to the buffer where the mapped system memory is stored
+
+    LazyRegionTable lazyRegions; ///< GPU memory regions preloaded lazily and not yet written into the memory modules
     u32bit systemMemorySize; ///< Amount of system memory (bytes)
 
     u32bit gpuMemorySize;
@@ -442,6 +451,10 @@ private:
     // memory modules directly (without timing overhead)
     void preloadGPUMemory(MemoryTransaction* mt);
 
+    // Writes into the memory modules the lazy preload regions that overlap
+    // with the address range (called before the range is accessed)
+    void faultLazyRegions(u32bit address, u32bit size);
+
     // System memory methods
     // Tries to issue a transaction to system memory
     void issueSystemTransaction(u64bit cycle);
@@ -498,7 +511,7 @@ public:
 
     void execCommand(stringstream &commandStream);
 
-    void saveMemory() const;
+    void saveMemory();
 
     void loadMemory();
 
@@ -266,7 +266,7 @@ GPU_TEX_TRACE(
         vertexInput = new Signal*[numVShaders];
         vertexOutput = new Signal*[numVShaders];
         vertexState = new Signal*[numVShaders];
-        vertexConsumer = new Signal*[numVShaders];
+        vertexConsumer = new TypedSignal<ConsumerState>*[numVShaders];
 
         /*  Check allocation.  */
         GPU_ASSERT(
@@ -299,7 +299,7 @@ GPU_TEX_TRACE(
             vertexState[i]->setData(defaultState);
 
             /*  Create state signal from Streamer Commit.  */
-            vertexConsumer[i] = newInputSignal("ConsumerState", 1, 1, vshPrefix[i]);
+            vertexConsumer[i] = newInputTypedSignal<ConsumerState>("ConsumerState", 1, 1, vshPrefix[i]);
         }
 
         /*  Check if triangle setup is performed in the shader.  */
@@ -341,7 +341,7 @@ GPU_TEX_TRACE(
     shaderInput = new Signal*[numFShaders];
     shaderOutput = new Signal*[numFShaders];
     shaderState = new Signal*[numFShaders];
-    ffStateShader = new Signal*[numFShaders];
+    ffStateShader = new TypedSignal<ConsumerState>*[numFShaders];
 
     /*  Check allocation.  */
     GPU_ASSERT(
@@ -368,13 +368,13 @@ GPU_TEX_TRACE(
         shaderState[i] = newInputSignal("ShaderState", 1, 1, fshPrefix[i]);
 
        /*  Create state signal to the Shader.  */
-        ffStateShader[i] = newOutputSignal("ConsumerState", 1, 1, fshPrefix[i]);
+        ffStateShader[i] = newOutputTypedSignal<ConsumerState>("ConsumerState", 1, 1, fshPrefix[i]);
 
         /*  Create default state signal value.  */
-        defaultState[0] = new ConsumerStateInfo(CONS_READY);
+        ConsumerState defaultConsumerState[1] = {CONS_READY};
 
         /*  Set default signal value.  */
-        ffStateShader[i]->setData(defaultState);
+        ffStateShader[i]->setData(defaultConsumerState);
     }
 
     /*  Create signals with the main rasterizer box.  */
@@ -745,7 +745,6 @@ void FragmentFIFO::clock(u64bit cycle)
     ROPStatusInfo *zstStateInfo;
     ROPStatusInfo *cwStateInfo;
     ShaderStateInfo *shStateInfo;
-    ConsumerStateInfo *consumerStateInfo;
     u32bit i;
     u32bit minFreeRast;
     char buffer[64];
@@ -761,11 +760,8 @@ void FragmentFIFO::clock(u64bit cycle)
         for(i = 0; i < numVShaders; i++)
         {
             /*  Read state from Streamer Commit.  */
-            if (vertexConsumer[i]->read(cycle, (DynamicObject *&) consumerStateInfo))
+            if (vertexConsumer[i]->read(cycle, consumerState[i]))
             {
-                /*  Get state.  */
-                consumerState[i] = consumerStateInfo->getState();
-
                 /*  Process last vertex sent to primitive assembly from Streamer Commit.  */
                 if (consumerState[i] == CONS_LAST_VERTEX_COMMIT)
                 {
@@ -785,10 +781,6 @@ void FragmentFIFO::clock(u64bit cycle)
                      /*  Last vertex state implicitly means ready state.  */
                      consumerState[i] = CONS_READY;
                 }
-
-
-                /*  Delete carrier object.  */
-                delete consumerStateInfo;
             }
             else
             {
@@ -1251,7 +1243,7 @@ switch(state)
     {
         /*  NOTE:  MUST BE IMPLEMENTED YET!!!!  TYPES OF STATE CARRIER ARE DIFFERENT!!   */
         /*  Send current state to the Fragment Shader.  */
-        ffStateShader[i]->write(cycle, new ConsumerStateInfo(CONS_READY));
+        ffStateShader[i]->write(cycle, CONS_READY);
     }
 
     /*  Send state to the Z Stencil Test units.  */
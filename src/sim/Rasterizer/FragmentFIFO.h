@@ -97,11 +97,11 @@ private:
     Signal **shaderInput;       /**<  Array of stamp input signal to the Shader unit.  */
     Signal **shaderOutput;      /**<  Array of stamp output signal from the Shader unit.  */
     Signal **shaderState;       /**<  Array of state signal from the Shader unit.  */
-    Signal **ffStateShader;     /**<  Array of Fragment FIFO state signals to the Shader unit.  */
+    TypedSignal<ConsumerState> **ffStateShader;     /**<  Array of Fragment FIFO state signals to the Shader unit.  */
     Signal **vertexInput;       /**<  Array of vertex input signals from Streamer Loader.  */
     Signal **vertexOutput;      /**<  Array of vertex output signals to Streamer Commit.  */
     Signal **vertexState;       /**<  Array of vertex state signals to Streamer Loader.  */
-    Signal **vertexConsumer;    /**<  Array of vertex consumer state signals from Streamer Commit.  */
+    TypedSignal<ConsumerState> **vertexConsumer;    /**<  Array of vertex consumer state signals from Streamer Commit.  */
     Signal *triangleInput;      /**<  Triangle shader input signal from Triangle Setup.  */
     Signal *triangleOutput;     /**<  Triangle shader output signal to Triangle Setup.  */
     Signal *triangleState;      /**<  Triangle shader state signal to Triangle Setup.  */
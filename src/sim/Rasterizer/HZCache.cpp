@@ -0,0 +1,207 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Hierarchical Z Cache implementation file.
+ *
+ */
+
+/**
+ *
+ *  @file HZCache.cpp
+ *
+ *  Implements the HZCache class.
+ *
+ */
+
+#include "HZCache.h"
+#include "GPUMath.h"
+
+using namespace gpu3d;
+
+/*  HZ Cache constructor.  */
+HZCache::HZCache(u32bit cacheLines, u32bit cacheLineSize, u32bit cacheWays) :
+
+    numLines(cacheLines), lineSize(cacheLineSize), numWays(cacheWays)
+
+{
+    u32bit i;
+
+    /*  Check the HZ cache associativity.  */
+    if ((numWays == 0) || (numWays > numLines) || ((numLines % numWays) != 0))
+        panic("HZCache", "HZCache", "HZ cache lines must be a multiple of the HZ cache ways.");
+
+    /*  Allocate the hz cache.  */
+    lines = new HZCacheLine[numLines];
+
+    /*  Check allocation.  */
+    GPU_ASSERT(
+        if (lines == NULL)
+            panic("HZCache", "HZCache", "Error allocation Hierarchical Z Cache.");
+    )
+
+    /*  Create the HZ Cache lines.  */
+    for(i = 0; i < numLines; i++)
+    {
+        /*  Allocate HZ Cache line z values.  */
+        lines[i].z = new u32bit[lineSize];
+
+        /*  Check allocation.  */
+        GPU_ASSERT(
+            if (lines[i].z == NULL)
+                panic("HZCache", "HZCache", "Error allocation Hierarchical Z Cache line.");
+        )
+    }
+
+    /*  Precalculate HZ cache line mask.  */
+    lineMask = ~GPUMath::buildMask(lineSize);
+
+    /*  Precalculate HZ cache line identifier shift.  */
+    lineShift = GPUMath::calculateShift(lineSize);
+
+    /*  Calculate the number of sets in the HZ cache.  */
+    numSets = numLines / numWays;
+
+    reset();
+}
+
+/*  HZ Cache destructor.  */
+HZCache::~HZCache()
+{
+    for(u32bit i = 0; i < numLines; i++)
+        delete[] lines[i].z;
+
+    delete[] lines;
+}
+
+/*  Search inside the Hierarchical Z cache for a HZ block.  */
+bool HZCache::search(u32bit block, u32bit &cacheEntry)
+{
+    u32bit first;
+    u32bit i;
+
+    /*  Get the first cache entry of the set for the block.  */
+    first = ((block >> lineShift) % numSets) * numWays;
+
+    /*  Search in the cache set for the block.  */
+    for(i = first; (i < (first + numWays)) && !(lines[i].valid && (lines[i].block == (block & lineMask))); i++);
+
+    /*  Check if block was found.  */
+    if (i < (first + numWays))
+    {
+        /*  Update cache reserve counter.  */
+        lines[i].reserves++;
+
+        /*  Update last access to the cache entry.  */
+        lines[i].lastUse = accesses++;
+
+        /*  Return the cache entry.  */
+        cacheEntry = i;
+
+        /*  Return valid block found.  */
+        return TRUE;
+    }
+
+    /*  Block not found in the cache.  */
+    return FALSE;
+}
+
+/*  Inserts a block inside the HZ cache.  */
+bool HZCache::insert(u32bit block, u32bit &cacheEntry, bool &evicted)
+{
+    u32bit first;
+    u32bit victim;
+    u32bit i;
+
+    /*  Get the first cache entry of the set for the block.  */
+    first = ((block >> lineShift) % numSets) * numWays;
+
+    /*  Search for an invalid cache entry in the set or for the least recently used unreserved cache entry.  */
+    victim = numLines;
+    for(i = first; i < (first + numWays); i++)
+    {
+        if (!lines[i].valid)
+        {
+            victim = i;
+            break;
+        }
+
+        if ((lines[i].reserves == 0) && ((victim == numLines) || (lines[i].lastUse < lines[victim].lastUse)))
+            victim = i;
+    }
+
+    /*  Check if all the cache entries in the set are reserved.  */
+    if (victim == numLines)
+    {
+        /*  No available cache entry.  */
+        evicted = FALSE;
+        return FALSE;
+    }
+
+    /*  Check if a valid cache entry is replaced.  */
+    evicted = lines[victim].valid;
+
+    /*  Set cache entry new block.  */
+    lines[victim].block = block & lineMask;
+
+    /*  Set valid bit.  */
+    lines[victim].valid = TRUE;
+
+    /*  Reset cache entry read block.  */
+    lines[victim].read = FALSE;
+
+    /*  Set cache entry reserve counter.  */
+    lines[victim].reserves = 1;
+
+    /*  Update last access to the cache entry.  */
+    lines[victim].lastUse = accesses++;
+
+    /*  Return the selected cache entry.  */
+    cacheEntry = victim;
+
+    /*  Block request insert in the HZ cache.  */
+    return TRUE;
+}
+
+/*  Returns a line of the HZ cache.  */
+HZCacheLine &HZCache::getLine(u32bit cacheEntry)
+{
+    GPU_ASSERT(
+        if (cacheEntry >= numLines)
+            panic("HZCache", "getLine", "HZ cache entry out of range.");
+    )
+
+    return lines[cacheEntry];
+}
+
+/*  Invalidates all the HZ cache lines.  */
+void HZCache::invalidate()
+{
+    for(u32bit i = 0; i < numLines; i++)
+    {
+        lines[i].block = 0;
+        lines[i].valid = FALSE;
+    }
+}
+
+/*  Resets the HZ cache.  */
+void HZCache::reset()
+{
+    for(u32bit i = 0; i < numLines; i++)
+    {
+        lines[i].block = 0;
+        lines[i].read = FALSE;
+        lines[i].valid = FALSE;
+        lines[i].reserves = 0;
+        lines[i].lastUse = 0;
+    }
+
+    accesses = 0;
+}
@@ -0,0 +1,161 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Hierarchical Z Cache definition file.
+ *
+ */
+
+/**
+ *
+ *  @file HZCache.h
+ *
+ *  Defines the HZCache class used by the Hierarchical Z box to store
+ *  lines of HZ blocks read from the Hierarchical Z Buffer.
+ *
+ */
+
+#ifndef _HZCACHE_
+
+#define _HZCACHE_
+
+#include "GPUTypes.h"
+#include "support.h"
+
+namespace gpu3d
+{
+
+/**
+ *
+ *  This structure defines a line in the Hierachical Z Buffer Cache.
+ *
+ */
+
+struct HZCacheLine
+{
+    u32bit block;       /**<  Identifier of the line of blocks stored in the cache.  */
+    u32bit *z;          /**<  The z value stored for each block in the line.  */
+    u32bit reserves;    /**<  Number of reserves for the cache entry.  */
+    u64bit lastUse;     /**<  Last access to the cache entry (for LRU replacement).  */
+    bool read;          /**<  The cache entry has received the line from the HZ buffer.  */
+    bool valid;         /**<  If the cache line is storing valid data.  */
+};
+
+/**
+ *
+ *  Hierarchical Z Cache class.
+ *
+ *  Set associative cache with the given number of lines per set (ways).  The set of a
+ *  block is selected by the line identifier of the block (block address without the
+ *  block inside the line).  A block is inserted in an invalid line of the set or replaces
+ *  the least recently used line of the set not reserved by a stamp waiting for the line.
+ *
+ */
+
+class HZCache
+{
+private:
+
+    u32bit numLines;        /**<  Number of lines in the HZ cache.  */
+    u32bit lineSize;        /**<  Number of blocks per HZ cache line.  */
+    u32bit numWays;         /**<  Number of lines per set in the HZ cache.  */
+    u32bit numSets;         /**<  Number of sets in the HZ cache.  */
+    u32bit lineMask;        /**<  Precalculated mask for the HZ cache line identifier of a block.  */
+    u32bit lineShift;       /**<  Precalculated shift for the HZ cache line identifier of a block.  */
+    HZCacheLine *lines;     /**<  HZ cache lines.  */
+    u64bit accesses;        /**<  Counter of HZ cache accesses (timestamp for LRU replacement).  */
+
+public:
+
+    /**
+     *
+     *  HZ Cache constructor.
+     *
+     *  @param cacheLines Number of lines in the HZ cache.
+     *  @param cacheLineSize Number of blocks per HZ cache line.
+     *  @param cacheWays Number of lines per set in the HZ cache.
+     *
+     *  @return A new HZ cache object.
+     *
+     */
+
+    HZCache(u32bit cacheLines, u32bit cacheLineSize, u32bit cacheWays);
+
+    /**
+     *
+     *  HZ Cache destructor.
+     *
+     */
+
+    ~HZCache();
+
+    /**
+     *
+     *  Searches the HZ cache for a HZ block.  If found the cache line is reserved.
+     *
+     *  @param block Block (address) to search in the cache.
+     *  @param cacheEntry Reference to a variable where to store which cache entry
+     *  stores the block if found inside the cache.
+     *
+     *  @return If the block was found in the HZ cache.
+     *
+     */
+
+    bool search(u32bit block, u32bit &cacheEntry);
+
+    /**
+     *
+     *  Inserts a new block in the HZ cache.  The cache line is reserved.
+     *
+     *  @param block Block (address) to insert in the HZ cache.
+     *  @param cacheEntry Reference to a variable where to store which cache entry
+     *  will store the new block.
+     *  @param evicted Reference to a variable where to store if a valid cache line
+     *  was replaced.
+     *
+     *  @return If the block could be added to the HZ cache.  Fails if all the
+     *  lines in the set are reserved.
+     *
+     */
+
+    bool insert(u32bit block, u32bit &cacheEntry, bool &evicted);
+
+    /**
+     *
+     *  Returns a line of the HZ cache.
+     *
+     *  @param cacheEntry The HZ cache entry.
+     *
+     *  @return A reference to the HZ cache line.
+     *
+     */
+
+    HZCacheLine &getLine(u32bit cacheEntry);
+
+    /**
+     *
+     *  Invalidates all the HZ cache lines.
+     *
+     */
+
+    void invalidate();
+
+    /**
+     *
+     *  Resets the HZ cache lines, reserves and access counter.
+     *
+     */
+
+    void reset();
+};
+
+} // namespace gpu3d
+
+#endif
@@ -47,7 +47,7 @@ using namespace gpu3d;
 /*  HierarchicalZ constructor.  */
 HierarchicalZ::HierarchicalZ(u32bit stampCycle, u32bit overWidth, u32bit overHeight,
     u32bit scanWidth, u32bit scanHeight, u32bit genWidth, u32bit genHeight, bool disabHZ, u32bit stampBlock,
-    u32bit hzSize, u32bit cacheLines, u32bit cacheLineSize, u32bit queueSize, u32bit hzBufferLat,
+    u32bit hzSize, u32bit cacheLines, u32bit cacheLineSize, u32bit cacheWays, u32bit queueSize, u32bit hzBufferLat,
     u32bit hzUpdateLat, u32bit clearBlocks, u32bit nStampUnits, char **suPrefixes, bool microTrisAsFrag,
     u32bit microTriSzLimit, char *name, Box *parent) :
 
@@ -55,7 +55,7 @@ HierarchicalZ::HierarchicalZ(u32bit stampCycle, u32bit overWidth, u32bit overHei
     scanH((u32bit) ceil(scanHeight / (f32bit) genHeight)),
     scanW((u32bit) ceil(scanWidth / (f32bit) genWidth)), genH(genHeight / STAMP_HEIGHT), genW(genWidth / STAMP_WIDTH),
     disableHZ(disabHZ), blockStamps(stampBlock), hzBufferSize(hzSize),
-    hzCacheLines(cacheLines), hzCacheLineSize(cacheLineSize), hzQueueSize(queueSize), hzBufferLatency(hzBufferLat),
+    hzCacheLines(cacheLines), hzCacheLineSize(cacheLineSize), hzCacheWays(cacheWays), hzQueueSize(queueSize), hzBufferLatency(hzBufferLat),
     hzUpdateLatency(hzUpdateLat), clearBlocksCycle(clearBlocks), numStampUnits(nStampUnits), 
     Box(name, parent)
 
@@ -80,6 +80,8 @@ HierarchicalZ::HierarchicalZ(u32bit stampCycle, u32bit overWidth, u32bit overHei
     cullHZ = &getSM().getNumericStatistic("CulledHZFragments", u32bit(0), "HierarchicalZ", "HZ");
     misses = &getSM().getNumericStatistic("MissesHZCache", u32bit(0), "HierarchicalZ", "HZ");
     hits = &getSM().getNumericStatistic("HitsHZCache", u32bit(0), "HierarchicalZ", "HZ");
+    evictions = &getSM().getNumericStatistic("EvictionsHZCache", u32bit(0), "HierarchicalZ", "HZ");
+    conflicts = &getSM().getNumericStatistic("ConflictsHZCache", u32bit(0), "HierarchicalZ", "HZ");
     reads = &getSM().getNumericStatistic("ReadsHZBuffer", u32bit(0), "HierarchicalZ", "HZ");
     writes = &getSM().getNumericStatistic("WritesHZBuffer", u32bit(0), "HierarchicalZ", "HZ");
 
@@ -175,8 +177,8 @@ HierarchicalZ::HierarchicalZ(u32bit stampCycle, u32bit overWidth, u32bit overHei
             panic("HierarchicalZ", "HierarchicalZ", "Error allocating Hierarchical Z Buffer Level 0.");
     )
 
-    /*  Allocate the hz cache.  */
-    hzCache = new HZCacheLine[hzCacheLines];
+    /*  Create the hz cache.  */
+    hzCache = new HZCache(hzCacheLines, hzCacheLineSize, hzCacheWays);
 
     /*  Check allocation.  */
     GPU_ASSERT(
@@ -184,19 +186,6 @@ HierarchicalZ::HierarchicalZ(u32bit stampCycle, u32bit overWidth, u32bit overHei
             panic("HierarchicalZ", "HierarchicalZ", "Error allocation Hierarchical Z Cache.");
     )
 
-    /*  Create the HZ Cache lines.  */
-    for(i = 0; i <  hzCacheLines; i++)
-    {
-        /*  Allocate HZ Cache line z values.  */
-        hzCache[i].z = new u32bit[hzCacheLineSize];
-
-        /*  Check allocation.  */
-        GPU_ASSERT(
-            if (hzCache[i].z == NULL)
-                panic("HierarchicalZ", "HierarchicalZ", "Error allocation Hierarchical Z Cache line.");
-        )
-    }
-
     /*  Allocate the stamp queue for the early z test.  */
     hzQueue = new HZQueue[hzQueueSize];
 
@@ -305,10 +294,10 @@ void HierarchicalZ::clock(u64bit cycle)
 
                 /*  Read the HZ buffer and fill the line in the HZ Cache.  */
                 for(i = 0; i < hzCacheLineSize; i++)
-                    hzCache[hzOperation->getCacheEntry()].z[i] = hzLevel0[hzOperation->getAddress() + i];
+                    hzCache->getLine(hzOperation->getCacheEntry()).z[i] = hzLevel0[hzOperation->getAddress() + i];
 
                 /*  Set hz queue entry read flag.  */
-                hzCache[hzOperation->getCacheEntry()].read = TRUE;
+                hzCache->getLine(hzOperation->getCacheEntry()).read = TRUE;
 
                 /*  Update statistics.  */
                 reads->inc();
@@ -369,12 +358,7 @@ void HierarchicalZ::clock(u64bit cycle)
             
 
             /*  Reset the HZ cache.  */
-            for(i = 0; i < hzCacheLines; i++)
-            {
-                hzCache[i].block = 0;
-                hzCache[i].read = false;
-                hzCache[i].valid = false;
-            }
+            hzCache->reset();
 
             /*  Initialize the early z test queue counters.  */
             nextFree = 0;
@@ -444,7 +428,7 @@ void HierarchicalZ::clock(u64bit cycle)
             for(i = 0; (i < stampsCycle) && (readHZQE > 0); i++)
             {
                 //  Search the stamp block in the HZ cache.  */
-                if (searchHZCache(hzQueue[nextRead].block[hzQueue[nextRead].currentBlock], cacheEntry))
+                if (hzCache->search(hzQueue[nextRead].block[hzQueue[nextRead].currentBlock], cacheEntry))
                 {
                     GPU_DEBUG_BOX(
                         printf("HierarchicalZ => Block %x for stamp at %d found at %d.\n",
@@ -481,9 +465,15 @@ void HierarchicalZ::clock(u64bit cycle)
                     //  Check if the HZ Level 0 buffer can be accessed in the current cycle.
                     if (dataBus)
                     {
+                        bool evicted;
+
                         //  Add a request to the HZ cache.
-                        if (insertHZCache(hzQueue[nextRead].block[hzQueue[nextRead].currentBlock], cacheEntry))
+                        if (hzCache->insert(hzQueue[nextRead].block[hzQueue[nextRead].currentBlock], cacheEntry, evicted))
                         {
+                            //  Update statistics.
+                            if (evicted)
+                                evictions->inc();
+
                             GPU_DEBUG_BOX(
                                 printf("HierarchicalZ => Read block %x into entry %d for stamp at %d.\n",
                                     hzQueue[nextRead].block[hzQueue[nextRead].currentBlock], cacheEntry, nextRead);
@@ -519,6 +509,11 @@ void HierarchicalZ::clock(u64bit cycle)
                             //  Only one access per cycle supported.
                             dataBus = FALSE;
                         }
+                        else
+                        {
+                            //  Update statistics.
+                            conflicts->inc();
+                        }
                     }
 
                     //  Update statistics.
@@ -592,18 +587,18 @@ void HierarchicalZ::clock(u64bit cycle)
             for(i = 0; (i < stampsCycle) && (testHZQE > 0); i++)
             {
                 //  Check if the stamp block Z has been read.
-                if (hzCache[hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]].read)
+                if (hzCache->getLine(hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]).read)
                 {                              
                     u32bit blockZ;
 
                     //  Read the block depth value from the cache.                                        
-                    blockZ = hzCache[hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]].z[hzQueue[nextTest].block[hzQueue[nextTest].currentBlock] & hzBlockMask];
+                    blockZ = hzCache->getLine(hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]).z[hzQueue[nextTest].block[hzQueue[nextTest].currentBlock] & hzBlockMask];
                     
                     //  Update block depth value for the stamp.
                     hzQueue[nextTest].blockZ = GPU_MAX(hzQueue[nextTest].blockZ, blockZ);
                     
                     //  Update cache reserve counter.
-                    hzCache[hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]].reserves--;
+                    hzCache->getLine(hzQueue[nextTest].cache[hzQueue[nextTest].currentBlock]).reserves--;
 
                     //  Update the number of stamp block values read.
                     hzQueue[nextTest].currentBlock++;
@@ -678,11 +673,7 @@ void HierarchicalZ::clock(u64bit cycle)
                     hzLevel0[i] = clearDepth & 0x00ffffff;
 
                 /*  Reset the HZ cache.  */
-                for(i = 0; i < hzCacheLines; i++)
-                {
-                    hzCache[i].block = 0;
-                    hzCache[i].valid = FALSE;
-                }
+                hzCache->invalidate();
 
                 /*  Change to end state.  */
                 state = RAST_CLEAR_END;
@@ -1454,89 +1445,6 @@ u32bit HierarchicalZ::stampBlocks(s32bit x, s32bit y, u32bit *blocks)
     }
 }
 
-/*  Search inside the Hierarchical Z cache for a HZ block.  */
-bool HierarchicalZ::searchHZCache(u32bit block, u32bit &cacheEntry)
-{
-    u32bit i;
-
-    /*  Search in the cache entry for the block.  */
-    for(i = 0; (i < hzCacheLines) && (hzCache[i].block != (block & hzLineMask)); i++);
-
-    /*  Check if block was found.  */
-    if ((i < hzCacheLines) && hzCache[i].valid)
-    {
-        /*  Update cache reserve counter.  */
-        hzCache[i].reserves++;
-
-        /*  Return the cache entry.  */
-        cacheEntry = i;
-
-        /*  Return valid block found.  */
-        return TRUE;
-    }
-
-    /*  Block not found in the cache.  */
-    return FALSE;
-}
-
-/*  Inserts a block inside the HZ cache.  */
-bool HierarchicalZ::insertHZCache(u32bit block, u32bit &cacheEntry)
-{
-    u32bit i;
-
-    /*  Search for an invalid cache entry.  */
-    for(i = 0; (i < hzCacheLines) && hzCache[i].valid; i++);
-
-    /*  Check if invalid cache entry found.  */
-    if (i < hzCacheLines)
-    {
-        /*  Set cache entry new block.  */
-        hzCache[i].block = block & hzLineMask;
-
-        /*  Set valid bit.  */
-        hzCache[i].valid = true;
-
-        /*  Reset cache entry read block.  */
-        hzCache[i].read = false;
-
-        /*  Set cache entry reserve counter.  */
-        hzCache[i].reserves = 1;
-
-        /*  Return the selected cache entry.  */
-        cacheEntry = i;
-
-        /*  Block request insert in the HZ cache.  */
-        return TRUE;
-    }
-    else
-    {
-        /*  Search for an unreserved cache entry.  */
-        for(i = 0; (i < hzCacheLines) && (hzCache[i].reserves > 0); i++);
-
-        /*  Check if unreserved cache entry was found.  */
-        if (i < hzCacheLines)
-        {
-            /*  Set cache entry new block.  */
-            hzCache[i].block = block & hzLineMask;
-
-            /*  Reset cache entry read block.  */
-            hzCache[i].read = false;
-
-            /*  Set cache entry reserve counter.  */
-            hzCache[i].reserves = 1;
-
-            /*  Return the selected cache entry.  */
-            cacheEntry = i;
-
-            /*  Block request insert in the HZ cache.  */
-            return TRUE;
-        }
-    }
-
-    /*  No available cache entry.  */
-    return FALSE;
-}
-
 /*  Performs the comparation between the fragment and hierarchical z values.  */
 bool HierarchicalZ::hzCompare(u32bit fragZ, u32bit hzZ)
 {
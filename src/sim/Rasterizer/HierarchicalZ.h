@@ -42,6 +42,7 @@
 #include "RasterizerCommand.h"
 #include "PixelMapper.h"
 #include "toolsQueue.h"
+#include "HZCache.h"
 
 namespace gpu3d
 {
@@ -58,21 +59,6 @@ enum HZState
     HZST_BUSY           /**<  The Hierarchical Z Early test can not receive new stamps.  */
 };
 
-/**
- *
- *  This structure defines a line in the Hierachical Z Buffer Cache.
- *
- */
-
-struct HZCacheLine
-{
-    u32bit block;       /**<  Identifier of the line of blocks stored in the cache.  */
-    u32bit *z;          /**<  The z value stored for each block in the line.  */
-    u32bit reserves;    /**<  Number of reserves for the cache entry.  */
-    bool read;          /**<  The cache entry has received the line from the HZ buffer.  */
-    bool valid;         /**<  If the cache line is storing valid data.  */
-};
-
 /**
  *
  *  Defines the maximum number of HZ blocks that can be required to evaluate a stamp tile.
@@ -145,6 +131,7 @@ private:
     u32bit hzBufferSize;             /**<  Size of the Hierarchical Z Buffer (number of blocks stored).  */
     u32bit hzCacheLines;             /**<  Number of lines in the fast access Hierarchical Z Buffer cache.  */
     u32bit hzCacheLineSize;          /**<  Number of blocks per HZ Cache line.  */
+    u32bit hzCacheWays;              /**<  Number of lines per set in the HZ Cache.  */
     u32bit hzQueueSize;              /**<  Size of the stamp queue for the Early test.  */
     u32bit hzBufferLatency;          /**<  Access latency to the HZ Buffer Level 0.  */
     u32bit hzUpdateLatency;          /**<  Update signal latency (from Z Stencil Test).  */
@@ -194,7 +181,7 @@ private:
 
     /*  Hierarchical Z structures.  */
     u32bit *hzLevel0;           /**<  Level 0 of the Hierachical Z buffer.  */
-    HZCacheLine *hzCache;       /**<  Hierarchical Z cache.  */
+    HZCache *hzCache;           /**<  Hierarchical Z cache.  */
     HZQueue *hzQueue;           /**<  Hierarchical Z Early Test queue.  */
     u32bit nextFree;            /**<  Next free HZ queue entry.  */
     u32bit nextRead;            /**<  Next stamp for which to read the block Z value.  */
@@ -217,6 +204,8 @@ private:
     GPUStatistics::Statistic *cullHZ;         /**<  Fragments culled by HZ test.  */
     GPUStatistics::Statistic *misses;         /**<  Misses to HZ Cache.  */
     GPUStatistics::Statistic *hits;           /**<  Hits to HZ Cache.  */
+    GPUStatistics::Statistic *evictions;      /**<  Valid HZ Cache lines replaced.  */
+    GPUStatistics::Statistic *conflicts;      /**<  HZ Cache misses that could not allocate a line (all the lines in the set reserved).  */
     GPUStatistics::Statistic *reads;          /**<  Read operations to the HZ Buffer.  */
     GPUStatistics::Statistic *writes;         /**<  Write operations to the HZ Buffer.  */
 
@@ -263,36 +252,6 @@ private:
 
     u32bit stampBlocks(s32bit x, s32bit y, u32bit *blocks);
 
-    /**
-     *
-     *  Search the Hierarchical Z Cache for a given Hierarchical Z block.
-     *
-     *  u32bit block Block (address) to search in the cache.
-     *  u32bit cacheEntry Reference to a variable where to store which
-     *  cache entry stores the block if found inside the cache.
-     *
-     *  @return If the block was found in the HZ Cache.
-     *
-     */
-
-    bool searchHZCache(u32bit block, u32bit &cacheEntry);
-
-    /**
-     *
-     *  Inserts a new block in the Hierarchical Z Cache.
-     *
-     *  @param block Block (address) to insert in the HZ Cache.
-     *  @param cacheEntry Reference to a variable where to store which
-     *  cache entry will store the new block in the HZ Cache.
-     *
-     *  @return If the block could be added to the HZ cache.
-     *  Fails if there are no free HZ cache entries.
-     *
-     */
-
-    bool insertHZCache(u32bit block, u32bit &cacheEntry);
-
-
     /**
      *
      *  Processes a rasterizer command.
@@ -349,6 +308,7 @@ public:
      *  @param hzBufferSize Size of the Hierarchical Z Buffer (number of stored blocks).
      *  @param hzCacheLines Number of lines in the Hierarchical Z Buffer cache.
      *  @param hzCacheLineSize Number of blocks in a line of the Hierarchical Z Buffer cache .
+     *  @param hzCacheWays Number of lines per set of the Hierarchical Z Buffer cache.
      *  @param hzQueueSize Size of the stamp queue for the early test.
      *  @param hzBufferLatency Access latency to the HZ Buffer level 0.
      *  @param hzUpdateLatency Update signal latency with Z Test.
@@ -366,7 +326,7 @@ public:
 
     HierarchicalZ(u32bit stampCycle, u32bit overW, u32bit overH, u32bit scanW, u32bit scanH,
         u32bit genW, u32bit genH, bool disableHZ, u32bit stampBlocks, u32bit hZBufferSize, u32bit hzCacheLines,
-        u32bit hzCacheLineSize, u32bit hzQueueSize, u32bit hzBufferLatency, u32bit hzUpdateLatency,
+        u32bit hzCacheLineSize, u32bit hzCacheWays, u32bit hzQueueSize, u32bit hzBufferLatency, u32bit hzUpdateLatency,
         u32bit clearBlocksCycle, u32bit nStampUnits, char **suPrefixes, bool microTrisAsFrag,
         u32bit microTriSzLimit, char *name, Box* parent);
 
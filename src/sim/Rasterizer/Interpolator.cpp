@@ -259,39 +259,8 @@ void Interpolator::clock(u64bit cycle)
                     attributes = new QuadFloat[MAX_FRAGMENT_ATTRIBUTES];
 
                     /*  Interpolate fragment attributes.  */
-                    for(i = 0; i < MAX_FRAGMENT_ATTRIBUTES; i++)
-                    {
-                        /*  Check if the attribute is active.  */
-                        if (fragmentAttributes[i])
-                        {
-                            /*  Check if interpolation is enabled.  */
-                            if (interpolation[i])
-                            {
-                                GPU_DEBUG_BOX(
-                                    printf("Interpolator => Interpolating fragment.\n");
-                                )
-
-                                /*  Interpolate the fragment attributes.  */
-                                //rastEmu.interpolate(frInput->getFragment(), attributes);
-                                attributes[i] = rastEmu.interpolate(frInput->getFragment(), i);
-                            }
-                            else
-                            {
-                                GPU_DEBUG_BOX(
-                                    printf("Interpolator => Copying from vertex attributes.\n");
-                                )
-
-                                /*  Copy fragment attribute from the last (third) triangle vertex.  */
-                                //rastEmu.copy(frInput->getFragment(), attributes, 0);
-                                attributes[i] = rastEmu.copy(frInput->getFragment(), i, 2);
-                            }
-                        }
-                        else
-                        {
-                            /*  Write default attribute value for non active attribute.  */
-                            DEFAULT_FRAGMENT_ATTRIBUTE(attributes[i]);
-                        }
-                    }
+                    Fragment *fragment = frInput->getFragment();
+                    rastEmu.interpolateStamp(&fragment, 1, fragmentAttributes, interpolation, &attributes);
 
                     /*  Position attribute is a special case.  */
                     attributes[POSITION_ATTRIBUTE][0] = (f32bit) frInput->getFragment()->getX();
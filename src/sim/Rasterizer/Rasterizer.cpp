@@ -42,7 +42,7 @@ Rasterizer::Rasterizer(RasterizerEmulator &rsEmu, u32bit trCycle, u32bit tsFIFOS
     bool shSetup, u32bit trShQSz, u32bit stampsPerCycle, u32bit depthSamplesCycle, u32bit overWidth, u32bit overHeight,
     u32bit scanWidth, u32bit scanHeight, u32bit genWidth, u32bit genHeight, u32bit trBatchSz, u32bit trBatchQSz,
     bool recursive, bool hzDisabled, u32bit stampsBlock, u32bit hzBufferSz, u32bit hzCacheLins,
-    u32bit hzCacheLineSz, u32bit hzQueueSz, u32bit hzBufferLat, u32bit hzUpLat, u32bit clearBCycle,
+    u32bit hzCacheLineSz, u32bit hzCacheWys, u32bit hzQueueSz, u32bit hzBufferLat, u32bit hzUpLat, u32bit clearBCycle,
     u32bit numInterpolators, u32bit shInQSz, u32bit shOutQSz, u32bit shInBSz, bool shTileDistro, bool unified,
     u32bit nVShaders, char **vshPrefix, u32bit nFShaders, char **fshPrefix, u32bit shInCycle,
     u32bit shOutCycle, u32bit thGroup, u32bit fshOutLat, u32bit vInQSz, u32bit vOutQSz,
@@ -56,7 +56,7 @@ Rasterizer::Rasterizer(RasterizerEmulator &rsEmu, u32bit trCycle, u32bit tsFIFOS
     samplesCycle(depthSamplesCycle), overH(overHeight), overW(overWidth), scanH(scanHeight), scanW(scanWidth),
     genH(genHeight), genW(genWidth), trBatchSize(trBatchSz), trBatchQueueSize(trBatchQSz), recursiveMode(recursive),
     disableHZ(hzDisabled), blockStamps(stampsBlock), hzBufferSize(hzBufferSz),
-    hzCacheLines(hzCacheLins), hzCacheLineSize(hzCacheLineSz), hzQueueSize(hzQueueSz), hzBufferLatency(hzBufferLat),
+    hzCacheLines(hzCacheLins), hzCacheLineSize(hzCacheLineSz), hzCacheWays(hzCacheWys), hzQueueSize(hzQueueSz), hzBufferLatency(hzBufferLat),
     hzUpdateLatency(hzUpLat), clearBlocksCycle(clearBCycle), interpolators(numInterpolators),
     shInputQSz(shInQSz), shOutputQSz(shOutQSz), shInputBatchSz(shInBSz), tiledShDistro(shTileDistro),
     unifiedModel(unified), numVShaders(nVShaders), numFShaders(nFShaders),
@@ -176,6 +176,7 @@ Rasterizer::Rasterizer(RasterizerEmulator &rsEmu, u32bit trCycle, u32bit tsFIFOS
         hzBufferSize,           /*  Size in block representatives of the Hierarchical Z Buffer.  */
         hzCacheLines,           /*  Hierarchical Z cache lines.  */
         hzCacheLineSize,        /*  Block info stored per HZ Cache line.  */
+        hzCacheWays,            /*  Hierarchical Z cache ways.  */
         hzQueueSize,            /*  Size of the Hierarchical Z test queue.  */
         hzBufferLatency,        /*  Access latency to the Hierarchical Z Buffer.  */
         hzUpdateLatency,        /*  Latency of the update signal from Z Stencil.  */
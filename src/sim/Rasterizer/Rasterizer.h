@@ -155,6 +155,7 @@ private:
     u32bit hzBufferSize;            /**<  Size of the Hierarchical Z Buffer (number of blocks stored).  */
     u32bit hzCacheLines;            /**<  Number of lines int the fast access Hierarchical Z Buffer cache.  */
     u32bit hzCacheLineSize;         /**<  Blocks per line of the fast access Hierarchical Z Buffer cache.  */
+    u32bit hzCacheWays;             /**<  Ways (lines per set) of the fast access Hierarchical Z Buffer cache.  */
     u32bit hzQueueSize;             /**<  Size of the stamp queue for the Early test.  */
     u32bit hzBufferLatency;         /**<  Access latency to the HZ Buffer Level 0.  */
     u32bit hzUpdateLatency;         /**<  Update signal latency from Z Stencil box.  */
@@ -249,6 +250,7 @@ public:
      *  @param hzBufferSize Size of the Hierarchical Z Buffer (number of blocks stored).
      *  @param hzCacheLines Lines in the fast access Hierarchical Z Buffer cache.
      *  @param hzCacheLineSize Blocks per line of the fast access Hierarchical Z Buffer cache.
+     *  @param hzCacheWays Ways (lines per set) of the fast access Hierarchical Z Buffer cache.
      *  @param hzQueueSize Size of the stamp queue for the Early test.
      *  @param hzBufferLatency Access latency to the HZ Buffer Level 0.
      *  @param hzUpdateLantecy Update signal latency from Z Stencil Test box.
@@ -287,7 +289,7 @@ public:
         bool shSetup, u32bit trShQSz, u32bit stampsCycle, u32bit samplesCycle, u32bit overW, u32bit overH, u32bit scanW, u32bit scanH,
         u32bit genW, u32bit genH, u32bit trBatchSize, u32bit trBatchQueueSize, bool recursive,
         bool disableHZ, u32bit blockStamps, u32bit hzBufferSize,
-        u32bit hzCacheLines, u32bit hzCacheLineSize, u32bit hzQueueSize, u32bit hzBufferLatency,
+        u32bit hzCacheLines, u32bit hzCacheLineSize, u32bit hzCacheWays, u32bit hzQueueSize, u32bit hzBufferLatency,
         u32bit hzUpdateLatency, u32bit clearBlocksCycle, u32bit interp, u32bit shInQSz, u32bit shOutQSz, u32bit shInBSz,
         bool shTileDistro, bool unified, u32bit nVShaders, char **vshPrefix, u32bit nFShaders, char **fshPrefix,
         u32bit shInCycle, u32bit shOutCycle, u32bit thGroup, u32bit fshOutLat,
@@ -39,6 +39,9 @@ RasterizerCommand::RasterizerCommand(RastComm comm)
     /*  Set the command.  */
     command = comm;
 
+    /*  No shared register file state attached.  */
+    stateVersion = 0;
+
     /*  Set color for tracing.  */
     setColor(command);
 
@@ -57,6 +60,9 @@ RasterizerCommand::RasterizerCommand(GPURegister rReg, u32bit rSubReg, GPURegDat
     subReg = rSubReg;
     data = rData;
 
+    /*  No shared register file state attached.  */
+    stateVersion = 0;
+
     /*  Set color for tracing.  */
     setColor(command);
 
@@ -87,3 +93,15 @@ GPURegData RasterizerCommand::getRegisterData()
 {
     return data;
 }
+
+/*  Sets the shared register file version.  */
+void RasterizerCommand::setStateVersion(u64bit version)
+{
+    stateVersion = version;
+}
+
+/*  Returns the shared register file version.  */
+u64bit RasterizerCommand::getStateVersion()
+{
+    return stateVersion;
+}
@@ -73,6 +73,7 @@ private:
     GPURegister reg;        /**<  The Rasterizer register to write or read.  */
     u32bit subReg;          /**<  Rasterizer register subregister to write or read.  */
     GPURegData data;        /**<  Data to write or read from the Rasterizer register.  */
+    u64bit stateVersion;    /**<  Version of the shared register file the command was issued with.  */
 
 
 public:
@@ -154,6 +155,27 @@ public:
 
     GPURegData getRegisterData();
 
+    /**
+     *
+     *  Sets the version of the shared register file when the command was issued.
+     *  The register writes up to this version must be processed before the command.
+     *
+     *  @param version Version of the shared register file.
+     *
+     */
+
+    void setStateVersion(u64bit version);
+
+    /**
+     *
+     *  Gets the version of the shared register file when the command was issued.
+     *
+     *  @return The version of the shared register file.
+     *
+     */
+
+    u64bit getStateVersion();
+
 };
 
 } // namespace gpu3d
@@ -144,6 +144,7 @@ void TriangleTraversal::clock(u64bit cycle)
     TriangleSetupOutput *tsOutput;
     TriangleSetupRequest *tsRequest;
     Fragment **stamp;
+    Fragment *emptyStamp[STAMP_FRAGMENTS];
     DynamicObject *stampCookies;
     FragmentInput *frInput;
     u32bit *triangleList;
@@ -264,10 +265,9 @@ storedTriangles, requestedTriangles, lastFragment?"T":"F");
                         /*  Check if is the last triangle in the batch.  */
                         if (triangleQueue[nextTriangle]->isLast())
                         {
-                            /*  Allocate a stamp.  */
-                            stamp = new Fragment*[STAMP_FRAGMENTS];
-
                             /*  Generate an empty stamp for the last triangle.  */
+                            stamp = emptyStamp;
+
                             for(j = 0; j < STAMP_FRAGMENTS; j++)
                                 stamp[j] = NULL;
 
@@ -435,9 +435,6 @@ storedTriangles, requestedTriangles, lastFragment?"T":"F");
                             /*  Delete stamp container.  */
                             delete stampCookies;
                         }
-
-                        /*  Delete the stamp (array of pointers to fragment).  */
-                        delete[] stamp;
                     }
                 }
             }
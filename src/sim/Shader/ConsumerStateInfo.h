@@ -23,7 +23,7 @@
 #define _CONSUMERSTATEINFO_
 
 #include "DynamicObject.h"
-#include "Streamer.h"
+#include "GPUTypes.h"
 
 namespace gpu3d
 {
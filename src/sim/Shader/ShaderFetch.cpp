@@ -135,6 +135,7 @@ ShaderFetch::ShaderFetch(ShaderEmulator &shEmu, bool unified, u32bit nThreads,
     emptyCycles = &getSM().getNumericStatistic("EmptyCycles", u32bit(0), fullName, postfix);
     fetchCycles = &getSM().getNumericStatistic("FetchCycles", u32bit(0), fullName, postfix);
     noReadyCycles = &getSM().getNumericStatistic("NoReadyCycles", u32bit(0), fullName, postfix);
+    threadLifetime = &getSM().getHistogramStatistic("ThreadLifetime", fullName, postfix);
 
     /*  Create Box Signals.  */
 
@@ -177,7 +178,7 @@ ShaderFetch::ShaderFetch(ShaderEmulator &shEmu, bool unified, u32bit nThreads,
     outputSignal = newOutputSignal("ShaderOutput", outputCycle, maxOutLatency, shPrefix);
 
     /*  Signal from the consumer to the Shader.  State of the consumer.  */
-    consumerSignal = newInputSignal("ConsumerState", 1, 1, shPrefix);
+    consumerSignal = newInputTypedSignal<ConsumerState>("ConsumerState", 1, 1, shPrefix);
 
     /*  Create and initialize the thread table.  */
     threadTable = new ThreadTable[numBuffers];
@@ -206,6 +207,7 @@ ShaderFetch::ShaderFetch(ShaderEmulator &shEmu, bool unified, u32bit nThreads,
         threadTable[i].PC = 0;
         threadTable[i].instructionCount = 0;
         threadTable[i].nextFetchCycle = 0;
+        threadTable[i].startCycle = 0;
     }
 
     /*  Allocate free thread/buffer list.  */
@@ -427,7 +429,6 @@ void ShaderFetch::clock(u64bit cycle)
     ConsumerState consumerState;
     ShaderInput *shInput;
     ShaderDecodeStateInfo *shDecStateInfo;
-    ConsumerStateInfo *consumerStateInfo;
     u32bit visited;
     u32bit i;
     u32bit j;
@@ -968,19 +969,11 @@ numFetchedGroups, numGroups);
     /*  Output Management.  */
 
     /*  Read consumer state.  This is a permament signal.  */
-    if (!consumerSignal->read(cycle, (DynamicObject *&) consumerStateInfo))
+    if (!consumerSignal->read(cycle, consumerState))
     {
         /*  No signal?  Electrons on strike!!!  So we go to strike too :).  */
         panic("ShaderFetch","clock", "No signal received from Shader consumer.");
     }
-    else
-    {
-        /*  Store consumer state.  */
-        consumerState = consumerStateInfo->getState();
-
-        /*  Delete received consumer state.  */
-        delete consumerStateInfo;
-    }
 
 
     /*  Check if there is a transmission in progress.  */
@@ -1940,6 +1933,9 @@ void ShaderFetch::processShaderInput(u64bit cycle, ShaderInput *input)
     /*  Set thread vertex.  */
     threadTable[newThread].shInput = input;
 
+    /*  Set the thread start cycle.  */
+    threadTable[newThread].startCycle = cycle;
+
 //if (cycle > 2500000)
 //printf("ShF(%p) %lld => new shader input for partition %d stored as thread %d\n",
 //    this, cycle, partition, newThread);
@@ -2533,6 +2529,7 @@ void ShaderFetch::sendOutput(u64bit cycle, u32bit outputThread)
 
     /*  Update statistics.  */
     outputs->inc();
+    threadLifetime->record(u32bit(cycle - threadTable[outputThread].startCycle));
 }
 
 //  Compute the maximum number of resources required for a new thread.
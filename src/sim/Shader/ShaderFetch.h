@@ -43,6 +43,7 @@
 #include "ShaderCommand.h"
 #include "ShaderDecodeCommand.h"
 #include "ShaderExecInstruction.h"
+#include "ConsumerStateInfo.h"
 
 namespace gpu3d
 {
@@ -65,6 +66,7 @@ struct ThreadTable
     u32bit instructionCount;    /**<  Number of executed dynamic instructions for this thread.  */
     ShaderInput *shInput;       /**<  Pointer to the thread shader input.  */
     u64bit nextFetchCycle;      /**<  Marks the next cycle this thread will be allowed to be fetched.  */
+    u64bit startCycle;          /**<  Cycle the shader input was loaded into the thread.  */
 };
 
 
@@ -96,7 +98,7 @@ private:
     Signal *newPCSignal;        /**<  New PC signal from Decode/Execute.  */
     Signal *decodeStateSignal;  /**<  Decoder state signal from Decode/Execute.  */
     Signal *outputSignal;       /**<  Shader output signal to a consumer.  */
-    Signal *consumerSignal;     /**<  Consumer readyness state to receive Shader output.  */
+    TypedSignal<ConsumerState> *consumerSignal;     /**<  Consumer readyness state to receive Shader output.  */
     Signal *shaderZExport;      /**<  Z export signal to the ShaderWorkDistributor (MicroPolygon Rasterizer).  */
 
     /*  Shader State.  */
@@ -215,6 +217,7 @@ private:
     GPUStatistics::Statistic *emptyCycles;  /**<  Counts the cycles there is no work to be done.  */
     GPUStatistics::Statistic *fetchCycles;  /**<  Counts the cycles instructions are fetched.  */
     GPUStatistics::Statistic *noReadyCycles;/**<  Counts the cycles there is no ready thread from which to fetch instructions.  */
+    GPUStatistics::HistogramStatistic *threadLifetime;  /**<  Distribution of the cycles from the shader input load to the output.  */
 
     /*  Private functions.  */
 
@@ -175,6 +175,10 @@ TextureUnit::TextureUnit(TextureEmulator &textEmu, u32bit stFrags, u32bit reqCyc
     /*  Signal from the Command Processor.  */
     commProcSignal = newInputSignal("TextureUnitCommand", 1, 1, prefix);
 
+    /*  Register writes are received as commands until a shared register file is set.  */
+    sharedRegisters = NULL;
+    sharedRegistersReader = 0;
+
     /*  Texture request signal from the Shader Decoder/Execute Box.  */
     textRequestSignal = newInputSignal("TextureRequest", requestsCycle, 1, prefix);
 
@@ -587,6 +591,9 @@ cycle, numFreeFilters, numToFilter, numFiltered);
     if (commProcSignal->read(cycle, (DynamicObject *&) command))
         processShaderCommand(cycle, command);
 
+    /*  Process the register writes issued by the Command Processor.  */
+    processSharedRegisterWrites(cycle);
+
     /*  Check if shader state is reset.  */
     if (state == SH_RESET)
     {
@@ -1619,6 +1626,27 @@ void TextureUnit::processShaderCommand(u64bit cycle, ShaderCommand *command)
 }
 
 
+/*  Processes the register writes stored in the shared register file in previous cycles.  */
+void TextureUnit::processSharedRegisterWrites(u64bit cycle)
+{
+    GPURegister reg;
+    u32bit subReg;
+    GPURegData data;
+
+    if (sharedRegisters == NULL)
+        return;
+
+    while (sharedRegisters->readIssued(sharedRegistersReader, cycle, reg, subReg, data))
+        processRegisterWrite(cycle, reg, subReg, data);
+}
+
+/*  Sets the shared register file.  */
+void TextureUnit::setSharedRegisters(SharedRegisterFile *regFile)
+{
+    sharedRegisters = regFile;
+    sharedRegistersReader = regFile->addReader(SharedRegisterFile::TEXTURE_UNITS);
+}
+
 /*  Processes a register write.  */
 void TextureUnit::processRegisterWrite(u64bit cycle, GPURegister reg, u32bit subReg, GPURegData data)
 {
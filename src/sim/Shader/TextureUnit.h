@@ -44,6 +44,7 @@
 #include "TextureCacheL2.h"
 #include "TextureRequest.h"
 #include "TextureResult.h"
+#include "SharedRegisterFile.h"
 
 //#include <fstream>
 #include "zfstream.h"
@@ -114,6 +115,9 @@ private:
     Signal *memDataSignal;      /**<  Data signal from the Memory Controller.  */
     Signal *memRequestSignal;   /**<  Request signal to the Memory Controller.  */
 
+    SharedRegisterFile *sharedRegisters;    /**<  Register writes stored by the Command Processor (NULL if register writes are received as commands).  */
+    u32bit sharedRegistersReader;           /**<  Reader identifier in the shared register file.  */
+
     /*  Texture Unit registers.  */
     bool textureEnabled[MAX_TEXTURES];      /**<  Texture unit enable flag.  */
     TextureMode textureMode[MAX_TEXTURES];  /**<  Current texture mode active in the texture unit.  */
@@ -324,6 +328,17 @@ private:
 
     void processRegisterWrite(u64bit cycle, GPURegister reg, u32bit subReg, GPURegData data);
 
+    /**
+     *
+     *  Processes the register writes stored in the shared register file by the Command Processor
+     *  in previous cycles.
+     *
+     *  @param cycle Current simulation cycle.
+     *
+     */
+
+    void processSharedRegisterWrites(u64bit cycle);
+
     /**
      *
      *  Processes a new Texture Request.
@@ -497,6 +512,17 @@ public:
      */
      
     void stallReport(u64bit cycle, string &stallReport);
+
+    /**
+     *
+     *  Sets the shared register file from which the register writes issued by the Command
+     *  Processor are read.
+     *
+     *  @param regFile Pointer to the shared register file.
+     *
+     */
+
+    void setSharedRegisters(SharedRegisterFile *regFile);
     
     /**
      *
@@ -50,7 +50,7 @@ StreamerCommit::StreamerCommit(u32bit idxCycle, u32bit oFIFOSize, u32bit omSize,
 {
     u32bit i;
     DynamicObject *defaultStreamerState[1];
-    DynamicObject *defaultConsumerState[1];
+    ConsumerState defaultConsumerState[1];
 
    /*  Check shaders and shader signals prefixes.  */
     GPU_ASSERT(
@@ -71,17 +71,17 @@ StreamerCommit::StreamerCommit(u32bit idxCycle, u32bit oFIFOSize, u32bit omSize,
     )
 
     /*  Allocate signal arrays for the shader signals.  */
-    shConsumerSignal = new Signal*[numShaders];
+    shConsumerSignal = new TypedSignal<ConsumerState>*[numShaders];
     shOutputSignal = new Signal*[numShaders];
 
     /*  Create signals from/to the shaders.  */
     for(i = 0; i < numShaders; i++)
     {
         /*  Streamer state signals to the shaders.  */
-        shConsumerSignal[i] = newOutputSignal("ConsumerState", 1, 1, shPrefixArray[i]);
+        shConsumerSignal[i] = newOutputTypedSignal<ConsumerState>("ConsumerState", 1, 1, shPrefixArray[i]);
 
         /*  Build initial signal data.  */
-        defaultConsumerState[0] = new ConsumerStateInfo(CONS_READY);
+        defaultConsumerState[0] = CONS_READY;
 
         /*  Set default streamer state signal to the shaders.  */
         shConsumerSignal[i]->setData(defaultConsumerState);
@@ -796,7 +796,7 @@ outputFIFO[nextOutput].stCCom);
         if (lastOutputSent)
         {
             /*  Send last output sent signal to Fragment FIFO.  */
-            shConsumerSignal[i]->write(cycle, new ConsumerStateInfo(CONS_LAST_VERTEX_COMMIT));
+            shConsumerSignal[i]->write(cycle, CONS_LAST_VERTEX_COMMIT);
 
             /*  Reset last output sent state.  */
             lastOutputSent = false;
@@ -804,7 +804,7 @@ outputFIFO[nextOutput].stCCom);
         else if (firstOutput)
         {
             /*  Send first output sent signal to Fragment FIFO.  */
-            shConsumerSignal[i]->write(cycle, new ConsumerStateInfo(CONS_FIRST_VERTEX_IN));
+            shConsumerSignal[i]->write(cycle, CONS_FIRST_VERTEX_IN);
 
             /*  Reset last output sent state.  */
             firstOutput = false;
@@ -812,7 +812,7 @@ outputFIFO[nextOutput].stCCom);
         else
         {
             /*  Send ready state to shaders.  */
-            shConsumerSignal[i]->write(cycle, new ConsumerStateInfo(CONS_READY)); 
+            shConsumerSignal[i]->write(cycle, CONS_READY);
         }
     }
 
@@ -42,6 +42,7 @@ namespace gpu3d
 #include "Streamer.h"
 #include "StreamerCommand.h"
 #include "StreamerControlCommand.h"
+#include "ConsumerStateInfo.h"
 
 namespace gpu3d
 {
@@ -91,7 +92,7 @@ private:
 
     /*  Streamer Commit signals.  */
     Signal **shOutputSignal;            /**<  Pointer to an array of shader output signals.  */
-    Signal **shConsumerSignal;          /**<  Pointer to an array of consumer state (streamer) signals to the Shaders.  */
+    TypedSignal<ConsumerState> **shConsumerSignal;  /**<  Pointer to an array of consumer state (streamer) signals to the Shaders.  */
     Signal *streamerCommitCommand;      /**<  Command signal from the Streamer main box.  */
     Signal *streamerCommitState;        /**<  State signal to the Streamer main box.  */
     Signal *streamerCommitNewIndex;     /**<  New index signal from the Streamer Output cache.  */
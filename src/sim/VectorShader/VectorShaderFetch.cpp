@@ -142,6 +142,7 @@ VectorShaderFetch::VectorShaderFetch(ShaderEmulator &shEmu, u32bit nThreads, u32
     emptyCycles = &getSM().getNumericStatistic("EmptyCycles", u32bit(0), fullName, postfix);
     fetchCycles = &getSM().getNumericStatistic("FetchCycles", u32bit(0), fullName, postfix);
     noReadyCycles = &getSM().getNumericStatistic("NoReadyCycles", u32bit(0), fullName, postfix);
+    threadLifetime = &getSM().getHistogramStatistic("ThreadLifetime", fullName, postfix);
 
     //  Create Box Signals.
 
@@ -174,7 +175,7 @@ VectorShaderFetch::VectorShaderFetch(ShaderEmulator &shEmu, u32bit nThreads, u32
     outputSignal = newOutputSignal("ShaderOutput", outputCycle, maxOutLatency, shPrefix);
 
     //  Signal from the consumer to the Shader.  State of the consumer.
-    consumerSignal = newInputSignal("ConsumerState", 1, 1, shPrefix);
+    consumerSignal = newInputTypedSignal<ConsumerState>("ConsumerState", 1, 1, shPrefix);
 
     //  Create and initialize the vector thread array.
     threadArray = new VectorThreadState[numThreads];
@@ -194,6 +195,7 @@ VectorShaderFetch::VectorShaderFetch(ShaderEmulator &shEmu, u32bit nThreads, u32
         threadArray[i].zexported = false;
         threadArray[i].PC = 0;
         threadArray[i].instructionCount = 0;
+        threadArray[i].startCycle = 0;
         threadArray[i].shInput = new ShaderInput*[vectorLength];
         threadArray[i].traceElement = new bool[vectorLength];
         
@@ -647,6 +649,9 @@ void VectorShaderFetch::freeVectorThread(u64bit cycle, u32bit threadID, u32bit e
         }
     )
 
+    //  Update statistics.
+    threadLifetime->record(u32bit(cycle - threadArray[threadID].startCycle));
+
     //  Clear flags of the freed vector thread array entry.  Mark the thread as free.
     threadArray[threadID].free = true;
     threadArray[threadID].end = false;
@@ -931,6 +936,7 @@ void VectorShaderFetch::reserveVectorThread(u64bit cycle, u32bit partition, u32b
 
     //  Set reserved vector thread array entry as no longer free.
     threadArray[newThread].free = false;
+    threadArray[newThread].startCycle = cycle;
 
     //  Allocate the vector thread resources.  Decrement the resource counter.
     freeResources -= requiredElementResources;
@@ -1565,23 +1571,14 @@ void VectorShaderFetch::sendOutput(u64bit cycle, u32bit threadID, u32bit element
 void VectorShaderFetch::processOutputs(u64bit cycle)
 {
     ConsumerState consumerState;
-    ConsumerStateInfo *consumerStateInfo;
     ShaderInput *shOutput;
 
     //  Read consumer state.  This is a permament signal.
-    if (!consumerSignal->read(cycle, (DynamicObject *&) consumerStateInfo))
+    if (!consumerSignal->read(cycle, consumerState))
     {
         //  No signal?  Electrons on strike!!!  So we go to strike too :).
         panic("VectorShaderFetch","clock", "No signal received from Shader consumer.");
     }
-    else
-    {
-        //  Store consumer state.
-        consumerState = consumerStateInfo->getState();
-
-        //  Delete received consumer state.
-        delete consumerStateInfo;
-    }
 
     //  Check if there is a transmission in progress.
     if (transInProgress)
@@ -38,6 +38,7 @@
 #include "ShaderCommand.h"
 #include "ShaderDecodeCommand.h"
 #include "ShaderExecInstruction.h"
+#include "ConsumerStateInfo.h"
 
 namespace gpu3d
 {
@@ -59,6 +60,7 @@ struct VectorThreadState
     u32bit instructionCount;    /**<  Number of executed dynamic instructions for this vector thread.  */
     u32bit partition;           /**<  Shader partition/target to which the vector thread is assigned (vertex, fragment, triangle).  */
     ShaderInput **shInput;      /**<  Pointer to the array of shader inputs assigned to the vector thread.  */
+    u64bit startCycle;          /**<  Cycle the vector thread was reserved.  */
     bool *traceElement;         /**<  Flag that stores if the execution of one element of the vector must be logged.  */
 };
 
@@ -96,7 +98,7 @@ private:
     Signal *newPCSignal;        /**<  New PC signal from Decode/Execute.  */
     Signal *decodeStateSignal;  /**<  Decoder state signal from Decode/Execute.  */
     Signal *outputSignal;       /**<  Shader output signal to a consumer.  */
-    Signal *consumerSignal;     /**<  Consumer readyness state to receive Shader output.  */
+    TypedSignal<ConsumerState> *consumerSignal;     /**<  Consumer readyness state to receive Shader output.  */
 
     //  Shader State.
     bool transInProgress;       /**<  Shader Output transmission in progress.  */
@@ -191,6 +193,7 @@ private:
     GPUStatistics::Statistic *emptyCycles;      /**<  Counts the cycles there is no work to be done.  */
     GPUStatistics::Statistic *fetchCycles;      /**<  Counts the cycles instructions are fetched.  */
     GPUStatistics::Statistic *noReadyCycles;    /**<  Counts the cycles there is no ready thread from which to fetch instructions.  */
+    GPUStatistics::HistogramStatistic *threadLifetime;  /**<  Distribution of the cycles from the vector thread reservation to the release.  */
 
     //  Debug/Log.
     bool traceVertex;       /**<  Flag that enables/disables a trace log for the defined vertex.  */
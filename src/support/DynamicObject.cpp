@@ -28,7 +28,11 @@ u32bit DynamicObject::nextCookie[MAX_COOKIES]; // static implies zero initializa
 
 DynamicObject::DynamicObject() : lastCookie( 0 ), color(0)
 {
-    cookies[lastCookie] = nextCookie[lastCookie]++;
+    /*  Objects may be created from more than one thread (threaded trace driver).  */
+    if ( isThreadSafe() )
+        cookies[lastCookie] = __sync_fetch_and_add(&nextCookie[lastCookie], 1);
+    else
+        cookies[lastCookie] = nextCookie[lastCookie]++;
 
     /*  Clear info field (zero string).  */
     info[0] = 0;
@@ -31,7 +31,9 @@
     #include <png.h>
 #endif
 
+#include "support.h"
 #include <cstdlib>
+#include <cstdio>
 
 namespace gpu3d
 {
@@ -131,6 +133,9 @@ void ImageSaver::savePNG(char *filename, u32bit xRes, u32bit yRes, u8bit *data)
     png_ptr = png_create_write_struct (PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     info_ptr = png_create_info_struct(png_ptr);
 
+    if ((png_ptr == NULL) || (info_ptr == NULL))
+        panic("ImageSaver", "savePNG", "Error creating the PNG encoder.");
+
     //  Add file extension.
     char filenameAux[256];
     sprintf(filenameAux, "%s.png", filename);
@@ -141,10 +146,9 @@ void ImageSaver::savePNG(char *filename, u32bit xRes, u32bit yRes, u8bit *data)
     //  Check if the file was correctly created.
     GPU_ASSERT(
         if (fout == NULL)
-            panic("bGPU-emu", "dumpFrame", "Error creating frame color output file.");
+            panic("ImageSaver", "savePNG", "Error creating PNG output file.");
     )
     
-    /*    
     png_init_io(png_ptr, fout);
     png_set_compression_level(png_ptr, 9);
     
@@ -158,13 +162,12 @@ void ImageSaver::savePNG(char *filename, u32bit xRes, u32bit yRes, u8bit *data)
     
     row_pointers = (png_byte **)malloc(yRes * sizeof(png_byte*));
 
-    for (int i = 0; i < yRes; i++)
+    for (u32bit i = 0; i < yRes; i++)
 	    row_pointers[i] = data + (xRes * 4) * i;
 
     png_write_image(png_ptr, row_pointers);
     png_write_end(png_ptr, info_ptr);
     png_destroy_write_struct(&png_ptr, &info_ptr);
-    */
     
     free(row_pointers);
 
@@ -173,6 +176,51 @@ void ImageSaver::savePNG(char *filename, u32bit xRes, u32bit yRes, u8bit *data)
 #endif    
 }
 
+void ImageSaver::savePPM(char *filename, u32bit xRes, u32bit yRes, u8bit *data)
+{
+    FILE *fout;
+
+    //  Add file extension.
+    char filenameAux[256];
+    sprintf(filenameAux, "%s.ppm", filename);
+
+    //  Open/Create the file for the current frame.
+    fout = fopen(filenameAux, "wb");
+
+    //  Check if the file was correctly created.
+    GPU_ASSERT(
+        if (fout == NULL)
+            panic("ImageSaver", "savePPM", "Error creating PPM output file.");
+    )
+
+    //  Write file header.
+
+    //  Write magic number.
+    fprintf(fout, "P6\n");
+
+    //  Write frame size.
+    fprintf(fout, "%d %d\n", xRes, yRes);
+
+    //  Write color component maximum value.
+    fprintf(fout, "255\n");
+
+    //  Convert the image from BGRA to RGB and write it with a single call.
+    u8bit *rgb = new u8bit[xRes * yRes * 3];
+
+    for (u32bit i = 0; i < (xRes * yRes); i++)
+    {
+        rgb[i * 3 + 0] = data[i * 4 + 2];
+        rgb[i * 3 + 1] = data[i * 4 + 1];
+        rgb[i * 3 + 2] = data[i * 4 + 0];
+    }
+
+    fwrite(rgb, 1, xRes * yRes * 3, fout);
+
+    delete[] rgb;
+
+    fclose(fout);
+}
+
 }   // namespace gpu3d
 
 
@@ -85,6 +85,19 @@ public:
      */
      
     void savePNG(char *filename, u32bit xRes, u32bit yRes, u8bit *data);
+
+    /**
+     *
+     *  Save image data to PPM file.
+     *
+     *  @param filename Name/path of the destination PPM file.
+     *  @param xRes Horizontal resolution in pixels of the image.
+     *  @param yRes Vertical resolution in pixels of the image.
+     *  @param data Pointer to the image data array (same format than savePNG).
+     *
+     */
+     
+    void savePPM(char *filename, u32bit xRes, u32bit yRes, u8bit *data);
     
 };
 
@@ -43,6 +43,15 @@ OptimizedDynamicMemory::Bucket OptimizedDynamicMemory::bucket[NUM_BUCKETS]; //
 bool OptimizedDynamicMemory::wasCalled = false;             // one initialize call allowed only
 u32bit OptimizedDynamicMemory::freqSize[24];
 u64bit OptimizedDynamicMemory::timeStamp = 0;
+bool OptimizedDynamicMemory::threadSafe = false;
+volatile u32bit OptimizedDynamicMemory::allocLock = 0;
+
+//  Spin lock protecting the buckets when objects are allocated or deleted from more than one thread.
+#define ACQUIRE_ALLOC_LOCK\
+    if (threadSafe) { while (__sync_lock_test_and_set(&allocLock, 1)) { while (allocLock); } }
+
+#define RELEASE_ALLOC_LOCK\
+    if (threadSafe) { __sync_lock_release(&allocLock); }
 
 using namespace std;
 using namespace gpu3d;
@@ -131,6 +140,11 @@ void OptimizedDynamicMemory::initialize( u32bit maxObjectSize1, u32bit capacity1
         freqSize[i] = 0;
 }
 
+void OptimizedDynamicMemory::setThreadSafe( bool enable )
+{
+    threadSafe = enable;
+}
+
 void* OptimizedDynamicMemory::operator new( size_t objectSize ) throw()
 {
 
@@ -142,6 +156,8 @@ void* OptimizedDynamicMemory::operator new( size_t objectSize ) throw()
     /*  Check the requested object size against the chunk ranges.  */
     b = ((objectSize + 16) <= bucket[0].ChunkSize())?0:((objectSize + 16) <= bucket[1].ChunkSize())?1:2;
 
+    ACQUIRE_ALLOC_LOCK
+
     if ((b == 2) || (bucket[b].nextFree == bucket[b].MaxObjects()))
     {
         if ( b == 2 ) 
@@ -163,6 +179,11 @@ void* OptimizedDynamicMemory::operator new( size_t objectSize ) throw()
     //printf("p %p b %d pos %d\n", p, b, bucket[b].map[bucket[b].nextFree]);
 
     bucket[b].nextFree++;
+
+    timeStamp++;
+
+    RELEASE_ALLOC_LOCK
+
     return &p[4];
 
 #else // !FAST_NEW_DELETE
@@ -192,6 +213,8 @@ void* OptimizedDynamicMemory::operator new( size_t objectSize ) throw()
         }
     }
 
+    ACQUIRE_ALLOC_LOCK
+
     // param ignored, size is fixed in initialization
     // find available map
     if ( bucket[b].nextFree == bucket[b].MaxObjects() )
@@ -211,7 +234,11 @@ void* OptimizedDynamicMemory::operator new( size_t objectSize ) throw()
 
     timeStamp++;
 
-    return &bucket[b].mem[bucket[b].map[bucket[b].nextFree++]*bucket[b].ChunkSize()]; // fast allocation ( product is a shift )
+    void *obj = &bucket[b].mem[bucket[b].map[bucket[b].nextFree++]*bucket[b].ChunkSize()]; // fast allocation ( product is a shift )
+
+    RELEASE_ALLOC_LOCK
+
+    return obj;
 
 #endif // FAST_NEW_DELETE  
 }
@@ -233,8 +260,13 @@ void OptimizedDynamicMemory::operator delete ( void* obj )
     idx = *(((u32bit*) obj) - 3);
 
     Bucket& bu = bucket[b]; // alias to avoid multiple computations of bucket[b]
+
+    ACQUIRE_ALLOC_LOCK
+
     bu.map[--bu.nextFree] = idx; // release map, new available chunk
 
+    RELEASE_ALLOC_LOCK
+
 #else // !FAST_NEW_DELETE
 
     u32bit b;
@@ -296,12 +328,16 @@ void OptimizedDynamicMemory::operator delete ( void* obj )
         }
     )
 
+    ACQUIRE_ALLOC_LOCK
+
     bucket[b].nextFree--;
 
     bucket[b].sizes[iMap] = 0; // free chunk, no consumed space then
 
     bucket[b].map[bucket[b].nextFree] = iMap; // release map, new available chunk
 
+    RELEASE_ALLOC_LOCK
+
 #endif // FAST_NEW_DELETE
     
 }
@@ -471,6 +507,11 @@ void OptimizedDynamicMemory::usage()
 #endif // FAST_NEW_DELETE
 }
 
+u64bit OptimizedDynamicMemory::getAllocations()
+{
+    return timeStamp;
+}
+
 bool OptimizedDynamicMemory::isOcupied( u32bit b, u32bit chunk )
 {
     for ( u32bit i = bucket[b].nextFree; i < bucket[b].MaxObjects(); i++ ) {
@@ -108,6 +108,8 @@ private:
     static bool wasCalled;      ///< controls that only one call to initialize is performed in the life of the class
     static u64bit timeStamp;    /**<  Timestamp counter.  */
     static u32bit freqSize[];   /**<  Stores how frequent are different object sizes (power of 2).  */
+    static bool threadSafe;     /**<  Allocations and deletions are protected with a lock.  */
+    static volatile u32bit allocLock;   /**<  Lock protecting the buckets in thread safe mode.  */
 
 
     /**
@@ -125,6 +127,11 @@ protected:
 
     void setTag(char *tag);
 
+    /**
+     * Returns if the thread safe mode is enabled
+     */
+    static bool isThreadSafe() { return threadSafe; }
+
     // Inherit classes call it implicitly, so It can not be private
     // It has an empty definition
     OptimizedDynamicMemory() {}
@@ -160,6 +167,16 @@ public:
     static void initialize( u32bit maxObjectSize1, u32bit capacity1, u32bit maxObjectSize2, u32bit capacity2,
         u32bit maxObjectSize3, u32bit capacity3 );
 
+    /**
+     * Enables or disables the thread safe mode.  Required when objects are allocated or deleted
+     * from more than one thread (e.g. the threaded trace driver).
+     *
+     * @param enable true to protect allocations and deletions with a lock
+     *
+     * @note Must be called before a second thread starts using dynamic objects.
+     */
+    static void setThreadSafe( bool enable );
+
     /**
      * Called by the compiler when new operator is used, size_t param is discarded
      *
@@ -192,6 +209,14 @@ public:
 
     static void usage();
 
+    /**
+     *
+     *  Returns the number of dynamic objects allocated since the initialization.
+     *
+     */
+
+    static u64bit getAllocations();
+
     // static void printNotDeletedObjects();
 
 };
@@ -26,9 +26,12 @@
     #include <windows.h>
     #include <sstream>
     #include <direct.h>
+    #include <psapi.h>
 #else
     #include <sys/stat.h>
     #include <sys/types.h>
+    #include <sys/time.h>
+    #include <sys/resource.h>
     #include <unistd.h>
 #endif
 #include <cstdlib>
@@ -131,6 +134,45 @@ int getCurrentDirectory(char *dirName, int arraySize)
 }
 
 
+f64bit getWallClockTime()
+{
+#ifdef WIN32
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return f64bit(counter.QuadPart) / f64bit(frequency.QuadPart);
+#else
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return f64bit(tv.tv_sec) + f64bit(tv.tv_usec) * 1e-6;
+#endif
+}
+
+u64bit getPeakMemoryUsage()
+{
+#ifdef WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return u64bit(counters.PeakWorkingSetSize) / 1024;
+    else
+        return 0;
+#else
+    struct rusage usage;
+
+    //  Linux reports the maximum resident set size in KBytes.
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return u64bit(usage.ru_maxrss);
+    else
+        return 0;
+#endif
+}
+
 unsigned int DebugTracker::refs = 0;
 
 
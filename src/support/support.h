@@ -140,6 +140,26 @@ int changeDirectory(char *dirName);
  */
  
 int getCurrentDirectory(char *dirName, int arraySize);
+
+/**
+ *
+ *  Get the host wall clock time.
+ *
+ *  @return The wall clock time in seconds with microsecond resolution.
+ *
+ */
+
+f64bit getWallClockTime();
+
+/**
+ *
+ *  Get the peak resident memory (RSS) of the process.
+ *
+ *  @return The peak resident memory of the process in KBytes, 0 if not available.
+ *
+ */
+
+u64bit getPeakMemoryUsage();
  
 #define DIRECTORY_ALREADY_EXISTS 1
 
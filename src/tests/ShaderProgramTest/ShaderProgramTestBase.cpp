@@ -59,7 +59,8 @@ ShaderProgramTestBase::ShaderProgramTestBase( const SimParameters& simP )
         simP.ras.scanWidth,             /*  Scan tile width (pixels).  */
         simP.ras.scanHeight,            /*  Scan tile height (pixels).  */
         simP.ras.genWidth,              /*  Generation tile width (pixels).  */
-        simP.ras.genHeight              /*  Generation tile height (pixels).  */
+        simP.ras.genHeight,             /*  Generation tile height (pixels).  */
+        simP.fsh.samplerKernels         /*  Use the specialized texel conversions.  */
         );
 
     //  Create the shader emulator object.
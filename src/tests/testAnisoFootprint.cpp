@@ -0,0 +1,895 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Anisotropic footprint test.
+ *
+ */
+
+/**
+ *
+ *  @file testAnisoFootprint.cpp
+ *
+ *  Checks that the anisotropic footprints computed by the texture emulator (footprint cache
+ *  and SSE2 or scalar footprint math, depending on the build) are bit identical to the
+ *  footprints computed by the previous implementation.  The previous footprint code
+ *  (calculateScale2D, computeAnisoSamples and the five anisotropy algorithms, with a scalar
+ *  square root and division per value) and the previous per sample texel coordinate code
+ *  (texelCoord2D applying the anisotropic offset of the sample to each coordinate) are
+ *  reproduced below as the reference.
+ *
+ *  For each quad the number of anisotropic samples, the per sample offsets, the lod and the
+ *  mipmaps of each fragment, and the texel coordinates, texel addresses (previous
+ *  texel2address computing the log2 of the mipmap width for each texel) and bilinear weights
+ *  of each anisotropic sample in both mipmaps must match the reference.
+ *
+ *  All the anisotropy algorithms are tested with different maximum anisotropies, sample
+ *  rounding modes and power of two and non power of two texture sizes.  The quads have
+ *  random anisotropic derivatives, repeated by consecutive quads to use the footprint cache,
+ *  and isotropic, axis aligned, degenerate (non finite footprint) and magnified footprints.
+ *
+ *  Usage: testAnisoFootprint [quads per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "TextureEmulator.h"
+#include "GPUMath.h"
+#include "OptimizedDynamicMemory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+using namespace gpu3d;
+
+#ifndef GPU_SIGN
+    #define GPU_SIGN(x) (((x) >= 0)?1:-1)
+#endif
+
+//  Reference footprint:  previous implementation of the anisotropic footprint.
+class ReferenceFootprint
+{
+private:
+
+    u32bit algorithm;
+    bool anisoRatioMultOfTwo;
+    f32bit anisoRoundUp;
+
+    u32bit computeAnisoSamples(f32bit anisoRatio)
+    {
+        u32bit samples;
+
+        if (anisoRatioMultOfTwo)
+        {
+            f32bit diffToMult2 = 2 - (f32bit(((u32bit(GPU_FLOOR(anisoRatio)) & 0xfffffffe) + 2)) - anisoRatio);
+
+            if (diffToMult2 > anisoRoundUp)
+                samples = (u32bit(GPU_FLOOR(anisoRatio)) & 0xfffffffe) + 2;
+            else
+                samples = (u32bit(GPU_FLOOR(anisoRatio)) & 0xfffffffe);
+        }
+        else
+        {
+            f32bit fracRatio = anisoRatio - f32bit(GPU_FLOOR(anisoRatio));
+
+            if (fracRatio > anisoRoundUp)
+                samples = u32bit(GPU_CEIL(anisoRatio));
+            else
+                samples = u32bit(GPU_FLOOR(anisoRatio));
+        }
+
+        return GPU_MAX(samples, u32bit(1));
+    }
+
+    f32bit anisoTwoAxis(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy,
+        u32bit maxAniso, u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit scale;
+        f32bit px;
+        f32bit py;
+        f32bit pMin;
+        f32bit pMax;
+        f32bit N;
+        TextureAccess::AnisotropyAxis axis;
+
+        px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
+        py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+
+        pMin = GPU_MIN(px, py);
+        pMax = GPU_MAX(px, py);
+
+        N = GPU_MIN(pMax/pMin, f32bit(maxAniso));
+
+        if (pMax == px)
+            axis = TextureAccess::X_AXIS;
+        else
+            axis = TextureAccess::Y_AXIS;
+
+        samples = computeAnisoSamples(N);
+
+        scale = pMax / N;
+
+        switch(axis)
+        {
+            case TextureAccess::X_AXIS:
+                dsOffset = dudx / f32bit(samples + 1);
+                dtOffset = dvdx / f32bit(samples + 1);
+                break;
+            default:
+                dsOffset = dudy / f32bit(samples + 1);
+                dtOffset = dvdy / f32bit(samples + 1);
+                break;
+        }
+
+        return scale;
+    }
+
+    f32bit anisoFourAxis(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy,
+        u32bit maxAniso, u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit scale;
+        f32bit px;
+        f32bit py;
+        f32bit pxy;
+        f32bit pyx;
+        f32bit pMin;
+        f32bit pMax;
+        f32bit N;
+        f32bit pMin2;
+        f32bit pMax2;
+        f32bit N2;
+        TextureAccess::AnisotropyAxis axis;
+
+        px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
+        py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+
+        pxy = (f32bit) GPU_SQRT((dudx + dudy) * (dudx + dudy) * 0.5 + (dvdx + dvdy) * (dvdx + dvdy) * 0.5);
+        pyx = (f32bit) GPU_SQRT((dudx - dudy) * (dudx - dudy) * 0.5 + (dvdx - dvdy) * (dvdx - dvdy) * 0.5);
+
+        pMin = GPU_MIN(px, py);
+        pMax = GPU_MAX(px, py);
+
+        N = GPU_MIN(pMax/pMin, f32bit(maxAniso));
+
+        pMin2 = GPU_MIN(pxy, pyx);
+        pMax2 = GPU_MAX(pxy, pyx);
+
+        N2 = GPU_MIN(pMax2/pMin2, f32bit(maxAniso));
+
+        if (N >= N2)
+        {
+            if (pMax == px)
+                axis = TextureAccess::X_AXIS;
+            else
+                axis = TextureAccess::Y_AXIS;
+
+            samples = computeAnisoSamples(N);
+
+            scale = pMax / N;
+        }
+        else
+        {
+            if (pMax2 == pxy)
+                axis = TextureAccess::XY_AXIS;
+            else
+                axis = TextureAccess::YX_AXIS;
+
+            samples = computeAnisoSamples(N2);
+
+            scale = pMax2 / N2;
+        }
+
+        switch(axis)
+        {
+            case TextureAccess::X_AXIS:
+                dsOffset = dudx / f32bit(samples + 1);
+                dtOffset = dvdx / f32bit(samples + 1);
+                break;
+            case TextureAccess::Y_AXIS:
+                dsOffset = dudy / f32bit(samples + 1);
+                dtOffset = dvdy / f32bit(samples + 1);
+                break;
+            case TextureAccess::XY_AXIS:
+                dsOffset = ((dudx + dudy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                dtOffset = ((dvdx + dvdy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                break;
+            case TextureAccess::YX_AXIS:
+                dsOffset = ((dudx - dudy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                dtOffset = ((dvdx - dvdy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                break;
+        }
+
+        return scale;
+    }
+
+    f32bit anisoRectangle(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy,
+        u32bit maxAniso, u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit scale;
+        f32bit pMinA;
+        f32bit pMaxA;
+        f32bit NA;
+        f32bit ratioA;
+        f32bit pMinB;
+        f32bit pMaxB;
+        f32bit NB;
+        f32bit ratioB;
+        f32bit axis1A[2];
+        f32bit axis2A[2];
+        f32bit axis1B[2];
+        f32bit axis2B[2];
+        f32bit diag1[2];
+        f32bit diag2[2];
+        f32bit l1A;
+        f32bit l2A;
+        f32bit l1B;
+        f32bit l2B;
+        f32bit lA;
+        f32bit lB;
+        f32bit N;
+
+        l1A = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
+        l2A = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+
+        diag1[0] = (dudx + dudy) / (f32bit) GPU_SQRT(2);
+        diag1[1] = (dvdx + dvdy) / (f32bit) GPU_SQRT(2);
+        diag2[0] = (dudx - dudy) / (f32bit) GPU_SQRT(2);
+        diag2[1] = (dvdx - dvdy) / (f32bit) GPU_SQRT(2);
+
+        l1B = (f32bit) GPU_SQRT(diag1[0] * diag1[0] + diag1[1] * diag1[1]);
+        l2B = (f32bit) GPU_SQRT(diag2[0] * diag2[0] + diag2[1] * diag2[1]);
+
+        if (l1A >= l2A)
+        {
+            axis1A[0] = dudx / l1A;
+            axis1A[1] = dvdx / l1A;
+            axis2A[0] = -axis1A[1];
+            axis2A[1] = axis1A[0];
+            ratioA = l1A/l2A;
+            lA = l1A;
+            pMaxA = l1A + GPU_ABS(dudy * axis1A[0] + dvdy * axis1A[1]);
+            pMinA = GPU_ABS(dudy * axis2A[0] + dvdy * axis2A[1]);
+        }
+        else
+        {
+            axis1A[0] = dudy / l2A;
+            axis1A[1] = dvdy / l2A;
+            axis2A[0] = -axis1A[1];
+            axis2A[1] = axis1A[0];
+            ratioA = l2A/l1A;
+            lA = l2A;
+            pMaxA = l2A + GPU_ABS(dudx * axis1A[0] + dvdx * axis1A[1]);
+            pMinA = GPU_ABS(dudx * axis2A[0] + dvdx * axis2A[1]);
+        }
+
+        if (l1B >= l2B)
+        {
+            axis1B[0] = diag1[0]/l1B;
+            axis1B[1] = diag1[1]/l1B;
+            ratioB = l1B/l2B;
+            axis2B[0] = -axis1B[1];
+            axis2B[1] = axis1B[0];
+            lB = l1B;
+            pMaxB = l1B + GPU_ABS(diag2[0] * axis1B[0] + diag2[1] * axis1B[1]);
+            pMinB = GPU_ABS(diag2[0] * axis2B[0] + diag2[1] * axis2B[1]);
+        }
+        else
+        {
+            axis1B[0] = diag2[0]/l2B;
+            axis1B[1] = diag2[1]/l2B;
+            axis2B[0] = -axis1B[1];
+            axis2B[1] = axis1B[0];
+            ratioB = l2B/l1B;
+            lB = l2B;
+            pMaxB = l2B + GPU_ABS(diag1[0] * axis1B[0] + diag1[1] * axis1B[1]);
+            pMinB = GPU_ABS(diag1[0] * axis2B[0] + diag1[1] * axis2B[1]);
+        }
+
+        NA = GPU_MIN(pMaxA/pMinA, f32bit(maxAniso));
+        NB = GPU_MIN(pMaxB/pMinB, f32bit(maxAniso));
+
+        N = GPU_MAX(NA, NB);
+
+        if (ratioA >= ratioB)
+        {
+            samples = computeAnisoSamples(N);
+            scale = lA / N;
+            dsOffset = (axis1A[0] * lA) / f32bit(samples + 1);
+            dtOffset = (axis1A[1] * lA) / f32bit(samples + 1);
+        }
+        else
+        {
+            samples = computeAnisoSamples(N);
+            scale = lB / N;
+            dsOffset = (axis1B[0] * lB) / f32bit(samples + 1);
+            dtOffset = (axis1B[1] * lB) / f32bit(samples + 1);
+        }
+
+        if (!(finite(scale) && finite(dsOffset) && finite(dtOffset)))
+        {
+            samples = 1;
+            scale = static_cast<f32bit>(GPU_MAX(GPU_SQRT(dudx * dudx + dvdx * dvdx), GPU_SQRT(dudy * dudy + dvdy * dvdy)));
+            dsOffset = 0.0f;
+            dtOffset = 0.0f;
+        }
+
+        return scale;
+    }
+
+    f32bit anisoEWA(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy,
+        u32bit maxAniso, u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit A;
+        f32bit B;
+        f32bit C;
+        f32bit F;
+        f32bit p;
+        f32bit t;
+        f32bit q;
+        f32bit axis1[2];
+        f32bit axis2[2];
+        f32bit l1;
+        f32bit l2;
+        f32bit scale;
+        f32bit N;
+
+        A = dvdx * dvdx + dvdy * dvdy;
+        B = -2.0f * (dudx * dvdx + dudy * dvdy);
+        C = dudx * dudx + dudy * dudy;
+        F = (dudx * dvdy - dudy * dvdx) * (dudx * dvdy - dudy * dvdx);
+
+        A = A/F;
+        B = B/F;
+        C = C/F;
+
+        p = A - C;
+        q = A + C;
+        t = GPU_SIGN(p) * (f32bit) GPU_SQRT(p * p + B * B);
+
+        if (t == 0.0f)
+        {
+            axis1[0] = 1.0f / (f32bit) GPU_SQRT(A);
+            axis1[1] = 0.0f;
+            axis2[0] = 0.0f;
+            axis2[1] = 1.0f / (f32bit) GPU_SQRT(A);
+        }
+        else
+        {
+            axis1[0] = (f32bit) GPU_SQRT((t + p) / (t * (q + t)));
+            axis1[1] = GPU_SIGN(B * p) * (f32bit) GPU_SQRT((t - p) / (t * (q + t)));
+
+            axis2[0] = -1.0f * GPU_SIGN(B * p) * (f32bit) GPU_SQRT((t - p) / (t * (q - t)));
+            axis2[1] = (f32bit) GPU_SQRT((t + p) / (t * (q - t)));
+        }
+
+        l1 = (f32bit) GPU_SQRT(axis1[0] * axis1[0] + axis1[1] * axis1[1]);
+        l2 = (f32bit) GPU_SQRT(axis2[0] * axis2[0] + axis2[1] * axis2[1]);
+
+        if (l1 > l2)
+        {
+            N = l1 / l2;
+            N = GPU_MIN(N, f32bit(maxAniso));
+            samples = computeAnisoSamples(N);
+            scale = l1 / N;
+            dsOffset = axis1[0] / f32bit(samples + 1);
+            dtOffset = axis1[1] / f32bit(samples + 1);
+        }
+        else
+        {
+            N = l2 / l1;
+            N = GPU_MIN(N, f32bit(maxAniso));
+            samples = computeAnisoSamples(N);
+            scale = l2 / N;
+            dsOffset = axis2[0] / f32bit(samples + 1);
+            dtOffset = axis2[1] / f32bit(samples + 1);
+        }
+
+        if (!(finite(scale) && finite(dsOffset) && finite(dtOffset)))
+        {
+            samples = 1;
+            scale = static_cast<f32bit>(GPU_MAX(GPU_SQRT(dudx * dudx + dvdx * dvdx), GPU_SQRT(dudy * dudy + dvdy * dvdy)));
+            dsOffset = 0.0f;
+            dtOffset = 0.0f;
+        }
+
+        return scale;
+    }
+
+    f32bit anisoExperimentalAngle(f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy, u32bit maxAniso,
+        u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit scale;
+        f32bit px;
+        f32bit py;
+        f32bit pxy;
+        f32bit pyx;
+        f32bit pMin;
+        f32bit pMax;
+        f32bit N;
+        f32bit pMin2;
+        f32bit pMax2;
+        f32bit N2;
+        f32bit adjustedMajorLength1;
+        f32bit adjustedMinorLength1;
+        f32bit adjustedMajorLength2;
+        f32bit adjustedMinorLength2;
+        f32bit newN1;
+        f32bit newN2;
+        f32bit factor;
+        f32bit vectorA[2];
+        f32bit vectorB[2];
+        TextureAccess::AnisotropyAxis axis;
+
+        px = (f32bit) GPU_SQRT(dudx * dudx + dvdx * dvdx);
+        py = (f32bit) GPU_SQRT(dudy * dudy + dvdy * dvdy);
+
+        pxy = (f32bit) GPU_SQRT((dudx + dudy) * (dudx + dudy) * 0.5 + (dvdx + dvdy) * (dvdx + dvdy) * 0.5);
+        pyx = (f32bit) GPU_SQRT((dudx - dudy) * (dudx - dudy) * 0.5 + (dvdx - dvdy) * (dvdx - dvdy) * 0.5);
+
+        pMin = GPU_MIN(px, py);
+        pMax = GPU_MAX(px, py);
+
+        N = GPU_MIN(pMax/pMin, f32bit(maxAniso));
+
+        pMin2 = GPU_MIN(pxy, pyx);
+        pMax2 = GPU_MAX(pxy, pyx);
+
+        N2 = GPU_MIN(pMax2/pMin2, f32bit(maxAniso));
+
+        vectorA[0] = dudx;
+        vectorA[1] = dvdx;
+        vectorB[0] = dudy;
+        vectorB[1] = dvdy;
+
+        factor = vectorA[0] * vectorB[0] + vectorA[1] * vectorB[1];
+
+        adjustedMajorLength1 = GPU_ABS(factor) / pMax + pMax;
+        adjustedMinorLength1 = pMin * GPU_ABS( (f32bit) GPU_SQRT(1 - (factor / (pMin * pMax) * (factor / (pMin * pMax)))));
+
+        newN1 = GPU_MIN(adjustedMajorLength1 / adjustedMinorLength1, f32bit(maxAniso));
+
+        vectorA[0] = (dudx + dudy) / (f32bit) GPU_SQRT(2.0f);
+        vectorA[1] = (dvdx + dvdy) / (f32bit) GPU_SQRT(2.0f);
+        vectorB[0] = (dudx - dudy) / (f32bit) GPU_SQRT(2.0f);
+        vectorB[1] = (dvdx - dvdy) / (f32bit) GPU_SQRT(2.0f);
+
+        factor = vectorA[0] * vectorB[0] + vectorA[1] * vectorB[1];
+
+        adjustedMajorLength2 = GPU_ABS(factor) / pMax2 + pMax2;
+        adjustedMinorLength2 = pMin2 * GPU_ABS((f32bit) GPU_SQRT(1 - (factor / (pMin2 * pMax2) * (factor / (pMin2 * pMax2)))));
+
+        newN2 = GPU_MIN(adjustedMajorLength2 / adjustedMinorLength2, f32bit(maxAniso));
+
+        if (N > N2)
+        {
+            if (pMax == px)
+                axis = TextureAccess::X_AXIS;
+            else
+                axis = TextureAccess::Y_AXIS;
+
+            samples = computeAnisoSamples(N);
+
+            scale = pMax / newN1;
+        }
+        else
+        {
+            if (pMax2 == pxy)
+                axis = TextureAccess::XY_AXIS;
+            else
+                axis = TextureAccess::YX_AXIS;
+
+            samples = computeAnisoSamples(N2);
+
+            scale = pMax2 / newN2;
+        }
+
+        switch(axis)
+        {
+            case TextureAccess::X_AXIS:
+                dsOffset = dudx / f32bit(samples + 1);
+                dtOffset = dvdx / f32bit(samples + 1);
+                break;
+            case TextureAccess::Y_AXIS:
+                dsOffset = dudy / f32bit(samples + 1);
+                dtOffset = dvdy / f32bit(samples + 1);
+                break;
+            case TextureAccess::XY_AXIS:
+                dsOffset = ((dudx + dudy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                dtOffset = ((dvdx + dvdy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                break;
+            case TextureAccess::YX_AXIS:
+                dsOffset = ((dudx - dudy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                dtOffset = ((dvdx - dvdy) / (f32bit) GPU_SQRT(2)) / f32bit(samples + 1);
+                break;
+        }
+
+        if (!(finite(scale) && finite(dsOffset) && finite(dtOffset)))
+        {
+            samples = 1;
+            scale = static_cast<f32bit>(GPU_MAX(GPU_SQRT(dudx * dudx + dvdx * dvdx), GPU_SQRT(dudy * dudy + dvdy * dvdy)));
+            dsOffset = 0.0f;
+            dtOffset = 0.0f;
+        }
+
+        return scale;
+    }
+
+public:
+
+    ReferenceFootprint(u32bit algorithm, bool multOfTwo, u32bit roundPrecision, u32bit roundThreshold) :
+        algorithm(algorithm), anisoRatioMultOfTwo(multOfTwo)
+    {
+        anisoRoundUp = f32bit(roundThreshold) / f32bit(u64bit(1) << roundPrecision);
+
+        if (anisoRatioMultOfTwo)
+            anisoRoundUp = 2.0f * anisoRoundUp;
+    }
+
+    //  Anisotropic branch of calculateScale2D.
+    f32bit calculateScale2D(u32bit width, u32bit height, f32bit dudx, f32bit dudy, f32bit dvdx, f32bit dvdy, u32bit maxAniso,
+        u32bit &samples, f32bit &dsOffset, f32bit &dtOffset)
+    {
+        f32bit scale;
+
+        switch(algorithm)
+        {
+            case ANISO_TWO_AXIS:
+                scale = anisoTwoAxis(dudx, dudy, dvdx, dvdy, maxAniso, samples, dsOffset, dtOffset);
+                break;
+            case ANISO_FOUR_AXIS:
+                scale = anisoFourAxis(dudx, dudy, dvdx, dvdy, maxAniso, samples, dsOffset, dtOffset);
+                break;
+            case ANISO_RECTANGULAR:
+                scale = anisoRectangle(dudx, dudy, dvdx, dvdy, maxAniso, samples, dsOffset, dtOffset);
+                break;
+            case ANISO_EWA:
+                scale = anisoEWA(dudx, dudy, dvdx, dvdy, maxAniso, samples, dsOffset, dtOffset);
+                break;
+            default:
+                scale = anisoExperimentalAngle(dudx, dudy, dvdx, dvdy, maxAniso, samples, dsOffset, dtOffset);
+                break;
+        }
+
+        dsOffset = dsOffset / f32bit(width);
+        dtOffset = dtOffset / f32bit(height);
+
+        return scale;
+    }
+};
+
+//  Reference texel coordinates and bilinear weights of an anisotropic sample (texelCoord2D, repeat wrap mode).
+static void referenceTexelCoord(u32bit width, u32bit height, u32bit currentSample, u32bit numSamples, f32bit dsOffset,
+    f32bit dtOffset, f32bit s, f32bit t, u32bit &i, u32bit &j, f32bit &a, f32bit &b)
+{
+    f32bit u;
+    f32bit v;
+
+    s = s + dsOffset * (currentSample - 0.5f * f32bit(numSamples + 1));
+    t = t + dtOffset * (currentSample - 0.5f * f32bit(numSamples + 1));
+
+    u = (s - floorf(s)) * f32bit(width);
+    v = (t - floorf(t)) * f32bit(height);
+
+    i = GPU_PMOD(u32bit(GPU_FLOOR(u - 0.5f)), width);
+    j = GPU_PMOD(u32bit(GPU_FLOOR(v - 0.5f)), height);
+
+    a = (u - 0.5f) - static_cast<f32bit>(GPU_FLOOR(u - 0.5f));
+    b = (v - 0.5f) - static_cast<f32bit>(GPU_FLOOR(v - 0.5f));
+}
+
+//  Reference texel address for an uncompressed RGBA8888 texture with the texture cache blocking (2x2 blocks,
+//  4x4 superblocks).
+static u64bit referenceTexelAddress(u32bit width, u32bit level, u32bit i, u32bit j)
+{
+    static const u32bit blockDim = 2;
+    static const u32bit sBlockDim = 4;
+
+    u64bit texelAddr = GPUMath::morton(blockDim, i, j);
+    u64bit blockAddr = GPUMath::morton(sBlockDim, i >> blockDim, j >> blockDim);
+    u32bit mipmapWidthLog2 = u32bit(GPU_CEIL(GPU_LOG2(GPU_MAX(width >> level, u32bit(1)))));
+    u32bit sBlocksPerLine = GPU_MAX(s32bit(mipmapWidthLog2) - s32bit((sBlockDim + blockDim)), s32bit(0));
+    u64bit sBlockAddr = ((j >> (sBlockDim + blockDim)) << sBlocksPerLine) + (i >> (sBlockDim + blockDim));
+
+    return u64bit(0x100000 * (level + 1)) + (((((sBlockAddr << (2 * sBlockDim)) + blockAddr) << (2 * blockDim)) + texelAddr) << 2);
+}
+
+struct FootprintConfig
+{
+    u32bit algorithm;
+    u32bit maxAniso;
+    bool multOfTwo;
+    u32bit roundThreshold;
+    u32bit width;
+    u32bit height;
+};
+
+static const FootprintConfig configs[] =
+{
+    {ANISO_TWO_AXIS, 16, false, 0, 1024, 1024},
+    {ANISO_TWO_AXIS, 4, true, 8, 600, 100},
+    {ANISO_FOUR_AXIS, 16, false, 8, 1024, 1024},
+    {ANISO_FOUR_AXIS, 8, true, 0, 256, 1000},
+    {ANISO_RECTANGULAR, 16, false, 0, 1024, 1024},
+    {ANISO_RECTANGULAR, 2, false, 8, 1000, 512},
+    {ANISO_EWA, 16, false, 0, 1024, 1024},
+    {ANISO_EWA, 8, true, 8, 130, 500},
+    {ANISO_EXPERIMENTAL, 16, false, 0, 1024, 1024},
+    {ANISO_EXPERIMENTAL, 4, false, 8, 700, 900}
+};
+
+static const char *algorithmNames[] = {"Two axis", "Four axis", "Rectangle", "EWA", "Angle"};
+
+static const u32bit ROUND_PRECISION = 4;
+
+//  Log2 (rounded up) of a texture dimension.
+static u32bit log2Size(u32bit size)
+{
+    return u32bit(GPU_CEIL(GPU_LOG2(size)));
+}
+
+static f32bit random01()
+{
+    return f32bit(rand() % 100000) / 100000.0f;
+}
+
+//  Creates a texture emulator with a mipmapped 2D texture and trilinear anisotropic filtering in texture unit 0.
+static TextureEmulator *createEmulator(const FootprintConfig &config)
+{
+    TextureEmulator *emulator = new TextureEmulator(4, 2, 4, config.algorithm, false, 16, 8, 0, ROUND_PRECISION,
+        config.roundThreshold, config.multOfTwo, 16, 16, 16, 16, 4, 4, true);
+
+    emulator->reset();
+
+    GPURegData data;
+    u32bit levels = GPU_MAX(log2Size(config.width), log2Size(config.height)) + 1;
+
+    data.booleanVal = true;
+    emulator->writeRegister(GPU_TEXTURE_ENABLE, 0, data);
+    data.txMode = GPU_TEXTURE2D;
+    emulator->writeRegister(GPU_TEXTURE_MODE, 0, data);
+    data.uintVal = config.width;
+    emulator->writeRegister(GPU_TEXTURE_WIDTH, 0, data);
+    data.uintVal = config.height;
+    emulator->writeRegister(GPU_TEXTURE_HEIGHT, 0, data);
+    data.uintVal = log2Size(config.width);
+    emulator->writeRegister(GPU_TEXTURE_WIDTH2, 0, data);
+    data.uintVal = log2Size(config.height);
+    emulator->writeRegister(GPU_TEXTURE_HEIGHT2, 0, data);
+    data.uintVal = levels - 1;
+    emulator->writeRegister(GPU_TEXTURE_MAX_LEVEL, 0, data);
+
+    for(u32bit m = 0; m < levels; m++)
+    {
+        data.uintVal = 0x100000 * (m + 1);
+        emulator->writeRegister(GPU_TEXTURE_ADDRESS, m * CUBEMAP_IMAGES, data);
+    }
+
+    data.txFilter = GPU_LINEAR_MIPMAP_LINEAR;
+    emulator->writeRegister(GPU_TEXTURE_MIN_FILTER, 0, data);
+    data.txFilter = GPU_LINEAR;
+    emulator->writeRegister(GPU_TEXTURE_MAG_FILTER, 0, data);
+    data.txClamp = GPU_TEXT_REPEAT;
+    emulator->writeRegister(GPU_TEXTURE_WRAP_S, 0, data);
+    emulator->writeRegister(GPU_TEXTURE_WRAP_T, 0, data);
+    data.uintVal = config.maxAniso;
+    emulator->writeRegister(GPU_TEXTURE_MAX_ANISOTROPY, 0, data);
+
+    return emulator;
+}
+
+//  Random texture coordinate derivatives (dx and dy in s, t space) of a quad.
+static void randomDerivatives(f32bit *dx, f32bit *dy)
+{
+    u32bit type = rand() % 8;
+    f32bit length = random01() * 0.02f;
+
+    switch(type)
+    {
+        case 0:
+            //  Isotropic footprint.
+            dx[0] = length;
+            dx[1] = 0.0f;
+            dy[0] = 0.0f;
+            dy[1] = length;
+            break;
+
+        case 1:
+            //  Axis aligned anisotropic footprint.
+            dx[0] = length;
+            dx[1] = 0.0f;
+            dy[0] = 0.0f;
+            dy[1] = length / (1.0f + random01() * 20.0f);
+            break;
+
+        case 2:
+            //  Degenerate footprint (non finite results).
+            dx[0] = length;
+            dx[1] = length * 0.5f;
+            dy[0] = ((rand() % 2) == 0) ? 0.0f : length * 2.0f;
+            dy[1] = ((rand() % 2) == 0) ? 0.0f : length;
+            break;
+
+        case 3:
+            //  Magnification.
+            length = random01() * 0.0005f;
+
+        default:
+            {
+                //  Random anisotropic footprint.
+                f32bit angle = random01() * 6.28f;
+                f32bit ratio = 1.0f + random01() * 20.0f;
+
+                dx[0] = length * cosf(angle);
+                dx[1] = length * sinf(angle);
+                dy[0] = -length / ratio * sinf(angle + random01() * 0.5f);
+                dy[1] = length / ratio * cosf(angle);
+            }
+            break;
+    }
+
+    //  Swap the screen axis.
+    if ((rand() % 4) == 0)
+    {
+        f32bit aux[2] = {dx[0], dx[1]};
+
+        dx[0] = dy[0];
+        dx[1] = dy[1];
+        dy[0] = aux[0];
+        dy[1] = aux[1];
+    }
+}
+
+//  Checks the texture access of a quad against the reference footprint.
+static u32bit checkQuad(TextureEmulator *emulator, ReferenceFootprint &reference, const FootprintConfig &config, u32bit id,
+    QuadFloat *coord, u32bit &samples)
+{
+    f32bit parameter[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    u32bit failed = 0;
+    u32bit width = config.width;
+    u32bit height = config.height;
+    u32bit q = GPU_MAX(log2Size(width), log2Size(height));
+
+    //  Reference footprint (same derivatives than TextureEmulator::derivativesXY).
+    f32bit dudx = coord[1][0] * f32bit(width) - coord[0][0] * f32bit(width);
+    f32bit dvdx = coord[1][1] * f32bit(height) - coord[0][1] * f32bit(height);
+    f32bit dudy = coord[2][0] * f32bit(width) - coord[0][0] * f32bit(width);
+    f32bit dvdy = coord[2][1] * f32bit(height) - coord[0][1] * f32bit(height);
+
+    u32bit refSamples;
+    f32bit refdsOffset;
+    f32bit refdtOffset;
+    f32bit scale = reference.calculateScale2D(width, height, dudx, dudy, dvdx, dvdy, config.maxAniso, refSamples, refdsOffset, refdtOffset);
+
+    //  Reference lod (no lod bias, default minimum and maximum lod).
+    f32bit refLOD = static_cast<f32bit>(GPU_LOG2(scale) + GPU_CLAMP(0.0f, -MAX_TEXTURE_LOD_BIAS, MAX_TEXTURE_LOD_BIAS));
+    refLOD = GPU_CLAMP(refLOD, 0.0f, 12.0f);
+
+    TextureAccess *access = emulator->textureOperation(id, TEXTURE_READ, coord, parameter, 0);
+
+    if ((access->anisoSamples != refSamples) || (memcmp(&access->anisodsOffset, &refdsOffset, sizeof(f32bit)) != 0) ||
+        (memcmp(&access->anisodtOffset, &refdtOffset, sizeof(f32bit)) != 0))
+        failed++;
+
+    for(u32bit frag = 0; frag < STAMP_FRAGMENTS; frag++)
+    {
+        if (memcmp(&access->lod[frag], &refLOD, sizeof(f32bit)) != 0)
+            failed++;
+
+        //  Minification, trilinear, or magnification (bilinear on the base level).
+        if (access->filter[frag] == GPU_LINEAR_MIPMAP_LINEAR)
+        {
+            u32bit d1 = GPU_MIN(u32bit(GPU_FLOOR(refLOD)), q);
+            u32bit d2 = (d1 < q) ? d1 + 1 : q;
+
+            if ((access->level[frag][0] != d1) || (access->level[frag][1] != d2))
+                failed++;
+        }
+        else if ((access->filter[frag] != GPU_LINEAR) || (access->level[frag][0] != 0) || (refLOD > C2))
+            failed++;
+    }
+
+    if (failed != 0)
+    {
+        delete access;
+        return failed;
+    }
+
+    //  Texel coordinates and weights of each anisotropic sample.
+    for(access->currentAnisoSample = 1; access->currentAnisoSample <= access->anisoSamples; access->currentAnisoSample++)
+    {
+        emulator->calculateAddress(access);
+
+        TextureAccess::Trilinear *trilinear = access->trilinear[access->currentAnisoSample - 1];
+
+        for(u32bit frag = 0; frag < STAMP_FRAGMENTS; frag++)
+        {
+            u32bit mips = (access->filter[frag] == GPU_LINEAR_MIPMAP_LINEAR) && trilinear->sampleFromTwoMips[frag] ? 2 : 1;
+
+            for(u32bit m = 0; m < mips; m++)
+            {
+                u32bit level = access->level[frag][m];
+                u32bit i;
+                u32bit j;
+                f32bit a;
+                f32bit b;
+
+                referenceTexelCoord(GPU_MAX(width >> level, u32bit(1)), GPU_MAX(height >> level, u32bit(1)),
+                    access->currentAnisoSample, refSamples, refdsOffset, refdtOffset, coord[frag][0], coord[frag][1], i, j, a, b);
+
+                if ((trilinear->i[frag][4 * m] != i) || (trilinear->j[frag][4 * m] != j) ||
+                    (trilinear->address[frag][4 * m] != referenceTexelAddress(width, level, i, j)) ||
+                    (memcmp(&trilinear->a[frag][m], &a, sizeof(f32bit)) != 0) ||
+                    (memcmp(&trilinear->b[frag][m], &b, sizeof(f32bit)) != 0))
+                    failed++;
+            }
+        }
+    }
+
+    samples += access->anisoSamples;
+
+    delete access;
+
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit quads = (argc > 1) ? atoi(argv[1]) : 20000;
+    bool passed = true;
+
+    OptimizedDynamicMemory::initialize(512, 1024, 4096, 1024, 16384, 256);
+
+    srand(49);
+
+    for(u32bit c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        const FootprintConfig &config = configs[c];
+        TextureEmulator *emulator = createEmulator(config);
+        ReferenceFootprint reference(config.algorithm, config.multOfTwo, ROUND_PRECISION, config.roundThreshold);
+        f32bit dx[2];
+        f32bit dy[2];
+        u32bit samples = 0;
+        u32bit failed = 0;
+
+        for(u32bit q = 0; q < quads; q++)
+        {
+            //  Consecutive quads with the same derivatives reuse the cached footprint.
+            if ((q == 0) || ((rand() % 3) == 0))
+                randomDerivatives(dx, dy);
+
+            //  Quad position in a triangle with constant derivatives.
+            f32bit s = f32bit(rand() % 64) * dx[0] + f32bit(rand() % 64) * dy[0] + random01() * 0.001f;
+            f32bit t = f32bit(rand() % 64) * dx[1] + f32bit(rand() % 64) * dy[1] + random01() * 0.001f;
+
+            QuadFloat coord[4];
+            coord[0] = QuadFloat(s, t, 0.0f, 1.0f);
+            coord[1] = QuadFloat(s + dx[0], t + dx[1], 0.0f, 1.0f);
+            coord[2] = QuadFloat(s + dy[0], t + dy[1], 0.0f, 1.0f);
+            coord[3] = QuadFloat(s + dx[0] + dy[0], t + dx[1] + dy[1], 0.0f, 1.0f);
+
+            failed += checkQuad(emulator, reference, config, q, coord, samples);
+        }
+
+        printf("AnisoFootprint => %-9s max aniso %2d %s round %d %4dx%-4d : Quads = %d Samples = %d | Differ = %d\n",
+            algorithmNames[config.algorithm], config.maxAniso, config.multOfTwo ? "even" : "any ", config.roundThreshold,
+            config.width, config.height, quads, samples, failed);
+
+        if (failed != 0)
+            passed = false;
+
+        delete emulator;
+    }
+
+    printf("AnisoFootprint => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,404 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Clipper emulator test.
+ *
+ */
+
+/**
+ *
+ *  @file testClipper.cpp
+ *
+ *  Checks the triangles generated by the clipper emulator for triangles crossing the near and
+ *  far planes, the guard band and an user clip plane.  The triangles are random eye space
+ *  triangles projected with OpenGL and D3D9 perspective matrices:  small triangles inside the
+ *  view volume, triangles with vertices behind the viewer, triangles much larger than the
+ *  viewport and triangles crossing all the planes.
+ *
+ *  For each triangle:
+ *
+ *    - the number of clip vertices must match a double precision Sutherland-Hodgman reference
+ *      (no clip vertices for triangles inside all the planes or outside a plane).
+ *    - the clip vertices must be inside all the clip planes.
+ *    - the vertex attributes are affine functions of the vertex position, the attributes of
+ *      the clip vertices must be the same functions of the interpolated position.
+ *    - the triangles returned by getClipTriangles must be the triangles of the fan that are
+ *      not trivially rejected (the triangle setup can't process a triangle outside the
+ *      viewport).
+ *
+ *  Usage: testClipper [triangles per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "ClipperEmulator.h"
+#include "GPUMath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+struct ClipConfig
+{
+    bool d3d9DepthRange;
+    f32bit guardBand;
+    bool userPlane;
+};
+
+static const ClipConfig configs[] =
+{
+    {false, 8.0f, false},
+    {true, 8.0f, false},
+    {false, 1.5f, false},
+    {true, 2.0f, true}
+};
+
+static QuadFloat userPlane(0.3f, -0.2f, 0.1f, 0.6f);
+
+static f32bit randomValue(f32bit min, f32bit max)
+{
+    return min + (max - min) * (f32bit(rand()) / f32bit(RAND_MAX));
+}
+
+//  Random eye space triangle projected to clip space (fov 67 degrees, 4:3, near 0.5, far 100).
+static void randomTriangle(bool d3d9DepthRange, QuadFloat *position)
+{
+    static const f32bit f = 1.5f;
+    static const f32bit aspect = 4.0f / 3.0f;
+    static const f32bit n = 0.5f;
+    static const f32bit fr = 100.0f;
+
+    u32bit type = rand() % 4;
+    f32bit cx = randomValue(-2.0f, 2.0f);
+    f32bit cy = randomValue(-2.0f, 2.0f);
+    f32bit cz = randomValue(-20.0f, -2.0f);
+
+    for(u32bit v = 0; v < 3; v++)
+    {
+        f32bit x, y, z;
+
+        switch(type)
+        {
+            case 0:
+                //  Small triangles inside the view volume.
+                x = cx + randomValue(-0.5f, 0.5f);
+                y = cy + randomValue(-0.5f, 0.5f);
+                z = cz + randomValue(-0.5f, 0.5f);
+                break;
+            case 1:
+                //  Triangles crossing the near plane.
+                x = randomValue(-3.0f, 3.0f);
+                y = randomValue(-3.0f, 3.0f);
+                z = randomValue(-4.0f, 1.5f);
+                break;
+            case 2:
+                //  Triangles crossing the guard band.
+                x = randomValue(-80.0f, 80.0f);
+                y = randomValue(-80.0f, 80.0f);
+                z = randomValue(-6.0f, -0.6f);
+                break;
+            default:
+                //  Triangles crossing any plane.
+                x = randomValue(-40.0f, 40.0f);
+                y = randomValue(-40.0f, 40.0f);
+                z = randomValue(-150.0f, 2.0f);
+                break;
+        }
+
+        position[v][0] = (f / aspect) * x;
+        position[v][1] = f * y;
+        if (d3d9DepthRange)
+            position[v][2] = (fr / (n - fr)) * z + (n * fr) / (n - fr);
+        else
+            position[v][2] = ((fr + n) / (n - fr)) * z + (2.0f * fr * n) / (n - fr);
+        position[v][3] = -z;
+    }
+}
+
+//  Clip planes in the same order than the clipper emulator.
+static u32bit clipPlanes(const ClipConfig &config, QuadFloat *planes)
+{
+    u32bit numPlanes = 0;
+
+    planes[numPlanes++] = QuadFloat(0.0f, 0.0f, 1.0f, config.d3d9DepthRange ? 0.0f : 1.0f);
+    planes[numPlanes++] = QuadFloat(0.0f, 0.0f, -1.0f, 1.0f);
+    planes[numPlanes++] = QuadFloat( 1.0f,  0.0f, 0.0f, config.guardBand);
+    planes[numPlanes++] = QuadFloat(-1.0f,  0.0f, 0.0f, config.guardBand);
+    planes[numPlanes++] = QuadFloat( 0.0f,  1.0f, 0.0f, config.guardBand);
+    planes[numPlanes++] = QuadFloat( 0.0f, -1.0f, 0.0f, config.guardBand);
+
+    if (config.userPlane)
+        planes[numPlanes++] = userPlane;
+
+    return numPlanes;
+}
+
+static f64bit distance(QuadFloat &plane, const f64bit *position)
+{
+    return f64bit(plane[0]) * position[0] + f64bit(plane[1]) * position[1] + f64bit(plane[2]) * position[2] +
+           f64bit(plane[3]) * position[3];
+}
+
+//  Reference Sutherland-Hodgman clipping in double precision, returns the number of clip vertices
+//  (0 for triangles outside a plane) and sets if the triangle crosses a plane.
+static u32bit referenceClip(QuadFloat *planes, u32bit numPlanes, QuadFloat *position, u32bit &crossed)
+{
+    vector<vector<f64bit> > polygon(3, vector<f64bit>(4));
+
+    for(u32bit v = 0; v < 3; v++)
+        for(u32bit c = 0; c < 4; c++)
+            polygon[v][c] = position[v][c];
+
+    crossed = 0;
+
+    for(u32bit p = 0; (p < numPlanes) && (polygon.size() > 0); p++)
+    {
+        u32bit outside = 0;
+
+        //  The planes crossed are selected with the triangle vertices.
+        for(u32bit v = 0; v < 3; v++)
+        {
+            f64bit original[4] = {position[v][0], position[v][1], position[v][2], position[v][3]};
+            if (distance(planes[p], original) < 0.0)
+                outside++;
+        }
+
+        if (outside == 3)
+            return 0;
+
+        if (outside == 0)
+            continue;
+
+        crossed |= (1 << p);
+
+        vector<vector<f64bit> > output;
+
+        for(u32bit v = 0; v < polygon.size(); v++)
+        {
+            const vector<f64bit> &current = polygon[v];
+            const vector<f64bit> &next = polygon[(v + 1) % polygon.size()];
+            f64bit dCurrent = distance(planes[p], &current[0]);
+            f64bit dNext = distance(planes[p], &next[0]);
+
+            if (dCurrent >= 0.0)
+                output.push_back(current);
+
+            if ((dCurrent >= 0.0) != (dNext >= 0.0))
+            {
+                f64bit t = dCurrent / (dCurrent - dNext);
+                vector<f64bit> vertex(4);
+
+                for(u32bit c = 0; c < 4; c++)
+                    vertex[c] = current[c] + t * (next[c] - current[c]);
+
+                output.push_back(vertex);
+            }
+        }
+
+        polygon.swap(output);
+    }
+
+    return (polygon.size() < 3) ? 0 : u32bit(polygon.size());
+}
+
+//  Affine function of the position used as vertex attribute.
+static f32bit attributeValue(QuadFloat &coefficients, QuadFloat &position, f32bit &scale)
+{
+    scale = 1.0f;
+    for(u32bit c = 0; c < 4; c++)
+        scale += GPU_ABS(coefficients[c] * position[c]);
+
+    return coefficients[0] * position[0] + coefficients[1] * position[1] + coefficients[2] * position[2] +
+           coefficients[3] * position[3];
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit triangles = (argc > 1) ? atoi(argv[1]) : 20000;
+    bool passed = true;
+
+    srand(50);
+
+    for(u32bit c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        const ClipConfig &config = configs[c];
+        QuadFloat planes[MAX_CLIP_PLANES];
+        u32bit numPlanes = clipPlanes(config, planes);
+        u32bit clipped = 0;
+        u32bit nearCrossing = 0;
+        u32bit guardBandCrossing = 0;
+        u32bit culled = 0;
+        u32bit fanTriangles = 0;
+        u32bit removed = 0;
+        u32bit failed = 0;
+
+        ClipperEmulator clipEmu(MAX_VERTEX_ATTRIBUTES, config.guardBand);
+
+        clipEmu.setDepthRange(config.d3d9DepthRange);
+
+        if (config.userPlane)
+            clipEmu.defineClipPlane(0, userPlane);
+
+        for(u32bit t = 0; t < triangles; t++)
+        {
+            QuadFloat vertex[3][MAX_VERTEX_ATTRIBUTES];
+            QuadFloat coefficients[MAX_VERTEX_ATTRIBUTES][4];
+            QuadFloat position[3];
+            u32bit crossed;
+
+            randomTriangle(config.d3d9DepthRange, position);
+
+            for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+                for(u32bit k = 0; k < 4; k++)
+                    coefficients[a][k] = QuadFloat(randomValue(-1.0f, 1.0f), randomValue(-1.0f, 1.0f),
+                                                   randomValue(-1.0f, 1.0f), randomValue(-1.0f, 1.0f));
+
+            for(u32bit v = 0; v < 3; v++)
+            {
+                for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+                {
+                    f32bit scale;
+
+                    if (a == POSITION_ATTRIBUTE)
+                        vertex[v][a] = position[v];
+                    else
+                        for(u32bit k = 0; k < 4; k++)
+                            vertex[v][a][k] = attributeValue(coefficients[a][k], position[v], scale);
+                }
+            }
+
+            u32bit refVertices = referenceClip(planes, numPlanes, position, crossed);
+            bool isClipped = clipEmu.clip(vertex[0], vertex[1], vertex[2], true, config.userPlane);
+            u32bit numVertices = clipEmu.getNumClipVertices();
+
+            //  Triangles inside all the planes are not clipped.
+            if (isClipped != ((crossed != 0) || (refVertices == 0)))
+            {
+                failed++;
+                continue;
+            }
+
+            if (!isClipped)
+                continue;
+
+            clipped++;
+
+            if ((crossed & 0x01) != 0)
+                nearCrossing++;
+            if ((crossed & 0x3c) != 0)
+                guardBandCrossing++;
+            if (numVertices == 0)
+                culled++;
+
+            //  Each crossed plane adds at most one vertex.
+            u32bit crossedPlanes = 0;
+            for(u32bit p = 0; p < numPlanes; p++)
+                crossedPlanes += ((crossed & (1 << p)) != 0) ? 1 : 0;
+
+            if ((numVertices != refVertices) || ((numVertices != 0) && ((numVertices < 3) || (numVertices > (3 + crossedPlanes)))))
+            {
+                failed++;
+                continue;
+            }
+
+            QuadFloat *clipVertex[MAX_CLIP_VERTICES];
+
+            for(u32bit v = 0; v < numVertices; v++)
+            {
+                clipVertex[v] = clipEmu.getNextClipVertex();
+
+                //  The clip vertices are inside all the planes.
+                QuadFloat &clipPosition = clipVertex[v][POSITION_ATTRIBUTE];
+                f64bit pos[4] = {clipPosition[0], clipPosition[1], clipPosition[2], clipPosition[3]};
+
+                for(u32bit p = 0; p < numPlanes; p++)
+                {
+                    f64bit scale = 0.0;
+                    for(u32bit k = 0; k < 4; k++)
+                        scale += GPU_ABS(pos[k]);
+
+                    if (distance(planes[p], pos) < -1e-5 * scale)
+                        failed++;
+                }
+
+                //  The attributes are interpolated as the position.
+                for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+                {
+                    if (a == POSITION_ATTRIBUTE)
+                        continue;
+
+                    for(u32bit k = 0; k < 4; k++)
+                    {
+                        f32bit scale;
+                        f32bit expected = attributeValue(coefficients[a][k], clipPosition, scale);
+
+                        if (GPU_ABS(clipVertex[v][a][k] - expected) > 1e-4f * scale)
+                        {
+                            failed++;
+                            a = MAX_VERTEX_ATTRIBUTES;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (clipEmu.getNextClipVertex() != NULL)
+                failed++;
+
+            //  The fan triangles outside the viewport are removed.
+            QuadFloat *triangle[MAX_CLIP_TRIANGLES][3];
+            u32bit numTriangles = clipEmu.getClipTriangles(triangle);
+            u32bit expected = 0;
+
+            for(u32bit v = 2; v < numVertices; v++)
+            {
+                if (ClipperEmulator::trivialReject(clipVertex[0][POSITION_ATTRIBUTE], clipVertex[v - 1][POSITION_ATTRIBUTE],
+                                                   clipVertex[v][POSITION_ATTRIBUTE], config.d3d9DepthRange))
+                {
+                    removed++;
+                    continue;
+                }
+
+                if ((expected >= numTriangles) || (triangle[expected][0] != clipVertex[0]) ||
+                    (triangle[expected][1] != clipVertex[v - 1]) || (triangle[expected][2] != clipVertex[v]))
+                    failed++;
+
+                expected++;
+            }
+
+            if (expected != numTriangles)
+                failed++;
+
+            for(u32bit f = 0; f < numTriangles; f++)
+                if (ClipperEmulator::trivialReject(triangle[f][0][POSITION_ATTRIBUTE], triangle[f][1][POSITION_ATTRIBUTE],
+                                                   triangle[f][2][POSITION_ATTRIBUTE], config.d3d9DepthRange))
+                    failed++;
+
+            fanTriangles += numTriangles;
+        }
+
+        printf("Clipper => %s depth guard band %4.1f%s : Triangles = %d Clipped = %d Near = %d GuardBand = %d Culled = %d "
+               "Generated = %d Removed = %d | Differ = %d\n", config.d3d9DepthRange ? "D3D9" : "OGL ", config.guardBand,
+               config.userPlane ? " user plane" : "           ", triangles, clipped, nearCrossing, guardBandCrossing, culled,
+               fanTriangles, removed, failed);
+
+        //  The test must generate fan triangles outside the viewport.
+        if ((failed != 0) || (removed == 0))
+            passed = false;
+    }
+
+    printf("Clipper => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -1,116 +1,591 @@
-#include <unistd.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Block compressors test.
+ *
+ */
 
-//#include "HiloCompressorEmulator.h"
+/**
+ *
+ *  @file testCompressor.cpp
+ *
+ *  Checks the ROP block compressors:  the HILO and MSAA compressor emulators used by the
+ *  DAC (with the configurations of the depth and color compressor emulators) and the
+ *  FragmentOpEmulator::hiloCompress used by the Z and color caches.
+ *
+ *  The HILO and MSAA compressors must select the same compression level and write the same
+ *  compressed stream than the previous scalar implementations (copied below), must not write
+ *  past the compressed block size of the level and every compressed block must decompress
+ *  to the original block.
+ *
+ *  The HILO compressor writes the reference index and the low bits of a value as a single
+ *  bit stream field of lowBits + 2 bits.  This is the same stream than writing the 2 bit
+ *  index and then the low bits only because the bit stream packs the fields LSB first, and
+ *  the values of a block only fit in the largest compressed block (192 bytes) for up to 21
+ *  low bits.  Both are checked.
+ *
+ *  The blocks are generated (depth planes with stencil, flat, blended and MSAA color blocks,
+ *  few-valued and random blocks) or read from a file with raw 256 byte blocks.
+ *
+ *  Usage: testCompressor [blocks] [block file]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "BitStreamWriter.h"
+#include "BitStreamReader.h"
+#include "HiloCompressorEmulator.h"
 #include "MsaaCompressorEmulator.h"
+#include "FragmentOpEmulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 using namespace gpu3d;
 
-int fd;
-bool eof = false;
-
-int next() {
-	char b[4];
-	int s = read(fd, b, 4);
-	eof = s <= 0;
-	int d = b[3] << 24
-			| b[2] << 16
-			| b[1] << 8
-			| b[0];
-	return d;
+static const int BLOCK_VALUES = 64;         //  Values per block (256 byte ROP cache line).
+static const int GUARD_WORDS = 8;           //  Words after the compressed block that must not be written.
+static const u32bit GUARD = 0xdeadbeef;
+
+//  HILO compressor levels:  low bits and compressed block size.
+static const int HILO_LEVELS = 3;
+static const int HILO_LOW_BITS[HILO_LEVELS] = {5, 13, 21};
+static const int HILO_SIZE[HILO_LEVELS] = {64, 128, 192};
+
+//  Parameters used by the Z and color caches for hiloCompress.
+static const u32bit HIMASK_NORMAL = 0xffffe000;
+static const u32bit HIMASK_BEST = 0xffffffe0;
+static const u32bit LOSHIFT_NORMAL = 13;
+static const u32bit LOSHIFT_BEST = 5;
+static const u32bit LOMASK_NORMAL = 0x00001fff;
+static const u32bit LOMASK_BEST = 0x0000001f;
+
+//  Previous scalar implementation of the HILO compressor.
+class ReferenceHilo
+{
+public:
+
+    ReferenceHilo(int numLevels, u32bit dataMask, bool reorderData)
+        : numLevels(numLevels), dataMask(dataMask), reorderData(reorderData)
+    {
+        for (int i = 0; i < numLevels; i++)
+            configs[i] = HiloLevelConfig(HILO_LOW_BITS[i]);
+    }
+
+    CompressorInfo compress(const u32bit *datain, u32bit *dataout, int size)
+    {
+        MinMaxInfo mmi;
+        HiloLevelRefs refs;
+
+        int level = findCompressionLevel(datain, size, mmi, refs);
+        bool success = level < numLevels;
+
+        if (success) {
+            const HiloLevelConfig& config = configs[level];
+
+            BitStreamWriter bs(dataout);
+
+            bs.write((mmi.min >> config.lowBits), config.highBits);
+            bs.write((mmi.max >> config.lowBits), config.highBits);
+
+            for (int i = 0; i < size; i++) {
+                u32bit d = reorder(datain[i] & dataMask, config);
+                u32bit index = refs.getIndexOfRef(d & config.highMask);
+                bs.write(index, 2);
+                bs.write(d, config.lowBits);
+            }
+        }
+
+        return CompressorInfo(success, level, success ? HILO_SIZE[level] : (size * sizeof(u32bit)));
+    }
+
+private:
+
+    u32bit reorder(u32bit data, const HiloLevelConfig& config)
+    {
+        return reorderData ?
+                (data & config.reHighMask1)
+                    | (data & config.reHighMask2) << config.reHighShift2
+                    | (data & config.reHighMask3) << config.reHighShift3
+                    | (data & config.reHighMask4) << config.reHighShift4
+                    | (data & config.reLowMask1) >> config.reLowShift1
+                    | (data & config.reLowMask2) >> config.reLowShift2
+                    | (data & config.reLowMask3) >> config.reLowShift3
+                    | (data & config.reLowMask4)
+                : data;
+    }
+
+    MinMaxInfo findMinMax(const u32bit *data, int size, const HiloLevelConfig& config)
+    {
+        u32bit min = 0xffffffff;
+        u32bit max = 0x00000000;
+
+        for (int i = 0; i < size; i++) {
+            u32bit d = reorder(data[i] & dataMask, config);
+            min = d < min ? d : min;
+            max = d > max ? d : max;
+        }
+
+        return MinMaxInfo(min, max);
+    }
+
+    int findCompressionLevel(const u32bit *data, int size, MinMaxInfo& mmi, HiloLevelRefs& refs)
+    {
+        int level = 0;
+
+        const HiloLevelConfig* config = &configs[level];
+        mmi = findMinMax(data, size, *config);
+        refs = HiloLevelRefs(mmi, *config);
+
+        int i = 0;
+        while (i < size && level < numLevels) {
+            u32bit d = reorder(data[i] & dataMask, *config);
+
+            while (level < numLevels && !refs.test(d & config->highMask)) {
+                level++;
+                if (level < numLevels) {
+                    config = &configs[level];
+                    mmi = findMinMax(data, size, *config);
+                    refs = HiloLevelRefs(mmi, *config);
+                    i = -1;
+                }
+            }
+            i++;
+        }
+
+        return level;
+    }
+
+    int numLevels;
+    u32bit dataMask;
+    bool reorderData;
+    HiloLevelConfig configs[HILO_LEVELS];
+};
+
+//  Previous scalar implementation of the MSAA compressor.
+class ReferenceMsaa
+{
+public:
+
+    CompressorInfo compress(const u32bit *datain, u32bit *dataout, int size)
+    {
+        MsaaRefs refsArray[32];
+        int refsArraySize = 0;
+
+        int level = findCompressionLevel(datain, size, &refsArray[0], refsArraySize);
+
+        bool success = level < numLevels;
+
+        if (success) {
+            BitStreamWriter bs(dataout);
+
+            const MsaaLevelConfig& conf = configs[level];
+            for (int i = 0; i < refsArraySize; i++) {
+                MsaaRefs& refs = refsArray[i];
+                int samples = refs.samples;
+                int pmask = 1 << (refs.samples - 1);
+
+                while (samples > 0) {
+                    bs.write(refs.ref1, 32);
+
+                    if (conf.numRefs > 1) {
+                        bs.write(refs.ref2, 32);
+
+                        for (int j = 0; j < conf.samples; j++) {
+                            int mask = (refs.mask & pmask) == 0 ? 0 : 1;
+                            bs.write(mask, 1);
+                            pmask >>= 1;
+                        }
+                    }
+
+                    samples -= conf.samples;
+                }
+            }
+        }
+
+        return CompressorInfo(success, level, success ? configs[level].size : (size * sizeof(u32bit)));
+    }
+
+private:
+
+    bool checkSubblock(const u32bit *data, int start, const MsaaLevelConfig* conf, MsaaRefs* refs)
+    {
+        bool bdiff[BLOCK_VALUES];
+
+        int end = start + conf->samples;
+
+        for (int i = start; i < end; i++)
+            bdiff[i] = true;
+
+        int diff = 0;
+
+        refs->ref1 = data[start];
+        refs->ref2 = refs->ref1;
+        refs->mask = 0;
+
+        for (int i = start; (i < end) && (diff <= conf->numRefs); i++) {
+            if (bdiff[i]) {
+                diff += 1;
+                refs->ref2 = (data[i] == refs->ref1) ? refs->ref2 : data[i];
+                for (int j = i + 1; j < end; j++)
+                    bdiff[j] = bdiff[j] && (data[i] != data[j]);
+            }
+            int index = (data[i] == refs->ref1) ? 0 : 1;
+            refs->mask = (refs->mask << 1) | index;
+        }
+
+        return diff <= conf->numRefs;
+    }
+
+    int findCompressionLevel(const u32bit *datain, int size, MsaaRefs *refsArray, int &refsArraySize)
+    {
+        int level = 0;
+
+        const MsaaLevelConfig* conf = &configs[level];
+
+        bool ok = true;
+        int start = 0;
+        int refsIndex = 0;
+
+        while (ok && (start < size)) {
+
+            ok = ok && checkSubblock(datain, start, conf, &refsArray[refsIndex]);
+
+            if (!ok) {
+                level++;
+                if (level < numLevels) {
+                    conf = &configs[level];
+                    ok = true;
+                }
+                start = 0;
+                refsIndex = 0;
+            }
+            else {
+                start += conf->samples;
+                refsArray[refsIndex].samples = conf->samples;
+                refsIndex++;
+            }
+        }
+
+        refsArraySize = refsIndex;
+
+        return level;
+    }
+
+    static const int numLevels = 5;
+    static const MsaaLevelConfig configs[numLevels];
+};
+
+const MsaaLevelConfig ReferenceMsaa::configs[] = {
+        MsaaLevelConfig(1, 4, 64),
+        MsaaLevelConfig(2, 16, 64),
+        MsaaLevelConfig(1, 2, 128),
+        MsaaLevelConfig(2, 8, 128),
+        MsaaLevelConfig(2, 4, 192)
+};
+
+static u32bit random32()
+{
+    return (u32bit(rand()) << 16) ^ u32bit(rand());
 }
 
-void readline(u32bit* data, int size) {
-	char b[size*4];
-	int s = read(fd, b, size*4);
-	for (int i = 0; i < size; i++) {
-		int p = i * 4;
-		int d = b[p+3] << 24 | b[p+2] << 16
-					| b[p+1] << 8 | b[p+0];
-		data[i] = d;
-	}
+//  Generates a block of one of the block kinds.
+static void generateBlock(u32bit *block, u32bit kind)
+{
+    u32bit base = random32();
+    s32bit dx = (rand() % 4096) - 2048;
+    s32bit dy = (rand() % 4096) - 2048;
+    u32bit values[4] = {base, base ^ (1 << (rand() % 32)), random32(), base + 1};
+
+    //  Scale the depth plane slopes to test every HILO level.
+    s32bit scale = 1 << (rand() % 12);
+
+    for(u32bit i = 0; i < BLOCK_VALUES; i++)
+    {
+        s32bit x = i & 0x07;
+        s32bit y = i >> 3;
+
+        switch(kind)
+        {
+            case 0:
+                //  Depth plane with stencil.
+                block[i] = (base & 0xff000000) | ((base + (dx * x + dy * y) / scale) & 0x00ffffff);
+                break;
+            case 1:
+                //  Flat color.
+                block[i] = base;
+                break;
+            case 2:
+                //  Color with a few samples blended.
+                block[i] = ((rand() % 8) == 0) ? (base ^ 0x00404040) : base;
+                break;
+            case 3:
+                //  MSAA color:  the samples of a pixel have one or two colors.
+                if ((i & 0x03) == 0)
+                    values[rand() % 4] = ((rand() % 4) == 0) ? random32() : base;
+                block[i] = (((i & 0x03) == 0) || ((rand() % 4) == 0)) ? values[rand() % 2] : block[i - 1];
+                break;
+            case 4:
+                //  Few values.
+                block[i] = values[rand() % 4];
+                break;
+            default:
+                block[i] = random32();
+                break;
+        }
+    }
 }
 
-class cl {
-	int m1, m2;
-};
+//  Checks that the bit stream packs the fields LSB first.
+static u32bit testBitStream()
+{
+    u32bit failed = 0;
+
+    //  Fields written and the expected packed words.
+    u32bit words[4];
+    u32bit expected[4] = {0x8000000b, 0xffffffff, 0x00000007, 0x00000000};
+    memset(words, 0, sizeof(words));
+    {
+        BitStreamWriter bs(words);
+        bs.write(0x3, 2);           //  bits 0-1
+        bs.write(0x2, 2);           //  bits 2-3
+        bs.write(0x0, 27);          //  bits 4-30
+        bs.write(0xffffffff, 32);   //  bits 31-62
+        bs.write(0xf, 4);           //  bits 63-66
+    }
+
+    if (memcmp(words, expected, sizeof(words)) != 0)
+    {
+        printf("Compressor => Bit stream => Fields not packed LSB first : %08x %08x %08x\n", words[0], words[1], words[2]);
+        failed++;
+    }
+
+    //  Writing the 2 bit reference index and the low bits as one field must write the same stream.
+    for(u32bit l = 0; l < HILO_LEVELS; l++)
+    {
+        u32bit lowBits = HILO_LOW_BITS[l];
+        u32bit highBits = 32 - lowBits;
+        u32bit single[BLOCK_VALUES];
+        u32bit separate[BLOCK_VALUES];
+        u32bit values[BLOCK_VALUES];
+
+        //  The values of a block must fit in the compressed block of the level.
+        if (((2 * highBits + BLOCK_VALUES * (lowBits + 2)) > (HILO_SIZE[l] * 8)) || (lowBits > 21))
+        {
+            printf("Compressor => Bit stream => Level %d with %d low bits doesn't fit in %d bytes\n", l, lowBits, HILO_SIZE[l]);
+            failed++;
+        }
+
+        memset(single, 0, sizeof(single));
+        memset(separate, 0, sizeof(separate));
+
+        {
+            BitStreamWriter bsSingle(single);
+            BitStreamWriter bsSeparate(separate);
+
+            bsSingle.write(0x12345678, highBits);
+            bsSeparate.write(0x12345678, highBits);
+
+            for(u32bit i = 0; i < BLOCK_VALUES; i++)
+            {
+                u32bit index = rand() & 0x03;
+                values[i] = random32();
+
+                bsSingle.write(index | (values[i] << 2), lowBits + 2);
+                bsSeparate.write(index, 2);
+                bsSeparate.write(values[i], lowBits);
+
+                values[i] = index | ((values[i] & ((1 << lowBits) - 1)) << 2);
+            }
+        }
+
+        BitStreamReader bs(single);
+        bs.read(highBits);
+        bool readMatch = true;
+        for(u32bit i = 0; i < BLOCK_VALUES; i++)
+            readMatch = readMatch && (bs.read(lowBits + 2) == values[i]);
+
+        if ((memcmp(single, separate, sizeof(single)) != 0) || !readMatch)
+        {
+            printf("Compressor => Bit stream => Single field stream differs for %d low bits\n", lowBits);
+            failed++;
+        }
+    }
+
+    return failed;
+}
+
+//  Compresses and decompresses a block with a compressor and compares with the reference compressor.
+//  The decompressed block only keeps the bits selected by the data mask of the compressor.
+template <class REFERENCE>
+static bool testBlock(CompressorEmulator &compressor, REFERENCE &reference, const u32bit *block, u32bit dataMask,
+    u32bit *levels)
+{
+    u32bit output[BLOCK_VALUES + GUARD_WORDS];
+    u32bit referenceOutput[BLOCK_VALUES + GUARD_WORDS];
+    u32bit uncompressed[BLOCK_VALUES];
+
+    for(u32bit i = 0; i < (BLOCK_VALUES + GUARD_WORDS); i++)
+        output[i] = referenceOutput[i] = GUARD;
+
+    CompressorInfo info = compressor.compress(block, output, BLOCK_VALUES);
+    CompressorInfo refInfo = reference.compress(block, referenceOutput, BLOCK_VALUES);
+
+    if ((info.success != refInfo.success) || (info.level != refInfo.level) || (info.size != refInfo.size))
+        return false;
+
+    if (!info.success)
+    {
+        levels[info.level]++;
+
+        //  Uncompressed blocks aren't written.
+        for(u32bit i = 0; i < (BLOCK_VALUES + GUARD_WORDS); i++)
+            if (output[i] != GUARD)
+                return false;
+
+        return true;
+    }
+
+    levels[info.level]++;
+
+    u32bit words = compressor.getLevelBlockSize(info.level) / sizeof(u32bit);
+
+    if ((u32bit(info.size) != (words * sizeof(u32bit))) || (memcmp(output, referenceOutput, sizeof(output)) != 0))
+        return false;
+
+    //  The compressed block must not be written past its size.
+    for(u32bit i = words; i < (BLOCK_VALUES + GUARD_WORDS); i++)
+        if (output[i] != GUARD)
+            return false;
+
+    CompressorInfo uncompressInfo = compressor.uncompress(output, uncompressed, BLOCK_VALUES, info.level);
+
+    bool match = (uncompressInfo.level == info.level);
+    for(u32bit i = 0; i < BLOCK_VALUES; i++)
+        match = match && (uncompressed[i] == (block[i] & dataMask));
+
+    return match;
+}
+
+//  Compresses and decompresses a block with hiloCompress.
+static bool testHiloCompress(u32bit *block, u32bit *levels)
+{
+    u8bit output[BLOCK_VALUES * 4];
+    u32bit uncompressed[BLOCK_VALUES];
+    u32bit min;
+    u32bit max;
+
+    FragmentOpEmulator::blockMinMax(block, BLOCK_VALUES, min, max);
+    FragmentOpEmulator::CompressionMode mode = FragmentOpEmulator::hiloCompress(block, output, BLOCK_VALUES,
+        HIMASK_NORMAL, HIMASK_BEST, LOSHIFT_NORMAL, LOSHIFT_BEST, LOMASK_NORMAL, LOMASK_BEST, min, max);
+
+    levels[mode]++;
+
+    if (mode == FragmentOpEmulator::UNCOMPRESSED)
+        return memcmp(output, block, sizeof(output)) == 0;
+
+    FragmentOpEmulator::hiloUncompress(output, uncompressed, BLOCK_VALUES, mode, HIMASK_NORMAL, HIMASK_BEST,
+        LOSHIFT_NORMAL, LOSHIFT_BEST);
+
+    return memcmp(uncompressed, block, sizeof(uncompressed)) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit numBlocks = (argc > 1) ? atoi(argv[1]) : 60000;
+    std::vector<u32bit> blocks;
+
+    srand(47);
+
+    if (argc > 2)
+    {
+        FILE *f = fopen(argv[2], "rb");
+
+        if (f == NULL)
+        {
+            printf("Compressor => Error opening block file %s\n", argv[2]);
+            return 1;
+        }
+
+        u32bit block[BLOCK_VALUES];
+        while (fread(block, sizeof(u32bit), BLOCK_VALUES, f) == BLOCK_VALUES)
+            blocks.insert(blocks.end(), block, block + BLOCK_VALUES);
+
+        fclose(f);
+
+        numBlocks = blocks.size() / BLOCK_VALUES;
+    }
+    else
+    {
+        u32bit block[BLOCK_VALUES];
+        for(u32bit b = 0; b < numBlocks; b++)
+        {
+            generateBlock(block, b % 6);
+            blocks.insert(blocks.end(), block, block + BLOCK_VALUES);
+        }
+    }
+
+    u32bit failed = testBitStream();
+
+    printf("Compressor => Bit stream | Differ = %d\n", failed);
+
+    //  Compressors configured as the depth compressor (old hilo), the color compressors and
+    //  the MSAA compressor.
+    HiloCompressorEmulator hilo2(2, 0xffffffff, false);
+    HiloCompressorEmulator hilo3(3, 0xffffffff, false);
+    HiloCompressorEmulator hiloRe(3, 0xffffffff, true);
+    HiloCompressorEmulator hiloZ(3, 0x00ffffff, false);
+    MsaaCompressorEmulator msaa(BLOCK_VALUES);
+
+    ReferenceHilo refHilo2(2, 0xffffffff, false);
+    ReferenceHilo refHilo3(3, 0xffffffff, false);
+    ReferenceHilo refHiloRe(3, 0xffffffff, true);
+    ReferenceHilo refHiloZ(3, 0x00ffffff, false);
+    ReferenceMsaa refMsaa;
+
+    const char *names[6] = {"HILO 2 levels", "HILO 3 levels", "HILO reorder", "HILO Z mask", "MSAA", "hiloCompress"};
+
+    for(u32bit c = 0; c < 6; c++)
+    {
+        u32bit levels[6] = {0, 0, 0, 0, 0, 0};
+        u32bit differ = 0;
+
+        for(u32bit b = 0; b < numBlocks; b++)
+        {
+            u32bit *block = &blocks[b * BLOCK_VALUES];
+            bool match;
+
+            switch(c)
+            {
+                case 0: match = testBlock(hilo2, refHilo2, block, 0xffffffff, levels); break;
+                case 1: match = testBlock(hilo3, refHilo3, block, 0xffffffff, levels); break;
+                case 2: match = testBlock(hiloRe, refHiloRe, block, 0xffffffff, levels); break;
+                case 3: match = testBlock(hiloZ, refHiloZ, block, 0x00ffffff, levels); break;
+                case 4: match = testBlock(msaa, refMsaa, block, 0xffffffff, levels); break;
+                default: match = testHiloCompress(block, levels); break;
+            }
+
+            if (!match)
+                differ++;
+        }
+
+        printf("Compressor => %-13s : Blocks = %d | Levels = %d %d %d %d %d %d | Differ = %d\n", names[c], numBlocks,
+            levels[0], levels[1], levels[2], levels[3], levels[4], levels[5], differ);
+
+        failed += differ;
+    }
+
+    printf("Compressor => %s\n", (failed == 0) ? "passed" : "FAILED");
 
-int main() {
-	u32bit data1[64];
-	u32bit data2[64];
-	u32bit cdata1[64];
-	u32bit cdata2[64];
-	
-	//HiloCompressorEmulator compr(3, 0xffffffff);
-	MsaaCompressorEmulator compr(64);
-
-	fd = open("cdata.bin", O_RDONLY);
-	if (fd < 0) {
-		printf("\nERROR: opening data file!!!\n");
-		exit(-1);
-	}
-
-	int lines = 0;
-	
-	while (!eof) {
-		int size = next();
-		readline(data1, size);
-		lines++;
-		
-		if (lines > 0 && size > 0)
-		{
-			printf(">");
-			/*for (int i = 0; i < size; i++)
-				printf("%08x ", data1[i]);
-			printf("(%i)", size);*/
-			
-			memset(cdata1, 0, size*4);
-			CompressorInfo info = compr.compress(data1, cdata1, size);
-			
-			printf(" level=%i  csize=%i\n", info.level, info.size);
-			
-			/*printf("*");
-			for (int i = 0; i < info.size / 4; i++)
-				printf("%08x ", cdata[i]);
-			printf("\n");*/
-			
-			if (info.success) {
-				memset(cdata2, 0, size*4);
-				memcpy(cdata2, cdata1, info.size);
-				
-				//printf("+");
-				memset(data2, 0, size*4);
-				CompressorInfo info2 = compr.uncompress(cdata2, data2, size, info.level);
-				
-				if (info2.level != info.level) {
-					printf("\nERROR: different levels!!!\n");
-					exit(-1);
-				}
-				for (int i = 0; i < size; i++) {
-					//printf("%08x ", data2[i]);
-					if (data1[i] != data2[i]) {
-						printf("\nERROR: data differences!!!\n");
-						memset(cdata1, 0, size*4);
-						CompressorInfo info = compr.compress(data1, cdata1, size);
-						
-						memset(cdata2, 0, size*4);
-						memcpy(cdata2, cdata1, info.size);
-										
-						memset(data2, 0, size*4);
-						compr.uncompress(cdata2, data2, size, info.level);
-						exit(-1);
-					}
-				}
-				//printf("\n\n");
-			}
-			else {
-				//printf("-");
-			}
-		}
-	}
-	
-	close(fd);
-	return 0;
+    return (failed == 0) ? 0 : 1;
 }
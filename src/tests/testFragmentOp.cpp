@@ -0,0 +1,600 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Fragment Operation Emulator test.
+ *
+ */
+
+/**
+ *
+ *  @file testFragmentOp.cpp
+ *
+ *  Checks the blend, logic operation, stencil and z test and color conversion functions of
+ *  the FragmentOpEmulator against the previous scalar formulas (copied below):
+ *
+ *    - Blending for every blend equation and every source and destination RGB and alpha
+ *      blend factor, with random colors and special values (zero, negative zero, one,
+ *      negative values, values greater than one, denormals, infinities and NaN) in the
+ *      source, destination and constant colors.  The results must be bit identical, a NaN
+ *      result only has to be a NaN (the sign and payload of a NaN aren't defined).
+ *    - Every logic operation.
+ *    - Every stencil and z compare function with random stencil masks, stencil update
+ *      functions and random z values (including values with the top bit set and equal
+ *      values) for the stencil and z test enabled and disabled.
+ *    - The RGBA8 <-> RGBA32F conversions for every 8 bit value and for special values.
+ *
+ *  The stamps have 4 fragments (as the Color Write unit) and 6 fragments, so the fragments
+ *  that don't fill a group of four fragments are also processed.
+ *
+ *  Usage: testFragmentOp [stamps]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPUMath.h"
+#include "FragmentOpEmulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace gpu3d;
+
+static const u32bit MAX_FRAGMENTS = 8;
+static const u32bit STAMP_SIZES = 2;
+static const u32bit stampSizes[STAMP_SIZES] = {4, 6};
+
+static const u32bit BLEND_EQUATIONS = 5;
+static const u32bit BLEND_FUNCTIONS = 15;
+static const u32bit LOGICOP_MODES = 16;
+static const u32bit COMPARE_MODES = 8;
+static const u32bit STENCIL_FUNCTIONS = 8;
+
+//  Previous blend factor formula for the RGB components.
+static f32bit referenceFactorRGB(BlendFunction bf, QuadFloat &constColor, QuadFloat &source, QuadFloat &destination,
+    u32bit c)
+{
+    switch(bf)
+    {
+        case BLEND_ZERO:                        return 0.0;
+        case BLEND_ONE:                         return 1.0;
+        case BLEND_SRC_COLOR:                   return source[c];
+        case BLEND_ONE_MINUS_SRC_COLOR:         return 1.0f - source[c];
+        case BLEND_DST_COLOR:                   return destination[c];
+        case BLEND_ONE_MINUS_DST_COLOR:         return 1.0f - destination[c];
+        case BLEND_SRC_ALPHA:                   return source[3];
+        case BLEND_ONE_MINUS_SRC_ALPHA:         return 1.0f - source[3];
+        case BLEND_DST_ALPHA:                   return destination[3];
+        case BLEND_ONE_MINUS_DST_ALPHA:         return 1.0f - destination[3];
+        case BLEND_CONSTANT_COLOR:              return constColor[c];
+        case BLEND_ONE_MINUS_CONSTANT_COLOR:    return 1.0f - constColor[c];
+        case BLEND_CONSTANT_ALPHA:              return constColor[3];
+        case BLEND_ONE_MINUS_CONSTANT_ALPHA:    return 1.0f - constColor[3];
+        case BLEND_SRC_ALPHA_SATURATE:          return GPU_MIN(source[3], 1.0f - destination[3]);
+        default:
+            panic("testFragmentOp", "referenceFactorRGB", "Unsupported blend factor function.");
+            return 0.0f;
+    }
+}
+
+//  Previous blend factor formula for the alpha component.
+static f32bit referenceFactorAlpha(BlendFunction bf, QuadFloat &constColor, QuadFloat &source, QuadFloat &destination)
+{
+    switch(bf)
+    {
+        case BLEND_ZERO:
+            return 0.0;
+        case BLEND_ONE:
+        case BLEND_SRC_ALPHA_SATURATE:
+            return 1.0;
+        case BLEND_SRC_COLOR:
+        case BLEND_SRC_ALPHA:
+            return source[3];
+        case BLEND_ONE_MINUS_SRC_COLOR:
+        case BLEND_ONE_MINUS_SRC_ALPHA:
+            return 1.0f - source[3];
+        case BLEND_DST_COLOR:
+        case BLEND_DST_ALPHA:
+            return destination[3];
+        case BLEND_ONE_MINUS_DST_COLOR:
+        case BLEND_ONE_MINUS_DST_ALPHA:
+            return 1.0f - destination[3];
+        case BLEND_CONSTANT_COLOR:
+        case BLEND_CONSTANT_ALPHA:
+            return constColor[3];
+        case BLEND_ONE_MINUS_CONSTANT_COLOR:
+        case BLEND_ONE_MINUS_CONSTANT_ALPHA:
+            return 1.0f - constColor[3];
+        default:
+            panic("testFragmentOp", "referenceFactorAlpha", "Unsupported blend factor function.");
+            return 0.0f;
+    }
+}
+
+//  Previous blend formula.
+static void referenceBlend(BlendEquation eq, BlendFunction sRGB, BlendFunction sA, BlendFunction dRGB, BlendFunction dA,
+    QuadFloat &constColor, QuadFloat *color, QuadFloat *source, QuadFloat *destination, u32bit fragments)
+{
+    for(u32bit i = 0; i < fragments; i++)
+    {
+        f32bit sFactor[4];
+        f32bit dFactor[4];
+
+        for(u32bit c = 0; c < 3; c++)
+        {
+            sFactor[c] = referenceFactorRGB(sRGB, constColor, source[i], destination[i], c);
+            dFactor[c] = referenceFactorRGB(dRGB, constColor, source[i], destination[i], c);
+        }
+        sFactor[3] = referenceFactorAlpha(sA, constColor, source[i], destination[i]);
+        dFactor[3] = referenceFactorAlpha(dA, constColor, source[i], destination[i]);
+
+        for(u32bit c = 0; c < 4; c++)
+        {
+            switch(eq)
+            {
+                case BLEND_FUNC_ADD:
+                    color[i][c] = source[i][c] * sFactor[c] + destination[i][c] * dFactor[c];
+                    break;
+                case BLEND_FUNC_SUBTRACT:
+                    color[i][c] = source[i][c] * sFactor[c] - destination[i][c] * dFactor[c];
+                    break;
+                case BLEND_FUNC_REVERSE_SUBTRACT:
+                    color[i][c] = -source[i][c] * sFactor[c] + destination[i][c] * dFactor[c];
+                    break;
+                case BLEND_MIN:
+                    color[i][c] = GPU_MIN(source[i][c], destination[i][c]);
+                    break;
+                case BLEND_MAX:
+                    color[i][c] = GPU_MAX(source[i][c], destination[i][c]);
+                    break;
+            }
+        }
+    }
+}
+
+//  Previous logic operation formula.
+static u8bit referenceLogicOp(LogicOpMode mode, u8bit s, u8bit d)
+{
+    switch(mode)
+    {
+        case LOGICOP_CLEAR:         return 0;
+        case LOGICOP_AND:           return s & d;
+        case LOGICOP_AND_REVERSE:   return s & ~d;
+        case LOGICOP_COPY:          return s;
+        case LOGICOP_AND_INVERTED:  return ~s & d;
+        case LOGICOP_NOOP:          return d;
+        case LOGICOP_XOR:           return s ^ d;
+        case LOGICOP_OR:            return s | d;
+        case LOGICOP_NOR:           return ~(s | d);
+        case LOGICOP_EQUIV:         return ~(s ^ d);
+        case LOGICOP_INVERT:        return ~d;
+        case LOGICOP_OR_REVERSE:    return s | ~d;
+        case LOGICOP_COPY_INVERTED: return ~s;
+        case LOGICOP_OR_INVERTED:   return ~s | d;
+        case LOGICOP_NAND:          return ~(s & d);
+        case LOGICOP_SET:           return 0xff;
+        default:
+            panic("testFragmentOp", "referenceLogicOp", "Unsupported logical operation mode.");
+            return 0;
+    }
+}
+
+//  Previous compare formula (the value is the stencil reference for the stencil test).
+static bool referenceCompare(CompareMode func, u32bit value, u32bit ref)
+{
+    switch(func)
+    {
+        case GPU_NEVER:     return FALSE;
+        case GPU_ALWAYS:    return TRUE;
+        case GPU_LESS:      return (value < ref);
+        case GPU_LEQUAL:    return (value <= ref);
+        case GPU_EQUAL:     return (value == ref);
+        case GPU_GEQUAL:    return (value >= ref);
+        case GPU_GREATER:   return (value > ref);
+        case GPU_NOTEQUAL:  return (value != ref);
+        default:
+            panic("testFragmentOp", "referenceCompare", "Undefined compare mode.");
+            return false;
+    }
+}
+
+//  Stencil and z test state.
+struct StencilZState
+{
+    bool stencilTest;
+    bool depthTest;
+    CompareMode stencilFunction;
+    CompareMode depthFunction;
+    u8bit reference;
+    u8bit testMask;
+    u8bit updateMask;
+    StencilUpdateFunction stencilFail;
+    StencilUpdateFunction depthFail;
+    StencilUpdateFunction depthPass;
+    bool depthMask;
+};
+
+//  Previous stencil update formula.
+static void referenceUpdateStencil(StencilZState &s, StencilUpdateFunction func, u8bit stencilVal, u32bit &bufferVal)
+{
+    u8bit stencilAux;
+
+    switch(func)
+    {
+        case STENCIL_KEEP:      stencilAux = stencilVal; break;
+        case STENCIL_ZERO:      stencilAux = 0; break;
+        case STENCIL_REPLACE:   stencilAux = s.reference; break;
+        case STENCIL_INCR:      stencilAux = (stencilVal == 0xff) ? 0xff : stencilVal + 1; break;
+        case STENCIL_DECR:      stencilAux = (stencilVal == 0) ? 0 : stencilVal - 1; break;
+        case STENCIL_INVERT:    stencilAux = ~stencilVal; break;
+        case STENCIL_INCR_WRAP: stencilAux = stencilVal + 1; break;
+        case STENCIL_DECR_WRAP: stencilAux = stencilVal - 1; break;
+        default:
+            panic("testFragmentOp", "referenceUpdateStencil", "Undefined stencil update function.");
+            return;
+    }
+
+    bufferVal = (bufferVal & 0x00ffffff) | ((stencilAux & s.updateMask) << 24);
+}
+
+//  Previous stencil and z test.
+static void referenceStencilZTest(StencilZState &s, u32bit *stampZ, u32bit *bufferZ, bool *stampCull, u32bit fragments)
+{
+    for(u32bit i = 0; i < fragments; i++)
+    {
+        u8bit stencil = bufferZ[i] >> 24;
+        u32bit depth = bufferZ[i] & 0x00ffffff;
+
+        bool stencilResult = referenceCompare(s.stencilFunction, s.reference & s.testMask, stencil & s.testMask) ||
+                             !s.stencilTest;
+        bool zResult = referenceCompare(s.depthFunction, stampZ[i], depth) || !s.depthTest;
+
+        if (s.stencilTest && !stampCull[i])
+        {
+            if (!stencilResult)
+                referenceUpdateStencil(s, s.stencilFail, stencil, bufferZ[i]);
+            else if (zResult)
+                referenceUpdateStencil(s, s.depthPass, stencil, bufferZ[i]);
+            else
+                referenceUpdateStencil(s, s.depthFail, stencil, bufferZ[i]);
+        }
+
+        if (s.depthTest && !stampCull[i] && stencilResult && zResult && s.depthMask)
+            bufferZ[i] = (bufferZ[i] & 0xff000000) | (stampZ[i] & 0x00ffffff);
+
+        stampCull[i] = stampCull[i] || !stencilResult || !zResult;
+    }
+}
+
+//  Returns a random color component, one in four components is a special value.
+static f32bit randomComponent()
+{
+    static const f32bit specials[] =
+    {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 2.0f, 1e30f, -1e30f, 1e-40f, -1e-40f,
+        std::numeric_limits<f32bit>::infinity(), -std::numeric_limits<f32bit>::infinity(),
+        std::numeric_limits<f32bit>::quiet_NaN(), -std::numeric_limits<f32bit>::quiet_NaN()
+    };
+
+    if ((rand() % 4) == 0)
+        return specials[rand() % (sizeof(specials) / sizeof(specials[0]))];
+
+    switch(rand() % 4)
+    {
+        case 0:  return f32bit(rand() % 256) / 255.0f;
+        case 1:  return f32bit(rand()) / f32bit(RAND_MAX);
+        case 2:  return (f32bit(rand()) / f32bit(RAND_MAX)) * 4.0f - 2.0f;
+        default: return f32bit(rand() % 3) * 0.5f;
+    }
+}
+
+static void randomColor(QuadFloat &color)
+{
+    for(u32bit c = 0; c < 4; c++)
+        color[c] = randomComponent();
+}
+
+//  Compares two colors bit by bit.  A NaN matches any NaN.
+static bool sameColor(QuadFloat &a, QuadFloat &b)
+{
+    for(u32bit c = 0; c < 4; c++)
+    {
+        f32bit x = a[c];
+        f32bit y = b[c];
+
+        if ((x != x) && (y != y))
+            continue;
+
+        if (memcmp(&x, &y, sizeof(f32bit)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static u32bit random32()
+{
+    return (u32bit(rand()) << 16) ^ u32bit(rand());
+}
+
+//  Tests every blend equation and blend factor combination.
+static u32bit testBlend(u32bit stamps)
+{
+    u32bit failed = 0;
+    u32bit tests = 0;
+
+    for(u32bit s = 0; s < STAMP_SIZES; s++)
+    {
+        u32bit fragments = stampSizes[s];
+        FragmentOpEmulator fragOp(fragments);
+
+        for(u32bit eq = 0; eq < BLEND_EQUATIONS; eq++)
+            for(u32bit sRGB = 0; sRGB < BLEND_FUNCTIONS; sRGB++)
+                for(u32bit sA = 0; sA < BLEND_FUNCTIONS; sA++)
+                    for(u32bit dRGB = 0; dRGB < BLEND_FUNCTIONS; dRGB++)
+                        for(u32bit dA = 0; dA < BLEND_FUNCTIONS; dA++)
+                            for(u32bit t = 0; t < stamps; t++)
+                            {
+                                QuadFloat constColor;
+                                QuadFloat source[MAX_FRAGMENTS];
+                                QuadFloat destination[MAX_FRAGMENTS];
+                                QuadFloat color[MAX_FRAGMENTS];
+                                QuadFloat expected[MAX_FRAGMENTS];
+
+                                randomColor(constColor);
+                                for(u32bit i = 0; i < fragments; i++)
+                                {
+                                    randomColor(source[i]);
+                                    randomColor(destination[i]);
+                                }
+
+                                //  Use a different render target for each test.
+                                u32bit rt = tests % MAX_RENDER_TARGETS;
+                                tests++;
+
+                                fragOp.setBlending(rt, BlendEquation(eq), BlendFunction(sRGB), BlendFunction(sA),
+                                    BlendFunction(dRGB), BlendFunction(dA), constColor);
+                                fragOp.blend(rt, color, source, destination);
+
+                                referenceBlend(BlendEquation(eq), BlendFunction(sRGB), BlendFunction(sA),
+                                    BlendFunction(dRGB), BlendFunction(dA), constColor, expected, source, destination,
+                                    fragments);
+
+                                bool match = true;
+                                for(u32bit i = 0; i < fragments; i++)
+                                    match = match && sameColor(color[i], expected[i]);
+
+                                if (!match)
+                                {
+                                    if (failed < 8)
+                                        printf("FragmentOp => Blend => Equation %d Factors %d %d %d %d differ\n", eq,
+                                            sRGB, sA, dRGB, dA);
+                                    failed++;
+                                }
+                            }
+    }
+
+    printf("FragmentOp => Blend => Tests = %d | Differ = %d\n", tests, failed);
+
+    return failed;
+}
+
+//  Tests every logic operation.
+static u32bit testLogicOp(u32bit stamps)
+{
+    u32bit failed = 0;
+    u32bit tests = 0;
+
+    for(u32bit s = 0; s < STAMP_SIZES; s++)
+    {
+        u32bit fragments = stampSizes[s];
+        FragmentOpEmulator fragOp(fragments);
+
+        for(u32bit mode = 0; mode < LOGICOP_MODES; mode++)
+        {
+            fragOp.setLogicOpMode(LogicOpMode(mode));
+
+            for(u32bit t = 0; t < stamps; t++)
+            {
+                u8bit source[MAX_FRAGMENTS * 4];
+                u8bit destination[MAX_FRAGMENTS * 4];
+                u8bit color[MAX_FRAGMENTS * 4];
+
+                for(u32bit i = 0; i < (fragments * 4); i++)
+                {
+                    source[i] = rand();
+                    destination[i] = rand();
+                }
+
+                fragOp.logicOp(color, source, destination);
+
+                bool match = true;
+                for(u32bit i = 0; i < (fragments * 4); i++)
+                    match = match && (color[i] == referenceLogicOp(LogicOpMode(mode), source[i], destination[i]));
+
+                if (!match)
+                {
+                    if (failed < 8)
+                        printf("FragmentOp => Logic Op => Mode %d differs\n", mode);
+                    failed++;
+                }
+
+                tests++;
+            }
+        }
+    }
+
+    printf("FragmentOp => Logic Op => Tests = %d | Differ = %d\n", tests, failed);
+
+    return failed;
+}
+
+//  Tests every stencil and z compare function.
+static u32bit testStencilZ(u32bit stamps)
+{
+    static const u8bit masks[] = {0xff, 0x0f, 0xf0, 0x81, 0x00};
+    u32bit failed = 0;
+    u32bit tests = 0;
+
+    for(u32bit s = 0; s < STAMP_SIZES; s++)
+    {
+        u32bit fragments = stampSizes[s];
+        FragmentOpEmulator fragOp(fragments);
+
+        for(u32bit stencilFunc = 0; stencilFunc < COMPARE_MODES; stencilFunc++)
+            for(u32bit depthFunc = 0; depthFunc < COMPARE_MODES; depthFunc++)
+                for(u32bit enables = 0; enables < 4; enables++)
+                    for(u32bit t = 0; t < stamps; t++)
+                    {
+                        StencilZState state;
+
+                        state.stencilTest = (enables & 0x01) != 0;
+                        state.depthTest = (enables & 0x02) != 0;
+                        state.stencilFunction = CompareMode(stencilFunc);
+                        state.depthFunction = CompareMode(depthFunc);
+                        state.reference = rand();
+                        state.testMask = masks[rand() % (sizeof(masks) / sizeof(masks[0]))];
+                        state.updateMask = masks[rand() % (sizeof(masks) / sizeof(masks[0]))];
+                        state.stencilFail = StencilUpdateFunction(rand() % STENCIL_FUNCTIONS);
+                        state.depthFail = StencilUpdateFunction(rand() % STENCIL_FUNCTIONS);
+                        state.depthPass = StencilUpdateFunction(rand() % STENCIL_FUNCTIONS);
+                        state.depthMask = (rand() % 4) != 0;
+
+                        fragOp.setStencilTest(state.stencilTest);
+                        fragOp.setZTest(state.depthTest);
+                        fragOp.configureStencilTest(state.stencilFunction, state.reference, state.testMask,
+                            state.updateMask, state.stencilFail, state.depthFail, state.depthPass);
+                        fragOp.configureZTest(state.depthFunction, state.depthMask);
+
+                        u32bit stampZ[MAX_FRAGMENTS];
+                        u32bit bufferZ[MAX_FRAGMENTS];
+                        u32bit expectedZ[MAX_FRAGMENTS];
+                        bool stampCull[MAX_FRAGMENTS];
+                        bool expectedCull[MAX_FRAGMENTS];
+
+                        for(u32bit i = 0; i < fragments; i++)
+                        {
+                            //  Stencil values around the reference, z values equal, close or random
+                            //  (with the top bit set).
+                            u32bit stencil = ((rand() % 2) == 0) ? u32bit(state.reference + (rand() % 3) - 1) & 0xff :
+                                             u32bit(rand() & 0xff);
+                            bufferZ[i] = expectedZ[i] = (stencil << 24) | (random32() & 0x00ffffff);
+
+                            switch(rand() % 4)
+                            {
+                                case 0:  stampZ[i] = bufferZ[i] & 0x00ffffff; break;
+                                case 1:  stampZ[i] = (bufferZ[i] & 0x00ffffff) + (rand() % 3) - 1; break;
+                                case 2:  stampZ[i] = random32() | 0x80000000; break;
+                                default: stampZ[i] = random32() & 0x00ffffff; break;
+                            }
+
+                            stampCull[i] = expectedCull[i] = (rand() % 8) == 0;
+                        }
+
+                        fragOp.stencilZTest(stampZ, bufferZ, stampCull);
+                        referenceStencilZTest(state, stampZ, expectedZ, expectedCull, fragments);
+
+                        bool match = (memcmp(bufferZ, expectedZ, fragments * sizeof(u32bit)) == 0);
+                        for(u32bit i = 0; i < fragments; i++)
+                            match = match && (stampCull[i] == expectedCull[i]);
+
+                        if (!match)
+                        {
+                            if (failed < 8)
+                                printf("FragmentOp => Stencil Z => Stencil function %d Z function %d Enables %d differ\n",
+                                    stencilFunc, depthFunc, enables);
+                            failed++;
+                        }
+
+                        tests++;
+                    }
+    }
+
+    printf("FragmentOp => Stencil Z => Tests = %d | Differ = %d\n", tests, failed);
+
+    return failed;
+}
+
+//  Tests the RGBA8 <-> RGBA32F conversions.
+static u32bit testConversions(u32bit stamps)
+{
+    u32bit failed = 0;
+    u32bit tests = 0;
+
+    //  Every 8 bit value in every component.
+    u8bit in[256 * 4];
+    QuadFloat out[256];
+    for(u32bit v = 0; v < 256; v++)
+        for(u32bit c = 0; c < 4; c++)
+            in[v * 4 + c] = u8bit(v + c * 64);
+
+    FragmentOpEmulator::colorRGBA8ToRGBA32F(in, out, 256);
+
+    for(u32bit v = 0; v < 256; v++)
+    {
+        for(u32bit c = 0; c < 4; c++)
+        {
+            f32bit expected = f32bit(in[v * 4 + c]) * (1.0f / 255.0f);
+            f32bit result = out[v][c];
+
+            if (memcmp(&expected, &result, sizeof(f32bit)) != 0)
+                failed++;
+
+            tests++;
+        }
+    }
+
+    //  Random and special values (NaN is clamped to 1).
+    for(u32bit t = 0; t < stamps; t++)
+    {
+        QuadFloat color[MAX_FRAGMENTS];
+        u8bit result[MAX_FRAGMENTS * 4];
+
+        for(u32bit i = 0; i < MAX_FRAGMENTS; i++)
+            randomColor(color[i]);
+
+        FragmentOpEmulator::colorRGBA32FToRGBA8(color, result, MAX_FRAGMENTS);
+
+        for(u32bit i = 0; i < MAX_FRAGMENTS; i++)
+        {
+            for(u32bit c = 0; c < 4; c++)
+            {
+                u8bit expected = u8bit(255.0f * GPU_CLAMP(color[i][c], 0.0f, 1.0f));
+
+                if (result[i * 4 + c] != expected)
+                    failed++;
+
+                tests++;
+            }
+        }
+    }
+
+    printf("FragmentOp => Conversions => Tests = %d | Differ = %d\n", tests, failed);
+
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit stamps = (argc > 1) ? atoi(argv[1]) : 1;
+
+    srand(46);
+
+    u32bit failed = testBlend(stamps);
+    failed += testLogicOp(stamps * 2000);
+    failed += testStencilZ(stamps * 1000);
+    failed += testConversions(stamps * 20000);
+
+    printf("FragmentOp => %s\n", (failed == 0) ? "passed" : "FAILED");
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Frame dump conversion test.
+ *
+ */
+
+/**
+ *
+ *  @file testFrameDumpWriter.cpp
+ *
+ *  Checks that the color buffer conversion and MSAA resolve of the FrameDumpWriter (SSE2 or
+ *  scalar, depending on the build) produce the same image than a per pixel reference
+ *  conversion.  The reference converts each channel directly (GPUMath::convertFP16ToFP32,
+ *  divisions and pow) instead of using the conversion tables.
+ *
+ *  All the color buffer formats are tested in color and alpha mode, with 1, 2, 4 and 8 samples
+ *  per pixel and widths that are not a multiple of four.  The buffers are random, the float16
+ *  values include denormals, infinites, NaNs and negative values, and a part of the MSAA pixels
+ *  have all the samples with the same color.
+ *
+ *  Usage: testFrameDumpWriter [surfaces per case]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "FrameDumpWriter.h"
+#include "GPUMath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+static f32bit linear(f32bit x)
+{
+    return f32bit(GPU_POWER(f64bit(x), f64bit(2.2f)));
+}
+
+static f32bit gamma(f32bit x)
+{
+    return f32bit(GPU_POWER(f64bit(x), f64bit(1.0f / 2.2f)));
+}
+
+static u8bit toU8(f32bit v)
+{
+    return u8bit(GPU_MIN(GPU_MAX(v, 0.0f), 1.0f) * 255.0f);
+}
+
+//  Reference per channel conversion of a sample.
+static void referenceSample(TextureFormat format, const u8bit *data, f32bit *color, f32bit *lin)
+{
+    const u16bit *data16 = (const u16bit *) data;
+    u32bit channels = 4;
+
+    color[0] = color[1] = color[2] = color[3] = 0.0f;
+
+    switch(format)
+    {
+        case GPU_RGBA8888:
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = f32bit(data[c]) / 255.0f;
+            break;
+        case GPU_RG16F:
+            color[0] = GPUMath::convertFP16ToFP32(data16[0]);
+            color[1] = GPUMath::convertFP16ToFP32(data16[1]);
+            channels = 2;
+            break;
+        case GPU_R32F:
+            color[0] = *((const f32bit *) data);
+            channels = 1;
+            break;
+        case GPU_RGBA16:
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = f32bit(data16[c]) / 65535.0f;
+            break;
+        default:
+            for(u32bit c = 0; c < 4; c++)
+                color[c] = GPUMath::convertFP16ToFP32(data16[c]);
+            break;
+    }
+
+    for(u32bit c = 0; c < 3; c++)
+        lin[c] = (c < channels) ? linear(color[c]) : 0.0f;
+}
+
+//  Reference conversion of a pixel to BGRA8.
+static void referencePixel(const FrameDumpSurface &surface, const u8bit *data, u8bit *out)
+{
+    u32bit bytesSample = ((surface.format == GPU_RGBA16) || (surface.format == GPU_RGBA16F)) ? 8 : 4;
+    f32bit reference[4];
+    f32bit lin[3];
+
+    referenceSample(surface.format, data, reference, lin);
+
+    if (surface.samples == 1)
+    {
+        out[0] = toU8(reference[2]);
+        out[1] = toU8(reference[1]);
+        out[2] = toU8(reference[0]);
+
+        //  The two and single channel formats have a 0 alpha, RGBA8 has the stored alpha.
+        if (surface.format == GPU_RGBA8888)
+            out[3] = data[3];
+        else
+            out[3] = toU8(reference[3]);
+
+        if (surface.format == GPU_RGBA8888)
+        {
+            out[0] = data[2];
+            out[1] = data[1];
+            out[2] = data[0];
+        }
+    }
+    else
+    {
+        f32bit resolved[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        bool fullCoverage = true;
+
+        for(u32bit i = 0; i < surface.samples; i++)
+        {
+            f32bit current[4];
+            referenceSample(surface.format, &data[i * bytesSample], current, lin);
+
+            for(u32bit c = 0; c < 3; c++)
+                resolved[c] += lin[c];
+            resolved[3] += current[3];
+
+            for(u32bit c = 0; c < 3; c++)
+                fullCoverage = fullCoverage && (reference[c] == current[c]);
+        }
+
+        if (fullCoverage)
+        {
+            out[0] = toU8(reference[2]);
+            out[1] = toU8(reference[1]);
+            out[2] = toU8(reference[0]);
+            out[3] = toU8(reference[3]);
+        }
+        else
+        {
+            out[0] = toU8(gamma(resolved[2] / f32bit(surface.samples)));
+            out[1] = toU8(gamma(resolved[1] / f32bit(surface.samples)));
+            out[2] = toU8(gamma(resolved[0] / f32bit(surface.samples)));
+            out[3] = toU8(resolved[3] / f32bit(surface.samples));
+        }
+    }
+
+    if (surface.mode == FrameDumpSurface::ALPHA)
+        out[0] = out[1] = out[2] = out[3];
+    else
+        out[3] = 255;
+}
+
+//  Random channel value, float16 values include all the special encodings.
+static void randomSample(TextureFormat format, u8bit *data)
+{
+    u16bit *data16 = (u16bit *) data;
+
+    switch(format)
+    {
+        case GPU_RG16F:
+        case GPU_RGBA16F:
+            for(u32bit c = 0; c < ((format == GPU_RG16F) ? 2 : 4); c++)
+            {
+                switch(rand() % 4)
+                {
+                    case 0:
+                        data16[c] = u16bit(rand());                         //  Any value.
+                        break;
+                    case 1:
+                        data16[c] = u16bit(rand() % 0x3C01);                //  [0, 1]
+                        break;
+                    case 2:
+                        data16[c] = u16bit(0x7C00 + (rand() % 3));          //  Infinite and NaNs.
+                        break;
+                    default:
+                        data16[c] = u16bit(rand() % 0x0400);                //  Denormals.
+                        break;
+                }
+            }
+            break;
+        case GPU_R32F:
+            *((f32bit *) data) = f32bit(rand() % 1400) / 1000.0f - 0.2f;
+            break;
+        default:
+            for(u32bit b = 0; b < ((format == GPU_RGBA16) ? 8 : 4); b++)
+                data[b] = u8bit(rand() >> 4);
+            break;
+    }
+}
+
+struct FormatTest
+{
+    const char *name;
+    TextureFormat format;
+    u32bit bytesSample;
+};
+
+static const FormatTest formats[] =
+{
+    {"RGBA8888", GPU_RGBA8888, 4},
+    {"RG16F", GPU_RG16F, 4},
+    {"R32F", GPU_R32F, 4},
+    {"RGBA16", GPU_RGBA16, 8},
+    {"RGBA16F", GPU_RGBA16F, 8}
+};
+
+int main(int argc, char *argv[])
+{
+    u32bit surfaces = (argc > 1) ? atoi(argv[1]) : 4;
+    bool passed = true;
+    static const u32bit sampleCounts[] = {1, 2, 4, 8};
+
+    srand(35);
+
+    FrameDumpWriter &writer = FrameDumpWriter::getInstance();
+
+    for(u32bit f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+        for(u32bit s = 0; s < sizeof(sampleCounts) / sizeof(sampleCounts[0]); s++)
+        {
+            u32bit pixels = 0;
+            u32bit failed = 0;
+
+            for(u32bit n = 0; n < surfaces; n++)
+            {
+                FrameDumpSurface surface;
+
+                surface.mode = ((n & 1) == 0) ? FrameDumpSurface::COLOR : FrameDumpSurface::ALPHA;
+                surface.format = formats[f].format;
+                surface.width = 61 + n * 3;
+                surface.height = 23 + n;
+                surface.samples = sampleCounts[s];
+                surface.d3d9PixelCoordinates = ((n & 2) != 0);
+                surface.pixelMapper.setupDisplay(surface.width, surface.height, 2, 2, 4, 4, 2, 2, 4, 4,
+                                                 surface.samples, formats[f].bytesSample);
+
+                u32bit bytesPixel = surface.samples * formats[f].bytesSample;
+                vector<u8bit> buffer(surface.pixelMapper.computeFrameBufferSize() + bytesPixel);
+                vector<u8bit> image(surface.width * surface.height * 4);
+
+                for(u32bit y = 0; y < surface.height; y++)
+                {
+                    for(u32bit x = 0; x < surface.width; x++)
+                    {
+                        u8bit *pixel = &buffer[surface.pixelMapper.computeAddress(x, y)];
+
+                        for(u32bit i = 0; i < surface.samples; i++)
+                            randomSample(surface.format, &pixel[i * formats[f].bytesSample]);
+
+                        //  Pixels fully covered by a triangle.
+                        if ((rand() % 3) == 0)
+                            for(u32bit i = 1; i < surface.samples; i++)
+                                memcpy(&pixel[i * formats[f].bytesSample], pixel, formats[f].bytesSample);
+                    }
+                }
+
+                writer.convert(surface, &buffer[0], &image[0]);
+
+                for(u32bit row = 0; row < surface.height; row++)
+                {
+                    u32bit y = surface.d3d9PixelCoordinates ? row : (surface.height - 1) - row;
+
+                    for(u32bit x = 0; x < surface.width; x++)
+                    {
+                        u8bit ref[4];
+                        referencePixel(surface, &buffer[surface.pixelMapper.computeAddress(x, y)], ref);
+
+                        if (memcmp(ref, &image[(row * surface.width + x) * 4], 4) != 0)
+                            failed++;
+
+                        pixels++;
+                    }
+                }
+            }
+
+            printf("FrameDumpWriter => %-8s %d samples : Pixels = %d | Differ = %d\n", formats[f].name, sampleCounts[s], pixels, failed);
+
+            if (failed != 0)
+                passed = false;
+        }
+    }
+
+    printf("FrameDumpWriter => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
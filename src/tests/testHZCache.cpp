@@ -0,0 +1,475 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Hierarchical Z cache test.
+ *
+ */
+
+/**
+ *
+ *  @file testHZCache.cpp
+ *
+ *  Checks the Hierarchical Z cache and the block minimum/maximum reductions used to
+ *  update the Hierarchical Z buffer.
+ *
+ *  The block reductions of the fragment operation emulator (blockMaxZ, blockMinMaxZ and
+ *  blockMinMax, SSE2 with a scalar tail or scalar, depending on the build) must return the
+ *  same values than the previous scalar code reproduced below.  The blocks have all the
+ *  sizes up to 70 values (SIMD body and scalar tail) and random values, values with the
+ *  sign bit set (unsigned compare), and the minimum and maximum 32 bit and 24 bit values.
+ *
+ *  The set associative HZ cache (HZCache) is compared with a model that keeps the lines of
+ *  each set in LRU order.  Random blocks are searched and inserted, the lines are reserved
+ *  by each access and released in random order, and the cache is randomly reset.  The hits,
+ *  the evicted lines and the conflicts (all the lines in the set reserved) must match the
+ *  model.  The cache entries returned must be in the set of the block and store the block.
+ *  The cache configurations have direct mapped, 2 way, 4 way and fully associative caches.
+ *
+ *  Usage: testHZCache [accesses per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "FragmentOpEmulator.h"
+#include "HZCache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+//  Reference block reductions:  previous FragmentOpEmulator::blockMaxZ, blockMinMaxZ and blockMinMax.
+static void referenceBlockMaxZ(u32bit *input, u32bit size, u32bit &maxZ)
+{
+    maxZ = 0x00000000L;
+
+    for(u32bit i = 0; i < size; i++)
+    {
+        u32bit d = input[i] & 0x00ffffff;
+        maxZ = d > maxZ ? d : maxZ;
+    }
+}
+
+static void referenceBlockMinMaxZ(u32bit *input, u32bit size, u32bit &minZ, u32bit &maxZ, u32bit &min, u32bit &max)
+{
+    min = 0xffffffffL;
+    max = 0x00000000L;
+    minZ = 0x00ffffffL;
+    maxZ = 0x00000000L;
+
+    for(u32bit i = 0; i < size; i++)
+    {
+        min = (input[i] < min)?input[i]:min;
+        max = (input[i] > max)?input[i]:max;
+        minZ = ((input[i] & 0x00ffffff) < minZ)?(input[i] & 0x00ffffff):minZ;
+        maxZ = ((input[i] & 0x00ffffff) > maxZ)?(input[i] & 0x00ffffff):maxZ;
+    }
+}
+
+static void referenceBlockMinMax(u32bit *input, u32bit size, u32bit &min, u32bit &max)
+{
+    min = 0xffffffffL;
+    max = 0x00000000L;
+
+    for(u32bit i = 0; i < size; i++)
+    {
+        min = (input[i] < min)?input[i]:min;
+        max = (input[i] > max)?input[i]:max;
+    }
+}
+
+static u32bit random32()
+{
+    return (u32bit(rand() & 0xffff) << 16) | u32bit(rand() & 0xffff);
+}
+
+//  Random block value.
+static u32bit randomValue(u32bit type)
+{
+    static const u32bit special[] = {0x00000000, 0xffffffff, 0x7fffffff, 0x80000000, 0x00ffffff, 0x01000000, 0xff000000, 0x80ffffff};
+
+    switch(type)
+    {
+        case 0:
+            return random32();
+        case 1:
+            //  Values around the sign bit.
+            return 0x80000000 + (random32() & 0xff) - 0x80;
+        case 2:
+            //  Same stencil, close Z values.
+            return 0x5a000000 | (0x00800000 + (random32() & 0xfff) - 0x800);
+        default:
+            return special[rand() % (sizeof(special) / sizeof(special[0]))];
+    }
+}
+
+//  Compares the block reductions with the reference.
+static u32bit checkBlockMinMax(u32bit blocks)
+{
+    u32bit failed = 0;
+    u32bit input[70];
+
+    for(u32bit b = 0; b < blocks; b++)
+    {
+        u32bit size = b % 71;
+        u32bit type = rand() % 4;
+
+        for(u32bit i = 0; i < size; i++)
+            input[i] = randomValue(((rand() % 8) == 0) ? 3 : type);
+
+        u32bit min, max, minZ, maxZ;
+        u32bit refMin, refMax, refMinZ, refMaxZ;
+
+        FragmentOpEmulator::blockMaxZ(input, size, maxZ);
+        referenceBlockMaxZ(input, size, refMaxZ);
+
+        if (maxZ != refMaxZ)
+            failed++;
+
+        FragmentOpEmulator::blockMinMaxZ(input, size, minZ, maxZ, min, max);
+        referenceBlockMinMaxZ(input, size, refMinZ, refMaxZ, refMin, refMax);
+
+        if ((minZ != refMinZ) || (maxZ != refMaxZ) || (min != refMin) || (max != refMax))
+            failed++;
+
+        FragmentOpEmulator::blockMinMax(input, size, min, max);
+        referenceBlockMinMax(input, size, refMin, refMax);
+
+        if ((min != refMin) || (max != refMax))
+            failed++;
+    }
+
+    return failed;
+}
+
+//  Model of the HZ cache:  the lines of each set in LRU order (least recently used first).
+class HZCacheModel
+{
+private:
+
+    struct Line
+    {
+        u32bit line;        //  Line identifier (block without the block inside the line).
+        u32bit entry;       //  HZ cache entry returned when the line was inserted.
+        u32bit reserves;
+    };
+
+    u32bit ways;
+    u32bit sets;
+    u32bit lineShift;
+    vector<list<Line> > lruSets;
+
+    list<Line>::iterator find(u32bit line)
+    {
+        list<Line> &set = lruSets[line % sets];
+        list<Line>::iterator it;
+
+        for(it = set.begin(); (it != set.end()) && (it->line != line); it++);
+
+        return it;
+    }
+
+public:
+
+    HZCacheModel(u32bit lines, u32bit lineSize, u32bit cacheWays) :
+        ways(cacheWays), sets(lines / cacheWays), lruSets(lines / cacheWays)
+    {
+        for(lineShift = 0; (u32bit(1) << lineShift) < lineSize; lineShift++);
+    }
+
+    u32bit firstEntry(u32bit block)
+    {
+        return ((block >> lineShift) % sets) * ways;
+    }
+
+    //  Returns if the block is in the cache and the cache entry storing the block.
+    bool search(u32bit block, u32bit &entry)
+    {
+        u32bit line = block >> lineShift;
+        list<Line> &set = lruSets[line % sets];
+        list<Line>::iterator it = find(line);
+
+        if (it == set.end())
+            return false;
+
+        //  Reserve the line and move it to the most recently used position.
+        Line hit = *it;
+        hit.reserves++;
+        set.erase(it);
+        set.push_back(hit);
+        entry = hit.entry;
+
+        return true;
+    }
+
+    //  Returns if the block can be inserted, if a line is evicted and the cache entry of the evicted line.
+    bool insert(u32bit block, u32bit entry, bool &evicted, u32bit &evictedEntry)
+    {
+        u32bit line = block >> lineShift;
+        list<Line> &set = lruSets[line % sets];
+        list<Line>::iterator it;
+
+        evicted = false;
+
+        if (set.size() == ways)
+        {
+            //  Evict the least recently used line without reserves.
+            for(it = set.begin(); (it != set.end()) && (it->reserves != 0); it++);
+
+            if (it == set.end())
+                return false;
+
+            evictedEntry = it->entry;
+            set.erase(it);
+            evicted = true;
+        }
+
+        Line inserted;
+        inserted.line = line;
+        inserted.entry = entry;
+        inserted.reserves = 1;
+        set.push_back(inserted);
+
+        return true;
+    }
+
+    //  Returns if a cache entry in the set of the block stores a line.
+    bool entryUsed(u32bit block, u32bit entry)
+    {
+        u32bit line = block >> lineShift;
+        list<Line> &set = lruSets[line % sets];
+
+        for(list<Line>::iterator it = set.begin(); it != set.end(); it++)
+            if (it->entry == entry)
+                return true;
+
+        return false;
+    }
+
+    void release(u32bit block)
+    {
+        list<Line>::iterator it = find(block >> lineShift);
+        it->reserves--;
+    }
+
+    void reset()
+    {
+        for(u32bit s = 0; s < sets; s++)
+            lruSets[s].clear();
+    }
+};
+
+struct CacheConfig
+{
+    u32bit lines;
+    u32bit lineSize;
+    u32bit ways;
+};
+
+static const CacheConfig configs[] =
+{
+    {8, 4, 1},
+    {8, 4, 2},
+    {8, 16, 4},
+    {16, 16, 4},
+    {8, 4, 8}
+};
+
+//  Reservation of a HZ cache line by a stamp block.
+struct Reservation
+{
+    u32bit block;
+    u32bit entry;
+};
+
+//  Checks the LRU replacement and conflicts for a 2 way cache.
+static u32bit checkReplacement()
+{
+    HZCache cache(4, 4, 2);
+    u32bit failed = 0;
+    u32bit a, b, c, d;
+    bool evicted;
+
+    //  Blocks A, B, C and D map to the set 0 (line identifiers 0, 2, 4 and 6).
+    cache.insert(0x00, a, evicted);
+    cache.insert(0x08, b, evicted);
+    cache.getLine(a).reserves--;
+    cache.getLine(b).reserves--;
+
+    //  A is the most recently used line, C must replace B.
+    if (!cache.search(0x01, a))
+        failed++;
+    cache.getLine(a).reserves--;
+
+    if (!cache.insert(0x10, c, evicted) || !evicted || (c != b))
+        failed++;
+
+    if (cache.search(0x08, b) || !cache.search(0x02, a) || !cache.search(0x13, c))
+        failed++;
+
+    //  All the lines in the set reserved, D can not be inserted.
+    if (cache.insert(0x18, d, evicted))
+        failed++;
+
+    //  The line of a different set must be inserted without eviction.
+    if (!cache.insert(0x04, d, evicted) || evicted || (d < 2))
+        failed++;
+
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit accesses = (argc > 1) ? atoi(argv[1]) : 200000;
+    bool passed = true;
+
+    srand(44);
+
+    u32bit blocks = 20000;
+    u32bit failed = checkBlockMinMax(blocks);
+
+#ifdef __SSE2__
+    printf("HZCache => Block min/max SSE2 : Blocks = %d | Differ = %d\n", blocks, failed);
+#else
+    printf("HZCache => Block min/max scalar : Blocks = %d | Differ = %d\n", blocks, failed);
+#endif
+
+    if (failed != 0)
+        passed = false;
+
+    failed = checkReplacement();
+
+    printf("HZCache => LRU replacement 2 ways | Differ = %d\n", failed);
+
+    if (failed != 0)
+        passed = false;
+
+    for(u32bit c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        const CacheConfig &config = configs[c];
+        HZCache cache(config.lines, config.lineSize, config.ways);
+        HZCacheModel model(config.lines, config.lineSize, config.ways);
+        vector<Reservation> reservations;
+        u32bit hits = 0;
+        u32bit misses = 0;
+        u32bit evictions = 0;
+        u32bit conflicts = 0;
+
+        failed = 0;
+
+        for(u32bit a = 0; a < accesses; a++)
+        {
+            u32bit action = rand() % 1024;
+
+            if (action == 0)
+            {
+                //  Reset (end of the batch, no stamps waiting for the cache lines).
+                cache.reset();
+                model.reset();
+                reservations.clear();
+            }
+            else if ((action < 512) && !reservations.empty())
+            {
+                //  A stamp reads the block from the cache line.
+                u32bit r = rand() % reservations.size();
+
+                cache.getLine(reservations[r].entry).reserves--;
+                model.release(reservations[r].block);
+
+                reservations[r] = reservations.back();
+                reservations.pop_back();
+            }
+            else
+            {
+                //  Blocks from four times the cache size.
+                u32bit block = rand() % (config.lines * config.lineSize * 4);
+                u32bit entry;
+                u32bit modelEntry;
+                bool evicted;
+                bool modelEvicted;
+
+                bool hit = cache.search(block, entry);
+                bool reserved = hit;
+
+                if (hit != model.search(block, modelEntry))
+                    failed++;
+                else if (hit)
+                {
+                    hits++;
+
+                    if (entry != modelEntry)
+                        failed++;
+                }
+                else
+                {
+                    misses++;
+
+                    bool inserted = cache.insert(block, entry, evicted);
+                    bool entryFree = inserted && !model.entryUsed(block, entry);
+
+                    if ((inserted != model.insert(block, entry, modelEvicted, modelEntry)) || (inserted && (evicted != modelEvicted)))
+                    {
+                        failed++;
+
+                        //  Continue from the same state.
+                        cache.reset();
+                        model.reset();
+                        reservations.clear();
+                        continue;
+                    }
+
+                    if (!inserted)
+                        conflicts++;
+                    else
+                    {
+                        //  The cache entry must be in the set of the block and be the evicted line or a free line.
+                        if ((entry < model.firstEntry(block)) || (entry >= (model.firstEntry(block) + config.ways)))
+                            failed++;
+                        else if (evicted ? (entry != modelEntry) : !entryFree)
+                            failed++;
+
+                        if (evicted)
+                            evictions++;
+
+                        reserved = true;
+                    }
+                }
+
+                if (reserved)
+                {
+                    //  The cache entry must store the block.
+                    if (!cache.getLine(entry).valid || (cache.getLine(entry).block != (block & ~(config.lineSize - 1))))
+                        failed++;
+
+                    Reservation reservation;
+                    reservation.block = block;
+                    reservation.entry = entry;
+                    reservations.push_back(reservation);
+                }
+            }
+        }
+
+        printf("HZCache => %2d lines %2d blocks/line %d ways : Hits = %d Misses = %d Evictions = %d Conflicts = %d | Differ = %d\n",
+            config.lines, config.lineSize, config.ways, hits, misses, evictions, conflicts, failed);
+
+        //  The accesses must hit, evict lines and find all the lines in the set reserved.
+        if ((failed != 0) || (hits == 0) || (evictions == 0) || (conflicts == 0))
+            passed = false;
+    }
+
+    printf("HZCache => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Register Write Filter test.
+ *
+ */
+
+/**
+ *
+ *  @file testRegisterWriteFilter.cpp
+ *
+ *  Checks that the register writes filtered by the Command Processor (FilterRedundantRegisterWrites)
+ *  don't change the state of the GPU units.  Two models of the Color Write / DAC register state
+ *  process the same random register writes, one all the writes and the other only the writes
+ *  not filtered by the RegisterWriteFilter.  The state of both models must be the same after
+ *  each register write.
+ *
+ *  The models implement the aliased registers of the units:  the color buffer format and the
+ *  render target 0 format, the back buffer address and the render target 0 address, the clear
+ *  color converted to the color buffer format when written, and the swap of the front and back
+ *  buffers at the end of the frame.  The register values are selected from small sets so most
+ *  of the writes are redundant.  The GPU is randomly reset (register shadow invalidated).
+ *
+ *  Usage: testRegisterWriteFilter [register writes]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPU.h"
+#include "RegisterWriteFilter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+using namespace gpu3d;
+using namespace std;
+
+//  Register state of a Color Write / DAC unit.
+struct UnitState
+{
+    u32bit format[MAX_RENDER_TARGETS];      //  Render target formats, render target 0 is the color buffer.
+    u32bit address[MAX_RENDER_TARGETS];     //  Render target addresses, render target 0 is the back buffer.
+    u32bit frontBuffer;
+    u32bit backBuffer;
+    u32bit clearColor;
+    u32bit clearColorFormat;                //  Format to which the clear color was converted.
+    map<pair<u32bit, u32bit>, u32bit> registers;
+
+    UnitState()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for(u32bit rt = 0; rt < MAX_RENDER_TARGETS; rt++)
+            format[rt] = address[rt] = 0;
+        frontBuffer = backBuffer = clearColor = clearColorFormat = 0;
+        registers.clear();
+    }
+
+    void write(GPURegister reg, u32bit subReg, u32bit value)
+    {
+        switch(reg)
+        {
+            case GPU_COLOR_BUFFER_FORMAT:
+                format[0] = value;
+                break;
+            case GPU_RENDER_TARGET_FORMAT:
+                format[subReg] = value;
+                break;
+            case GPU_COLOR_BUFFER_CLEAR:
+                clearColor = value;
+                clearColorFormat = format[0];
+                break;
+            case GPU_FRONTBUFFER_ADDR:
+                frontBuffer = value;
+                break;
+            case GPU_BACKBUFFER_ADDR:
+                backBuffer = address[0] = value;
+                break;
+            case GPU_RENDER_TARGET_ADDRESS:
+                address[subReg] = value;
+                if (subReg == 0)
+                    backBuffer = value;
+                break;
+            default:
+                registers[make_pair(u32bit(reg), subReg)] = value;
+                break;
+        }
+    }
+
+    //  End of frame:  the units swap the front and back buffers.
+    void swap()
+    {
+        u32bit aux = frontBuffer;
+        frontBuffer = backBuffer;
+        backBuffer = address[0] = aux;
+    }
+
+    bool operator!=(const UnitState &s) const
+    {
+        return (memcmp(format, s.format, sizeof(format)) != 0) || (memcmp(address, s.address, sizeof(address)) != 0) ||
+               (frontBuffer != s.frontBuffer) || (backBuffer != s.backBuffer) || (clearColor != s.clearColor) ||
+               (clearColorFormat != s.clearColorFormat) || (registers != s.registers);
+    }
+};
+
+struct RegisterTest
+{
+    GPURegister reg;
+    u32bit subRegs;
+    u32bit values;
+};
+
+static const RegisterTest registers[] =
+{
+    {GPU_COLOR_BUFFER_FORMAT, 1, 3},
+    {GPU_RENDER_TARGET_FORMAT, 2, 3},
+    {GPU_COLOR_BUFFER_CLEAR, 1, 2},
+    {GPU_FRONTBUFFER_ADDR, 1, 2},
+    {GPU_BACKBUFFER_ADDR, 1, 2},
+    {GPU_RENDER_TARGET_ADDRESS, 2, 3},
+    {GPU_Z_BUFFER_CLEAR, 1, 2},
+    {GPU_DEPTH_FUNCTION, 1, 3},
+    {GPU_BLEND_EQUATION, 4, 2}
+};
+
+int main(int argc, char *argv[])
+{
+    u32bit writes = (argc > 1) ? atoi(argv[1]) : 200000;
+    u32bit filtered = 0;
+    u32bit failed = 0;
+
+    srand(39);
+
+    RegisterWriteFilter filter;
+
+    //  Writing back the render target 0 format after changing the color buffer format
+    //  must not be filtered.
+    GPURegData formatA;
+    GPURegData formatB;
+    memset(&formatA, 0, sizeof(formatA));
+    memset(&formatB, 0, sizeof(formatB));
+    formatA.uintVal = 1;
+    formatB.uintVal = 2;
+
+    filter.isRedundant(GPU_RENDER_TARGET_FORMAT, 0, formatA);
+    filter.isRedundant(GPU_COLOR_BUFFER_FORMAT, 0, formatB);
+    if (filter.isRedundant(GPU_RENDER_TARGET_FORMAT, 0, formatA))
+    {
+        printf("RegisterWriteFilter => Render target 0 format write after a color buffer format write filtered\n");
+        failed++;
+    }
+    filter.invalidate();
+    UnitState allWrites;
+    UnitState filteredWrites;
+
+    for(u32bit w = 0; w < writes; w++)
+    {
+        u32bit action = rand() % 64;
+
+        if (action == 0)
+        {
+            //  End of frame.
+            allWrites.swap();
+            filteredWrites.swap();
+        }
+        else if (action == 1)
+        {
+            //  GPU reset.
+            allWrites.reset();
+            filteredWrites.reset();
+            filter.invalidate();
+        }
+        else
+        {
+            const RegisterTest &test = registers[rand() % (sizeof(registers) / sizeof(registers[0]))];
+            u32bit subReg = rand() % test.subRegs;
+            GPURegData data;
+
+            memset(&data, 0, sizeof(data));
+            data.uintVal = 1 + rand() % test.values;
+
+            allWrites.write(test.reg, subReg, data.uintVal);
+
+            if (filter.isRedundant(test.reg, subReg, data))
+                filtered++;
+            else
+                filteredWrites.write(test.reg, subReg, data.uintVal);
+        }
+
+        if (allWrites != filteredWrites)
+        {
+            failed++;
+
+            //  Continue from the same state.
+            filteredWrites = allWrites;
+        }
+    }
+
+    printf("RegisterWriteFilter => Register writes = %d Filtered = %d | Differ = %d\n", writes, filtered, failed);
+
+    //  The test must filter register writes.
+    bool passed = (failed == 0) && (filtered != 0);
+
+    printf("RegisterWriteFilter => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -1,83 +1,434 @@
-#include "Box.h"
-#include "StatisticsManager.h"
-
-
-class DummyBox : public Box 
-{
-
-private:
-
-	u32bit s1;
-	u32bit s2;
-	u32bit s3;
-	u32bit s4;
-	u32bit s5;
-	StatisticsManager& sm;
-
-public:
-	DummyBox( const char* name, Box* parent ) : Box(name,parent),
-
-		// Usar punteros !!!!!!!!! en vez de referencias
-		sm(StatisticsManager::getManager())
-	{	
-		// Register some statistics
-		/*
-		s1 = sm.getStatU32BIT( "stat1", this );
-		s2 = sm.getStatU32BIT( "stat2", this );
-		s3 = sm.getStatU32BIT( "stat3", this );
-		s4 = sm.getStatU32BIT( "stat4", this );
-		s5 = sm.getStatU32BIT( "stat5", this );
-		*/		
-
-		sm.getStatU32BIT( "stat1", s1, this );
-		sm.getStatU32BIT( "stat2", s2, this );
-		sm.getStatU32BIT( "stat3", s3, this );
-		sm.getStatU32BIT( "stat4", s4, this );
-		sm.getStatU32BIT( "stat5", s5, this );
-
-		cout << "COnstructor OK" << endl;
-		// initialization
-		s1 = 5;
-		s2 = 10;
-		s3 = 15;
-		s4 = 20;
-		s5 = 25;
-		
-	}
-
-	void clock( u32bit cycle ) // dummy clock, only increase in 1 the references...
-	{
-		s1++;
-		s2++;
-		s3++;
-		s4++;
-		s5++;
-	}
-};
-
-int main( void ) 
-{
-	StatisticsManager& sm = StatisticsManager::getManager();
-	
-
-	DummyBox db1("Dummy1", 0 );
-	DummyBox db2("Dummy2", 0 );
-
-	u32bit ref1;
-	sm.getStatU32BIT( "stat1", ref1 );
-	
-
-	cout << "REF1: " << ref1 << endl;
-
-	ref1 = 777;
-	/*
-
-
-	u32bit& ref1 = sm.getStatU32BIT( "otro stat" );
-	u32bit& ref2 = sm.getStatU32BIT( "otra stat mas" );	
-	u32bit& ref3 = sm.getStatU32BIT( "otra stat mas, la ultima" );
-
-  */
-	sm.dump();
-	return 0;
-}
\ No newline at end of file
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Statistics Manager test.
+ *
+ */
+
+/**
+ *
+ *  @file testSManager.cpp
+ *
+ *  Checks that the per cycle, per frame and per batch statistics dumps of the StatisticsManager
+ *  (counters stored in the CounterRegistry) are byte identical to the dumps of the previous
+ *  implementation, where each statistic stored its own value for each frequency and a reset
+ *  cleared every statistic in the manager.  The previous statistic class and dump code are
+ *  reproduced below as the reference.
+ *
+ *  Random inc, incavg, increment/decrement, max and min updates are applied to integer
+ *  statistics (the type used by the simulator boxes), some of them with a non zero initial
+ *  value and some of them created after the first dumps.  The dump period and the frame and
+ *  batch ends are also random, and the first cycles are before the dump start cycle (updates
+ *  disabled).
+ *
+ *  Usage: testSManager [cycles]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "StatisticsManager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gpu3d;
+using namespace gpu3d::GPUStatistics;
+using namespace std;
+
+//  Reference statistic:  per frequency values, cleared by the resets.
+class ReferenceStatistic
+{
+public:
+
+    virtual void inc(int times) = 0;
+    virtual void incavg(int times) = 0;
+    virtual void max(s64bit val) = 0;
+    virtual void min(s64bit val) = 0;
+    virtual void clear(int f) = 0;
+    virtual void print(ostream &os, int f) const = 0;
+    virtual ~ReferenceStatistic() {}
+};
+
+template<class T>
+class ReferenceNumericStatistic : public ReferenceStatistic
+{
+private:
+
+    T value[MAX_FREQS];
+    u64bit count[MAX_FREQS];
+
+public:
+
+    ReferenceNumericStatistic(T initialValue)
+    {
+        for(int i = 0; i < MAX_FREQS; i++)
+        {
+            value[i] = initialValue;
+            count[i] = 0;
+        }
+    }
+
+    void inc(int times)
+    {
+        if (!Statistic::isEnabled())
+            return;
+
+        for(int i = 0; i < MAX_FREQS; i++)
+            value[i] += times;
+    }
+
+    void incavg(int times)
+    {
+        if (!Statistic::isEnabled())
+            return;
+
+        for(int i = 0; i < MAX_FREQS; i++)
+        {
+            value[i] += times;
+            count[i]++;
+        }
+    }
+
+    void max(s64bit val)
+    {
+        for(int i = 0; i < MAX_FREQS; i++)
+            value[i] = (T(val) > value[i]) ? T(val) : value[i];
+    }
+
+    void min(s64bit val)
+    {
+        for(int i = 0; i < MAX_FREQS; i++)
+            value[i] = (T(val) < value[i]) ? T(val) : value[i];
+    }
+
+    void clear(int f)
+    {
+        value[f] = (T)0;
+        count[f] = 0;
+    }
+
+    void print(ostream &os, int f) const
+    {
+        if (count[f] == 0)
+            os << value[f];
+        else
+            os << ((f32bit) value[f])/((f32bit) count[f]);
+    }
+};
+
+//  Reference dumps, same scheduling than the StatisticsManager.
+class ReferenceManager
+{
+private:
+
+    map<string, ReferenceStatistic *> stats;
+    u64bit startCycle;
+    u64bit nCycles;
+    u64bit nextDump;
+    u64bit lastCycle;
+    bool cycleNamesOut;
+    bool frameNamesOut;
+    bool batchNamesOut;
+    u32bit batchCounter;
+
+    void reset(int f)
+    {
+        map<string, ReferenceStatistic *>::iterator it = stats.begin();
+        for(; it != stats.end(); it++)
+            it->second->clear(f);
+    }
+
+    void dumpNames(const char *str, ostream &os)
+    {
+        os << str;
+        map<string, ReferenceStatistic *>::iterator it = stats.begin();
+        for(; it != stats.end(); it++)
+            os << ";" << it->first;
+        os << endl;
+    }
+
+    void dumpValues(u64bit n, int f, ostream &os)
+    {
+        if (f == FREQ_CYCLES)
+            os << startCycle << ".." << lastCycle;
+        else
+            os << n;
+
+        map<string, ReferenceStatistic *>::iterator it = stats.begin();
+        for(; it != stats.end(); it++)
+        {
+            os << ";";
+            it->second->print(os, f);
+        }
+        os << endl;
+    }
+
+public:
+
+    ostringstream cycleOut;
+    ostringstream frameOut;
+    ostringstream batchOut;
+
+    ReferenceManager(u64bit start, u64bit period) : startCycle(start), nCycles(period), nextDump(start + period - 1),
+        lastCycle(0), cycleNamesOut(false), frameNamesOut(false), batchNamesOut(false), batchCounter(0)
+    {
+    }
+
+    ~ReferenceManager()
+    {
+        map<string, ReferenceStatistic *>::iterator it = stats.begin();
+        for(; it != stats.end(); it++)
+            delete it->second;
+    }
+
+    void add(const string &name, ReferenceStatistic *stat)
+    {
+        stats[name] = stat;
+    }
+
+    void clock(u64bit cycle)
+    {
+        lastCycle = cycle;
+
+        if (cycle >= nextDump)
+        {
+            if (!cycleNamesOut)
+            {
+                cycleNamesOut = true;
+                dumpNames("Cycles", cycleOut);
+            }
+
+            dumpValues(0, FREQ_CYCLES, cycleOut);
+
+            startCycle = cycle + 1;
+            reset(FREQ_CYCLES);
+            nextDump = cycle + nCycles;
+        }
+    }
+
+    void frame(u32bit frame)
+    {
+        if (!frameNamesOut)
+        {
+            frameNamesOut = true;
+            dumpNames("Frame", frameOut);
+        }
+
+        dumpValues(frame, FREQ_FRAME, frameOut);
+        reset(FREQ_FRAME);
+    }
+
+    void batch()
+    {
+        if (!batchNamesOut)
+        {
+            batchNamesOut = true;
+            dumpNames("Batch", batchOut);
+        }
+
+        dumpValues(batchCounter, FREQ_BATCH, batchOut);
+        batchCounter++;
+        reset(FREQ_BATCH);
+    }
+};
+
+//  Statistic under test and its reference.
+struct TestStatistic
+{
+    NumericStatistic<u32bit> *u32Stat;
+    NumericStatistic<s32bit> *s32Stat;
+    NumericStatistic<u64bit> *u64Stat;
+    ReferenceStatistic *reference;
+};
+
+static TestStatistic createStatistic(StatisticsManager &sm, ReferenceManager &rm, u32bit n)
+{
+    TestStatistic stat = {NULL, NULL, NULL, NULL};
+    char name[64];
+    u32bit type = n % 3;
+    u32bit initialValue = ((rand() % 4) == 0) ? (rand() % 1000) : 0;
+
+    sprintf(name, "Stat%03d", (n * 37) % 1000);
+
+    switch(type)
+    {
+        case 0:
+            stat.u32Stat = &sm.getNumericStatistic(name, u32bit(initialValue), "TestBox");
+            stat.reference = new ReferenceNumericStatistic<u32bit>(u32bit(initialValue));
+            break;
+        case 1:
+            stat.s32Stat = &sm.getNumericStatistic(name, s32bit(initialValue), "TestBox");
+            stat.reference = new ReferenceNumericStatistic<s32bit>(s32bit(initialValue));
+            break;
+        default:
+            stat.u64Stat = &sm.getNumericStatistic(name, u64bit(initialValue), "TestBox");
+            stat.reference = new ReferenceNumericStatistic<u64bit>(u64bit(initialValue));
+            break;
+    }
+
+    rm.add(name, stat.reference);
+
+    return stat;
+}
+
+static Statistic &statistic(TestStatistic &stat)
+{
+    if (stat.u32Stat != NULL)
+        return *stat.u32Stat;
+    if (stat.s32Stat != NULL)
+        return *stat.s32Stat;
+    return *stat.u64Stat;
+}
+
+static void updateStatistic(TestStatistic &stat)
+{
+    u32bit op = rand() % 8;
+    int times = (rand() % 9) - 2;
+    s64bit val = rand() % 2000;
+
+    switch(op)
+    {
+        case 0:
+        case 1:
+            statistic(stat).inc(times);
+            stat.reference->inc(times);
+            break;
+        case 2:
+            statistic(stat).incavg(times);
+            stat.reference->incavg(times);
+            break;
+        case 3:
+            statistic(stat)++;
+            stat.reference->inc(1);
+            break;
+        case 4:
+            statistic(stat)--;
+            stat.reference->inc(-1);
+            break;
+        case 5:
+        case 6:
+            if (stat.u32Stat != NULL)
+                stat.u32Stat->max(u32bit(val));
+            else if (stat.s32Stat != NULL)
+                stat.s32Stat->max(s32bit(val));
+            else
+                stat.u64Stat->max(u64bit(val));
+            stat.reference->max(val);
+            break;
+        default:
+            if (stat.u32Stat != NULL)
+                stat.u32Stat->min(u32bit(val));
+            else if (stat.s32Stat != NULL)
+                stat.s32Stat->min(s32bit(val));
+            else
+                stat.u64Stat->min(u64bit(val));
+            stat.reference->min(val);
+            break;
+    }
+}
+
+//  Compares two dumps and reports the first different line.
+static bool compareDumps(const char *name, const string &dump, const string &reference)
+{
+    u32bit lines = 0;
+    for(u32bit i = 0; i < dump.length(); i++)
+        if (dump[i] == '\n')
+            lines++;
+
+    bool equal = (dump == reference);
+
+    printf("SManager => %-6s : Bytes = %d Lines = %d | Identical = %s\n", name, u32bit(dump.length()), lines, equal ? "yes" : "no");
+
+    if (!equal)
+    {
+        istringstream a(dump);
+        istringstream b(reference);
+        string lineA;
+        string lineB;
+        u32bit line = 0;
+
+        while (getline(a, lineA) && getline(b, lineB) && (lineA == lineB))
+            line++;
+
+        printf("SManager => %-6s : first difference in line %d\n", name, line + 1);
+    }
+
+    return equal;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit cycles = (argc > 1) ? atoi(argv[1]) : 100000;
+
+    srand(32);
+
+    const u64bit startCycle = 50;
+    const u64bit period = 1 + rand() % 200;
+
+    StatisticsManager &sm = StatisticsManager::instance();
+    ReferenceManager rm(startCycle, period);
+
+    ostringstream cycleOut;
+    ostringstream frameOut;
+    ostringstream batchOut;
+
+    sm.setDumpScheduling(startCycle, period, true);
+    sm.setOutputStream(cycleOut);
+    sm.setPerFrameStream(frameOut);
+    sm.setPerBatchStream(batchOut);
+
+    vector<TestStatistic> stats;
+
+    for(u32bit s = 0; s < 40; s++)
+        stats.push_back(createStatistic(sm, rm, s));
+
+    u32bit frame = 0;
+
+    for(u32bit cycle = 0; cycle < cycles; cycle++)
+    {
+        sm.clock(cycle);
+        rm.clock(cycle);
+
+        //  New statistics after the first dumps.
+        if ((cycle == 2000) || (cycle == 30000))
+            for(u32bit s = 0; s < 10; s++)
+                stats.push_back(createStatistic(sm, rm, u32bit(stats.size())));
+
+        u32bit updates = rand() % 16;
+        for(u32bit u = 0; u < updates; u++)
+            updateStatistic(stats[rand() % stats.size()]);
+
+        if ((rand() % 500) == 0)
+        {
+            sm.frame(frame);
+            rm.frame(frame);
+            frame++;
+        }
+
+        if ((rand() % 50) == 0)
+        {
+            sm.batch();
+            rm.batch();
+        }
+    }
+
+    bool passed = compareDumps("Cycles", cycleOut.str(), rm.cycleOut.str());
+    passed = compareDumps("Frame", frameOut.str(), rm.frameOut.str()) && passed;
+    passed = compareDumps("Batch", batchOut.str(), rm.batchOut.str()) && passed;
+
+    printf("SManager => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
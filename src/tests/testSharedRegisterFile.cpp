@@ -0,0 +1,259 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Shared Register File test.
+ *
+ */
+
+/**
+ *
+ *  @file testSharedRegisterFile.cpp
+ *
+ *  Checks that the units reading the register writes from the SharedRegisterFile process the
+ *  same register writes, in the same order and in the same cycle, than when the Command
+ *  Processor sent a register write command to each unit.
+ *
+ *  Texture units:  the reference is a command signal per unit (bandwidth 1, latency 1) read
+ *  every cycle.  The register writes read from the shared register file must be processed
+ *  in the same cycles.  The texture units are randomly clocked before or after the Command
+ *  Processor.
+ *
+ *  Stamp units (Z Stencil Test and Color Write):  the commands carry the register file
+ *  version and wait a random number of cycles in the unit before being processed while new
+ *  register writes are stored.  Before each command the unit must read exactly the register
+ *  writes for its unit type issued before the command.
+ *
+ *  The register writes are random and tagged with random combinations of unit types.  The
+ *  number of writes is large enough to remove the writes already read by all the units.
+ *
+ *  Usage: testSharedRegisterFile [cycles]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPUSignal.h"
+#include "SharedRegisterFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+//  Register write processed by a unit.
+struct ProcessedWrite
+{
+    u64bit cycle;
+    u32bit reg;
+    u32bit subReg;
+    u32bit data;
+
+    bool operator!=(const ProcessedWrite &w) const
+    {
+        return (cycle != w.cycle) || (reg != w.reg) || (subReg != w.subReg) || (data != w.data);
+    }
+};
+
+//  Register write command sent through a command signal.
+class RegisterWriteCommand : public DynamicObject
+{
+public:
+
+    ProcessedWrite write;
+
+    RegisterWriteCommand(const ProcessedWrite &w) : write(w) {}
+};
+
+//  Command sent to a stamp unit.
+struct StampCommand
+{
+    u64bit version;                 //  Register file version when the command was issued.
+    vector<ProcessedWrite> writes;  //  Register writes for the unit issued before the command and after the previous command.
+};
+
+static const u32bit TEXTURE_UNITS = 4;
+static const u32bit STAMP_UNITS = 2;
+
+//  The texture units read the command signal and the shared register file every cycle.
+static void clockTextureUnits(u64bit cycle, SharedRegisterFile &regFile, vector<Signal *> &tuSignal, vector<u32bit> &tuReader,
+                              vector<vector<ProcessedWrite> > &tuReference, vector<vector<ProcessedWrite> > &tuShared)
+{
+    for(u32bit u = 0; u < TEXTURE_UNITS; u++)
+    {
+        DynamicObject *object;
+        GPURegister reg;
+        u32bit subReg;
+        GPURegData data;
+
+        if (tuSignal[u]->read(cycle, object))
+        {
+            ProcessedWrite w = static_cast<RegisterWriteCommand *>(object)->write;
+            w.cycle = cycle;
+            tuReference[u].push_back(w);
+            delete object;
+        }
+
+        while (regFile.readIssued(tuReader[u], cycle, reg, subReg, data))
+        {
+            ProcessedWrite w = {cycle, u32bit(reg), subReg, data.uintVal};
+            tuShared[u].push_back(w);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit cycles = (argc > 1) ? atoi(argv[1]) : 200000;
+
+    OptimizedDynamicMemory::initialize(512, 1024, 1024, 16, 4096, 16);
+
+    srand(40);
+
+    SharedRegisterFile regFile;
+
+    //  Texture units.
+    vector<Signal *> tuSignal;
+    vector<u32bit> tuReader;
+    vector<vector<ProcessedWrite> > tuReference(TEXTURE_UNITS);
+    vector<vector<ProcessedWrite> > tuShared(TEXTURE_UNITS);
+
+    for(u32bit u = 0; u < TEXTURE_UNITS; u++)
+    {
+        tuSignal.push_back(new Signal("TextureUnitCommand", 1, 1));
+        tuReader.push_back(regFile.addReader(SharedRegisterFile::TEXTURE_UNITS));
+    }
+
+    //  Stamp units:  a Z Stencil Test and a Color Write unit per stamp pipe.
+    static const u32bit stampUnitType[2] = {SharedRegisterFile::ZSTENCIL_UNITS, SharedRegisterFile::COLORWRITE_UNITS};
+    vector<u32bit> stampReader;
+    vector<u32bit> stampType;
+    vector<deque<StampCommand> > stampCommands;
+    vector<vector<ProcessedWrite> > stampPending;
+
+    for(u32bit u = 0; u < 2 * STAMP_UNITS; u++)
+    {
+        stampType.push_back(stampUnitType[u & 1]);
+        stampReader.push_back(regFile.addReader(stampType[u]));
+    }
+
+    stampCommands.resize(2 * STAMP_UNITS);
+    stampPending.resize(2 * STAMP_UNITS);
+
+    u32bit regWrites = 0;
+    u32bit stampCommandsProcessed = 0;
+    u32bit stampFailed = 0;
+
+    for(u64bit cycle = 0; cycle < cycles; cycle++)
+    {
+        //  The texture units are clocked before or after the Command Processor.
+        bool textureUnitsFirst = ((rand() % 2) == 0);
+
+        if (textureUnitsFirst)
+            clockTextureUnits(cycle, regFile, tuSignal, tuReader, tuReference, tuShared);
+
+        //  The stamp units process the oldest command after a random number of cycles.
+        for(u32bit u = 0; u < 2 * STAMP_UNITS; u++)
+        {
+            if (stampCommands[u].empty() || ((rand() % 8) != 0))
+                continue;
+
+            StampCommand &command = stampCommands[u].front();
+            GPURegister reg;
+            u32bit subReg;
+            GPURegData data;
+            u32bit processed = 0;
+
+            while (regFile.read(stampReader[u], command.version, reg, subReg, data))
+            {
+                if ((processed >= command.writes.size()) || (command.writes[processed].reg != u32bit(reg)) ||
+                    (command.writes[processed].subReg != subReg) || (command.writes[processed].data != data.uintVal))
+                    stampFailed++;
+                processed++;
+            }
+
+            if (processed != command.writes.size())
+                stampFailed++;
+
+            stampCommands[u].pop_front();
+            stampCommandsProcessed++;
+        }
+
+        //  The Command Processor issues a register write or a command to the stamp units.
+        u32bit action = rand() % 8;
+
+        if (action < 5)
+        {
+            GPURegData data;
+            data.uintVal = u32bit(rand());
+
+            ProcessedWrite w = {cycle, u32bit(rand() % GPU_LAST_REGISTER), u32bit(rand() % 16), data.uintVal};
+            u32bit units = 1 + rand() % 7;
+
+            regFile.write(cycle, units, GPURegister(w.reg), w.subReg, data);
+            regWrites++;
+
+            //  Previous implementation:  a register write command to each texture unit.
+            if ((units & SharedRegisterFile::TEXTURE_UNITS) != 0)
+                for(u32bit u = 0; u < TEXTURE_UNITS; u++)
+                    tuSignal[u]->write(cycle, new RegisterWriteCommand(w));
+
+            for(u32bit u = 0; u < 2 * STAMP_UNITS; u++)
+                if ((units & stampType[u]) != 0)
+                    stampPending[u].push_back(w);
+        }
+        else if (action == 5)
+        {
+            for(u32bit u = 0; u < 2 * STAMP_UNITS; u++)
+            {
+                StampCommand command;
+                command.version = regFile.getVersion();
+                command.writes.swap(stampPending[u]);
+                stampCommands[u].push_back(command);
+            }
+        }
+
+        if (!textureUnitsFirst)
+            clockTextureUnits(cycle, regFile, tuSignal, tuReader, tuReference, tuShared);
+    }
+
+    bool passed = true;
+
+    for(u32bit u = 0; u < TEXTURE_UNITS; u++)
+    {
+        u32bit failed = 0;
+
+        if (tuReference[u].size() != tuShared[u].size())
+            failed++;
+
+        for(u32bit w = 0; (w < tuReference[u].size()) && (w < tuShared[u].size()); w++)
+            if (tuReference[u][w] != tuShared[u][w])
+                failed++;
+
+        printf("SharedRegisterFile => Texture Unit %d : Register writes = %d | Differ = %d\n", u, u32bit(tuShared[u].size()), failed);
+
+        if (failed != 0)
+            passed = false;
+    }
+
+    printf("SharedRegisterFile => Stamp Units : Register writes = %d Commands = %d | Differ = %d\n", regWrites, stampCommandsProcessed, stampFailed);
+
+    if (stampFailed != 0)
+        passed = false;
+
+    for(u32bit u = 0; u < TEXTURE_UNITS; u++)
+        delete tuSignal[u];
+
+    printf("SharedRegisterFile => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
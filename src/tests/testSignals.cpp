@@ -1,55 +1,224 @@
-/*
- * SIGNALS test
- */
-
-#include "Signal.h"
-#include "QuadFloat.h" 
-
-Signal s1( "Signal1");//, 3, 2 );
-
-
-QuadFloat qfin( 1, 2, 3, 4 );
-QuadFloat qfin2( 5, 7, 11, 13 );
-
-QuadFloat* qfout = 0;
-
-// Macros for easy use of READ/WRITES tests
-#define READ(cycle,data) { cout << "Read: " << (int)s1.read(cycle,data) << endl; }
-#define WRITE(cycle,data) { cout << "Write: " << (int)s1.write(cycle,data) << endl; }
-
-// Dumps signal state
-#define DUMP() { s1.dump(); }
-
-int main( void ) {
-	
-	s1.setParameters( 3,2 );
-	
-	WRITE(2,&qfin);
-	WRITE(2,&qfin);
-	WRITE(2,&qfin);
-	WRITE(3,&qfin2);	
-
-	READ(3,qfout); // No data available yet
-	READ(4,qfout);
-	DUMP();
-	READ(4,qfout);
-	READ(4,qfout);
-	
-	cout << "Value QFOUT: " << (*qfout) << endl;
-	
-	READ(5,qfout);
-	
-	cout << "Value QFOUT: " << (*qfout) << endl;
-
-	WRITE(7,&qfin); // READ in  9
-	WRITE(8,&qfin); // READ in 10
-	
-	//DUMP();
-
-
-	cout << "Name: \"" << s1.getName() << "\"" << endl;
-	cout << "Bandwidth: " << s1.getBandwidth() << endl;
-	cout << "Latency: " << s1.getLatency() << endl;
-
-	return 0;
-}
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Signal and TypedSignal test.
+ *
+ */
+
+/**
+ *
+ *  @file testSignals.cpp
+ *
+ *  Checks that a TypedSignal delivers the same values in the same cycles and in the same
+ *  order than a Signal with the same bandwidth and latency.  Both signals receive the same
+ *  random stream of writes (random number of writes per cycle, random values and, for the
+ *  variable latency signals, random latencies) and are read every cycle with pending data.
+ *  Cycles without pending data are randomly skipped.  The values read are also checked
+ *  against a model of the expected arrival cycle of each value.
+ *
+ *  Usage: testSignals [cycles per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPUSignal.h"
+#include "TypedSignal.h"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+//  Value carried by the Signal.
+class TestValue : public DynamicObject
+{
+public:
+
+    u32bit value;
+
+    TestValue(u32bit v) : value(v) {}
+};
+
+//  Value expected by the model.
+struct ExpectedValue
+{
+    u64bit cycle;
+    u32bit value;
+};
+
+struct SignalTest
+{
+    u32bit bandwidth;
+    u32bit latency;
+    bool variableLatency;
+    bool initialData;
+};
+
+static const SignalTest signalTests[] =
+{
+    {1, 1, false, true},
+    {1, 1, false, false},
+    {1, 3, false, true},
+    {2, 2, false, false},
+    {4, 7, false, true},
+    {1, 4, true, false},
+    {2, 5, true, false},
+    {3, 9, true, false},
+    {4, 16, true, false}
+};
+
+//  Runs the same random stream through a Signal and a TypedSignal.  Returns the number of reads that differ.
+static u32bit runTest(const SignalTest &test, u32bit cycles, u32bit &reads)
+{
+    Signal signal("Signal", test.bandwidth, test.latency);
+    TypedSignal<u32bit> typedSignal("TypedSignal", test.bandwidth, test.latency);
+
+    //  Values expected in each cycle, in write order.
+    vector<deque<ExpectedValue> > expected(test.latency + 1);
+    u32bit pending = 0;
+    u32bit failed = 0;
+    u32bit nextValue = 0;
+
+    u64bit cycle = 0;
+
+    //  Default contents for the first cycles.
+    if (test.initialData)
+    {
+        vector<DynamicObject *> initial(test.latency * test.bandwidth);
+        vector<u32bit> typedInitial(test.latency * test.bandwidth);
+
+        for(u32bit i = 0; i < initial.size(); i++)
+        {
+            initial[i] = new TestValue(nextValue);
+            typedInitial[i] = nextValue;
+
+            ExpectedValue e = {i / test.bandwidth, nextValue};
+            expected[e.cycle % (test.latency + 1)].push_back(e);
+            pending++;
+            nextValue++;
+        }
+
+        signal.setData(&initial[0]);
+        typedSignal.setData(&typedInitial[0]);
+    }
+
+    for(u32bit c = 0; c < cycles; c++)
+    {
+        //  Read all the values available in the cycle from both signals.
+        deque<ExpectedValue> &arriving = expected[cycle % (test.latency + 1)];
+
+        bool signalRead = true;
+        bool typedRead = true;
+
+        while (signalRead || typedRead)
+        {
+            DynamicObject *object = NULL;
+            u32bit typedValue = 0;
+
+            signalRead = signal.read(cycle, object);
+            typedRead = typedSignal.read(cycle, typedValue);
+
+            if (!signalRead && !typedRead)
+                break;
+
+            reads++;
+
+            u32bit signalValue = signalRead ? static_cast<TestValue *>(object)->value : 0;
+            bool expectedRead = !arriving.empty() && (arriving.front().cycle == cycle);
+
+            if ((signalRead != typedRead) || (signalValue != typedValue) || !expectedRead || (arriving.front().value != typedValue))
+                failed++;
+
+            if (expectedRead)
+            {
+                arriving.pop_front();
+                pending--;
+            }
+
+            delete object;
+        }
+
+        //  Values expected in this cycle that neither signal returned.
+        while (!arriving.empty() && (arriving.front().cycle == cycle))
+        {
+            arriving.pop_front();
+            pending--;
+            failed++;
+        }
+
+        //  Write a random number of values.
+        u32bit writes = rand() % (test.bandwidth + 1);
+
+        for(u32bit w = 0; w < writes; w++)
+        {
+            u32bit latency = test.variableLatency ? (1 + rand() % test.latency) : test.latency;
+            deque<ExpectedValue> &slot = expected[(cycle + latency) % (test.latency + 1)];
+
+            //  Don't exceed the bandwidth of the destination cycle.
+            if (slot.size() == test.bandwidth)
+                continue;
+
+            if (test.variableLatency)
+            {
+                signal.write(cycle, new TestValue(nextValue), latency);
+                typedSignal.write(cycle, nextValue, latency);
+            }
+            else
+            {
+                signal.write(cycle, new TestValue(nextValue));
+                typedSignal.write(cycle, nextValue);
+            }
+
+            ExpectedValue e = {cycle + latency, nextValue};
+            slot.push_back(e);
+            pending++;
+            nextValue++;
+        }
+
+        //  Skip some cycles when there is no data pending.
+        if ((pending == 0) && ((rand() % 4) == 0))
+            cycle += 1 + rand() % (2 * test.latency + 2);
+        else
+            cycle++;
+    }
+
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit cycles = (argc > 1) ? atoi(argv[1]) : 100000;
+    bool passed = true;
+
+    OptimizedDynamicMemory::initialize(512, 1024, 1024, 16, 4096, 16);
+
+    srand(31);
+
+    for(u32bit t = 0; t < sizeof(signalTests) / sizeof(signalTests[0]); t++)
+    {
+        const SignalTest &test = signalTests[t];
+        u32bit reads = 0;
+        u32bit failed = runTest(test, cycles, reads);
+
+        printf("Signals => BW %d Latency %2d %s%s : Reads = %d | Differ = %d\n", test.bandwidth, test.latency,
+            test.variableLatency ? "variable" : "fixed   ", test.initialData ? " setData" : "        ", reads, failed);
+
+        if (failed != 0)
+            passed = false;
+    }
+
+    printf("Signals => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
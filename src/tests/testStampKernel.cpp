@@ -0,0 +1,287 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Rasterizer SIMD stamp kernel test.
+ *
+ */
+
+/**
+ *
+ *  @file testStampKernel.cpp
+ *
+ *  Checks that the SIMD stamp kernel of the rasterizer emulator (evaluateSubTilesSIMD,
+ *  generateStampSIMD and computeMSAASamplesSIMD) generates the same fragments than the
+ *  scalar path.  Two rasterizer emulators, one with the SIMD kernel enabled and one without,
+ *  rasterize the same triangles with the recursive algorithm used by the GPU emulator.  The
+ *  position, Z, edge coordinates, inside and last flags of each fragment, and the Z samples,
+ *  coverage and centroid coordinates for MSAA, must be bit identical.
+ *
+ *  The triangles are random, front and back facing, with large and small (thin and sub pixel)
+ *  triangles, vertices outside the viewport (guard band) and different w values, and axis
+ *  aligned triangles with the edges crossing the sample points (tie rules).  Each
+ *  configuration uses a different viewport, scissor, pixel coordinate, rasterization rule and
+ *  depth range convention, and MSAA mode (disabled, 2, 4, 6 and 8 samples).
+ *
+ *  Without SSE2 both rasterizer emulators use the scalar path.
+ *
+ *  Usage: testStampKernel [triangles per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "RasterizerEmulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace gpu3d;
+using namespace std;
+
+//  Fragment generated by the rasterizer emulator.
+struct FragmentRecord
+{
+    s32bit x;
+    s32bit y;
+    u32bit z;
+    f64bit coord[4];
+    bool inside;
+    bool last;
+    u32bit msaaZ[MAX_MSAA_SAMPLES];
+    bool msaaCoverage[MAX_MSAA_SAMPLES];
+};
+
+struct RasterConfig
+{
+    u32bit width;
+    u32bit height;
+    bool d3d9PixelCoordinates;
+    bool d3d9RasterizationRules;
+    bool d3d9DepthRange;
+    bool scissor;
+    u32bit msaaSamples;
+};
+
+static const RasterConfig configs[] =
+{
+    {320, 240, false, false, false, false, 0},
+    {253, 181, true, true, true, false, 0},
+    {200, 150, false, false, false, true, 0},
+    {320, 240, false, false, false, false, 2},
+    {317, 243, true, true, true, false, 4},
+    {160, 120, false, false, false, true, 6},
+    {199, 211, true, false, false, false, 8}
+};
+
+static f32bit randomValue(f32bit min, f32bit max)
+{
+    return min + (max - min) * (f32bit(rand()) / f32bit(RAND_MAX));
+}
+
+//  Random clip space position.  The first vertex is inside the view volume so the triangle is not trivially rejected.
+static void randomTriangle(const RasterConfig &config, QuadFloat *position)
+{
+    u32bit type = rand() % 5;
+
+    //  Axis aligned triangles with the vertices on pixel centers or corners (edges crossing the sample points).
+    if (type == 4)
+    {
+        f32bit offset = ((rand() % 2) == 0) ? 0.5f : 0.0f;
+        s32bit x0 = rand() % config.width;
+        s32bit y0 = rand() % config.height;
+        s32bit x1 = x0 + ((rand() % 2) ? 1 : -1) * (1 + rand() % 40);
+        s32bit y1 = y0 + ((rand() % 2) ? 1 : -1) * (1 + rand() % 40);
+
+        for(u32bit v = 0; v < 3; v++)
+        {
+            s32bit x = (v == 1) ? x1 : x0;
+            s32bit y = (v == 2) ? y1 : y0;
+
+            position[v][0] = 2.0f * (f32bit(x) + offset) / f32bit(config.width) - 1.0f;
+            position[v][1] = 2.0f * (f32bit(y) + offset) / f32bit(config.height) - 1.0f;
+            position[v][2] = randomValue(-0.99f, 0.99f);
+            position[v][3] = 1.0f;
+        }
+
+        return;
+    }
+    f32bit extent = (type == 0) ? 2.5f : ((type == 1) ? 0.02f : 1.0f);
+
+    for(u32bit v = 0; v < 3; v++)
+    {
+        f32bit w = randomValue(0.5f, 4.0f);
+
+        if (v == 0)
+        {
+            position[v][0] = randomValue(-0.9f, 0.9f);
+            position[v][1] = randomValue(-0.9f, 0.9f);
+        }
+        else
+        {
+            position[v][0] = position[0][0] + randomValue(-extent, extent);
+            position[v][1] = position[0][1] + randomValue(-extent, extent);
+        }
+
+        //  Thin triangles.
+        if ((type == 3) && (v == 2))
+        {
+            position[v][0] = position[1][0] + randomValue(-0.01f, 0.01f);
+            position[v][1] = position[1][1] + randomValue(-0.01f, 0.01f);
+        }
+
+        position[v][2] = randomValue(-0.99f, 0.99f);
+
+        position[v][0] = position[v][0] * w;
+        position[v][1] = position[v][1] * w;
+        position[v][2] = position[v][2] * w;
+        position[v][3] = w;
+    }
+}
+
+//  Rasterizes a triangle with the recursive algorithm and stores the generated fragments.
+static void rasterize(RasterizerEmulator &rastEmu, const RasterConfig &config, const QuadFloat *position, vector<FragmentRecord> &fragments)
+{
+    QuadFloat *attributes[3];
+
+    //  The setup triangle owns (and deletes) the vertex attribute arrays.
+    for(u32bit v = 0; v < 3; v++)
+    {
+        attributes[v] = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+
+        for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+            attributes[v][a] = (a == POSITION_ATTRIBUTE) ? position[v] : QuadFloat(f32bit(a), f32bit(v), 0.0f, 1.0f);
+    }
+
+    u32bit triangleID = rastEmu.setup(attributes[0], attributes[1], attributes[2]);
+
+    //  Rasterize front and back facing triangles.
+    if (rastEmu.triangleArea(triangleID) < 0)
+        rastEmu.invertTriangleFacing(triangleID);
+
+    bool msaa = (config.msaaSamples != 0);
+    u32bit batchID = rastEmu.startRecursiveMulti(&triangleID, 1, msaa);
+
+    rastEmu.updateRecursiveMultiv2(batchID);
+
+    while(!rastEmu.lastFragment(triangleID))
+    {
+        u32bit currentTriangleID;
+        Fragment **stamp = rastEmu.nextStampRecursiveMulti(batchID, currentTriangleID);
+
+        if (stamp != NULL)
+        {
+            for(u32bit p = 0; p < STAMP_FRAGMENTS; p++)
+            {
+                if (msaa)
+                    rastEmu.computeMSAASamples(stamp[p], config.msaaSamples);
+
+                FragmentRecord fr;
+
+                memset(&fr, 0, sizeof(fr));
+
+                fr.x = stamp[p]->getX();
+                fr.y = stamp[p]->getY();
+                fr.z = stamp[p]->getZ();
+                memcpy(fr.coord, stamp[p]->getCoordinates(), 3 * sizeof(f64bit));
+                fr.coord[3] = stamp[p]->getZW();
+                fr.inside = stamp[p]->isInsideTriangle();
+                fr.last = stamp[p]->isLastFragment();
+
+                if (msaa)
+                {
+                    memcpy(fr.msaaZ, stamp[p]->getMSAASamples(), config.msaaSamples * sizeof(u32bit));
+                    memcpy(fr.msaaCoverage, stamp[p]->getMSAACoverage(), config.msaaSamples * sizeof(bool));
+                }
+
+                fragments.push_back(fr);
+
+                delete stamp[p];
+            }
+        }
+        else
+            rastEmu.updateRecursiveMultiv2(batchID);
+    }
+
+    rastEmu.destroyTriangle(triangleID);
+}
+
+static void configure(RasterizerEmulator &rastEmu, const RasterConfig &config)
+{
+    rastEmu.setViewport(config.d3d9PixelCoordinates, 0, 0, config.width, config.height);
+    rastEmu.setScissor(config.width, config.height, config.scissor, config.width / 5, config.height / 7,
+                       config.width / 2, config.height / 2);
+    rastEmu.setDepthRange(config.d3d9DepthRange, 0.0f, 1.0f);
+    rastEmu.setPolygonOffset(0.0f, 0.0f);
+    rastEmu.setFaceMode(GPU_CCW);
+    rastEmu.setDepthPrecission(24);
+    rastEmu.setD3D9RasterizationRules(config.d3d9RasterizationRules);
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit triangles = (argc > 1) ? atoi(argv[1]) : 500;
+    bool passed = true;
+
+    //  Same object sizes and buckets than the test configuration.
+    OptimizedDynamicMemory::initialize(512, 262144, 4096, 32768, 64, 65536);
+
+    srand(41);
+
+    //  Same parameters than the test configuration (16x16 scan tiles, 4x4 over scan tiles, 8x8 generation tiles).
+    RasterizerEmulator scalarEmu(1, MAX_FRAGMENT_ATTRIBUTES, 16, 16, 4, 4, 8, 8, false, 8, false);
+    RasterizerEmulator simdEmu(1, MAX_FRAGMENT_ATTRIBUTES, 16, 16, 4, 4, 8, 8, false, 8, true);
+
+    for(u32bit c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        const RasterConfig &config = configs[c];
+        u32bit generated = 0;
+        u32bit failed = 0;
+
+        configure(scalarEmu, config);
+        configure(simdEmu, config);
+
+        for(u32bit t = 0; t < triangles; t++)
+        {
+            QuadFloat position[3];
+            vector<FragmentRecord> scalarFragments;
+            vector<FragmentRecord> simdFragments;
+
+            randomTriangle(config, position);
+
+            rasterize(scalarEmu, config, position, scalarFragments);
+            rasterize(simdEmu, config, position, simdFragments);
+
+            if (scalarFragments.size() != simdFragments.size())
+                failed++;
+            else
+            {
+                for(u32bit f = 0; f < scalarFragments.size(); f++)
+                    if (memcmp(&scalarFragments[f], &simdFragments[f], sizeof(FragmentRecord)) != 0)
+                        failed++;
+            }
+
+            generated += u32bit(scalarFragments.size());
+        }
+
+        printf("StampKernel => %dx%d %s %s %s%s MSAA %d : Fragments = %d | Differ = %d\n", config.width, config.height,
+            config.d3d9PixelCoordinates ? "D3D9" : "OGL ", config.d3d9RasterizationRules ? "D3D9 rules" : "OGL rules ",
+            config.d3d9DepthRange ? "D3D9 depth" : "OGL depth ", config.scissor ? " scissor" : "        ",
+            config.msaaSamples, generated, failed);
+
+        if (failed != 0)
+            passed = false;
+    }
+
+    printf("StampKernel => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
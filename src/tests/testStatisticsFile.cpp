@@ -0,0 +1,286 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Binary statistics file test.
+ *
+ */
+
+/**
+ *
+ *  @file testStatisticsFile.cpp
+ *
+ *  Round trip test of the binary statistics file format.  The StatisticsManager dumps the
+ *  same statistics to a binary stream (StatisticsFileWriter) and to a text stream.  The binary
+ *  stream is read back with the StatisticsFileReader:  the values and samples of each row must
+ *  match the values of the statistics when the row was dumped, and the CSV conversion used by
+ *  stats2csv must be byte identical to the text stream.
+ *
+ *  The statistics are unsigned, signed and floating point numeric statistics and histograms,
+ *  updated with random inc, incavg, max and min calls.  New statistics are created between
+ *  rows.  The binary streams are set twice to check that the first writers are replaced.
+ *
+ *  Usage: testStatisticsFile [rows]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "StatisticsManager.h"
+#include "StatisticsFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gpu3d;
+using namespace gpu3d::GPUStatistics;
+using namespace std;
+
+struct RowValues
+{
+    vector<string> names;
+    vector<u64bit> values;
+    vector<u64bit> samples;
+};
+
+static vector<NumericStatistic<u32bit> *> u32Stats;
+static vector<NumericStatistic<s32bit> *> s32Stats;
+static vector<NumericStatistic<f32bit> *> f32Stats;
+static vector<HistogramStatistic *> histograms;
+
+static void createStatistics(StatisticsManager &sm, u32bit n)
+{
+    char name[64];
+
+    for(u32bit s = 0; s < n; s++)
+    {
+        u32bit id = u32bit(u32Stats.size() + s32Stats.size() + f32Stats.size() + histograms.size());
+
+        sprintf(name, "Stat%03d", (id * 37) % 1000);
+
+        switch(rand() % 4)
+        {
+            case 0:
+                u32Stats.push_back(&sm.getNumericStatistic(name, u32bit(0), "TestBox"));
+                break;
+            case 1:
+                s32Stats.push_back(&sm.getNumericStatistic(name, s32bit(rand() % 100), "TestBox"));
+                break;
+            case 2:
+                f32Stats.push_back(&sm.getNumericStatistic(name, f32bit(0), "TestBox"));
+                break;
+            default:
+                histograms.push_back(&sm.getHistogramStatistic(name, "TestBox"));
+                break;
+        }
+    }
+}
+
+static void updateStatistics()
+{
+    for(u32bit u = 0; u < 200; u++)
+    {
+        u32bit op = rand() % 4;
+        s32bit val = (rand() % 3000) - 1000;
+
+        switch(rand() % 4)
+        {
+            case 0:
+                if (!u32Stats.empty())
+                {
+                    NumericStatistic<u32bit> *stat = u32Stats[rand() % u32Stats.size()];
+                    if (op == 0) stat->inc(val & 0xff); else if (op == 1) stat->incavg(val & 0xff); else if (op == 2) stat->max(u32bit(val)); else stat->inc();
+                }
+                break;
+            case 1:
+                if (!s32Stats.empty())
+                {
+                    NumericStatistic<s32bit> *stat = s32Stats[rand() % s32Stats.size()];
+                    if (op == 0) stat->inc(val); else if (op == 1) stat->incavg(val); else if (op == 2) stat->min(val); else stat->max(val);
+                }
+                break;
+            case 2:
+                if (!f32Stats.empty())
+                {
+                    NumericStatistic<f32bit> *stat = f32Stats[rand() % f32Stats.size()];
+                    if (op == 0) stat->inc(val); else if (op == 1) stat->incavg(val); else if (op == 2) stat->max(f32bit(val) * 0.25f); else stat->min(f32bit(val) * 0.5f);
+                }
+                break;
+            default:
+                if (!histograms.empty())
+                    histograms[rand() % histograms.size()]->record(u32bit(rand()) % ((op == 0) ? 100000 : 64));
+                break;
+        }
+    }
+}
+
+//  Values of all the statistics in dump order.
+static void currentValues(StatisticsManager &sm, const vector<string> &names, u32bit freq, RowValues &row)
+{
+    row.names = names;
+    row.values.clear();
+    row.samples.clear();
+
+    for(u32bit i = 0; i < names.size(); i++)
+    {
+        u64bit samples;
+        row.values.push_back(sm[names[i]]->getRawValue(freq, samples));
+        row.samples.push_back(samples);
+    }
+}
+
+//  Reads back a binary stream and checks the rows and the CSV conversion.
+static bool checkStream(const char *name, const string &binary, const string &text, const vector<RowValues> &rows, bool rangeKey)
+{
+    u32bit failed = 0;
+    u32bit rowsRead = 0;
+
+    istringstream in(binary);
+    StatisticsFileReader reader(in);
+
+    if (!reader.readHeader() || (reader.isRangeKey() != rangeKey))
+        failed++;
+    else
+    {
+        while (reader.nextRow())
+        {
+            if (rowsRead >= rows.size())
+            {
+                failed++;
+                break;
+            }
+
+            const RowValues &row = rows[rowsRead];
+
+            if (reader.getColumns() != row.names.size())
+                failed++;
+            else
+            {
+                for(u32bit c = 0; c < row.names.size(); c++)
+                {
+                    if ((reader.getColumnName(c) != row.names[c]) || (reader.getValue(c) != row.values[c]) ||
+                        (reader.getSamples(c) != row.samples[c]))
+                        failed++;
+                }
+            }
+
+            rowsRead++;
+        }
+    }
+
+    if (rowsRead != rows.size())
+        failed++;
+
+    istringstream inCSV(binary);
+    StatisticsFileReader readerCSV(inCSV);
+    ostringstream csv;
+
+    readerCSV.readHeader();
+    readerCSV.writeCSV(csv);
+
+    bool identicalCSV = (csv.str() == text);
+
+    printf("StatisticsFile => %-6s : Rows = %d | Binary = %d bytes Text = %d bytes | Differ = %d | CSV identical = %s\n",
+        name, rowsRead, u32bit(binary.length()), u32bit(text.length()), failed, identicalCSV ? "yes" : "no");
+
+    return (failed == 0) && identicalCSV;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit rowCount = (argc > 1) ? atoi(argv[1]) : 2000;
+
+    srand(33);
+
+    StatisticsManager &sm = StatisticsManager::instance();
+
+    //  Never dumps from clock, the rows are dumped below.
+    sm.setDumpScheduling(0, u64bit(-1) / 2, false);
+
+    //  The first binary writers must be replaced by the second ones.
+    ostringstream unusedCycle;
+    ostringstream unusedFrame;
+    ostringstream binaryCycle;
+    ostringstream binaryFrame;
+    ostringstream textCycle;
+    ostringstream textFrame;
+
+    sm.setBinaryOutput(true);
+    sm.setOutputStream(unusedCycle);
+    sm.setPerFrameStream(unusedFrame);
+    sm.setOutputStream(binaryCycle);
+    sm.setPerFrameStream(binaryFrame);
+
+    createStatistics(sm, 30);
+
+    vector<RowValues> cycleRows;
+    vector<RowValues> frameRows;
+    vector<string> names;
+
+    u64bit cycle = 0;
+
+    for(u32bit r = 0; r < rowCount; r++)
+    {
+        //  New statistics between rows.
+        if ((r > 0) && ((rand() % 200) == 0))
+            createStatistics(sm, 1 + rand() % 5);
+
+        updateStatistics();
+
+        cycle += 1 + rand() % 1000;
+        sm.clock(cycle);
+
+        //  Statistics in dump order (sorted by name).
+        names.clear();
+        ostringstream header;
+        sm.dumpNames("Names", header);
+        istringstream headerIn(header.str());
+        string column;
+        getline(headerIn, column, ';');
+        while (getline(headerIn, column, ';'))
+        {
+            if (!column.empty() && (column[column.length() - 1] == '\n'))
+                column.erase(column.length() - 1);
+            names.push_back(column);
+        }
+
+        RowValues row;
+        u32bit freq = ((rand() % 4) == 0) ? FREQ_FRAME : FREQ_CYCLES;
+        ostringstream &binary = (freq == FREQ_CYCLES) ? binaryCycle : binaryFrame;
+        ostringstream &text = (freq == FREQ_CYCLES) ? textCycle : textFrame;
+        vector<RowValues> &rows = (freq == FREQ_CYCLES) ? cycleRows : frameRows;
+        const char *keyName = (freq == FREQ_CYCLES) ? "Cycles" : "Frame";
+
+        currentValues(sm, names, freq, row);
+        rows.push_back(row);
+
+        if (rows.size() == 1)
+        {
+            sm.dumpNames((char *) keyName, binary);
+            sm.dumpNames((char *) keyName, text);
+        }
+
+        sm.dumpValues(r, freq, binary);
+        sm.dumpValues(r, freq, text);
+
+        sm.reset(freq);
+    }
+
+    bool passed = (unusedCycle.str().empty() && unusedFrame.str().empty());
+
+    passed = checkStream("Cycles", binaryCycle.str(), textCycle.str(), cycleRows, true) && passed;
+    passed = checkStream("Frame", binaryFrame.str(), textFrame.str(), frameRows, false) && passed;
+
+    printf("StatisticsFile => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
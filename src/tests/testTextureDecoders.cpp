@@ -0,0 +1,330 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Compressed texture block decoder test.
+ *
+ */
+
+/**
+ *
+ *  @file testTextureDecoders.cpp
+ *
+ *  Checks that the palette based DXT1/DXT3/DXT5/LATC1/LATC2 block decoders of the texture
+ *  emulator (SSE2 or scalar, depending on the build) produce the same texels than the
+ *  original per texel decoders.  The reference decoders below convert each texel with the
+ *  same single precision operations than the per texel decoders they replaced.
+ *
+ *  All the alpha and luminance reference pairs are tested.  Color blocks are tested for
+ *  equal reference colors (transparent DXT1 encoding) and for random reference colors.
+ *
+ *  Usage: testTextureDecoders [random blocks]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "TextureEmulator.h"
+#include "GPUMath.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace gpu3d;
+
+//  Reference per texel decoders.
+
+static void colorS3TC(u32bit code, const f32bit *c0, const f32bit *c1, bool transparent, f32bit *out)
+{
+    for(u32bit c = 0; c < 3; c++)
+    {
+        if (code == 0)
+            out[c] = c0[c];
+        else if (code == 1)
+            out[c] = c1[c];
+        else if (!transparent)
+            out[c] = (code == 2) ? (2 * c0[c] + c1[c]) / 3 : (c0[c] + 2 * c1[c]) / 3;
+        else
+            out[c] = (code == 2) ? (c0[c] + c1[c]) * 0.5f : 0.0f;
+    }
+}
+
+static f32bit alphaS3TC(u32bit code, f32bit a0, f32bit a1)
+{
+    if (code == 0)
+        return a0;
+    if (code == 1)
+        return a1;
+
+    if (a0 > a1)
+        return (f32bit(8 - code) * a0 + f32bit(code - 1) * a1) / 7.0f;
+
+    if (code == 6)
+        return 0.0f;
+    if (code == 7)
+        return 1.0f;
+
+    return (f32bit(6 - code) * a0 + f32bit(code - 1) * a1) / 5.0f;
+}
+
+static void referenceColors(const u8bit *data, f32bit *c0, f32bit *c1, u32bit &color0, u32bit &color1)
+{
+    color0 = (data[1] << 8) + data[0];
+    color1 = (data[3] << 8) + data[2];
+
+    c0[0] = f32bit(color0 >> 11) * (1.0f / 31.0f);
+    c0[1] = f32bit((color0 >> 5) & 0x3f) * (1.0f / 63.0f);
+    c0[2] = f32bit(color0 & 0x1f) * (1.0f / 31.0f);
+    c1[0] = f32bit(color1 >> 11) * (1.0f / 31.0f);
+    c1[1] = f32bit((color1 >> 5) & 0x3f) * (1.0f / 63.0f);
+    c1[2] = f32bit(color1 & 0x1f) * (1.0f / 31.0f);
+}
+
+static u32bit rgba8888(const f32bit *c)
+{
+    return u8bit(c[0] * 255.0f) + (u8bit(c[1] * 255.0f) << 8) + (u8bit(c[2] * 255.0f) << 16) + (u8bit(c[3] * 255.0f) << 24);
+}
+
+static u64bit codes48(const u8bit *data)
+{
+    u64bit codes = 0;
+
+    for(u32bit b = 0; b < 6; b++)
+        codes |= u64bit(data[b]) << (8 * b);
+
+    return codes;
+}
+
+static void referenceDXT(u32bit format, const u8bit *in, u8bit *out)
+{
+    if (*((u32bit *) in) == 0xDEADCAFE)
+    {
+        memset(out, 0xFF, 64);
+        return;
+    }
+
+    const u8bit *colorData = (format < 2) ? in : &in[8];
+    f32bit c0[3];
+    f32bit c1[3];
+    u32bit color0;
+    u32bit color1;
+
+    referenceColors(colorData, c0, c1, color0, color1);
+
+    u32bit colorCodes = colorData[4] + (colorData[5] << 8) + (colorData[6] << 16) + (colorData[7] << 24);
+    u64bit explicitAlpha = 0;
+    for(u32bit b = 0; b < 8; b++)
+        explicitAlpha |= u64bit(in[b]) << (8 * b);
+    u64bit alphaCodes = codes48(&in[2]);
+    f32bit a0 = f32bit(in[0]) * (1.0f / 255.0f);
+    f32bit a1 = f32bit(in[1]) * (1.0f / 255.0f);
+
+    for(u32bit j = 0; j < 4; j++)
+    {
+        for(u32bit i = 0; i < 4; i++)
+        {
+            u32bit t = j * 4 + i;
+            u32bit code = (colorCodes >> (2 * t)) & 0x03;
+            bool transparent = (format < 2) && (color0 <= color1);
+            f32bit texel[4];
+
+            colorS3TC(code, c0, c1, transparent, texel);
+
+            switch(format)
+            {
+                case 0:     //  DXT1 RGB
+                    texel[3] = 1.0f;
+                    break;
+                case 1:     //  DXT1 RGBA
+                    texel[3] = (transparent && (code == 3)) ? 0.0f : 1.0f;
+                    break;
+                case 2:     //  DXT3
+                    texel[3] = f32bit((explicitAlpha >> (4 * t)) & 0x0f) * (1.0f / 15.0f);
+                    break;
+                default:    //  DXT5
+                    texel[3] = alphaS3TC(u32bit((alphaCodes >> (3 * t)) & 0x07), a0, a1);
+                    break;
+            }
+
+            ((u32bit *) out)[GPUMath::morton(2, i, j)] = rgba8888(texel);
+        }
+    }
+}
+
+static void referenceLATC(u32bit format, const u8bit *in, u8bit *out)
+{
+    bool isSigned = (format & 1) != 0;
+    bool twoChannels = (format >= 2);
+
+    //  LATC1_SIGNED reads signed references, LATC2_SIGNED reads them as unsigned values.
+    f32bit l0 = isSigned ? (twoChannels ? f32bit(s32bit(in[0])) : f32bit(s8bit(in[0]))) * (1.0f / 127.0f) : f32bit(in[0]) * (1.0f / 255.0f);
+    f32bit l1 = isSigned ? (twoChannels ? f32bit(s32bit(in[1])) : f32bit(s8bit(in[1]))) * (1.0f / 127.0f) : f32bit(in[1]) * (1.0f / 255.0f);
+    f32bit a0 = isSigned ? f32bit(s32bit(in[8])) * (1.0f / 127.0f) : f32bit(in[8]) * (1.0f / 255.0f);
+    f32bit a1 = isSigned ? f32bit(s32bit(in[9])) * (1.0f / 127.0f) : f32bit(in[9]) * (1.0f / 255.0f);
+
+    u64bit luminanceCodes = codes48(&in[2]);
+    u64bit alphaCodes = codes48(&in[10]);
+
+    for(u32bit j = 0; j < 4; j++)
+    {
+        for(u32bit i = 0; i < 4; i++)
+        {
+            u32bit t = j * 4 + i;
+            f32bit l = alphaS3TC(u32bit((luminanceCodes >> (3 * t)) & 0x07), l0, l1);
+            f32bit a = alphaS3TC(u32bit((alphaCodes >> (3 * t)) & 0x07), a0, a1);
+            u32bit m = GPUMath::morton(2, i, j);
+
+            switch(format)
+            {
+                case 0:
+                    out[m] = u8bit(l * 255.0f);
+                    break;
+                case 1:
+                    out[m] = u8bit(s8bit(l * 127.0f));
+                    break;
+                case 2:
+                    ((u16bit *) out)[m] = u16bit(u8bit(l * 255.0f) + (u8bit(a * 255.0f) << 8));
+                    break;
+                default:
+                    ((u16bit *) out)[m] = u16bit((s8bit(l * 255.0f) & 0x00FF) + (s8bit(a * 255.0f) << 8));
+                    break;
+            }
+        }
+    }
+}
+
+typedef void (*BlockDecoder)(u8bit *, u8bit *);
+
+struct DecoderTest
+{
+    const char *name;
+    BlockDecoder decoder;
+    bool latc;
+    u32bit format;
+    u32bit outputBytes;
+};
+
+static const DecoderTest decoders[] =
+{
+    {"DXT1 RGB", &TextureEmulator::decodeBlockDXT1RGB, false, 0, 64},
+    {"DXT1 RGBA", &TextureEmulator::decodeBlockDXT1RGBA, false, 1, 64},
+    {"DXT3 RGBA", &TextureEmulator::decodeBlockDXT3RGBA, false, 2, 64},
+    {"DXT5 RGBA", &TextureEmulator::decodeBlockDXT5RGBA, false, 3, 64},
+    {"LATC1", &TextureEmulator::decodeBlockLATC1, true, 0, 16},
+    {"LATC1 Signed", &TextureEmulator::decodeBlockLATC1Signed, true, 1, 16},
+    {"LATC2", &TextureEmulator::decodeBlockLATC2, true, 2, 32},
+    {"LATC2 Signed", &TextureEmulator::decodeBlockLATC2Signed, true, 3, 32}
+};
+
+static u8bit randomByte()
+{
+    return u8bit(rand() >> 4);
+}
+
+//  Decodes a block with the emulator and the reference decoder and compares the texels.
+static bool checkBlock(const DecoderTest &test, u8bit *block)
+{
+    u8bit out[64];
+    u8bit ref[64];
+
+    test.decoder(block, out);
+
+    if (test.latc)
+        referenceLATC(test.format, block, ref);
+    else
+        referenceDXT(test.format, block, ref);
+
+    return memcmp(out, ref, test.outputBytes) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit randomBlocks = (argc > 1) ? atoi(argv[1]) : 200000;
+    bool passed = true;
+
+    srand(29);
+
+    for(u32bit d = 0; d < sizeof(decoders) / sizeof(decoders[0]); d++)
+    {
+        const DecoderTest &test = decoders[d];
+        u32bit tested = 0;
+        u32bit failed = 0;
+        u8bit block[16];
+
+        //  All the reference pairs for the alpha and luminance codes, all the codes in each block.
+        if (test.latc || (test.format == 3))
+        {
+            for(u32bit pair = 0; pair < 65536; pair++)
+            {
+                for(u32bit b = 0; b < 16; b++)
+                    block[b] = randomByte();
+
+                block[0] = block[8] = u8bit(pair & 0xff);
+                block[1] = block[9] = u8bit(pair >> 8);
+
+                //  Texel t uses code t % 8 (two full sets of 3-bit codes).
+                for(u32bit b = 0; b < 6; b++)
+                    block[2 + b] = block[10 + b] = u8bit(((0xFAC688ULL * 0x1000001ULL) >> (8 * b)) & 0xff);
+
+                if (!checkBlock(test, block))
+                    failed++;
+                tested++;
+            }
+        }
+
+        //  Equal reference colors and reference colors in both orders.
+        if (!test.latc)
+        {
+            u32bit colorOffset = (test.format < 2) ? 0 : 8;
+
+            for(u32bit color = 0; color < 65536; color++)
+            {
+                for(u32bit b = 0; b < 16; b++)
+                    block[b] = randomByte();
+
+                block[colorOffset + 0] = block[colorOffset + 2] = u8bit(color & 0xff);
+                block[colorOffset + 1] = block[colorOffset + 3] = u8bit(color >> 8);
+
+                if (color & 1)
+                    block[colorOffset + 2] ^= 0x21;
+
+                if (!checkBlock(test, block))
+                    failed++;
+                tested++;
+            }
+
+            //  Non initialized memory pattern.
+            *((u32bit *) block) = 0xDEADCAFE;
+            if (!checkBlock(test, block))
+                failed++;
+            tested++;
+        }
+
+        //  Random blocks.
+        for(u32bit r = 0; r < randomBlocks; r++)
+        {
+            for(u32bit b = 0; b < 16; b++)
+                block[b] = randomByte();
+
+            if (!checkBlock(test, block))
+                failed++;
+            tested++;
+        }
+
+        printf("TextureDecoders => %-12s : Blocks = %d | Differ = %d\n", test.name, tested, failed);
+
+        if (failed != 0)
+            passed = false;
+    }
+
+    printf("TextureDecoders => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Texture sampler kernels test.
+ *
+ */
+
+/**
+ *
+ *  @file testTextureKernels.cpp
+ *
+ *  Checks that the sampler kernels selected by the texture emulator for the texture unit
+ *  state (texel conversion specialized for the texture format and component order, and the
+ *  SSE2 or scalar bilinear filter, mipmap interpolation and anisotropic sample combine,
+ *  depending on the build) match the generic paths.
+ *
+ *  Two texture emulators with the same texture unit state convert the same random texel
+ *  data, one with the specialized texel conversions enabled and the other with the generic
+ *  convertFormat conversion.  The converted texels must be the same.  The texels converted
+ *  by the generic conversion are then filtered by the previous scalar filter (bilinearFilter,
+ *  filterTrilinear and the anisotropic sample combine of filter) reproduced below as the
+ *  reference, and the trilinear and final samples of the first emulator must be the same.
+ *  Any NaN matches any NaN.
+ *
+ *  All the texture formats supported by convertFormat are tested with all the combinations
+ *  of D3D9 color order, reversed order, sRGB conversion and comparison filter (PCF, random
+ *  comparison function), for 1D, 2D, 3D and cubemap textures.  The accesses have random
+ *  texel data, addresses, filter modes, weights, lods and anisotropic samples.
+ *
+ *  Usage: testTextureKernels [accesses per configuration]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "TextureEmulator.h"
+#include "GPUMath.h"
+#include "OptimizedDynamicMemory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace gpu3d;
+
+//  Reference bilinear filter:  previous TextureEmulator::bilinearFilter.
+static QuadFloat referenceBilinear(TextureMode mode, TextureAccess::Trilinear *trilinear, u32bit level, u32bit frag)
+{
+    QuadFloat sample;
+    f32bit a, b, c;
+
+    switch(mode)
+    {
+        case GPU_TEXTURE1D:
+
+            a = trilinear->a[frag][level];
+
+            for(u32bit i = 0; i < 4; i++)
+                sample[i] = trilinear->texel[frag][level * 2 + 1][i] * a + trilinear->texel[frag][level * 2 + 0][i] * (1.0f - a);
+
+            break;
+
+        case GPU_TEXTURE2D:
+        case GPU_TEXTURECUBEMAP:
+
+            a = trilinear->a[frag][level];
+            b = trilinear->b[frag][level];
+
+            for(u32bit i = 0; i < 4; i++)
+                sample[i] = trilinear->texel[frag][level * 4 + 0][i] * (1.0f - a) * (1.0f - b) +
+                            trilinear->texel[frag][level * 4 + 1][i] * a * (1.0f - b) +
+                            trilinear->texel[frag][level * 4 + 2][i] * (1.0f - a) * b +
+                            trilinear->texel[frag][level * 4 + 3][i] * a * b;
+
+            break;
+
+        case GPU_TEXTURE3D:
+
+            a = trilinear->a[frag][level];
+            b = trilinear->b[frag][level];
+            c = trilinear->c[frag][level];
+
+            for(u32bit i = 0; i < 4; i++)
+                sample[i] = trilinear->texel[frag][level * 8 + 0][i] * (1.0f - a) * (1.0f - b) * (1.0f - c) +
+                            trilinear->texel[frag][level * 8 + 1][i] * a * (1.0f - b) * (1.0f - c) +
+                            trilinear->texel[frag][level * 8 + 2][i] * (1.0f - a) * b * (1.0f - c) +
+                            trilinear->texel[frag][level * 8 + 3][i] * a * b * (1.0f - c)+
+                            trilinear->texel[frag][level * 8 + 4][i] * (1.0f - a) * (1.0f - b) * c +
+                            trilinear->texel[frag][level * 8 + 5][i] * a * (1.0f - b) * c +
+                            trilinear->texel[frag][level * 8 + 6][i] * (1.0f - a) * b * c +
+                            trilinear->texel[frag][level * 8 + 7][i] * a * b * c;
+
+            break;
+
+        default:
+            panic("testTextureKernels", "referenceBilinear", "Unsupported texture mode.");
+    }
+
+    return sample;
+}
+
+//  Reference trilinear filter:  previous TextureEmulator::filterTrilinear.
+static QuadFloat referenceTrilinear(TextureMode mode, TextureAccess &access, u32bit trilinearAccess, u32bit frag)
+{
+    TextureAccess::Trilinear *trilinear = access.trilinear[trilinearAccess];
+    QuadFloat sample;
+    QuadFloat t1, t2;
+    f32bit w;
+
+    switch(access.filter[frag])
+    {
+        case GPU_NEAREST:
+        case GPU_NEAREST_MIPMAP_NEAREST:
+
+            sample = trilinear->texel[frag][0];
+            break;
+
+        case GPU_LINEAR:
+        case GPU_LINEAR_MIPMAP_NEAREST:
+
+            sample = referenceBilinear(mode, trilinear, 0, frag);
+            break;
+
+        case GPU_NEAREST_MIPMAP_LINEAR:
+        case GPU_LINEAR_MIPMAP_LINEAR:
+
+            if (trilinear->sampleFromTwoMips[frag])
+            {
+                w = access.lod[frag] - static_cast<f32bit>(GPU_FLOOR(access.lod[frag]));
+
+                if (access.filter[frag] == GPU_NEAREST_MIPMAP_LINEAR)
+                {
+                    t1 = trilinear->texel[frag][0];
+                    t2 = trilinear->texel[frag][1];
+                }
+                else
+                {
+                    t1 = referenceBilinear(mode, trilinear, 0, frag);
+                    t2 = referenceBilinear(mode, trilinear, 1, frag);
+                }
+
+                for(u32bit i = 0; i < 4; i++)
+                    sample[i] = (t1[i] * (1.0f - w) + t2[i] * w);
+            }
+            else if (access.filter[frag] == GPU_NEAREST_MIPMAP_LINEAR)
+                sample = trilinear->texel[frag][0];
+            else
+                sample = referenceBilinear(mode, trilinear, 0, frag);
+
+            break;
+
+        default:
+            panic("testTextureKernels", "referenceTrilinear", "Unsupported filter mode.");
+            break;
+    }
+
+    return sample;
+}
+
+//  Reference anisotropic sample combine:  previous TextureEmulator::filter.
+static QuadFloat referenceCombine(QuadFloat *samples, u32bit anisoSamples)
+{
+    QuadFloat sample(0.0f, 0.0f, 0.0f, 0.0f);
+
+    for(u32bit s = 0; s < anisoSamples; s++)
+        for(u32bit i = 0; i < 4; i++)
+            sample[i] += samples[s][i];
+
+    for(u32bit i = 0; i < 4; i++)
+        sample[i] = sample[i] / f32bit(anisoSamples);
+
+    return sample;
+}
+
+//  Compares two texels or samples (any NaN matches any NaN).
+static bool sameQuad(QuadFloat &a, QuadFloat &b)
+{
+    for(u32bit i = 0; i < 4; i++)
+    {
+        f32bit x = a[i];
+        f32bit y = b[i];
+
+        if ((x != x) && (y != y))
+            continue;
+
+        if (memcmp(&x, &y, sizeof(f32bit)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static f32bit random01()
+{
+    return f32bit(rand() % 100000) / 100000.0f;
+}
+
+//  Creates a texture emulator, with or without the specialized texel conversions.
+static TextureEmulator *createEmulator(bool samplerKernels)
+{
+    TextureEmulator *emulator = new TextureEmulator(4, 2, 4, 0, false, 16, 8, 0, 4, 0, false,
+        16, 16, 16, 16, 4, 4, samplerKernels);
+
+    emulator->reset();
+
+    GPURegData data;
+
+    data.booleanVal = true;
+    emulator->writeRegister(GPU_TEXTURE_ENABLE, 0, data);
+
+    return emulator;
+}
+
+//  Sets the state of texture unit 0.
+static void setState(TextureEmulator *emulator, TextureMode mode, TextureFormat format, bool d3d9, bool reverse,
+                     bool sRGB, bool comparison, CompareMode function)
+{
+    GPURegData data;
+
+    data.txMode = mode;
+    emulator->writeRegister(GPU_TEXTURE_MODE, 0, data);
+    data.txFormat = format;
+    emulator->writeRegister(GPU_TEXTURE_FORMAT, 0, data);
+    data.booleanVal = d3d9;
+    emulator->writeRegister(GPU_TEXTURE_D3D9_COLOR_CONV, 0, data);
+    data.booleanVal = reverse;
+    emulator->writeRegister(GPU_TEXTURE_REVERSE, 0, data);
+    data.booleanVal = sRGB;
+    emulator->writeRegister(GPU_TEXTURE_SRGB, 0, data);
+    data.booleanVal = comparison;
+    emulator->writeRegister(GPU_TEXTURE_ENABLE_COMPARISON, 0, data);
+    data.compare = function;
+    emulator->writeRegister(GPU_TEXTURE_COMPARISON_FUNCTION, 0, data);
+}
+
+//  Creates a texture access with random filter modes, weights, lods and anisotropic samples.
+static TextureAccess *createAccess(u32bit anisoSamples)
+{
+    QuadFloat coord[STAMP_FRAGMENTS];
+    f32bit parameter[STAMP_FRAGMENTS];
+
+    //  The third coordinate is the reference value for the comparison filter.
+    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+    {
+        coord[f] = QuadFloat(random01(), random01(), random01(), 1.0f);
+        parameter[f] = 0.0f;
+    }
+
+    TextureAccess *access = new TextureAccess(0, TEXTURE_READ, coord, parameter, 0);
+
+    access->anisoSamples = anisoSamples;
+    access->trilinearToFilter = anisoSamples;
+
+    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+    {
+        access->filter[f] = FilterMode(rand() % 6);
+        access->lod[f] = random01() * 8.0f;
+        access->sample[f] = QuadFloat(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    for(u32bit s = 0; s < anisoSamples; s++)
+    {
+        access->trilinear[s] = new TextureAccess::Trilinear;
+
+        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+        {
+            access->trilinear[s]->sampleFromTwoMips[f] = ((rand() & 0x01) != 0);
+
+            for(u32bit l = 0; l < 2; l++)
+            {
+                access->trilinear[s]->a[f][l] = random01();
+                access->trilinear[s]->b[f][l] = random01();
+                access->trilinear[s]->c[f][l] = random01();
+            }
+
+            for(u32bit t = 0; t < 16; t++)
+                access->trilinear[s]->address[f][t] = u64bit(rand()) * 4 + (rand() & 0x03);
+        }
+    }
+
+    return access;
+}
+
+//  Copies the state of a texture access (the random values set by createAccess).
+static TextureAccess *copyAccess(TextureAccess *access)
+{
+    TextureAccess *copy = new TextureAccess(0, TEXTURE_READ, access->coordinates, access->parameter, 0);
+
+    copy->anisoSamples = access->anisoSamples;
+    copy->trilinearToFilter = access->trilinearToFilter;
+
+    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+    {
+        copy->filter[f] = access->filter[f];
+        copy->lod[f] = access->lod[f];
+        copy->sample[f] = access->sample[f];
+    }
+
+    for(u32bit s = 0; s < access->anisoSamples; s++)
+    {
+        copy->trilinear[s] = new TextureAccess::Trilinear;
+
+        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+        {
+            copy->trilinear[s]->sampleFromTwoMips[f] = access->trilinear[s]->sampleFromTwoMips[f];
+
+            for(u32bit l = 0; l < 2; l++)
+            {
+                copy->trilinear[s]->a[f][l] = access->trilinear[s]->a[f][l];
+                copy->trilinear[s]->b[f][l] = access->trilinear[s]->b[f][l];
+                copy->trilinear[s]->c[f][l] = access->trilinear[s]->c[f][l];
+            }
+
+            for(u32bit t = 0; t < 16; t++)
+                copy->trilinear[s]->address[f][t] = access->trilinear[s]->address[f][t];
+        }
+    }
+
+    return copy;
+}
+
+static const TextureMode modes[] = {GPU_TEXTURE1D, GPU_TEXTURE2D, GPU_TEXTURE3D, GPU_TEXTURECUBEMAP};
+
+static const char *formatNames[] =
+{
+    "ALPHA8", "ALPHA12", "ALPHA16", "DEPTH_COMPONENT16", "DEPTH_COMPONENT24", "DEPTH_COMPONENT32",
+    "LUMINANCE8", "LUMINANCE8_SIGNED", "LUMINANCE12", "LUMINANCE16", "LUMINANCE4_ALPHA4", "LUMINANCE6_ALPHA2",
+    "LUMINANCE8_ALPHA8", "LUMINANCE8_ALPHA8_SIGNED", "LUMINANCE12_ALPHA4", "LUMINANCE12_ALPHA12", "LUMINANCE16_ALPHA16",
+    "INTENSITY8", "INTENSITY12", "INTENSITY16", "RGB332", "RGB444", "RGB555", "RGB565", "RGB888", "RGB101010",
+    "RGB121212", "RGBA2222", "RGBA4444", "RGBA5551", "RGBA8888", "RGBA1010102", "R16", "RG16", "RGBA16",
+    "R16F", "RG16F", "RGBA16F", "R32F", "RG32F", "RGBA32F"
+};
+
+int main(int argc, char *argv[])
+{
+    u32bit accesses = (argc > 1) ? atoi(argv[1]) : 8;
+    bool passed = true;
+
+    OptimizedDynamicMemory::initialize(512, 1024, 4096, 1024, 16384, 256);
+
+    srand(48);
+
+    TextureEmulator *kernels = createEmulator(true);
+    TextureEmulator *generic = createEmulator(false);
+
+    for(u32bit format = GPU_ALPHA8; format <= GPU_RGBA32F; format++)
+    {
+        //  The 16 and 32 bit depth formats are not supported by convertFormat.
+        if ((format == GPU_DEPTH_COMPONENT16) || (format == GPU_DEPTH_COMPONENT32))
+            continue;
+
+        u32bit texels = 0;
+        u32bit texelsFailed = 0;
+        u32bit samplesFailed = 0;
+
+        for(u32bit m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            for(u32bit flags = 0; flags < 16; flags++)
+            {
+                bool d3d9 = (flags & 0x01) != 0;
+                bool reverse = (flags & 0x02) != 0;
+                bool sRGB = (flags & 0x04) != 0;
+                bool comparison = (flags & 0x08) != 0;
+                CompareMode function = CompareMode(rand() % 8);
+
+                setState(kernels, modes[m], TextureFormat(format), d3d9, reverse, sRGB, comparison, function);
+                setState(generic, modes[m], TextureFormat(format), d3d9, reverse, sRGB, comparison, function);
+
+                for(u32bit a = 0; a < accesses; a++)
+                {
+                    TextureAccess *kernelAccess = createAccess(1 + rand() % 4);
+                    TextureAccess *genericAccess = copyAccess(kernelAccess);
+                    u32bit anisoSamples = kernelAccess->anisoSamples;
+
+                    //  Convert the same texel data with both emulators.
+                    for(u32bit s = 0; s < anisoSamples; s++)
+                        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                            for(u32bit t = 0; t < 16; t++)
+                            {
+                                u8bit data[16];
+
+                                for(u32bit b = 0; b < 16; b++)
+                                    data[b] = u8bit(rand());
+
+                                kernels->convertFormat(*kernelAccess, s, f, t, data);
+                                generic->convertFormat(*genericAccess, s, f, t, data);
+
+                                if (!sameQuad(kernelAccess->trilinear[s]->texel[f][t], genericAccess->trilinear[s]->texel[f][t]))
+                                    texelsFailed++;
+
+                                texels++;
+                            }
+
+                    //  Filter the texels with the selected kernels and the reference filter.
+                    QuadFloat reference[MAX_ANISOTROPY][STAMP_FRAGMENTS];
+
+                    for(u32bit s = 0; s < anisoSamples; s++)
+                    {
+                        kernels->filter(*kernelAccess, s);
+
+                        for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                        {
+                            reference[s][f] = referenceTrilinear(modes[m], *genericAccess, s, f);
+
+                            if (!sameQuad(kernelAccess->trilinear[s]->sample[f], reference[s][f]))
+                                samplesFailed++;
+                        }
+                    }
+
+                    for(u32bit f = 0; f < STAMP_FRAGMENTS; f++)
+                    {
+                        QuadFloat samples[MAX_ANISOTROPY];
+
+                        for(u32bit s = 0; s < anisoSamples; s++)
+                            samples[s] = reference[s][f];
+
+                        QuadFloat sample = referenceCombine(samples, anisoSamples);
+
+                        if (!sameQuad(kernelAccess->sample[f], sample))
+                            samplesFailed++;
+                    }
+
+                    delete kernelAccess;
+                    delete genericAccess;
+                }
+            }
+        }
+
+        printf("TextureKernels => %-24s : Texels = %d | Differ = %d Samples differ = %d\n",
+            formatNames[format], texels, texelsFailed, samplesFailed);
+
+        if ((texelsFailed != 0) || (samplesFailed != 0))
+            passed = false;
+    }
+
+    delete kernels;
+    delete generic;
+
+    printf("TextureKernels => %s\n", passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Anisotropic filtering microbenchmark.
+ *
+ */
+
+/**
+ *
+ *  @file aniso.cpp
+ *
+ *  Measures the time per quad of the texture emulator address path with anisotropic
+ *  filtering (TextureEmulator::textureOperation plus TextureEmulator::calculateAddress
+ *  for every anisotropic sample) for each anisotropy algorithm, and checks that the
+ *  footprints reused from the per texture unit footprint cache produce the same samples
+ *  and addresses than footprints computed from scratch.  The comparison against the
+ *  previous footprint implementation is done by tests/testAnisoFootprint.
+ *
+ *  The quads are generated with random anisotropic derivatives that are repeated by
+ *  consecutive quads, as in a triangle with constant derivatives.
+ *
+ *  Usage: aniso [quads] [max anisotropy]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "TextureEmulator.h"
+#include "OptimizedDynamicMemory.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sys/time.h>
+
+using namespace gpu3d;
+
+static const u32bit TEXTURE_SIZE = 1024;    //  Width and height of the test texture.
+static const u32bit TEXTURE_LEVELS = 11;    //  Mipmaps of the test texture.
+static const u32bit ALGORITHMS = 5;         //  Anisotropy algorithms.
+
+static f64bit wallTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return f64bit(tv.tv_sec) + f64bit(tv.tv_usec) * 1e-6;
+}
+
+static f32bit random01()
+{
+    return f32bit(rand() % 100000) / 100000.0f;
+}
+
+//  Creates a texture emulator with a mipmapped 2D texture and trilinear anisotropic filtering in texture unit 0.
+static TextureEmulator *createEmulator(u32bit algorithm, u32bit maxAniso)
+{
+    TextureEmulator *emulator = new TextureEmulator(4, 2, 4, algorithm, false, 16, 8, 0, 4, 0, (algorithm & 1) != 0,
+        16, 16, 16, 16, 4, 4, true);
+
+    emulator->reset();
+
+    GPURegData data;
+
+    data.booleanVal = true;
+    emulator->writeRegister(GPU_TEXTURE_ENABLE, 0, data);
+    data.txMode = GPU_TEXTURE2D;
+    emulator->writeRegister(GPU_TEXTURE_MODE, 0, data);
+    data.uintVal = TEXTURE_SIZE;
+    emulator->writeRegister(GPU_TEXTURE_WIDTH, 0, data);
+    emulator->writeRegister(GPU_TEXTURE_HEIGHT, 0, data);
+    data.uintVal = TEXTURE_LEVELS - 1;
+    emulator->writeRegister(GPU_TEXTURE_WIDTH2, 0, data);
+    emulator->writeRegister(GPU_TEXTURE_HEIGHT2, 0, data);
+    emulator->writeRegister(GPU_TEXTURE_MAX_LEVEL, 0, data);
+
+    for(u32bit m = 0; m < TEXTURE_LEVELS; m++)
+    {
+        data.uintVal = 0x100000 * (m + 1);
+        emulator->writeRegister(GPU_TEXTURE_ADDRESS, m * CUBEMAP_IMAGES, data);
+    }
+
+    data.txFilter = GPU_LINEAR_MIPMAP_LINEAR;
+    emulator->writeRegister(GPU_TEXTURE_MIN_FILTER, 0, data);
+    data.txFilter = GPU_LINEAR;
+    emulator->writeRegister(GPU_TEXTURE_MAG_FILTER, 0, data);
+    data.txClamp = GPU_TEXT_REPEAT;
+    emulator->writeRegister(GPU_TEXTURE_WRAP_S, 0, data);
+    emulator->writeRegister(GPU_TEXTURE_WRAP_T, 0, data);
+    data.uintVal = maxAniso;
+    emulator->writeRegister(GPU_TEXTURE_MAX_ANISOTROPY, 0, data);
+
+    return emulator;
+}
+
+//  Generates the texture coordinates of a quad at (s, t) with the derivatives dx and dy.
+static void generateQuad(QuadFloat *coord, f32bit s, f32bit t, const f32bit *dx, const f32bit *dy)
+{
+    coord[0] = QuadFloat(s, t, 0.0f, 1.0f);
+    coord[1] = QuadFloat(s + dx[0], t + dx[1], 0.0f, 1.0f);
+    coord[2] = QuadFloat(s + dy[0], t + dy[1], 0.0f, 1.0f);
+    coord[3] = QuadFloat(s + dx[0] + dy[0], t + dx[1] + dy[1], 0.0f, 1.0f);
+}
+
+//  Issues a texture access for a quad and calculates the addresses of all the anisotropic samples.
+static TextureAccess *accessQuad(TextureEmulator *emulator, u32bit id, QuadFloat *coord)
+{
+    f32bit parameter[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    TextureAccess *access = emulator->textureOperation(id, TEXTURE_READ, coord, parameter, 0);
+
+    for(access->currentAnisoSample = 1; access->currentAnisoSample <= access->anisoSamples; access->currentAnisoSample++)
+        emulator->calculateAddress(access);
+
+    return access;
+}
+
+//  Compares the samples and texel addresses of two texture accesses.
+static bool sameAccess(TextureAccess *a, TextureAccess *b)
+{
+    if ((a->anisoSamples != b->anisoSamples) || (a->anisodsOffset != b->anisodsOffset) ||
+        (a->anisodtOffset != b->anisodtOffset) || (memcmp(a->lod, b->lod, sizeof(a->lod)) != 0))
+        return false;
+
+    for(u32bit sample = 0; sample < a->anisoSamples; sample++)
+    {
+        TextureAccess::Trilinear *ta = a->trilinear[sample];
+        TextureAccess::Trilinear *tb = b->trilinear[sample];
+
+        for(u32bit f = 0; f < 4; f++)
+        {
+            u32bit texels = ta->texelsLoop[f] * ta->loops[f];
+
+            //  Only the weights of the mipmaps sampled are defined.
+            if ((texels != tb->texelsLoop[f] * tb->loops[f]) ||
+                (memcmp(ta->address[f], tb->address[f], sizeof(u64bit) * texels) != 0) ||
+                (memcmp(ta->a[f], tb->a[f], sizeof(f32bit) * ta->loops[f]) != 0) ||
+                (memcmp(ta->b[f], tb->b[f], sizeof(f32bit) * ta->loops[f]) != 0))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit quads = (argc > 1) ? atoi(argv[1]) : 100000;
+    u32bit maxAniso = (argc > 2) ? atoi(argv[2]) : 16;
+
+    const char *names[ALGORITHMS] = {"Two axis", "Four axis", "Rectangle", "EWA", "Angle"};
+
+    OptimizedDynamicMemory::initialize(512, 1024, 4096, 1024, 16384, 256);
+
+    printf("Aniso => Quads = %d | Max anisotropy = %d\n", quads, maxAniso);
+
+    bool match = true;
+
+    for(u32bit alg = 0; alg < ALGORITHMS; alg++)
+    {
+        TextureEmulator *emulator = createEmulator(alg, maxAniso);
+        f32bit dx[2];
+        f32bit dy[2];
+        u32bit samples = 0;
+
+        //  Time the address path.
+        srand(11 + alg);
+        f64bit start = wallTime();
+        for(u32bit q = 0; q < quads; q++)
+        {
+            //  Change the derivatives every few quads.
+            if (((q % 8) == 0) || ((rand() % 3) == 0))
+            {
+                f32bit angle = random01() * 6.28f;
+                f32bit length = random01() * 0.02f;
+                f32bit ratio = 1.0f + random01() * 20.0f;
+
+                dx[0] = length * cosf(angle);
+                dx[1] = length * sinf(angle);
+                dy[0] = -length / ratio * sinf(angle + random01() * 0.5f);
+                dy[1] = length / ratio * cosf(angle);
+            }
+
+            QuadFloat coord[4];
+            generateQuad(coord, random01() * 4.0f - 2.0f, random01() * 4.0f - 2.0f, dx, dy);
+
+            TextureAccess *access = accessQuad(emulator, q, coord);
+            samples += access->anisoSamples;
+            delete access;
+        }
+        f64bit time = wallTime() - start;
+
+        //  Compare the cached footprints against footprints computed from scratch.  The reference emulator
+        //  receives a quad with different derivatives before each quad so the footprint is never reused.
+        TextureEmulator *reference = createEmulator(alg, maxAniso);
+        f32bit flush[2] = {0.001f, 0.0f};
+        u32bit differ = 0;
+
+        srand(11 + alg);
+        for(u32bit q = 0; q < quads; q++)
+        {
+            if (((q % 8) == 0) || ((rand() % 3) == 0))
+            {
+                f32bit angle = random01() * 6.28f;
+                f32bit length = random01() * 0.02f;
+                f32bit ratio = 1.0f + random01() * 20.0f;
+
+                dx[0] = length * cosf(angle);
+                dx[1] = length * sinf(angle);
+                dy[0] = -length / ratio * sinf(angle + random01() * 0.5f);
+                dy[1] = length / ratio * cosf(angle);
+            }
+
+            QuadFloat coord[4];
+            generateQuad(coord, random01() * 4.0f - 2.0f, random01() * 4.0f - 2.0f, dx, dy);
+
+            QuadFloat flushCoord[4];
+            generateQuad(flushCoord, 0.5f, 0.5f, flush, flush);
+            delete accessQuad(reference, q, flushCoord);
+
+            TextureAccess *cached = accessQuad(emulator, q, coord);
+            TextureAccess *fresh = accessQuad(reference, q, coord);
+
+            if (!sameAccess(cached, fresh))
+                differ++;
+
+            delete cached;
+            delete fresh;
+        }
+
+        if (differ != 0)
+            match = false;
+
+        printf("Aniso => %-9s : %.1f ns/quad | %.1f ns/sample | Samples/quad = %.2f | Differ = %d\n", names[alg],
+            time * 1e9 / f64bit(quads), (samples > 0) ? (time * 1e9 / f64bit(samples)) : 0.0,
+            f64bit(samples) / f64bit(quads), differ);
+
+        delete emulator;
+        delete reference;
+    }
+
+    printf("Aniso => Results %s\n", match ? "match" : "DIFFER");
+
+    return match ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Depth and color block compression microbenchmark.
+ *
+ */
+
+/**
+ *
+ *  @file compression.cpp
+ *
+ *  Measures the time per block of the ROP block compressors (FragmentOpEmulator::hiloCompress
+ *  used by the Z and color caches, and the HILO and MSAA compressor emulators used by the DAC)
+ *  and checks that every compressed block decompresses to the original block.
+ *
+ *  The blocks are read from a file with raw 256 byte blocks (for example a depth or color
+ *  buffer dumped from a trace) or generated (depth planes, flat and blended color blocks).
+ *
+ *  Usage: compression [iterations] [block file]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "FragmentOpEmulator.h"
+#include "HiloCompressorEmulator.h"
+#include "MsaaCompressorEmulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/time.h>
+
+using namespace gpu3d;
+
+static const u32bit BLOCK_VALUES = 64;  //  Values per block (256 byte ROP cache line).
+
+//  Parameters used by the Z and color caches for hiloCompress.
+static const u32bit HIMASK_NORMAL = 0xffffe000;
+static const u32bit HIMASK_BEST = 0xffffffe0;
+static const u32bit LOSHIFT_NORMAL = 13;
+static const u32bit LOSHIFT_BEST = 5;
+static const u32bit LOMASK_NORMAL = 0x00001fff;
+static const u32bit LOMASK_BEST = 0x0000001f;
+
+static f64bit wallTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return f64bit(tv.tv_sec) + f64bit(tv.tv_usec) * 1e-6;
+}
+
+//  Generates a block: a depth plane with stencil, a flat color or a color with a few samples blended.
+static void generateBlock(u32bit *block, u32bit kind)
+{
+    u32bit base = (u32bit(rand()) << 16) ^ u32bit(rand());
+    s32bit dx = (rand() % 4096) - 2048;
+    s32bit dy = (rand() % 4096) - 2048;
+
+    for(u32bit i = 0; i < BLOCK_VALUES; i++)
+    {
+        s32bit x = i & 0x07;
+        s32bit y = i >> 3;
+
+        switch(kind)
+        {
+            case 0:
+                block[i] = (base & 0xff000000) | ((base + dx * x + dy * y) & 0x00ffffff);
+                break;
+            case 1:
+                block[i] = base;
+                break;
+            default:
+                block[i] = ((rand() % 8) == 0) ? (base ^ 0x00404040) : base;
+                break;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit iterations = (argc > 1) ? atoi(argv[1]) : 200;
+    std::vector<u32bit> blocks;
+
+    if (argc > 2)
+    {
+        FILE *f = fopen(argv[2], "rb");
+
+        if (f == NULL)
+        {
+            printf("Compression => Error opening block file %s\n", argv[2]);
+            return 1;
+        }
+
+        u32bit block[BLOCK_VALUES];
+        while (fread(block, sizeof(u32bit), BLOCK_VALUES, f) == BLOCK_VALUES)
+            blocks.insert(blocks.end(), block, block + BLOCK_VALUES);
+
+        fclose(f);
+    }
+    else
+    {
+        u32bit block[BLOCK_VALUES];
+        for(u32bit b = 0; b < 4096; b++)
+        {
+            generateBlock(block, b % 3);
+            blocks.insert(blocks.end(), block, block + BLOCK_VALUES);
+        }
+    }
+
+    u32bit numBlocks = blocks.size() / BLOCK_VALUES;
+
+    if (numBlocks == 0)
+    {
+        printf("Compression => No blocks\n");
+        return 1;
+    }
+
+    HiloCompressorEmulator hiloZ(3, 0xffffffff, false);
+    HiloCompressorEmulator hiloRe(3, 0xffffffff, true);
+    MsaaCompressorEmulator msaa(BLOCK_VALUES);
+
+    const char *names[4] = {"hiloCompress", "HILO", "HILO reorder", "MSAA"};
+    CompressorEmulator *compressors[4] = {NULL, &hiloZ, &hiloRe, &msaa};
+
+    bool match = true;
+
+    printf("Compression => Blocks = %d | Iterations = %d\n", numBlocks, iterations);
+
+    std::vector<u32bit> output(numBlocks * (BLOCK_VALUES + 4));
+    std::vector<u32bit> uncompressed(numBlocks * BLOCK_VALUES);
+    std::vector<bool> success(numBlocks);
+    std::vector<u32bit> level(numBlocks);
+
+    for(u32bit c = 0; c < 4; c++)
+    {
+        //  Compress all the blocks.
+        f64bit start = wallTime();
+        for(u32bit it = 0; it < iterations; it++)
+        {
+            for(u32bit b = 0; b < numBlocks; b++)
+            {
+                u32bit *block = &blocks[b * BLOCK_VALUES];
+                u32bit *out = &output[b * (BLOCK_VALUES + 4)];
+
+                if (c == 0)
+                {
+                    u32bit min;
+                    u32bit max;
+
+                    FragmentOpEmulator::blockMinMax(block, BLOCK_VALUES, min, max);
+                    FragmentOpEmulator::CompressionMode mode = FragmentOpEmulator::hiloCompress(block, (u8bit *) out,
+                        BLOCK_VALUES, HIMASK_NORMAL, HIMASK_BEST, LOSHIFT_NORMAL, LOSHIFT_BEST, LOMASK_NORMAL, LOMASK_BEST,
+                        min, max);
+                    success[b] = (mode != FragmentOpEmulator::UNCOMPRESSED);
+                    level[b] = mode;
+                }
+                else
+                {
+                    CompressorInfo info = compressors[c]->compress(block, out, BLOCK_VALUES);
+                    success[b] = info.success;
+                    level[b] = info.level;
+                }
+            }
+        }
+        f64bit compressTime = wallTime() - start;
+
+        //  Decompress the compressed blocks.
+        u32bit compressed = 0;
+        start = wallTime();
+        for(u32bit it = 0; it < iterations; it++)
+        {
+            for(u32bit b = 0; b < numBlocks; b++)
+            {
+                if (!success[b])
+                    continue;
+
+                u32bit *in = &output[b * (BLOCK_VALUES + 4)];
+                u32bit *out = &uncompressed[b * BLOCK_VALUES];
+
+                if (c == 0)
+                    FragmentOpEmulator::hiloUncompress((u8bit *) in, out, BLOCK_VALUES,
+                        FragmentOpEmulator::CompressionMode(level[b]), HIMASK_NORMAL, HIMASK_BEST, LOSHIFT_NORMAL, LOSHIFT_BEST);
+                else
+                    compressors[c]->uncompress(in, out, BLOCK_VALUES, level[b]);
+
+                compressed++;
+            }
+        }
+        f64bit uncompressTime = wallTime() - start;
+
+        for(u32bit b = 0; b < numBlocks; b++)
+            if (success[b] && (memcmp(&blocks[b * BLOCK_VALUES], &uncompressed[b * BLOCK_VALUES], sizeof(u32bit) * BLOCK_VALUES) != 0))
+                match = false;
+
+        f64bit total = f64bit(numBlocks) * f64bit(iterations);
+
+        printf("Compression => %-12s : compress %.1f ns/block | uncompress %.1f ns/compressed block | Compressed = %.1f %%\n",
+            names[c], compressTime * 1e9 / total, (compressed > 0) ? (uncompressTime * 1e9 / compressed) : 0.0,
+            f64bit(compressed) * 100.0 / total);
+    }
+
+    printf("Compression => Results %s\n", match ? "match" : "DIFFER");
+
+    return match ? 0 : 1;
+}
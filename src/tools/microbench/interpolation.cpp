@@ -0,0 +1,144 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Attribute interpolation microbenchmark.
+ *
+ */
+
+/**
+ *
+ *  @file interpolation.cpp
+ *
+ *  Compares the per attribute interpolation (RasterizerEmulator::interpolate) used
+ *  before with the batched stamp interpolation (RasterizerEmulator::interpolateStamp).
+ *  Checks that both compute the same attributes and reports the time per fragment.
+ *
+ *  Usage: interpolation [stamps] [iterations]
+ *
+ */
+
+#include "GPUTypes.h"
+#include "support.h"
+#include "GPU.h"
+#include "OptimizedDynamicMemory.h"
+#include "RasterizerEmulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+using namespace gpu3d;
+
+static f64bit wallTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return f64bit(tv.tv_sec) + f64bit(tv.tv_usec) * 1e-6;
+}
+
+static f32bit randomValue()
+{
+    return f32bit(rand()) / f32bit(RAND_MAX) * 2.0f - 1.0f;
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit stamps = (argc > 1) ? atoi(argv[1]) : 4096;
+    u32bit iterations = (argc > 2) ? atoi(argv[2]) : 100;
+    u32bit fragments = stamps * STAMP_FRAGMENTS;
+    bool active[MAX_FRAGMENT_ATTRIBUTES];
+    bool interpolation[MAX_FRAGMENT_ATTRIBUTES];
+
+    OptimizedDynamicMemory::initialize(512, fragments + 1024, 1024, 1024, 4096, 64);
+
+    RasterizerEmulator rastEmu(1, MAX_FRAGMENT_ATTRIBUTES, 16, 16, 1, 1, 4, 4, false, 8, false);
+
+    //  Create a triangle with random vertex attributes.
+    QuadFloat *vAttr[3];
+    for(u32bit v = 0; v < 3; v++)
+    {
+        vAttr[v] = new QuadFloat[MAX_VERTEX_ATTRIBUTES];
+        for(u32bit a = 0; a < MAX_VERTEX_ATTRIBUTES; a++)
+            vAttr[v][a].setComponents(randomValue(), randomValue(), randomValue(), randomValue());
+    }
+
+    SetupTriangle *triangle = new SetupTriangle(vAttr[0], vAttr[1], vAttr[2]);
+
+    //  All attributes active and interpolated except one flat attribute.
+    for(u32bit a = 0; a < MAX_FRAGMENT_ATTRIBUTES; a++)
+    {
+        active[a] = true;
+        interpolation[a] = (a != (MAX_FRAGMENT_ATTRIBUTES - 1));
+    }
+
+    //  Create the fragments with random edge/barycentric coordinates.
+    Fragment **stamp = new Fragment*[fragments];
+    for(u32bit f = 0; f < fragments; f++)
+    {
+        f64bit coord[4];
+
+        coord[0] = f64bit(rand()) / RAND_MAX + 0.01;
+        coord[1] = f64bit(rand()) / RAND_MAX + 0.01;
+        coord[2] = f64bit(rand()) / RAND_MAX + 0.01;
+        coord[3] = 0.5;
+
+        stamp[f] = new Fragment(triangle, f & 0x01, f >> 1, 0, coord, true);
+    }
+
+    QuadFloat *reference = new QuadFloat[fragments * MAX_FRAGMENT_ATTRIBUTES];
+    QuadFloat *batched = new QuadFloat[fragments * MAX_FRAGMENT_ATTRIBUTES];
+    QuadFloat **batchedStamp = new QuadFloat*[fragments];
+
+    for(u32bit f = 0; f < fragments; f++)
+        batchedStamp[f] = &batched[f * MAX_FRAGMENT_ATTRIBUTES];
+
+    //  Per attribute interpolation.
+    f64bit start = wallTime();
+    for(u32bit it = 0; it < iterations; it++)
+    {
+        for(u32bit f = 0; f < fragments; f++)
+            for(u32bit a = 0; a < MAX_FRAGMENT_ATTRIBUTES; a++)
+                reference[f * MAX_FRAGMENT_ATTRIBUTES + a] = interpolation[a] ? rastEmu.interpolate(stamp[f], a) :
+                                                                                 rastEmu.copy(stamp[f], a, 2);
+    }
+    f64bit referenceTime = wallTime() - start;
+
+    //  Batched stamp interpolation.
+    start = wallTime();
+    for(u32bit it = 0; it < iterations; it++)
+    {
+        for(u32bit s = 0; s < stamps; s++)
+            rastEmu.interpolateStamp(&stamp[s * STAMP_FRAGMENTS], STAMP_FRAGMENTS, active, interpolation,
+                &batchedStamp[s * STAMP_FRAGMENTS]);
+    }
+    f64bit batchedTime = wallTime() - start;
+
+    bool match = (memcmp(reference, batched, sizeof(QuadFloat) * fragments * MAX_FRAGMENT_ATTRIBUTES) == 0);
+
+    f64bit totalFragments = f64bit(fragments) * f64bit(iterations);
+
+    printf("Interpolation => Fragments = %d | Attributes = %d | Iterations = %d\n", fragments, MAX_FRAGMENT_ATTRIBUTES, iterations);
+    printf("Interpolation => interpolate : %.2f ns/fragment\n", referenceTime * 1e9 / totalFragments);
+    printf("Interpolation => interpolateStamp : %.2f ns/fragment\n", batchedTime * 1e9 / totalFragments);
+    printf("Interpolation => Speedup = %.2f | Results %s\n", referenceTime / batchedTime, match ? "match" : "DIFFER");
+
+    for(u32bit f = 0; f < fragments; f++)
+        delete stamp[f];
+    delete[] stamp;
+    delete[] reference;
+    delete[] batched;
+    delete[] batchedStamp;
+    delete triangle;
+
+    return match ? 0 : 1;
+}
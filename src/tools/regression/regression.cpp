@@ -0,0 +1,963 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Parallel regression test runner.
+ *
+ * Runs the test cases in test/regression_list (same format used by
+ * test/regression.pl) with several simulator processes at the same time.  Each
+ * case runs in its own working directory (<test dir>/regression.run) with links
+ * to the trace files.  The frames are compared in memory with the frames in the
+ * reference directory of the test and the results are written to a JUnit XML
+ * report (regression.xml) and a JSON report (regression.json).
+ *
+ * The test cases with 'valid' in the seventh column run the simulator in
+ * validation mode (--valid, compared with the emulator while the frames are
+ * simulated) in <test dir>/regression.valid.run and fail on any validation
+ * error reported by the simulator.
+ *
+ */
+
+#include "GPUTypes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cerrno>
+#include <cctype>
+#include <climits>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ *  Result of the comparison of a frame with the reference frame.
+ */
+struct FrameResult
+{
+    string name;        /**<  Name of the frame file.  */
+    bool missing;       /**<  The frame is missing in the output or in the reference.  */
+    bool identical;     /**<  Output and reference are identical.  */
+    bool passed;        /**<  The frame passed the test.  */
+    f64bit psnr;        /**<  PSNR in dB (0 if identical).  */
+    u32bit maxDiff;     /**<  Maximum absolute difference between samples.  */
+    string error;       /**<  Error message.  */
+};
+
+/**
+ *  A regression test case.
+ */
+struct TestCase
+{
+    string dir;                     /**<  Test directory relative to the test path.  */
+    string config;                  /**<  Configuration file in the config directory.  */
+    string trace;                   /**<  Trace file.  */
+    string frames;                  /**<  Frames to simulate.  */
+    string startFrame;              /**<  First frame to simulate.  */
+    f64bit tolerance;               /**<  Minimum PSNR in dB for different frames.  */
+    bool validation;                /**<  Run the simulator in validation mode.  */
+
+    pid_t pid;                      /**<  Simulator process.  */
+    f64bit startTime;               /**<  Time at which the simulator was started.  */
+    f64bit time;                    /**<  Simulation and comparison time.  */
+    int exitCode;                   /**<  Exit code of the simulator (-1 if it was killed by a signal).  */
+    bool passed;                    /**<  The test passed.  */
+    string error;                   /**<  Reason of the failure.  */
+    vector<FrameResult> frameResults;   /**<  Results of the frame comparisons.  */
+};
+
+static f64bit getTime()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return f64bit(tv.tv_sec) + f64bit(tv.tv_usec) * 1E-6;
+}
+
+static string trim(const string &str)
+{
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == string::npos)
+        return "";
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+static bool endsWith(const string &str, const string &suffix)
+{
+    return (str.size() >= suffix.size()) && (str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0);
+}
+
+static bool isDirectory(const string &path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+}
+
+static vector<string> listDirectory(const string &path)
+{
+    vector<string> names;
+    DIR *dir = opendir(path.c_str());
+
+    if (dir != NULL)
+    {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            string name(entry->d_name);
+            if ((name != ".") && (name != ".."))
+                names.push_back(name);
+        }
+        closedir(dir);
+    }
+
+    sort(names.begin(), names.end());
+
+    return names;
+}
+
+static string absolutePath(const string &path)
+{
+    char buffer[PATH_MAX];
+
+    if (realpath(path.c_str(), buffer) == NULL)
+        return path;
+
+    return string(buffer);
+}
+
+//  Reads a binary (P6) 8-bit PPM file.
+static bool readPPM(const string &filename, u32bit &width, u32bit &height, vector<u8bit> &data, string &error)
+{
+    FILE *f = fopen(filename.c_str(), "rb");
+
+    if (f == NULL)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    char magic[3] = {0, 0, 0};
+    u32bit values[3];
+    bool ok = (fread(magic, 1, 2, f) == 2) && (magic[0] == 'P') && (magic[1] == '6');
+
+    //  Read width, height and maximum value skipping comments.
+    for(u32bit v = 0; ok && (v < 3); v++)
+    {
+        int c = fgetc(f);
+        while ((c == '#') || isspace(c))
+        {
+            if (c == '#')
+                while ((c != '\n') && (c != EOF))
+                    c = fgetc(f);
+            c = fgetc(f);
+        }
+
+        ok = isdigit(c);
+        values[v] = 0;
+        while (ok && isdigit(c))
+        {
+            values[v] = values[v] * 10 + (c - '0');
+            c = fgetc(f);
+        }
+
+        //  A single white space separates the header from the data.
+        ok = ok && isspace(c);
+    }
+
+    if (!ok || (values[2] != 255))
+    {
+        fclose(f);
+        error = filename + " is not a 8-bit binary PPM file";
+        return false;
+    }
+
+    width = values[0];
+    height = values[1];
+    data.resize(width * height * 3);
+
+    ok = data.empty() || (fread(&data[0], 1, data.size(), f) == data.size());
+    fclose(f);
+
+    if (!ok)
+        error = "unexpected end of file in " + filename;
+
+    return ok;
+}
+
+//  Writes the absolute difference between two images as a PPM file.
+static void writeDiffPPM(const string &filename, u32bit width, u32bit height, const vector<u8bit> &a, const vector<u8bit> &b)
+{
+    FILE *f = fopen(filename.c_str(), "wb");
+
+    if (f == NULL)
+        return;
+
+    vector<u8bit> diff(a.size());
+    for(size_t i = 0; i < a.size(); i++)
+        diff[i] = (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+    fwrite(&diff[0], 1, diff.size(), f);
+    fclose(f);
+}
+
+/**
+ *  Computes the sum of the squared differences and the maximum absolute difference
+ *  between two arrays of samples.
+ */
+static void compareSamples(const u8bit *a, const u8bit *b, size_t n, u64bit &sumSqr, u32bit &maxDiff)
+{
+    size_t i = 0;
+
+    sumSqr = 0;
+    maxDiff = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    __m128i maxV = zero;
+    size_t vectorEnd = n & ~size_t(15);
+
+    while (i < vectorEnd)
+    {
+        //  Each 32-bit lane adds at most 2 x 2 x 255^2 per iteration, flush before overflowing.
+        size_t blockEnd = min(vectorEnd, i + 16 * 4096);
+        __m128i acc = zero;
+
+        for(; i < blockEnd; i += 16)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+            __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            __m128i lo = _mm_unpacklo_epi8(d, zero);
+            __m128i hi = _mm_unpackhi_epi8(d, zero);
+
+            maxV = _mm_max_epu8(maxV, d);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, lo));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, hi));
+        }
+
+        u32bit lanes[4];
+        _mm_storeu_si128((__m128i *) lanes, acc);
+        sumSqr += u64bit(lanes[0]) + u64bit(lanes[1]) + u64bit(lanes[2]) + u64bit(lanes[3]);
+    }
+
+    u8bit maxBytes[16];
+    _mm_storeu_si128((__m128i *) maxBytes, maxV);
+    for(u32bit j = 0; j < 16; j++)
+        maxDiff = max(maxDiff, u32bit(maxBytes[j]));
+#endif
+
+    for(; i < n; i++)
+    {
+        u32bit d = (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+        sumSqr += d * d;
+        maxDiff = max(maxDiff, d);
+    }
+}
+
+//  Compares an output frame with the reference frame.
+static void compareFrame(const string &outputDir, const string &referenceDir, f64bit tolerance, FrameResult &result)
+{
+    u32bit refWidth, refHeight;
+    u32bit width, height;
+    vector<u8bit> refData;
+    vector<u8bit> data;
+
+    result.identical = false;
+    result.passed = false;
+    result.psnr = 0.0;
+    result.maxDiff = 0;
+
+    if (!readPPM(referenceDir + "/" + result.name, refWidth, refHeight, refData, result.error) ||
+        !readPPM(outputDir + "/" + result.name, width, height, data, result.error))
+        return;
+
+    if ((width != refWidth) || (height != refHeight))
+    {
+        stringstream ss;
+        ss << "resolution " << width << "x" << height << " differs from reference " << refWidth << "x" << refHeight;
+        result.error = ss.str();
+        return;
+    }
+
+    u64bit sumSqr;
+    compareSamples(&refData[0], &data[0], data.size(), sumSqr, result.maxDiff);
+
+    result.identical = (sumSqr == 0);
+
+    if (result.identical)
+        result.passed = true;
+    else
+    {
+        //  Same PSNR definition than icmp_diff.
+        f64bit rmse = sqrt(f64bit(sumSqr) / f64bit(data.size()));
+        result.psnr = 20.0 * log10(255.0 / rmse);
+        result.passed = (result.psnr >= tolerance);
+
+        if (!result.passed)
+        {
+            stringstream ss;
+            ss << "psnr is " << result.psnr << " dB (below tolerated)";
+            result.error = ss.str();
+        }
+
+        writeDiffPPM(outputDir + "/" + result.name + "_diff.ppm", width, height, refData, data);
+    }
+}
+
+//  Compares all the frames of a test case with the reference frames.
+static void compareResults(const string &outputDir, const string &referenceDir, TestCase &test)
+{
+    set<string> outputFrames;
+    set<string> referenceFrames;
+    vector<string> names;
+
+    names = listDirectory(outputDir);
+    for(size_t i = 0; i < names.size(); i++)
+        if (endsWith(names[i], ".ppm") && !endsWith(names[i], "_diff.ppm"))
+            outputFrames.insert(names[i]);
+
+    names = listDirectory(referenceDir);
+    for(size_t i = 0; i < names.size(); i++)
+        if (endsWith(names[i], ".ppm"))
+            referenceFrames.insert(names[i]);
+
+    set<string> allFrames(outputFrames);
+    allFrames.insert(referenceFrames.begin(), referenceFrames.end());
+
+    for(set<string>::iterator it = allFrames.begin(); it != allFrames.end(); it++)
+    {
+        FrameResult result;
+
+        result.name = *it;
+        result.missing = (outputFrames.count(*it) == 0) || (referenceFrames.count(*it) == 0);
+
+        if (result.missing)
+        {
+            result.identical = false;
+            result.passed = false;
+            result.psnr = 0.0;
+            result.maxDiff = 0;
+            result.error = (outputFrames.count(*it) == 0) ? "missing frame" : "frame not in reference";
+        }
+        else
+            compareFrame(outputDir, referenceDir, test.tolerance, result);
+
+        if (!result.passed)
+        {
+            test.passed = false;
+            if (test.error.empty())
+                test.error = result.name + ": " + result.error;
+        }
+
+        test.frameResults.push_back(result);
+    }
+}
+
+//  Creates the working directory of a test case with links to the input files.
+static bool prepareWorkDir(const string &testDir, const string &workDir, string &error)
+{
+    if (!isDirectory(workDir) && (mkdir(workDir.c_str(), 0755) != 0))
+    {
+        error = "cannot create " + workDir + ": " + strerror(errno);
+        return false;
+    }
+
+    //  Remove the outputs of the previous run.
+    vector<string> names = listDirectory(workDir);
+    for(size_t i = 0; i < names.size(); i++)
+        unlink((workDir + "/" + names[i]).c_str());
+
+    //  Link the trace and data files.  The outputs of regression.pl in the test directory are skipped.
+    names = listDirectory(testDir);
+    for(size_t i = 0; i < names.size(); i++)
+    {
+        const string &name = names[i];
+        string path = testDir + "/" + name;
+
+        if (isDirectory(path) || endsWith(name, ".ppm") || (name == "output.txt") || (name.compare(0, 6, "stats.") == 0) ||
+            (name == "bGPU.ini"))
+            continue;
+
+        if (symlink(path.c_str(), (workDir + "/" + name).c_str()) != 0)
+        {
+            error = "cannot link " + path + ": " + strerror(errno);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//  Name of a test case in the reports.
+static string testName(const TestCase &test)
+{
+    return test.validation ? (test.dir + " (validation)") : test.dir;
+}
+
+//  Working directory of a test case, the validation and the normal runs of a test can run at the same time.
+static string workDirectory(const string &testPath, const TestCase &test)
+{
+    return testPath + "/" + test.dir + (test.validation ? "/regression.valid.run" : "/regression.run");
+}
+
+//  Counts the validation errors reported by the simulator in the output of a test case.
+static u32bit countValidationErrors(const string &workDir)
+{
+    ifstream output((workDir + "/output.txt").c_str());
+    string line;
+    u32bit errors = 0;
+
+    while (getline(output, line))
+        if (line.compare(0, 13, "Validation =>") == 0)
+            errors++;
+
+    return errors;
+}
+
+//  Starts the simulator for a test case.
+static bool startTest(const string &binary, const string &testPath, const string &configPath, TestCase &test)
+{
+    string testDir = testPath + "/" + test.dir;
+    string workDir = workDirectory(testPath, test);
+    string config = configPath + "/" + test.config;
+
+    if (!prepareWorkDir(testDir, workDir, test.error))
+        return false;
+
+    //  In validation mode the frames are simulated with the commands of the debug loop.
+    if (test.validation)
+    {
+        ofstream commands((workDir + "/commands.txt").c_str());
+        commands << "runframe " << test.frames << endl;
+        commands << "quit" << endl;
+
+        if (!commands.good())
+        {
+            test.error = "cannot write " + workDir + "/commands.txt";
+            return false;
+        }
+    }
+
+    test.startTime = getTime();
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        test.error = string("fork failed: ") + strerror(errno);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        if (chdir(workDir.c_str()) != 0)
+            _exit(126);
+
+        //  The simulator output is saved to output.txt.
+        int fd = open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+        {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+
+        if (test.validation)
+        {
+            fd = open("commands.txt", O_RDONLY);
+            if (fd < 0)
+                _exit(126);
+            dup2(fd, STDIN_FILENO);
+            close(fd);
+        }
+
+        vector<const char *> args;
+        args.push_back(binary.c_str());
+        args.push_back("--config");
+        args.push_back(config.c_str());
+        if (test.validation)
+            args.push_back("--valid");
+        args.push_back(test.trace.c_str());
+        if (!test.frames.empty())
+            args.push_back(test.frames.c_str());
+        if (!test.startFrame.empty())
+            args.push_back(test.startFrame.c_str());
+        args.push_back(NULL);
+
+        execv(binary.c_str(), (char * const *) &args[0]);
+        _exit(127);
+    }
+
+    test.pid = pid;
+
+    return true;
+}
+
+//  Finishes a test case after the simulator ends.
+static void finishTest(const string &testPath, int status, TestCase &test)
+{
+    string testDir = testPath + "/" + test.dir;
+    string workDir = workDirectory(testPath, test);
+
+    test.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    test.passed = true;
+
+    if (test.exitCode != 0)
+    {
+        stringstream ss;
+        if (WIFSIGNALED(status))
+            ss << "INTERRUPTED (signal " << WTERMSIG(status) << ")";
+        else
+            ss << "INTERRUPTED (returned code " << test.exitCode << ")";
+        test.passed = false;
+        test.error = ss.str();
+    }
+
+    if (test.validation)
+    {
+        u32bit errors = countValidationErrors(workDir);
+
+        if (errors != 0)
+        {
+            stringstream ss;
+            ss << errors << " validation errors (see " << workDir << "/output.txt)";
+            test.passed = false;
+            if (test.error.empty())
+                test.error = ss.str();
+        }
+    }
+
+    if (!isDirectory(testDir + "/reference"))
+    {
+        test.passed = false;
+        if (test.error.empty())
+            test.error = "reference dir not found";
+    }
+    else
+        compareResults(workDir, testDir + "/reference", test);
+
+    test.time = getTime() - test.startTime;
+}
+
+static string xmlEscape(const string &str)
+{
+    string out;
+
+    for(size_t i = 0; i < str.size(); i++)
+    {
+        switch (str[i])
+        {
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '&': out += "&amp;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += str[i]; break;
+        }
+    }
+
+    return out;
+}
+
+static string jsonEscape(const string &str)
+{
+    string out;
+
+    for(size_t i = 0; i < str.size(); i++)
+    {
+        switch (str[i])
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default: out += str[i]; break;
+        }
+    }
+
+    return out;
+}
+
+static void writeJUnitReport(const string &filename, const vector<TestCase> &tests, f64bit totalTime)
+{
+    ofstream out(filename.c_str());
+    u32bit failures = 0;
+
+    for(size_t t = 0; t < tests.size(); t++)
+        if (!tests[t].passed)
+            failures++;
+
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
+    out << "<testsuite name=\"regression\" tests=\"" << tests.size() << "\" failures=\"" << failures
+        << "\" errors=\"0\" time=\"" << totalTime << "\">" << endl;
+
+    for(size_t t = 0; t < tests.size(); t++)
+    {
+        const TestCase &test = tests[t];
+        string className = test.dir.substr(0, test.dir.find('/'));
+
+        out << "  <testcase classname=\"" << xmlEscape(className) << "\" name=\"" << xmlEscape(testName(test))
+            << "\" time=\"" << test.time << "\">" << endl;
+
+        if (!test.passed)
+            out << "    <failure message=\"" << xmlEscape(test.error) << "\"/>" << endl;
+
+        out << "    <system-out>" << endl;
+        for(size_t f = 0; f < test.frameResults.size(); f++)
+        {
+            const FrameResult &frame = test.frameResults[f];
+
+            out << xmlEscape(frame.name) << ": ";
+            if (!frame.error.empty())
+                out << xmlEscape(frame.error);
+            else if (frame.identical)
+                out << "identical";
+            else
+                out << "psnr " << frame.psnr << " dB, max diff " << frame.maxDiff;
+            out << endl;
+        }
+        out << "    </system-out>" << endl;
+        out << "  </testcase>" << endl;
+    }
+
+    out << "</testsuite>" << endl;
+}
+
+static void writeJSONReport(const string &filename, const vector<TestCase> &tests, f64bit totalTime)
+{
+    ofstream out(filename.c_str());
+
+    out << "{" << endl;
+    out << "   \"time\" : " << totalTime << "," << endl;
+    out << "   \"tests\" : [" << endl;
+
+    for(size_t t = 0; t < tests.size(); t++)
+    {
+        const TestCase &test = tests[t];
+
+        out << "      {" << endl;
+        out << "         \"name\" : \"" << jsonEscape(test.dir) << "\"," << endl;
+        out << "         \"config\" : \"" << jsonEscape(test.config) << "\"," << endl;
+        out << "         \"trace\" : \"" << jsonEscape(test.trace) << "\"," << endl;
+        out << "         \"tolerance\" : " << test.tolerance << "," << endl;
+        out << "         \"validation\" : " << (test.validation ? "true" : "false") << "," << endl;
+        out << "         \"passed\" : " << (test.passed ? "true" : "false") << "," << endl;
+        out << "         \"exit_code\" : " << test.exitCode << "," << endl;
+        out << "         \"time\" : " << test.time << "," << endl;
+        out << "         \"error\" : \"" << jsonEscape(test.error) << "\"," << endl;
+        out << "         \"frames\" : [" << endl;
+
+        for(size_t f = 0; f < test.frameResults.size(); f++)
+        {
+            const FrameResult &frame = test.frameResults[f];
+
+            out << "            { \"name\" : \"" << jsonEscape(frame.name) << "\", \"passed\" : " << (frame.passed ? "true" : "false")
+                << ", \"identical\" : " << (frame.identical ? "true" : "false") << ", \"psnr\" : " << frame.psnr
+                << ", \"max_diff\" : " << frame.maxDiff << ", \"error\" : \"" << jsonEscape(frame.error) << "\" }"
+                << ((f + 1 < test.frameResults.size()) ? "," : "") << endl;
+        }
+
+        out << "         ]" << endl;
+        out << "      }" << ((t + 1 < tests.size()) ? "," : "") << endl;
+    }
+
+    out << "   ]" << endl;
+    out << "}" << endl;
+}
+
+static bool isNumber(const string &str, bool decimal)
+{
+    char *end;
+
+    if (str.empty())
+        return false;
+
+    if (decimal)
+        strtod(str.c_str(), &end);
+    else
+        strtoul(str.c_str(), &end, 10);
+
+    return (*end == 0) && (decimal || isdigit(str[0]));
+}
+
+/**
+ *  Parses the columns of a test case:  test directory, configuration file, trace file and the optional
+ *  frames, start frame, tolerance and 'valid' columns (same format than regression.pl).
+ */
+static bool parseTestCase(const vector<string> &fields, TestCase &test, string &error)
+{
+    if ((fields.size() < 3) || (fields.size() > 7))
+    {
+        error = "expected 3 to 7 columns";
+        return false;
+    }
+
+    for(u32bit f = 0; f < 3; f++)
+    {
+        if (fields[f].empty())
+        {
+            error = "empty test directory, configuration or trace column";
+            return false;
+        }
+    }
+
+    test.dir = fields[0];
+    test.config = fields[1];
+    test.trace = fields[2];
+    test.frames = (fields.size() > 3) ? fields[3] : "";
+    test.startFrame = (fields.size() > 4) ? fields[4] : "";
+    test.tolerance = (fields.size() > 5) ? atof(fields[5].c_str()) : 0.0;
+    test.validation = (fields.size() > 6);
+
+    if ((fields.size() > 3) && !isNumber(test.frames, false))
+    {
+        error = "the frames column is not a number";
+        return false;
+    }
+
+    if ((fields.size() > 4) && !isNumber(test.startFrame, false))
+    {
+        error = "the start frame column is not a number";
+        return false;
+    }
+
+    if ((fields.size() > 5) && !isNumber(fields[5], true))
+    {
+        error = "the tolerance column is not a number";
+        return false;
+    }
+
+    if (test.validation && (fields[6] != "valid"))
+    {
+        error = "unknown seventh column '" + fields[6] + "' (only 'valid' is supported)";
+        return false;
+    }
+
+    return true;
+}
+
+static void usage()
+{
+    printf("Usage:\n");
+    printf("  regression [-j jobs] [-l regression list] [-b simulator binary] [-o report name] [test path]\n");
+    printf("\n");
+    printf("  -j  Number of test cases simulated at the same time (default: number of processors).\n");
+    printf("  -l  Test case list (default: <test path>/regression_list).\n");
+    printf("  -b  Simulator binary (default: <test path>/../bin/bGPU-Uni).\n");
+    printf("  -o  Name of the reports without extension (default: <test path>/regression).\n");
+    printf("\n");
+    printf("  The default test path is the current directory.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    u32bit jobs = 0;
+    string testPath = ".";
+    string listFile;
+    string binary;
+    string reportName;
+
+    for(int a = 1; a < argc; a++)
+    {
+        string arg(argv[a]);
+
+        if ((arg == "-j") && (a + 1 < argc))
+            jobs = atoi(argv[++a]);
+        else if ((arg == "-l") && (a + 1 < argc))
+            listFile = argv[++a];
+        else if ((arg == "-b") && (a + 1 < argc))
+            binary = argv[++a];
+        else if ((arg == "-o") && (a + 1 < argc))
+            reportName = argv[++a];
+        else if ((arg == "-h") || (arg == "--help") || (arg[0] == '-'))
+        {
+            usage();
+            exit(-1);
+        }
+        else
+            testPath = arg;
+    }
+
+    testPath = absolutePath(testPath);
+
+    if (listFile.empty())
+        listFile = testPath + "/regression_list";
+    if (binary.empty())
+        binary = testPath + "/../bin/bGPU-Uni";
+    if (reportName.empty())
+        reportName = testPath + "/regression";
+    if (jobs == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = (cpus > 0) ? u32bit(cpus) : 1;
+    }
+
+    binary = absolutePath(binary);
+    string configPath = testPath + "/config";
+
+    if (access(binary.c_str(), X_OK) != 0)
+    {
+        printf("gpu3d binary not found in %s\n", binary.c_str());
+        exit(-1);
+    }
+
+    //  Read the test cases.
+    ifstream list(listFile.c_str());
+
+    if (!list.is_open())
+    {
+        printf("ERROR: Cannot open %s\n", listFile.c_str());
+        exit(-1);
+    }
+
+    vector<TestCase> tests;
+    string line;
+    u32bit lineNumber = 0;
+
+    while (getline(list, line))
+    {
+        lineNumber++;
+
+        if (trim(line).empty() || (trim(line)[0] == '#'))
+            continue;
+
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+
+        while (getline(ss, field, ','))
+            fields.push_back(trim(field));
+
+        TestCase test;
+        string error;
+
+        //  Lines that are not understood stop the run, a column ignored would run a different test.
+        if (!parseTestCase(fields, test, error))
+        {
+            printf("ERROR: %s:%d: %s: %s\n", listFile.c_str(), lineNumber, error.c_str(), line.c_str());
+            exit(-1);
+        }
+
+        test.pid = 0;
+        test.startTime = 0.0;
+        test.time = 0.0;
+        test.exitCode = 0;
+        test.passed = false;
+
+        tests.push_back(test);
+    }
+
+    printf("Running %d test cases, %d at a time...\n", u32bit(tests.size()), jobs);
+    fflush(stdout);
+
+    f64bit startTime = getTime();
+
+    //  Keep up to 'jobs' simulators running, compare the frames of a test case when its simulator ends.
+    map<pid_t, u32bit> running;
+    u32bit nextTest = 0;
+    u32bit failed = 0;
+
+    while ((nextTest < tests.size()) || !running.empty())
+    {
+        while ((nextTest < tests.size()) && (running.size() < jobs))
+        {
+            TestCase &test = tests[nextTest];
+
+            if (!isDirectory(testPath + "/" + test.dir))
+            {
+                test.error = "test not found";
+                printf("%s test not found\n", testName(test).c_str());
+                failed++;
+            }
+            else if (!startTest(binary, testPath, configPath, test))
+            {
+                printf("%s FAILED: %s\n", testName(test).c_str(), test.error.c_str());
+                failed++;
+            }
+            else
+                running[test.pid] = nextTest;
+
+            nextTest++;
+        }
+
+        if (running.empty())
+            continue;
+
+        int status;
+        pid_t pid = wait(&status);
+
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        map<pid_t, u32bit>::iterator it = running.find(pid);
+        if (it == running.end())
+            continue;
+
+        TestCase &test = tests[it->second];
+        running.erase(it);
+
+        finishTest(testPath, status, test);
+
+        if (test.passed)
+            printf("%s PASS (%.1f s)\n", testName(test).c_str(), test.time);
+        else
+        {
+            printf("%s FAILED: %s\n", testName(test).c_str(), test.error.c_str());
+            failed++;
+        }
+
+        for(size_t f = 0; f < test.frameResults.size(); f++)
+        {
+            const FrameResult &frame = test.frameResults[f];
+
+            if (!frame.error.empty())
+                printf("    %s: %s\n", frame.name.c_str(), frame.error.c_str());
+            else if (frame.identical)
+                printf("    %s: output images are identical\n", frame.name.c_str());
+            else
+                printf("    %s: psnr is %g dB, max diff %d (tolerance %g dB)\n", frame.name.c_str(), frame.psnr,
+                    frame.maxDiff, test.tolerance);
+        }
+
+        fflush(stdout);
+    }
+
+    f64bit totalTime = getTime() - startTime;
+
+    writeJUnitReport(reportName + ".xml", tests, totalTime);
+    writeJSONReport(reportName + ".json", tests, totalTime);
+
+    printf("\n%d of %d test cases passed in %.1f s.  Reports written to %s.xml and %s.json\n",
+        u32bit(tests.size()) - failed, u32bit(tests.size()), totalTime, reportName.c_str(), reportName.c_str());
+
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ * Converts binary statistics files (BinaryStatistics = TRUE) to the CSV
+ * format written by the simulator.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include "StatisticsFile.h"
+#include "zfstream.h"
+
+using namespace std;
+using namespace gpu3d;
+using namespace gpu3d::GPUStatistics;
+
+int main(int argc, char* argv[])
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        printf("Usage:\n");
+        printf("  stats2csv <binary statistics file> [<csv file>]\n");
+        exit(-1);
+    }
+
+    //  Compressed and uncompressed files are read through zlib.
+    gzifstream inFile;
+
+    inFile.open(argv[1], ios::in | ios::binary);
+
+    if (!inFile.is_open())
+    {
+        printf("Error opening binary statistics file %s\n", argv[1]);
+        exit(-1);
+    }
+
+    ofstream outFile;
+
+    if (argc == 3)
+    {
+        outFile.open(argv[2], ios::out);
+
+        if (!outFile.is_open())
+        {
+            printf("Error opening output file %s\n", argv[2]);
+            exit(-1);
+        }
+    }
+
+    ostream &out = (argc == 3) ? outFile : cout;
+
+    StatisticsFileReader reader(inFile);
+
+    if (!reader.readHeader())
+    {
+        printf("%s is not a binary statistics file\n", argv[1]);
+        exit(-1);
+    }
+
+    reader.writeCSV(out);
+
+    inFile.close();
+
+    return 0;
+}
@@ -698,7 +698,7 @@ void ACDSamplerImp::_syncTexture()
             acd_uint md;
             if (texture2D)
             {
-                moa.syncGPU(texture2D, mipRegion);
+                moa.syncGPU(texture2D, mipRegion, true);
                 md = moa.md(texture2D, mipRegion);
 
 #ifdef ACD_DUMP_SAMPLERS
@@ -709,7 +709,7 @@ void ACDSamplerImp::_syncTexture()
             }
             else if (textureCM)
             {
-                moa.syncGPU(textureCM, mipRegion);
+                moa.syncGPU(textureCM, mipRegion, true);
                 md = moa.md(textureCM, mipRegion);
 
 #ifdef ACD_DUMP_SAMPLERS
@@ -720,7 +720,7 @@ void ACDSamplerImp::_syncTexture()
             }
 			else
 			{
-                moa.syncGPU(texture3D, mipRegion);
+                moa.syncGPU(texture3D, mipRegion, true);
                 md = moa.md(texture3D, mipRegion);
 			}
 
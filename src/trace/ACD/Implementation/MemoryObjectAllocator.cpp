@@ -41,7 +41,7 @@ MemoryObjectAllocator::MemoryObjectInfo* MemoryObjectAllocator::_findMOI(MemoryO
 //  2. The region passed as parameter its in state MOS_NotSync
 // This method also requires that the MemoryObjectInfo corresponds to
 // the memory object passed as argument
-void MemoryObjectAllocator::_update(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region)
+void MemoryObjectAllocator::_update(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region, acd_bool lazy)
 {
     // Gets the memory data of this object
     acd_uint memorySizeDummy;
@@ -54,8 +54,14 @@ void MemoryObjectAllocator::_update(MemoryObject* mo, MemoryObjectInfo* moi, acd
     acd_uint startByte, lastByte;
     mo->getUpdateRange(region, startByte, lastByte);
 
+    //  Check if the region can be written into GPU memory when first accessed.
+    if (lazy && _driver->getLazyTextureResidency())
+    {
+        // Update the GPU memory corresponding to the region 
+        _driver->writeMemoryLazy((*moi)[region].md, startByte, data + startByte, lastByte - startByte + 1);
+    }
     //  Check if the region contains data to be preloaded into GPU memory.
-    if (mo->isPreload(region))
+    else if (mo->isPreload(region))
     {
         // Update the GPU memory corresponding to the region 
 	    _driver->writeMemoryPreload((*moi)[region].md, startByte, data + startByte, lastByte - startByte + 1);
@@ -97,7 +103,7 @@ void MemoryObjectAllocator::_addRegionToMOI(MemoryObjectInfo* moi, acd_uint regi
 }
 
 
-void MemoryObjectAllocator::_alloc( MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region )
+void MemoryObjectAllocator::_alloc( MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region, acd_bool lazy )
 {
     // Get the memory data of the memory object and its size in bytes
     acd_uint size;
@@ -115,8 +121,14 @@ void MemoryObjectAllocator::_alloc( MemoryObject* mo, MemoryObjectInfo* moi, acd
     else
         panic("MemoryObjectAllocator", "_alloc", "Unknown memory type");
 
+    //  Check if the memory region can be written into GPU memory when first accessed.
+    if (lazy && _driver->getLazyTextureResidency())
+    {
+        // Update the GPU memory
+        _driver->writeMemoryLazy(md, 0, data, size);
+    }
     //  Check if the memory region contains data to be preloaded into GPU memory.
-    if (mo->isPreload(region))
+    else if (mo->isPreload(region))
     {
         // Update the GPU memory
         _driver->writeMemoryPreload(md, 0, data, size);
@@ -159,7 +171,7 @@ void MemoryObjectAllocator::syncGPU(MemoryObject* mo)
         syncGPU(mo, *it);
 }
 
-acd_bool MemoryObjectAllocator::syncGPU(MemoryObject* mo, acd_uint region)
+acd_bool MemoryObjectAllocator::syncGPU(MemoryObject* mo, acd_uint region, acd_bool lazy)
 {
     ACD_ASSERT
     (
@@ -190,13 +202,13 @@ acd_bool MemoryObjectAllocator::syncGPU(MemoryObject* mo, acd_uint region)
             else if ( moi->find(region) != moi->end() )
                 _dealloc(mo, moi, region); // deallocate previous region
 
-            _alloc(mo, moi, region);
+            _alloc(mo, moi, region, lazy);
 
 			mo->lock(region, true);
 			lockInMem->push_back(lockedRegion(mo,region));
             break;
         case MOS_NotSync:            
-            _update(mo, moi, region);
+            _update(mo, moi, region, lazy);
 
 			mo->lock(region, true);
 			lockInMem->push_back(lockedRegion(mo,region));
@@ -59,10 +59,12 @@ public:
      *
      * @param mo The memory object from where the subregion is to be synchronized/allocated
      * @param region The region to be synchronized/allocated
+     * @param lazy The region data can be written into GPU memory when first accessed
+     *        (only if the driver has lazy texture residency enabled)
      *
      * @see syncGPU()
      */
-    acd_bool syncGPU(MemoryObject* mo, acd_uint region);
+    acd_bool syncGPU(MemoryObject* mo, acd_uint region, acd_bool lazy = false);
 
     /**
      *
@@ -155,9 +157,9 @@ private:
     GPUDriver* _driver;
     
     // Primitives to manage local GPU memory, the public methods are built on top this functions
-    void _update(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region);
+    void _update(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region, acd_bool lazy);
     void _dealloc(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region);
-    void _alloc(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region);
+    void _alloc(MemoryObject* mo, MemoryObjectInfo* moi, acd_uint region, acd_bool lazy);
 
 };
 
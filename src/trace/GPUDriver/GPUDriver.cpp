@@ -164,7 +164,9 @@ setResolutionCalled(false), hRes(0), vRes(0), lastBlock(0),
 gpuAllocBlocks(0), systemAllocBlocks(0),
 // statistics
 agpTransactionsGenerated(0), memoryAllocations(0), memoryDeallocations(0), mdSearches(0),
-addressSearches(0), memPreloads(0), memWrites(0), memPreloadBytes(0), memWriteBytes(0), ctx(0), preloadMemory(false), 
+addressSearches(0), memPreloads(0), memWrites(0), memPreloadBytes(0), memWriteBytes(0),
+memLazyPreloads(0), memLazyPreloadBytes(0), memDedupWrites(0), memDedupBytes(0), frameDedupBytes(0),
+ctx(0), preloadMemory(false), lazyTextureResidency(false), writeDedup(false),
 #ifdef DISABLE_WRITEBUFFER_CACHE
     registerWriteBuffer(this, RegisterWriteBuffer::Inmediate),
 #else
@@ -653,6 +655,23 @@ void GPUDriver::writeGPUAddrRegister( GPURegister regId, u32bit index, u32bit md
     if ( data.uintVal > mdesc->lastAddress )
         panic("GPUDriver", "writeGPUAddrRegister", "offset out of bounds");
 
+    //  The GPU writes into these buffers so the driver no longer knows their content.
+    switch ( regId )
+    {
+        case GPU_FRONTBUFFER_ADDR:
+        case GPU_BACKBUFFER_ADDR:
+        case GPU_ZSTENCILBUFFER_ADDR:
+        case GPU_COLOR_STATE_BUFFER_MEM_ADDR:
+        case GPU_ZSTENCIL_STATE_BUFFER_MEM_ADDR:
+        case GPU_RENDER_TARGET_ADDRESS:
+        case GPU_BLIT_DST_ADDRESS:
+            mdesc->gpuWritten = true;
+            mdesc->writeHashes.clear();
+            break;
+        default:
+            break;
+    }
+
     registerWriteBuffer.writeRegister(regId, index, data, md);
 
     GLOBALPROFILER_EXITREGION()
@@ -701,6 +720,9 @@ void GPUDriver::sendCommand( GPUCommand com )
     {
         frame++;
         batch = 0;
+
+        dedupBytesPerFrame.push_back(frameDedupBytes);
+        frameDedupBytes = 0;
     }
 
     if ( preloadMemory )
@@ -1087,6 +1109,8 @@ GPUDriver::_MemoryDescriptor* GPUDriver::_createMD( u32bit firstAddress, u32bit
         // debug
         md->highAddressWritten = firstAddress;
 
+        md->gpuWritten = false;
+
         //  Add to the map of Memory Descriptors.
         memoryDescriptors[mdID] = md;
 
@@ -1491,6 +1515,12 @@ bool GPUDriver::writeMemory( u32bit md, u32bit offset, const u8bit* data, u32bit
 
     UPDATE_HIGH_ADDRESS_WRITTEN(memDesc,offset,dataSize);
 
+    if ( _elideWrite(memDesc, offset, data, dataSize) )
+    {
+        GLOBALPROFILER_EXITREGION()
+        return true;
+    }
+
     if ( preloadMemory )
     {
         _sendAGPTransaction( new AGPTransaction( memDesc->firstAddress + offset, dataSize,(u8bit*)data, md) );
@@ -1525,6 +1555,12 @@ bool GPUDriver::writeMemoryPreload(u32bit md, u32bit offset, const u8bit* data,
 
     UPDATE_HIGH_ADDRESS_WRITTEN(memDesc,offset,dataSize);
 
+    if (_elideWrite(memDesc, offset, data, dataSize))
+    {
+        GLOBALPROFILER_EXITREGION()
+        return true;
+    }
+
     //  Create AGP_PRELOAD transaction.
     _sendAGPTransaction(new AGPTransaction(memDesc->firstAddress + offset, dataSize, (u8bit*) data, md));
 
@@ -1536,6 +1572,91 @@ bool GPUDriver::writeMemoryPreload(u32bit md, u32bit offset, const u8bit* data,
     return true;
 }
 
+bool GPUDriver::writeMemoryLazy(u32bit md, u32bit offset, const u8bit* data, u32bit dataSize)
+{
+    GLOBALPROFILER_ENTERREGION("gpudriver", "", "")
+
+    _MemoryDescriptor* memDesc = _findMD(md);
+    
+    if (memDesc == NULL)
+        panic("GPUDriver", "writeMemoryLazy", "Memory descriptor does not exist");
+
+    if (!CHECK_MEMORY_ACCESS(memDesc,offset,dataSize))
+        panic("GPUDriver", "writeMemoryLazy", "Access memory out of range");
+
+    UPDATE_HIGH_ADDRESS_WRITTEN(memDesc,offset,dataSize);
+
+    if (_elideWrite(memDesc, offset, data, dataSize))
+    {
+        GLOBALPROFILER_EXITREGION()
+        return true;
+    }
+
+    //  Create AGP_PRELOAD transaction to be deferred by the memory controller.
+    AGPTransaction *agpt = new AGPTransaction(memDesc->firstAddress + offset, dataSize, (u8bit*) data, md);
+    agpt->setLazy(true);
+    _sendAGPTransaction(agpt);
+
+    memLazyPreloads++;
+    memLazyPreloadBytes += dataSize;
+    
+    GLOBALPROFILER_EXITREGION()
+
+    return true;
+}
+
+bool GPUDriver::_elideWrite(_MemoryDescriptor* memDesc, u32bit offset, const u8bit* data, u32bit dataSize)
+{
+    if (!writeDedup || memDesc->gpuWritten || (dataSize == 0))
+        return false;
+
+    u64bit hash = _hashData(data, dataSize);
+
+    map<u32bit, _WriteHash>::iterator it = memDesc->writeHashes.find(offset);
+
+    //  Same range and same content than the last write.  A hash collision must not lose a write.
+    if ((it != memDesc->writeHashes.end()) && (it->second.size == dataSize) && (it->second.hash == hash) &&
+        (memcmp(&it->second.data[0], data, dataSize) == 0))
+    {
+        memDedupWrites++;
+        memDedupBytes += dataSize;
+        frameDedupBytes += dataSize;
+        return true;
+    }
+
+    //  Remove the hashes of all the ranges overlapping with the new write.
+    it = memDesc->writeHashes.lower_bound(offset);
+    if (it != memDesc->writeHashes.begin())
+    {
+        map<u32bit, _WriteHash>::iterator prev = it;
+        prev--;
+        if ((prev->first + prev->second.size) > offset)
+            it = prev;
+    }
+    while ((it != memDesc->writeHashes.end()) && (it->first < (offset + dataSize)))
+        memDesc->writeHashes.erase(it++);
+
+    _WriteHash &writeHash = memDesc->writeHashes[offset];
+    writeHash.size = dataSize;
+    writeHash.hash = hash;
+    writeHash.data.assign(data, data + dataSize);
+
+    return false;
+}
+
+u64bit GPUDriver::_hashData(const u8bit* data, u32bit dataSize)
+{
+    u64bit hash = 0xcbf29ce484222325ULL;
+
+    for (u32bit i = 0; i < dataSize; i++)
+    {
+        hash ^= u64bit(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
 void GPUDriver::printMemoryUsage()
 {
     printf("GPUDriver => Memory usage : GPU %d blocks | System %d blocks\n", gpuAllocBlocks,
@@ -1666,6 +1787,15 @@ void GPUDriver::dumpStatistics()
     printf("memPreloadBytes : %d\n", memPreloadBytes);
     printf("memWrites : %d\n", memWrites);
     printf("memWriteBytes : %d\n", memWriteBytes);
+    printf("memLazyPreloads : %d\n", memLazyPreloads);
+    printf("memLazyPreloadBytes : %d\n", memLazyPreloadBytes);
+    printf("memDedupWrites : %d\n", memDedupWrites);
+    printf("memDedupBytes : %d\n", memDedupBytes);
+    for (u32bit f = 0; f < dedupBytesPerFrame.size(); f++)
+    {
+        if (dedupBytesPerFrame[f] != 0)
+            printf("memDedupBytes frame %d : %d\n", f, dedupBytesPerFrame[f]);
+    }
 }
 
 
@@ -1752,6 +1882,26 @@ bool GPUDriver::getPreloadMemory() const
     return preloadMemory;
 }
 
+void GPUDriver::setLazyTextureResidency(bool enable)
+{
+    lazyTextureResidency = enable;
+}
+
+bool GPUDriver::getLazyTextureResidency() const
+{
+    return lazyTextureResidency;
+}
+
+void GPUDriver::setWriteDedup(bool enable)
+{
+    writeDedup = enable;
+}
+
+bool GPUDriver::getWriteDedup() const
+{
+    return writeDedup;
+}
+
 void GPUDriver::translateShaderProgram(u8bit *inCode, u32bit inSize, u8bit *outCode, u32bit &outSize,
                                        bool isVertexProgram, u32bit &maxLiveTempRegs, MicroTriangleRasterSettings settings)
 {
@@ -65,8 +65,26 @@ private:
     u32bit memWrites;
     u32bit memPreloadBytes;
     u32bit memWriteBytes;
+    u32bit memLazyPreloads;
+    u32bit memLazyPreloadBytes;
+    u32bit memDedupWrites;
+    u32bit memDedupBytes;
+    u32bit frameDedupBytes;
+    std::vector<u32bit> dedupBytesPerFrame;
 
     bool preloadMemory;
+    bool lazyTextureResidency;
+    bool writeDedup;
+
+    /**
+     * Content hash and copy of the last data written by the driver into a range of a memory descriptor
+     */
+    struct _WriteHash
+    {
+        u32bit size;
+        u64bit hash;
+        std::vector<u8bit> data; // the hash only filters, the content is always compared
+    };
 
     /**
      * Descriptor for a sequence of GPU memory blocks
@@ -80,6 +98,8 @@ private:
         u32bit memId;
         u64bit lastBatchWritten; // used to support batch pipelining
         u32bit highAddressWritten; // debug
+        bool gpuWritten; // the GPU renders into this memory, writes are never elided
+        std::map<u32bit, _WriteHash> writeHashes; // last content written by the driver, indexed by offset
     };
 
     /**
@@ -131,6 +151,26 @@ private:
      */
     void _releaseMD( u32bit memId );
 
+    /**
+     * Checks if a write into a memory descriptor can be elided because the driver already
+     * wrote the same content in the same range.  The hash is used as a filter and the write
+     * is only elided when the bytes match the copy of the last write.  If the write can not
+     * be elided the ranges overwritten are replaced with the hash and copy of the new content.
+     *
+     * @param memDesc the memory descriptor being written
+     * @param offset offset of the write inside the memory descriptor
+     * @param data data to be written
+     * @param dataSize data size in bytes
+     *
+     * @return true if the write can be elided, false if it must be sent to the GPU
+     */
+    bool _elideWrite( _MemoryDescriptor* memDesc, u32bit offset, const u8bit* data, u32bit dataSize );
+
+    /**
+     * Computes the content hash (64-bit FNV-1a) of a data buffer
+     */
+    static u64bit _hashData( const u8bit* data, u32bit dataSize );
+
 
     /**
      *
@@ -422,6 +462,31 @@ public:
 
     bool getPreloadMemory() const;
 
+    /**
+     * Lazy texture residency mode.  Texture mipmap uploads are sent as lazy preloads, the
+     * memory is allocated but the data is only written into GPU memory when the mipmap is
+     * first accessed.
+     *
+     * The lazy uploads are AGP_PRELOAD transactions:  no AGP write traffic or latency is
+     * simulated for the texture uploads, the timing is not the timing of normal uploads.
+     *
+     * @param enable true to upload texture mipmaps lazily, false means normal behaviour
+     */
+    void setLazyTextureResidency(bool enable);
+
+    bool getLazyTextureResidency() const;
+
+    /**
+     * Memory write deduplication.  Writes into a range of a memory descriptor with the same
+     * content the driver last wrote into that range are not sent to the GPU.  Memory
+     * descriptors bound as render targets are never deduplicated.
+     *
+     * @param enable true to elide redundant memory writes, false means normal behaviour
+     */
+    void setWriteDedup(bool enable);
+
+    bool getWriteDedup() const;
+
     /**
      *
      *  Returns the fetch instruction rate for the GPU shader units.
@@ -740,6 +805,22 @@ public:
      */
     bool writeMemoryPreload(u32bit md, u32bit offset, const u8bit* data, u32bit dataSize);
 
+    /**
+     *
+     * Preloads data in an specific portion of memory described by a memory descriptor.  The
+     * GPU memory controller defers writing the data into memory until the region is first accessed.
+     *
+     * @param md memory descriptor representing a portion of memory previously reserved
+     * @param offset logical offset added to the initial address of this memory space
+     *        before writting
+     * @param data data buffer we want to preload in local memory
+     * @param dataSize data size in bytes
+     *
+     * @return true if the preload was succesful, false otherwise
+     *
+     */
+    bool writeMemoryLazy(u32bit md, u32bit offset, const u8bit* data, u32bit dataSize);
+
     /**
      * Writes a GPU simulator's register
      *
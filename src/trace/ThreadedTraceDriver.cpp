@@ -0,0 +1,175 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ */
+
+
+
+#include "ThreadedTraceDriver.h"
+#include "support.h"
+#include <cstdio>
+
+using namespace gpu3d;
+
+ThreadedTraceDriver::ThreadedTraceDriver(TraceDriverInterface *trDriver_, u32bit queueSize_) :
+    trDriver(trDriver_), queueSize(queueSize_), head(0), tail(0), stopRequested(false),
+    threadStarted(false), endOfTrace(false), tracePosition(0), producerWaits(0), consumerWaits(0)
+{
+    if (trDriver == NULL)
+        panic("ThreadedTraceDriver", "ThreadedTraceDriver", "Trace driver not defined.");
+
+    //  One entry is always kept empty to distinguish between full and empty queue.
+    if (queueSize < 2)
+        panic("ThreadedTraceDriver", "ThreadedTraceDriver", "AGP transaction queue requires at least two entries.");
+
+    queue = new QueueEntry[queueSize];
+
+    pthread_mutex_init(&queueMutex, NULL);
+    pthread_cond_init(&notFull, NULL);
+    pthread_cond_init(&notEmpty, NULL);
+}
+
+ThreadedTraceDriver::~ThreadedTraceDriver()
+{
+    stop();
+
+    //  Delete the AGP transactions not consumed by the simulator.
+    while (head != tail)
+    {
+        if (queue[head].agpTrans != NULL)
+            delete queue[head].agpTrans;
+        head = (head + 1) % queueSize;
+    }
+
+    delete[] queue;
+
+    pthread_cond_destroy(&notEmpty);
+    pthread_cond_destroy(&notFull);
+    pthread_mutex_destroy(&queueMutex);
+}
+
+int ThreadedTraceDriver::startTrace()
+{
+    int result = trDriver->startTrace();
+
+    if (!threadStarted)
+    {
+        if (pthread_create(&producerThread, NULL, &ThreadedTraceDriver::producerMain, this) != 0)
+            panic("ThreadedTraceDriver", "startTrace", "Error creating the trace driver thread.");
+
+        threadStarted = true;
+    }
+
+    return result;
+}
+
+void *ThreadedTraceDriver::producerMain(void *arg)
+{
+    static_cast<ThreadedTraceDriver *>(arg)->produce();
+
+    return NULL;
+}
+
+void ThreadedTraceDriver::produce()
+{
+    bool end = false;
+
+    while (!end)
+    {
+        //  Generate the next AGP transaction.  NULL is also queued to signal the end of the trace.
+        AGPTransaction *agpTrans = trDriver->nextAGPTransaction();
+        u32bit position = trDriver->getTracePosition();
+        end = (agpTrans == NULL);
+
+        pthread_mutex_lock(&queueMutex);
+
+        //  Wait for a free entry in the queue.
+        if ((((tail + 1) % queueSize) == head) && !stopRequested)
+        {
+            producerWaits++;
+
+            while ((((tail + 1) % queueSize) == head) && !stopRequested)
+                pthread_cond_wait(&notFull, &queueMutex);
+        }
+
+        if (stopRequested)
+        {
+            pthread_mutex_unlock(&queueMutex);
+
+            if (agpTrans != NULL)
+                delete agpTrans;
+
+            return;
+        }
+
+        queue[tail].agpTrans = agpTrans;
+        queue[tail].tracePosition = position;
+
+        tail = (tail + 1) % queueSize;
+
+        pthread_cond_signal(&notEmpty);
+        pthread_mutex_unlock(&queueMutex);
+    }
+}
+
+AGPTransaction *ThreadedTraceDriver::nextAGPTransaction()
+{
+    if (endOfTrace)
+        return NULL;
+
+    pthread_mutex_lock(&queueMutex);
+
+    //  Wait until the producer thread writes a new entry.
+    if (head == tail)
+    {
+        consumerWaits++;
+
+        while (head == tail)
+            pthread_cond_wait(&notEmpty, &queueMutex);
+    }
+
+    AGPTransaction *agpTrans = queue[head].agpTrans;
+    tracePosition = queue[head].tracePosition;
+
+    head = (head + 1) % queueSize;
+
+    pthread_cond_signal(&notFull);
+    pthread_mutex_unlock(&queueMutex);
+
+    endOfTrace = (agpTrans == NULL);
+
+    return agpTrans;
+}
+
+u32bit ThreadedTraceDriver::getTracePosition()
+{
+    return tracePosition;
+}
+
+void ThreadedTraceDriver::stop()
+{
+    if (threadStarted)
+    {
+        pthread_mutex_lock(&queueMutex);
+        stopRequested = true;
+        pthread_cond_signal(&notFull);
+        pthread_mutex_unlock(&queueMutex);
+
+        pthread_join(producerThread, NULL);
+        threadStarted = false;
+    }
+}
+
+void ThreadedTraceDriver::dumpStatistics()
+{
+    printf("ThreadedTraceDriver => Queue entries : %d | Producer waits : %lld | Consumer waits : %lld\n",
+        queueSize, producerWaits, consumerWaits);
+}
@@ -0,0 +1,154 @@
+/**************************************************************************
+ *
+ * Copyright (c) 2002 - 2011 by Computer Architecture Department,
+ * Universitat Politecnica de Catalunya.
+ * All rights reserved.
+ *
+ * The contents of this file may not be disclosed to third parties,
+ * copied or duplicated in any form, in whole or in part, without the
+ * prior permission of the authors, Computer Architecture Department
+ * and Universitat Politecnica de Catalunya.
+ *
+ */
+
+
+
+#ifndef _THREADEDTRACEDRIVER_
+    #define _THREADEDTRACEDRIVER_
+
+#include "GPUTypes.h"
+#include "AGPTransaction.h"
+#include "TraceDriverInterface.h"
+#include <pthread.h>
+
+/**
+ *
+ *  Threaded Trace Driver class.
+ *
+ *  Runs a trace driver (trace reader, API library and GPU driver) in its own thread ahead
+ *  of the simulator.  The generated AGP transactions are stored in a bounded single producer
+ *  single consumer queue protected by a mutex.  The producer thread blocks on a condition
+ *  variable when the queue is full and the simulator blocks when the queue is empty and the
+ *  trace has not finished.
+ *
+ *  The API libraries and the GPU driver must not be accessed from the simulator thread
+ *  while the producer thread is running.  GPU register reads are served by the driver
+ *  register shadow so no transaction requires results from the simulator.
+ *
+ *  Dynamic objects (AGP transactions) are allocated by the producer thread and deleted by
+ *  the simulator thread so the OptimizedDynamicMemory thread safe mode must be enabled.  The
+ *  mode also makes the DynamicObject cookie generator atomic.
+ *
+ */
+
+class ThreadedTraceDriver : public TraceDriverInterface
+{
+
+private:
+
+    /**
+     *  Entry of the AGP transaction queue.
+     */
+    struct QueueEntry
+    {
+        gpu3d::AGPTransaction *agpTrans;    /**<  The AGP transaction.  NULL marks the end of the trace.  */
+        u32bit tracePosition;               /**<  Position in the trace after generating the transaction.  */
+    };
+
+    TraceDriverInterface *trDriver;     /**<  The trace driver that runs in the producer thread.  */
+
+    QueueEntry *queue;                  /**<  AGP transaction queue.  */
+    u32bit queueSize;                   /**<  Number of entries in the AGP transaction queue.  */
+    u32bit head;                        /**<  Next entry to read, only written by the simulator thread.  */
+    u32bit tail;                        /**<  Next entry to write, only written by the producer thread.  */
+
+    pthread_mutex_t queueMutex;         /**<  Protects the queue pointers and the stop flag.  */
+    pthread_cond_t notFull;             /**<  Signaled when the simulator frees a queue entry.  */
+    pthread_cond_t notEmpty;            /**<  Signaled when the producer thread writes a queue entry.  */
+
+    bool stopRequested;                 /**<  The producer thread must stop.  */
+    bool threadStarted;                 /**<  The producer thread was created.  */
+    bool endOfTrace;                    /**<  The end of trace entry was read from the queue.  */
+    pthread_t producerThread;           /**<  Producer thread.  */
+
+    u32bit tracePosition;               /**<  Trace position for the last AGP transaction read from the queue.  */
+
+    //  Statistics.
+    u64bit producerWaits;               /**<  Times the producer thread found the queue full.  */
+    u64bit consumerWaits;               /**<  Times the simulator found the queue empty.  */
+
+    /**
+     *  Producer thread entry point.
+     */
+    static void *producerMain(void *arg);
+
+    /**
+     *  Producer thread loop.  Generates AGP transactions until the end of the trace or
+     *  until a stop is requested.
+     */
+    void produce();
+
+public:
+
+    /**
+     *
+     *  Threaded Trace Driver constructor.
+     *
+     *  @param trDriver Pointer to the trace driver to run in the producer thread.
+     *  @param queueSize Number of entries in the AGP transaction queue.
+     *
+     */
+    ThreadedTraceDriver(TraceDriverInterface *trDriver, u32bit queueSize);
+
+    /**
+     *
+     *  Threaded Trace Driver destructor.  Stops the producer thread and deletes the
+     *  AGP transactions still in the queue.  The wrapped trace driver is not deleted.
+     *
+     */
+    ~ThreadedTraceDriver();
+
+    /**
+     *
+     *  Starts the wrapped trace driver and creates the producer thread.
+     *
+     *  @return The value returned by the wrapped trace driver startTrace().
+     *
+     */
+    int startTrace();
+
+    /**
+     *
+     *  Reads the next AGP transaction from the queue.  Waits for the producer thread
+     *  if the queue is empty.
+     *
+     *  @return A pointer to the new AGP transaction, NULL if there are no more AGP transactions.
+     *
+     */
+    gpu3d::AGPTransaction* nextAGPTransaction();
+
+    /**
+     *
+     *  Obtain the trace position for the last AGP transaction read from the queue.
+     *
+     *  @return The trace position.
+     *
+     */
+    u32bit getTracePosition();
+
+    /**
+     *
+     *  Stops the producer thread.
+     *
+     */
+    void stop();
+
+    /**
+     *
+     *  Prints the queue statistics.
+     *
+     */
+    void dumpStatistics();
+};
+
+#endif
@@ -170,6 +170,11 @@ int gzfilebuf::setcompressionstrategy(int comp_strategy)
   return gzsetparams(file, -2, comp_strategy);
 }
 
+int gzfilebuf::setcompression(int comp_level, int comp_strategy)
+{
+  return gzsetparams(file, comp_level, comp_strategy);
+}
+
 
 streampos gzfilebuf::seekpos(streamoff off, int which)
 {
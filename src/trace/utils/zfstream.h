@@ -27,6 +27,7 @@ public:
 
     int setcompressionlevel( int comp_level );
     int setcompressionstrategy( int comp_strategy );
+    int setcompression( int comp_level, int comp_strategy );
 
     inline int is_open() const { return (file !=NULL); }
 
@@ -130,6 +131,11 @@ class gzofstream : public gzfilestream_common, public ostream {
             rdbuf()->setcompressionlevel(l);
     };
 
+    void setcompression(int l, int s)
+    {
+            rdbuf()->setcompression(l, s);
+    };
+
     virtual ~gzofstream();
 
     pos_type tellp()
@@ -0,0 +1,177 @@
+#!/usr/bin/perl
+#
+#  Simulator performance benchmark.
+#
+#  Runs the simulator (bGPU-Uni) and the emulator (bGPU-emu) on the traces in
+#  bench_list with the fixed configurations in test/config and writes the wall
+#  time, peak RSS and throughput (simulated cycles/s, emulated fragments/s) of
+#  every run to a JSON file that can be compared across commits.  The simulator
+#  runs with the box profiler enabled (--profile) and the host time spent in each
+#  box is also recorded.
+#
+#  Usage: bench.pl [--list file] [--output file] [--repeat n] [--sim-only | --emu-only] [--no-profile]
+#
+#  bench_list format (one case per line):
+#
+#    test_dir, config file, trace file, frames, start frame
+#
+use strict;
+use warnings;
+use Cwd 'abs_path';
+use File::Basename;
+use Getopt::Long;
+use JSON::PP;
+use POSIX qw(strftime);
+use Sys::Hostname;
+use Time::HiRes qw(time);
+
+sub trim($)
+{
+        my $string = shift;
+        $string =~ s/^\s+//;
+        $string =~ s/\s+$//;
+        return $string;
+}
+
+my $test_path = abs_path(dirname($0)) . "/";
+my $gpu3d_path = abs_path("$test_path/..");
+my $config_path = "$test_path/config";
+
+my $list_path = "$test_path/bench_list";
+my $output_path = "$test_path/bench.json";
+my $repeat = 1;
+my $sim_only = 0;
+my $emu_only = 0;
+my $profile = 1;
+
+GetOptions("list=s" => \$list_path,
+           "output=s" => \$output_path,
+           "repeat=i" => \$repeat,
+           "sim-only" => \$sim_only,
+           "emu-only" => \$emu_only,
+           "profile!" => \$profile) or die "Usage: $0 [--list file] [--output file] [--repeat n] [--sim-only | --emu-only] [--no-profile]\n";
+
+$repeat = 1 if ($repeat < 1);
+
+my @tools = ();
+push(@tools, { name => "simulator", binary => "$gpu3d_path/bin/bGPU-Uni", options => ($profile ? "--profile" : "") }) if (!$emu_only);
+push(@tools, { name => "emulator", binary => "$gpu3d_path/bin/bGPU-emu", options => "" }) if (!$sim_only);
+
+foreach my $tool (@tools) {
+        die "gpu3d binary not found in $tool->{binary}\n" if (! -e $tool->{binary});
+}
+
+open(CASES, $list_path) or die "ERROR: Cannot open $list_path\n";
+my @lines = grep { /\S/ && !/^\s*#/ } <CASES>;
+close(CASES);
+
+#  Runs a case once and returns the values parsed from the benchmark line.
+sub run_case
+{
+        my $binary = shift;
+        my $config = shift;
+        my $args = shift;
+        my $log = shift;
+        my %run = ();
+        my %boxes = ();
+
+        my $start = time();
+        my $code = system("$binary --config $config $args > $log 2>&1");
+        $run{host_wall_time_s} = time() - $start;
+        $run{exit_code} = $code >> 8;
+
+        open(LOG, $log) or return \%run;
+        while (my $line = <LOG>) {
+                if ($line =~ /^Benchmark => Wall time = ([\d.]+) s \| (GPU cycles|Fragments) = (\d+) \| (?:Cycles|Fragments)\/s = ([\d.]+) \| Peak RSS = (\d+) KB/) {
+                        $run{wall_time_s} = $1 + 0;
+                        if ($2 eq "GPU cycles") {
+                                $run{gpu_cycles} = $3 + 0;
+                                $run{cycles_per_s} = $4 + 0;
+                        }
+                        else {
+                                $run{fragments} = $3 + 0;
+                                $run{fragments_per_s} = $4 + 0;
+                        }
+                        $run{peak_rss_kb} = $5 + 0;
+                }
+                elsif ($line =~ /^Box profile => Box (\S+)\s+(\S+)\s+([\d.]+) s\s+([\d.]+) %/) {
+                        $boxes{($2 eq "GPU") ? $1 : "$1($2)"} = $3 + 0;
+                }
+                elsif ($line =~ /^Box profile => Profiled = ([\d.]+) s \| Boxes = ([\d.]+) s \| Other = ([\d.]+) s/) {
+                        $run{profiled_time_s} = $1 + 0;
+                        $run{other_time_s} = $3 + 0;
+                }
+        }
+        close(LOG);
+
+        $run{box_time_s} = \%boxes if (%boxes);
+
+        return \%run;
+}
+
+my @results = ();
+
+foreach my $line (@lines)
+{
+        my @splitted = split(/,/, $line);
+        my $test_dir = trim($splitted[0]);
+        my $configfile = trim($splitted[1]);
+        my $tracefile = trim($splitted[2]);
+        my $frames = defined($splitted[3]) ? trim($splitted[3]) : '';
+        my $start_frame = defined($splitted[4]) ? trim($splitted[4]) : '';
+        my $full_test_path = "$test_path" . "$test_dir";
+
+        if (! -d $full_test_path) {
+                print("$test_dir test not found\n");
+                next;
+        }
+
+        foreach my $tool (@tools)
+        {
+                my $best;
+
+                chdir($full_test_path);
+
+                for (my $i = 0; $i < $repeat; $i++)
+                {
+                        print("Running $tool->{name} on $test_dir (run " . ($i + 1) . " of $repeat)...\n");
+
+                        my $run = run_case($tool->{binary}, "$config_path/$configfile", "$tool->{options} $tracefile $frames $start_frame",
+                                           "bench.$tool->{name}.txt");
+
+                        #  Keep the fastest run, the slower ones are disturbed by the host.
+                        $best = $run if (!defined($best) || (defined($run->{wall_time_s}) &&
+                                         (!defined($best->{wall_time_s}) || ($run->{wall_time_s} < $best->{wall_time_s}))));
+                }
+
+                `rm -f *.ppm *.png stats*.*.* BoxProfile.*.csv`;
+
+                chdir($test_path);
+
+                my %result = (case => $test_dir, tool => $tool->{name}, config => $configfile, trace => $tracefile,
+                              frames => $frames + 0, start_frame => $start_frame + 0, runs => $repeat, %$best);
+
+                if ($best->{exit_code} != 0 || !defined($best->{wall_time_s})) {
+                        print("FAILED (exit code $best->{exit_code}), see $test_dir/bench.$tool->{name}.txt\n");
+                }
+                else {
+                        printf("  wall time %.3f s, peak RSS %d KB\n", $best->{wall_time_s}, $best->{peak_rss_kb});
+                }
+
+                push(@results, \%result);
+        }
+}
+
+my $commit = `cd $gpu3d_path && git rev-parse HEAD 2>/dev/null`;
+chomp($commit);
+
+my %report = (commit => $commit,
+              date => strftime("%Y-%m-%dT%H:%M:%S", localtime()),
+              host => hostname(),
+              results => \@results);
+
+open(OUT, ">$output_path") or die "ERROR: Cannot open $output_path\n";
+print OUT JSON::PP->new->canonical->pretty->encode(\%report);
+close(OUT);
+
+print("Benchmark results written to $output_path\n");
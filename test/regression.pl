@@ -194,6 +194,7 @@ foreach $line (@lines)
         my $frames = defined($splitted[3]) ? trim($splitted[3]) : '';
         my $start_frame = defined($splitted[4]) ? trim($splitted[4]) : '';
 	my $tolerance = defined($splitted[5]) ? trim($splitted[5]) : 0;
+	my $validation = defined($splitted[6]) ? (trim($splitted[6]) eq "valid") : 0;
 	my $full_test_path = "$test_path" . "$test_dir";
 	my $result;
 
@@ -210,11 +211,28 @@ foreach $line (@lines)
 		print("Executing $test_dir...\n");
         	copy("$config_path/$configfile","./bGPU.ini") or die "ERROR: $configfile copy failed";
         	my $code;
-        	$code = system("$binary_path $tracefile $frames $start_frame | tee output.txt");
+        	if ($validation) {
+        		# Validation mode: the simulator is compared with the emulator while the frames are simulated.
+        		$code = system("printf 'runframe $frames\\nquit\\n' | $binary_path --valid $tracefile $frames $start_frame | tee output.txt");
+        	}
+        	else {
+        		$code = system("$binary_path $tracefile $frames $start_frame | tee output.txt");
+        	}
         	if($code != 0) {
                 	print("INTERRUPTED (returned code $code)\n");
                         print RESULT "INTERRUPTED (returned code $code)\n";
         	}
+		if ($validation) {
+			my $errors = `grep -c "^Validation =>" output.txt`;
+			chomp($errors);
+			if ($errors != 0) {
+				print("Result FAILED, $errors validation errors (see $test_dir/output.txt)\n");
+				print RESULT "$test_dir (validation): FAILED, $errors validation errors\n";
+				die "REGRESSION TEST STOPPED\n";
+			}
+			print("Validation PASS: simulator and emulator logs match\n");
+			print RESULT "$test_dir (validation): PASS\n";
+		}
 		system('rm bGPU.ini');
 		
 		if (! -d "$full_test_path/reference/")